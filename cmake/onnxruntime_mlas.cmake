@@ -5,11 +5,19 @@ set(mlas_common_srcs
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/platform.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/threading.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/sgemm.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/qgemm.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/convolve.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/winograd.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/pooling.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/broadcast.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/transpose.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/snchwc.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/activate.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/logistic.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/tanh.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/erf.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/exp.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/softmax.cpp
 )
 
 if (MSVC)
@@ -65,7 +73,12 @@ if (MSVC)
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/amd64/cvtfp16a.asm
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/amd64/LogisticKernelFma3.asm
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/amd64/TanhKernelFma3.asm
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/amd64/ExpKernelFma3.asm
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/sconv_avx2.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/sconv_avx512f.cpp
     )
+    set_source_files_properties(${ONNXRUNTIME_ROOT}/core/mlas/lib/sconv_avx2.cpp PROPERTIES COMPILE_FLAGS "/arch:AVX2")
+    set_source_files_properties(${ONNXRUNTIME_ROOT}/core/mlas/lib/sconv_avx512f.cpp PROPERTIES COMPILE_FLAGS "/arch:AVX512")
 
   endif()
 
@@ -120,19 +133,29 @@ else()
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/SgemmKernelFma3.S
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/LogisticKernelFma3.S
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/TanhKernelFma3.S
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/ExpKernelFma3.S
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/QgemmKernelAvx2.S
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/sconv_avx2.cpp
     )
     set_source_files_properties(${mlas_platform_srcs_avx2} PROPERTIES COMPILE_FLAGS "-mavx2 -mfma")
 
     set(mlas_platform_srcs_avx512f
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/SgemmKernelAvx512F.S
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/sconv_avx512f.cpp
     )
     set_source_files_properties(${mlas_platform_srcs_avx512f} PROPERTIES COMPILE_FLAGS "-mavx512f")
 
+    set(mlas_platform_srcs_avx512vnni
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/QgemmKernelAvx512Vnni.S
+    )
+    set_source_files_properties(${mlas_platform_srcs_avx512vnni} PROPERTIES COMPILE_FLAGS "-mavx512f -mavx512bw -mavx512vnni")
+
     set(mlas_platform_srcs
       ${mlas_platform_srcs_sse2}
       ${mlas_platform_srcs_avx}
       ${mlas_platform_srcs_avx2}
       ${mlas_platform_srcs_avx512f}
+      ${mlas_platform_srcs_avx512vnni}
     )
 
   endif()
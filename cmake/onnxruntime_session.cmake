@@ -16,6 +16,10 @@ target_include_directories(onnxruntime_session PRIVATE ${ONNXRUNTIME_ROOT} ${eig
 add_dependencies(onnxruntime_session ${onnxruntime_EXTERNAL_DEPENDENCIES})
 set_target_properties(onnxruntime_session PROPERTIES FOLDER "ONNXRuntime")
 
+# optimized model cache entries are keyed by the runtime version
+set_source_files_properties("${ONNXRUNTIME_ROOT}/core/session/optimized_model_cache.cc"
+    PROPERTIES COMPILE_DEFINITIONS ORT_VERSION="${VERSION_NUMBER}")
+
 if(onnxruntime_USE_EIGEN_THREADPOOL)
     target_compile_definitions(onnxruntime_session PUBLIC USE_EIGEN_THREADPOOL)
 endif()
@@ -19,11 +19,19 @@
 #include "gsl/span"
 #include "onnx/defs/schema.h"
 
+#ifdef USE_EIGEN_THREADPOOL
+#include <unsupported/Eigen/CXX11/ThreadPool>
+#endif
+
 namespace onnxruntime {
 class ExecutionFrame;
 class OpKernelContext;
 class OpKernelWrapper;
 
+#ifndef USE_EIGEN_THREADPOOL
+class TaskThreadPool;
+#endif
+
 class OpKernel {
  public:
   using DoneCallback = std::function<void()>;
@@ -46,6 +54,16 @@ class OpKernel {
     ORT_NOT_IMPLEMENTED(__FUNCTION__, " is not implemented");
   }
 
+  // Override this function to transform a constant initializer input into a
+  // kernel specific layout (for example, a prepacked GEMM weight) once when
+  // the session is initialized. The function is invoked after construction
+  // for each input that is a constant initializer.
+  // Set is_packed to true if the kernel keeps its own copy of the data.
+  virtual Status PrePack(const Tensor& /*tensor*/, int /*input_idx*/, bool& is_packed) {
+    is_packed = false;
+    return Status::OK();
+  }
+
   const OrtAllocatorInfo& Allocator(int id, OrtMemType mem_type) const {
     return op_kernel_info_.GetAllocatorInfo(id, mem_type);
   }
@@ -121,6 +139,18 @@ class OpKernelContext {
    */
   Status GetTempSpaceAllocator(AllocatorPtr* output) const;
 
+  /**
+  Return the thread pool of the session, which kernels can use to run their work in parallel
+  instead of creating threads of their own. It is shared with the executor, so the caller must
+  not block waiting for work that has not started yet.
+  @returns The session thread pool, or nullptr if the session does not have one.
+  */
+#ifdef USE_EIGEN_THREADPOOL
+  Eigen::NonBlockingThreadPool* GetOperatorThreadPool() const;
+#else
+  TaskThreadPool* GetOperatorThreadPool() const;
+#endif
+
   /**
   Return the fence of current node's input.
   @param index The index of the input.
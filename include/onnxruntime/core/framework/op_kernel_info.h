@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <string>
+
 #include "core/framework/execution_provider.h"
 #include "core/framework/kernel_def_builder.h"
 #include "core/framework/ml_value.h"
@@ -41,6 +45,16 @@ class OpKernelInfo : public OpNodeProtoHelper<ProtoHelperNodeContext> {
 
   bool TryGetConstantInput(int input_index, const Tensor** constant_input_value) const;
 
+  /**
+     Get a buffer for data that OpKernel::PrePack derives from a constant initializer, e.g. a prepacked GEMM matrix.
+     If the initializer comes from the session's SharedWeightsStore the buffer is shared with the other sessions
+     using the store, and pack_fn only runs if none of them holds a buffer for the same tensor and pack_key.
+     @param pack_key identifies the parameters that change the packed data. The node's op type is prepended.
+     @param pack_fn writes size bytes of packed data to the buffer.
+  */
+  common::Status GetPrePackedBuffer(const Tensor& tensor, const std::string& pack_key, size_t size,
+                                    const std::function<void(void*)>& pack_fn, std::shared_ptr<void>& buffer) const;
+
   common::Status GetFusedFuncs(ComputeFunc* compute, CreateFunctionStateFunc* create, DestroyFunctionStateFunc* release) const;
 
  private:
@@ -184,6 +184,30 @@ ORT_API_STATUS(OrtRun, _Inout_ OrtSession* sess,
                _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
                _In_ const char* const* output_names, size_t output_names_len, _Out_ OrtValue** output);
 
+/**
+ * Called when a run queued by OrtRunAsync completes.
+ * \param user_data the value passed to OrtRunAsync
+ * \param status NULL on success. Otherwise it should be freed by OrtReleaseStatus
+ * \param output output_names_len values in the order of output_names passed to OrtRunAsync. NULL if status is not NULL.
+ *        Each value should be freed by OrtReleaseValue. The array itself is only valid during the callback.
+ */
+typedef void(ORT_API_CALL* OrtRunAsyncCallback)(void* user_data, OrtStatus* status, OrtValue** output,
+                                                size_t output_names_len);
+
+/**
+ * Queue a run and return immediately. The model is run on a thread owned by the session and callback
+ * is invoked on that thread when the run completes. The callback must not release the session.
+ * \param run_options may be NULL. Otherwise it must not be released until callback is invoked.
+ * \param input the input values must not be changed until callback is invoked
+ * \return NULL if the run was queued, in which case callback will be invoked exactly once.
+ *         callback is not invoked if an error status is returned.
+ */
+ORT_API_STATUS(OrtRunAsync, _Inout_ OrtSession* sess,
+               _In_opt_ OrtRunOptions* run_options,
+               _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
+               _In_ const char* const* output_names, size_t output_names_len,
+               _In_ OrtRunAsyncCallback callback, _In_opt_ void* user_data);
+
 /**
  * \return A pointer of the newly created object. The pointer should be freed by OrtReleaseSessionOptions after use
  */
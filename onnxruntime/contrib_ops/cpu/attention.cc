@@ -0,0 +1,184 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "attention.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/util/math.h"
+#include "core/util/math_cpuonly.h"
+#include <algorithm>
+#include <cmath>
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    Attention,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    Attention);
+
+namespace {
+
+// The number of bytes of attention scores computed at a time by a thread. The
+// query rows of a head are processed in blocks so that the scores of a block
+// stay in the cache between the two GEMMs and the softmax.
+constexpr int64_t kScoreBlockBytes = 64 * 1024;
+
+}  // namespace
+
+Status Attention::PrePack(const Tensor& tensor, int input_idx, bool& is_packed) {
+  is_packed = false;
+
+#if defined(USE_MLAS) && !defined(USE_MKLDNN)
+  // only pack the weights, which are matrix B of the projection GEMM.
+  if (input_idx != 1 || tensor.Shape().NumDimensions() != 2) {
+    return Status::OK();
+  }
+
+  const size_t K = static_cast<size_t>(tensor.Shape()[0]);
+  const size_t N = static_cast<size_t>(tensor.Shape()[1]);
+
+  const size_t packed_weights_size = MlasSgemmPackBSize(N, K);
+  if (packed_weights_size == 0) {
+    return Status::OK();
+  }
+
+  auto alloc = Info().GetAllocator(0, OrtMemTypeDefault);
+  auto packed_weights_data = alloc->Alloc(packed_weights_size);
+  packed_weights_ = BufferUniquePtr(packed_weights_data, BufferDeleter(alloc));
+
+  MlasSgemmPackB(CblasNoTrans, N, K, tensor.Data<float>(), N, packed_weights_data);
+
+  is_packed = true;
+#else
+  // math::Gemm does not use MLAS in this configuration.
+  ORT_UNUSED_PARAMETER(tensor);
+  ORT_UNUSED_PARAMETER(input_idx);
+#endif
+  return Status::OK();
+}
+
+Status Attention::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  const Tensor* W = context->Input<Tensor>(1);
+  const Tensor* B = context->Input<Tensor>(2);
+  const Tensor* mask_index = context->Input<Tensor>(3);
+
+  const auto& x_dims = X->Shape().GetDims();
+  ORT_RETURN_IF_NOT(x_dims.size() == 3, "Input is expected to have 3 dimensions, got ", x_dims.size());
+
+  const int64_t batch_size = x_dims[0];
+  const int64_t sequence_length = x_dims[1];
+  const int64_t hidden_size = x_dims[2];
+  ORT_RETURN_IF_NOT(hidden_size % num_heads_ == 0, "Hidden size ", hidden_size,
+                    " is not a multiple of the number of heads ", num_heads_);
+  const int64_t head_size = hidden_size / num_heads_;
+
+  // The weights are checked even when packed, since the tensor still holds the shape.
+  ORT_RETURN_IF_NOT(W->Shape() == TensorShape({hidden_size, 3 * hidden_size}),
+                    "Weights are expected to have shape [", hidden_size, ", ", 3 * hidden_size, "]");
+  ORT_RETURN_IF_NOT(B->Shape() == TensorShape({3 * hidden_size}),
+                    "Bias is expected to have shape [", 3 * hidden_size, "]");
+  if (mask_index != nullptr) {
+    ORT_RETURN_IF_NOT(mask_index->Shape() == TensorShape({batch_size}),
+                      "Mask index is expected to have shape [", batch_size, "]");
+  }
+
+  Tensor* Y = context->Output(0, X->Shape());
+  if (X->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+
+  // Compute the packed projections [batch, sequence, 3, hidden] with a single
+  // GEMM that accumulates into the broadcast bias.
+  const int64_t M = batch_size * sequence_length;
+  const int64_t qkv_size = 3 * hidden_size;
+  auto qkv_data = alloc->Alloc(sizeof(float) * M * qkv_size);
+  BufferUniquePtr qkv_buffer(qkv_data, BufferDeleter(alloc));
+  float* qkv = static_cast<float*>(qkv_data);
+
+  EigenMatrixMapRowMajor<float>(qkv, M, qkv_size).rowwise() =
+      ConstEigenVectorMap<float>(B->template Data<float>(), qkv_size).transpose();
+
+  if (packed_weights_ != nullptr) {
+    MlasSgemmPacked(CblasNoTrans, static_cast<size_t>(M), static_cast<size_t>(qkv_size),
+                    static_cast<size_t>(hidden_size), 1.0f, X->template Data<float>(),
+                    static_cast<size_t>(hidden_size), packed_weights_.get(), 1.0f, qkv,
+                    static_cast<size_t>(qkv_size));
+  } else {
+    math::Gemm<float, CPUMathUtil>(CblasNoTrans, CblasNoTrans,
+                                   static_cast<int>(M), static_cast<int>(qkv_size), static_cast<int>(hidden_size),
+                                   1.0f, X->template Data<float>(), W->template Data<float>(),
+                                   1.0f, qkv, &CPUMathUtil::Instance());
+  }
+
+  const int32_t* mask_data = (mask_index != nullptr) ? mask_index->template Data<int32_t>() : nullptr;
+  float* y_data = Y->template MutableData<float>();
+
+  const int64_t block_size = std::max(int64_t{1},
+                                      std::min(sequence_length, kScoreBlockBytes / static_cast<int64_t>(sizeof(float)) / sequence_length));
+  const int64_t block_count = (sequence_length + block_size - 1) / block_size;
+  const int64_t task_count = batch_size * num_heads_ * block_count;
+  const float alpha = 1.0f / std::sqrt(static_cast<float>(head_size));
+
+#ifdef USE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<float> scores(block_size * sequence_length);
+
+#ifdef USE_OPENMP
+#pragma omp for
+#endif
+    for (int64_t task = 0; task < task_count; task++) {
+      const int64_t b = task / (num_heads_ * block_count);
+      const int64_t h = (task / block_count) % num_heads_;
+      const int64_t q_start = (task % block_count) * block_size;
+      const int64_t q_count = std::min(block_size, sequence_length - q_start);
+
+      // Only the keys inside of the sequence length of the batch are attended.
+      int64_t kv_length = sequence_length;
+      if (mask_data != nullptr) {
+        kv_length = std::max(int64_t{0}, std::min(sequence_length, static_cast<int64_t>(mask_data[b])));
+      }
+
+      float* y = y_data + (b * sequence_length + q_start) * hidden_size + h * head_size;
+
+      if (kv_length == 0) {
+        for (int64_t i = 0; i < q_count; i++) {
+          std::fill_n(y + i * hidden_size, head_size, 0.0f);
+        }
+        continue;
+      }
+
+      const float* batch_qkv = qkv + b * sequence_length * qkv_size;
+      const float* q = batch_qkv + q_start * qkv_size + h * head_size;
+      const float* k = batch_qkv + hidden_size + h * head_size;
+      const float* v = batch_qkv + 2 * hidden_size + h * head_size;
+
+      // scores = Q K^T / sqrt(head_size)
+      math::GemmEx<float, CPUMathUtil>(CblasNoTrans, CblasTrans,
+                                       static_cast<int>(q_count), static_cast<int>(kv_length), static_cast<int>(head_size),
+                                       alpha, q, static_cast<int>(qkv_size), k, static_cast<int>(qkv_size),
+                                       0.0f, scores.data(), static_cast<int>(kv_length), &CPUMathUtil::Instance());
+
+      MlasComputeSoftmax(scores.data(), scores.data(), static_cast<size_t>(q_count), static_cast<size_t>(kv_length), false);
+
+      // Y = softmax(scores) V
+      math::GemmEx<float, CPUMathUtil>(CblasNoTrans, CblasNoTrans,
+                                       static_cast<int>(q_count), static_cast<int>(head_size), static_cast<int>(kv_length),
+                                       1.0f, scores.data(), static_cast<int>(kv_length), v, static_cast<int>(qkv_size),
+                                       0.0f, y, static_cast<int>(hidden_size), &CPUMathUtil::Instance());
+    }
+  }
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Multi-head self attention. The query, key and value projections are computed
+// with a single GEMM against the packed weights, then softmax(Q K^T) V is
+// evaluated per head in blocks of query rows so that the attention scores of
+// a block stay in the cache. Replaces the subgraph found by the AttentionFusion
+// transformer.
+class Attention final : public OpKernel {
+ public:
+  Attention(const OpKernelInfo& info) : OpKernel(info) {
+    ORT_ENFORCE(info.GetAttr<int64_t>("num_heads", &num_heads_).IsOK() && num_heads_ > 0);
+  }
+
+  Status PrePack(const Tensor& tensor, int input_idx, bool& is_packed) override;
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  int64_t num_heads_;
+
+  // weights packed by MlasSgemmPackB when they are a constant initializer
+  BufferUniquePtr packed_weights_;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,288 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "fused_elementwise.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/util/math_cpuonly.h"
+#include <algorithm>
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    FusedElementwise,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    FusedElementwise);
+
+namespace {
+
+// The number of bytes of scratch buffers used to evaluate one tile. The tile
+// size is chosen so that the buffers for all values of the program stay in the
+// first level cache.
+constexpr size_t kTileBufferBytes = 32 * 1024;
+constexpr int64_t kMinimumTileSize = 64;
+constexpr int64_t kMaximumTileSize = 1024;
+
+// Describes how the elements of an input are read for a tile of the output.
+struct InputView {
+  enum class Kind {
+    Full,       // The input has the output shape, so tiles are read in place.
+    Scalar,     // The input has a single element.
+    Broadcast,  // The input is broadcast and gathered into a scratch buffer.
+  };
+
+  Kind kind;
+  const float* data;
+  std::vector<int64_t> strides;  // Strides in the output dimensions, zero for broadcast dimensions.
+};
+
+// Gathers count elements of a broadcast input starting at the output element
+// offset start.
+void GatherBroadcastInput(const InputView& input, const std::vector<int64_t>& output_dims,
+                          int64_t start, int64_t count, float* buffer) {
+  const size_t rank = output_dims.size();
+  std::vector<int64_t> coordinates(rank);
+  int64_t index = 0;
+  int64_t remainder = start;
+  for (size_t d = rank; d > 0; d--) {
+    coordinates[d - 1] = remainder % output_dims[d - 1];
+    remainder /= output_dims[d - 1];
+    index += coordinates[d - 1] * input.strides[d - 1];
+  }
+
+  for (int64_t i = 0; i < count; i++) {
+    buffer[i] = input.data[index];
+    for (size_t d = rank; d > 0; d--) {
+      index += input.strides[d - 1];
+      if (++coordinates[d - 1] < output_dims[d - 1]) {
+        break;
+      }
+      index -= input.strides[d - 1] * output_dims[d - 1];
+      coordinates[d - 1] = 0;
+    }
+  }
+}
+
+}  // namespace
+
+bool FusedElementwise::TryGetOpCode(const std::string& op_type, OpCode& opcode) {
+  static const std::pair<const char*, OpCode> op_codes[] = {
+      {"Add", OpCode::Add},
+      {"Sub", OpCode::Sub},
+      {"Mul", OpCode::Mul},
+      {"Div", OpCode::Div},
+      {"Relu", OpCode::Relu},
+      {"LeakyRelu", OpCode::LeakyRelu},
+      {"Sigmoid", OpCode::Sigmoid},
+      {"Tanh", OpCode::Tanh},
+      {"Neg", OpCode::Neg},
+      {"Abs", OpCode::Abs},
+      {"Exp", OpCode::Exp},
+      {"Log", OpCode::Log},
+      {"Sqrt", OpCode::Sqrt},
+      {"Reciprocal", OpCode::Reciprocal},
+  };
+
+  for (const auto& op_code : op_codes) {
+    if (op_type == op_code.first) {
+      opcode = op_code.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+FusedElementwise::FusedElementwise(const OpKernelInfo& info) : OpKernel(info) {
+  std::vector<std::string> ops;
+  std::vector<int64_t> operands;
+  ORT_ENFORCE(info.GetAttrs<std::string>("ops", ops).IsOK());
+  ORT_ENFORCE(info.GetAttrs<int64_t>("operands", operands).IsOK());
+  std::vector<float> alphas = info.GetAttrsOrDefault<float>("alphas");
+
+  ORT_ENFORCE(!ops.empty(), "FusedElementwise requires at least one operator.");
+  ORT_ENFORCE(operands.size() == 2 * ops.size(), "FusedElementwise requires two operands per operator.");
+  ORT_ENFORCE(alphas.empty() || alphas.size() == ops.size(), "FusedElementwise requires one alpha per operator.");
+
+  const int64_t input_count = static_cast<int64_t>(info.GetInputCount());
+
+  for (size_t i = 0; i < ops.size(); i++) {
+    Instruction instruction;
+    ORT_ENFORCE(TryGetOpCode(ops[i], instruction.opcode), "Unsupported operator in FusedElementwise: ", ops[i]);
+    instruction.operand0 = operands[2 * i];
+    instruction.operand1 = operands[2 * i + 1];
+    instruction.alpha = alphas.empty() ? 0.0f : alphas[i];
+
+    // An instruction can only read the inputs and the results of the
+    // preceding instructions.
+    const int64_t value_count = input_count + static_cast<int64_t>(i);
+    ORT_ENFORCE(instruction.operand0 >= 0 && instruction.operand0 < value_count,
+                "Invalid FusedElementwise operand ", instruction.operand0);
+    if (IsBinary(instruction.opcode)) {
+      ORT_ENFORCE(instruction.operand1 >= 0 && instruction.operand1 < value_count,
+                  "Invalid FusedElementwise operand ", instruction.operand1);
+    }
+
+    program_.push_back(instruction);
+  }
+}
+
+Status FusedElementwise::Compute(OpKernelContext* context) const {
+  const int input_count = context->InputCount();
+
+  // Compute the multidirectional broadcast of the input shapes.
+  size_t rank = 0;
+  for (int i = 0; i < input_count; i++) {
+    rank = std::max(rank, context->Input<Tensor>(i)->Shape().NumDimensions());
+  }
+
+  std::vector<int64_t> output_dims(rank, 1);
+  for (int i = 0; i < input_count; i++) {
+    const auto& dims = context->Input<Tensor>(i)->Shape().GetDims();
+    const size_t offset = rank - dims.size();
+    for (size_t d = 0; d < dims.size(); d++) {
+      if (dims[d] != 1) {
+        ORT_RETURN_IF_NOT(output_dims[offset + d] == 1 || output_dims[offset + d] == dims[d],
+                          "FusedElementwise inputs cannot be broadcast together.");
+        output_dims[offset + d] = dims[d];
+      }
+    }
+  }
+
+  Tensor* Y = context->Output(0, TensorShape(output_dims));
+  const int64_t output_size = Y->Shape().Size();
+  if (output_size == 0) {
+    return Status::OK();
+  }
+
+  std::vector<InputView> inputs(input_count);
+  for (int i = 0; i < input_count; i++) {
+    const Tensor& X = *context->Input<Tensor>(i);
+    auto& input = inputs[i];
+    input.data = X.template Data<float>();
+    if (X.Shape().Size() == output_size) {
+      input.kind = InputView::Kind::Full;
+    } else if (X.Shape().Size() == 1) {
+      input.kind = InputView::Kind::Scalar;
+    } else {
+      input.kind = InputView::Kind::Broadcast;
+      const auto& dims = X.Shape().GetDims();
+      const size_t offset = rank - dims.size();
+      input.strides.assign(rank, 0);
+      int64_t stride = 1;
+      for (size_t d = dims.size(); d > 0; d--) {
+        if (dims[d - 1] != 1) {
+          input.strides[offset + d - 1] = stride;
+        }
+        stride *= dims[d - 1];
+      }
+    }
+  }
+
+  // Each input and each instruction result has a scratch buffer of one tile.
+  const size_t value_count = inputs.size() + program_.size();
+  int64_t tile_size = static_cast<int64_t>(kTileBufferBytes / sizeof(float) / value_count);
+  tile_size = std::max(kMinimumTileSize, std::min(kMaximumTileSize, tile_size & ~int64_t{15}));
+  const int64_t tile_count = (output_size + tile_size - 1) / tile_size;
+
+  float* output = Y->template MutableData<float>();
+
+#ifdef USE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<float> scratch(value_count * tile_size);
+    std::vector<const float*> values(value_count);
+
+    // Scalar inputs are expanded to a full tile once per thread.
+    for (size_t i = 0; i < inputs.size(); i++) {
+      if (inputs[i].kind == InputView::Kind::Scalar) {
+        std::fill_n(scratch.data() + i * tile_size, tile_size, *inputs[i].data);
+        values[i] = scratch.data() + i * tile_size;
+      }
+    }
+
+#ifdef USE_OPENMP
+#pragma omp for
+#endif
+    for (int64_t tile = 0; tile < tile_count; tile++) {
+      const int64_t start = tile * tile_size;
+      const int64_t count = std::min(tile_size, output_size - start);
+
+      for (size_t i = 0; i < inputs.size(); i++) {
+        const auto& input = inputs[i];
+        if (input.kind == InputView::Kind::Full) {
+          values[i] = input.data + start;
+        } else if (input.kind == InputView::Kind::Broadcast) {
+          float* buffer = scratch.data() + i * tile_size;
+          GatherBroadcastInput(input, output_dims, start, count, buffer);
+          values[i] = buffer;
+        }
+      }
+
+      for (size_t n = 0; n < program_.size(); n++) {
+        const auto& instruction = program_[n];
+        const size_t value_index = inputs.size() + n;
+        float* result = (n + 1 == program_.size()) ? output + start : scratch.data() + value_index * tile_size;
+
+        const float* operand0 = values[instruction.operand0];
+        ConstEigenVectorArrayMap<float> a(operand0, count);
+        EigenVectorArrayMap<float> y(result, count);
+
+        switch (instruction.opcode) {
+          case OpCode::Add:
+            y = a + ConstEigenVectorArrayMap<float>(values[instruction.operand1], count);
+            break;
+          case OpCode::Sub:
+            y = a - ConstEigenVectorArrayMap<float>(values[instruction.operand1], count);
+            break;
+          case OpCode::Mul:
+            y = a * ConstEigenVectorArrayMap<float>(values[instruction.operand1], count);
+            break;
+          case OpCode::Div:
+            y = a / ConstEigenVectorArrayMap<float>(values[instruction.operand1], count);
+            break;
+          case OpCode::Relu:
+            y = a.cwiseMax(0.0f);
+            break;
+          case OpCode::LeakyRelu:
+            y = (a >= 0.0f).select(a, instruction.alpha * a);
+            break;
+          case OpCode::Sigmoid:
+            MlasComputeLogistic(operand0, result, static_cast<size_t>(count));
+            break;
+          case OpCode::Tanh:
+            MlasComputeTanh(operand0, result, static_cast<size_t>(count));
+            break;
+          case OpCode::Neg:
+            y = -a;
+            break;
+          case OpCode::Abs:
+            y = a.abs();
+            break;
+          case OpCode::Exp:
+            y = a.exp();
+            break;
+          case OpCode::Log:
+            y = a.log();
+            break;
+          case OpCode::Sqrt:
+            y = a.sqrt();
+            break;
+          case OpCode::Reciprocal:
+            y = a.inverse();
+            break;
+        }
+
+        values[value_index] = result;
+      }
+    }
+  }
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Evaluates a chain of element-wise operators fused by the ElementwiseFusion
+// transformer. The fused operators are stored as a small program that is
+// interpreted over cache sized tiles of the output, so the intermediate
+// results never need full sized tensors.
+class FusedElementwise final : public OpKernel {
+ public:
+  FusedElementwise(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* context) const override;
+
+  enum class OpCode {
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Relu,
+    LeakyRelu,
+    Sigmoid,
+    Tanh,
+    Neg,
+    Abs,
+    Exp,
+    Log,
+    Sqrt,
+    Reciprocal,
+  };
+
+  // Returns true and the opcode if the operator can be part of a program.
+  static bool TryGetOpCode(const std::string& op_type, OpCode& opcode);
+
+  static bool IsBinary(OpCode opcode) {
+    return opcode == OpCode::Add || opcode == OpCode::Sub || opcode == OpCode::Mul || opcode == OpCode::Div;
+  }
+
+ private:
+  // An instruction reads one or two values and produces a new value. Values
+  // are numbered with the inputs first, followed by the result of each
+  // instruction in program order. The last instruction produces the output.
+  struct Instruction {
+    OpCode opcode;
+    int64_t operand0;
+    int64_t operand1;
+    float alpha;
+  };
+
+  std::vector<Instruction> program_;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
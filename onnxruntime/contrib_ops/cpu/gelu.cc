@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gelu.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/util/math_cpuonly.h"
+#include <algorithm>
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    Gelu,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    Gelu);
+
+Status Gelu::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  Tensor* Y = context->Output(0, X->Shape());
+
+  const float* x_data = X->template Data<float>();
+  float* y_data = Y->template MutableData<float>();
+  const int64_t size = X->Shape().Size();
+
+  // Process the tensor in blocks that stay in the cache between the passes.
+  constexpr int64_t block_size = 4096;
+  const int64_t block_count = (size + block_size - 1) / block_size;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int64_t block = 0; block < block_count; ++block) {
+    const int64_t offset = block * block_size;
+    const int64_t count = std::min(block_size, size - offset);
+
+    ConstEigenVectorArrayMap<float> x(x_data + offset, count);
+    EigenVectorArrayMap<float> y(y_data + offset, count);
+
+    y = x * 0.70710678118654752440f;
+    MlasComputeErf(y.data(), y.data(), static_cast<size_t>(count));
+    y = 0.5f * x * (y + 1.0f);
+  }
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Computes the Gaussian Error Linear Unit, Y = 0.5 * X * (1 + erf(X / sqrt(2))).
+// Replaces the expanded subgraph found by the GeluFusion transformer.
+class Gelu final : public OpKernel {
+ public:
+  Gelu(const OpKernelInfo& info) : OpKernel(info) {
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "layer_norm.h"
+#include "core/providers/common.h"
+#include "core/util/math_cpuonly.h"
+#include <cmath>
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    LayerNormalization,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    LayerNormalization);
+
+Status LayerNormalization::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  const Tensor* scale = context->Input<Tensor>(1);
+  const Tensor* bias = context->Input<Tensor>(2);
+
+  const TensorShape& x_shape = X->Shape();
+  const int64_t axis = HandleNegativeAxis(axis_, x_shape.NumDimensions());
+  const int64_t norm_count = x_shape.SizeToDimension(axis);
+  const int64_t norm_size = x_shape.SizeFromDimension(axis);
+
+  ORT_RETURN_IF_NOT(scale->Shape().Size() == norm_size, "Size of scale must match the normalized size ", norm_size);
+  ORT_RETURN_IF_NOT(bias->Shape().Size() == norm_size, "Size of bias must match the normalized size ", norm_size);
+
+  Tensor* Y = context->Output(0, x_shape);
+  if (norm_size == 0) {
+    return Status::OK();
+  }
+
+  const float* x_data = X->template Data<float>();
+  float* y_data = Y->template MutableData<float>();
+  ConstEigenVectorArrayMap<float> scale_vec(scale->template Data<float>(), norm_size);
+  ConstEigenVectorArrayMap<float> bias_vec(bias->template Data<float>(), norm_size);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int64_t i = 0; i < norm_count; ++i) {
+    ConstEigenVectorArrayMap<float> x(x_data + i * norm_size, norm_size);
+    EigenVectorArrayMap<float> y(y_data + i * norm_size, norm_size);
+
+    // Center the input into the output and compute the variance from the
+    // centered values. Computing it as E[x^2] - E[x]^2 loses precision to
+    // cancellation when the mean is large relative to the deviation.
+    const float mean = x.sum() / norm_size;
+    y = x - mean;
+    const float variance = y.square().sum() / norm_size;
+    const float inv_std = 1.0f / std::sqrt(variance + epsilon_);
+
+    y = y * (inv_std * scale_vec) + bias_vec;
+  }
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Normalizes each slice of the input that starts at axis to zero mean and unit
+// variance, then applies the scale and bias. Replaces the expanded subgraph
+// found by the LayerNormFusion transformer.
+class LayerNormalization final : public OpKernel {
+ public:
+  LayerNormalization(const OpKernelInfo& info) : OpKernel(info) {
+    axis_ = info.GetAttrOrDefault<int64_t>("axis", -1);
+    epsilon_ = info.GetAttrOrDefault<float>("epsilon", 1e-5f);
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  int64_t axis_;
+  float epsilon_;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
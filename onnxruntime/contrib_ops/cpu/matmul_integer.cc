@@ -8,11 +8,62 @@
 
 #include "contrib_ops/cpu/matmul_integer.h"
 #include "core/providers/cpu/math/matmul_helper.h"
-#include "core/util/gemmlowp_common_wrapper.h"
+#include "core/mlas/inc/mlas.h"
 
 namespace onnxruntime {
 namespace contrib {
 
+template <>
+MatMulInteger<uint8_t, uint8_t, int32_t>::MatMulInteger(const OpKernelInfo& info) : OpKernel(info) {
+  has_a_zero_point_ = false;
+  has_b_zero_point_ = false;
+  if (info.GetInputCount() > 2) {
+    has_a_zero_point_ = true;
+  }
+  if (info.GetInputCount() > 3) {
+    has_b_zero_point_ = true;
+  }
+}
+
+template <>
+Status MatMulInteger<uint8_t, uint8_t, int32_t>::PrePack(const Tensor& tensor, int input_idx, bool& is_packed) {
+  is_packed = false;
+
+  // only pack matrix B when it's a 2D initializer, so that every batch of
+  // matrix A multiplies the same matrix B.
+  if (input_idx != 1 || tensor.Shape().NumDimensions() != 2) {
+    return Status::OK();
+  }
+
+  // the zero point of matrix B is applied as the matrix is packed, so it must
+  // also be a constant initializer.
+  uint8_t b_offset = 0;
+  if (has_b_zero_point_) {
+    const Tensor* b_zero_point;
+    if (!Info().TryGetConstantInput(3, &b_zero_point) || b_zero_point->Shape().Size() != 1) {
+      return Status::OK();
+    }
+    b_offset = *b_zero_point->template Data<uint8_t>();
+  }
+
+  const size_t K = static_cast<size_t>(tensor.Shape()[0]);
+  const size_t N = static_cast<size_t>(tensor.Shape()[1]);
+
+  const size_t packed_b_size = MlasQgemmPackBSize(N, K);
+  if (packed_b_size == 0) {
+    return Status::OK();
+  }
+
+  auto alloc = Info().GetAllocator(0, OrtMemTypeDefault);
+  auto packed_b_data = alloc->Alloc(packed_b_size);
+  packed_b_ = BufferUniquePtr(packed_b_data, BufferDeleter(alloc));
+
+  MlasQgemmPackB(N, K, tensor.template Data<uint8_t>(), N, b_offset, packed_b_data);
+
+  is_packed = true;
+  return Status::OK();
+}
+
 // only register this operator if low precision computation is enabled.
 ONNX_OPERATOR_KERNEL_EX(
     MatMulInteger,
@@ -25,24 +76,6 @@ ONNX_OPERATOR_KERNEL_EX(
         .TypeConstraint("T3", DataTypeImpl::GetTensorType<int32_t>()),
     MatMulInteger<uint8_t, uint8_t, int32_t>);
 
-Status GemmlowpMultiply(const uint8_t* lhs_data, const uint8_t* rhs_data,
-                        int32_t* result_data, const int lhs_offset, const int rhs_offset,
-                        int m, int n, int k) {
-  const std::tuple<> empty_pipeline = {};
-  // TODO exp ColMajor order for rhs and result. That may be faster
-  const auto matOrder = gemmlowp::MapOrder::RowMajor;
-  gemmlowp::MatrixMap<const std::uint8_t, matOrder> lhs(lhs_data, m, k);
-  gemmlowp::MatrixMap<const std::uint8_t, matOrder> rhs(rhs_data, k, n);
-  gemmlowp::MatrixMap<std::int32_t, matOrder> result(result_data, m, n);
-
-  gemmlowp::GemmContext gemm_context;
-  gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::int32_t,
-                                   gemmlowp::DefaultL8R8BitDepthParams>(
-      &gemm_context, lhs, rhs, &result, -lhs_offset, -rhs_offset, empty_pipeline);
-
-  return Status::OK();
-}
-
 template<>
 Status MatMulInteger<uint8_t, uint8_t, int32_t>::Compute(OpKernelContext* ctx) const {
   auto a = ctx->Input<Tensor>(0);
@@ -71,15 +104,20 @@ Status MatMulInteger<uint8_t, uint8_t, int32_t>::Compute(OpKernelContext* ctx) c
     b_offset = static_cast<int32_t>(*b_zero_point->template Data<uint8_t>());
   }
 
-  for (int i = 0; i < helper.OutputOffsets().size(); i++) {
-    GemmlowpMultiply(a->template Data<uint8_t>() + helper.LeftOffsets()[i],
-                     b->template Data<uint8_t>() + helper.RightOffsets()[i],
-                     y->template MutableData<int32_t>() + helper.OutputOffsets()[i],
-                     a_offset,
-                     b_offset,
-                     static_cast<int>(helper.M()),
-                     static_cast<int>(helper.N()),
-                     static_cast<int>(helper.K()));
+  const size_t M = static_cast<size_t>(helper.M());
+  const size_t N = static_cast<size_t>(helper.N());
+  const size_t K = static_cast<size_t>(helper.K());
+
+  for (size_t i = 0; i < helper.OutputOffsets().size(); i++) {
+    const uint8_t* a_data = a->template Data<uint8_t>() + helper.LeftOffsets()[i];
+    int32_t* y_data = y->template MutableData<int32_t>() + helper.OutputOffsets()[i];
+    if (packed_b_ != nullptr) {
+      MlasQgemmPacked(M, N, K, a_data, K, static_cast<uint8_t>(a_offset), packed_b_.get(), y_data, N);
+    } else {
+      MlasQgemm(M, N, K, a_data, K, static_cast<uint8_t>(a_offset),
+                b->template Data<uint8_t>() + helper.RightOffsets()[i], N, static_cast<uint8_t>(b_offset),
+                y_data, N);
+    }
   }
 
   return Status::OK();
@@ -13,22 +13,19 @@ namespace contrib {
 template <typename T1, typename T2, typename T3>
 class MatMulInteger final : public OpKernel {
  public:
-  MatMulInteger(const OpKernelInfo& info) : OpKernel(info) {
-    has_a_zero_point_ = false;
-    has_b_zero_point_ = false;
-    if (info.GetInputCount() > 2) {
-      has_a_zero_point_ = true;      
-    }
-    if (info.GetInputCount() > 3) {
-      has_b_zero_point_ = true;
-    }
-  }
+  MatMulInteger(const OpKernelInfo& info);
+
+  Status PrePack(const Tensor& tensor, int input_idx, bool& is_packed) override;
 
   Status Compute(OpKernelContext* context) const override;
 
  private:
   bool has_a_zero_point_;
   bool has_b_zero_point_;
+
+  // matrix B packed by MlasQgemmPackB when it and its zero point are constant
+  // initializers
+  BufferUniquePtr packed_b_;
 };
 }  // namespace contrib
-}  // namespace onnxruntime
\ No newline at end of file
+}  // namespace onnxruntime
@@ -0,0 +1,204 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "nchwc_ops.h"
+#include "core/mlas/inc/mlas.h"
+#include <algorithm>
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    ReorderInput,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    ReorderInput);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    ReorderOutput,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    ReorderOutput);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NchwcConv,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NchwcConv);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NchwcMaxPool,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NchwcMaxPool);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NchwcAveragePool,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NchwcAveragePool);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NchwcGlobalMaxPool,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NchwcMaxPool);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NchwcGlobalAveragePool,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NchwcAveragePool);
+
+static Status ValidateNchwcShape(const TensorShape& shape) {
+  if (shape.NumDimensions() != 4) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "NCHWc tensors must have 4 dimensions: ", shape.ToString());
+  }
+  if (shape[1] % static_cast<int64_t>(MlasNchwcGetBlockSize()) != 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "NCHWc channel count must be a multiple of the block size: ",
+                           shape.ToString());
+  }
+  return Status::OK();
+}
+
+Status ReorderInput::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  const TensorShape& X_shape = X->Shape();
+  ORT_RETURN_IF_ERROR(ValidateNchwcShape(X_shape));
+
+  Tensor* Y = context->Output(0, X_shape);
+  MlasReorderInput(X_shape.GetDims().data(), X->template Data<float>(), Y->template MutableData<float>());
+
+  return Status::OK();
+}
+
+Status ReorderOutput::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  const TensorShape& X_shape = X->Shape();
+  ORT_RETURN_IF_ERROR(ValidateNchwcShape(X_shape));
+
+  Tensor* Y = context->Output(0, X_shape);
+  MlasReorderOutput(X_shape.GetDims().data(), X->template Data<float>(), Y->template MutableData<float>());
+
+  return Status::OK();
+}
+
+Status NchwcConv::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  const Tensor* W = context->Input<Tensor>(1);
+  const Tensor* B = context->Input<Tensor>(2);
+  const Tensor* Sum = context->Input<Tensor>(3);
+
+  ORT_RETURN_IF_ERROR(ValidateInputShape(X, W));
+
+  const TensorShape& X_shape = X->Shape();
+  const TensorShape& W_shape = W->Shape();
+  ORT_RETURN_IF_NOT(X_shape.NumDimensions() == 4, "NchwcConv only supports 2D convolutions.");
+
+  std::vector<int64_t> kernel_shape;
+  ORT_RETURN_IF_ERROR(ComputeKernelShape(W_shape, kernel_shape));
+
+  std::vector<int64_t> pads(pads_);
+  if (pads.empty()) {
+    pads.resize(kernel_shape.size() * 2, 0);
+  }
+  std::vector<int64_t> dilations(dilations_);
+  if (dilations.empty()) {
+    dilations.resize(kernel_shape.size(), 1);
+  }
+  std::vector<int64_t> strides(strides_);
+  if (strides.empty()) {
+    strides.resize(kernel_shape.size(), 1);
+  }
+
+  std::vector<int64_t> Y_dims({X_shape[0], W_shape[0]});
+  TensorShape input_shape = X_shape.Slice(2);
+  ORT_RETURN_IF_ERROR(InferOutputShape(input_shape, kernel_shape, strides, dilations, &pads, &Y_dims));
+  Tensor* Y = context->Output(0, TensorShape(Y_dims));
+  float* Ydata = Y->template MutableData<float>();
+
+  // The Sum tensor is accumulated into by the convolution, so start from a
+  // copy of it in the output buffer.
+  bool ZeroMode = true;
+  if (Sum != nullptr) {
+    ORT_RETURN_IF_NOT(Sum->Shape() == Y->Shape(), "NchwcConv Sum input does not match the output shape.");
+    const float* Sumdata = Sum->template Data<float>();
+    if (Sumdata != Ydata) {
+      std::copy_n(Sumdata, Y->Shape().Size(), Ydata);
+    }
+    ZeroMode = false;
+  }
+
+  MLAS_ACTIVATION Activation;
+  if (activation_.empty()) {
+    Activation.ActivationKind = MlasIdentityActivation;
+  } else if (activation_ == "Relu") {
+    Activation.ActivationKind = MlasReluActivation;
+  } else if (activation_ == "LeakyRelu") {
+    Activation.ActivationKind = MlasLeakyReluActivation;
+    Activation.alpha = alpha_;
+  } else if (activation_ == "Tanh") {
+    Activation.ActivationKind = MlasTanhActivation;
+  } else if (activation_ == "Sigmoid") {
+    Activation.ActivationKind = MlasLogisticActivation;
+  } else {
+    ORT_NOT_IMPLEMENTED("Not implemented fused activation: ", activation_);
+  }
+
+  MlasNchwcConv(X_shape.GetDims().data(),
+                kernel_shape.data(),
+                dilations.data(),
+                pads.data(),
+                strides.data(),
+                Y_dims.data(),
+                static_cast<size_t>(group_),
+                X->template Data<float>(),
+                W->template Data<float>(),
+                B != nullptr ? B->template Data<float>() : nullptr,
+                Ydata,
+                &Activation,
+                ZeroMode);
+
+  return Status::OK();
+}
+
+Status NchwcPool::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  const TensorShape& X_shape = X->Shape();
+  ORT_RETURN_IF_ERROR(ValidateNchwcShape(X_shape));
+  if (!global_pooling_) {
+    ORT_RETURN_IF_NOT(kernel_shape_.size() == 2, "kernel_shape num_dims is not compatible with X num_dims.");
+  }
+
+  std::vector<int64_t> pads = pads_;
+  std::vector<int64_t> output_dims = PoolBase::SetOutputSize(X_shape, X_shape[1], &pads);
+  Tensor* Y = context->Output(0, TensorShape(output_dims));
+
+  MlasNchwcPool(kind_,
+                X_shape.GetDims().data(),
+                global_pooling_ ? nullptr : kernel_shape_.data(),
+                global_pooling_ ? nullptr : pads.data(),
+                global_pooling_ ? nullptr : strides_.data(),
+                output_dims.data(),
+                X->template Data<float>(),
+                Y->template MutableData<float>());
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
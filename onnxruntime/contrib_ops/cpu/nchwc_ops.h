@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+#include "core/providers/cpu/nn/conv_base.h"
+#include "core/providers/cpu/nn/pool_base.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Kernels for tensors stored in the NCHWc layout used by the MLAS NCHWc
+// convolution and pooling routines. These operators are inserted by the
+// NchwcTransformer and are not intended to appear in models directly.
+
+class ReorderInput : public OpKernel {
+ public:
+  ReorderInput(const OpKernelInfo& info) : OpKernel(info) {
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+class ReorderOutput : public OpKernel {
+ public:
+  ReorderOutput(const OpKernelInfo& info) : OpKernel(info) {
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+class NchwcConv : public OpKernel, public ConvBase {
+ public:
+  NchwcConv(const OpKernelInfo& info) : OpKernel(info), ConvBase(info) {
+    activation_ = info.GetAttrOrDefault<std::string>("activation", "");
+    alpha_ = info.GetAttrOrDefault("alpha", 0.01f);
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+class NchwcPool : public OpKernel, public PoolBase {
+ public:
+  NchwcPool(const OpKernelInfo& info, MLAS_POOLING_KIND kind) : OpKernel(info), PoolBase(info), kind_(kind) {
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  MLAS_POOLING_KIND kind_;
+};
+
+class NchwcMaxPool : public NchwcPool {
+ public:
+  NchwcMaxPool(const OpKernelInfo& info) : NchwcPool(info, MlasMaximumPooling) {
+  }
+};
+
+class NchwcAveragePool : public NchwcPool {
+ public:
+  NchwcAveragePool(const OpKernelInfo& info)
+      : NchwcPool(info, info.GetAttrOrDefault<int64_t>("count_include_pad", 0) != 0
+                            ? MlasAveragePoolingIncludePad
+                            : MlasAveragePoolingExcludePad) {
+  }
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -138,6 +138,9 @@ class TaskThreadPool {
     condition_.notify_one();
   }
 
+  /// @brief Number of threads in the pool.
+  std::size_t NumThreads() const { return total_; }
+
   /// @brief Wait for queue to be empty
   void WaitWorkComplete() {
     std::unique_lock<OrtMutex> lock(mutex_);
@@ -14,6 +14,11 @@ struct DeviceAllocatorRegistrationInfo {
   OrtMemType mem_type;
   DeviceAllocatorFactory factory;
   size_t max_mem;
+  // serve small allocations from per-thread caches in front of the arena. see BFCArena.
+  // off by default as it only pays off for allocators used from many threads, such as the CPU one.
+  bool enable_thread_cache = false;
+  // when the arena returns unused memory to the device allocator.
+  ArenaShrinkOptions shrink_options;
 };
 
 AllocatorPtr CreateAllocator(DeviceAllocatorRegistrationInfo info, int device_id = 0);
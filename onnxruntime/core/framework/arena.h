@@ -3,12 +3,25 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
 
 #include "core/common/common.h"
 #include "core/framework/allocator.h"
 
 namespace onnxruntime {
+// Controls when an arena returns regions that are entirely free back to the device allocator.
+// By default memory is kept until the arena is destroyed.
+struct ArenaShrinkOptions {
+  // after a Free, release free regions while the memory held by the arena exceeds this many bytes. 0 disables.
+  size_t high_watermark_bytes = 0;
+
+  // release regions that have been entirely free for at least this long. evaluated on Free. 0 disables.
+  std::chrono::milliseconds max_idle_time{0};
+
+  bool Enabled() const { return high_watermark_bytes > 0 || max_idle_time.count() > 0; }
+};
+
 // The interface for arena which manage memory allocations
 // Arena will hold a pool of pre-allocate memories and manage their lifecycle.
 // Need an underline IResourceAllocator to allocate memories.
@@ -27,6 +40,9 @@ class IArenaAllocator : public IAllocator {
   virtual size_t Used() const = 0;
   virtual size_t Max() const = 0;
   const OrtAllocatorInfo& Info() const override = 0;
+  // Return memory that is not in use to the device allocator. Thread safe.
+  // Returns the number of bytes released.
+  virtual size_t Shrink() { return 0; }
   // allocate host pinned memory?
 };
 
@@ -3,14 +3,64 @@
 
 #include "core/framework/bfc_arena.h"
 
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+
 namespace onnxruntime {
+static std::atomic<uint64_t> next_arena_id{1};
+
+// arenas with thread caches by id, so a thread that exits can find the arenas it holds caches for that are still
+// alive. never destroyed, as threads can exit during static destruction.
+static OrtMutex& ArenaRegistryMutex() {
+  static auto* mutex = new OrtMutex();
+  return *mutex;
+}
+
+static std::unordered_map<uint64_t, BFCArena*>& ArenaRegistry() {
+  static auto* registry = new std::unordered_map<uint64_t, BFCArena*>();
+  return *registry;
+}
+
+struct BFCArena::ThreadLocalCaches {
+  // most threads only use one arena, so check the last one used before the map lookup.
+  // only accessed by the owning thread. arena ids are never reused, so a destroyed arena's id can't match.
+  uint64_t last_arena_id = 0;
+  ThreadCache* last_cache = nullptr;
+
+  // guards caches, as an arena being destroyed erases its entry from the thread local storage of every thread
+  // holding a cache for it. lock order is the registry mutex, then this, then the arena's lock_.
+  OrtMutex mutex;
+  std::unordered_map<uint64_t, ThreadCache*> caches;
+
+  ~ThreadLocalCaches() {
+    // hold the registry lock so the arena can't be destroyed while its cache is released
+    std::lock_guard<OrtMutex> lock(ArenaRegistryMutex());
+    std::lock_guard<OrtMutex> caches_lock(mutex);
+    auto& registry = ArenaRegistry();
+    for (const auto& entry : caches) {
+      auto arena = registry.find(entry.first);
+      if (arena != registry.end()) {
+        arena->second->ReleaseThreadCache(entry.second);
+      }
+    }
+  }
+};
+
 BFCArena::BFCArena(std::unique_ptr<IDeviceAllocator> resource_allocator,
-                   size_t total_memory)
-    : device_allocator_(std::move(resource_allocator)),
+                   size_t total_memory,
+                   bool enable_thread_cache,
+                   const ArenaShrinkOptions& shrink_options)
+    : shrink_options_(shrink_options),
+      device_allocator_(std::move(resource_allocator)),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1),
-      info_(device_allocator_->Info().name, OrtAllocatorType::OrtArenaAllocator, device_allocator_->Info().id, device_allocator_->Info().mem_type) {
+      info_(device_allocator_->Info().name, OrtAllocatorType::OrtArenaAllocator, device_allocator_->Info().id, device_allocator_->Info().mem_type),
+      enable_thread_cache_(enable_thread_cache),
+      arena_id_(next_arena_id++) {
   curr_region_allocation_bytes_ = RoundedBytes(std::min(total_memory, size_t{1048576}));
+  initial_region_allocation_bytes_ = curr_region_allocation_bytes_;
 
   // Allocate the requested amount of memory.
   memory_limit_ = total_memory;
@@ -32,9 +82,33 @@ BFCArena::BFCArena(std::unique_ptr<IDeviceAllocator> resource_allocator,
       ORT_ENFORCE(BinForSize(bin_size * 2) != BinFromIndex(b));
     }
   }
+
+  if (enable_thread_cache_) {
+    std::lock_guard<OrtMutex> lock(ArenaRegistryMutex());
+    ArenaRegistry()[arena_id_] = this;
+  }
 }
 
 BFCArena::~BFCArena() {
+  if (enable_thread_cache_) {
+    std::lock_guard<OrtMutex> lock(ArenaRegistryMutex());
+    ArenaRegistry().erase(arena_id_);
+
+    // threads that exited released their caches under the registry lock, so the owners of the remaining caches
+    // are alive. erase this arena from them so long lived threads don't collect entries for every arena they used.
+    for (const auto& cache : thread_caches_) {
+      std::lock_guard<OrtMutex> caches_lock(cache->owner->mutex);
+      cache->owner->caches.erase(arena_id_);
+    }
+
+    for (const auto& slab : slabs_) {
+      const char* begin = slab.begin.load(std::memory_order_relaxed);
+      if (begin != nullptr) {
+        device_allocator_->Free(const_cast<char*>(begin));
+      }
+    }
+  }
+
   for (const auto& region : region_manager_.regions()) {
     device_allocator_->Free(region.ptr());
   }
@@ -132,6 +206,94 @@ bool BFCArena::Extend(size_t rounded_bytes) {
   return true;
 }
 
+bool BFCArena::IsRegionFree(const AllocationRegion& region) {
+  ChunkHandle h = region_manager_.get_handle(region.ptr());
+  if (h == kInvalidChunkHandle) {
+    return false;
+  }
+
+  // free neighbours are always coalesced, so a free region is a single free chunk covering it
+  const Chunk* c = ChunkFromHandle(h);
+  return !c->in_use() && c->size == region.memory_size();
+}
+
+size_t BFCArena::ReleaseRegion(void* region_ptr) {
+  ChunkHandle h = region_manager_.get_handle(region_ptr);
+  size_t bytes = ChunkFromHandle(h)->size;
+
+  RemoveFreeChunkFromBin(h);
+  DeleteChunk(h);
+  region_manager_.RemoveAllocationRegion(region_ptr);
+  free_regions_.erase(region_ptr);
+  device_allocator_->Free(region_ptr);
+
+  stats_.total_allocated_bytes -= bytes;
+  ++stats_.num_regions_released;
+
+  // don't let the next Extend allocate a region as large as the one that was released
+  curr_region_allocation_bytes_ = initial_region_allocation_bytes_;
+
+  LOGS_DEFAULT(INFO) << "Released region of " << bytes << " bytes at " << region_ptr
+                     << ". Total allocated bytes: " << stats_.total_allocated_bytes;
+  return bytes;
+}
+
+size_t BFCArena::Shrink() {
+  std::lock_guard<OrtMutex> lock(lock_);
+
+  std::vector<void*> free_regions;
+  for (const auto& region : region_manager_.regions()) {
+    if (IsRegionFree(region)) {
+      free_regions.push_back(region.ptr());
+    }
+  }
+
+  size_t bytes = 0;
+  for (void* region_ptr : free_regions) {
+    bytes += ReleaseRegion(region_ptr);
+  }
+
+  return bytes;
+}
+
+void BFCArena::ShrinkIfNeeded(bool idle_only) {
+  if (free_regions_.empty()) {
+    return;
+  }
+
+  // largest first, so the fewest regions are released to get under the watermark
+  std::vector<std::pair<size_t, void*>> free_regions;
+  const auto now = std::chrono::steady_clock::now();
+  for (auto entry = free_regions_.begin(); entry != free_regions_.end();) {
+    const auto* region = region_manager_.RegionFor(entry->first);
+    if (!IsRegionFree(*region)) {
+      entry = free_regions_.erase(entry);
+      continue;
+    }
+
+    if (shrink_options_.max_idle_time.count() > 0 && now - entry->second >= shrink_options_.max_idle_time) {
+      free_regions.emplace_back(std::numeric_limits<size_t>::max(), region->ptr());  // always released
+    } else if (!idle_only) {
+      free_regions.emplace_back(region->memory_size(), region->ptr());
+    }
+
+    ++entry;
+  }
+
+  std::sort(free_regions.begin(), free_regions.end(), std::greater<std::pair<size_t, void*>>());
+
+  for (const auto& free_region : free_regions) {
+    const bool idle = free_region.first == std::numeric_limits<size_t>::max();
+    const bool above_watermark = shrink_options_.high_watermark_bytes > 0 &&
+                                 static_cast<size_t>(stats_.total_allocated_bytes) > shrink_options_.high_watermark_bytes;
+    if (!idle && !above_watermark) {
+      break;
+    }
+
+    ReleaseRegion(free_region.second);
+  }
+}
+
 BFCArena::ChunkHandle BFCArena::AllocateChunk() {
   if (free_chunks_list_ != kInvalidChunkHandle) {
     ChunkHandle h = free_chunks_list_;
@@ -180,6 +342,12 @@ void* BFCArena::Reserve(size_t size) {
 }
 
 size_t BFCArena::RequestedSize(const void* ptr) {
+  // the requested size of a thread cache block isn't tracked
+  int slab_index = SlabIndexFor(ptr);
+  if (slab_index >= 0) {
+    return kMinAllocationSize << slabs_[slab_index].size_class.load(std::memory_order_relaxed);
+  }
+
   std::lock_guard<OrtMutex> lock(lock_);
   BFCArena::ChunkHandle h = region_manager_.get_handle(ptr);
   ORT_ENFORCE(h != kInvalidChunkHandle);
@@ -188,6 +356,11 @@ size_t BFCArena::RequestedSize(const void* ptr) {
 }
 
 size_t BFCArena::AllocatedSize(const void* ptr) {
+  int slab_index = SlabIndexFor(ptr);
+  if (slab_index >= 0) {
+    return kMinAllocationSize << slabs_[slab_index].size_class.load(std::memory_order_relaxed);
+  }
+
   std::lock_guard<OrtMutex> lock(lock_);
   BFCArena::ChunkHandle h = region_manager_.get_handle(ptr);
   ORT_ENFORCE(h != kInvalidChunkHandle);
@@ -206,10 +379,23 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
+  if (enable_thread_cache_ && rounded_bytes <= kMaxCachedSize) {
+    void* ptr = AllocFromThreadCache(rounded_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
   std::lock_guard<OrtMutex> lock(lock_);
+
+  // a Free may not happen for a long time, so idle regions are also released here
+  if (shrink_options_.max_idle_time.count() > 0) {
+    ShrinkIfNeeded(/*idle_only*/ true);
+  }
+
   void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
   if (ptr != nullptr) {
     return ptr;
@@ -238,6 +424,218 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
 void BFCArena::GetStats(AllocatorStats* stats) {
   std::lock_guard<OrtMutex> lock(lock_);
   *stats = stats_;
+  stats->num_regions = static_cast<int64_t>(region_manager_.regions().size() + num_slabs_);
+  stats->num_thread_caches = static_cast<int64_t>(thread_caches_.size());
+
+  if (!enable_thread_cache_) {
+    return;
+  }
+
+  int64_t cache_num_allocs = released_cache_num_allocs_;
+  int64_t cache_bytes_in_use = released_cache_bytes_in_use_;
+  stats->num_thread_cache_hits = released_cache_hits_;
+  stats->num_thread_cache_misses = released_cache_misses_;
+  for (const auto& cache : thread_caches_) {
+    stats->num_thread_cache_hits += cache->hits.load(std::memory_order_relaxed);
+    stats->num_thread_cache_misses += cache->misses.load(std::memory_order_relaxed);
+    cache_num_allocs += cache->num_allocs.load(std::memory_order_relaxed);
+    cache_bytes_in_use += cache->bytes_in_use.load(std::memory_order_relaxed);
+  }
+
+  const int64_t slab_bytes = static_cast<int64_t>(num_slabs_ * kSlabSize);
+  stats->num_allocs += cache_num_allocs;
+  stats->bytes_in_use += cache_bytes_in_use;
+  stats->bytes_in_thread_caches = slab_bytes - cache_bytes_in_use;
+}
+
+BFCArena::ThreadCache& BFCArena::GetThreadCache() {
+  static thread_local ThreadLocalCaches tls;
+
+  if (tls.last_arena_id == arena_id_) {
+    return *tls.last_cache;
+  }
+
+  ThreadCache* cache;
+  std::lock_guard<OrtMutex> caches_lock(tls.mutex);
+  auto entry = tls.caches.find(arena_id_);
+  if (entry != tls.caches.end()) {
+    cache = entry->second;
+  } else {
+    // the arena owns the caches so the cached blocks stay valid until the thread exits or the arena is destroyed
+    std::lock_guard<OrtMutex> lock(lock_);
+    thread_caches_.push_back(std::make_unique<ThreadCache>());
+    cache = thread_caches_.back().get();
+    cache->owner = &tls;
+    tls.caches[arena_id_] = cache;
+  }
+
+  tls.last_arena_id = arena_id_;
+  tls.last_cache = cache;
+  return *cache;
+}
+
+void BFCArena::ReleaseThreadCache(ThreadCache* cache) {
+  std::lock_guard<OrtMutex> lock(lock_);
+  for (int size_class = 0; size_class < kNumCachedClasses; ++size_class) {
+    for (int i = 0; i < cache->num_blocks[size_class]; ++i) {
+      PushSharedBlock(size_class, cache->blocks[size_class][i]);
+    }
+  }
+
+  released_cache_hits_ += cache->hits.load(std::memory_order_relaxed);
+  released_cache_misses_ += cache->misses.load(std::memory_order_relaxed);
+  released_cache_bytes_in_use_ += cache->bytes_in_use.load(std::memory_order_relaxed);
+  released_cache_num_allocs_ += cache->num_allocs.load(std::memory_order_relaxed);
+
+  auto entry = std::find_if(thread_caches_.begin(), thread_caches_.end(),
+                            [cache](const std::unique_ptr<ThreadCache>& c) { return c.get() == cache; });
+  if (entry != thread_caches_.end()) {
+    thread_caches_.erase(entry);
+  }
+}
+
+void* BFCArena::AllocFromThreadCache(size_t rounded_bytes) {
+  // smallest power of two size class that fits rounded_bytes
+  const int size_class = rounded_bytes <= kMinAllocationSize
+                             ? 0
+                             : Log2FloorNonZero((rounded_bytes - 1) >> kMinAllocationBits) + 1;
+
+  ThreadCache& cache = GetThreadCache();
+  int& num_blocks = cache.num_blocks[size_class];
+  if (num_blocks == 0) {
+    cache.misses.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<OrtMutex> lock(lock_);
+    RefillThreadCache(cache, size_class);
+    if (num_blocks == 0) {
+      return nullptr;  // out of slabs. fall back to the arena
+    }
+  } else {
+    cache.hits.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  cache.num_allocs.fetch_add(1, std::memory_order_relaxed);
+  cache.bytes_in_use.fetch_add(static_cast<int64_t>(kMinAllocationSize << size_class), std::memory_order_relaxed);
+  return cache.blocks[size_class][--num_blocks];
+}
+
+bool BFCArena::FreeToThreadCache(void* p) {
+  const int slab_index = SlabIndexFor(p);
+  if (slab_index < 0) {
+    return false;
+  }
+
+  // the slab can't be released while p is in use, so its size class is stable
+  const int size_class = slabs_[slab_index].size_class.load(std::memory_order_relaxed);
+  ThreadCache& cache = GetThreadCache();
+  int& num_blocks = cache.num_blocks[size_class];
+  if (num_blocks == kThreadCacheCapacity) {
+    // return a batch to the shared free list so other threads can use them
+    std::lock_guard<OrtMutex> lock(lock_);
+    for (int i = 0; i < kTransferBatchSize; ++i) {
+      PushSharedBlock(size_class, cache.blocks[size_class][--num_blocks]);
+    }
+  }
+
+  cache.blocks[size_class][num_blocks++] = p;
+  cache.bytes_in_use.fetch_sub(static_cast<int64_t>(kMinAllocationSize << size_class), std::memory_order_relaxed);
+  return true;
+}
+
+int BFCArena::SlabIndexFor(const void* p) const {
+  // a slab containing p can't be released or replaced concurrently, as p is a block in use. a slot being
+  // written concurrently holds a slab that doesn't contain p.
+  const char* ptr = static_cast<const char*>(p);
+  const size_t num_slots = num_slab_slots_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < num_slots; ++i) {
+    const char* begin = slabs_[i].begin.load(std::memory_order_acquire);
+    if (begin != nullptr && ptr >= begin && ptr < begin + kSlabSize) {
+      return static_cast<int>(i);
+    }
+  }
+
+  return -1;
+}
+
+void BFCArena::RefillThreadCache(ThreadCache& cache, int size_class) {
+  auto& shared = shared_free_blocks_[size_class];
+  if (shared.empty()) {
+    CarveSlab(size_class);
+  }
+
+  int& num_blocks = cache.num_blocks[size_class];
+  while (!shared.empty() && num_blocks < kTransferBatchSize) {
+    void* p = shared.back();
+    shared.pop_back();
+    --slabs_[SlabIndexFor(p)].num_shared_blocks;
+    cache.blocks[size_class][num_blocks++] = p;
+  }
+}
+
+void BFCArena::CarveSlab(int size_class) {
+  if (num_slabs_ == kMaxSlabs || static_cast<size_t>(stats_.total_allocated_bytes) + kSlabSize > memory_limit_) {
+    return;
+  }
+
+  // slabs are separate allocations rather than chunks of a region, so they don't keep a region from being
+  // shrunk and can be released on their own
+  auto slot = std::find_if(slabs_.begin(), slabs_.end(), [](const Slab& slab) {
+    return slab.begin.load(std::memory_order_relaxed) == nullptr;
+  });
+  void* ptr = device_allocator_->Alloc(kSlabSize);
+  if (ptr == nullptr) {
+    return;
+  }
+
+  stats_.total_allocated_bytes += kSlabSize;
+  ++num_slabs_;
+
+  // push in reverse so blocks are handed out in address order
+  const size_t block_size = kMinAllocationSize << size_class;
+  auto& shared = shared_free_blocks_[size_class];
+  for (size_t offset = kSlabSize; offset >= block_size; offset -= block_size) {
+    shared.push_back(static_cast<char*>(ptr) + offset - block_size);
+  }
+  slot->num_shared_blocks = kSlabSize / block_size;
+
+  // publish the slab to SlabIndexFor
+  slot->size_class.store(size_class, std::memory_order_relaxed);
+  slot->begin.store(static_cast<const char*>(ptr), std::memory_order_release);
+  const auto index = static_cast<size_t>(slot - slabs_.begin());
+  if (index >= num_slab_slots_.load(std::memory_order_relaxed)) {
+    num_slab_slots_.store(index + 1, std::memory_order_release);
+  }
+}
+
+void BFCArena::PushSharedBlock(int size_class, void* p) {
+  shared_free_blocks_[size_class].push_back(p);
+
+  const int slab_index = SlabIndexFor(p);
+  if (++slabs_[slab_index].num_shared_blocks == kSlabSize / (kMinAllocationSize << size_class)) {
+    ReleaseSlab(slab_index);
+  }
+}
+
+void BFCArena::ReleaseSlab(int slab_index) {
+  auto& slab = slabs_[slab_index];
+  const char* begin = slab.begin.load(std::memory_order_relaxed);
+  const int size_class = slab.size_class.load(std::memory_order_relaxed);
+
+  auto& shared = shared_free_blocks_[size_class];
+  shared.erase(std::remove_if(shared.begin(), shared.end(),
+                              [begin](const void* p) {
+                                const char* ptr = static_cast<const char*>(p);
+                                return ptr >= begin && ptr < begin + kSlabSize;
+                              }),
+               shared.end());
+
+  slab.begin.store(nullptr, std::memory_order_release);
+  slab.num_shared_blocks = 0;
+  device_allocator_->Free(const_cast<char*>(begin));
+
+  stats_.total_allocated_bytes -= kSlabSize;
+  ++stats_.num_regions_released;
+  --num_slabs_;
 }
 
 void* BFCArena::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
@@ -328,6 +726,11 @@ void BFCArena::Free(void* p) {
   if (p == nullptr) {
     return;
   }
+
+  if (enable_thread_cache_ && FreeToThreadCache(p)) {
+    return;
+  }
+
   std::lock_guard<OrtMutex> lock(lock_);
   auto it = reserved_chunks_.find(p);
   if (it != reserved_chunks_.end()) {
@@ -336,7 +739,16 @@ void BFCArena::Free(void* p) {
     stats_.total_allocated_bytes -= it->second;
     reserved_chunks_.erase(it);
   } else {
+    const auto* region = region_manager_.RegionFor(p);
+    const void* region_ptr = region->ptr();
     DeallocateRawInternal(p);
+
+    // only the region the chunk was in can have become entirely free, so there's no need to scan the others.
+    // it wasn't free before this call, so it has been free since now.
+    if (shrink_options_.Enabled() && IsRegionFree(*region_manager_.RegionFor(region_ptr))) {
+      free_regions_[region_ptr] = std::chrono::steady_clock::now();
+      ShrinkIfNeeded();
+    }
   }
 }
 
@@ -16,9 +16,12 @@ limitations under the License.
 
 #pragma once
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <unordered_map>
 
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
@@ -50,8 +53,21 @@ struct AllocatorStats {
                                   // unknown.
   int64_t bytes_limit;
 
+  int64_t num_regions;           // Number of regions and slabs currently allocated from the device allocator.
+  int64_t num_regions_released;  // Number of regions and slabs returned to the device allocator.
+
+  int64_t num_thread_cache_hits;    // Small allocations served from a thread local cache without locking.
+  int64_t num_thread_cache_misses;  // Small allocations that had to refill the thread local cache.
+  int64_t num_thread_caches;        // Thread caches currently held by live threads.
+  int64_t bytes_in_thread_caches;   // Bytes of slabs reserved for the thread caches that are not in use.
+
   AllocatorStats() { Clear(); }
 
+  double ThreadCacheHitRate() const {
+    const int64_t total = num_thread_cache_hits + num_thread_cache_misses;
+    return total == 0 ? 0.0 : static_cast<double>(num_thread_cache_hits) / total;
+  }
+
   void Clear() {
     this->num_allocs = 0;
     this->bytes_in_use = 0;
@@ -59,6 +75,12 @@ struct AllocatorStats {
     this->max_alloc_size = 0;
     this->bytes_limit = 0;
     this->total_allocated_bytes = 0;
+    this->num_regions = 0;
+    this->num_regions_released = 0;
+    this->num_thread_cache_hits = 0;
+    this->num_thread_cache_misses = 0;
+    this->num_thread_caches = 0;
+    this->bytes_in_thread_caches = 0;
   }
 
   std::string DebugString() const {
@@ -68,7 +90,13 @@ struct AllocatorStats {
        << "TotalAllocated: " << this->total_allocated_bytes << "\n"
        << "MaxInUse:       " << this->max_bytes_in_use << "\n"
        << "NumAllocs:      " << this->num_allocs << "\n"
-       << "MaxAllocSize:   " << this->max_alloc_size << "\n";
+       << "MaxAllocSize:   " << this->max_alloc_size << "\n"
+       << "NumRegions:     " << this->num_regions << "\n"
+       << "RegionsFreed:   " << this->num_regions_released << "\n"
+       << "CacheHits:      " << this->num_thread_cache_hits << "\n"
+       << "CacheMisses:    " << this->num_thread_cache_misses << "\n"
+       << "NumCaches:      " << this->num_thread_caches << "\n"
+       << "CachedBytes:    " << this->bytes_in_thread_caches << "\n";
     return ss.str();
   }
 };
@@ -81,9 +109,26 @@ struct AllocatorStats {
 // coalescing.  One assumption we make is that the process using this
 // allocator owns pretty much all of the memory, and that nearly
 // all requests to allocate memory go through this interface.
+//
+// If enable_thread_cache is set, small allocations (up to kMaxCachedSize) are served from
+// per-thread caches of fixed size blocks so that they don't contend on the arena lock.
+// The blocks are carved from slabs allocated directly from the device allocator and move
+// between the thread caches and a shared free list in batches. Blocks can be freed by any
+// thread, and the blocks held by a thread's cache are returned to the shared free list when
+// the thread exits. A slab is returned to the device allocator once all its blocks are back
+// in the shared free list, and slabs never pin the arena's regions.
+// GetStats counts slabs as regions, blocks handed out from the caches as allocations and bytes
+// in use, and the rest of the slabs as bytes_in_thread_caches.
+//
+// Regions are only returned to the device allocator when they are entirely free, either
+// by an explicit Shrink call or according to shrink_options. The shrink policy is applied
+// when a Free leaves a region entirely free, and regions that have been idle for
+// max_idle_time are also released from the slow path of Alloc.
 class BFCArena : public IArenaAllocator {
  public:
-  BFCArena(std::unique_ptr<IDeviceAllocator> resource_allocator, size_t total_memory);
+  BFCArena(std::unique_ptr<IDeviceAllocator> resource_allocator, size_t total_memory,
+           bool enable_thread_cache = false,
+           const ArenaShrinkOptions& shrink_options = ArenaShrinkOptions());
 
   ~BFCArena() override;
 
@@ -114,6 +159,9 @@ class BFCArena : public IArenaAllocator {
     return device_allocator_->CreateFence(session_state);
   }
 
+  // Release all regions that are entirely free.
+  size_t Shrink() override;
+
   void GetStats(AllocatorStats* stats);
 
   size_t RequestedSize(const void* ptr);
@@ -124,6 +172,65 @@ class BFCArena : public IArenaAllocator {
   void* AllocateRawInternal(size_t num_bytes, bool dump_log_on_failure);
   void DeallocateRawInternal(void* ptr);
 
+  // Size classes served by the thread caches are powers of two from kMinAllocationSize to kMaxCachedSize.
+  static const int kNumCachedClasses = 8;
+  static const size_t kSlabSize = 1 << 20;
+  static const size_t kMaxSlabs = 64;
+  static const int kThreadCacheCapacity = 32;
+  static const int kTransferBatchSize = 16;
+
+  // thread local storage holding a thread's caches for all arenas. defined in bfc_arena.cc.
+  struct ThreadLocalCaches;
+
+  struct ThreadCache {
+    // thread local storage of the owning thread, so the arena can erase its entry when it is destroyed
+    ThreadLocalCaches* owner = nullptr;
+
+    // free blocks per size class. only accessed by the owning thread.
+    std::array<std::array<void*, kThreadCacheCapacity>, kNumCachedClasses> blocks;
+    std::array<int, kNumCachedClasses> num_blocks{};
+
+    // written by the owning thread, read by GetStats
+    std::atomic<int64_t> hits{0};
+    std::atomic<int64_t> misses{0};
+    // blocks freed by this thread may have been allocated by another, so bytes_in_use can be negative.
+    // only the sum over all the caches is meaningful.
+    std::atomic<int64_t> bytes_in_use{0};
+    std::atomic<int64_t> num_allocs{0};
+  };
+
+  // A slab is an allocation of kSlabSize bytes from the device allocator split into blocks of a single size class.
+  struct Slab {
+    // written with lock_ held and read without it by SlabIndexFor. nullptr if the slot is unused.
+    std::atomic<const char*> begin{nullptr};
+    std::atomic<int> size_class{-1};
+    // number of the slab's blocks in shared_free_blocks_. protected by lock_
+    size_t num_shared_blocks = 0;
+  };
+
+  ThreadCache& GetThreadCache();
+  void* AllocFromThreadCache(size_t rounded_bytes);
+  bool FreeToThreadCache(void* p);
+
+  // Called when the thread owning cache exits. Moves its blocks to the shared free list and drops the cache.
+  void ReleaseThreadCache(ThreadCache* cache);
+
+  // Returns the index in slabs_ of the slab containing p, or -1 if p is not a slab block.
+  // Lock free scan of the slab slots in use.
+  int SlabIndexFor(const void* p) const;
+
+  // Moves up to kTransferBatchSize free blocks into the thread cache, carving a new slab if there
+  // are none. lock_ must be held.
+  void RefillThreadCache(ThreadCache& cache, int size_class);
+  void CarveSlab(int size_class);
+
+  // Adds a block to the shared free list, releasing its slab if all the slab's blocks are free. lock_ must be held.
+  void PushSharedBlock(int size_class, void* p);
+
+  // Removes the blocks of a slab from the shared free list and returns its memory to the device allocator.
+  // lock_ must be held.
+  void ReleaseSlab(int slab_index);
+
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
   // kInvalidChunkHandle means an invalid chunk
   using ChunkHandle = size_t;
@@ -219,6 +326,7 @@ class BFCArena : public IArenaAllocator {
 
   static const size_t kMinAllocationBits = 8;
   static const size_t kMinAllocationSize = 1 << kMinAllocationBits;
+  static const size_t kMaxCachedSize = kMinAllocationSize << (kNumCachedClasses - 1);
 
   // AllocationRegion maps pointers to ChunkHandles for a single
   // contiguous memory region.
@@ -306,6 +414,13 @@ class BFCArena : public IArenaAllocator {
       regions_.insert(entry, AllocationRegion(ptr, memory_size));
     }
 
+    void RemoveAllocationRegion(void* ptr) {
+      auto entry =
+          std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
+      ORT_ENFORCE(entry != regions_.end() && entry->ptr() == ptr, "Could not find region for ", ptr);
+      regions_.erase(entry);
+    }
+
     ChunkHandle get_handle(const void* p) const {
       return RegionFor(p)->get_handle(p);
     }
@@ -317,17 +432,6 @@ class BFCArena : public IArenaAllocator {
 
     const std::vector<AllocationRegion>& regions() const { return regions_; }
 
-   private:
-    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(RegionManager);
-
-    static bool Comparator(const void* ptr, const AllocationRegion& other) {
-      return ptr < other.end_ptr();
-    }
-
-    AllocationRegion* MutableRegionFor(const void* p) {
-      return const_cast<AllocationRegion*>(RegionFor(p));
-    }
-
     const AllocationRegion* RegionFor(const void* p) const {
       auto entry =
           std::upper_bound(regions_.begin(), regions_.end(), p, &Comparator);
@@ -341,6 +445,16 @@ class BFCArena : public IArenaAllocator {
     }
 
    private:
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(RegionManager);
+
+    static bool Comparator(const void* ptr, const AllocationRegion& other) {
+      return ptr < other.end_ptr();
+    }
+
+    AllocationRegion* MutableRegionFor(const void* p) {
+      return const_cast<AllocationRegion*>(RegionFor(p));
+    }
+
     std::vector<AllocationRegion> regions_;
   };
 
@@ -352,6 +466,17 @@ class BFCArena : public IArenaAllocator {
   // failure.
   bool Extend(size_t rounded_bytes);
 
+  // Returns true if the region consists of a single free chunk.
+  bool IsRegionFree(const AllocationRegion& region);
+
+  // Returns the memory of a free region to the device allocator.
+  // Invalidates iterators into region_manager_.regions(). Returns the size of the region.
+  size_t ReleaseRegion(void* region_ptr);
+
+  // Applies shrink_options_ to the regions in free_regions_. Only releases regions that have been idle
+  // for max_idle_time if idle_only is set. lock_ must be held.
+  void ShrinkIfNeeded(bool idle_only = false);
+
   // Returns a pointer to an underlying allocated chunk of size
   // 'rounded_bytes'.
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes);
@@ -456,6 +581,13 @@ class BFCArena : public IArenaAllocator {
 
   // The size of the current region allocation.
   size_t curr_region_allocation_bytes_;
+  size_t initial_region_allocation_bytes_;
+
+  const ArenaShrinkOptions shrink_options_;
+  // regions seen to be entirely free by Free, and when they were first seen free. only maintained if
+  // shrink_options_ is enabled. entries are checked again before use, as the region may have been allocated from
+  // since, so the shrink policy only looks at these instead of scanning every region.
+  std::unordered_map<const void*, std::chrono::steady_clock::time_point> free_regions_;
 
   // An indicator that expansion of a region has hit the limits
   // of the available memory.
@@ -480,6 +612,24 @@ class BFCArena : public IArenaAllocator {
 
   std::unordered_map<void*, size_t> reserved_chunks_;
 
+  const bool enable_thread_cache_;
+  // unique id used to find the ThreadCache of this arena in thread local storage.
+  // unlike the arena address it is never reused, so a stale thread local entry can't match a new arena.
+  const uint64_t arena_id_;
+  std::vector<std::unique_ptr<ThreadCache>> thread_caches_;                // protected by lock_
+  std::array<std::vector<void*>, kNumCachedClasses> shared_free_blocks_;  // protected by lock_
+  // counters of the caches released by threads that exited. protected by lock_
+  int64_t released_cache_hits_ = 0;
+  int64_t released_cache_misses_ = 0;
+  int64_t released_cache_bytes_in_use_ = 0;
+  int64_t released_cache_num_allocs_ = 0;
+  // slots for the live slabs. a slot is only reused once the slab in it is released, which requires all its blocks
+  // to be free, so SlabIndexFor can scan the slots without the lock.
+  std::array<Slab, kMaxSlabs> slabs_;
+  // number of slots that have been used, so SlabIndexFor doesn't scan the ones that never were
+  std::atomic<size_t> num_slab_slots_{0};
+  size_t num_slabs_ = 0;  // protected by lock_
+
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(BFCArena);
 };
 #ifdef __GNUC__
@@ -25,30 +25,117 @@ ExecutionFrame::ExecutionFrame(const std::unordered_map<std::string, MLValue>& f
       session_state_(session_state),
       mem_patterns_(nullptr),
       planner_(nullptr) {
-  Init(feeds, output_names, fetches, fetch_allocators);
+  auto& mlvalue_idx_map = session_state_.GetMLValueNameIdxMap();
+
+  std::vector<MLValue> feed_values;
+  feed_indices_.reserve(feeds.size());
+  feed_values.reserve(feeds.size());
+
+  for (const auto& feed : feeds) {
+    int mlvalue_idx;
+    Status status = mlvalue_idx_map.GetIdx(feed.first, mlvalue_idx);
+    ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+    feed_indices_.push_back(mlvalue_idx);
+    feed_values.push_back(feed.second);
+  }
+
+  // setup output_indices_ for any pre-allocated fetches, we don't want to generate mem plan on output tensors.
+  if (!fetches.empty()) {
+    // should've already verified this much before when Run() starts
+    ORT_ENFORCE(output_names.size() == fetches.size(),
+                "output_names vector size: " + std::to_string(output_names.size()) +
+                    " does not match that of fetches vector: " + std::to_string(fetches.size()));
+
+    output_indices_.reserve(output_names.size());
+    for (const auto& oname : output_names) {
+      int mlvalue_idx;
+      Status status = mlvalue_idx_map.GetIdx(oname, mlvalue_idx);
+      ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+      output_indices_.push_back(mlvalue_idx);
+    }
+  }
+
+  Init(feed_values, fetches, fetch_allocators);
+  InitMemoryPatterns(feed_values);
+}
+
+ExecutionFrame::ExecutionFrame(const std::vector<int>& feed_mlvalue_idxs,
+                               const std::vector<MLValue>& feeds,
+                               const std::vector<int>& fetch_mlvalue_idxs,
+                               const std::vector<MLValue>& fetches,
+                               const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
+                               const SessionState& session_state)
+    : node_index_info_(session_state.GetNodeIndexInfo()),
+      session_state_(session_state),
+      mem_patterns_(nullptr),
+      planner_(nullptr),
+      feed_indices_(feed_mlvalue_idxs),
+      output_indices_(fetch_mlvalue_idxs) {
+  ORT_ENFORCE(feed_indices_.size() == feeds.size(),
+              "Number of feed indexes: " + std::to_string(feed_indices_.size()) +
+                  " does not match number of feeds: " + std::to_string(feeds.size()));
+
+  Init(feeds, fetches, fetch_allocators);
+  InitMemoryPatterns(feeds);
+}
+
+ExecutionFrame::~ExecutionFrame() = default;
+
+void ExecutionFrame::Reset(const std::vector<MLValue>& feeds,
+                           const std::vector<MLValue>& fetches,
+                           const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators) {
+  ORT_ENFORCE(feed_indices_.size() == feeds.size(),
+              "Number of feed indexes: " + std::to_string(feed_indices_.size()) +
+                  " does not match number of feeds: " + std::to_string(feeds.size()));
+
+  // release everything from the previous execution. Init will add the initializers back.
+  for (auto& mlvalue : all_values_) {
+    mlvalue = MLValue();
+  }
+
+  custom_allocators_.clear();
+
+  Init(feeds, fetches, fetch_allocators);
+
+  // the memory pattern and its buffers can be used again if the feeds have the same shapes
+  bool reuse_mem_patterns = mem_patterns_ != nullptr;
+  for (size_t i = 0, end = feeds.size(); reuse_mem_patterns && i < end; ++i) {
+    reuse_mem_patterns = feeds[i].IsTensor() && feeds[i].Get<Tensor>().Shape() == feed_shapes_[i];
+  }
+
+  if (!reuse_mem_patterns) {
+    InitMemoryPatterns(feeds);
+  }
+}
+
+void ExecutionFrame::InitMemoryPatterns(const std::vector<MLValue>& feeds) {
+  mem_patterns_ = nullptr;
+  planner_ = nullptr;
+  buffers_.clear();
+  feed_shapes_.clear();
 
   // If the session enable memory pattern optimization
   // and we have execution plan generated, try to setup
   // memory pattern optimization.
-  if (session_state.GetEnableMemoryPattern() &&
-      session_state.GetExecutionPlan()) {
+  if (session_state_.GetEnableMemoryPattern() &&
+      session_state_.GetExecutionPlan()) {
     std::vector<TensorShape> input_shapes;
     bool all_tensors = true;
     for (const auto& feed : feeds) {
-      if (!(feed.second.IsTensor())) {
+      if (!(feed.IsTensor())) {
         all_tensors = false;
         break;
       }
-      auto& tensor = feed.second.Get<Tensor>();
+      auto& tensor = feed.Get<Tensor>();
       input_shapes.push_back(tensor.Shape());
     }
     // if there is some traditional ml value type in inputs
     // disable the memory pattern optimization.
     if (all_tensors) {
-      mem_patterns_ = session_state.GetMemoryPatternGroup(input_shapes);
+      mem_patterns_ = session_state_.GetMemoryPatternGroup(input_shapes);
       // if no existing patterns, generate one in this executionframe
       if (!mem_patterns_) {
-        planner_ = std::make_unique<MLValuePatternPlanner>(*session_state.GetExecutionPlan());
+        planner_ = std::make_unique<MLValuePatternPlanner>(*session_state_.GetExecutionPlan());
       } else {
         // pre-allocate the big chunk requested in memory pattern.
         // all the internal kernel's input/output tensors will be allocated on these buffer.
@@ -59,12 +146,12 @@ ExecutionFrame::ExecutionFrame(const std::unordered_map<std::string, MLValue>& f
           buffers_[mem_patterns_->locations[i]] = BufferUniquePtr(buffer, alloc);
         }
       }
+
+      feed_shapes_ = std::move(input_shapes);
     }
   }
 }
 
-ExecutionFrame::~ExecutionFrame() = default;
-
 Status ExecutionFrame::AllocateMLValueTensorSelfOwnBuffer(int mlvalue_index,
                                                           const DataTypeImpl* element_type,
                                                           const OrtAllocatorInfo& location,
@@ -116,20 +203,21 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(int mlvalue_inde
       // if block not found, fall back to default behavior
       if (block) {
         auto it = buffers_.find(location);
-        // if the block is not correct, log message then fall back to default behavior
-        if (it != buffers_.end() && block->size_ == size) {
+        // if the block is not correct, log message then fall back to default behavior.
+        // the block may be larger than needed if the pattern was generated for a larger shape in the same bucket.
+        if (it != buffers_.end() && size <= block->size_) {
           void* buffer = it->second.get();
           auto status = AllocateTensorWithPreAllocateBufferHelper(
               p_mlvalue, static_cast<void*>(static_cast<char*>(buffer) + block->offset_),
               element_type, location, shape);
           return status;
         }
-        if (block->size_ != size) {
-          LOGS_DEFAULT(WARNING) << "For mlvalue with index: " << mlvalue_index << ", block in memory pattern size is: "
-                                << block->size_ << " but the actually size is: " << size << ", fall back to default allocation behavior";
+        if (block->size_ < size) {
+          VLOGS_DEFAULT(1) << "For mlvalue with index: " << mlvalue_index << ", block in memory pattern size is: "
+                           << block->size_ << " but the actually size is: " << size << ", fall back to default allocation behavior";
         } else if (it == buffers_.end()) {
-          LOGS_DEFAULT(WARNING) << "For mlvalue with index: " << mlvalue_index << ", block not found in target loation. "
-                                                                                  " fall back to default allocation behavior";
+          VLOGS_DEFAULT(1) << "For mlvalue with index: " << mlvalue_index << ", block not found in target loation. "
+                                                                             " fall back to default allocation behavior";
         }
       }
     }
@@ -290,8 +378,7 @@ Status ExecutionFrame::AllocateAsPerAllocationPlan(int mlvalue_index,
   return Status::OK();
 }
 
-void ExecutionFrame::Init(const std::unordered_map<std::string, MLValue>& feeds,
-                          const std::vector<std::string>& output_names,
+void ExecutionFrame::Init(const std::vector<MLValue>& feeds,
                           const std::vector<MLValue>& fetches,
                           const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators) {
   auto& mlvalue_idx_map = session_state_.GetMLValueNameIdxMap();
@@ -301,27 +388,18 @@ void ExecutionFrame::Init(const std::unordered_map<std::string, MLValue>& feeds,
 
   // 2. Handle non-empty output vector
   if (!fetches.empty()) {
-    // should've already verified this much before when Run() starts
-    ORT_ENFORCE(output_names.size() == fetches.size(),
-                "output_names vector size: " + std::to_string(output_names.size()) +
+    ORT_ENFORCE(output_indices_.size() == fetches.size(),
+                "Number of fetch indexes: " + std::to_string(output_indices_.size()) +
                     " does not match that of fetches vector: " + std::to_string(fetches.size()));
 
-    // setup output_indices_, we don't want to generate mem plan on output tensors.
-    output_indices_.reserve(output_names.size());
-    auto idx = 0;
-    for (const auto& oname : output_names) {
-      int mlvalue_idx;
-      Status status = mlvalue_idx_map.GetIdx(oname, mlvalue_idx);
-      ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
-      all_values_[mlvalue_idx] = fetches.at(idx);
-      output_indices_.push_back(mlvalue_idx);
+    for (size_t idx = 0, end = fetches.size(); idx < end; ++idx) {
+      int mlvalue_idx = output_indices_[idx];
+      all_values_[mlvalue_idx] = fetches[idx];
 
       auto custom_alloc_entry = fetch_allocators.find(idx);
       if (custom_alloc_entry != fetch_allocators.cend()) {
         custom_allocators_[mlvalue_idx] = custom_alloc_entry->second;
       }
-
-      ++idx;
     }
   }
 
@@ -338,12 +416,9 @@ void ExecutionFrame::Init(const std::unordered_map<std::string, MLValue>& feeds,
   }
 
   // 4. handle feed in values. these can override initializer values so must be last
-  for (const auto& feed : feeds) {
-    int mlvalue_idx;
-    Status status = mlvalue_idx_map.GetIdx(feed.first, mlvalue_idx);
-    ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+  for (size_t i = 0, end = feeds.size(); i < end; ++i) {
     // we are sharing the underline tensor/object for MLValue
-    all_values_[mlvalue_idx] = feed.second;
+    all_values_[feed_indices_[i]] = feeds[i];
   }
 }
 
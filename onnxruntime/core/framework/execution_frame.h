@@ -45,8 +45,23 @@ class ExecutionFrame {
                  const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
                  const SessionState& session_state);
 
+  // feeds and fetches are bound by MLValue index. fetch_allocators key is index in fetches.
+  ExecutionFrame(const std::vector<int>& feed_mlvalue_idxs,
+                 const std::vector<MLValue>& feeds,
+                 const std::vector<int>& fetch_mlvalue_idxs,
+                 const std::vector<MLValue>& fetches,
+                 const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
+                 const SessionState& session_state);
+
   ~ExecutionFrame();
 
+  // Prepare the frame for another execution of the graph with new feeds and fetches, bound to the same
+  // MLValue indexes as when the frame was created. All other values apart from initializers are released.
+  // The buffers for the memory pattern are kept if the shapes of the feeds have not changed.
+  void Reset(const std::vector<MLValue>& feeds,
+             const std::vector<MLValue>& fetches,
+             const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators);
+
   // TODO: These two AllocateMLValue... methods are in the API purely for unit test usage.
   // Fix the unit tests so they set an execution plan that results in these methods being called by
   // GetOrCreateNodeOutputMLValue instead
@@ -100,14 +115,20 @@ class ExecutionFrame {
     return planner_ != nullptr;
   }
 
+  // shapes of the feeds used to look up the memory pattern. only valid if all the feeds are tensors.
+  const std::vector<TensorShape>& GetFeedShapes() const {
+    return feed_shapes_;
+  }
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ExecutionFrame);
 
-  void Init(const std::unordered_map<std::string, MLValue>& feeds,
-            const std::vector<std::string>& output_names,
+  void Init(const std::vector<MLValue>& feeds,
             const std::vector<MLValue>& fetches,
             const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators);
 
+  void InitMemoryPatterns(const std::vector<MLValue>& feeds);
+
   common::Status AllocateAsPerAllocationPlan(int mlvalue_index,
                                              const MLValueAllocationParameters& parameters);
 
@@ -148,16 +169,22 @@ class ExecutionFrame {
   // If we already have cached memory pattern on these input shapes
   // Use this mem pattern that create a big chunk for all the internal
   // kernel's input/output tensors.
-  const MemoryPatternGroup* mem_patterns_;
+  std::shared_ptr<const MemoryPatternGroup> mem_patterns_;
 
   // If no cached memory pattern, and we enable the memory pattern optimization
   // use this planner_ to trace the memory allocation in current executor.
   std::unique_ptr<MLValuePatternPlanner> planner_;
 
+  // ml value indices for the feeds
+  std::vector<int> feed_indices_;
+
   // Record the ml value indices for output values. we won't include those
   // values' allocation in memory pattern, as they can't be shared.
   std::vector<int> output_indices_;
 
+  // shapes of the feeds the memory pattern was selected for
+  std::vector<TensorShape> feed_shapes_;
+
   // Big chunks on different locations that will be used by mem_pattern.
   std::map<OrtAllocatorInfo, BufferUniquePtr> buffers_;
 };
@@ -56,6 +56,14 @@ Status OpKernelContext::GetTempSpaceAllocator(AllocatorPtr* output) const {
   return Status::OK();
 }
 
+#ifdef USE_EIGEN_THREADPOOL
+Eigen::NonBlockingThreadPool* OpKernelContext::GetOperatorThreadPool() const {
+#else
+TaskThreadPool* OpKernelContext::GetOperatorThreadPool() const {
+#endif
+  return execution_frame_->GetSessionState().GetOperatorThreadPool();
+}
+
 MLDataType OpKernelContext::InputType(int index) const {
   int input_arg_index = GetInputArgIndex(index);
   const MLValue* p_ml_value = execution_frame_->GetNodeInputOrOutputMLValue(input_arg_index);
@@ -4,6 +4,7 @@
 #include "core/framework/op_kernel.h"
 #include "core/framework/op_kernel_info.h"
 #include "core/framework/session_state.h"
+#include "core/framework/shared_weights_store.h"
 
 namespace onnxruntime {
 
@@ -53,6 +54,11 @@ bool OpKernelInfo::TryGetConstantInput(int input_index, const Tensor** constant_
     return false;
   }
 
+  // an initializer that is also a graph input may be overridden by a feed
+  if (!session_state_.IsConstantInitializer(input_arg_name)) {
+    return false;
+  }
+
   auto& initializers = session_state_.GetInitializedTensors();
   auto iter = initializers.find(input_arg_index);
   if (initializers.end() == iter) {
@@ -66,6 +72,20 @@ bool OpKernelInfo::TryGetConstantInput(int input_index, const Tensor** constant_
   return true;
 }
 
+common::Status OpKernelInfo::GetPrePackedBuffer(const Tensor& tensor, const std::string& pack_key, size_t size,
+                                                const std::function<void(void*)>& pack_fn,
+                                                std::shared_ptr<void>& buffer) const {
+  auto* shared_weights_store = session_state_.GetSharedWeightsStore();
+  if (shared_weights_store != nullptr && shared_weights_store->IsSharedWeight(tensor)) {
+    return shared_weights_store->GetOrCreatePacked(tensor, node_.OpType() + ":" + pack_key, size, pack_fn, buffer);
+  }
+
+  auto alloc = GetAllocator(0, OrtMemTypeDefault);
+  buffer = std::shared_ptr<void>(alloc->Alloc(size), BufferDeleter(alloc));
+  pack_fn(buffer.get());
+  return Status::OK();
+}
+
 common::Status OpKernelInfo::GetFusedFuncs(ComputeFunc* compute, CreateFunctionStateFunc* create, DestroyFunctionStateFunc* release) const {
   const auto& funcs_mgr = session_state_.GetFuncMgr();
   return funcs_mgr.GetFuncs(node_.Name(), compute, create, release);
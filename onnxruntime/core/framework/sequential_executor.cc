@@ -15,9 +15,8 @@
 
 namespace onnxruntime {
 
-static Status FetchOutput(const MLValueNameIdxMap& name_idx_map,
-                          ExecutionFrame& frame,
-                          const std::vector<std::string>& output_names,
+static Status FetchOutput(const ExecutionFrame& frame,
+                          const std::vector<int>& fetch_mlvalue_idxs,
                           std::vector<MLValue>& fetches,
                           const logging::Logger& logger);
 
@@ -32,6 +31,24 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
                                    std::vector<MLValue>& fetches,
                                    const std::unordered_map<size_t, CustomAllocator> fetch_allocators,
                                    const logging::Logger& logger) {
+  std::vector<int> fetch_mlvalue_idxs;
+  fetch_mlvalue_idxs.reserve(output_names.size());
+  for (const auto& oname : output_names) {
+    int mlvalue_idx;
+    ORT_RETURN_IF_ERROR(session_state.GetMLValueNameIdxMap().GetIdx(oname, mlvalue_idx));
+    fetch_mlvalue_idxs.push_back(mlvalue_idx);
+  }
+
+  ExecutionFrame frame{feeds, output_names, fetches, fetch_allocators, session_state};
+
+  return Execute(frame, fetch_mlvalue_idxs, fetches, logger);
+}
+
+Status SequentialExecutor::Execute(ExecutionFrame& frame,
+                                   const std::vector<int>& fetch_mlvalue_idxs,
+                                   std::vector<MLValue>& fetches,
+                                   const logging::Logger& logger) {
+  const SessionState& session_state = frame.GetSessionState();
   bool f_profiler_enabled = session_state.Profiler().FEnabled();
   TimePoint tp;
   TimePoint sync_time_begin;
@@ -41,8 +58,6 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
     tp = session_state.Profiler().StartTime();
   }
 
-  ExecutionFrame frame{feeds, output_names, fetches, fetch_allocators, session_state};
-
   LOGS(logger, INFO) << "Begin execution";
   const SequentialExecutionPlan& seq_exec_plan = *session_state.GetExecutionPlan();
   const auto& exec_plan_vec = seq_exec_plan.execution_plan;
@@ -162,25 +177,13 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
   }
 
   VLOGS(logger, 1) << "Fetching output.";
-  ORT_RETURN_IF_ERROR(FetchOutput(session_state.GetMLValueNameIdxMap(), frame, output_names, fetches, logger));
+  ORT_RETURN_IF_ERROR(FetchOutput(frame, fetch_mlvalue_idxs, fetches, logger));
 
+  // the frame only has a plan if all the feeds are tensors
   if (frame.HasPlan()) {
-    std::vector<TensorShape> input_shapes;
-    bool all_tensors = true;
-    for (const auto& feed : feeds) {
-      if (!(feed.second.IsTensor())) {
-        all_tensors = false;
-        break;
-      }
-      auto& tensor = feed.second.Get<Tensor>();
-      input_shapes.push_back(tensor.Shape());
-    }
-
-    if (all_tensors) {
-      auto mem_patterns = std::make_unique<MemoryPatternGroup>();
-      ORT_RETURN_IF_ERROR(frame.GeneratePatterns(mem_patterns.get()));
-      ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(input_shapes, std::move(mem_patterns)));
-    }
+    auto mem_patterns = std::make_unique<MemoryPatternGroup>();
+    ORT_RETURN_IF_ERROR(frame.GeneratePatterns(mem_patterns.get()));
+    ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(frame.GetFeedShapes(), std::move(mem_patterns)));
   }
 
   if (f_profiler_enabled) {
@@ -190,29 +193,22 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
   return Status::OK();
 }
 
-static Status FetchOutput(const MLValueNameIdxMap& name_idx_map,
-                          ExecutionFrame& frame,
-                          const std::vector<std::string>& output_names,
+static Status FetchOutput(const ExecutionFrame& frame,
+                          const std::vector<int>& fetch_mlvalue_idxs,
                           std::vector<MLValue>& fetches,
                           const logging::Logger& logger) {
   if (fetches.empty()) {
-    fetches.resize(output_names.size());
+    fetches.resize(fetch_mlvalue_idxs.size());
   } else {
     // this should've been checked before already
-    ORT_ENFORCE(output_names.size() == fetches.size(),
-                "output_names vector size: " + std::to_string(output_names.size()) +
+    ORT_ENFORCE(fetch_mlvalue_idxs.size() == fetches.size(),
+                "fetch_mlvalue_idxs vector size: " + std::to_string(fetch_mlvalue_idxs.size()) +
                     " does not match that of fetches vector: " + std::to_string(fetches.size()));
   }
 
-  auto idx = 0;
-
-  for (const auto& oname : output_names) {
-    VLOGS(logger, 1) << "Attempting to fetch output with name: " << oname;
-    int mlvalue_index;
-    ORT_RETURN_IF_ERROR(name_idx_map.GetIdx(oname, mlvalue_index));
-    const MLValue& output_mlvalue = frame.GetMLValue(mlvalue_index);
-    VLOGS(logger, 1) << "Copying fetched MLValue to output vector";
-    fetches[idx++] = output_mlvalue;
+  for (size_t idx = 0, end = fetch_mlvalue_idxs.size(); idx < end; ++idx) {
+    VLOGS(logger, 1) << "Copying fetched MLValue with index " << fetch_mlvalue_idxs[idx] << " to output vector";
+    fetches[idx] = frame.GetMLValue(fetch_mlvalue_idxs[idx]);
   }
 
   VLOGS(logger, 1) << "Done with execution.";
@@ -14,6 +14,8 @@
 #include "core/graph/graph_viewer.h"
 
 namespace onnxruntime {
+class ExecutionFrame;
+
 class SequentialExecutor : public IExecutor {
  public:
   SequentialExecutor(const bool& terminate_flag = false) : terminate_flag_{terminate_flag} {}
@@ -25,6 +27,13 @@ class SequentialExecutor : public IExecutor {
                          const std::unordered_map<size_t, CustomAllocator> fetch_allocators,
                          const logging::Logger& logger) override;
 
+  // Execute using a frame that has the feeds and fetches bound by MLValue index.
+  // This allows the frame to be re-used for repeated executions of the same graph. See ExecutionFrame::Reset.
+  common::Status Execute(ExecutionFrame& frame,
+                         const std::vector<int>& fetch_mlvalue_idxs,
+                         std::vector<MLValue>& fetches,
+                         const logging::Logger& logger);
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SequentialExecutor);
   const bool& terminate_flag_;
@@ -3,6 +3,8 @@
 
 #include "core/framework/session_state.h"
 
+#include <algorithm>
+#include <iterator>
 #include <sstream>
 
 #include "core/common/logging/logging.h"
@@ -52,6 +54,18 @@ const std::unordered_map<int, MLValue>& SessionState::GetInitializedTensors() co
   return initialized_tensors_;
 }
 
+bool SessionState::IsConstantInitializer(const std::string& name) const {
+  int mlvalue_idx;
+  if (!mlvalue_name_idx_map_.GetIdx(name, mlvalue_idx).IsOK() ||
+      initialized_tensors_.find(mlvalue_idx) == initialized_tensors_.end()) {
+    return false;
+  }
+
+  const auto& graph_inputs = graph_viewer_->GetInputsIncludingInitializers();
+  return std::none_of(graph_inputs.cbegin(), graph_inputs.cend(),
+                      [&name](const NodeArg* input) { return input->Name() == name; });
+}
+
 SessionState& SessionState::SetLogger(const logging::Logger& logger) {
   logger_ = &logger;
   return *this;
@@ -71,38 +85,125 @@ void SessionState::SetProfiler(profiling::Profiler& profiler) {
   return *profiler_;
 }
 
-static int64_t CalculateMemoryPatternsKey(const std::vector<TensorShape>& shapes) {
-  int64_t key = 0;
+static int64_t RoundUpToBucket(int64_t dim, const std::vector<int64_t>& buckets) {
+  auto bucket = std::lower_bound(buckets.cbegin(), buckets.cend(), dim);
+  return bucket == buckets.cend() ? dim : *bucket;
+}
+
+std::vector<TensorShape> SessionState::GetBucketedShapes(const std::vector<TensorShape>& input_shapes) const {
+  std::vector<TensorShape> bucketed_shapes;
+  bucketed_shapes.reserve(input_shapes.size());
+  for (const auto& shape : input_shapes) {
+    std::vector<int64_t> dims = shape.GetDims();
+    for (auto& dim : dims) {
+      dim = RoundUpToBucket(dim, mem_pattern_dim_buckets_);
+    }
+    bucketed_shapes.emplace_back(dims);
+  }
+
+  return bucketed_shapes;
+}
+
+// the key holds the rank of each shape followed by its (bucketed) dims so that different shapes never collide
+static std::vector<int64_t> CalculateMemoryPatternsKey(const std::vector<TensorShape>& shapes,
+                                                       const std::vector<int64_t>& buckets) {
+  std::vector<int64_t> key;
   for (auto& shape : shapes) {
-    for (auto dim : shape.GetDims())
-      key ^= dim;
+    const auto& dims = shape.GetDims();
+    key.push_back(static_cast<int64_t>(dims.size()));
+    for (auto dim : dims)
+      key.push_back(RoundUpToBucket(dim, buckets));
   }
   return key;
 }
 
-const MemoryPatternGroup* SessionState::GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes) const {
+// true if every dim of shapes is at least as large as the matching dim of other_shapes.
+// both must have the same memory pattern key, so they have the same number of shapes with the same ranks.
+static bool CoversShapes(const std::vector<TensorShape>& shapes, const std::vector<TensorShape>& other_shapes) {
+  for (size_t i = 0, end = shapes.size(); i < end; ++i) {
+    const auto& dims = shapes[i].GetDims();
+    const auto& other_dims = other_shapes[i].GetDims();
+    for (size_t j = 0, rank = dims.size(); j < rank; ++j) {
+      if (dims[j] < other_dims[j])
+        return false;
+    }
+  }
+
+  return true;
+}
+
+std::shared_ptr<const MemoryPatternGroup> SessionState::GetMemoryPatternGroup(
+    const std::vector<TensorShape>& input_shapes) const {
+  auto key = CalculateMemoryPatternsKey(input_shapes, mem_pattern_dim_buckets_);
+
   std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
-  int64_t key = CalculateMemoryPatternsKey(input_shapes);
-  auto it = mem_patterns_.find(key);
-  if (it == mem_patterns_.end())
-    return nullptr;
+  auto range = mem_pattern_lookup_.equal_range(key);
+  for (auto it = range.first; it != range.second; ++it) {
+    // the blocks of a pattern generated for smaller shapes in the bucket are too small for these ones
+    if (CoversShapes(it->second->input_shapes, input_shapes)) {
+      // move to the front of the LRU list
+      mem_patterns_.splice(mem_patterns_.begin(), mem_patterns_, it->second);
+      return it->second->patterns;
+    }
+  }
 
-  return it->second.get();
+  return nullptr;
 }
 
 Status SessionState::UpdateMemoryPatternGroupCache(const std::vector<TensorShape>& input_shape,
                                                    std::unique_ptr<MemoryPatternGroup> mem_patterns) const {
-  int64_t key = CalculateMemoryPatternsKey(input_shape);
+  auto key = CalculateMemoryPatternsKey(input_shape, mem_pattern_dim_buckets_);
 
   std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
-  auto it = mem_patterns_.find(key);
-  if (it == mem_patterns_.end()) {
-    mem_patterns_[key] = std::move(mem_patterns);
+  auto range = mem_pattern_lookup_.equal_range(key);
+  for (auto it = range.first; it != range.second;) {
+    if (CoversShapes(it->second->input_shapes, input_shape)) {
+      // another run already cached a pattern that is large enough
+      mem_patterns_.splice(mem_patterns_.begin(), mem_patterns_, it->second);
+      return Status::OK();
+    }
+
+    // the new pattern replaces the ones for shapes it covers
+    if (CoversShapes(input_shape, it->second->input_shapes)) {
+      mem_patterns_.erase(it->second);
+      it = mem_pattern_lookup_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  mem_patterns_.push_front(MemoryPatternEntry{key, input_shape, std::move(mem_patterns)});
+  mem_pattern_lookup_.emplace(std::move(key), mem_patterns_.begin());
+
+  while (max_num_mem_patterns_ > 0 && mem_patterns_.size() > max_num_mem_patterns_) {
+    auto last = std::prev(mem_patterns_.end());
+    auto last_range = mem_pattern_lookup_.equal_range(last->key);
+    for (auto it = last_range.first; it != last_range.second; ++it) {
+      if (it->second == last) {
+        mem_pattern_lookup_.erase(it);
+        break;
+      }
+    }
+    mem_patterns_.pop_back();
   }
 
   return Status::OK();
 }
 
+void SessionState::SetMemoryPatternCacheSize(size_t max_num_patterns) {
+  max_num_mem_patterns_ = max_num_patterns;
+}
+
+void SessionState::SetMemoryPatternDimBuckets(const std::vector<int64_t>& buckets) {
+  ORT_ENFORCE(std::is_sorted(buckets.cbegin(), buckets.cend()), "Memory pattern dimension buckets must be sorted.");
+  mem_pattern_dim_buckets_ = buckets;
+}
+
+size_t SessionState::GetNumMemoryPatterns() const {
+  std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
+  return mem_patterns_.size();
+}
+
 void SessionState::SetEnableMemoryPattern(bool flag) {
   enable_mem_pattern_ = flag;
 }
@@ -216,6 +317,22 @@ void SessionState::CalculateNodeIndexInfo() {
   ORT_ENFORCE(graph_viewer_);
   node_index_info_ = std::make_unique<NodeIndexInfo>(*graph_viewer_, mlvalue_name_idx_map_);
 
+  // walk the graph backwards so every successor has its priority before its producers are visited
+  node_priorities_.assign(graph_viewer_->MaxNodeIndex(), 0);
+  const auto& order = graph_viewer_->GetNodesInTopologicalOrder();
+  for (auto it = order.crbegin(); it != order.crend(); ++it) {
+    const auto* node = graph_viewer_->GetNode(*it);
+    size_t max_successor = 0;
+    for (auto edge = node->OutputEdgesBegin(); edge != node->OutputEdgesEnd(); ++edge) {
+      max_successor = std::max(max_successor, node_priorities_[edge->GetNode().Index()]);
+    }
+    node_priorities_[*it] = max_successor + 1;
+  }
+
+  root_nodes_by_priority_ = graph_viewer_->GetRootNodes();
+  std::stable_sort(root_nodes_by_priority_.begin(), root_nodes_by_priority_.end(),
+                   [this](NodeIndex a, NodeIndex b) { return node_priorities_[a] > node_priorities_[b]; });
+
   for (auto& node_to_map_pair : subgraph_session_states_) {
     for (auto& attr_name_to_subgraph : node_to_map_pair.second) {
       attr_name_to_subgraph.second->CalculateNodeIndexInfo();
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <functional>
+#include <list>
+#include <map>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -21,6 +24,7 @@
 #include "core/framework/node_index_info.h"
 #include "core/graph/graph_viewer.h"
 #include "core/framework/fuse_nodes_funcs.h"
+#include "core/platform/env.h"
 
 #ifdef USE_EIGEN_THREADPOOL
 #include <unsupported/Eigen/CXX11/ThreadPool>
@@ -34,6 +38,7 @@ class OpKernel;
 class NodeIndexInfo;
 struct SequentialExecutionPlan;
 struct MemoryPatternGroup;
+class SharedWeightsStore;
 
 #ifndef USE_EIGEN_THREADPOOL
 class TaskThreadPool;
@@ -76,6 +81,13 @@ class SessionState {
   */
   const std::unordered_map<int, MLValue>& GetInitializedTensors() const;
 
+  /**
+  * Returns true if name is an initialized tensor that is not also a graph input.
+  * An initializer that is a graph input can be overridden by a feed, so kernels must not
+  * treat its value as constant.
+  */
+  bool IsConstantInitializer(const std::string& name) const;
+
   // execution plan
   void SetExecutionPlan(std::unique_ptr<SequentialExecutionPlan> p_seq_exec_plan);
   const SequentialExecutionPlan* GetExecutionPlan() const;
@@ -103,17 +115,46 @@ class SessionState {
   profiling::Profiler& Profiler() const;
 
   /**
-  Get cached memory pattern based on input shapes
+  Get cached memory pattern based on input shapes.
+  Returns a pattern cached for the bucket the shapes fall in that was generated for shapes at least as large as
+  input_shapes in every dimension. Returns nullptr if there is none, so that the caller traces a new pattern.
+  The returned pattern stays valid for as long as the caller holds on to it, even if it is evicted from the cache.
   */
-  const MemoryPatternGroup* GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes) const;
+  std::shared_ptr<const MemoryPatternGroup> GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes) const;
 
   /**
   Set generated memory pattern with a given input shapes. 
+  Patterns cached for the bucket that were generated for shapes no larger than input_shape in every dimension are
+  replaced. A bucket keeps one pattern for each set of shapes that is not covered by another one, e.g. [2,5] and
+  [3,4], so the bucket converges on the patterns for its largest shapes instead of alternating between them.
   Const as it's an internal cache update only.
   */
   Status UpdateMemoryPatternGroupCache(const std::vector<TensorShape>& input_shape,
                                        std::unique_ptr<MemoryPatternGroup> mem_patterns) const;
 
+  /**
+  Set the maximum number of memory patterns to cache. The least recently used pattern is evicted when
+  the limit is exceeded. 0 means unbounded.
+  */
+  void SetMemoryPatternCacheSize(size_t max_num_patterns);
+
+  /**
+  Set the buckets input dimensions are rounded up to when looking up memory patterns, so that inputs with
+  similar shapes (e.g. sequence lengths) share a pattern. Must be sorted in ascending order.
+  Dimensions larger than the last bucket are used as is.
+  */
+  void SetMemoryPatternDimBuckets(const std::vector<int64_t>& buckets);
+
+  /**
+  Input shapes with each dimension rounded up to its bucket.
+  */
+  std::vector<TensorShape> GetBucketedShapes(const std::vector<TensorShape>& input_shapes) const;
+
+  /**
+  Number of memory patterns currently cached.
+  */
+  size_t GetNumMemoryPatterns() const;
+
   /**
   Set enable memory pattern flag
   */
@@ -124,6 +165,16 @@ class SessionState {
   */
   bool GetEnableMemoryPattern() const;
 
+  /**
+  Set whether parallel execution uses the WorkStealingExecutor instead of the ParallelExecutor
+  */
+  void SetEnableWorkStealing(bool flag) { enable_work_stealing_ = flag; }
+
+  /**
+  Get enable work stealing flag
+  */
+  bool GetEnableWorkStealing() const { return enable_work_stealing_; }
+
   struct NodeInfo {
     NodeInfo(size_t index0, const onnxruntime::Node* p_node0, const KernelCreateInfo* kci0)
         : index(index0),
@@ -165,6 +216,24 @@ class SessionState {
   void SetThreadPool(TaskThreadPool* p_pool) { thread_pool_ = p_pool; }
 #endif
 
+  /**
+  Get the thread pool for kernels that parallelize their own work. This is the session thread pool,
+  which the session creates on the first call if it did not need one for the executor.
+  */
+#ifdef USE_EIGEN_THREADPOOL
+  using ThreadPoolFactory = std::function<Eigen::NonBlockingThreadPool*()>;
+  Eigen::NonBlockingThreadPool* GetOperatorThreadPool() const {
+#else
+  using ThreadPoolFactory = std::function<TaskThreadPool*()>;
+  TaskThreadPool* GetOperatorThreadPool() const {
+#endif
+    if (thread_pool_ == nullptr && thread_pool_factory_) {
+      return thread_pool_factory_();
+    }
+    return thread_pool_;
+  }
+  void SetThreadPoolFactory(ThreadPoolFactory factory) { thread_pool_factory_ = std::move(factory); }
+
   bool ExportDll() const { return export_fused_dll_; }
   void SetExportDllFlag(bool flag) { export_fused_dll_ = flag; }
 
@@ -173,9 +242,30 @@ class SessionState {
 
   std::map<OrtAllocatorInfo, BufferUniquePtr>& GetMutableWeightsBuffers() { return weights_buffers_; }
 
+  // Directory that the locations of initializers stored in external data files are relative to.
+  void SetExternalDataDirectory(const std::string& directory) { external_data_directory_ = directory; }
+  const std::string& GetExternalDataDirectory() const { return external_data_directory_; }
+
+  // File mappings referenced by initialized tensors. They are released with the SessionState.
+  std::vector<Env::MappedMemoryPtr>& GetMutableMappedExternalData() { return mapped_external_data_; }
+
+  // Store used to share CPU initializers with other sessions. Optional.
+  void SetSharedWeightsStore(const std::shared_ptr<SharedWeightsStore>& store) { shared_weights_store_ = store; }
+  SharedWeightsStore* GetSharedWeightsStore() const { return shared_weights_store_.get(); }
+
+  // Initializers from the shared weights store. Holding them keeps them in the store for other sessions.
+  std::vector<std::shared_ptr<const MLValue>>& GetMutableSharedWeights() { return shared_weights_; }
+
   void CalculateNodeIndexInfo();
   const NodeIndexInfo& GetNodeIndexInfo() const;
 
+  // Per node priority used by the work stealing executor, indexed by NodeIndex. The priority of a node is the
+  // number of nodes on the longest path from it to a graph output. Calculated by CalculateNodeIndexInfo.
+  const std::vector<size_t>& GetNodePriorities() const { return node_priorities_; }
+
+  // Root nodes of the graph in descending priority order.
+  const std::vector<NodeIndex>& GetRootNodesByPriority() const { return root_nodes_by_priority_; }
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SessionState);
 
@@ -190,6 +280,10 @@ class SessionState {
   // initialized tensorset
   std::unordered_map<int, MLValue> initialized_tensors_;  // key is mlvalue_index
   std::map<OrtAllocatorInfo, BufferUniquePtr> weights_buffers_;
+  std::string external_data_directory_;
+  std::vector<Env::MappedMemoryPtr> mapped_external_data_;
+  std::shared_ptr<SharedWeightsStore> shared_weights_store_;
+  std::vector<std::shared_ptr<const MLValue>> shared_weights_;
   std::unique_ptr<SequentialExecutionPlan> p_seq_exec_plan_ = nullptr;
 
   const logging::Logger* logger_;
@@ -197,10 +291,23 @@ class SessionState {
 
   // switch for enable memory pattern optimization or not.
   bool enable_mem_pattern_ = true;
+  // switch for using the work stealing executor when running in parallel.
+  bool enable_work_stealing_ = false;
   // lock for the mem_patterns_
   mutable OrtMutex mem_patterns_lock_;
-  // cache for the generated mem_patterns. key is calculated based on input shapes.
-  mutable std::map<int64_t, std::unique_ptr<MemoryPatternGroup>> mem_patterns_;
+  // cache for the generated mem_patterns, most recently used first. key is the (bucketed) input shapes.
+  using MemoryPatternKey = std::vector<int64_t>;
+  struct MemoryPatternEntry {
+    MemoryPatternKey key;
+    std::vector<TensorShape> input_shapes;  // shapes the pattern was generated for
+    std::shared_ptr<const MemoryPatternGroup> patterns;
+  };
+  using MemoryPatternList = std::list<MemoryPatternEntry>;
+  mutable MemoryPatternList mem_patterns_;
+  // a key has one entry per set of input shapes in the bucket that is not covered by another one
+  mutable std::multimap<MemoryPatternKey, MemoryPatternList::iterator> mem_pattern_lookup_;
+  size_t max_num_mem_patterns_ = 0;
+  std::vector<int64_t> mem_pattern_dim_buckets_;
 
   NameNodeInfoMapType input_names_to_nodeinfo_mapping_;
   NameNodeInfoMapType output_names_to_nodeinfo_mapping_;
@@ -216,10 +323,13 @@ class SessionState {
 #else
   TaskThreadPool* thread_pool_ = nullptr;
 #endif
+  ThreadPoolFactory thread_pool_factory_;
 
   bool export_fused_dll_ = false;
   FuncManager fused_funcs_mgr_;
 
   std::unique_ptr<NodeIndexInfo> node_index_info_;
+  std::vector<size_t> node_priorities_;
+  std::vector<NodeIndex> root_nodes_by_priority_;
 };
 }  // namespace onnxruntime
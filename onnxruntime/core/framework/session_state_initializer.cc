@@ -20,6 +20,7 @@
 #include "core/framework/mlvalue_name_idx_map.h"
 #include "core/framework/sequential_execution_plan.h"
 #include "core/framework/session_state.h"
+#include "core/framework/shared_weights_store.h"
 #include "core/framework/tensorutils.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/transformer_memcpy.h"
@@ -39,9 +40,42 @@ static common::Status SaveInitializedTensors(const onnxruntime::Graph& graph,
                                              const ExecutionProviders& exec_providers,
                                              const MLValueNameIdxMap& mlvalue_name_idx_map,
                                              std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
+                                             const std::string& external_data_directory,
+                                             std::vector<Env::MappedMemoryPtr>& mapped_external_data,
+                                             SharedWeightsStore* shared_weights_store,
+                                             std::vector<std::shared_ptr<const MLValue>>& shared_weights,
                                              const SaveTensorFunc& save_tensor_func,
                                              const logging::Logger& logger);
 
+// give the kernel the chance to transform its constant initializer inputs.
+// initializers that are also graph inputs can be overridden by a feed, so they are not passed to the kernel.
+static common::Status PrePackInitializedTensors(const onnxruntime::Node& node,
+                                                const SessionState& session_state,
+                                                OpKernel& op_kernel,
+                                                const logging::Logger& logger) {
+  const auto& mlvalue_name_idx_map = session_state.GetMLValueNameIdxMap();
+  const auto& initialized_tensors = session_state.GetInitializedTensors();
+
+  int input_idx = 0;
+  for (const auto* input_def : node.InputDefs()) {
+    int mlvalue_idx;
+    if (input_def->Exists() && session_state.IsConstantInitializer(input_def->Name()) &&
+        mlvalue_name_idx_map.GetIdx(input_def->Name(), mlvalue_idx).IsOK()) {
+      auto iter = initialized_tensors.find(mlvalue_idx);
+      if (iter != initialized_tensors.end() && iter->second.IsTensor()) {
+        bool is_packed = false;
+        ORT_RETURN_IF_ERROR(op_kernel.PrePack(iter->second.Get<Tensor>(), input_idx, is_packed));
+        if (is_packed) {
+          VLOGS(logger, 1) << "Node " << node.Name() << " packed initializer " << input_def->Name();
+        }
+      }
+    }
+    input_idx++;
+  }
+
+  return Status::OK();
+}
+
 static common::Status SaveKernels(const ExecutionProviders& execution_providers,
                                   SessionState& session_state,
                                   const KernelRegistryManager& custom_registry_manager,
@@ -119,6 +153,10 @@ common::Status SessionStateInitializer::InitializeAndSave(bool enable_memory_pat
 
   ORT_RETURN_IF_ERROR(SaveInitializedTensors(graph_, enable_memory_pattern, exec_plan, execution_providers_,
                                              mlvalue_name_idx_map, session_state_.GetMutableWeightsBuffers(),
+                                             session_state_.GetExternalDataDirectory(),
+                                             session_state_.GetMutableMappedExternalData(),
+                                             session_state_.GetSharedWeightsStore(),
+                                             session_state_.GetMutableSharedWeights(),
                                              add_initialized_tensor, logger_));
 
   graph_.CleanAllInitializedTensors();  // remove weights from the graph now to save memory
@@ -232,7 +270,96 @@ common::Status DeserializeTensorProto(const ONNX_NAMESPACE::TensorProto& tensor_
   return common::Status::OK();
 }
 
+// Create a tensor for an initializer whose data is stored in an external file.
+// The file is mapped into memory and CPU tensors reference the mapping directly, so the weights are paged in
+// from the file on first use rather than being copied. The mapping is kept alive in mapped_external_data.
+// Tensors on other devices, or data that is not suitably aligned in the file, are copied from the mapping.
+static common::Status DeserializeExternalTensorProto(const ONNX_NAMESPACE::TensorProto& tensor_proto,
+                                                     const OrtAllocatorInfo& alloc_info,
+                                                     const ExecutionProviders& exec_providers,
+                                                     const std::string& external_data_directory,
+                                                     std::vector<Env::MappedMemoryPtr>& mapped_external_data,
+                                                     MLValue& mlvalue) {
+  const auto element_type = utils::GetElementTypeFromTensorProto(tensor_proto);
+  if (element_type == nullptr || element_type == DataTypeImpl::GetType<std::string>()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Unsupported type for external data in tensor ",
+                           tensor_proto.name());
+  }
+
+  std::string file_path;
+  size_t offset;
+  size_t length;
+  ORT_RETURN_IF_ERROR(utils::GetExternalDataInfo(tensor_proto, external_data_directory, file_path, offset, length));
+
+  TensorShape shape{utils::GetTensorShapeFromTensorProto(tensor_proto)};
+  if (static_cast<size_t>(shape.Size()) * element_type->Size() != length) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_PROTOBUF, "External data length of ", length,
+                           " does not match the shape of tensor ", tensor_proto.name());
+  }
+
+  Env::MappedMemoryPtr mapped_memory;
+  ORT_RETURN_IF_ERROR(Env::Default().MapFileIntoMemory(file_path, offset, length, mapped_memory));
+
+  auto cpu_alloc_ptr = exec_providers.Get(kCpuExecutionProvider)->GetAllocator(0, OrtMemTypeDefault);
+  const bool is_cpu = strcmp(alloc_info.name, CPU) == 0 || alloc_info.mem_type == OrtMemTypeCPUOutput;
+  const bool is_aligned = reinterpret_cast<uintptr_t>(mapped_memory.get()) % element_type->Size() == 0;
+
+  // view of the mapped data. no deleter as the mapping owns the memory.
+  auto p_mapped_tensor = std::make_unique<Tensor>(element_type, shape, mapped_memory.get(), cpu_alloc_ptr->Info());
+
+  if (is_cpu && is_aligned) {
+    mlvalue.Init(p_mapped_tensor.release(),
+                 DataTypeImpl::GetType<Tensor>(),
+                 DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+    mapped_external_data.push_back(std::move(mapped_memory));
+    return Status::OK();
+  }
+
+  auto alloc_ptr = utils::GetAllocator(exec_providers, alloc_info);
+  if (!alloc_ptr) {
+    return Status(common::ONNXRUNTIME, common::FAIL, "Failed to get allocator for alloc_info: " + alloc_info.ToString());
+  }
+
+  auto p_tensor = std::make_unique<Tensor>(element_type, shape, alloc_ptr->Alloc(length), alloc_info, alloc_ptr);
+  if (is_cpu) {
+    memcpy(p_tensor->MutableDataRaw(), mapped_memory.get(), length);
+  } else {
+    const IExecutionProvider* provider = exec_providers.Get(alloc_info);
+    ORT_ENFORCE(provider != nullptr);
+    ORT_RETURN_IF_ERROR(provider->CopyTensor(*p_mapped_tensor, *p_tensor));
+  }
+
+  mlvalue.Init(p_tensor.release(),
+               DataTypeImpl::GetType<Tensor>(),
+               DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+
+  return Status::OK();
+}
+
+// CPU initializers can be shared with other sessions via the SharedWeightsStore.
+// External data isn't added to the store as the file mapping is already shared via the OS page cache.
+static bool UseSharedWeightsStore(const SharedWeightsStore* shared_weights_store,
+                                  const ONNX_NAMESPACE::TensorProto& tensor_proto,
+                                  const OrtAllocatorInfo& location) {
+  return shared_weights_store != nullptr && !utils::HasExternalData(tensor_proto) &&
+         (strcmp(location.name, CPU) == 0 || location.mem_type == OrtMemTypeCPUOutput);
+}
+
+static common::Status GetSharedTensor(SharedWeightsStore& shared_weights_store,
+                                      const ONNX_NAMESPACE::TensorProto& tensor_proto,
+                                      std::vector<std::shared_ptr<const MLValue>>& shared_weights,
+                                      MLValue& mlvalue) {
+  std::shared_ptr<const MLValue> shared_value;
+  ORT_RETURN_IF_ERROR(shared_weights_store.GetOrCreate(tensor_proto, shared_value));
+  mlvalue = *shared_value;
+  shared_weights.push_back(std::move(shared_value));
+  return Status::OK();
+}
+
 static common::Status PlanTensor(MLValuePatternPlanner& planner, const MLValueNameIdxMap& mlvalue_name_idx_map, const std::string& name, const ONNX_NAMESPACE::TensorProto& tensor_proto) {
+  // external data is mapped from its file rather than copied into the weights buffer
+  if (utils::HasExternalData(tensor_proto)) return Status::OK();
+
   int mlvalue_index;
   ORT_RETURN_IF_ERROR(mlvalue_name_idx_map.GetIdx(name, mlvalue_index));
   size_t len;
@@ -247,6 +374,10 @@ common::Status SaveInitializedTensorsWithMemPattern(const Graph& graph,
                                                     const ExecutionProviders& exec_providers,
                                                     const MLValueNameIdxMap& mlvalue_name_idx_map,
                                                     std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
+                                                    const std::string& external_data_directory,
+                                                    std::vector<Env::MappedMemoryPtr>& mapped_external_data,
+                                                    SharedWeightsStore* shared_weights_store,
+                                                    std::vector<std::shared_ptr<const MLValue>>& shared_weights,
                                                     const SaveTensorFunc& save_tensor_func,
                                                     const logging::Logger& logger) {
   LOGS(logger, INFO) << "Saving initialized tensors.";
@@ -258,6 +389,15 @@ common::Status SaveInitializedTensorsWithMemPattern(const Graph& graph,
   //1. first plan the memory
   const onnxruntime::InitializedTensorSet& initialized_tensor_set = graph.GetAllInitializedTensors();
   for (const auto& entry : initialized_tensor_set) {
+    int mlvalue_index;
+    ORT_RETURN_IF_ERROR(mlvalue_name_idx_map.GetIdx(entry.first, mlvalue_index));
+
+    // shared weights are not part of the weights buffer
+    if (UseSharedWeightsStore(shared_weights_store, *entry.second,
+                              execution_plan.allocation_plan[mlvalue_index].location)) {
+      continue;
+    }
+
     //string/complex64/complex128 tensors will be skipped
     ORT_RETURN_IF_ERROR(PlanTensor(planner, mlvalue_name_idx_map, entry.first, *entry.second));
   }
@@ -287,6 +427,23 @@ common::Status SaveInitializedTensorsWithMemPattern(const Graph& graph,
     const ONNX_NAMESPACE::TensorProto& tensor_proto = *(entry.second);
 
     auto& location = execution_plan.allocation_plan[mlvalue_index].location;
+
+    if (UseSharedWeightsStore(shared_weights_store, tensor_proto, location)) {
+      MLValue mlvalue;
+      ORT_RETURN_IF_ERROR(GetSharedTensor(*shared_weights_store, tensor_proto, shared_weights, mlvalue));
+      save_tensor_func(mlvalue_index, mlvalue);
+      continue;
+    }
+
+    // external data was not planned into the weights buffer
+    if (utils::HasExternalData(tensor_proto)) {
+      MLValue mlvalue;
+      ORT_RETURN_IF_ERROR(DeserializeExternalTensorProto(tensor_proto, location, exec_providers,
+                                                         external_data_directory, mapped_external_data, mlvalue));
+      save_tensor_func(mlvalue_index, mlvalue);
+      continue;
+    }
+
     auto it = weights_buffers.find(location);
     if (it == weights_buffers.end())
       return Status(common::ONNXRUNTIME, common::FAIL, "Weight buffer not found");
@@ -329,6 +486,10 @@ common::Status SaveInitializedTensorsWithSeperateBuffer(const onnxruntime::Graph
                                                         const SequentialExecutionPlan& execution_plan,
                                                         const ExecutionProviders& exec_providers,
                                                         const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                                        const std::string& external_data_directory,
+                                                        std::vector<Env::MappedMemoryPtr>& mapped_external_data,
+                                                        SharedWeightsStore* shared_weights_store,
+                                                        std::vector<std::shared_ptr<const MLValue>>& shared_weights,
                                                         const SaveTensorFunc& save_tensor_func,
                                                         const logging::Logger& logger) {
   LOGS(logger, INFO) << "Saving initialized tensors.";
@@ -343,7 +504,14 @@ common::Status SaveInitializedTensorsWithSeperateBuffer(const onnxruntime::Graph
     VLOGS(logger, 1) << "About to add weight with name: " << name << " and index: " << mlvalue_index;
     auto& location = execution_plan.allocation_plan[mlvalue_index].location;
     MLValue mlvalue;
-    ORT_RETURN_IF_ERROR(DeserializeTensorProto(*(entry.second), location, exec_providers, mlvalue, nullptr, 0));
+    if (UseSharedWeightsStore(shared_weights_store, *(entry.second), location)) {
+      ORT_RETURN_IF_ERROR(GetSharedTensor(*shared_weights_store, *(entry.second), shared_weights, mlvalue));
+    } else if (utils::HasExternalData(*(entry.second))) {
+      ORT_RETURN_IF_ERROR(DeserializeExternalTensorProto(*(entry.second), location, exec_providers,
+                                                         external_data_directory, mapped_external_data, mlvalue));
+    } else {
+      ORT_RETURN_IF_ERROR(DeserializeTensorProto(*(entry.second), location, exec_providers, mlvalue, nullptr, 0));
+    }
     save_tensor_func(mlvalue_index, mlvalue);
     VLOGS(logger, 1) << "Added weight with name : " << name << " with index: " << mlvalue_index;
   }
@@ -358,6 +526,10 @@ common::Status SaveInitializedTensors(const onnxruntime::Graph& graph,
                                       const ExecutionProviders& exec_providers,
                                       const MLValueNameIdxMap& mlvalue_name_idx_map,
                                       std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
+                                      const std::string& external_data_directory,
+                                      std::vector<Env::MappedMemoryPtr>& mapped_external_data,
+                                      SharedWeightsStore* shared_weights_store,
+                                      std::vector<std::shared_ptr<const MLValue>>& shared_weights,
                                       const SaveTensorFunc& save_tensor_func,
                                       const logging::Logger& logger) {
   // if we enable the memory pattern and already have the execution plan
@@ -365,10 +537,16 @@ common::Status SaveInitializedTensors(const onnxruntime::Graph& graph,
   // the weights.
   if (enable_memory_pattern) {
     return SaveInitializedTensorsWithMemPattern(graph, execution_plan, exec_providers,
-                                                mlvalue_name_idx_map, weights_buffers, save_tensor_func, logger);
+                                                mlvalue_name_idx_map, weights_buffers,
+                                                external_data_directory, mapped_external_data,
+                                                shared_weights_store, shared_weights,
+                                                save_tensor_func, logger);
   }
   return SaveInitializedTensorsWithSeperateBuffer(graph, execution_plan, exec_providers,
-                                                  mlvalue_name_idx_map, save_tensor_func, logger);
+                                                  mlvalue_name_idx_map,
+                                                  external_data_directory, mapped_external_data,
+                                                  shared_weights_store, shared_weights,
+                                                  save_tensor_func, logger);
 }
 
 static common::Status CreateOpKernelInternal(const onnxruntime::Node& node,
@@ -415,6 +593,7 @@ common::Status SaveKernels(const ExecutionProviders& execution_providers,
     // construct and save the kernels
     std::unique_ptr<OpKernel> op_kernel;
     ORT_RETURN_IF_ERROR(CreateOpKernel(node, execution_providers, session_state, custom_registry_manager, op_kernel, logger));
+    ORT_RETURN_IF_ERROR(PrePackInitializedTensors(node, session_state, *op_kernel, logger));
     session_state.AddKernel(node.Index(), std::move(op_kernel));
   }
 
@@ -0,0 +1,255 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/shared_weights_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+
+#include "core/framework/tensor.h"
+#include "core/framework/tensorprotoutils.h"
+#include "core/graph/onnx_protobuf.h"
+
+namespace onnxruntime {
+
+static size_t ComputeContentHash(const ONNX_NAMESPACE::TensorProto& tensor_proto) {
+  // combine the same way as boost::hash_combine
+  auto hash_combine = [](size_t& seed, size_t value) {
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  };
+
+  size_t hash = std::hash<int>()(tensor_proto.data_type());
+  for (auto dim : tensor_proto.dims()) {
+    hash_combine(hash, std::hash<int64_t>()(dim));
+  }
+
+  // large initializers are stored in raw_data which can be hashed without copying.
+  // otherwise hash the serialized proto, which includes the typed data fields.
+  if (tensor_proto.has_raw_data()) {
+    hash_combine(hash, std::hash<std::string>()(tensor_proto.raw_data()));
+  } else {
+    hash_combine(hash, std::hash<std::string>()(tensor_proto.SerializeAsString()));
+  }
+
+  return hash;
+}
+
+// compare the bytes of a shared weight with the initializer data, to guard against a hash collision.
+// returns false if the data can't be compared without deserializing the initializer, which is the case for
+// strings and for the types that are widened to int32_data.
+static bool MatchesProtoData(const ONNX_NAMESPACE::TensorProto& tensor_proto, const Tensor& tensor) {
+  if (tensor.DataType() != utils::GetElementTypeFromTensorProto(tensor_proto) ||
+      tensor.Shape() != TensorShape(utils::GetTensorShapeFromTensorProto(tensor_proto))) {
+    return false;
+  }
+
+  const void* data = nullptr;
+  size_t num_bytes = 0;
+  if (tensor_proto.has_raw_data()) {
+    data = tensor_proto.raw_data().data();
+    num_bytes = tensor_proto.raw_data().size();
+  } else {
+    switch (tensor_proto.data_type()) {
+      case ONNX_NAMESPACE::TensorProto_DataType_FLOAT:
+        data = tensor_proto.float_data().data();
+        num_bytes = tensor_proto.float_data_size() * sizeof(float);
+        break;
+      case ONNX_NAMESPACE::TensorProto_DataType_DOUBLE:
+        data = tensor_proto.double_data().data();
+        num_bytes = tensor_proto.double_data_size() * sizeof(double);
+        break;
+      case ONNX_NAMESPACE::TensorProto_DataType_INT32:
+        data = tensor_proto.int32_data().data();
+        num_bytes = tensor_proto.int32_data_size() * sizeof(int32_t);
+        break;
+      case ONNX_NAMESPACE::TensorProto_DataType_INT64:
+        data = tensor_proto.int64_data().data();
+        num_bytes = tensor_proto.int64_data_size() * sizeof(int64_t);
+        break;
+      case ONNX_NAMESPACE::TensorProto_DataType_UINT64:
+        data = tensor_proto.uint64_data().data();
+        num_bytes = tensor_proto.uint64_data_size() * sizeof(uint64_t);
+        break;
+      default:
+        return false;
+    }
+  }
+
+  return num_bytes == tensor.Size() && (num_bytes == 0 || memcmp(data, tensor.DataRaw(), num_bytes) == 0);
+}
+
+// compare a shared weight with a deserialized copy of the initializer
+static bool MatchesTensor(const Tensor& tensor, const Tensor& other) {
+  if (tensor.DataType() != other.DataType() || tensor.Shape() != other.Shape()) {
+    return false;
+  }
+
+  if (tensor.DataType() == DataTypeImpl::GetType<std::string>()) {
+    const auto* strings = tensor.Data<std::string>();
+    return std::equal(strings, strings + tensor.Shape().Size(), other.Data<std::string>());
+  }
+
+  return tensor.Size() == 0 || memcmp(tensor.DataRaw(), other.DataRaw(), tensor.Size()) == 0;
+}
+
+// minimum number of entries before PruneExpiredEntries walks the maps
+static constexpr size_t kMinPruneThreshold = 64;
+
+SharedWeightsStore::SharedWeightsStore()
+    : allocator_{std::make_shared<CPUAllocator>()}, prune_threshold_{kMinPruneThreshold} {}
+
+std::shared_ptr<const MLValue> SharedWeightsStore::FindEntry(const Key& key) const {
+  auto entry = entries_.find(key);
+  return entry != entries_.end() ? entry->second.lock() : nullptr;
+}
+
+bool SharedWeightsStore::FindWeightKey(const void* data, Key& key) const {
+  auto weight_key = weight_keys_.find(data);
+  if (weight_key == weight_keys_.end()) {
+    return false;
+  }
+
+  // the entry may be stale if the weight was released and its memory reused
+  auto value = FindEntry(weight_key->second);
+  if (!value || value->Get<Tensor>().DataRaw() != data) {
+    return false;
+  }
+
+  key = weight_key->second;
+  return true;
+}
+
+void SharedWeightsStore::PruneExpiredEntries() {
+  if (entries_.size() + weight_keys_.size() + packed_entries_.size() < prune_threshold_) {
+    return;
+  }
+
+  for (auto it = packed_entries_.begin(); it != packed_entries_.end();) {
+    it = it->second.expired() ? packed_entries_.erase(it) : std::next(it);
+  }
+
+  // checked before entries_ is pruned as FindWeightKey looks up the entry of the weight
+  for (auto it = weight_keys_.begin(); it != weight_keys_.end();) {
+    Key key;
+    it = !FindWeightKey(it->first, key) ? weight_keys_.erase(it) : std::next(it);
+  }
+
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    it = it->second.expired() ? entries_.erase(it) : std::next(it);
+  }
+
+  prune_threshold_ = std::max(kMinPruneThreshold,
+                              2 * (entries_.size() + weight_keys_.size() + packed_entries_.size()));
+}
+
+Status SharedWeightsStore::GetOrCreate(const ONNX_NAMESPACE::TensorProto& tensor_proto,
+                                       std::shared_ptr<const MLValue>& value) {
+  if (utils::HasExternalData(tensor_proto)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Initializer ", tensor_proto.name(),
+                           " uses external data and can't be added to the shared weights store.");
+  }
+
+  Key key{tensor_proto.name(), ComputeContentHash(tensor_proto)};
+
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    auto existing = FindEntry(key);
+    if (existing && MatchesProtoData(tensor_proto, existing->Get<Tensor>())) {
+      value = std::move(existing);
+      return Status::OK();
+    }
+  }
+
+  // deserialize without holding the lock so sessions loading other weights aren't blocked. if several sessions
+  // create the same weight concurrently, the first one to publish it wins and the other copies are released.
+  auto mlvalue = std::make_shared<MLValue>();
+  ORT_RETURN_IF_ERROR(utils::TensorProtoToMLValue(tensor_proto, allocator_, nullptr, 0, *mlvalue));
+  const auto& tensor = mlvalue->Get<Tensor>();
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  auto existing = FindEntry(key);
+  if (existing) {
+    // a live entry that doesn't match is left in place and the new value is not shared
+    value = MatchesTensor(existing->Get<Tensor>(), tensor) ? std::move(existing) : std::move(mlvalue);
+    return Status::OK();
+  }
+
+  PruneExpiredEntries();
+
+  // empty tensors have nothing to pack, and may not have a unique data pointer
+  if (tensor.Size() > 0) {
+    weight_keys_[tensor.DataRaw()] = key;
+  }
+  entries_[std::move(key)] = mlvalue;
+  value = std::move(mlvalue);
+
+  return Status::OK();
+}
+
+bool SharedWeightsStore::IsSharedWeight(const Tensor& tensor) const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  Key key;
+  return FindWeightKey(tensor.DataRaw(), key);
+}
+
+Status SharedWeightsStore::GetOrCreatePacked(const Tensor& weight, const std::string& pack_key, size_t size,
+                                             const std::function<void(void*)>& pack_fn,
+                                             std::shared_ptr<void>& buffer) {
+  std::pair<Key, std::string> packed_key;
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    if (!FindWeightKey(weight.DataRaw(), packed_key.first)) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Packed weight ", pack_key,
+                             " was not created from a weight in the shared weights store.");
+    }
+
+    packed_key.second = pack_key;
+    auto entry = packed_entries_.find(packed_key);
+    if (entry != packed_entries_.end() && (buffer = entry->second.lock()) != nullptr) {
+      return Status::OK();
+    }
+  }
+
+  // pack without holding the lock, the same way GetOrCreate deserializes
+  auto allocator = allocator_;
+  std::shared_ptr<void> packed(allocator->Alloc(size), [allocator](void* p) { allocator->Free(p); });
+  pack_fn(packed.get());
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  PruneExpiredEntries();
+  auto& entry = packed_entries_[packed_key];
+  buffer = entry.lock();
+  if (!buffer) {
+    entry = packed;
+    buffer = std::move(packed);
+  }
+
+  return Status::OK();
+}
+
+size_t SharedWeightsStore::NumEntries() const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  size_t num_entries = 0;
+  for (const auto& entry : entries_) {
+    if (!entry.second.expired()) {
+      ++num_entries;
+    }
+  }
+
+  return num_entries;
+}
+
+size_t SharedWeightsStore::NumPackedEntries() const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  size_t num_entries = 0;
+  for (const auto& entry : packed_entries_) {
+    if (!entry.second.expired()) {
+      ++num_entries;
+    }
+  }
+
+  return num_entries;
+}
+}  // namespace onnxruntime
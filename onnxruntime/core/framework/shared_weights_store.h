@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ml_value.h"
+#include "core/platform/ort_mutex.h"
+
+namespace ONNX_NAMESPACE {
+class TensorProto;
+}  // namespace ONNX_NAMESPACE
+
+namespace onnxruntime {
+
+/**
+  * @brief Read-only store of CPU initializers that can be shared by multiple sessions loading the same model,
+  * so that N sessions of a model hold one copy of the weights instead of N.
+  * Entries are keyed by initializer name and a hash of the tensor content. The store only holds weak references,
+  * so a weight is released once the last session using it is destroyed. The entries of released weights are erased
+  * when new entries are added.
+  * Buffers that kernels derive from a shared weight in OpKernel::PrePack are shared the same way, keyed by the weight
+  * and the packing, so N sessions also hold one copy of each packed weight.
+  * Attach an instance to each session via SessionOptions::shared_weights_store. Thread-safe.
+  */
+class SharedWeightsStore {
+ public:
+  SharedWeightsStore();
+
+  /**
+    * Get the shared value for an initializer, deserializing it if no session currently holds it.
+    * @param tensor_proto initializer. Must not use external data.
+    * @param value the shared value. The caller must hold it for as long as it uses the tensor.
+    */
+  common::Status GetOrCreate(const ONNX_NAMESPACE::TensorProto& tensor_proto, std::shared_ptr<const MLValue>& value);
+
+  // Check if tensor is a weight returned by GetOrCreate that is still held by a session.
+  bool IsSharedWeight(const Tensor& tensor) const;
+
+  /**
+    * Get the shared buffer a kernel derives from a shared weight, such as a prepacked GEMM matrix, creating it if no
+    * session currently holds it.
+    * @param weight tensor for which IsSharedWeight returns true.
+    * @param pack_key identifies the kernel type and any parameters that change the packed data.
+    * @param size size of the buffer in bytes.
+    * @param pack_fn writes the packed data to the buffer. Called without holding the store's lock.
+    * @param buffer the shared buffer. The caller must hold it for as long as it uses the packed data.
+    */
+  common::Status GetOrCreatePacked(const Tensor& weight, const std::string& pack_key, size_t size,
+                                   const std::function<void(void*)>& pack_fn, std::shared_ptr<void>& buffer);
+
+  // Number of weights currently held by one or more sessions.
+  size_t NumEntries() const;
+
+  // Number of packed buffers currently held by one or more sessions.
+  size_t NumPackedEntries() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SharedWeightsStore);
+
+  using Key = std::pair<std::string, size_t>;  // initializer name, content hash
+
+  // weights are allocated from a plain CPU allocator as memory from a session's arena can't outlive the session
+  AllocatorPtr allocator_;
+
+  // find the live value for key. returns nullptr if there is none.
+  std::shared_ptr<const MLValue> FindEntry(const Key& key) const;  // REQUIRES(mutex_)
+
+  // find the key of the live weight that owns data. returns false if data isn't owned by a shared weight.
+  bool FindWeightKey(const void* data, Key& key) const;  // REQUIRES(mutex_)
+
+  // erase the entries of released weights and packed buffers once the maps have doubled in size since the last
+  // time, so the cost is amortized over the insertions and the maps stay proportional to the live entries.
+  void PruneExpiredEntries();  // REQUIRES(mutex_)
+
+  mutable OrtMutex mutex_;
+  std::map<Key, std::weak_ptr<const MLValue>> entries_;  // GUARDED_BY(mutex_)
+  std::map<const void*, Key> weight_keys_;                // GUARDED_BY(mutex_)
+  std::map<std::pair<Key, std::string>, std::weak_ptr<void>> packed_entries_;  // GUARDED_BY(mutex_)
+  size_t prune_threshold_;                                                      // GUARDED_BY(mutex_)
+};
+}  // namespace onnxruntime
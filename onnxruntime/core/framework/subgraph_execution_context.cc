@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/subgraph_execution_context.h"
+
+#include "core/framework/execution_frame.h"
+#include "core/framework/execution_providers.h"
+#include "core/framework/sequential_executor.h"
+#include "core/framework/session_state.h"
+#include "core/framework/utils.h"
+
+namespace onnxruntime {
+
+SubgraphExecutionContext::SubgraphExecutionContext(const SessionState& session_state,
+                                                   const std::vector<std::string>& feed_names,
+                                                   const std::vector<std::string>& output_names)
+    : session_state_(session_state),
+      feed_names_(feed_names),
+      output_names_(output_names),
+      // If we only have one provider it's the CPU provider as that is always automatically registered.
+      // In that case no copy to/from other devices is required and we can execute directly using the frame.
+      use_frame_(session_state.GetExecutionProviders().NumProviders() == 1) {
+  const auto& mlvalue_idx_map = session_state_.GetMLValueNameIdxMap();
+
+  auto map_names = [&mlvalue_idx_map](const std::vector<std::string>& names, std::vector<int>& idxs) {
+    idxs.reserve(names.size());
+    for (const auto& name : names) {
+      int mlvalue_idx;
+      Status status = mlvalue_idx_map.GetIdx(name, mlvalue_idx);
+      ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+      idxs.push_back(mlvalue_idx);
+    }
+  };
+
+  map_names(feed_names_, feed_mlvalue_idxs_);
+  map_names(output_names_, fetch_mlvalue_idxs_);
+}
+
+SubgraphExecutionContext::~SubgraphExecutionContext() = default;
+
+Status SubgraphExecutionContext::Execute(const std::vector<MLValue>& feeds,
+                                         std::vector<MLValue>& fetches,
+                                         const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
+                                         const bool& terminate_flag,
+                                         const logging::Logger& logger) {
+  ORT_ENFORCE(feeds.size() == feed_names_.size(),
+              "Expected ", feed_names_.size(), " feeds but got ", feeds.size());
+
+  if (!use_frame_) {
+    // fall back to the name based execution which handles copying feeds and fetches across devices
+    NameMLValMap name_feeds;
+    name_feeds.reserve(feeds.size());
+    for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+      name_feeds[feed_names_[i]] = feeds[i];
+    }
+
+    return utils::ExecuteGraph(session_state_, name_feeds, output_names_, fetches, fetch_allocators,
+                               /*sequential_execution*/ true, terminate_flag, logger);
+  }
+
+  if (frame_) {
+    frame_->Reset(feeds, fetches, fetch_allocators);
+  } else {
+    frame_ = std::make_unique<ExecutionFrame>(feed_mlvalue_idxs_, feeds, fetch_mlvalue_idxs_, fetches,
+                                              fetch_allocators, session_state_);
+  }
+
+  SequentialExecutor executor{terminate_flag};
+  return executor.Execute(*frame_, fetch_mlvalue_idxs_, fetches, logger);
+}
+}  // namespace onnxruntime
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/common/logging/logging.h"
+#include "core/framework/iexecutor.h"
+#include "core/framework/ml_value.h"
+
+namespace onnxruntime {
+class ExecutionFrame;
+class SessionState;
+
+/**
+Class to repeatedly execute a subgraph, as is done by the Scan and Loop operators.
+
+The feed and output names are mapped to MLValue indexes once, and the ExecutionFrame and any memory pattern
+it is using are kept alive between executions so the per-iteration cost is limited to binding the new
+feeds and fetches.
+
+Feeds and fetches are provided by position and must be in the same order as the names provided when the
+instance was created.
+
+An instance must only be used by a single thread at a time.
+*/
+class SubgraphExecutionContext {
+ public:
+  SubgraphExecutionContext(const SessionState& session_state,
+                           const std::vector<std::string>& feed_names,
+                           const std::vector<std::string>& output_names);
+
+  ~SubgraphExecutionContext();
+
+  common::Status Execute(const std::vector<MLValue>& feeds,
+                         std::vector<MLValue>& fetches,
+                         const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
+                         const bool& terminate_flag,
+                         const logging::Logger& logger);
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SubgraphExecutionContext);
+
+  const SessionState& session_state_;
+  const std::vector<std::string> feed_names_;
+  const std::vector<std::string> output_names_;
+
+  std::vector<int> feed_mlvalue_idxs_;
+  std::vector<int> fetch_mlvalue_idxs_;
+
+  // true if device copies may be required, in which case we can't re-use the frame
+  bool use_frame_;
+  std::unique_ptr<ExecutionFrame> frame_;
+};
+}  // namespace onnxruntime
@@ -214,6 +214,76 @@ common::Status GetTensorFromTensorProto(const TensorProto& tensor_proto,
   }
 }
 
+#define CASE_ELEMENT_TYPE(X, Y)                                        \
+  case ONNX_NAMESPACE::TensorProto_DataType::TensorProto_DataType_##X: \
+    return DataTypeImpl::GetType<Y>();
+
+MLDataType GetElementTypeFromTensorProto(const TensorProto& tensor_proto) {
+  switch (tensor_proto.data_type()) {
+    CASE_ELEMENT_TYPE(FLOAT, float);
+    CASE_ELEMENT_TYPE(DOUBLE, double);
+    CASE_ELEMENT_TYPE(BOOL, bool);
+    CASE_ELEMENT_TYPE(INT8, int8_t);
+    CASE_ELEMENT_TYPE(INT16, int16_t);
+    CASE_ELEMENT_TYPE(INT32, int32_t);
+    CASE_ELEMENT_TYPE(INT64, int64_t);
+    CASE_ELEMENT_TYPE(UINT8, uint8_t);
+    CASE_ELEMENT_TYPE(UINT16, uint16_t);
+    CASE_ELEMENT_TYPE(UINT32, uint32_t);
+    CASE_ELEMENT_TYPE(UINT64, uint64_t);
+    CASE_ELEMENT_TYPE(STRING, std::string);
+    CASE_ELEMENT_TYPE(FLOAT16, MLFloat16);
+    CASE_ELEMENT_TYPE(BFLOAT16, BFloat16);
+    default:
+      return nullptr;
+  }
+}
+
+bool HasExternalData(const TensorProto& tensor_proto) {
+  return tensor_proto.has_data_location() &&
+         tensor_proto.data_location() == TensorProto_DataLocation_EXTERNAL;
+}
+
+common::Status GetExternalDataInfo(const TensorProto& tensor_proto,
+                                   const std::string& tensor_proto_dir,
+                                   std::string& external_file_path,
+                                   size_t& offset,
+                                   size_t& length) {
+  std::string location;
+  bool has_length = false;
+  offset = 0;
+  length = 0;
+
+  for (const auto& entry : tensor_proto.external_data()) {
+    try {
+      if (entry.key() == "location") {
+        location = entry.value();
+      } else if (entry.key() == "offset") {
+        offset = static_cast<size_t>(std::stoull(entry.value()));
+      } else if (entry.key() == "length") {
+        length = static_cast<size_t>(std::stoull(entry.value()));
+        has_length = true;
+      }
+    } catch (const std::exception&) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_PROTOBUF, "Invalid value '", entry.value(), "' for external data ",
+                             entry.key(), " of tensor ", tensor_proto.name());
+    }
+  }
+
+  if (location.empty()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_PROTOBUF, "Missing external data location for tensor ",
+                           tensor_proto.name());
+  }
+
+  // the length is optional. without it the data runs to the size implied by the type and shape.
+  if (!has_length) {
+    ORT_RETURN_IF_ERROR(GetSizeInBytesFromTensorProto<0>(tensor_proto, &length));
+  }
+
+  external_file_path = tensor_proto_dir.empty() ? location : tensor_proto_dir + "/" + location;
+  return Status::OK();
+}
+
 TensorProto::DataType GetTensorProtoType(const Tensor& tensor) {
   auto tensor_type = tensor.DataType();
   TensorProto::DataType dtype = TensorProto_DataType_UNDEFINED;
@@ -25,5 +25,19 @@ std::vector<int64_t> GetTensorShapeFromTensorShapeProto(const ONNX_NAMESPACE::Te
 common::Status TensorProtoToMLValue(const ONNX_NAMESPACE::TensorProto& input, AllocatorPtr allocator, void* preallocated,
                                     size_t preallocated_size, MLValue& value);
 ONNX_NAMESPACE::TensorProto::DataType GetTensorProtoType(const Tensor& tensor);
+
+// Get the element type of a tensor proto. Returns nullptr for unsupported types.
+MLDataType GetElementTypeFromTensorProto(const ONNX_NAMESPACE::TensorProto& tensor_proto);
+
+// Whether the data of the tensor is stored in a file outside of the model (ONNX external data).
+bool HasExternalData(const ONNX_NAMESPACE::TensorProto& tensor_proto);
+
+// Get the file, offset and length of the external data of a tensor.
+// @param tensor_proto_dir directory the location in the tensor proto is relative to. Usually the model directory.
+common::Status GetExternalDataInfo(const ONNX_NAMESPACE::TensorProto& tensor_proto,
+                                   const std::string& tensor_proto_dir,
+                                   std::string& external_file_path,
+                                   size_t& offset,
+                                   size_t& length);
 }  // namespace utils
 }  // namespace onnxruntime
@@ -13,6 +13,7 @@
 #include "core/framework/parallel_executor.h"
 #include "core/framework/session_state.h"
 #include "core/framework/sequential_executor.h"
+#include "core/framework/work_stealing_executor.h"
 
 namespace onnxruntime {
 namespace utils {
@@ -334,6 +335,8 @@ common::Status ExecuteGraph(const SessionState& session_state,
 
   if (sequential_execution) {
     p_exec = std::unique_ptr<IExecutor>(new SequentialExecutor(terminate_flag));
+  } else if (session_state.GetEnableWorkStealing()) {
+    p_exec = std::unique_ptr<IExecutor>(new WorkStealingExecutor(session_state, terminate_flag));
   } else {
     p_exec = std::unique_ptr<IExecutor>(new ParallelExecutor(session_state, terminate_flag));
   }
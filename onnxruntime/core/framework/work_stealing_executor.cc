@@ -0,0 +1,445 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/work_stealing_executor.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "core/common/common.h"
+#include "core/common/logging/logging.h"
+
+#ifndef USE_EIGEN_THREADPOOL
+#include "core/common/task_thread_pool.h"
+#endif
+
+#include "core/framework/allocation_planner.h"
+#include "core/framework/execution_frame.h"
+#include "core/framework/session_state.h"
+#include "core/framework/op_kernel_context_internal.h"
+
+namespace onnxruntime {
+
+WorkStealingExecutor::WorkStealingExecutor(const SessionState& session_state, const bool& terminate_flag)
+    : priorities_{&session_state.GetNodePriorities()}, terminate_flag_{terminate_flag} {
+  auto graph_viewer = session_state.GetGraphViewer();
+  const auto max_node_index = static_cast<size_t>(graph_viewer->MaxNodeIndex());
+  ORT_ENFORCE(priorities_->size() == max_node_index,
+              "Node priorities have not been calculated. CalculateNodeIndexInfo must be called first.");
+
+  node_refs_ = std::make_unique<std::atomic<int>[]>(max_node_index);
+
+  for (auto& node : graph_viewer->Nodes()) {
+    node_refs_[node.Index()].store(static_cast<int>(node.GetInputEdgesCount()), std::memory_order_relaxed);
+    ++num_nodes_;
+  }
+}
+
+Status WorkStealingExecutor::Execute(const SessionState& session_state,
+                                     const NameMLValMap& feeds,
+                                     const std::vector<std::string>& output_names,
+                                     std::vector<MLValue>& fetches,
+                                     const std::unordered_map<size_t, CustomAllocator> fetch_allocators,
+                                     const logging::Logger& logger) {
+  TimePoint tp;
+  bool f_profiler_enabled = session_state.Profiler().FEnabled();
+  if (f_profiler_enabled) {
+    tp = session_state.Profiler().StartTime();
+  }
+
+  root_frame_ = std::make_unique<ExecutionFrame>(feeds, output_names, fetches, fetch_allocators, session_state);
+  session_state_ = &session_state;
+  logger_ = &logger;
+
+  auto* thread_pool = session_state.GetThreadPool();
+  max_helpers_ = thread_pool != nullptr ? static_cast<size_t>(thread_pool->NumThreads()) : 0;
+  max_helpers_ = std::min(max_helpers_, num_nodes_ > 0 ? num_nodes_ - 1 : 0);
+
+  // the calling thread is worker 0. helpers use the other slots as they are started.
+  const size_t num_workers = max_helpers_ + 1;
+  for (size_t i = 0; i < num_workers; ++i) {
+    queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+
+  for (size_t i = num_workers - 1; i > 0; --i) {
+    free_slots_.push_back(i);
+  }
+
+  num_remaining_ = num_nodes_;
+
+  // queue the root nodes on worker 0 with the most critical at the back so it is run first.
+  // helpers steal the others from the front.
+  const auto& roots = session_state.GetRootNodesByPriority();
+  for (auto node_index : roots) {
+    queues_[0]->nodes.push_front(node_index);
+    ++num_queued_;
+  }
+
+  StartHelpers();
+
+  WorkerLoop(0, session_state, logger);
+
+  // the helpers reference this executor so they must all have exited before we return
+  {
+    std::unique_lock<OrtMutex> lock(idle_mutex_);
+    while (active_helpers_ > 0) idle_cv_.wait(lock);
+  }
+
+  if (failed_) {
+    std::lock_guard<OrtMutex> lock(error_mutex_);
+    return error_status_;
+  }
+
+  VLOGS(logger, 1) << "Fetching output.";
+  ORT_RETURN_IF_ERROR(
+      FetchOutput(session_state.GetMLValueNameIdxMap(), *root_frame_, output_names, fetches, logger));
+
+  if (root_frame_->HasPlan()) {
+    std::vector<TensorShape> input_shapes;
+    bool all_tensors = true;
+    for (const auto& feed : feeds) {
+      if (!(feed.second.IsTensor())) {
+        all_tensors = false;
+        break;
+      }
+      auto& tensor = feed.second.Get<Tensor>();
+      input_shapes.push_back(tensor.Shape());
+    }
+
+    if (all_tensors) {
+      auto mem_patterns = std::make_unique<MemoryPatternGroup>();
+      ORT_RETURN_IF_ERROR(root_frame_->GeneratePatterns(mem_patterns.get()));
+      ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(input_shapes, std::move(mem_patterns)));
+    }
+  }
+
+  if (f_profiler_enabled) {
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "WorkStealingExecutor::Execute", tp);
+  }
+  return Status::OK();
+}
+
+void WorkStealingExecutor::WorkerLoop(size_t worker_id, const SessionState& session_state,
+                                      const logging::Logger& logger) {
+  NodeIndex node_index = 0;
+  bool has_node = false;
+
+  while (num_remaining_.load() > 0 && !failed_.load()) {
+    if (!has_node) {
+      has_node = PopOrSteal(worker_id, node_index);
+    }
+
+    if (!has_node) {
+      // a helper gives its pool thread back rather than waiting. see StartHelpers for the release.
+      if (worker_id != 0) {
+        return;
+      }
+
+      std::unique_lock<OrtMutex> lock(idle_mutex_);
+      while (num_queued_.load() <= 0 && num_remaining_.load() > 0 && !failed_.load()) {
+        idle_cv_.wait(lock);
+      }
+      continue;
+    }
+
+    Status status;
+    try {
+      status = RunNode(node_index, session_state, logger);
+    } catch (const std::exception& ex) {
+      status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+    } catch (...) {
+      status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, "Unknown exception running node ", node_index);
+    }
+
+    if (!status.IsOK()) {
+      SetError(status);
+      return;
+    }
+
+    // keep going with the most critical successor that became ready so we avoid a round trip through the deques
+    ReleaseSuccessors(worker_id, node_index, session_state, node_index, has_node);
+    NodeDone();
+  }
+}
+
+Status WorkStealingExecutor::RunNode(NodeIndex node_index, const SessionState& session_state,
+                                     const logging::Logger& logger) {
+  if (terminate_flag_) {
+    LOGS(logger, WARNING) << "Exiting due to terminate flag being set to true.";
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
+  }
+
+  auto p_op_kernel = session_state.GetKernel(node_index);
+
+  // nodes without a kernel (if any) have nothing to compute and only need to release their successors
+  if (p_op_kernel == nullptr) {
+    return Status::OK();
+  }
+
+  TimePoint sync_time_begin;
+  TimePoint kernel_begin_time;
+  bool f_profiler_enabled = session_state.Profiler().FEnabled();
+
+  OpKernelContextInternal op_kernel_context(*root_frame_, *p_op_kernel, logger,
+                                            p_op_kernel->Node().ImplicitInputDefs(),
+                                            terminate_flag_);
+
+  if (f_profiler_enabled) {
+    sync_time_begin = session_state.Profiler().StartTime();
+  }
+  // sync before compute
+  int queue_id = p_op_kernel->KernelDef().ExecQueueId();
+
+  for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.InputFence(input_index);
+    if (fence) {
+      auto execution_provider_type = p_op_kernel->Node().GetExecutionProviderType();
+      if (OrtMemTypeCPUInput == p_op_kernel->KernelDef().InputMemoryType(input_index)) {
+        execution_provider_type = kCpuExecutionProvider;
+      }
+      fence->BeforeUsingAsInput(execution_provider_type, queue_id);
+    }
+  }
+
+  for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
+    if (fence) {
+      auto execution_provider_type = p_op_kernel->Node().GetExecutionProviderType();
+      if (OrtMemTypeCPUInput == p_op_kernel->KernelDef().InputMemoryType(input_index)) {
+        execution_provider_type = kCpuExecutionProvider;
+      }
+      fence->BeforeUsingAsInput(execution_provider_type, queue_id);
+    }
+  }
+
+  for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
+    Fence_t fence = op_kernel_context.OutputFence(output_index);
+    if (fence) {
+      fence->BeforeUsingAsOutput(p_op_kernel->Node().GetExecutionProviderType(), queue_id);
+    }
+  }
+
+  if (f_profiler_enabled) {
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                   p_op_kernel->Node().Name() + "_fence_before",
+                                                   sync_time_begin,
+                                                   {{"op_name", p_op_kernel->KernelDef().OpName()}});
+
+    kernel_begin_time = session_state.Profiler().StartTime();
+  }
+
+  // call compute on the kernel
+  VLOGS(logger, 1) << "Computing kernel: " << p_op_kernel->Node().Name();
+
+  auto status = p_op_kernel->Compute(&op_kernel_context);
+  if (!status.IsOK()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Compute failed for node: ", p_op_kernel->Node().Name(),
+                           ". ", status.ErrorMessage());
+  }
+
+  if (f_profiler_enabled) {
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                   p_op_kernel->Node().Name() + "_kernel_time",
+                                                   kernel_begin_time,
+                                                   {{"op_name", p_op_kernel->KernelDef().OpName()}});
+
+    sync_time_begin = session_state.Profiler().StartTime();
+  }
+
+  // sync after compute for outputs
+  for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.InputFence(input_index);
+    if (fence) {
+      fence->AfterUsedAsInput(queue_id);
+    }
+  }
+
+  for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
+    if (fence) {
+      fence->AfterUsedAsInput(queue_id);
+    }
+  }
+
+  for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
+    Fence_t fence = op_kernel_context.OutputFence(output_index);
+    if (fence) {
+      fence->AfterUsedAsOutput(queue_id);
+    }
+  }
+
+  if (f_profiler_enabled) {
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                   p_op_kernel->Node().Name() + "_fence_after",
+                                                   sync_time_begin,
+                                                   {{"op_name", p_op_kernel->KernelDef().OpName()}});
+  }
+
+  return Status::OK();
+}
+
+void WorkStealingExecutor::ReleaseSuccessors(size_t worker_id, NodeIndex node_index,
+                                             const SessionState& session_state,
+                                             NodeIndex& next_node, bool& has_next) {
+  has_next = false;
+
+  const auto* node = session_state.GetGraphViewer()->GetNode(node_index);
+  for (auto it = node->OutputEdgesBegin(); it != node->OutputEdgesEnd(); ++it) {
+    auto idx = it->GetNode().Index();
+    if (node_refs_[idx].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      continue;
+    }
+
+    if (!has_next) {
+      next_node = idx;
+      has_next = true;
+    } else if ((*priorities_)[idx] > (*priorities_)[next_node]) {
+      Push(worker_id, next_node);
+      next_node = idx;
+    } else {
+      Push(worker_id, idx);
+    }
+  }
+}
+
+void WorkStealingExecutor::StartHelpers() {
+  std::vector<size_t> slots;
+  {
+    // taking the idle lock also ensures worker 0 can't miss the notification for a node that was just queued
+    std::lock_guard<OrtMutex> lock(idle_mutex_);
+    while (active_helpers_ < max_helpers_ && static_cast<int>(active_helpers_) < num_queued_.load()) {
+      slots.push_back(free_slots_.back());
+      free_slots_.pop_back();
+      ++active_helpers_;
+    }
+  }
+
+  idle_cv_.notify_one();
+
+  auto* thread_pool = session_state_->GetThreadPool();
+  for (auto slot : slots) {
+    auto helper = [this, slot]() {
+      std::unique_lock<OrtMutex> lock(idle_mutex_, std::defer_lock);
+      for (;;) {
+        WorkerLoop(slot, *session_state_, *logger_);
+
+        // re-check under the lock in case a node was queued after WorkerLoop found nothing to steal,
+        // while StartHelpers still counted this helper as active
+        lock.lock();
+        if (num_queued_.load() <= 0 || num_remaining_.load() == 0 || failed_.load()) {
+          break;
+        }
+        lock.unlock();
+      }
+
+      free_slots_.push_back(slot);
+      --active_helpers_;
+      idle_cv_.notify_all();
+    };
+
+#ifdef USE_EIGEN_THREADPOOL
+    thread_pool->Schedule(helper);
+#else
+    std::packaged_task<void()> task{helper};
+    thread_pool->RunTask(std::move(task));
+#endif
+  }
+}
+
+void WorkStealingExecutor::Push(size_t worker_id, NodeIndex node_index) {
+  {
+    auto& queue = *queues_[worker_id];
+    std::lock_guard<OrtMutex> lock(queue.mutex);
+
+    // keep the deque ordered so the owner takes the most critical node and thieves take the least critical one
+    auto pos = std::upper_bound(queue.nodes.begin(), queue.nodes.end(), node_index,
+                                [this](NodeIndex a, NodeIndex b) { return (*priorities_)[a] < (*priorities_)[b]; });
+    queue.nodes.insert(pos, node_index);
+
+    // count the node while holding the queue lock so a thief can't decrement first
+    ++num_queued_;
+  }
+
+  StartHelpers();
+}
+
+bool WorkStealingExecutor::PopOrSteal(size_t worker_id, NodeIndex& node_index) {
+  {
+    auto& own = *queues_[worker_id];
+    std::lock_guard<OrtMutex> lock(own.mutex);
+    if (!own.nodes.empty()) {
+      node_index = own.nodes.back();
+      own.nodes.pop_back();
+      --num_queued_;
+      return true;
+    }
+  }
+
+  const size_t num_workers = queues_.size();
+  for (size_t i = 1; i < num_workers; ++i) {
+    auto& victim = *queues_[(worker_id + i) % num_workers];
+    std::lock_guard<OrtMutex> lock(victim.mutex);
+    if (!victim.nodes.empty()) {
+      node_index = victim.nodes.front();
+      victim.nodes.pop_front();
+      --num_queued_;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void WorkStealingExecutor::NodeDone() {
+  if (num_remaining_.fetch_sub(1) == 1) {
+    std::lock_guard<OrtMutex> lock(idle_mutex_);
+    idle_cv_.notify_all();
+  }
+}
+
+void WorkStealingExecutor::SetError(const Status& status) {
+  {
+    std::lock_guard<OrtMutex> lock(error_mutex_);
+    if (error_status_.IsOK()) {
+      error_status_ = status;
+    }
+  }
+
+  {
+    std::lock_guard<OrtMutex> lock(idle_mutex_);
+    failed_ = true;
+  }
+  idle_cv_.notify_all();
+}
+
+Status WorkStealingExecutor::FetchOutput(const MLValueNameIdxMap& name_idx_map,
+                                         ExecutionFrame& frame,
+                                         const std::vector<std::string>& output_names,
+                                         std::vector<MLValue>& fetches,
+                                         const logging::Logger& logger) {
+  if (fetches.empty()) {
+    fetches.resize(output_names.size());
+  } else {
+    // this should've been checked before already
+    ORT_ENFORCE(output_names.size() == fetches.size(),
+                "output_names vector size: " + std::to_string(output_names.size()) +
+                    " does not match that of fetches vector: " + std::to_string(fetches.size()));
+  }
+
+  auto idx = 0;
+
+  for (const auto& oname : output_names) {
+    VLOGS(logger, 1) << "Attempting to fetch output with name: " << oname;
+    int mlvalue_index;
+    ORT_RETURN_IF_ERROR(name_idx_map.GetIdx(oname, mlvalue_index));
+    const MLValue& output_mlvalue = frame.GetMLValue(mlvalue_index);
+    VLOGS(logger, 1) << "Copying fetched MLValue to output vector";
+    fetches[idx++] = output_mlvalue;
+  }
+
+  VLOGS(logger, 1) << "Done with execution.";
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/common/logging/logging.h"
+#include "core/platform/ort_mutex.h"
+#include "core/framework/iexecutor.h"
+#include "core/framework/framework_common.h"
+#include "core/framework/ml_value.h"
+#include "core/framework/session_state.h"
+#include "core/graph/graph_viewer.h"
+
+namespace onnxruntime {
+
+class ExecutionFrame;
+
+/**
+Executor that runs the nodes of a graph on a fixed set of workers, each with its own deque of ready nodes.
+
+A worker continues with the most critical ready successor of the node it just completed and pushes the rest
+to its own deque. Idle workers steal from the opposite end of the other deques. Node readiness is tracked
+with atomic dependency counters, so the only locks taken are the per-worker deque locks and the idle wait.
+Node priorities are the length of the longest path from the node to a graph output (the critical path), and
+are calculated once per SessionState.
+
+The calling thread is always a worker. Helpers are scheduled on the session thread pool when nodes are queued,
+and return their pool thread as soon as there is nothing left to steal, so concurrent Run calls and kernels
+that parallelize their own work on the same pool are not starved by idle helpers.
+*/
+class WorkStealingExecutor : public IExecutor {
+ public:
+  WorkStealingExecutor(const SessionState& session_state, const bool& terminate_flag = false);
+
+  common::Status Execute(const SessionState& session_state,
+                         const NameMLValMap& feeds,
+                         const std::vector<std::string>& output_names,
+                         std::vector<MLValue>& fetches,
+                         const std::unordered_map<size_t, CustomAllocator> fetch_allocators,
+                         const logging::Logger& logger) override;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(WorkStealingExecutor);
+
+  struct WorkerQueue {
+    OrtMutex mutex;
+    std::deque<NodeIndex> nodes;  // sorted by ascending priority. owner pops from the back, thieves from the front
+  };
+
+  // runs nodes until the graph completes or fails. the calling thread (worker 0) waits for more work when
+  // there is nothing to steal, a helper returns instead.
+  void WorkerLoop(size_t worker_id, const SessionState& session_state, const logging::Logger& logger);
+
+  // schedule helpers on the thread pool for queued nodes that no worker is available for
+  void StartHelpers();
+
+  Status RunNode(NodeIndex node_index, const SessionState& session_state, const logging::Logger& logger);
+
+  // decrements the dependency counters of the successors of node_index and queues the ones that become ready.
+  // the most critical ready successor is returned in next_node (if any) so the caller can run it without queuing.
+  void ReleaseSuccessors(size_t worker_id, NodeIndex node_index, const SessionState& session_state,
+                         NodeIndex& next_node, bool& has_next);
+
+  void Push(size_t worker_id, NodeIndex node_index);
+  bool PopOrSteal(size_t worker_id, NodeIndex& node_index);
+
+  void NodeDone();
+  void SetError(const Status& status);
+
+  Status FetchOutput(const MLValueNameIdxMap& name_idx_map,
+                     ExecutionFrame& frame,
+                     const std::vector<std::string>& output_names,
+                     std::vector<MLValue>& fetches,
+                     const logging::Logger& logger);
+
+  std::unique_ptr<ExecutionFrame> root_frame_;
+
+  // per node priority (longest path to a sink) and number of inputs still outstanding. indexed by NodeIndex.
+  const std::vector<size_t>* priorities_ = nullptr;
+  std::unique_ptr<std::atomic<int>[]> node_refs_;
+  size_t num_nodes_ = 0;
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+
+  std::atomic<size_t> num_remaining_{0};  // nodes that have not completed yet
+  std::atomic<int> num_queued_{0};        // nodes sitting in any of the deques
+  std::atomic<bool> failed_{false};
+
+  // used by worker 0 to wait for new work or completion, and to wait for the helpers to exit
+  OrtMutex idle_mutex_;
+  OrtCondVar idle_cv_;
+
+  // used by StartHelpers. set for the duration of Execute
+  const SessionState* session_state_ = nullptr;
+  const logging::Logger* logger_ = nullptr;
+
+  size_t max_helpers_ = 0;
+  size_t active_helpers_ = 0;       // protected by idle_mutex_
+  std::vector<size_t> free_slots_;  // worker ids available to new helpers. protected by idle_mutex_
+
+  OrtMutex error_mutex_;
+  Status error_status_;  // first failure, protected by error_mutex_
+
+  const bool& terminate_flag_;
+};
+}  // namespace onnxruntime
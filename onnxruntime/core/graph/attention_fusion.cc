@@ -0,0 +1,303 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/graph/attention_fusion.h"
+#include "core/graph/graph_utils.h"
+#include "core/graph/initializer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+// Returns the node that produces the input of the node, or nullptr if the
+// input is not produced by a node.
+const Node* GetInputNode(const Node& node, int input_index) {
+  for (auto it = node.InputEdgesBegin(); it != node.InputEdgesEnd(); ++it) {
+    if (it->GetDstArgIndex() == input_index) {
+      return &it->GetNode();
+    }
+  }
+  return nullptr;
+}
+
+// Returns the producer of the input of the node if the node is the only
+// consumer of the producer.
+const Node* GetOnlyProducer(const Graph& graph, const Node& node, int input_index) {
+  const Node* producer = GetInputNode(node, input_index);
+  if (producer == nullptr || utils::GetOnlyConsumer(graph, *producer) != &node) {
+    return nullptr;
+  }
+  return producer;
+}
+
+// The initializers read below are folded into the Attention node, so they must
+// be constants that can't be overridden by a feed.
+const TensorProto* GetFloatInitializer(const Graph& graph, const NodeArg& node_arg) {
+  const TensorProto* tensor_proto = nullptr;
+  if (!utils::IsConstantInitializer(graph, node_arg.Name()) ||
+      !graph.GetInitializedTensor(node_arg.Name(), tensor_proto) ||
+      tensor_proto->data_type() != TensorProto_DataType_FLOAT) {
+    return nullptr;
+  }
+  return tensor_proto;
+}
+
+bool GetInt64Initializer(const Graph& graph, const NodeArg& node_arg, std::vector<int64_t>& values) {
+  const TensorProto* tensor_proto = nullptr;
+  if (!utils::IsConstantInitializer(graph, node_arg.Name()) ||
+      !graph.GetInitializedTensor(node_arg.Name(), tensor_proto) ||
+      tensor_proto->data_type() != TensorProto_DataType_INT64) {
+    return false;
+  }
+  if (tensor_proto->has_raw_data()) {
+    const std::string& raw_data = tensor_proto->raw_data();
+    values.resize(raw_data.size() / sizeof(int64_t));
+    std::memcpy(values.data(), raw_data.data(), values.size() * sizeof(int64_t));
+  } else {
+    values.assign(tensor_proto->int64_data().begin(), tensor_proto->int64_data().end());
+  }
+  return true;
+}
+
+bool IsTransposeWithPerm(const Node& node, const std::vector<int64_t>& expected_perm) {
+  std::vector<int64_t> perm;
+  return utils::IsSupportedOptypeVersionAndDomain(node, "Transpose", 1) &&
+         utils::GetRepeatedNodeAttributeValues(node, "perm", perm) &&
+         perm == expected_perm;
+}
+
+bool IsMatMul(const Node& node) {
+  return utils::IsSupportedOptypeVersionAndDomain(node, "MatMul", 1) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "MatMul", 9);
+}
+
+// The nodes of the query, key or value branch:
+//   Transpose(Reshape(Add(MatMul(X, W), b), [0, 0, num_heads, head_size]))
+struct ProjectionBranch {
+  const Node* matmul;
+  const Node* add;
+  const Node* reshape;
+  const Node* transpose;
+  const NodeArg* input;
+  const TensorProto* weight;
+  const TensorProto* bias;
+  int64_t num_heads;
+  int64_t head_size;
+};
+
+bool MatchProjectionBranch(const Graph& graph, const Node* transpose, const std::vector<int64_t>& perm,
+                           ProjectionBranch& branch) {
+  if (transpose == nullptr || !IsTransposeWithPerm(*transpose, perm)) {
+    return false;
+  }
+
+  const Node* reshape = GetOnlyProducer(graph, *transpose, 0);
+  std::vector<int64_t> shape;
+  if (reshape == nullptr ||
+      !utils::IsSupportedOptypeVersionAndDomain(*reshape, "Reshape", 5) ||
+      !GetInt64Initializer(graph, *reshape->InputDefs()[1], shape) ||
+      shape.size() != 4 || shape[0] != 0 || shape[1] != 0 || shape[2] <= 0 || shape[3] <= 0) {
+    return false;
+  }
+
+  const Node* add = GetOnlyProducer(graph, *reshape, 0);
+  if (add == nullptr || !utils::IsSupportedOptypeVersionAndDomain(*add, "Add", 7)) {
+    return false;
+  }
+
+  // The bias may be either input of the Add node.
+  int matmul_index = 0;
+  const TensorProto* bias = GetFloatInitializer(graph, *add->InputDefs()[1]);
+  if (bias == nullptr) {
+    matmul_index = 1;
+    bias = GetFloatInitializer(graph, *add->InputDefs()[0]);
+  }
+  const Node* matmul = GetOnlyProducer(graph, *add, matmul_index);
+  if (bias == nullptr || matmul == nullptr || !IsMatMul(*matmul)) {
+    return false;
+  }
+
+  const TensorProto* weight = GetFloatInitializer(graph, *matmul->InputDefs()[1]);
+  const int64_t hidden_size = shape[2] * shape[3];
+  if (weight == nullptr ||
+      weight->dims_size() != 2 || weight->dims(0) != hidden_size || weight->dims(1) != hidden_size ||
+      bias->dims_size() != 1 || bias->dims(0) != hidden_size) {
+    return false;
+  }
+
+  branch.matmul = matmul;
+  branch.add = add;
+  branch.reshape = reshape;
+  branch.transpose = transpose;
+  branch.input = matmul->InputDefs()[0];
+  branch.weight = weight;
+  branch.bias = bias;
+  branch.num_heads = shape[2];
+  branch.head_size = shape[3];
+  return true;
+}
+
+// Adds a float initializer and returns the node argument that refers to it.
+NodeArg& AddFloatInitializer(Graph& graph, Initializer& initializer) {
+  TensorProto tensor_proto;
+  initializer.ToProto(&tensor_proto);
+  graph.AddInitializedTensor(tensor_proto);
+
+  TypeProto type_proto;
+  type_proto.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  for (auto dim : initializer.dims()) {
+    type_proto.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+  return graph.GetOrCreateNodeArg(tensor_proto.name(), &type_proto);
+}
+
+}  // namespace
+
+Status AttentionFusion::ApplyImpl(Graph& graph, bool& modified, int graph_level) const {
+  GraphViewer graph_viewer(graph);
+  const auto& order = graph_viewer.GetNodesInTopologicalOrder();
+
+  const std::vector<int64_t> heads_first_perm{0, 2, 1, 3};
+  const std::vector<int64_t> key_transposed_perm{0, 2, 3, 1};
+
+  for (auto index : order) {
+    Node* node = graph.GetNode(index);
+    if (node == nullptr) {
+      // The node was removed by an earlier fusion.
+      continue;
+    }
+
+    ORT_RETURN_IF_ERROR(Recurse(*node, modified, graph_level));
+
+    if (!utils::IsSupportedOptypeVersionAndDomain(*node, "Softmax", 1) ||
+        (node->GetExecutionProviderType() != kCpuExecutionProvider && !node->GetExecutionProviderType().empty())) {
+      continue;
+    }
+
+    // The softmax must be over the keys of the [batch, heads, sequence, sequence] scores.
+    const Node& softmax = *node;
+    const auto* axis_attr = utils::GetNodeAttribute(softmax, "axis");
+    if (axis_attr == nullptr || (axis_attr->i() != 3 && axis_attr->i() != -1)) {
+      continue;
+    }
+
+    // Div(MatMul(Q, K), sqrt(head_size)) or Mul(MatMul(Q, K), 1 / sqrt(head_size))
+    const Node* scale = GetOnlyProducer(graph, softmax, 0);
+    float scale_value;
+    if (scale == nullptr ||
+        !(utils::IsSupportedOptypeVersionAndDomain(*scale, "Div", 7) ||
+          utils::IsSupportedOptypeVersionAndDomain(*scale, "Mul", 7)) ||
+        !utils::GetScalarConstant(graph, *scale->InputDefs()[1], scale_value)) {
+      continue;
+    }
+    if (scale->OpType() == "Div") {
+      scale_value = 1.0f / scale_value;
+    }
+
+    const Node* qk = GetOnlyProducer(graph, *scale, 0);
+    if (qk == nullptr || !IsMatMul(*qk)) {
+      continue;
+    }
+
+    // MatMul(Softmax(...), V)
+    const Node* qkv = utils::GetOnlyConsumer(graph, softmax);
+    if (qkv == nullptr || !IsMatMul(*qkv) || qkv->InputDefs()[0] != softmax.OutputDefs()[0]) {
+      continue;
+    }
+
+    ProjectionBranch q;
+    ProjectionBranch k;
+    ProjectionBranch v;
+    if (!MatchProjectionBranch(graph, GetOnlyProducer(graph, *qk, 0), heads_first_perm, q) ||
+        !MatchProjectionBranch(graph, GetOnlyProducer(graph, *qk, 1), key_transposed_perm, k) ||
+        !MatchProjectionBranch(graph, GetOnlyProducer(graph, *qkv, 1), heads_first_perm, v)) {
+      continue;
+    }
+
+    const int64_t num_heads = q.num_heads;
+    const int64_t head_size = q.head_size;
+    const int64_t hidden_size = num_heads * head_size;
+    if (k.input != q.input || v.input != q.input ||
+        k.num_heads != num_heads || v.num_heads != num_heads ||
+        k.head_size != head_size || v.head_size != head_size ||
+        std::fabs(scale_value * std::sqrt(static_cast<float>(head_size)) - 1.0f) > 1e-5f) {
+      continue;
+    }
+
+    const auto* input_type = q.input->TypeAsProto();
+    if (input_type == nullptr || input_type->tensor_type().elem_type() != TensorProto_DataType_FLOAT) {
+      continue;
+    }
+
+    // Reshape(Transpose(...), [0, 0, hidden_size]) merges the heads.
+    const Node* output_transpose = utils::GetOnlyConsumer(graph, *qkv);
+    if (output_transpose == nullptr || !IsTransposeWithPerm(*output_transpose, heads_first_perm)) {
+      continue;
+    }
+    const Node* output_reshape = utils::GetOnlyConsumer(graph, *output_transpose);
+    std::vector<int64_t> output_shape;
+    if (output_reshape == nullptr ||
+        !utils::IsSupportedOptypeVersionAndDomain(*output_reshape, "Reshape", 5) ||
+        !GetInt64Initializer(graph, *output_reshape->InputDefs()[1], output_shape) ||
+        output_shape.size() != 3 || output_shape[0] != 0 || output_shape[1] != 0 ||
+        (output_shape[2] != hidden_size && output_shape[2] != -1)) {
+      continue;
+    }
+
+    // Pack the weights into [hidden_size, 3 * hidden_size] and the biases into
+    // [3 * hidden_size], in the order query, key, value.
+    const ProjectionBranch* branches[] = {&q, &k, &v};
+    Initializer packed_weight(TensorProto_DataType_FLOAT,
+                              graph.GenerateNodeArgName(softmax.Name() + "_qkv_weight"),
+                              {hidden_size, 3 * hidden_size});
+    Initializer packed_bias(TensorProto_DataType_FLOAT,
+                            graph.GenerateNodeArgName(softmax.Name() + "_qkv_bias"),
+                            {3 * hidden_size});
+    float* packed_weight_data = packed_weight.data<float>();
+    float* packed_bias_data = packed_bias.data<float>();
+    for (int64_t b = 0; b < 3; b++) {
+      Initializer weight(branches[b]->weight);
+      Initializer bias(branches[b]->bias);
+      const float* weight_data = weight.data<float>();
+      for (int64_t row = 0; row < hidden_size; row++) {
+        std::copy_n(weight_data + row * hidden_size, hidden_size,
+                    packed_weight_data + row * 3 * hidden_size + b * hidden_size);
+      }
+      std::copy_n(bias.data<float>(), hidden_size, packed_bias_data + b * hidden_size);
+    }
+
+    NodeArg& weight_arg = AddFloatInitializer(graph, packed_weight);
+    NodeArg& bias_arg = AddFloatInitializer(graph, packed_bias);
+
+    Node& output = *graph.GetNode(output_reshape->Index());
+    Node& attention_node = graph.AddNode(graph.GenerateNodeName(softmax.Name() + "_Attention"),
+                                         "Attention",
+                                         "fused multi-head attention ending with " + output.Name(),
+                                         std::vector<NodeArg*>{graph.GetNode(q.matmul->Index())->MutableInputDefs()[0],
+                                                               &weight_arg, &bias_arg},
+                                         output.MutableOutputDefs(),
+                                         nullptr,
+                                         kMSDomain);
+    attention_node.AddAttribute("num_heads", num_heads);
+    attention_node.SetExecutionProviderType(softmax.GetExecutionProviderType());
+
+    // The original weights and biases are released when the graph is resolved
+    // if no other node uses them.
+    utils::RemoveNodes(graph, {q.matmul->Index(), q.add->Index(), q.reshape->Index(), q.transpose->Index(),
+                               k.matmul->Index(), k.add->Index(), k.reshape->Index(), k.transpose->Index(),
+                               v.matmul->Index(), v.add->Index(), v.reshape->Index(), v.transpose->Index(),
+                               qk->Index(), scale->Index(), softmax.Index(), qkv->Index(),
+                               output_transpose->Index(), output_reshape->Index()});
+
+    modified = true;
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
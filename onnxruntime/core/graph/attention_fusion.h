@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/graph/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@class AttentionFusion
+
+Fuses the multi-head self attention subgraph that frameworks export into a
+single Attention node. Each of the query, key and value branches is
+
+  Transpose(Reshape(Add(MatMul(X, W), b), [0, 0, num_heads, head_size]))
+
+and the branches are combined as
+
+  Reshape(Transpose(MatMul(Softmax(Div(MatMul(Q, K), sqrt(head_size))), V)), [0, 0, hidden_size])
+
+The weights and biases of the three branches are packed into new initializers
+so that the Attention kernel computes the projections with a single GEMM. The
+weights, biases, shapes and scale must be constant initializers that are not
+graph inputs. No intermediate value may be a graph output or have other consumers.
+*/
+class AttentionFusion : public onnxruntime::GraphTransformer {
+ public:
+  AttentionFusion() noexcept : onnxruntime::GraphTransformer("AttentionFusion", "Fusing multi-head attention subgraphs into Attention") {}
+
+ private:
+  Status ApplyImpl(onnxruntime::Graph& graph, bool& modified, int graph_level) const override;
+};
+
+}  // namespace onnxruntime
@@ -219,6 +219,24 @@ void convPoolShapeInference(
   }
 }
 
+void NchwcGlobalPoolShapeInference(ONNX_NAMESPACE::InferenceContext& ctx) {
+  ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 0);
+  if (!hasNInputShapes(ctx, 1)) {
+    return;
+  }
+
+  auto& input_shape = ctx.getInputType(0)->tensor_type().shape();
+  if (input_shape.dim_size() != 4) {
+    fail_shape_inference("Input tensor must have 4 dimensions");
+  }
+
+  auto* output_shape = ctx.getOutputType(0)->mutable_tensor_type()->mutable_shape();
+  *output_shape->add_dim() = input_shape.dim(0);
+  *output_shape->add_dim() = input_shape.dim(1);
+  output_shape->add_dim()->set_dim_value(1);
+  output_shape->add_dim()->set_dim_value(1);
+}
+
 void RegisterContribSchemas() {
   ONNX_CONTRIB_OPERATOR_SCHEMA(SampleOp)
       .SetDomain(kMSDomain)
@@ -335,6 +353,244 @@ activation.)DOC")
       .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
         ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
       });
+  ONNX_CONTRIB_OPERATOR_SCHEMA(ReorderInput)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. Reorders a 4-D tensor from the NCHW layout to the NCHWc
+layout used by the Nchwc operators. The number of channels must be a multiple of the
+platform block size, so the shape of the tensor is unchanged.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(ReorderOutput)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. Reorders a 4-D tensor from the NCHWc layout back to the
+NCHW layout.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(NchwcConv)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. The schema is the same as FusedConv except that the input,
+the output and the optional Sum tensor use the NCHWc layout and the filter has been reordered
+for the NCHWc kernels. The Sum tensor is added to the convolution result before the activation
+is applied.)DOC")
+      .Attr(
+          "auto_pad",
+          "",
+          AttributeProto::STRING,
+          std::string("NOTSET"))
+      .Attr(
+          "kernel_shape",
+          "",
+          AttributeProto::INTS,
+          OPTIONAL)
+      .Attr(
+          "dilations",
+          "",
+          AttributeProto::INTS,
+          OPTIONAL)
+      .Attr(
+          "strides", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("pads",
+            "",
+            AttributeProto::INTS, OPTIONAL)
+      .Attr(
+          "group",
+          "",
+          AttributeProto::INT,
+          static_cast<int64_t>(1))
+      .Attr(
+          "activation",
+          "",
+          AttributeProto::STRING,
+          OPTIONAL)
+      .Attr(
+          "alpha",
+          "",
+          AttributeProto::FLOAT,
+          OPTIONAL)
+      .Input(0, "X", "", "T")
+      .Input(1, "W", "", "T")
+      .Input(2, "B", "", "T", OpSchema::Optional)
+      .Input(3, "Sum", "", "T", OpSchema::Optional)
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, true, false);
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(NchwcMaxPool)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. MaxPool over a tensor using the NCHWc layout.)DOC")
+      .Attr(
+          "auto_pad",
+          "",
+          AttributeProto::STRING,
+          std::string("NOTSET"))
+      .Attr(
+          "kernel_shape",
+          "",
+          AttributeProto::INTS)
+      .Attr("pads",
+            "",
+            AttributeProto::INTS, OPTIONAL)
+      .Attr(
+          "strides", "", AttributeProto::INTS, OPTIONAL)
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(NchwcAveragePool)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. AveragePool over a tensor using the NCHWc layout.)DOC")
+      .Attr(
+          "auto_pad",
+          "",
+          AttributeProto::STRING,
+          std::string("NOTSET"))
+      .Attr(
+          "kernel_shape",
+          "",
+          AttributeProto::INTS)
+      .Attr("pads",
+            "",
+            AttributeProto::INTS, OPTIONAL)
+      .Attr(
+          "strides", "", AttributeProto::INTS, OPTIONAL)
+      .Attr(
+          "count_include_pad",
+          "",
+          AttributeProto::INT,
+          static_cast<int64_t>(0))
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(NchwcGlobalMaxPool)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. GlobalMaxPool over a tensor using the NCHWc layout. The
+output has a single spatial position, so it is identical in the NCHW and NCHWc layouts.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(NchwcGlobalPoolShapeInference);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(NchwcGlobalAveragePool)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. GlobalAveragePool over a tensor using the NCHWc layout. The
+output has a single spatial position, so it is identical in the NCHW and NCHWc layouts.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(NchwcGlobalPoolShapeInference);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(FusedElementwise)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. Evaluates a chain of element-wise operators as a single
+operator. Each operator in 'ops' reads the values selected by two entries of 'operands': values
+are numbered with the inputs first, followed by the result of each operator in order. The second
+operand of a unary operator is -1. The result of the last operator is the output, which has the
+multidirectional broadcast shape of the inputs.)DOC")
+      .Input(0, "inputs", "", "T", OpSchema::Variadic)
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .Attr(
+          "ops",
+          "",
+          AttributeProto::STRINGS)
+      .Attr(
+          "operands",
+          "",
+          AttributeProto::INTS)
+      .Attr(
+          "alphas",
+          "",
+          AttributeProto::FLOATS,
+          OPTIONAL)
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        propagateElemTypeFromInputToOutput(ctx, 0, 0);
+        const size_t input_count = ctx.getNumInputs();
+        if (!hasNInputShapes(ctx, static_cast<int>(input_count))) {
+          return;
+        }
+        ONNX_NAMESPACE::TensorShapeProto resultShape = ctx.getInputType(0)->tensor_type().shape();
+        for (size_t i = 1; i < input_count; i++) {
+          ONNX_NAMESPACE::TensorShapeProto previousShape = resultShape;
+          resultShape.clear_dim();
+          bidirectionalBroadcastShapeInference(
+              previousShape, ctx.getInputType(i)->tensor_type().shape(), resultShape);
+        }
+        *ctx.getOutputType(0)->mutable_tensor_type()->mutable_shape() = resultShape;
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(LayerNormalization)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(Layer normalization. Each slice of the input that starts at 'axis' is normalized
+to zero mean and unit variance, then scaled by 'scale' and shifted by 'B'.
+Y = (X - mean) / sqrt(variance + epsilon) * scale + B)DOC")
+      .Attr(
+          "axis",
+          "The first normalization dimension. Negative values count from the back.",
+          AttributeProto::INT,
+          static_cast<int64_t>(-1))
+      .Attr(
+          "epsilon",
+          "The epsilon value to use to avoid division by zero.",
+          AttributeProto::FLOAT,
+          1e-5f)
+      .Input(0, "X", "Input data tensor.", "T")
+      .Input(1, "scale", "Scale tensor with the shape of the normalized dimensions.", "T")
+      .Input(2, "B", "Bias tensor with the shape of the normalized dimensions.", "T")
+      .Output(0, "Y", "Output data tensor.", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(Gelu)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(Gaussian Error Linear Unit.
+Y = 0.5 * X * (1 + erf(X / sqrt(2))))DOC")
+      .Input(0, "X", "Input data tensor.", "T")
+      .Output(0, "Y", "Output data tensor.", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(Attention)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(Multi-head self attention. The query, key and value projections of the input
+are computed with the packed weights [Wq Wk Wv] and bias [bq bk bv]. Each head then
+computes softmax(Q K^T / sqrt(head_size)) V and the heads are concatenated.
+The optional mask index holds the number of valid tokens of each batch, so that
+keys beyond the sequence length are not attended.)DOC")
+      .Attr("num_heads", "Number of attention heads", AttributeProto::INT)
+      .Input(0, "input", "3D input tensor with shape (batch_size, sequence_length, hidden_size)", "T")
+      .Input(1, "weight", "2D weight tensor with shape (hidden_size, 3 * hidden_size)", "T")
+      .Input(2, "bias", "1D bias tensor with shape (3 * hidden_size)", "T")
+      .Input(3, "mask_index", "Number of valid tokens of each batch with shape (batch_size)", "M", OpSchema::Optional)
+      .Output(0, "output", "3D output tensor with shape (batch_size, sequence_length, hidden_size)", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors.")
+      .TypeConstraint("M", {"tensor(int32)"}, "Constrain mask index to integer types")
+      .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput);
 
   ONNX_CONTRIB_OPERATOR_SCHEMA(FusedGemm)
       .SetDomain(kMSDomain)
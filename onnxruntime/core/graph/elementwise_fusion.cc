@@ -0,0 +1,228 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/graph/elementwise_fusion.h"
+#include "core/graph/graph_utils.h"
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+// The maximum number of nodes fused into one FusedElementwise node. Each node
+// uses a scratch buffer of one tile, so longer programs shrink the tile size.
+constexpr size_t kMaximumFusedNodes = 32;
+
+bool IsFusableBinary(const Node& node) {
+  return utils::IsSupportedOptypeVersionAndDomain(node, "Add", 7) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Sub", 7) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Mul", 7) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Div", 7);
+}
+
+bool IsFusableUnary(const Node& node) {
+  return utils::IsSupportedOptypeVersionAndDomain(node, "Relu", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "LeakyRelu", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Sigmoid", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Tanh", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Neg", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Abs", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Exp", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Log", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Sqrt", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Reciprocal", 6);
+}
+
+bool IsFusableNode(const Node& node) {
+  if (node.GetExecutionProviderType() != kCpuExecutionProvider && !node.GetExecutionProviderType().empty()) {
+    return false;
+  }
+
+  if (!IsFusableBinary(node) && !IsFusableUnary(node)) {
+    return false;
+  }
+
+  // The fused kernel only supports float tensors.
+  const auto* output_type = node.OutputDefs()[0]->TypeAsProto();
+  return output_type != nullptr &&
+         output_type->tensor_type().elem_type() == TensorProto_DataType_FLOAT;
+}
+
+class ElementwiseFusionImpl {
+ public:
+  explicit ElementwiseFusionImpl(Graph& graph) : graph_(graph) {}
+
+  void Fuse(Node& root, const std::unordered_map<NodeIndex, size_t>& topological_position);
+  void Finalize(bool& modified);
+
+ private:
+  // Returns true if the producer can join the group of nodes.
+  bool CanJoinGroup(const Node& producer, const std::unordered_set<NodeIndex>& group) const;
+
+  void RemoveNode(Node& node);
+
+  Graph& graph_;
+
+  // Nodes that have been fused into a FusedElementwise node.
+  std::unordered_set<NodeIndex> fused_nodes_;
+
+  std::deque<NodeIndex> removed_nodes_;
+};
+
+bool ElementwiseFusionImpl::CanJoinGroup(const Node& producer, const std::unordered_set<NodeIndex>& group) const {
+  if (group.count(producer.Index()) != 0 ||
+      fused_nodes_.count(producer.Index()) != 0 ||
+      !IsFusableNode(producer) ||
+      graph_.IsNodeOutputsInGraphOutputs(producer)) {
+    return false;
+  }
+
+  // The output of the producer is not materialized by the fused node, so all
+  // of its consumers must be part of the group.
+  for (auto it = producer.OutputEdgesBegin(); it != producer.OutputEdgesEnd(); ++it) {
+    if (group.count(it->GetNode().Index()) == 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void ElementwiseFusionImpl::RemoveNode(Node& node) {
+  utils::RemoveNodeOutputEdges(graph_, node);
+  removed_nodes_.push_front(node.Index());
+}
+
+void ElementwiseFusionImpl::Fuse(Node& root, const std::unordered_map<NodeIndex, size_t>& topological_position) {
+  if (fused_nodes_.count(root.Index()) != 0 || !IsFusableNode(root)) {
+    return;
+  }
+
+  // Grow the group backwards from the root. A producer that feeds several
+  // nodes of the group can only join once all of those nodes have joined, so
+  // repeat until the group stops growing.
+  std::vector<Node*> group_nodes{&root};
+  std::unordered_set<NodeIndex> group{root.Index()};
+
+  for (bool grown = true; grown && group_nodes.size() < kMaximumFusedNodes;) {
+    grown = false;
+    for (size_t n = 0; n < group_nodes.size() && group_nodes.size() < kMaximumFusedNodes; n++) {
+      for (auto it = group_nodes[n]->InputNodesBegin(); it != group_nodes[n]->InputNodesEnd(); ++it) {
+        Node& producer = *graph_.GetNode(it->Index());
+        if (group_nodes.size() < kMaximumFusedNodes && CanJoinGroup(producer, group)) {
+          group_nodes.push_back(&producer);
+          group.insert(producer.Index());
+          grown = true;
+        }
+      }
+    }
+  }
+
+  if (group_nodes.size() < 2) {
+    return;
+  }
+
+  // Emit the program in topological order so that each instruction only
+  // reads the inputs and the results of preceding instructions.
+  std::sort(group_nodes.begin(), group_nodes.end(), [&topological_position](const Node* a, const Node* b) {
+    return topological_position.at(a->Index()) < topological_position.at(b->Index());
+  });
+
+  std::vector<NodeArg*> fused_inputs;
+  std::unordered_map<const NodeArg*, int64_t> value_indices;
+
+  // Values produced inside the group are numbered after all of the inputs, so
+  // collect the inputs first.
+  std::unordered_set<const NodeArg*> group_outputs;
+  for (const Node* node : group_nodes) {
+    group_outputs.insert(node->OutputDefs()[0]);
+  }
+  for (Node* node : group_nodes) {
+    for (NodeArg* input_def : node->MutableInputDefs()) {
+      if (group_outputs.count(input_def) == 0 && value_indices.count(input_def) == 0) {
+        value_indices[input_def] = static_cast<int64_t>(fused_inputs.size());
+        fused_inputs.push_back(input_def);
+      }
+    }
+  }
+
+  std::vector<std::string> ops;
+  std::vector<int64_t> operands;
+  std::vector<float> alphas;
+
+  for (const Node* node : group_nodes) {
+    const auto& input_defs = node->InputDefs();
+    ops.push_back(node->OpType());
+    operands.push_back(value_indices.at(input_defs[0]));
+    operands.push_back(input_defs.size() > 1 ? value_indices.at(input_defs[1]) : -1);
+
+    float alpha = 0.0f;
+    if (node->OpType() == "LeakyRelu") {
+      const auto* alpha_attr = utils::GetNodeAttribute(*node, "alpha");
+      alpha = (alpha_attr != nullptr) ? alpha_attr->f() : 0.01f;
+    }
+    alphas.push_back(alpha);
+
+    value_indices[node->OutputDefs()[0]] = static_cast<int64_t>(fused_inputs.size() + ops.size() - 1);
+  }
+
+  Node& fused_node = graph_.AddNode(graph_.GenerateNodeName(root.Name() + "_fused"),
+                                    "FusedElementwise",
+                                    "fused element-wise nodes ending with " + root.Name(),
+                                    fused_inputs,
+                                    root.MutableOutputDefs(),
+                                    nullptr,
+                                    kMSDomain);
+  fused_node.AddAttribute("ops", ops);
+  fused_node.AddAttribute("operands", operands);
+  fused_node.AddAttribute("alphas", alphas);
+  fused_node.SetExecutionProviderType(root.GetExecutionProviderType());
+
+  for (Node* node : group_nodes) {
+    fused_nodes_.insert(node->Index());
+    RemoveNode(*node);
+  }
+}
+
+void ElementwiseFusionImpl::Finalize(bool& modified) {
+  for (auto index : removed_nodes_) {
+    graph_.RemoveNode(index);
+  }
+
+  if (!removed_nodes_.empty()) {
+    modified = true;
+  }
+}
+
+}  // namespace
+
+Status ElementwiseFusion::ApplyImpl(Graph& graph, bool& modified, int graph_level) const {
+  ElementwiseFusionImpl impl(graph);
+  GraphViewer graph_viewer(graph);
+  const auto& order = graph_viewer.GetNodesInTopologicalOrder();
+
+  std::unordered_map<NodeIndex, size_t> topological_position;
+  for (size_t i = 0; i < order.size(); i++) {
+    topological_position[order[i]] = i;
+  }
+
+  for (auto index : order) {
+    ORT_RETURN_IF_ERROR(Recurse(*graph.GetNode(index), modified, graph_level));
+  }
+
+  // Visit the nodes in reverse topological order so that each group is rooted
+  // at its last node and grows towards the graph inputs.
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    impl.Fuse(*graph.GetNode(*it), topological_position);
+  }
+
+  impl.Finalize(modified);
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/graph/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@class ElementwiseFusion
+
+Fuses connected groups of float element-wise nodes (Add, Sub, Mul, Div and the
+unary activations and math functions) into a single FusedElementwise node. The
+fused node evaluates the group one cache sized tile at a time, so the
+intermediate tensors of the group are never written to memory. A node joins a
+group only if all of its consumers are in the same group and its output is not
+a graph output.
+*/
+class ElementwiseFusion : public onnxruntime::GraphTransformer {
+ public:
+  ElementwiseFusion() noexcept : onnxruntime::GraphTransformer("ElementwiseFusion", "Fusing element-wise nodes into FusedElementwise") {}
+
+ private:
+  Status ApplyImpl(onnxruntime::Graph& graph, bool& modified, int graph_level) const override;
+};
+
+}  // namespace onnxruntime
@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/graph/gelu_fusion.h"
+#include "core/graph/graph_utils.h"
+#include <cmath>
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+// Returns true if the node argument is a scalar float initializer that is
+// equal to the expected value. Exported models round the constants of the
+// pattern differently, so the comparison uses a relative tolerance. The value
+// must be a constant that can't be overridden by a feed.
+bool IsScalarConstant(const Graph& graph, const NodeArg& node_arg, float expected_value) {
+  float value;
+  if (!utils::GetScalarConstant(graph, node_arg, value)) {
+    return false;
+  }
+  return std::fabs(value - expected_value) <= 1e-5f * std::fabs(expected_value);
+}
+
+// Returns true if the node is the binary operator op_type applied to X and a
+// scalar constant equal to the expected value. Commutative operators accept
+// the operands in either order.
+bool IsBinaryWithConstant(const Graph& graph, const Node& node, const std::string& op_type,
+                          const NodeArg* X, float expected_value) {
+  if (!utils::IsSupportedOptypeVersionAndDomain(node, op_type, 7)) {
+    return false;
+  }
+  const auto& input_defs = node.InputDefs();
+  if (input_defs[0] == X) {
+    return IsScalarConstant(graph, *input_defs[1], expected_value);
+  }
+  return op_type != "Div" && input_defs[1] == X && IsScalarConstant(graph, *input_defs[0], expected_value);
+}
+
+// Returns true if the node multiplies the two node arguments.
+bool IsMulOf(const Node& node, const NodeArg* a, const NodeArg* b) {
+  if (!utils::IsSupportedOptypeVersionAndDomain(node, "Mul", 7)) {
+    return false;
+  }
+  const auto& input_defs = node.InputDefs();
+  return (input_defs[0] == a && input_defs[1] == b) || (input_defs[0] == b && input_defs[1] == a);
+}
+
+}  // namespace
+
+Status GeluFusion::ApplyImpl(Graph& graph, bool& modified, int graph_level) const {
+  GraphViewer graph_viewer(graph);
+  const auto& order = graph_viewer.GetNodesInTopologicalOrder();
+
+  for (auto index : order) {
+    Node* node = graph.GetNode(index);
+    if (node == nullptr) {
+      // The node was removed by an earlier fusion.
+      continue;
+    }
+
+    ORT_RETURN_IF_ERROR(Recurse(*node, modified, graph_level));
+
+    if (!utils::IsSupportedOptypeVersionAndDomain(*node, "Erf", 9) ||
+        (node->GetExecutionProviderType() != kCpuExecutionProvider && !node->GetExecutionProviderType().empty()) ||
+        node->GetInputEdgesCount() != 1) {
+      continue;
+    }
+
+    // Erf(Div(X, sqrt(2))) or Erf(Mul(X, 1/sqrt(2)))
+    const Node& erf_node = *node;
+    const Node& scale_node = *erf_node.InputNodesBegin();
+    if (utils::GetOnlyConsumer(graph, scale_node) != &erf_node) {
+      continue;
+    }
+    NodeArg* X = graph.GetNode(scale_node.Index())->MutableInputDefs()[0];
+    if (!IsBinaryWithConstant(graph, scale_node, "Div", X, 1.41421356237309504880f) &&
+        !IsBinaryWithConstant(graph, scale_node, "Mul", X, 0.70710678118654752440f)) {
+      X = graph.GetNode(scale_node.Index())->MutableInputDefs()[1];
+      if (!IsBinaryWithConstant(graph, scale_node, "Mul", X, 0.70710678118654752440f)) {
+        continue;
+      }
+    }
+
+    const auto* x_type = X->TypeAsProto();
+    if (x_type == nullptr || x_type->tensor_type().elem_type() != TensorProto_DataType_FLOAT) {
+      continue;
+    }
+
+    // Add(Erf(...), 1)
+    const Node* add_node = utils::GetOnlyConsumer(graph, erf_node);
+    if (add_node == nullptr || !IsBinaryWithConstant(graph, *add_node, "Add", erf_node.OutputDefs()[0], 1.0f)) {
+      continue;
+    }
+
+    const Node* mul_node = utils::GetOnlyConsumer(graph, *add_node);
+    if (mul_node == nullptr) {
+      continue;
+    }
+
+    std::vector<NodeIndex> nodes_to_remove{scale_node.Index(), erf_node.Index(), add_node->Index(), mul_node->Index()};
+    const Node* output_node = nullptr;
+
+    if (IsMulOf(*mul_node, X, add_node->OutputDefs()[0])) {
+      // Mul(Mul(X, Add(...)), 0.5)
+      const Node* half_node = utils::GetOnlyConsumer(graph, *mul_node);
+      if (half_node == nullptr || !IsBinaryWithConstant(graph, *half_node, "Mul", mul_node->OutputDefs()[0], 0.5f)) {
+        continue;
+      }
+      nodes_to_remove.push_back(half_node->Index());
+      output_node = half_node;
+    } else {
+      // Mul(Mul(X, 0.5), Add(...))
+      const Node* half_node = nullptr;
+      for (auto it = mul_node->InputNodesBegin(); it != mul_node->InputNodesEnd(); ++it) {
+        if (&*it != add_node) {
+          half_node = &*it;
+        }
+      }
+      if (half_node == nullptr ||
+          utils::GetOnlyConsumer(graph, *half_node) != mul_node ||
+          !IsBinaryWithConstant(graph, *half_node, "Mul", X, 0.5f) ||
+          !IsMulOf(*mul_node, half_node->OutputDefs()[0], add_node->OutputDefs()[0])) {
+        continue;
+      }
+      nodes_to_remove.push_back(half_node->Index());
+      output_node = mul_node;
+    }
+
+    Node& output = *graph.GetNode(output_node->Index());
+    Node& gelu_node = graph.AddNode(graph.GenerateNodeName(output.Name() + "_Gelu"),
+                                    "Gelu",
+                                    "fused Gelu ending with " + output.Name(),
+                                    std::vector<NodeArg*>{X},
+                                    output.MutableOutputDefs(),
+                                    nullptr,
+                                    kMSDomain);
+    gelu_node.SetExecutionProviderType(erf_node.GetExecutionProviderType());
+
+    utils::RemoveNodes(graph, nodes_to_remove);
+
+    modified = true;
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
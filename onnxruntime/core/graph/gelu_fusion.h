@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/graph/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@class GeluFusion
+
+Fuses the subgraph that frameworks export for the Gaussian error linear unit
+into a single Gelu node:
+
+  Y = Mul(Mul(X, Add(Erf(Div(X, sqrt(2))), 1)), 0.5)
+
+The division may also be written as a multiplication by 1/sqrt(2), and the
+multiplication by 0.5 may be applied to X before the multiplication by the Erf
+term. No intermediate value may be a graph output or have other consumers.
+*/
+class GeluFusion : public onnxruntime::GraphTransformer {
+ public:
+  GeluFusion() noexcept : onnxruntime::GraphTransformer("GeluFusion", "Fusing Gelu subgraphs into Gelu") {}
+
+ private:
+  Status ApplyImpl(onnxruntime::Graph& graph, bool& modified, int graph_level) const override;
+};
+
+}  // namespace onnxruntime
@@ -24,6 +24,15 @@ class GraphTransformerManager {
   // up to the given number of steps.
   common::Status ApplyAll(Graph& graph) const;
 
+  // Names of the registered transformers in the order they are applied.
+  std::vector<std::string> TransformerNames() const {
+    std::vector<std::string> names;
+    for (const auto& transformer : transformers_) {
+      names.push_back(transformer->Name());
+    }
+    return names;
+  }
+
  private:
   GraphTransformerManager() = default;
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(GraphTransformerManager);
@@ -1,5 +1,8 @@
 
 #include "core/graph/graph_utils.h"
+#include "core/graph/initializer.h"
+
+#include <algorithm>
 
 namespace onnxruntime {
 
@@ -80,6 +83,55 @@ const onnx::AttributeProto* GetNodeAttribute(
   return iter == attrs.end() ? nullptr : &iter->second;
 }
 
+bool IsConstantInitializer(const Graph& graph, const std::string& name) {
+  const ONNX_NAMESPACE::TensorProto* initializer = nullptr;
+  if (!graph.GetInitializedTensor(name, initializer)) {
+    return false;
+  }
+  const auto& graph_inputs = graph.GetInputsIncludingInitializers();
+  return std::none_of(graph_inputs.cbegin(), graph_inputs.cend(),
+                      [&name](const NodeArg* input) { return input->Name() == name; });
+}
+
+bool GetScalarConstant(const Graph& graph, const NodeArg& node_arg, float& value) {
+  const ONNX_NAMESPACE::TensorProto* tensor_proto = nullptr;
+  if (!IsConstantInitializer(graph, node_arg.Name()) ||
+      !graph.GetInitializedTensor(node_arg.Name(), tensor_proto) ||
+      tensor_proto->data_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT) {
+    return false;
+  }
+  Initializer initializer(tensor_proto);
+  if (initializer.size() != 1) {
+    return false;
+  }
+  value = *initializer.data<float>();
+  return true;
+}
+
+const Node* GetOnlyConsumer(const Graph& graph, const Node& node) {
+  if (node.GetOutputEdgesCount() != 1 || graph.IsNodeOutputsInGraphOutputs(node)) {
+    return nullptr;
+  }
+  return &*node.OutputNodesBegin();
+}
+
+void RemoveNodeOutputEdges(Graph& graph, Node& node) {
+  std::vector<Node::EdgeEnd> output_edges(node.OutputEdgesBegin(), node.OutputEdgesEnd());
+  for (const auto& output_edge : output_edges) {
+    graph.RemoveEdge(node.Index(), output_edge.GetNode().Index(),
+                     output_edge.GetSrcArgIndex(), output_edge.GetDstArgIndex());
+  }
+}
+
+void RemoveNodes(Graph& graph, const std::vector<NodeIndex>& node_indices) {
+  for (auto index : node_indices) {
+    RemoveNodeOutputEdges(graph, *graph.GetNode(index));
+  }
+  for (auto index : node_indices) {
+    graph.RemoveNode(index);
+  }
+}
+
 bool RemoveSingleInSingleOutNode(Graph& graph, Node& node) {
   if (!IsSingleInSingleOutNode(node)) {
     return false;
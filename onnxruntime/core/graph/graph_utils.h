@@ -37,6 +37,26 @@ bool GetRepeatedNodeAttributeValues(const Node& node,
   }
 }
 
+/** Check whether the given name is an initializer that is not also a graph input.
+    An initializer that is a graph input can be overridden by a feed at run time, so
+    transformers must not rewrite or fold its value. */
+bool IsConstantInitializer(const Graph& graph, const std::string& name);
+
+/** Retrieve the value of a scalar float initializer that is a constant as defined by IsConstantInitializer.
+    Returns false if the node argument is not such an initializer. */
+bool GetScalarConstant(const Graph& graph, const NodeArg& node_arg, float& value);
+
+/** Return the only consumer of the outputs of the node, or nullptr if an output is a graph output or
+    the outputs are consumed by more than one edge. */
+const Node* GetOnlyConsumer(const Graph& graph, const Node& node);
+
+/** Remove the output edges of the node. Graph::RemoveNode only removes the input edges of a node, so this
+    must be called before removing a node that still has consumers to avoid leaving edges to a released node. */
+void RemoveNodeOutputEdges(Graph& graph, Node& node);
+
+/** Remove the given nodes and all the edges between them and the rest of the Graph. */
+void RemoveNodes(Graph& graph, const std::vector<NodeIndex>& node_indices);
+
 /** Remove the given single-input-single-output Node from the Graph. */
 bool RemoveSingleInSingleOutNode(Graph& graph, Node& node);
 
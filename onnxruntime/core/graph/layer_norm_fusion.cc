@@ -0,0 +1,232 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/graph/layer_norm_fusion.h"
+#include "core/graph/graph_utils.h"
+#include <algorithm>
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+// Returns the index of the other input of a binary node.
+int OtherInputIndex(const Node& node, const NodeArg* input_def) {
+  return node.InputDefs()[0] == input_def ? 1 : 0;
+}
+
+// Gets the first normalized axis from the axes of a ReduceMean node. The axes
+// must be the trailing dimensions of the input and the node must keep the
+// reduced dimensions. Negative axes are returned as is when the rank of the
+// input is unknown (zero).
+bool GetNormalizedAxis(const Node& reduce_node, int64_t rank, int64_t& axis, int64_t& axis_count) {
+  const auto* keepdims_attr = utils::GetNodeAttribute(reduce_node, "keepdims");
+  if (keepdims_attr != nullptr && keepdims_attr->i() == 0) {
+    return false;
+  }
+
+  std::vector<int64_t> axes;
+  if (!utils::GetRepeatedNodeAttributeValues(reduce_node, "axes", axes) || axes.empty()) {
+    return false;
+  }
+
+  for (auto& a : axes) {
+    if (a < 0 && rank > 0) {
+      a += rank;
+    }
+  }
+  std::sort(axes.begin(), axes.end());
+
+  const int64_t last_axis = (axes.front() < 0) ? -1 : rank - 1;
+  if (axes.back() != last_axis) {
+    return false;
+  }
+  for (size_t i = 1; i < axes.size(); i++) {
+    if (axes[i] != axes[i - 1] + 1) {
+      return false;
+    }
+  }
+
+  axis = axes.front();
+  axis_count = static_cast<int64_t>(axes.size());
+  return true;
+}
+
+// Returns true if the initializer has the shape of the normalized dimensions
+// of X. Leading dimensions of size one are allowed, but the initializer must
+// not be broadcast over any of the normalized dimensions, as the kernel
+// requires one value per normalized element.
+bool IsNormalizedShapeInitializer(const Graph& graph, const NodeArg& node_arg, const NodeArg& X, int64_t axis_count) {
+  const TensorProto* tensor_proto = nullptr;
+  const auto* shape = X.Shape();
+  if (!graph.GetInitializedTensor(node_arg.Name(), tensor_proto) ||
+      tensor_proto->data_type() != TensorProto_DataType_FLOAT ||
+      shape == nullptr || shape->dim_size() < axis_count ||
+      tensor_proto->dims_size() > shape->dim_size()) {
+    return false;
+  }
+
+  int64_t norm_size = 1;
+  for (int i = shape->dim_size() - static_cast<int>(axis_count); i < shape->dim_size(); i++) {
+    if (!shape->dim(i).has_dim_value()) {
+      return false;
+    }
+    norm_size *= shape->dim(i).dim_value();
+  }
+  int64_t element_count = 1;
+  for (int i = 0; i < tensor_proto->dims_size(); i++) {
+    element_count *= tensor_proto->dims(i);
+  }
+  if (element_count != norm_size) {
+    return false;
+  }
+
+  const int offset = shape->dim_size() - tensor_proto->dims_size();
+  for (int i = 0; i < tensor_proto->dims_size(); i++) {
+    const auto& dim = shape->dim(offset + i);
+    if (offset + i < shape->dim_size() - axis_count) {
+      if (tensor_proto->dims(i) != 1) {
+        return false;
+      }
+    } else if (!dim.has_dim_value() || dim.dim_value() != tensor_proto->dims(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+Status LayerNormFusion::ApplyImpl(Graph& graph, bool& modified, int graph_level) const {
+  GraphViewer graph_viewer(graph);
+  const auto& order = graph_viewer.GetNodesInTopologicalOrder();
+
+  for (auto index : order) {
+    Node* node = graph.GetNode(index);
+    if (node == nullptr) {
+      // The node was removed by an earlier fusion.
+      continue;
+    }
+
+    ORT_RETURN_IF_ERROR(Recurse(*node, modified, graph_level));
+
+    if (!utils::IsSupportedOptypeVersionAndDomain(*node, "ReduceMean", 1) ||
+        (node->GetExecutionProviderType() != kCpuExecutionProvider && !node->GetExecutionProviderType().empty())) {
+      continue;
+    }
+
+    const Node& mean_node = *node;
+    NodeArg* X = node->MutableInputDefs()[0];
+    const auto* x_type = X->TypeAsProto();
+    if (x_type == nullptr || x_type->tensor_type().elem_type() != TensorProto_DataType_FLOAT) {
+      continue;
+    }
+
+    const auto* x_shape = X->Shape();
+    const int64_t rank = (x_shape != nullptr) ? x_shape->dim_size() : 0;
+    int64_t axis;
+    int64_t axis_count;
+    if (!GetNormalizedAxis(mean_node, rank, axis, axis_count)) {
+      continue;
+    }
+
+    // D = Sub(X, mean)
+    const Node* sub_node = utils::GetOnlyConsumer(graph, mean_node);
+    if (sub_node == nullptr ||
+        !utils::IsSupportedOptypeVersionAndDomain(*sub_node, "Sub", 7) ||
+        sub_node->InputDefs()[0] != X ||
+        sub_node->InputDefs()[1] != mean_node.OutputDefs()[0]) {
+      continue;
+    }
+
+    // D is consumed by Pow(D, 2) and by Div(D, stddev).
+    if (sub_node->GetOutputEdgesCount() != 2 || graph.IsNodeOutputsInGraphOutputs(*sub_node)) {
+      continue;
+    }
+    const Node* pow_node = nullptr;
+    const Node* div_node = nullptr;
+    for (auto it = sub_node->OutputNodesBegin(); it != sub_node->OutputNodesEnd(); ++it) {
+      if (utils::IsSupportedOptypeVersionAndDomain(*it, "Pow", 7)) {
+        pow_node = &*it;
+      } else if (utils::IsSupportedOptypeVersionAndDomain(*it, "Div", 7)) {
+        div_node = &*it;
+      }
+    }
+    float exponent;
+    if (pow_node == nullptr || div_node == nullptr ||
+        pow_node->InputDefs()[0] != sub_node->OutputDefs()[0] ||
+        !utils::GetScalarConstant(graph, *pow_node->InputDefs()[1], exponent) || exponent != 2.0f ||
+        div_node->InputDefs()[0] != sub_node->OutputDefs()[0]) {
+      continue;
+    }
+
+    // V = ReduceMean(Pow(D, 2)) over the same axes.
+    const Node* variance_node = utils::GetOnlyConsumer(graph, *pow_node);
+    int64_t variance_axis;
+    int64_t variance_axis_count;
+    if (variance_node == nullptr ||
+        !utils::IsSupportedOptypeVersionAndDomain(*variance_node, "ReduceMean", 1) ||
+        !GetNormalizedAxis(*variance_node, rank, variance_axis, variance_axis_count) ||
+        variance_axis != axis || variance_axis_count != axis_count) {
+      continue;
+    }
+
+    // stddev = Sqrt(Add(V, epsilon))
+    const Node* add_epsilon_node = utils::GetOnlyConsumer(graph, *variance_node);
+    float epsilon;
+    if (add_epsilon_node == nullptr ||
+        !utils::IsSupportedOptypeVersionAndDomain(*add_epsilon_node, "Add", 7) ||
+        !utils::GetScalarConstant(graph,
+                                  *add_epsilon_node->InputDefs()[OtherInputIndex(*add_epsilon_node, variance_node->OutputDefs()[0])],
+                                  epsilon)) {
+      continue;
+    }
+    const Node* sqrt_node = utils::GetOnlyConsumer(graph, *add_epsilon_node);
+    if (sqrt_node == nullptr ||
+        !utils::IsSupportedOptypeVersionAndDomain(*sqrt_node, "Sqrt", 6) ||
+        utils::GetOnlyConsumer(graph, *sqrt_node) != div_node ||
+        div_node->InputDefs()[1] != sqrt_node->OutputDefs()[0]) {
+      continue;
+    }
+
+    // Y = Add(Mul(Div(D, stddev), scale), B)
+    const Node* mul_node = utils::GetOnlyConsumer(graph, *div_node);
+    if (mul_node == nullptr || !utils::IsSupportedOptypeVersionAndDomain(*mul_node, "Mul", 7)) {
+      continue;
+    }
+    NodeArg* scale = graph.GetNode(mul_node->Index())->MutableInputDefs()[OtherInputIndex(*mul_node, div_node->OutputDefs()[0])];
+    const Node* add_bias_node = utils::GetOnlyConsumer(graph, *mul_node);
+    if (add_bias_node == nullptr || !utils::IsSupportedOptypeVersionAndDomain(*add_bias_node, "Add", 7)) {
+      continue;
+    }
+    NodeArg* bias = graph.GetNode(add_bias_node->Index())->MutableInputDefs()[OtherInputIndex(*add_bias_node, mul_node->OutputDefs()[0])];
+
+    if (!IsNormalizedShapeInitializer(graph, *scale, *X, axis_count) ||
+        !IsNormalizedShapeInitializer(graph, *bias, *X, axis_count)) {
+      continue;
+    }
+
+    Node& add_bias = *graph.GetNode(add_bias_node->Index());
+    Node& layer_norm_node = graph.AddNode(graph.GenerateNodeName(add_bias.Name() + "_LayerNormalization"),
+                                          "LayerNormalization",
+                                          "fused layer normalization ending with " + add_bias.Name(),
+                                          std::vector<NodeArg*>{X, scale, bias},
+                                          add_bias.MutableOutputDefs(),
+                                          nullptr,
+                                          kMSDomain);
+    layer_norm_node.AddAttribute("axis", axis);
+    layer_norm_node.AddAttribute("epsilon", epsilon);
+    layer_norm_node.SetExecutionProviderType(mean_node.GetExecutionProviderType());
+
+    utils::RemoveNodes(graph, {mean_node.Index(), sub_node->Index(), pow_node->Index(), variance_node->Index(),
+                               add_epsilon_node->Index(), sqrt_node->Index(), div_node->Index(), mul_node->Index(),
+                               add_bias_node->Index()});
+
+    modified = true;
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/graph/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@class LayerNormFusion
+
+Fuses the subgraph that frameworks export for layer normalization into a single
+LayerNormalization node:
+
+  mean = ReduceMean(X), D = Sub(X, mean), V = ReduceMean(Pow(D, 2)),
+  Y = Add(Mul(Div(D, Sqrt(Add(V, epsilon))), scale), B)
+
+Both ReduceMean nodes must reduce the same trailing axes with keepdims set, the
+scale and bias must be initializers with the shape of the normalized dimensions,
+the exponent and epsilon must be constant initializers that are not graph inputs,
+and no intermediate value may be a graph output or have other consumers.
+*/
+class LayerNormFusion : public onnxruntime::GraphTransformer {
+ public:
+  LayerNormFusion() noexcept : onnxruntime::GraphTransformer("LayerNormFusion", "Fusing layer normalization subgraphs into LayerNormalization") {}
+
+ private:
+  Status ApplyImpl(onnxruntime::Graph& graph, bool& modified, int graph_level) const override;
+};
+
+}  // namespace onnxruntime
@@ -252,6 +252,9 @@ Status Model::Load(std::unique_ptr<ModelProto> p_model_proto, std::shared_ptr<Mo
   return Status::OK();
 }
 
+static Status LoadFromMappedMemory(const char* p_bytes, int count, std::shared_ptr<Model>& p_model,
+                                   const IOnnxRuntimeOpSchemaRegistryList* local_registries);
+
 template <typename T>
 static Status LoadModel(const T& file_path, std::shared_ptr<Model>& p_model, const IOnnxRuntimeOpSchemaRegistryList* local_registries) {
   int fd;
@@ -319,6 +322,16 @@ Status Model::Save(Model& model, const std::wstring& file_path) {
 GSL_SUPPRESS(r .30)  // spurious warnings. p_model is potentially reset in the internal call to Load
 GSL_SUPPRESS(r .35)
 Status Model::Load(const std::string& file_path, std::shared_ptr<Model>& p_model, const IOnnxRuntimeOpSchemaRegistryList* local_registries) {
+  // parse directly from a mapping of the file where possible, which avoids the read() calls into an intermediate
+  // buffer. it does not reduce peak memory for weights embedded as raw_data: parsing copies them into the
+  // ModelProto and the session state copies them again. only weights stored as external data are used in place.
+  size_t length = 0;
+  Env::MappedMemoryPtr mapped_model;
+  if (Env::Default().GetFileLength(file_path, length).IsOK() && length > 0 && length <= INT_MAX &&
+      Env::Default().MapFileIntoMemory(file_path, 0, length, mapped_model).IsOK()) {
+    return LoadFromMappedMemory(mapped_model.get(), static_cast<int>(length), p_model, local_registries);
+  }
+
   return LoadModel(file_path, p_model, local_registries);
 }
 
@@ -340,10 +353,31 @@ Status Model::LoadFromBytes(int count, void* p_bytes, /*out*/ std::shared_ptr<Mo
   return Status::OK();
 }
 
+using ::google::protobuf::io::ArrayInputStream;
 using ::google::protobuf::io::CodedInputStream;
 using ::google::protobuf::io::FileInputStream;
 using ::google::protobuf::io::ZeroCopyInputStream;
 
+static Status LoadFromMappedMemory(const char* p_bytes, int count, std::shared_ptr<Model>& p_model,
+                                   const IOnnxRuntimeOpSchemaRegistryList* local_registries) {
+  ArrayInputStream raw_input(p_bytes, count);
+  CodedInputStream coded_input(&raw_input);
+
+  // Allows protobuf library versions < 3.2.0 to parse messages greater than 64MB.
+  coded_input.SetTotalBytesLimit(INT_MAX, INT_MAX);
+
+  std::unique_ptr<ModelProto> model_proto = std::make_unique<ModelProto>();
+  if (!model_proto->ParseFromCodedStream(&coded_input)) {
+    return Status(ONNXRUNTIME, INVALID_PROTOBUF, "Protobuf parsing failed.");
+  }
+
+  p_model = std::make_shared<Model>(std::move(model_proto), local_registries);
+
+  ORT_RETURN_IF_ERROR(p_model->MainGraph().Resolve(true));
+
+  return Status::OK();
+}
+
 Status Model::Load(int fd, std::shared_ptr<Model>& p_model, const IOnnxRuntimeOpSchemaRegistryList* local_registries) {
   if (fd < 0) {
     return Status(ONNXRUNTIME, INVALID_ARGUMENT, "<p_fd> less than 0.");
@@ -0,0 +1,487 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/graph/nchwc_transformer.h"
+#include "core/graph/graph_utils.h"
+#include "core/graph/initializer.h"
+#include "core/mlas/inc/mlas.h"
+#include <deque>
+#include <unordered_map>
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+bool IsNchwcActivation(const Node& node) {
+  return utils::IsSupportedOptypeVersionAndDomain(node, "LeakyRelu", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Relu", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Sigmoid", 6) ||
+         utils::IsSupportedOptypeVersionAndDomain(node, "Tanh", 6);
+}
+
+// Returns true if the optional auto_pad attribute is missing or set to NOTSET.
+bool HasExplicitPadding(const Node& node) {
+  const auto* auto_pad_attr = utils::GetNodeAttribute(node, "auto_pad");
+  return auto_pad_attr == nullptr || auto_pad_attr->s() == "NOTSET";
+}
+
+// Returns true if both arguments have the same fully specified shape. The
+// NCHWc tensors cannot be broadcast, so this is required for Add and Sum.
+bool HaveSameShape(const NodeArg& arg1, const NodeArg& arg2) {
+  const auto* shape1 = arg1.Shape();
+  const auto* shape2 = arg2.Shape();
+  if (shape1 == nullptr || shape2 == nullptr || shape1->dim_size() != shape2->dim_size()) {
+    return false;
+  }
+  for (int i = 0; i < shape1->dim_size(); i++) {
+    const auto& dim1 = shape1->dim(i);
+    const auto& dim2 = shape2->dim(i);
+    if (!dim1.has_dim_value() || !dim2.has_dim_value() || dim1.dim_value() != dim2.dim_value()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class NchwcTransformerImpl {
+ public:
+  explicit NchwcTransformerImpl(Graph& graph);
+
+  void Transform(Node& node);
+  void Finalize(bool& modified);
+
+ private:
+  // Associate the following state with each NodeArg that has been replaced by
+  // a tensor in the NCHWc layout.
+  struct NchwcArgument {
+    // The node that produces the NCHWc tensor. This is always a node created
+    // by this transformer, so it can be changed in place.
+    Node& output_node_;
+
+    // The NodeArg of the NCHWc tensor.
+    NodeArg* nchwc_arg_;
+
+    // The NodeArg of the original NCHW tensor.
+    NodeArg* original_arg_;
+
+    // The number of consumers of the original NCHW tensor.
+    const size_t starting_original_uses_;
+
+    // The number of consumers of the original NCHW tensor that have not been
+    // transformed to use the NCHWc tensor.
+    size_t remaining_original_uses_;
+
+    NchwcArgument(Node& output_node, NodeArg* nchwc_arg, NodeArg* original_arg, size_t original_uses)
+        : output_node_(output_node),
+          nchwc_arg_(nchwc_arg),
+          original_arg_(original_arg),
+          starting_original_uses_(original_uses),
+          remaining_original_uses_(original_uses) {
+    }
+  };
+
+  size_t OriginalUses(const NodeArg* arg) const;
+  NchwcArgument* LookupNchwcArgument(const NodeArg* arg);
+  NodeArg* CreateNchwcArgument(Node& node, Node& nchwc_node);
+  bool CanFuseIntoOutputNode(const NchwcArgument& nchwc_input) const;
+  void RemoveNode(Node& node);
+
+  void TransformConv(Node& node);
+  void TransformPool(Node& node);
+  void TransformAdd(Node& node);
+  void TransformActivation(Node& node);
+
+  Graph& graph_;
+  const size_t block_size_;
+
+  // The number of nodes that consume each NodeArg in the original graph.
+  std::unordered_map<const NodeArg*, size_t> original_uses_;
+
+  // The NodeArgs that are replaced by NCHWc tensors in the order that they
+  // were created.
+  std::vector<std::unique_ptr<NchwcArgument>> nchwc_args_;
+  std::unordered_map<const NodeArg*, NchwcArgument*> nchwc_args_map_;
+
+  // NCHW tensors that have been reordered to NCHWc for the first run of
+  // transformed nodes that consumes them.
+  std::unordered_map<const NodeArg*, NodeArg*> reorder_inputs_;
+
+  std::deque<NodeIndex> removed_nodes_;
+};
+
+NchwcTransformerImpl::NchwcTransformerImpl(Graph& graph)
+    : graph_(graph), block_size_(MlasNchwcGetBlockSize()) {
+  for (auto& node : graph_.Nodes()) {
+    for (const auto* input_def : node.InputDefs()) {
+      if (input_def->Exists()) {
+        original_uses_[input_def]++;
+      }
+    }
+    for (const auto* input_def : node.ImplicitInputDefs()) {
+      original_uses_[input_def]++;
+    }
+  }
+  for (const auto* output_def : graph_.GetOutputs()) {
+    original_uses_[output_def]++;
+  }
+}
+
+size_t NchwcTransformerImpl::OriginalUses(const NodeArg* arg) const {
+  auto it = original_uses_.find(arg);
+  return (it != original_uses_.end()) ? it->second : 0;
+}
+
+NchwcTransformerImpl::NchwcArgument* NchwcTransformerImpl::LookupNchwcArgument(const NodeArg* arg) {
+  auto it = nchwc_args_map_.find(arg);
+  return (it != nchwc_args_map_.end()) ? it->second : nullptr;
+}
+
+// Creates the NCHWc version of the output of the original node and makes it
+// the output of the new node.
+NodeArg* NchwcTransformerImpl::CreateNchwcArgument(Node& node, Node& nchwc_node) {
+  NodeArg* output_original_arg = node.MutableOutputDefs()[0];
+  std::string output_reorder_def_name = graph_.GenerateNodeArgName(output_original_arg->Name() + "_nchwc");
+  NodeArg* output_nchwc_arg = &graph_.GetOrCreateNodeArg(output_reorder_def_name, output_original_arg->TypeAsProto());
+
+  auto nchwc_arg = std::make_unique<NchwcArgument>(nchwc_node, output_nchwc_arg, output_original_arg,
+                                                   OriginalUses(output_original_arg));
+  nchwc_args_map_[output_original_arg] = nchwc_arg.get();
+  nchwc_args_.push_back(std::move(nchwc_arg));
+
+  nchwc_node.MutableOutputDefs()[0] = output_nchwc_arg;
+  return output_nchwc_arg;
+}
+
+// Returns true if the NCHWc tensor is only consumed by the node being
+// transformed, so that the node can be fused into the NchwcConv producing it.
+// Graph outputs are included in the original uses.
+bool NchwcTransformerImpl::CanFuseIntoOutputNode(const NchwcArgument& nchwc_input) const {
+  return nchwc_input.starting_original_uses_ == 1 &&
+         nchwc_input.output_node_.OpType() == "NchwcConv" &&
+         nchwc_input.output_node_.GetAttributes().count("activation") == 0;
+}
+
+void NchwcTransformerImpl::RemoveNode(Node& node) {
+  utils::RemoveNodeOutputEdges(graph_, node);
+  removed_nodes_.push_front(node.Index());
+}
+
+void NchwcTransformerImpl::TransformConv(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+
+  // The filter must be a constant that can be reordered ahead of time. Skip
+  // filters that are also graph inputs as a feed would replace the reordered
+  // initializer with a tensor in the original layout.
+  const TensorProto* conv_W_tensor_proto = nullptr;
+  if (!utils::IsConstantInitializer(graph_, input_defs[1]->Name()) ||
+      !graph_.GetInitializedTensor(input_defs[1]->Name(), conv_W_tensor_proto) ||
+      conv_W_tensor_proto->data_type() != TensorProto_DataType_FLOAT ||
+      conv_W_tensor_proto->dims_size() != 4 ||
+      OriginalUses(input_defs[1]) != 1) {
+    return;
+  }
+
+  if (!HasExplicitPadding(node)) {
+    return;
+  }
+
+  const int64_t output_channels = conv_W_tensor_proto->dims(0);
+  const int64_t group_input_channels = conv_W_tensor_proto->dims(1);
+  const auto* group_attr = utils::GetNodeAttribute(node, "group");
+  const int64_t group_count = (group_attr != nullptr) ? group_attr->i() : 1;
+  const int64_t input_channels = group_input_channels * group_count;
+  const int64_t block_size = static_cast<int64_t>(block_size_);
+
+  if (output_channels % block_size != 0) {
+    return;
+  }
+
+  // Select the filter layout expected by the MLAS kernel that MlasNchwcConv
+  // selects for this convolution.
+  bool reorder_filter_OIHWBo = false;
+  bool use_nchwc_input = true;
+
+  if (group_count > 1) {
+    if (group_input_channels == 1 && output_channels == input_channels) {
+      if (input_channels % block_size != 0) {
+        return;
+      }
+      reorder_filter_OIHWBo = true;
+    } else if (group_input_channels % block_size != 0 || (output_channels / group_count) % block_size != 0) {
+      return;
+    }
+  } else if (input_channels < block_size) {
+    reorder_filter_OIHWBo = true;
+    use_nchwc_input = false;
+  } else if (input_channels % block_size != 0) {
+    return;
+  }
+
+  // Reorder the filter in place. The shape is unchanged as the channel counts
+  // are already multiples of the block size.
+  auto conv_W = std::make_unique<Initializer>(conv_W_tensor_proto);
+  const int64_t filter_shape[] = {conv_W_tensor_proto->dims(0), conv_W_tensor_proto->dims(1),
+                                  conv_W_tensor_proto->dims(2), conv_W_tensor_proto->dims(3)};
+  std::vector<float> reordered_filter(conv_W->size());
+  if (reorder_filter_OIHWBo) {
+    MlasReorderFilterOIHWBo(filter_shape, conv_W->data<float>(), reordered_filter.data());
+  } else {
+    MlasReorderFilterOIHWBiBo(filter_shape, conv_W->data<float>(), reordered_filter.data());
+  }
+  std::copy(reordered_filter.begin(), reordered_filter.end(), conv_W->data<float>());
+
+  TensorProto new_conv_W_tensor_proto(*conv_W_tensor_proto);
+  conv_W->ToProto(&new_conv_W_tensor_proto);
+  graph_.RemoveInitializedTensor(input_defs[1]->Name());
+  graph_.AddInitializedTensor(new_conv_W_tensor_proto);
+
+  std::vector<NodeArg*> nchwc_input_defs(input_defs);
+
+  if (use_nchwc_input) {
+    auto* nchwc_input = LookupNchwcArgument(input_defs[0]);
+    if (nchwc_input != nullptr) {
+      nchwc_input_defs[0] = nchwc_input->nchwc_arg_;
+      nchwc_input->remaining_original_uses_--;
+    } else {
+      auto it = reorder_inputs_.find(input_defs[0]);
+      if (it != reorder_inputs_.end()) {
+        nchwc_input_defs[0] = it->second;
+      } else {
+        std::string input_reorder_def_name = graph_.GenerateNodeArgName(input_defs[0]->Name() + "_nchwc");
+        NodeArg* input_nchwc_arg = &graph_.GetOrCreateNodeArg(input_reorder_def_name, input_defs[0]->TypeAsProto());
+        graph_.AddNode(graph_.GenerateNodeName("ReorderInput"),
+                       "ReorderInput",
+                       "ReorderInput",
+                       std::vector<NodeArg*>{input_defs[0]},
+                       std::vector<NodeArg*>{input_nchwc_arg},
+                       nullptr,
+                       kMSDomain);
+        reorder_inputs_[input_defs[0]] = input_nchwc_arg;
+        nchwc_input_defs[0] = input_nchwc_arg;
+      }
+    }
+  }
+
+  Node& nchwc_node = graph_.AddNode(graph_.GenerateNodeName(node.Name() + "_nchwc"),
+                                    "NchwcConv",
+                                    "NCHWc " + node.Name(),
+                                    nchwc_input_defs,
+                                    node.MutableOutputDefs(),
+                                    &node.GetAttributes(),
+                                    kMSDomain);
+
+  CreateNchwcArgument(node, nchwc_node);
+  RemoveNode(node);
+}
+
+void NchwcTransformerImpl::TransformPool(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+  auto& output_defs = node.MutableOutputDefs();
+
+  // Only transform pooling nodes that are part of a run of NCHWc nodes.
+  auto* nchwc_input = LookupNchwcArgument(input_defs[0]);
+  if (nchwc_input == nullptr || output_defs.size() != 1) {
+    return;
+  }
+
+  const bool global_pooling = node.OpType() == "GlobalMaxPool" || node.OpType() == "GlobalAveragePool";
+
+  NodeAttributes nchwc_attributes;
+  if (!global_pooling) {
+    if (!HasExplicitPadding(node)) {
+      return;
+    }
+    const auto* kernel_shape_attr = utils::GetNodeAttribute(node, "kernel_shape");
+    if (kernel_shape_attr == nullptr || kernel_shape_attr->ints_size() != 2) {
+      return;
+    }
+    // The MaxPool storage_order attribute only applies to the indices output
+    // which is not supported here, so only copy the attributes in the schema.
+    for (const auto& attr : node.GetAttributes()) {
+      if (attr.first == "kernel_shape" || attr.first == "pads" || attr.first == "strides" ||
+          attr.first == "count_include_pad") {
+        nchwc_attributes[attr.first] = attr.second;
+      }
+    }
+  }
+
+  Node& nchwc_node = graph_.AddNode(graph_.GenerateNodeName(node.Name() + "_nchwc"),
+                                    "Nchwc" + node.OpType(),
+                                    "NCHWc " + node.Name(),
+                                    std::vector<NodeArg*>{nchwc_input->nchwc_arg_},
+                                    output_defs,
+                                    &nchwc_attributes,
+                                    kMSDomain);
+  nchwc_input->remaining_original_uses_--;
+
+  // The output of a global pooling node has a single spatial position, so the
+  // NCHW and NCHWc layouts are identical and the original output can be used.
+  if (!global_pooling) {
+    CreateNchwcArgument(node, nchwc_node);
+  }
+  RemoveNode(node);
+}
+
+void NchwcTransformerImpl::TransformAdd(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+
+  // All of the inputs must be NCHWc tensors of the same shape.
+  std::vector<NchwcArgument*> nchwc_inputs;
+  for (auto* input_def : input_defs) {
+    auto* nchwc_input = LookupNchwcArgument(input_def);
+    if (nchwc_input == nullptr || !HaveSameShape(*input_def, *input_defs[0])) {
+      return;
+    }
+    nchwc_inputs.push_back(nchwc_input);
+  }
+
+  // Try to fuse a two input Add into one of the NchwcConv nodes producing the
+  // inputs by passing the other input as the Sum tensor.
+  if (nchwc_inputs.size() == 2) {
+    for (size_t n = 0; n < 2; n++) {
+      auto* nchwc_input = nchwc_inputs[n];
+      auto* sum_input = nchwc_inputs[n ^ 1];
+      if (nchwc_input == sum_input || !CanFuseIntoOutputNode(*nchwc_input)) {
+        continue;
+      }
+      Node& nchwc_node = nchwc_input->output_node_;
+      auto& nchwc_input_defs = nchwc_node.MutableInputDefs();
+      if (nchwc_input_defs.size() > 3) {
+        continue;
+      }
+      if (nchwc_input_defs.size() < 3) {
+        nchwc_input_defs.push_back(&graph_.GetOrCreateNodeArg("", nullptr));
+      }
+      nchwc_input_defs.push_back(sum_input->nchwc_arg_);
+      nchwc_node.MutableInputArgsCount().assign(nchwc_input_defs.size(), 1);
+      nchwc_input->remaining_original_uses_--;
+      sum_input->remaining_original_uses_--;
+      CreateNchwcArgument(node, nchwc_node);
+      RemoveNode(node);
+      return;
+    }
+  }
+
+  std::vector<NodeArg*> nchwc_input_defs;
+  for (auto* nchwc_input : nchwc_inputs) {
+    nchwc_input_defs.push_back(nchwc_input->nchwc_arg_);
+    nchwc_input->remaining_original_uses_--;
+  }
+
+  Node& nchwc_node = graph_.AddNode(graph_.GenerateNodeName(node.Name() + "_nchwc"),
+                                    node.OpType(),
+                                    "NCHWc " + node.Name(),
+                                    nchwc_input_defs,
+                                    node.MutableOutputDefs(),
+                                    &node.GetAttributes(),
+                                    node.Domain());
+  CreateNchwcArgument(node, nchwc_node);
+  RemoveNode(node);
+}
+
+void NchwcTransformerImpl::TransformActivation(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+
+  auto* nchwc_input = LookupNchwcArgument(input_defs[0]);
+  if (nchwc_input == nullptr) {
+    return;
+  }
+
+  if (CanFuseIntoOutputNode(*nchwc_input)) {
+    Node& nchwc_node = nchwc_input->output_node_;
+    nchwc_node.AddAttribute("activation", node.OpType());
+    if (node.OpType() == "LeakyRelu") {
+      for (const auto& attr : node.GetAttributes()) {
+        nchwc_node.AddAttribute(attr.first, attr.second);
+      }
+    }
+    nchwc_input->remaining_original_uses_--;
+    CreateNchwcArgument(node, nchwc_node);
+    RemoveNode(node);
+    return;
+  }
+
+  // The activation operates elementwise, so apply it to the NCHWc tensor.
+  Node& nchwc_node = graph_.AddNode(graph_.GenerateNodeName(node.Name() + "_nchwc"),
+                                    node.OpType(),
+                                    "NCHWc " + node.Name(),
+                                    std::vector<NodeArg*>{nchwc_input->nchwc_arg_},
+                                    node.MutableOutputDefs(),
+                                    &node.GetAttributes(),
+                                    node.Domain());
+  nchwc_input->remaining_original_uses_--;
+  CreateNchwcArgument(node, nchwc_node);
+  RemoveNode(node);
+}
+
+void NchwcTransformerImpl::Transform(Node& node) {
+  if (node.GetExecutionProviderType() != kCpuExecutionProvider && !node.GetExecutionProviderType().empty()) {
+    return;
+  }
+
+  if (utils::IsSupportedOptypeVersionAndDomain(node, "Conv", 1) ||
+      utils::IsSupportedOptypeVersionAndDomain(node, "FusedConv", 1, kMSDomain)) {
+    TransformConv(node);
+  } else if (utils::IsSupportedOptypeVersionAndDomain(node, "MaxPool", 1) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "MaxPool", 8) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "AveragePool", 1) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "AveragePool", 7) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "GlobalMaxPool", 1) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "GlobalAveragePool", 1)) {
+    TransformPool(node);
+  } else if (utils::IsSupportedOptypeVersionAndDomain(node, "Add", 7) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "Sum", 6) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "Sum", 8)) {
+    TransformAdd(node);
+  } else if (IsNchwcActivation(node)) {
+    TransformActivation(node);
+  }
+}
+
+void NchwcTransformerImpl::Finalize(bool& modified) {
+  // Reorder the NCHWc tensors back to the original NCHW tensors for the
+  // consumers that were not transformed and for the graph outputs.
+  for (auto& nchwc_output : nchwc_args_) {
+    if (nchwc_output->remaining_original_uses_ > 0) {
+      graph_.AddNode(graph_.GenerateNodeName("ReorderOutput"),
+                     "ReorderOutput",
+                     "ReorderOutput",
+                     std::vector<NodeArg*>{nchwc_output->nchwc_arg_},
+                     std::vector<NodeArg*>{nchwc_output->original_arg_},
+                     nullptr,
+                     kMSDomain);
+    }
+  }
+
+  for (auto index : removed_nodes_) {
+    graph_.RemoveNode(index);
+  }
+
+  if (!removed_nodes_.empty()) {
+    modified = true;
+  }
+}
+
+}  // namespace
+
+Status NchwcTransformer::ApplyImpl(Graph& graph, bool& modified, int graph_level) const {
+  if (MlasNchwcGetBlockSize() <= 1) {
+    return Status::OK();
+  }
+
+  NchwcTransformerImpl impl(graph);
+  GraphViewer graph_viewer(graph);
+
+  for (auto index : graph_viewer.GetNodesInTopologicalOrder()) {
+    auto& node = *graph.GetNode(index);
+    ORT_RETURN_IF_ERROR(Recurse(node, modified, graph_level));
+    impl.Transform(node);
+  }
+
+  impl.Finalize(modified);
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
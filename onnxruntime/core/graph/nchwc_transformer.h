@@ -0,0 +1,29 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/graph/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@class NchwcTransformer
+
+Transforms runs of 2D convolution and pooling nodes to the NCHWc layout used by
+the MLAS NCHWc kernels. Inputs are reordered to NCHWc once at the start of a
+run and reordered back to NCHW only where a tensor is consumed by a node that
+was not transformed or is a graph output. Convolution weights are reordered
+ahead of time. Activations and same shaped Add/Sum nodes inside a run operate
+on the NCHWc tensors directly and are fused into the convolution when possible.
+The transformer does nothing if the platform does not support the NCHWc kernels.
+*/
+class NchwcTransformer : public onnxruntime::GraphTransformer {
+ public:
+  NchwcTransformer() noexcept : onnxruntime::GraphTransformer("NchwcTransformer", "Transforms convolutions and pooling to the NCHWc layout") {}
+
+ private:
+  Status ApplyImpl(onnxruntime::Graph& graph, bool& modified, int graph_level) const override;
+};
+
+}  // namespace onnxruntime
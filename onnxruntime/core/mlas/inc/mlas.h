@@ -94,6 +94,133 @@ MlasSgemm(
     size_t ldc
     );
 
+//
+// Single precision matrix/matrix multiply routines using a prepacked matrix B.
+//
+// Matrix B is packed once with MlasSgemmPackB to the layout used by the SGEMM
+// kernels. The packed buffer must be aligned to 64 bytes.
+//
+
+size_t
+MLASCALL
+MlasSgemmPackBSize(
+    size_t N,
+    size_t K
+    );
+
+void
+MLASCALL
+MlasSgemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    void* PackedB
+    );
+
+void
+MLASCALL
+MlasSgemmPacked(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc
+    );
+
+//
+// Quantized integer matrix/matrix multiply routines.
+//
+// Computes C = (A - offa) * (B - offb) where A is a row major M x K matrix of
+// unsigned 8-bit values, B is a row major K x N matrix of unsigned or signed
+// 8-bit values and C is a row major M x N matrix of 32-bit results.
+//
+// Matrix B can be packed ahead of time with MlasQgemmPackB. The zero point of
+// matrix B is applied when the matrix is packed.
+//
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    int32_t* C,
+    size_t ldc
+    );
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const int8_t* B,
+    size_t ldb,
+    int8_t offb,
+    int32_t* C,
+    size_t ldc
+    );
+
+size_t
+MLASCALL
+MlasQgemmPackBSize(
+    size_t N,
+    size_t K
+    );
+
+void
+MLASCALL
+MlasQgemmPackB(
+    size_t N,
+    size_t K,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    void* PackedB
+    );
+
+void
+MLASCALL
+MlasQgemmPackB(
+    size_t N,
+    size_t K,
+    const int8_t* B,
+    size_t ldb,
+    int8_t offb,
+    void* PackedB
+    );
+
+void
+MLASCALL
+MlasQgemmPacked(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const void* PackedB,
+    int32_t* C,
+    size_t ldc
+    );
+
 //
 // Convolution routines.
 //
@@ -102,6 +229,7 @@ enum MLAS_CONV_ALGORITHM {
     MlasConvAlgorithmGemmDirect,
     MlasConvAlgorithmExpandThenGemm,
     MlasConvAlgorithmExpandThenGemmSegmented,
+    MlasConvAlgorithmWinograd,
 };
 
 struct MLAS_CONV_PARAMETERS {
@@ -129,6 +257,11 @@ struct MLAS_CONV_PARAMETERS {
         struct {
             size_t ThreadStrideN;
         } ExpandThenGemmSegmented;
+        struct {
+            size_t OutputTileSize;
+            size_t TileRowsPerBlock;
+            size_t ThreadCount;
+        } Winograd;
     } u;
 };
 
@@ -162,14 +295,51 @@ MlasConv(
     float* Output
     );
 
+//
+// Winograd convolution filter routines.
+//
+// When MlasConvPrepare selects MlasConvAlgorithmWinograd, the filter supplied
+// to MlasConv must be transformed by MlasConvWinogradTransformFilter using the
+// output tile size from Parameters->u.Winograd.OutputTileSize. The transform
+// depends only on the filter, so callers with constant weights may transform
+// them once and reuse the result. MlasConvWinogradGetTransformedFilterSize
+// returns zero if the filter is not supported by the Winograd algorithm.
+//
+
+size_t
+MLASCALL
+MlasConvWinogradGetTransformedFilterSize(
+    size_t OutputTileSize,
+    size_t GroupCount,
+    size_t FilterCount,
+    size_t InputChannels
+    );
+
+void
+MLASCALL
+MlasConvWinogradTransformFilter(
+    size_t OutputTileSize,
+    size_t GroupCount,
+    size_t FilterCount,
+    size_t InputChannels,
+    const float* Filter,
+    float* TransformedFilter
+    );
+
 //
 // Pooling routines.
 //
+// The L1 and L2 norm pooling kinds implement Lp pooling with p=1 and p=2.
+// Padding elements do not contribute to the norm. A null kernel shape selects
+// global pooling over the entire input shape.
+//
 
 enum MLAS_POOLING_KIND {
     MlasMaximumPooling,
     MlasAveragePoolingExcludePad,
     MlasAveragePoolingIncludePad,
+    MlasL1NormPooling,
+    MlasL2NormPooling,
 };
 
 void
@@ -186,6 +356,132 @@ MlasPool(
     float* Output
     );
 
+//
+// Convolution and pooling routines using the NCHWc layout.
+//
+// The NCHWc layout splits the channel dimension into blocks of the size
+// returned by MlasNchwcGetBlockSize and stores the channels of a block
+// contiguously for each spatial position, i.e. [N][C/Block][H][W][Block]. A
+// block size of one indicates that the platform does not support the NCHWc
+// routines. The shapes are supplied in NCHW form with the channel counts
+// rounded up to a multiple of the block size.
+//
+
+size_t
+MLASCALL
+MlasNchwcGetBlockSize(
+    void
+    );
+
+void
+MLASCALL
+MlasNchwcConv(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    size_t GroupCount,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    const MLAS_ACTIVATION* Activation,
+    bool ZeroMode
+    );
+
+void
+MLASCALL
+MlasNchwcPool(
+    MLAS_POOLING_KIND PoolingKind,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    float* Output
+    );
+
+void
+MLASCALL
+MlasReorderInput(
+    const int64_t* InputShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderOutput(
+    const int64_t* OutputShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderFilterOIHWBiBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderFilterOIHWBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    );
+
+//
+// Element-wise binary routines with multidirectional (numpy style) broadcasting.
+//
+// The input shapes are padded with leading ones to the number of output
+// dimensions, which must not exceed MLAS_MAXIMUM_BROADCAST_DIMENSIONS.
+//
+
+#define MLAS_MAXIMUM_BROADCAST_DIMENSIONS   8
+
+enum MLAS_BINARY_OPERATION_KIND {
+    MlasAddOperation,
+    MlasSubtractOperation,
+    MlasMultiplyOperation,
+    MlasDivideOperation,
+    MlasMaximumOperation,
+    MlasMinimumOperation,
+};
+
+void
+MLASCALL
+MlasBroadcastBinaryOperation(
+    MLAS_BINARY_OPERATION_KIND OperationKind,
+    size_t Dimensions,
+    const int64_t* InputShapeA,
+    const int64_t* InputShapeB,
+    const int64_t* OutputShape,
+    const float* InputA,
+    const float* InputB,
+    float* Output
+    );
+
+//
+// Transpose routines.
+//
+
+void
+MLASCALL
+MlasTranspose(
+    size_t M,
+    size_t N,
+    const uint32_t* Input,
+    size_t lda,
+    uint32_t* Output,
+    size_t ldb
+    );
+
 //
 // Miscellaneous compute routines.
 //
@@ -206,6 +502,32 @@ MlasComputeTanh(
     size_t N
     );
 
+void
+MLASCALL
+MlasComputeErf(
+    const float* Input,
+    float* Output,
+    size_t N
+    );
+
+void
+MLASCALL
+MlasComputeExp(
+    const float* Input,
+    float* Output,
+    size_t N
+    );
+
+void
+MLASCALL
+MlasComputeSoftmax(
+    const float* Input,
+    float* Output,
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    );
+
 //
 // Half-precision floating-point routines.
 //
@@ -0,0 +1,366 @@
+;++
+;
+; Copyright (c) Microsoft Corporation. All rights reserved.
+;
+; Licensed under the MIT License.
+;
+; Module Name:
+;
+;   ExpKernelFma3.asm
+;
+; Abstract:
+;
+;   This module implements kernels for computing the exponential function for
+;   a buffer of elements.
+;
+;   This implementation uses AVX fused multiply/add instructions.
+;
+;--
+
+        .xlist
+INCLUDE mlasi.inc
+        .list
+
+        EXTERN  MlasMaskMoveAvx:NEAR
+        EXTERN  MlasExpConstants:NEAR
+
+;
+; Structure layout for the exponential constants block.
+;
+
+ExpConstants STRUCT
+
+        LowerRange DWORD ?
+        UpperRange DWORD ?
+        LOG2e DWORD ?
+        ln2_high DWORD ?
+        ln2_low DWORD ?
+        p0 DWORD ?
+        p1 DWORD ?
+        p2 DWORD ?
+        p3 DWORD ?
+        p4 DWORD ?
+        p5 DWORD ?
+        One DWORD ?
+        RoundingBias DWORD ?
+        ExponentBias DWORD ?
+
+ExpConstants ENDS
+
+;
+; Stack frame layout for the exponential kernels.
+;
+
+ExpKernelFrame STRUCT
+
+        SavedXmm6 OWORD ?
+        SavedXmm7 OWORD ?
+        SavedXmm8 OWORD ?
+        SavedXmm9 OWORD ?
+        SavedXmm10 OWORD ?
+        SavedXmm11 OWORD ?
+        SavedXmm12 OWORD ?
+        SavedXmm13 OWORD ?
+        SavedXmm14 OWORD ?
+        SavedXmm15 OWORD ?
+        Padding0 QWORD ?
+        Padding1 QWORD ?
+        CountN QWORD ?
+        ReturnAddress QWORD ?
+        PreviousP1Home QWORD ?
+        PreviousP2Home QWORD ?
+        PreviousP3Home QWORD ?
+        PreviousP4Home QWORD ?
+
+ExpKernelFrame ENDS
+
+;++
+;
+; Routine Description:
+;
+;   This routine implements a vectorized kernel for the exponential function.
+;
+; Arguments:
+;
+;   Input (rcx) - Supplies the input buffer.
+;
+;   Output (rdx) - Supplies the output buffer.
+;
+;   N (r8)  - Supplies the number of elements to process.
+;
+; Return Value:
+;
+;   None.
+;
+;--
+
+        NESTED_ENTRY MlasExpKernelFma3, _TEXT
+
+        alloc_stack (ExpKernelFrame.ReturnAddress)
+
+        save_xmm128_avx xmm6,ExpKernelFrame.SavedXmm6
+        save_xmm128_avx xmm7,ExpKernelFrame.SavedXmm7
+        save_xmm128_avx xmm8,ExpKernelFrame.SavedXmm8
+        save_xmm128_avx xmm9,ExpKernelFrame.SavedXmm9
+        save_xmm128_avx xmm10,ExpKernelFrame.SavedXmm10
+        save_xmm128_avx xmm11,ExpKernelFrame.SavedXmm11
+        save_xmm128_avx xmm12,ExpKernelFrame.SavedXmm12
+        save_xmm128_avx xmm13,ExpKernelFrame.SavedXmm13
+        save_xmm128_avx xmm14,ExpKernelFrame.SavedXmm14
+        save_xmm128_avx xmm15,ExpKernelFrame.SavedXmm15
+
+        END_PROLOGUE
+
+        lea     rax,MlasExpConstants
+        vbroadcastss ymm4,ExpConstants.LowerRange[rax]
+        vbroadcastss ymm5,ExpConstants.UpperRange[rax]
+        vbroadcastss ymm6,ExpConstants.LOG2e[rax]
+        vbroadcastss ymm7,ExpConstants.ln2_high[rax]
+        vbroadcastss ymm8,ExpConstants.ln2_low[rax]
+        vbroadcastss ymm9,ExpConstants.p0[rax]
+        vbroadcastss ymm10,ExpConstants.p1[rax]
+        vbroadcastss ymm11,ExpConstants.p2[rax]
+        vbroadcastss ymm12,ExpConstants.p3[rax]
+        vbroadcastss ymm13,ExpConstants.p4[rax]
+        vbroadcastss ymm14,ExpConstants.p5[rax]
+        vbroadcastss ymm15,ExpConstants.RoundingBias[rax]
+
+        sub     r8,8
+        jb      ExpProcessRemainingCount
+
+ComputeExpBy8Loop:
+        vmaxps  ymm0,ymm4,YMMWORD PTR [rcx]     ; clamp lower bound
+        vmovaps ymm1,ymm15
+        vminps  ymm0,ymm5,ymm0                  ; clamp upper bound
+        vfmadd231ps ymm1,ymm0,ymm6              ; biased m = x * log2e + rounding bias
+        vsubps  ymm2,ymm1,ymm15                 ; m = round(x * log2e)
+        vfmadd231ps ymm0,ymm2,ymm7              ; r = m * ln2_high + x
+        vfmadd231ps ymm0,ymm2,ymm8              ; r = m * ln2_low + r
+        vmovaps ymm2,ymm10
+        vfmadd231ps ymm2,ymm0,ymm9              ; p = r * p0 + p1
+        vfmadd213ps ymm2,ymm0,ymm11             ; p = r * p + p2
+        vfmadd213ps ymm2,ymm0,ymm12             ; p = r * p + p3
+        vfmadd213ps ymm2,ymm0,ymm13             ; p = r * p + p4
+        vfmadd213ps ymm2,ymm0,ymm14             ; p = r * p + p5
+        vbroadcastss ymm3,ExpConstants.One[rax]
+        vaddps  ymm3,ymm0,ymm3                  ; r + 1
+        vmulps  ymm0,ymm0,ymm0                  ; r2
+        vfmadd213ps ymm2,ymm0,ymm3              ; p = r2 * p + (r + 1)
+        vpslld  ymm1,ymm1,23                    ; shift m to the exponent field
+        vpbroadcastd ymm3,DWORD PTR ExpConstants.ExponentBias[rax]
+        vpaddd  ymm1,ymm1,ymm3                  ; 2^m
+        vmulps  ymm0,ymm2,ymm1                  ; exp = p * 2^m
+        add     rcx,8*4                         ; advance input by 8 elements
+        vmovups YMMWORD PTR [rdx],ymm0
+        add     rdx,8*4                         ; advance output by 8 elements
+        sub     r8,8
+        jae     ComputeExpBy8Loop
+
+ExpProcessRemainingCount:
+        add     r8,8                            ; correct for over-subtract above
+        jz      ExpExitKernel
+        mov     DWORD PTR ExpKernelFrame.CountN[rsp],r8d
+        vbroadcastss ymm3,DWORD PTR ExpKernelFrame.CountN[rsp]
+        vpcmpgtd ymm3,ymm3,YMMWORD PTR [MlasMaskMoveAvx]
+        vmaskmovps ymm0,ymm3,YMMWORD PTR [rcx]
+        vmaxps  ymm0,ymm4,ymm0                  ; clamp lower bound
+        vmovaps ymm1,ymm15
+        vminps  ymm0,ymm5,ymm0                  ; clamp upper bound
+        vfmadd231ps ymm1,ymm0,ymm6              ; biased m = x * log2e + rounding bias
+        vsubps  ymm2,ymm1,ymm15                 ; m = round(x * log2e)
+        vfmadd231ps ymm0,ymm2,ymm7              ; r = m * ln2_high + x
+        vfmadd231ps ymm0,ymm2,ymm8              ; r = m * ln2_low + r
+        vmovaps ymm2,ymm10
+        vfmadd231ps ymm2,ymm0,ymm9              ; p = r * p0 + p1
+        vfmadd213ps ymm2,ymm0,ymm11             ; p = r * p + p2
+        vfmadd213ps ymm2,ymm0,ymm12             ; p = r * p + p3
+        vfmadd213ps ymm2,ymm0,ymm13             ; p = r * p + p4
+        vfmadd213ps ymm2,ymm0,ymm14             ; p = r * p + p5
+        vbroadcastss ymm4,ExpConstants.One[rax]
+        vaddps  ymm4,ymm0,ymm4                  ; r + 1
+        vmulps  ymm0,ymm0,ymm0                  ; r2
+        vfmadd213ps ymm2,ymm0,ymm4              ; p = r2 * p + (r + 1)
+        vpslld  ymm1,ymm1,23                    ; shift m to the exponent field
+        vpbroadcastd ymm4,DWORD PTR ExpConstants.ExponentBias[rax]
+        vpaddd  ymm1,ymm1,ymm4                  ; 2^m
+        vmulps  ymm0,ymm2,ymm1                  ; exp = p * 2^m
+        vmaskmovps YMMWORD PTR [rdx],ymm3,ymm0
+
+ExpExitKernel:
+        vzeroupper
+        vmovaps xmm6,ExpKernelFrame.SavedXmm6[rsp]
+        vmovaps xmm7,ExpKernelFrame.SavedXmm7[rsp]
+        vmovaps xmm8,ExpKernelFrame.SavedXmm8[rsp]
+        vmovaps xmm9,ExpKernelFrame.SavedXmm9[rsp]
+        vmovaps xmm10,ExpKernelFrame.SavedXmm10[rsp]
+        vmovaps xmm11,ExpKernelFrame.SavedXmm11[rsp]
+        vmovaps xmm12,ExpKernelFrame.SavedXmm12[rsp]
+        vmovaps xmm13,ExpKernelFrame.SavedXmm13[rsp]
+        vmovaps xmm14,ExpKernelFrame.SavedXmm14[rsp]
+        vmovaps xmm15,ExpKernelFrame.SavedXmm15[rsp]
+        add     rsp,(ExpKernelFrame.ReturnAddress)
+
+        BEGIN_EPILOGUE
+
+        ret
+
+        NESTED_END MlasExpKernelFma3, _TEXT
+
+;++
+;
+; Routine Description:
+;
+;   This routine implements a vectorized kernel that computes the exponential
+;   of each element offset by the negative maximum and accumulates the sum of
+;   the results.
+;
+; Arguments:
+;
+;   Input (rcx) - Supplies the input buffer.
+;
+;   Output (rdx) - Supplies the output buffer to receive the exponentials, or
+;       NULL if only the sum is needed.
+;
+;   N (r8)  - Supplies the number of elements to process.
+;
+;   NegativeMaximum (r9) - Supplies the address of the value added to each
+;       element before the exponential is computed.
+;
+; Return Value:
+;
+;   Returns the sum of the exponentials.
+;
+;--
+
+        NESTED_ENTRY MlasComputeSumExpKernelFma3, _TEXT
+
+        alloc_stack (ExpKernelFrame.ReturnAddress)
+
+        save_xmm128_avx xmm6,ExpKernelFrame.SavedXmm6
+        save_xmm128_avx xmm7,ExpKernelFrame.SavedXmm7
+        save_xmm128_avx xmm8,ExpKernelFrame.SavedXmm8
+        save_xmm128_avx xmm9,ExpKernelFrame.SavedXmm9
+        save_xmm128_avx xmm10,ExpKernelFrame.SavedXmm10
+        save_xmm128_avx xmm11,ExpKernelFrame.SavedXmm11
+        save_xmm128_avx xmm12,ExpKernelFrame.SavedXmm12
+        save_xmm128_avx xmm13,ExpKernelFrame.SavedXmm13
+        save_xmm128_avx xmm14,ExpKernelFrame.SavedXmm14
+        save_xmm128_avx xmm15,ExpKernelFrame.SavedXmm15
+
+        END_PROLOGUE
+
+        lea     rax,MlasExpConstants
+        vbroadcastss ymm4,ExpConstants.LowerRange[rax]
+        vbroadcastss ymm5,ExpConstants.UpperRange[rax]
+        vbroadcastss ymm6,ExpConstants.LOG2e[rax]
+        vbroadcastss ymm7,ExpConstants.ln2_high[rax]
+        vbroadcastss ymm8,ExpConstants.ln2_low[rax]
+        vbroadcastss ymm9,ExpConstants.p0[rax]
+        vbroadcastss ymm10,ExpConstants.p1[rax]
+        vbroadcastss ymm11,ExpConstants.p2[rax]
+        vbroadcastss ymm12,ExpConstants.p3[rax]
+        vbroadcastss ymm13,ExpConstants.RoundingBias[rax]
+        vbroadcastss ymm14,DWORD PTR [r9]       ; broadcast negative maximum value
+        vxorps  xmm15,xmm15,xmm15               ; clear exp() accumulator
+
+        sub     r8,8
+        jb      SumExpProcessRemainingCount
+
+ComputeSumExpBy8Loop:
+        vaddps  ymm0,ymm14,YMMWORD PTR [rcx]    ; bias by negative maximum value
+        vmovaps ymm1,ymm13
+        vmaxps  ymm0,ymm4,ymm0                  ; clamp lower bound
+        vminps  ymm0,ymm5,ymm0                  ; clamp upper bound
+        vfmadd231ps ymm1,ymm0,ymm6              ; biased m = x * log2e + rounding bias
+        vsubps  ymm2,ymm1,ymm13                 ; m = round(x * log2e)
+        vfmadd231ps ymm0,ymm2,ymm7              ; r = m * ln2_high + x
+        vfmadd231ps ymm0,ymm2,ymm8              ; r = m * ln2_low + r
+        vmovaps ymm2,ymm10
+        vfmadd231ps ymm2,ymm0,ymm9              ; p = r * p0 + p1
+        vfmadd213ps ymm2,ymm0,ymm11             ; p = r * p + p2
+        vfmadd213ps ymm2,ymm0,ymm12             ; p = r * p + p3
+        vbroadcastss ymm3,ExpConstants.p4[rax]
+        vfmadd213ps ymm2,ymm0,ymm3              ; p = r * p + p4
+        vbroadcastss ymm3,ExpConstants.p5[rax]
+        vfmadd213ps ymm2,ymm0,ymm3              ; p = r * p + p5
+        vbroadcastss ymm3,ExpConstants.One[rax]
+        vaddps  ymm3,ymm0,ymm3                  ; r + 1
+        vmulps  ymm0,ymm0,ymm0                  ; r2
+        vfmadd213ps ymm2,ymm0,ymm3              ; p = r2 * p + (r + 1)
+        vpslld  ymm1,ymm1,23                    ; shift m to the exponent field
+        vpbroadcastd ymm3,DWORD PTR ExpConstants.ExponentBias[rax]
+        vpaddd  ymm1,ymm1,ymm3                  ; 2^m
+        vmulps  ymm0,ymm2,ymm1                  ; exp = p * 2^m
+        vaddps  ymm15,ymm15,ymm0                ; accumulate exp() results
+        add     rcx,8*4                         ; advance input by 8 elements
+        test    rdx,rdx
+        jz      SkipStoreResultsBy8
+        vmovups YMMWORD PTR [rdx],ymm0
+        add     rdx,8*4                         ; advance output by 8 elements
+
+SkipStoreResultsBy8:
+        sub     r8,8
+        jae     ComputeSumExpBy8Loop
+
+SumExpProcessRemainingCount:
+        add     r8,8                            ; correct for over-subtract above
+        jz      SumExpReduceAccumulator
+        mov     DWORD PTR ExpKernelFrame.CountN[rsp],r8d
+        vbroadcastss ymm3,DWORD PTR ExpKernelFrame.CountN[rsp]
+        vpcmpgtd ymm3,ymm3,YMMWORD PTR [MlasMaskMoveAvx]
+        vmaskmovps ymm0,ymm3,YMMWORD PTR [rcx]
+        vaddps  ymm0,ymm14,ymm0                 ; bias by negative maximum value
+        vmovaps ymm1,ymm13
+        vmaxps  ymm0,ymm4,ymm0                  ; clamp lower bound
+        vminps  ymm0,ymm5,ymm0                  ; clamp upper bound
+        vfmadd231ps ymm1,ymm0,ymm6              ; biased m = x * log2e + rounding bias
+        vsubps  ymm2,ymm1,ymm13                 ; m = round(x * log2e)
+        vfmadd231ps ymm0,ymm2,ymm7              ; r = m * ln2_high + x
+        vfmadd231ps ymm0,ymm2,ymm8              ; r = m * ln2_low + r
+        vmovaps ymm2,ymm10
+        vfmadd231ps ymm2,ymm0,ymm9              ; p = r * p0 + p1
+        vfmadd213ps ymm2,ymm0,ymm11             ; p = r * p + p2
+        vfmadd213ps ymm2,ymm0,ymm12             ; p = r * p + p3
+        vbroadcastss ymm4,ExpConstants.p4[rax]
+        vfmadd213ps ymm2,ymm0,ymm4              ; p = r * p + p4
+        vbroadcastss ymm4,ExpConstants.p5[rax]
+        vfmadd213ps ymm2,ymm0,ymm4              ; p = r * p + p5
+        vbroadcastss ymm4,ExpConstants.One[rax]
+        vaddps  ymm4,ymm0,ymm4                  ; r + 1
+        vmulps  ymm0,ymm0,ymm0                  ; r2
+        vfmadd213ps ymm2,ymm0,ymm4              ; p = r2 * p + (r + 1)
+        vpslld  ymm1,ymm1,23                    ; shift m to the exponent field
+        vpbroadcastd ymm4,DWORD PTR ExpConstants.ExponentBias[rax]
+        vpaddd  ymm1,ymm1,ymm4                  ; 2^m
+        vmulps  ymm0,ymm2,ymm1                  ; exp = p * 2^m
+        vandps  ymm0,ymm3,ymm0                  ; clear the unused elements
+        vaddps  ymm15,ymm15,ymm0                ; accumulate exp() results
+        test    rdx,rdx
+        jz      SumExpReduceAccumulator
+        vmaskmovps YMMWORD PTR [rdx],ymm3,ymm0
+
+SumExpReduceAccumulator:
+        vextractf128 xmm0,ymm15,1
+        vaddps  xmm0,xmm0,xmm15
+        vhaddps xmm0,xmm0,xmm0
+        vhaddps xmm0,xmm0,xmm0
+        vzeroupper
+        vmovaps xmm6,ExpKernelFrame.SavedXmm6[rsp]
+        vmovaps xmm7,ExpKernelFrame.SavedXmm7[rsp]
+        vmovaps xmm8,ExpKernelFrame.SavedXmm8[rsp]
+        vmovaps xmm9,ExpKernelFrame.SavedXmm9[rsp]
+        vmovaps xmm10,ExpKernelFrame.SavedXmm10[rsp]
+        vmovaps xmm11,ExpKernelFrame.SavedXmm11[rsp]
+        vmovaps xmm12,ExpKernelFrame.SavedXmm12[rsp]
+        vmovaps xmm13,ExpKernelFrame.SavedXmm13[rsp]
+        vmovaps xmm14,ExpKernelFrame.SavedXmm14[rsp]
+        vmovaps xmm15,ExpKernelFrame.SavedXmm15[rsp]
+        add     rsp,(ExpKernelFrame.ReturnAddress)
+
+        BEGIN_EPILOGUE
+
+        ret
+
+        NESTED_END MlasComputeSumExpKernelFma3, _TEXT
+
+        END
@@ -0,0 +1,481 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    broadcast.cpp
+
+Abstract:
+
+    This module implements element-wise binary operations with multidirectional
+    (numpy style) broadcasting.
+
+    The input shapes are first collapsed so that adjacent dimensions with the
+    same broadcasting pattern are merged into a single dimension. The innermost
+    collapsed dimension forms a span that is processed by a vectorized kernel
+    specialized for the pattern of the span: both inputs are vectors, input A
+    is a scalar, or input B is a scalar. The outer collapsed dimensions are
+    walked with per-input strides that are zero for broadcast dimensions.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the prototype of the broadcast span kernel routine.
+//
+
+typedef
+void
+(MLAS_BROADCAST_KERNEL_ROUTINE)(
+    const float* InputA,
+    const float* InputB,
+    float* Output,
+    size_t N
+    );
+
+typedef MLAS_BROADCAST_KERNEL_ROUTINE* PMLAS_BROADCAST_KERNEL_ROUTINE;
+
+//
+// Define the parameters to execute segments of a broadcast operation on worker
+// threads.
+//
+
+struct MLAS_BROADCAST_WORK_BLOCK {
+    PMLAS_BROADCAST_KERNEL_ROUTINE KernelRoutine;
+    const float* InputA;
+    const float* InputB;
+    float* Output;
+    bool ScalarA;
+    bool ScalarB;
+    size_t SpanLength;
+    size_t OuterDimensions;
+    size_t OuterShape[MLAS_MAXIMUM_BROADCAST_DIMENSIONS];
+    size_t OuterStrideA[MLAS_MAXIMUM_BROADCAST_DIMENSIONS];
+    size_t OuterStrideB[MLAS_MAXIMUM_BROADCAST_DIMENSIONS];
+    size_t OutputSize;
+    int32_t TargetThreadCount;
+};
+
+//
+// Define the minimum number of output elements to assign to a worker thread.
+//
+
+#define MLAS_BROADCAST_MINIMUM_ELEMENTS_PER_THREAD      16384
+
+//
+// Define the broadcasting patterns of a collapsed dimension.
+//
+
+#define MLAS_BROADCAST_PATTERN_BROADCAST_A              0x1
+#define MLAS_BROADCAST_PATTERN_BROADCAST_B              0x2
+
+struct MLAS_BINARY_ADD
+{
+    static float Scalar(float a, float b) { return a + b; }
+    static MLAS_FLOAT32X4 Vector(MLAS_FLOAT32X4 a, MLAS_FLOAT32X4 b) { return MlasAddFloat32x4(a, b); }
+};
+
+struct MLAS_BINARY_SUBTRACT
+{
+    static float Scalar(float a, float b) { return a - b; }
+    static MLAS_FLOAT32X4 Vector(MLAS_FLOAT32X4 a, MLAS_FLOAT32X4 b) { return MlasSubtractFloat32x4(a, b); }
+};
+
+struct MLAS_BINARY_MULTIPLY
+{
+    static float Scalar(float a, float b) { return a * b; }
+    static MLAS_FLOAT32X4 Vector(MLAS_FLOAT32X4 a, MLAS_FLOAT32X4 b) { return MlasMultiplyFloat32x4(a, b); }
+};
+
+struct MLAS_BINARY_DIVIDE
+{
+    static float Scalar(float a, float b) { return a / b; }
+    static MLAS_FLOAT32X4 Vector(MLAS_FLOAT32X4 a, MLAS_FLOAT32X4 b) { return MlasDivideFloat32x4(a, b); }
+};
+
+struct MLAS_BINARY_MAXIMUM
+{
+    static float Scalar(float a, float b) { return (a > b) ? a : b; }
+    static MLAS_FLOAT32X4 Vector(MLAS_FLOAT32X4 a, MLAS_FLOAT32X4 b) { return MlasMaximumFloat32x4(a, b); }
+};
+
+struct MLAS_BINARY_MINIMUM
+{
+    static float Scalar(float a, float b) { return (a < b) ? a : b; }
+    static MLAS_FLOAT32X4 Vector(MLAS_FLOAT32X4 a, MLAS_FLOAT32X4 b) { return MlasMinimumFloat32x4(a, b); }
+};
+
+template<typename OperationType, bool ScalarA, bool ScalarB>
+void
+MlasBroadcastKernel(
+    const float* InputA,
+    const float* InputB,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine applies the binary operation to a span of elements.
+
+Arguments:
+
+    InputA - Supplies the first input span. If ScalarA is true, then the first
+        element is broadcast across the span.
+
+    InputB - Supplies the second input span. If ScalarB is true, then the first
+        element is broadcast across the span.
+
+    Output - Supplies the output span.
+
+    N - Supplies the number of elements in the span.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const float ScalarValueA = *InputA;
+    const float ScalarValueB = *InputB;
+
+    const MLAS_FLOAT32X4 ScalarVectorA = MlasBroadcastFloat32x4(ScalarValueA);
+    const MLAS_FLOAT32X4 ScalarVectorB = MlasBroadcastFloat32x4(ScalarValueB);
+
+    while (N >= 8) {
+
+        MLAS_FLOAT32X4 a0 = ScalarA ? ScalarVectorA : MlasLoadFloat32x4(InputA);
+        MLAS_FLOAT32X4 a1 = ScalarA ? ScalarVectorA : MlasLoadFloat32x4(InputA + 4);
+        MLAS_FLOAT32X4 b0 = ScalarB ? ScalarVectorB : MlasLoadFloat32x4(InputB);
+        MLAS_FLOAT32X4 b1 = ScalarB ? ScalarVectorB : MlasLoadFloat32x4(InputB + 4);
+
+        MlasStoreFloat32x4(Output, OperationType::Vector(a0, b0));
+        MlasStoreFloat32x4(Output + 4, OperationType::Vector(a1, b1));
+
+        if (!ScalarA) {
+            InputA += 8;
+        }
+
+        if (!ScalarB) {
+            InputB += 8;
+        }
+
+        Output += 8;
+        N -= 8;
+    }
+
+    if (N >= 4) {
+
+        MLAS_FLOAT32X4 a = ScalarA ? ScalarVectorA : MlasLoadFloat32x4(InputA);
+        MLAS_FLOAT32X4 b = ScalarB ? ScalarVectorB : MlasLoadFloat32x4(InputB);
+
+        MlasStoreFloat32x4(Output, OperationType::Vector(a, b));
+
+        if (!ScalarA) {
+            InputA += 4;
+        }
+
+        if (!ScalarB) {
+            InputB += 4;
+        }
+
+        Output += 4;
+        N -= 4;
+    }
+
+    while (N > 0) {
+
+        float a = ScalarA ? ScalarValueA : *InputA++;
+        float b = ScalarB ? ScalarValueB : *InputB++;
+
+        *Output++ = OperationType::Scalar(a, b);
+        N -= 1;
+    }
+}
+
+//
+// Stores the span kernels indexed by the operation kind and by the pattern of
+// the innermost collapsed dimension.
+//
+
+#define MLAS_BROADCAST_KERNELS(OperationType) \
+    { \
+        MlasBroadcastKernel<OperationType, false, false>, \
+        MlasBroadcastKernel<OperationType, true, false>, \
+        MlasBroadcastKernel<OperationType, false, true>, \
+    }
+
+static const PMLAS_BROADCAST_KERNEL_ROUTINE MlasBroadcastKernels[][3] =
+{
+    MLAS_BROADCAST_KERNELS(MLAS_BINARY_ADD),
+    MLAS_BROADCAST_KERNELS(MLAS_BINARY_SUBTRACT),
+    MLAS_BROADCAST_KERNELS(MLAS_BINARY_MULTIPLY),
+    MLAS_BROADCAST_KERNELS(MLAS_BINARY_DIVIDE),
+    MLAS_BROADCAST_KERNELS(MLAS_BINARY_MAXIMUM),
+    MLAS_BROADCAST_KERNELS(MLAS_BINARY_MINIMUM),
+};
+
+void
+MlasBroadcastThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    broadcast operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_BROADCAST_WORK_BLOCK* WorkBlock = (const MLAS_BROADCAST_WORK_BLOCK*)Context;
+
+    //
+    // Compute the range of output elements to use for this thread.
+    //
+
+    const size_t OutputSize = WorkBlock->OutputSize;
+    const size_t TargetThreadCount = size_t(WorkBlock->TargetThreadCount);
+
+    const size_t ElementsPerThread = OutputSize / TargetThreadCount;
+    const size_t ElementsExtra = OutputSize % TargetThreadCount;
+
+    size_t ElementStart;
+    size_t ElementCount;
+
+    if (uint32_t(Index) < ElementsExtra) {
+        ElementStart = (ElementsPerThread + 1) * Index;
+        ElementCount = ElementsPerThread + 1;
+    } else {
+        ElementStart = ElementsPerThread * Index + ElementsExtra;
+        ElementCount = ElementsPerThread;
+    }
+
+    //
+    // Decompose the starting element into the offset within its span and the
+    // indices of the outer dimensions.
+    //
+
+    const size_t SpanLength = WorkBlock->SpanLength;
+    const size_t OuterDimensions = WorkBlock->OuterDimensions;
+
+    size_t SpanOffset = ElementStart % SpanLength;
+    size_t SpanIndex = ElementStart / SpanLength;
+
+    size_t OuterIndex[MLAS_MAXIMUM_BROADCAST_DIMENSIONS];
+    size_t OffsetA = 0;
+    size_t OffsetB = 0;
+
+    for (size_t d = 0; d < OuterDimensions; d++) {
+        OuterIndex[d] = SpanIndex % WorkBlock->OuterShape[d];
+        SpanIndex /= WorkBlock->OuterShape[d];
+        OffsetA += OuterIndex[d] * WorkBlock->OuterStrideA[d];
+        OffsetB += OuterIndex[d] * WorkBlock->OuterStrideB[d];
+    }
+
+    const PMLAS_BROADCAST_KERNEL_ROUTINE KernelRoutine = WorkBlock->KernelRoutine;
+    const float* InputA = WorkBlock->InputA;
+    const float* InputB = WorkBlock->InputB;
+    float* Output = WorkBlock->Output + ElementStart;
+
+    while (ElementCount > 0) {
+
+        size_t N = (std::min)(SpanLength - SpanOffset, ElementCount);
+
+        KernelRoutine(InputA + OffsetA + (WorkBlock->ScalarA ? 0 : SpanOffset),
+            InputB + OffsetB + (WorkBlock->ScalarB ? 0 : SpanOffset), Output, N);
+
+        Output += N;
+        ElementCount -= N;
+        SpanOffset = 0;
+
+        //
+        // Advance the outer dimension indices to the next span.
+        //
+
+        for (size_t d = 0; d < OuterDimensions; d++) {
+
+            OffsetA += WorkBlock->OuterStrideA[d];
+            OffsetB += WorkBlock->OuterStrideB[d];
+
+            if (++OuterIndex[d] < WorkBlock->OuterShape[d]) {
+                break;
+            }
+
+            OffsetA -= WorkBlock->OuterStrideA[d] * WorkBlock->OuterShape[d];
+            OffsetB -= WorkBlock->OuterStrideB[d] * WorkBlock->OuterShape[d];
+            OuterIndex[d] = 0;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasBroadcastBinaryOperation(
+    MLAS_BINARY_OPERATION_KIND OperationKind,
+    size_t Dimensions,
+    const int64_t* InputShapeA,
+    const int64_t* InputShapeB,
+    const int64_t* OutputShape,
+    const float* InputA,
+    const float* InputB,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine applies a binary operation to two tensors with multidirectional
+    broadcasting.
+
+Arguments:
+
+    OperationKind - Supplies the kind of binary operation to perform.
+
+    Dimensions - Supplies the number of dimensions of the shapes. The input
+        shapes must be padded with leading ones to this number of dimensions.
+
+    InputShapeA - Supplies the shape of the first input tensor. Each dimension
+        must be one or equal to the output dimension.
+
+    InputShapeB - Supplies the shape of the second input tensor. Each dimension
+        must be one or equal to the output dimension.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    InputA - Supplies the first input tensor.
+
+    InputB - Supplies the second input tensor.
+
+    Output - Supplies the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_BROADCAST_WORK_BLOCK WorkBlock;
+
+    //
+    // Collapse the dimensions from the innermost dimension outwards, merging
+    // adjacent dimensions with the same broadcasting pattern. Dimensions with
+    // an output size of one do not affect the iteration and are skipped.
+    //
+
+    size_t CollapsedShape[MLAS_MAXIMUM_BROADCAST_DIMENSIONS];
+    unsigned CollapsedPattern[MLAS_MAXIMUM_BROADCAST_DIMENSIONS];
+    size_t CollapsedDimensions = 0;
+    size_t OutputSize = 1;
+
+    for (size_t d = Dimensions; d > 0; d--) {
+
+        const size_t OutputDimension = size_t(OutputShape[d - 1]);
+
+        OutputSize *= OutputDimension;
+
+        if (OutputDimension == 1) {
+            continue;
+        }
+
+        unsigned Pattern = 0;
+
+        if (InputShapeA[d - 1] == 1) {
+            Pattern |= MLAS_BROADCAST_PATTERN_BROADCAST_A;
+        }
+
+        if (InputShapeB[d - 1] == 1) {
+            Pattern |= MLAS_BROADCAST_PATTERN_BROADCAST_B;
+        }
+
+        if (CollapsedDimensions > 0 && CollapsedPattern[CollapsedDimensions - 1] == Pattern) {
+            CollapsedShape[CollapsedDimensions - 1] *= OutputDimension;
+        } else {
+            CollapsedShape[CollapsedDimensions] = OutputDimension;
+            CollapsedPattern[CollapsedDimensions] = Pattern;
+            CollapsedDimensions++;
+        }
+    }
+
+    if (OutputSize == 0) {
+        return;
+    }
+
+    if (CollapsedDimensions == 0) {
+        CollapsedShape[0] = 1;
+        CollapsedPattern[0] = 0;
+        CollapsedDimensions = 1;
+    }
+
+    //
+    // The innermost collapsed dimension is the span processed by the kernel.
+    // Compute the strides of the outer collapsed dimensions, which are zero
+    // for an input that is broadcast along the dimension.
+    //
+
+    size_t StrideA = 1;
+    size_t StrideB = 1;
+
+    for (size_t d = 0; d < CollapsedDimensions; d++) {
+
+        const bool BroadcastA = (CollapsedPattern[d] & MLAS_BROADCAST_PATTERN_BROADCAST_A) != 0;
+        const bool BroadcastB = (CollapsedPattern[d] & MLAS_BROADCAST_PATTERN_BROADCAST_B) != 0;
+
+        if (d > 0) {
+            WorkBlock.OuterShape[d - 1] = CollapsedShape[d];
+            WorkBlock.OuterStrideA[d - 1] = BroadcastA ? 0 : StrideA;
+            WorkBlock.OuterStrideB[d - 1] = BroadcastB ? 0 : StrideB;
+        }
+
+        if (!BroadcastA) {
+            StrideA *= CollapsedShape[d];
+        }
+
+        if (!BroadcastB) {
+            StrideB *= CollapsedShape[d];
+        }
+    }
+
+    WorkBlock.ScalarA = (CollapsedPattern[0] & MLAS_BROADCAST_PATTERN_BROADCAST_A) != 0;
+    WorkBlock.ScalarB = (CollapsedPattern[0] & MLAS_BROADCAST_PATTERN_BROADCAST_B) != 0;
+    WorkBlock.KernelRoutine = MlasBroadcastKernels[OperationKind][CollapsedPattern[0]];
+    WorkBlock.InputA = InputA;
+    WorkBlock.InputB = InputB;
+    WorkBlock.Output = Output;
+    WorkBlock.SpanLength = CollapsedShape[0];
+    WorkBlock.OuterDimensions = CollapsedDimensions - 1;
+    WorkBlock.OutputSize = OutputSize;
+
+    //
+    // Partition the output elements across the worker threads.
+    //
+
+    int32_t TargetThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    size_t MaximumThreadCount = (OutputSize + MLAS_BROADCAST_MINIMUM_ELEMENTS_PER_THREAD - 1) /
+        MLAS_BROADCAST_MINIMUM_ELEMENTS_PER_THREAD;
+
+    if (size_t(TargetThreadCount) >= MaximumThreadCount) {
+        TargetThreadCount = int32_t(MaximumThreadCount);
+    }
+
+    WorkBlock.TargetThreadCount = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasBroadcastThreaded, &WorkBlock, TargetThreadCount);
+}
@@ -505,7 +505,8 @@ Arguments:
 
     Input - Supplies the input tensor.
 
-    Filter - Supplies the filter tensor.
+    Filter - Supplies the filter tensor. If the Winograd algorithm is selected,
+        the filter tensor must be transformed by MlasConvWinogradTransformFilter.
 
     Bias - Optionally supplies the bias vector.
 
@@ -894,6 +895,16 @@ Return Value:
 
     const MLAS_CONV_ALGORITHM Algorithm = Parameters->Algorithm;
 
+    //
+    // The Winograd algorithm schedules blocks of tiles from all batches and
+    // groups across multiple threads.
+    //
+
+    if (Algorithm == MlasConvAlgorithmWinograd) {
+        MlasConvWinograd(Parameters, Input, Filter, Bias, WorkingBuffer, Output);
+        return;
+    }
+
 #if defined(MLAS_HAS_THREADING_SUPPORT)
 
     //
@@ -1005,6 +1016,16 @@ Return Value:
 
                     break;
                 }
+
+                case MlasConvAlgorithmWinograd:
+                {
+                    //
+                    // The Winograd algorithm processes all batches and groups
+                    // above.
+                    //
+
+                    break;
+                }
             }
 
             //
@@ -1179,6 +1200,16 @@ Return Value:
         }
     }
 
+    //
+    // Detect a 3x3 convolution with unit strides that is large enough to use
+    // the Winograd algorithm.
+    //
+
+    if (AllStridesAreOne && AllDilationsAreOne &&
+        MlasConvWinogradPrepare(Parameters, WorkingBufferSize)) {
+        return;
+    }
+
     if (FilterCount > OutputSize) {
 
         //
@@ -0,0 +1,147 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    erf.cpp
+
+Abstract:
+
+    This module implements routines to compute the error function.
+
+    This implementation uses the same polynomial coefficients and algorithm as
+    found in Eigen: a rational interpolant that is accurate to a couple of ulp
+    in the range [-4, 4], outside of which the result rounds to +/-1.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Bundles the floating point constants of the rational interpolant.
+//
+
+const struct {
+    float LowerRange;
+    float UpperRange;
+    float alpha_13;
+    float alpha_11;
+    float alpha_9;
+    float alpha_7;
+    float alpha_5;
+    float alpha_3;
+    float alpha_1;
+    float beta_8;
+    float beta_6;
+    float beta_4;
+    float beta_2;
+    float beta_0;
+} MlasErfConstants = {
+    -4.0f,
+    4.0f,
+    -2.72614225801306e-10f,
+    2.77068142495902e-08f,
+    -2.10102402082508e-06f,
+    -5.69250639462346e-05f,
+    -7.34990630326855e-04f,
+    -2.95459980854025e-03f,
+    -1.60960333262415e-02f,
+    -1.45660718464996e-05f,
+    -2.13374055278905e-04f,
+    -1.68282697438203e-03f,
+    -7.37332916720468e-03f,
+    -1.42647390514189e-02f,
+};
+
+void
+MLASCALL
+MlasComputeErf(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the error function.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer. The output buffer may be the same as
+        the input buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (N >= 4) {
+
+        MLAS_FLOAT32X4 Value = MlasLoadFloat32x4(Input);
+
+        Value = MlasMaximumFloat32x4(MlasBroadcastFloat32x4(MlasErfConstants.LowerRange), Value);
+        Value = MlasMinimumFloat32x4(MlasBroadcastFloat32x4(MlasErfConstants.UpperRange), Value);
+
+        MLAS_FLOAT32X4 ValueSquared = MlasMultiplyFloat32x4(Value, Value);
+
+        MLAS_FLOAT32X4 p;
+        p = MlasMultiplyAddFloat32x4(ValueSquared, MlasBroadcastFloat32x4(MlasErfConstants.alpha_13),
+            MlasBroadcastFloat32x4(MlasErfConstants.alpha_11));
+        p = MlasMultiplyAddFloat32x4(p, ValueSquared, MlasBroadcastFloat32x4(MlasErfConstants.alpha_9));
+        p = MlasMultiplyAddFloat32x4(p, ValueSquared, MlasBroadcastFloat32x4(MlasErfConstants.alpha_7));
+        p = MlasMultiplyAddFloat32x4(p, ValueSquared, MlasBroadcastFloat32x4(MlasErfConstants.alpha_5));
+        p = MlasMultiplyAddFloat32x4(p, ValueSquared, MlasBroadcastFloat32x4(MlasErfConstants.alpha_3));
+        p = MlasMultiplyAddFloat32x4(p, ValueSquared, MlasBroadcastFloat32x4(MlasErfConstants.alpha_1));
+        p = MlasMultiplyFloat32x4(p, Value);
+
+        MLAS_FLOAT32X4 q;
+        q = MlasMultiplyAddFloat32x4(ValueSquared, MlasBroadcastFloat32x4(MlasErfConstants.beta_8),
+            MlasBroadcastFloat32x4(MlasErfConstants.beta_6));
+        q = MlasMultiplyAddFloat32x4(q, ValueSquared, MlasBroadcastFloat32x4(MlasErfConstants.beta_4));
+        q = MlasMultiplyAddFloat32x4(q, ValueSquared, MlasBroadcastFloat32x4(MlasErfConstants.beta_2));
+        q = MlasMultiplyAddFloat32x4(q, ValueSquared, MlasBroadcastFloat32x4(MlasErfConstants.beta_0));
+
+        MlasStoreFloat32x4(Output, MlasDivideFloat32x4(p, q));
+
+        Input += 4;
+        Output += 4;
+        N -= 4;
+    }
+
+    while (N > 0) {
+
+        float Value = *Input++;
+
+        Value = (std::min)(MlasErfConstants.UpperRange, (std::max)(MlasErfConstants.LowerRange, Value));
+
+        float ValueSquared = Value * Value;
+
+        float p;
+        p = ValueSquared * MlasErfConstants.alpha_13 + MlasErfConstants.alpha_11;
+        p = p * ValueSquared + MlasErfConstants.alpha_9;
+        p = p * ValueSquared + MlasErfConstants.alpha_7;
+        p = p * ValueSquared + MlasErfConstants.alpha_5;
+        p = p * ValueSquared + MlasErfConstants.alpha_3;
+        p = p * ValueSquared + MlasErfConstants.alpha_1;
+        p = p * Value;
+
+        float q;
+        q = ValueSquared * MlasErfConstants.beta_8 + MlasErfConstants.beta_6;
+        q = q * ValueSquared + MlasErfConstants.beta_4;
+        q = q * ValueSquared + MlasErfConstants.beta_2;
+        q = q * ValueSquared + MlasErfConstants.beta_0;
+
+        *Output++ = p / q;
+
+        N -= 1;
+    }
+}
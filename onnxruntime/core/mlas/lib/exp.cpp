@@ -0,0 +1,319 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    exp.cpp
+
+Abstract:
+
+    This module implements routines to compute the exponential function.
+
+    This implementation uses the same range reduction and polynomial
+    coefficients as found in Cephes and Eigen. The input is split as
+    x = m * ln(2) + r with |r| <= ln(2)/2, exp(r) is approximated with a
+    polynomial, and the result is scaled by 2^m by building the exponent bits
+    of the floating point value directly.
+
+    Our usage requires building platform specific versions of the algorithm to
+    target different instruction sets. The implementation below targets the
+    base instruction set (typically SSE2) while assembly implementations target
+    newer instruction sets (such as FMA3).
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Bundles the floating point constants for use by kernels written in assembly.
+//
+
+extern "C" const struct {
+    float LowerRange;
+    float UpperRange;
+    float LOG2e;
+    float ln2_high;
+    float ln2_low;
+    float p0;
+    float p1;
+    float p2;
+    float p3;
+    float p4;
+    float p5;
+    float One;
+    float RoundingBias;
+    int32_t ExponentBias;
+} MlasExpConstants = {
+    -88.3762626647949f,
+    88.3762626647949f,
+    1.44269504088896341f,
+    -6.93359375e-1f,
+    2.12194440e-4f,
+    1.9875691500e-4f,
+    1.3981999507e-3f,
+    8.3334519073e-3f,
+    4.1665795894e-2f,
+    1.6666665459e-1f,
+    5.0000001201e-1f,
+    1.0f,
+    12582912.0f,
+    0x3F800000,
+};
+
+inline
+MLAS_FLOAT32X4
+MlasComputeExpVector(
+    MLAS_FLOAT32X4 Value
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential function for a vector of elements.
+
+Arguments:
+
+    Value - Supplies the input vector.
+
+Return Value:
+
+    Returns the exponential of each element of the input vector.
+
+--*/
+{
+    Value = MlasMaximumFloat32x4(MlasBroadcastFloat32x4(MlasExpConstants.LowerRange), Value);
+    Value = MlasMinimumFloat32x4(MlasBroadcastFloat32x4(MlasExpConstants.UpperRange), Value);
+
+    //
+    // Round x * log2(e) to the nearest integer m by adding a bias that pushes
+    // the fractional bits out of the mantissa. The low bits of the biased value
+    // then hold m as an integer.
+    //
+
+    MLAS_FLOAT32X4 BiasedM = MlasMultiplyAddFloat32x4(Value, MlasBroadcastFloat32x4(MlasExpConstants.LOG2e),
+        MlasBroadcastFloat32x4(MlasExpConstants.RoundingBias));
+    MLAS_FLOAT32X4 m = MlasSubtractFloat32x4(BiasedM, MlasBroadcastFloat32x4(MlasExpConstants.RoundingBias));
+
+    MLAS_FLOAT32X4 r = MlasMultiplyAddFloat32x4(m, MlasBroadcastFloat32x4(MlasExpConstants.ln2_high), Value);
+    r = MlasMultiplyAddFloat32x4(m, MlasBroadcastFloat32x4(MlasExpConstants.ln2_low), r);
+
+    MLAS_FLOAT32X4 p;
+    p = MlasMultiplyAddFloat32x4(r, MlasBroadcastFloat32x4(MlasExpConstants.p0),
+        MlasBroadcastFloat32x4(MlasExpConstants.p1));
+    p = MlasMultiplyAddFloat32x4(p, r, MlasBroadcastFloat32x4(MlasExpConstants.p2));
+    p = MlasMultiplyAddFloat32x4(p, r, MlasBroadcastFloat32x4(MlasExpConstants.p3));
+    p = MlasMultiplyAddFloat32x4(p, r, MlasBroadcastFloat32x4(MlasExpConstants.p4));
+    p = MlasMultiplyAddFloat32x4(p, r, MlasBroadcastFloat32x4(MlasExpConstants.p5));
+    p = MlasMultiplyAddFloat32x4(p, MlasMultiplyFloat32x4(r, r),
+        MlasAddFloat32x4(r, MlasBroadcastFloat32x4(MlasExpConstants.One)));
+
+    //
+    // Build 2^m from the integer bits of the biased value.
+    //
+
+    MLAS_INT32X4 Exponent = MlasShiftLeftInt32x4<23>(MlasReinterpretAsInt32x4(BiasedM));
+    Exponent = MlasAddInt32x4(Exponent, MlasBroadcastInt32x4(MlasExpConstants.ExponentBias));
+
+    return MlasMultiplyFloat32x4(p, MlasReinterpretAsFloat32x4(Exponent));
+}
+
+inline
+float
+MlasComputeExpScalar(
+    float Value
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential function for a single element using
+    the same algorithm as the vector implementation.
+
+Arguments:
+
+    Value - Supplies the input value.
+
+Return Value:
+
+    Returns the exponential of the input value.
+
+--*/
+{
+    return MlasExtractLaneFloat32x4<0>(MlasComputeExpVector(MlasBroadcastFloat32x4(Value)));
+}
+
+void
+MLASCALL
+MlasExpKernel(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the generic kernel for the exponential function.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (N >= 4) {
+
+        MlasStoreFloat32x4(Output, MlasComputeExpVector(MlasLoadFloat32x4(Input)));
+
+        Input += 4;
+        Output += 4;
+        N -= 4;
+    }
+
+    while (N > 0) {
+
+        *Output++ = MlasComputeExpScalar(*Input++);
+
+        N -= 1;
+    }
+}
+
+float
+MLASCALL
+MlasComputeSumExpKernel(
+    const float* Input,
+    float* Output,
+    size_t N,
+    const float* NegativeMaximum
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the generic kernel that computes the exponential
+    of each element offset by the negative maximum and accumulates the sum of
+    the results.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer to receive the exponentials, or nullptr
+        if only the sum is needed.
+
+    N - Supplies the number of elements to process.
+
+    NegativeMaximum - Supplies the value added to each element before the
+        exponential is computed.
+
+Return Value:
+
+    Returns the sum of the exponentials.
+
+--*/
+{
+    MLAS_FLOAT32X4 NegativeMaximumVector = MlasBroadcastFloat32x4(NegativeMaximum);
+
+    MLAS_FLOAT32X4 Accumulator0 = MlasZeroFloat32x4();
+    MLAS_FLOAT32X4 Accumulator1 = MlasZeroFloat32x4();
+
+    while (N >= 8) {
+
+        MLAS_FLOAT32X4 Vector0 = MlasAddFloat32x4(MlasLoadFloat32x4(Input), NegativeMaximumVector);
+        MLAS_FLOAT32X4 Vector1 = MlasAddFloat32x4(MlasLoadFloat32x4(Input + 4), NegativeMaximumVector);
+
+        Vector0 = MlasComputeExpVector(Vector0);
+        Vector1 = MlasComputeExpVector(Vector1);
+
+        Accumulator0 = MlasAddFloat32x4(Accumulator0, Vector0);
+        Accumulator1 = MlasAddFloat32x4(Accumulator1, Vector1);
+
+        if (Output != nullptr) {
+            MlasStoreFloat32x4(Output, Vector0);
+            MlasStoreFloat32x4(Output + 4, Vector1);
+            Output += 8;
+        }
+
+        Input += 8;
+        N -= 8;
+    }
+
+    if (N >= 4) {
+
+        MLAS_FLOAT32X4 Vector0 = MlasAddFloat32x4(MlasLoadFloat32x4(Input), NegativeMaximumVector);
+
+        Vector0 = MlasComputeExpVector(Vector0);
+
+        Accumulator0 = MlasAddFloat32x4(Accumulator0, Vector0);
+
+        if (Output != nullptr) {
+            MlasStoreFloat32x4(Output, Vector0);
+            Output += 4;
+        }
+
+        Input += 4;
+        N -= 4;
+    }
+
+    float Accumulator = MlasReduceAddFloat32x4(MlasAddFloat32x4(Accumulator0, Accumulator1));
+
+    while (N > 0) {
+
+        float Value = MlasComputeExpScalar(*Input++ + *NegativeMaximum);
+
+        Accumulator += Value;
+
+        if (Output != nullptr) {
+            *Output++ = Value;
+        }
+
+        N -= 1;
+    }
+
+    return Accumulator;
+}
+
+void
+MLASCALL
+MlasComputeExp(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential function.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+#if defined(MLAS_TARGET_AMD64)
+    MlasPlatform.ExpKernelRoutine(Input, Output, N);
+#else
+    MlasExpKernel(Input, Output, N);
+#endif
+}
@@ -21,6 +21,7 @@ Abstract:
 #include <mlas.h>
 #include <memory.h>
 #include <algorithm>
+#include <cmath>
 #include <limits>
 
 #if defined(_WIN32)
@@ -112,6 +113,21 @@ Abstract:
 
 #define MLAS_SGEMM_STRIDEN_THREAD_ALIGN             16
 
+//
+// Define the default strides to step through slices of the input matrices for
+// the quantized integer matrix/matrix multiply operation (QGEMM).
+//
+// N.B. The QGEMM kernels operate on columns of matrix B in blocks of 16, so
+// the N stride must be a multiple of 16. The K stride must be a multiple of 4
+// as the kernels operate on pairs or quads of values along the K dimension.
+//
+
+#define MLAS_QGEMM_STRIDEM                          16
+#define MLAS_QGEMM_STRIDEN                          128
+#define MLAS_QGEMM_STRIDEK                          256
+
+#define MLAS_QGEMM_STRIDEN_THREAD_ALIGN             16
+
 //
 // Define the prototypes of the platform optimized routines.
 //
@@ -156,6 +172,38 @@ void
 
 typedef MLAS_SGEMM_TRANSPOSE_PACKB_BLOCK_ROUTINE* PMLAS_SGEMM_TRANSPOSE_PACKB_BLOCK_ROUTINE;
 
+typedef
+size_t
+(MLASCALL MLAS_QGEMM_KERNEL_ROUTINE)(
+    const int16_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldb,
+    size_t ldc
+    );
+
+typedef MLAS_QGEMM_KERNEL_ROUTINE* PMLAS_QGEMM_KERNEL_ROUTINE;
+
+typedef
+size_t
+(MLASCALL MLAS_QGEMM_U8S8_KERNEL_ROUTINE)(
+    const uint8_t* A,
+    const uint8_t* B,
+    int32_t* C,
+    size_t QuadCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldb,
+    size_t ldc
+    );
+
+typedef MLAS_QGEMM_U8S8_KERNEL_ROUTINE* PMLAS_QGEMM_U8S8_KERNEL_ROUTINE;
+
 typedef
 void
 (MLASCALL MLAS_LOGISTIC_KERNEL_ROUTINE)(
@@ -176,6 +224,61 @@ void
 
 typedef MLAS_TANH_KERNEL_ROUTINE* PMLAS_TANH_KERNEL_ROUTINE;
 
+typedef
+void
+(MLASCALL MLAS_EXP_KERNEL_ROUTINE)(
+    const float* Input,
+    float* Output,
+    size_t N
+    );
+
+typedef MLAS_EXP_KERNEL_ROUTINE* PMLAS_EXP_KERNEL_ROUTINE;
+
+typedef
+float
+(MLASCALL MLAS_SUM_EXP_KERNEL_ROUTINE)(
+    const float* Input,
+    float* Output,
+    size_t N,
+    const float* NegativeMaximum
+    );
+
+typedef MLAS_SUM_EXP_KERNEL_ROUTINE* PMLAS_SUM_EXP_KERNEL_ROUTINE;
+
+//
+// Define the flags that control the post processing done by the NCHWc
+// convolution kernels after the filter has been applied.
+//
+
+#define MLAS_CONV_KERNEL_FLAG_ACCUMULATE_OUTPUT     0x00000001
+#define MLAS_CONV_KERNEL_FLAG_BIAS_ADDITION         0x00000002
+#define MLAS_CONV_KERNEL_FLAG_RELU_ACTIVATION       0x00000004
+
+typedef
+void
+(MLASCALL MLAS_CONV_FLOAT_KERNEL)(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t DilatedInputWidth,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeft,
+    size_t OutputCountLeftPad,
+    size_t OutputCount,
+    size_t OutputCountRightPad,
+    const float* Bias,
+    unsigned KernelFlags
+    );
+
+typedef MLAS_CONV_FLOAT_KERNEL* PMLAS_CONV_FLOAT_KERNEL;
+
 extern "C" {
 
     MLAS_SGEMM_KERNEL_ROUTINE MlasSgemmKernelZero;
@@ -203,11 +306,33 @@ extern "C" {
     MLAS_SGEMM_TRANSPOSE_PACKB_BLOCK_ROUTINE MlasSgemmTransposePackB16x4Avx;
 #endif
 
+    MLAS_QGEMM_KERNEL_ROUTINE MlasQgemmKernelZero;
+    MLAS_QGEMM_KERNEL_ROUTINE MlasQgemmKernelAdd;
+#if defined(MLAS_TARGET_AMD64) && !defined(_WIN32)
+    MLAS_QGEMM_KERNEL_ROUTINE MlasQgemmKernelZeroAvx2;
+    MLAS_QGEMM_KERNEL_ROUTINE MlasQgemmKernelAddAvx2;
+    MLAS_QGEMM_U8S8_KERNEL_ROUTINE MlasQgemmU8S8KernelZeroAvx512Vnni;
+    MLAS_QGEMM_U8S8_KERNEL_ROUTINE MlasQgemmU8S8KernelAddAvx512Vnni;
+#endif
+
     MLAS_TANH_KERNEL_ROUTINE MlasLogisticKernel;
     MLAS_TANH_KERNEL_ROUTINE MlasTanhKernel;
+    MLAS_EXP_KERNEL_ROUTINE MlasExpKernel;
+    MLAS_SUM_EXP_KERNEL_ROUTINE MlasComputeSumExpKernel;
 #if defined(MLAS_TARGET_AMD64)
     MLAS_TANH_KERNEL_ROUTINE MlasLogisticKernelFma3;
     MLAS_TANH_KERNEL_ROUTINE MlasTanhKernelFma3;
+    MLAS_EXP_KERNEL_ROUTINE MlasExpKernelFma3;
+    MLAS_SUM_EXP_KERNEL_ROUTINE MlasComputeSumExpKernelFma3;
+#endif
+
+#if defined(MLAS_TARGET_AMD64)
+    MLAS_CONV_FLOAT_KERNEL MlasConvNchwcFloatKernelAvx2;
+    MLAS_CONV_FLOAT_KERNEL MlasConvNchwFloatKernelAvx2;
+    MLAS_CONV_FLOAT_KERNEL MlasConvDepthwiseFloatKernelAvx2;
+    MLAS_CONV_FLOAT_KERNEL MlasConvNchwcFloatKernelAvx512F;
+    MLAS_CONV_FLOAT_KERNEL MlasConvNchwFloatKernelAvx512F;
+    MLAS_CONV_FLOAT_KERNEL MlasConvDepthwiseFloatKernelAvx512F;
 #endif
 
 }
@@ -252,6 +377,26 @@ MlasSgemmOperation(
     size_t ldc
     );
 
+//
+// Winograd convolution routines.
+//
+
+bool
+MlasConvWinogradPrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t* WorkingBufferSize
+    );
+
+void
+MlasConvWinograd(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output
+    );
+
 //
 // Environment information class.
 //
@@ -265,14 +410,26 @@ struct MLAS_PLATFORM {
     PMLAS_SGEMM_KERNEL_ROUTINE KernelAddRoutine;
 #endif
 
+    PMLAS_QGEMM_KERNEL_ROUTINE QgemmKernelZeroRoutine;
+    PMLAS_QGEMM_KERNEL_ROUTINE QgemmKernelAddRoutine;
+    PMLAS_QGEMM_U8S8_KERNEL_ROUTINE QgemmU8S8KernelZeroRoutine;
+    PMLAS_QGEMM_U8S8_KERNEL_ROUTINE QgemmU8S8KernelAddRoutine;
+
 #if defined(MLAS_TARGET_AMD64)
     PMLAS_SGEMM_KERNEL_M1_ROUTINE KernelM1Routine;
     PMLAS_SGEMM_KERNEL_M1_ROUTINE KernelM1TransposeBRoutine;
     PMLAS_SGEMM_TRANSPOSE_PACKB_BLOCK_ROUTINE TransposePackB16x4Routine;
     PMLAS_LOGISTIC_KERNEL_ROUTINE LogisticKernelRoutine;
     PMLAS_TANH_KERNEL_ROUTINE TanhKernelRoutine;
+    PMLAS_EXP_KERNEL_ROUTINE ExpKernelRoutine;
+    PMLAS_SUM_EXP_KERNEL_ROUTINE ComputeSumExpKernelRoutine;
 #endif
 
+    PMLAS_CONV_FLOAT_KERNEL ConvNchwcFloatKernel;
+    PMLAS_CONV_FLOAT_KERNEL ConvNchwFloatKernel;
+    PMLAS_CONV_FLOAT_KERNEL ConvDepthwiseFloatKernel;
+    size_t NchwcBlockSize;
+
 #if defined(MLAS_USE_WIN32_THREADPOOL)
     int32_t MaximumThreadCount;
 #endif
@@ -354,10 +511,68 @@ MlasExecuteThreaded(
 
 #if defined(MLAS_NEON_INTRINSICS)
 typedef float32x4_t MLAS_FLOAT32X4;
+typedef int32x4_t MLAS_INT32X4;
 #elif defined(MLAS_SSE2_INTRINSICS)
 typedef __m128 MLAS_FLOAT32X4;
+typedef __m128i MLAS_INT32X4;
 #endif
 
+inline
+MLAS_INT32X4
+MlasReinterpretAsInt32x4(MLAS_FLOAT32X4 Vector)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vreinterpretq_s32_f32(Vector);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_castps_si128(Vector);
+#endif
+}
+
+inline
+MLAS_FLOAT32X4
+MlasReinterpretAsFloat32x4(MLAS_INT32X4 Vector)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vreinterpretq_f32_s32(Vector);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_castsi128_ps(Vector);
+#endif
+}
+
+inline
+MLAS_INT32X4
+MlasBroadcastInt32x4(int32_t Value)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vdupq_n_s32(Value);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_set1_epi32(Value);
+#endif
+}
+
+inline
+MLAS_INT32X4
+MlasAddInt32x4(MLAS_INT32X4 Vector1, MLAS_INT32X4 Vector2)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vaddq_s32(Vector1, Vector2);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_add_epi32(Vector1, Vector2);
+#endif
+}
+
+template<unsigned ShiftCount>
+inline
+MLAS_INT32X4
+MlasShiftLeftInt32x4(MLAS_INT32X4 Vector)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vshlq_n_s32(Vector, ShiftCount);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_slli_epi32(Vector, ShiftCount);
+#endif
+}
+
 inline
 MLAS_FLOAT32X4
 MlasZeroFloat32x4(void)
@@ -544,6 +759,23 @@ MlasDivideFloat32x4(MLAS_FLOAT32X4 Vector1, MLAS_FLOAT32X4 Vector2)
 #endif
 }
 
+inline
+MLAS_FLOAT32X4
+MlasSqrtFloat32x4(MLAS_FLOAT32X4 Vector)
+{
+#if defined(MLAS_NEON64_INTRINSICS)
+    return vsqrtq_f32(Vector);
+#elif defined(MLAS_NEON32_INTRINSICS)
+    Vector = vsetq_lane_f32(std::sqrt(vgetq_lane_f32(Vector, 0)), Vector, 0);
+    Vector = vsetq_lane_f32(std::sqrt(vgetq_lane_f32(Vector, 1)), Vector, 1);
+    Vector = vsetq_lane_f32(std::sqrt(vgetq_lane_f32(Vector, 2)), Vector, 2);
+    Vector = vsetq_lane_f32(std::sqrt(vgetq_lane_f32(Vector, 3)), Vector, 3);
+    return Vector;
+#elif defined(MLAS_SSE2_INTRINSICS)
+    return _mm_sqrt_ps(Vector);
+#endif
+}
+
 inline
 MLAS_FLOAT32X4
 MlasMaximumFloat32x4(MLAS_FLOAT32X4 Vector1, MLAS_FLOAT32X4 Vector2)
@@ -566,6 +798,42 @@ MlasMinimumFloat32x4(MLAS_FLOAT32X4 Vector1, MLAS_FLOAT32X4 Vector2)
 #endif
 }
 
+inline
+float
+MlasReduceAddFloat32x4(MLAS_FLOAT32X4 Vector)
+{
+#if defined(MLAS_NEON64_INTRINSICS)
+    Vector = vpaddq_f32(Vector, Vector);
+    Vector = vpaddq_f32(Vector, Vector);
+    return vgetq_lane_f32(Vector, 0);
+#elif defined(MLAS_NEON32_INTRINSICS)
+    float32x2_t VectorLow = vpadd_f32(vget_low_f32(Vector), vget_high_f32(Vector));
+    VectorLow = vpadd_f32(VectorLow, VectorLow);
+    return vget_lane_f32(VectorLow, 0);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    Vector = _mm_add_ps(Vector, _mm_movehl_ps(Vector, Vector));
+    Vector = _mm_add_ss(Vector, _mm_shuffle_ps(Vector, Vector, 1));
+    return _mm_cvtss_f32(Vector);
+#endif
+}
+
+inline
+float
+MlasReduceMaximumFloat32x4(MLAS_FLOAT32X4 Vector)
+{
+#if defined(MLAS_NEON64_INTRINSICS)
+    return vmaxvq_f32(Vector);
+#elif defined(MLAS_NEON32_INTRINSICS)
+    float32x2_t VectorLow = vpmax_f32(vget_low_f32(Vector), vget_high_f32(Vector));
+    VectorLow = vpmax_f32(VectorLow, VectorLow);
+    return vget_lane_f32(VectorLow, 0);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    Vector = _mm_max_ps(Vector, _mm_movehl_ps(Vector, Vector));
+    Vector = _mm_max_ss(Vector, _mm_shuffle_ps(Vector, Vector, 1));
+    return _mm_cvtss_f32(Vector);
+#endif
+}
+
 //
 // Reads a platform specific time stamp counter.
 //
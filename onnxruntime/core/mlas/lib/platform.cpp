@@ -43,6 +43,24 @@ Return Value:
 --*/
 {
 
+    //
+    // Default to the portable QGEMM kernels.
+    //
+
+    this->QgemmKernelZeroRoutine = MlasQgemmKernelZero;
+    this->QgemmKernelAddRoutine = MlasQgemmKernelAdd;
+    this->QgemmU8S8KernelZeroRoutine = nullptr;
+    this->QgemmU8S8KernelAddRoutine = nullptr;
+
+    //
+    // Default to no support for the NCHWc convolution kernels.
+    //
+
+    this->ConvNchwcFloatKernel = nullptr;
+    this->ConvNchwFloatKernel = nullptr;
+    this->ConvDepthwiseFloatKernel = nullptr;
+    this->NchwcBlockSize = 1;
+
 #if defined(MLAS_TARGET_AMD64_IX86)
 
     //
@@ -55,6 +73,8 @@ Return Value:
     this->TransposePackB16x4Routine = MlasSgemmTransposePackB16x4Sse;
     this->LogisticKernelRoutine = MlasLogisticKernel;
     this->TanhKernelRoutine = MlasTanhKernel;
+    this->ExpKernelRoutine = MlasExpKernel;
+    this->ComputeSumExpKernelRoutine = MlasComputeSumExpKernel;
 #endif
 
     //
@@ -106,13 +126,42 @@ Return Value:
                 if (((Cpuid7[1] & 0x10000) != 0) && ((xcr0 & 0xE0) == 0xE0)) {
                     this->KernelZeroRoutine = MlasSgemmKernelZeroAvx512F;
                     this->KernelAddRoutine = MlasSgemmKernelAddAvx512F;
+                    this->ConvNchwcFloatKernel = MlasConvNchwcFloatKernelAvx512F;
+                    this->ConvNchwFloatKernel = MlasConvNchwFloatKernelAvx512F;
+                    this->ConvDepthwiseFloatKernel = MlasConvDepthwiseFloatKernelAvx512F;
+                    this->NchwcBlockSize = 16;
                 } else {
                     this->KernelZeroRoutine = MlasSgemmKernelZeroFma3;
                     this->KernelAddRoutine = MlasSgemmKernelAddFma3;
+                    this->ConvNchwcFloatKernel = MlasConvNchwcFloatKernelAvx2;
+                    this->ConvNchwFloatKernel = MlasConvNchwFloatKernelAvx2;
+                    this->ConvDepthwiseFloatKernel = MlasConvDepthwiseFloatKernelAvx2;
+                    this->NchwcBlockSize = 8;
                 }
 
                 this->LogisticKernelRoutine = MlasLogisticKernelFma3;
                 this->TanhKernelRoutine = MlasTanhKernelFma3;
+                this->ExpKernelRoutine = MlasExpKernelFma3;
+                this->ComputeSumExpKernelRoutine = MlasComputeSumExpKernelFma3;
+
+#if !defined(_WIN32)
+
+                this->QgemmKernelZeroRoutine = MlasQgemmKernelZeroAvx2;
+                this->QgemmKernelAddRoutine = MlasQgemmKernelAddAvx2;
+
+                //
+                // Check if the processor supports AVX512BW and AVX512VNNI (and
+                // the operating system supports saving AVX512 state). These
+                // kernels multiply unsigned and signed 8-bit values directly.
+                //
+
+                if (((Cpuid7[1] & 0x40010000) == 0x40010000) && ((Cpuid7[2] & 0x800) != 0) &&
+                    ((xcr0 & 0xE0) == 0xE0)) {
+                    this->QgemmU8S8KernelZeroRoutine = MlasQgemmU8S8KernelZeroAvx512Vnni;
+                    this->QgemmU8S8KernelAddRoutine = MlasQgemmU8S8KernelAddAvx512Vnni;
+                }
+
+#endif
 
             } else {
 
@@ -16,25 +16,12 @@ Abstract:
 
 #include "mlasi.h"
 
-//
-// Define the parameters to execute segments of a pooling operation on worker
-// threads.
-//
-
-struct MLAS_WORK_BLOCK {
-    MLAS_POOLING_KIND PoolingKind;
-    size_t InputShape[3];
-    size_t InputSize;
-    size_t OutputShape[3];
-    int64_t KernelShape[3];
-    int64_t Padding[6];
-    int64_t StrideShape[3];
-};
-
 //
 // Define the prototype of the pooling kernel routine.
 //
 
+struct MLAS_WORK_BLOCK;
+
 typedef
 void
 (MLAS_POOL_KERNEL_ROUTINE)(
@@ -46,6 +33,27 @@ void
 
 typedef MLAS_POOL_KERNEL_ROUTINE* PMLAS_POOL_KERNEL_ROUTINE;
 
+//
+// Define the parameters to execute segments of a pooling operation on worker
+// threads.
+//
+
+struct MLAS_WORK_BLOCK {
+    MLAS_POOLING_KIND PoolingKind;
+    size_t InputShape[3];
+    size_t InputSize;
+    size_t OutputShape[3];
+    size_t OutputSize;
+    int64_t KernelShape[3];
+    int64_t Padding[6];
+    int64_t StrideShape[3];
+    PMLAS_POOL_KERNEL_ROUTINE PoolKernelRoutine;
+    const float* Input;
+    float* Output;
+    size_t TotalChannelCount;
+    int32_t TargetThreadCount;
+};
+
 //
 // Define the number of elements to allocate on the stack for the reduction
 // buffer in the vectorized kernels.
@@ -77,6 +85,16 @@ struct MLAS_MAXIMUM_POOLING
         return MlasBroadcastFloat32x4(InitialValue());
     }
 
+    static float Transform(float Value)
+    {
+        return Value;
+    }
+
+    static MLAS_FLOAT32X4 Transform(MLAS_FLOAT32X4 Value)
+    {
+        return Value;
+    }
+
     static float Reduce(float Reduction, float Value)
     {
         return (std::max)(Reduction, Value);
@@ -159,6 +177,16 @@ struct MLAS_AVERAGE_POOLING
         return MlasZeroFloat32x4();
     }
 
+    static float Transform(float Value)
+    {
+        return Value;
+    }
+
+    static MLAS_FLOAT32X4 Transform(MLAS_FLOAT32X4 Value)
+    {
+        return Value;
+    }
+
     static float Reduce(float Reduction, float Value)
     {
         return Reduction + Value;
@@ -269,75 +297,70 @@ struct MLAS_AVERAGE_POOLING
     };
 };
 
-template<typename PoolingType>
-void
-MlasPool1DKernel(
-    const MLAS_WORK_BLOCK* WorkBlock,
-    size_t ChannelCount,
-    const float* Input,
-    float* Output
-    )
-/*++
-
-Routine Description:
-
-    This routine implements the 1D pooling operation using generic constructs.
-
-Arguments:
-
-    WorkBlock - Supplies the structure that contains the pooling parameters.
-
-    ChannelCount - Supplies the number of channels to process.
-
-    Input - Supplies the input tensor.
-
-    Output - Supplies the output tensor.
-
-Return Value:
-
-    None.
+//
+// Abstraction for Lp pooling with p=1 and p=2.
+//
+// Each input element is transformed to its absolute or squared value and then
+// summed as with average pooling, except that the sum is converted to the
+// norm instead of being divided by the number of elements.
+//
 
---*/
+struct MLAS_L1_NORM_POOLING : MLAS_AVERAGE_POOLING
 {
-    constexpr size_t WidthShapeIndex = 0;
-
-    const MLAS_POOLING_KIND PoolingKind = WorkBlock->PoolingKind;
-
-    const size_t InputWidth = WorkBlock->InputShape[WidthShapeIndex];
-    const size_t OutputWidth = WorkBlock->OutputShape[WidthShapeIndex];
+    static float Transform(float Value)
+    {
+        return (std::max)(Value, -Value);
+    }
 
-    const int64_t KernelWidth = WorkBlock->KernelShape[WidthShapeIndex];
-    const int64_t PaddingLeftWidth = WorkBlock->Padding[WidthShapeIndex];
-    const int64_t StrideWidth = WorkBlock->StrideShape[WidthShapeIndex];
+    static MLAS_FLOAT32X4 Transform(MLAS_FLOAT32X4 Value)
+    {
+        return MlasMaximumFloat32x4(Value, MlasSubtractFloat32x4(MlasZeroFloat32x4(), Value));
+    }
 
-    for (size_t c = 0; c < ChannelCount; c++) {
+    static float AveragePool(float Reduction, float Size)
+    {
+        MLAS_UNREFERENCED_PARAMETER(Size);
 
-        for (size_t pw = 0; pw < OutputWidth; pw++) {
+        return Reduction;
+    }
 
-            const int64_t iwStart64 = pw * StrideWidth - PaddingLeftWidth;
-            const int64_t iwEnd64 = iwStart64 + KernelWidth;
+    struct DividerVectorContext : MLAS_MAXIMUM_POOLING::DividerVectorContext
+    {
+    };
+};
 
-            const size_t iwStart = size_t((std::max)(iwStart64, int64_t(0)));
-            const size_t iwEnd = size_t((std::min)(iwEnd64, int64_t(InputWidth)));
+struct MLAS_L2_NORM_POOLING : MLAS_AVERAGE_POOLING
+{
+    static float Transform(float Value)
+    {
+        return Value * Value;
+    }
 
-            float m = PoolingType::InitialValue();
+    static MLAS_FLOAT32X4 Transform(MLAS_FLOAT32X4 Value)
+    {
+        return MlasMultiplyFloat32x4(Value, Value);
+    }
 
-            for (size_t iw = size_t(iwStart); iw < size_t(iwEnd); iw++) {
-                m = PoolingType::Reduce(m, Input[iw]);
-            }
+    static float AveragePool(float Reduction, float Size)
+    {
+        MLAS_UNREFERENCED_PARAMETER(Size);
 
-            if (PoolingKind == MlasAveragePoolingExcludePad) {
-                m = PoolingType::AveragePool(m, float(iwEnd - iwStart));
-            } else {
-                m = PoolingType::AveragePool(m, float(KernelWidth));
-            }
+        return std::sqrt(Reduction);
+    }
 
-            *Output++ = m;
+    struct DividerVectorContext : MLAS_MAXIMUM_POOLING::DividerVectorContext
+    {
+        MLAS_FLOAT32X4 DivideExcludePad(MLAS_FLOAT32X4 Reduction)
+        {
+            return MlasSqrtFloat32x4(Reduction);
         }
 
-        Input += InputWidth;
-    }
-}
+        MLAS_FLOAT32X4 DivideIncludePad(MLAS_FLOAT32X4 Reduction)
+        {
+            return MlasSqrtFloat32x4(Reduction);
+        }
+    };
+};
 
 template<typename PoolingType>
 void
@@ -409,7 +432,7 @@ Return Value:
 
                 for (size_t ih = ihStart; ih < ihEnd; ih++) {
                     for (size_t iw = iwStart; iw < iwEnd; iw++) {
-                        m = PoolingType::Reduce(m, Input[ih * InputWidth + iw]);
+                        m = PoolingType::Reduce(m, PoolingType::Transform(Input[ih * InputWidth + iw]));
                     }
                 }
 
@@ -538,11 +561,11 @@ Return Value:
 
                 const float* InputRow = InputRowStart;
                 size_t InputRowsRemaining = InputRowsCount;
-                MLAS_FLOAT32X4 Reduction = MlasLoadFloat32x4(InputRow);
+                MLAS_FLOAT32X4 Reduction = PoolingType::Transform(MlasLoadFloat32x4(InputRow));
 
                 while (InputRowsRemaining > 0) {
                     InputRow += InputWidth;
-                    Reduction = PoolingType::Reduce(Reduction, MlasLoadFloat32x4(InputRow));
+                    Reduction = PoolingType::Reduce(Reduction, PoolingType::Transform(MlasLoadFloat32x4(InputRow)));
                     InputRowsRemaining--;
                 }
 
@@ -557,11 +580,11 @@ Return Value:
 
                 const float* InputRow = InputRowStart;
                 size_t InputRowsRemaining = InputRowsCount;
-                float Reduction = *InputRow;
+                float Reduction = PoolingType::Transform(*InputRow);
 
                 while (InputRowsRemaining > 0) {
                     InputRow += InputWidth;
-                    Reduction = PoolingType::Reduce(Reduction, *InputRow);
+                    Reduction = PoolingType::Reduce(Reduction, PoolingType::Transform(*InputRow));
                     InputRowsRemaining--;
                 }
 
@@ -736,7 +759,7 @@ Return Value:
                     for (size_t id = idStart; id < idEnd; id++) {
                         for (size_t ih = ihStart; ih < ihEnd; ih++) {
                             for (size_t iw = iwStart; iw < iwEnd; iw++) {
-                                m = PoolingType::Reduce(m, Input[id * InputHeight * InputWidth + ih * InputWidth + iw]);
+                                m = PoolingType::Reduce(m, PoolingType::Transform(Input[id * InputHeight * InputWidth + ih * InputWidth + iw]));
                             }
                         }
                     }
@@ -896,7 +919,7 @@ Return Value:
 
                         do {
 
-                            Reduction = PoolingType::Reduce(Reduction, MlasLoadFloat32x4(InputRow));
+                            Reduction = PoolingType::Reduce(Reduction, PoolingType::Transform(MlasLoadFloat32x4(InputRow)));
                             InputRow += InputWidth;
                             InputRowsRemaining--;
 
@@ -926,7 +949,7 @@ Return Value:
 
                         do {
 
-                            Reduction = PoolingType::Reduce(Reduction, *InputRow);
+                            Reduction = PoolingType::Reduce(Reduction, PoolingType::Transform(*InputRow));
                             InputRow += InputWidth;
                             InputRowsRemaining--;
 
@@ -1072,7 +1095,7 @@ Return Value:
         MLAS_FLOAT32X4 Reduction = PoolingType::InitialVector();
 
         while (InputSizeRemaining >= 4) {
-            Reduction = PoolingType::Reduce(Reduction, MlasLoadFloat32x4(Input));
+            Reduction = PoolingType::Reduce(Reduction, PoolingType::Transform(MlasLoadFloat32x4(Input)));
             Input += 4;
             InputSizeRemaining -= 4;
         }
@@ -1111,7 +1134,7 @@ Return Value:
         //
 
         while (InputSizeRemaining > 0) {
-            ReductionValue = PoolingType::Reduce(ReductionValue, *Input++);
+            ReductionValue = PoolingType::Reduce(ReductionValue, PoolingType::Transform(*Input++));
             InputSizeRemaining -= 1;
         }
 
@@ -1129,23 +1152,28 @@ Return Value:
 // Stores pointers to the pooling kernel routines.
 //
 
-static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolGenericKernels[][3] =
+static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolGenericKernels[][2] =
 {
     {
-        MlasPool1DKernel<MLAS_MAXIMUM_POOLING>,
         MlasPool2DKernel<MLAS_MAXIMUM_POOLING>,
         MlasPool3DKernel<MLAS_MAXIMUM_POOLING>,
     },
     {
-        MlasPool1DKernel<MLAS_AVERAGE_POOLING>,
         MlasPool2DKernel<MLAS_AVERAGE_POOLING>,
         MlasPool3DKernel<MLAS_AVERAGE_POOLING>,
     },
     {
-        MlasPool1DKernel<MLAS_AVERAGE_POOLING>,
         MlasPool2DKernel<MLAS_AVERAGE_POOLING>,
         MlasPool3DKernel<MLAS_AVERAGE_POOLING>,
     },
+    {
+        MlasPool2DKernel<MLAS_L1_NORM_POOLING>,
+        MlasPool3DKernel<MLAS_L1_NORM_POOLING>,
+    },
+    {
+        MlasPool2DKernel<MLAS_L2_NORM_POOLING>,
+        MlasPool3DKernel<MLAS_L2_NORM_POOLING>,
+    },
 };
 
 static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolGlobalKernels[] =
@@ -1153,6 +1181,8 @@ static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolGlobalKernels[] =
     MlasPoolGlobalKernel<MLAS_MAXIMUM_POOLING>,
     MlasPoolGlobalKernel<MLAS_AVERAGE_POOLING>,
     MlasPoolGlobalKernel<MLAS_AVERAGE_POOLING>,
+    MlasPoolGlobalKernel<MLAS_L1_NORM_POOLING>,
+    MlasPoolGlobalKernel<MLAS_L2_NORM_POOLING>,
 };
 
 static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolVectorKernels[][2] =
@@ -1169,8 +1199,68 @@ static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolVectorKernels[][2] =
         MlasPool2DVectorKernel<MLAS_AVERAGE_POOLING>,
         MlasPool3DVectorKernel<MLAS_AVERAGE_POOLING>,
     },
+    {
+        MlasPool2DVectorKernel<MLAS_L1_NORM_POOLING>,
+        MlasPool3DVectorKernel<MLAS_L1_NORM_POOLING>,
+    },
+    {
+        MlasPool2DVectorKernel<MLAS_L2_NORM_POOLING>,
+        MlasPool3DVectorKernel<MLAS_L2_NORM_POOLING>,
+    },
 };
 
+void
+MlasPoolThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    pooling operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_WORK_BLOCK* WorkBlock = (const MLAS_WORK_BLOCK*)Context;
+
+    //
+    // Compute the range of channels to use for this thread.
+    //
+
+    const size_t TotalChannelCount = WorkBlock->TotalChannelCount;
+    const size_t TargetThreadCount = size_t(WorkBlock->TargetThreadCount);
+
+    const size_t ChannelCountPerThread = TotalChannelCount / TargetThreadCount;
+    const size_t ChannelCountExtra = TotalChannelCount % TargetThreadCount;
+
+    size_t ChannelStart;
+    size_t ChannelCount;
+
+    if (uint32_t(Index) < ChannelCountExtra) {
+        ChannelStart = (ChannelCountPerThread + 1) * Index;
+        ChannelCount = ChannelCountPerThread + 1;
+    } else {
+        ChannelStart = ChannelCountPerThread * Index + ChannelCountExtra;
+        ChannelCount = ChannelCountPerThread;
+    }
+
+    WorkBlock->PoolKernelRoutine(WorkBlock, ChannelCount,
+        WorkBlock->Input + ChannelStart * WorkBlock->InputSize,
+        WorkBlock->Output + ChannelStart * WorkBlock->OutputSize);
+}
+
 void
 MLASCALL
 MlasPool(
@@ -1198,7 +1288,8 @@ Arguments:
 
     InputShape - Supplies the shape of the input tensor.
 
-    KernelShape - Supplies the shape of the kernel transform.
+    KernelShape - Supplies the shape of the kernel transform. If nullptr, then
+        the kernel shape is the input shape (global pooling).
 
     Padding - Supplies the number of padding elements at the edge of the input
         tensor.
@@ -1231,6 +1322,50 @@ Return Value:
     InputShape += 2;
     OutputShape += 2;
 
+    //
+    // Perform 1D pooling as 2D pooling with a unit height so that the same
+    // vectorized kernels are used.
+    //
+
+    int64_t InputShape2D[2];
+    int64_t OutputShape2D[2];
+    int64_t KernelShape2D[2];
+    int64_t Padding2D[4];
+    int64_t StrideShape2D[2];
+
+    if (Dimensions == 1) {
+
+        InputShape2D[0] = 1;
+        InputShape2D[1] = InputShape[0];
+        InputShape = InputShape2D;
+
+        OutputShape2D[0] = 1;
+        OutputShape2D[1] = OutputShape[0];
+        OutputShape = OutputShape2D;
+
+        if (KernelShape != nullptr) {
+            KernelShape2D[0] = 1;
+            KernelShape2D[1] = KernelShape[0];
+            KernelShape = KernelShape2D;
+        }
+
+        if (Padding != nullptr) {
+            Padding2D[0] = 0;
+            Padding2D[1] = Padding[0];
+            Padding2D[2] = 0;
+            Padding2D[3] = Padding[1];
+            Padding = Padding2D;
+        }
+
+        if (StrideShape != nullptr) {
+            StrideShape2D[0] = 1;
+            StrideShape2D[1] = StrideShape[0];
+            StrideShape = StrideShape2D;
+        }
+
+        Dimensions = 2;
+    }
+
     //
     // Save the pooling parameters.
     //
@@ -1278,6 +1413,7 @@ Return Value:
     }
 
     WorkBlock.InputSize = InputSize;
+    WorkBlock.OutputSize = OutputSize;
 
     //
     // Determine which pooling kernel routine to use.
@@ -1288,13 +1424,13 @@ Return Value:
     // in the reduction buffer.
     //
 
-    PMLAS_POOL_KERNEL_ROUTINE PoolKernelRoutine = MlasPoolGenericKernels[PoolingKind][Dimensions - 1];
+    PMLAS_POOL_KERNEL_ROUTINE PoolKernelRoutine = MlasPoolGenericKernels[PoolingKind][Dimensions - 2];
 
     if (InputAndKernelShapeMatch && AllStridesAreOne && AllPaddingIsZero) {
 
         PoolKernelRoutine = MlasPoolGlobalKernels[PoolingKind];
 
-    } else if (Dimensions >= 2 && WorkBlock.StrideShape[Dimensions - 1] <= 2 && AllKernelsAreSmall) {
+    } else if (WorkBlock.StrideShape[Dimensions - 1] <= 2 && AllKernelsAreSmall) {
 
         int64_t ReductionBufferRemaining = MLAS_POOL_REDUCTION_BUFFER_STACK - MLAS_POOL_REDUCTION_BUFFER_PADDING;
 
@@ -1316,20 +1452,25 @@ Return Value:
     }
 
     //
-    // Execute the pooling kernel routine.
+    // Execute the pooling kernel routine with the channels split across
+    // multiple threads.
     //
 
-#if defined(MLAS_USE_OPENMP)
-
-    #pragma omp parallel for
-    for (int64_t c = 0; c < int64_t(TotalChannelCount); c++) {
-        PoolKernelRoutine(&WorkBlock, 1, Input + c * InputSize, Output + c * OutputSize);
+    if (TotalChannelCount == 0) {
+        return;
     }
 
-#else
+    int32_t TargetThreadCount = MlasPlatform.GetMaximumThreadCount();
 
-    PoolKernelRoutine(&WorkBlock, TotalChannelCount, Input, Output);
+    if (size_t(TargetThreadCount) >= TotalChannelCount) {
+        TargetThreadCount = int32_t(TotalChannelCount);
+    }
 
-#endif
+    WorkBlock.PoolKernelRoutine = PoolKernelRoutine;
+    WorkBlock.Input = Input;
+    WorkBlock.Output = Output;
+    WorkBlock.TotalChannelCount = TotalChannelCount;
+    WorkBlock.TargetThreadCount = TargetThreadCount;
 
+    MlasExecuteThreaded(MlasPoolThreaded, &WorkBlock, TargetThreadCount);
 }
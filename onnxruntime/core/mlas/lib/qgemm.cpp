@@ -0,0 +1,1603 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    qgemm.cpp
+
+Abstract:
+
+    This module implements the quantized integer matrix/matrix multiply
+    operation (QGEMM).
+
+    The kernels operate on 16-bit values: matrix A and matrix B are widened
+    and have their zero points subtracted as they are packed, so the products
+    of pairs of values along the K dimension can be accumulated into 32-bit
+    results without saturation (pmaddwd/vpdpwssd).
+
+    Matrix A is packed as rows of pairs of values along the K dimension.
+
+    Matrix B is packed as blocks of 16 columns. Each pair of rows from the K
+    dimension of a block is stored as 16 interleaved pairs of values, so a
+    block with K rows occupies ((K + 1) & ~1) * 16 values.
+
+    Platforms that can multiply 8-bit values directly (vpdpbusd) use the U8S8
+    kernels instead. Matrix A keeps its unsigned values and matrix B is
+    converted to signed values by flipping the sign bit of unsigned inputs
+    (which shifts the zero point by 128). The kernels then accumulate A * B
+    and the zero points are applied afterwards using the row sums of A and
+    the column sums of B:
+
+        (A - offa) * (B - offb) = A * B - offb * RowSums(A) - offa * ColumnSums(B) + K * offa * offb
+
+    Matrix A is packed as rows of quads of values along the K dimension.
+
+    Matrix B is packed as blocks of 16 columns. Each block starts with the 16
+    column sums followed by the quads of rows from the K dimension stored as
+    16 interleaved quads of values.
+
+--*/
+
+#include "mlasi.h"
+
+#include <type_traits>
+
+//
+// Define the parameters to execute segments of a QGEMM operation on worker
+// threads.
+//
+
+struct MLAS_QGEMM_WORK_BLOCK {
+    size_t K;
+    size_t lda;
+    size_t ldb;
+    size_t ldc;
+    int16_t offa;
+    int16_t offb;
+    bool BIsSigned;
+    bool BIsPacked;
+    struct SEGMENT {
+        size_t M;
+        size_t N;
+        const uint8_t* A;
+        const void* B;
+        int32_t* C;
+    } Segments[MLAS_MAXIMUM_THREAD_COUNT];
+};
+
+inline
+size_t
+MlasQgemmPackedBlockStride(
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the number of values between blocks of 16 columns of
+    a packed matrix B.
+
+Arguments:
+
+    K - Supplies the number of rows of matrix B.
+
+Return Value:
+
+    Returns the block stride.
+
+--*/
+{
+    return ((K + 1) & ~size_t(1)) * 16;
+}
+
+//
+// Define the size of the header of a matrix B packed for the U8S8 kernels.
+// The header stores the zero point of the signed values.
+//
+
+#define MLAS_QGEMM_U8S8_PACKED_HEADER_SIZE          64
+
+inline
+bool
+MlasQgemmUseU8S8(
+    void
+    )
+{
+    return MlasPlatform.QgemmU8S8KernelZeroRoutine != nullptr;
+}
+
+inline
+size_t
+MlasQgemmU8S8PackedBlockStride(
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the number of bytes between blocks of 16 columns of
+    a matrix B packed for the U8S8 kernels.
+
+Arguments:
+
+    K - Supplies the number of rows of matrix B.
+
+Return Value:
+
+    Returns the block stride.
+
+--*/
+{
+    return 16 * sizeof(int32_t) + ((K + 3) & ~size_t(3)) * 16;
+}
+
+inline
+size_t
+MlasQgemmPackedBlockBytes(
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the number of bytes between blocks of 16 columns of
+    a matrix B packed by MlasQgemmPackB for the current platform.
+
+Arguments:
+
+    K - Supplies the number of rows of matrix B.
+
+Return Value:
+
+    Returns the block stride.
+
+--*/
+{
+    if (MlasQgemmUseU8S8()) {
+        return MlasQgemmU8S8PackedBlockStride(K);
+    }
+
+    return MlasQgemmPackedBlockStride(K) * sizeof(int16_t);
+}
+
+void
+MlasQgemmCopyPackA(
+    int16_t* D,
+    const uint8_t* A,
+    size_t lda,
+    size_t CountM,
+    size_t CountK,
+    int16_t offa
+    )
+/*++
+
+Routine Description:
+
+    This routine copies elements from the source matrix to the destination
+    packed buffer, subtracting the zero point.
+
+    Each row of the packed buffer is padded with a zero to an even number of
+    columns.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    A - Supplies the address of the source matrix.
+
+    lda - Supplies the number of elements per row of the source matrix.
+
+    CountM - Supplies the number of rows of the source matrix to copy.
+
+    CountK - Supplies the number of columns of the source matrix to copy.
+
+    offa - Supplies the zero point of the source matrix.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (CountM-- > 0) {
+
+        size_t k = 0;
+
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        __m128i ZeroPoint = _mm_set1_epi16(offa);
+        __m128i Zero = _mm_setzero_si128();
+
+        for (; k + 16 <= CountK; k += 16) {
+
+            __m128i Bytes = _mm_loadu_si128((const __m128i*)&A[k]);
+
+            _mm_storeu_si128((__m128i*)&D[k], _mm_sub_epi16(_mm_unpacklo_epi8(Bytes, Zero), ZeroPoint));
+            _mm_storeu_si128((__m128i*)&D[k + 8], _mm_sub_epi16(_mm_unpackhi_epi8(Bytes, Zero), ZeroPoint));
+        }
+
+#endif
+
+        for (; k < CountK; k++) {
+            D[k] = int16_t(A[k]) - offa;
+        }
+
+        if ((CountK & 1) != 0) {
+            D[k++] = 0;
+        }
+
+        D += k;
+        A += lda;
+    }
+}
+
+template<typename BType>
+void
+MlasQgemmCopyPackB(
+    int16_t* D,
+    const BType* B,
+    size_t ldb,
+    size_t CountN,
+    size_t CountK,
+    int16_t offb
+    )
+/*++
+
+Routine Description:
+
+    This routine copies elements from the source matrix to the destination
+    packed buffer, subtracting the zero point.
+
+    Columns of the source matrix are packed in blocks of 16 columns. The rows
+    of the last block and the last row pair are padded with zeroes.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    B - Supplies the address of the source matrix.
+
+    ldb - Supplies the number of elements per row of the source matrix.
+
+    CountN - Supplies the number of columns of the source matrix to copy.
+
+    CountK - Supplies the number of rows of the source matrix to copy.
+
+    offb - Supplies the zero point of the source matrix.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    for (size_t n = 0; n < CountN; n += 16) {
+
+        const BType* b = B + n;
+        size_t CountColumns = std::min(CountN - n, size_t(16));
+
+        for (size_t k = 0; k < CountK; k += 2) {
+
+            const BType* b0 = b;
+            const BType* b1 = b + ldb;
+
+#if defined(MLAS_SSE2_INTRINSICS)
+
+            if (CountColumns == 16 && k + 1 < CountK) {
+
+                //
+                // Interleave the two rows and then widen the values to
+                // produce the pairs of values for all 16 columns.
+                //
+
+                __m128i Row0 = _mm_loadu_si128((const __m128i*)b0);
+                __m128i Row1 = _mm_loadu_si128((const __m128i*)b1);
+                __m128i Pairs[2] = { _mm_unpacklo_epi8(Row0, Row1), _mm_unpackhi_epi8(Row0, Row1) };
+                __m128i ZeroPoint = _mm_set1_epi16(offb);
+
+                for (size_t i = 0; i < 2; i++) {
+
+                    __m128i Low;
+                    __m128i High;
+
+                    if (std::is_signed<BType>::value) {
+                        Low = _mm_srai_epi16(_mm_unpacklo_epi8(Pairs[i], Pairs[i]), 8);
+                        High = _mm_srai_epi16(_mm_unpackhi_epi8(Pairs[i], Pairs[i]), 8);
+                    } else {
+                        Low = _mm_unpacklo_epi8(Pairs[i], _mm_setzero_si128());
+                        High = _mm_unpackhi_epi8(Pairs[i], _mm_setzero_si128());
+                    }
+
+                    _mm_storeu_si128((__m128i*)&D[i * 16], _mm_sub_epi16(Low, ZeroPoint));
+                    _mm_storeu_si128((__m128i*)&D[i * 16 + 8], _mm_sub_epi16(High, ZeroPoint));
+                }
+
+                D += 32;
+                b += ldb * 2;
+                continue;
+            }
+
+#endif
+
+            if (k + 1 == CountK) {
+
+                for (size_t c = 0; c < CountColumns; c++) {
+                    D[c * 2] = int16_t(b0[c]) - offb;
+                    D[c * 2 + 1] = 0;
+                }
+
+            } else {
+
+                for (size_t c = 0; c < CountColumns; c++) {
+                    D[c * 2] = int16_t(b0[c]) - offb;
+                    D[c * 2 + 1] = int16_t(b1[c]) - offb;
+                }
+            }
+
+            for (size_t c = CountColumns; c < 16; c++) {
+                D[c * 2] = 0;
+                D[c * 2 + 1] = 0;
+            }
+
+            D += 32;
+            b += ldb * 2;
+        }
+    }
+}
+
+template<bool ZeroMode>
+size_t
+MlasQgemmKernelPortable(
+    const int16_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldb,
+    size_t ldc
+    )
+/*++
+
+Routine Description:
+
+    This routine is an inner kernel to compute matrix multiplication for a
+    set of rows.
+
+Arguments:
+
+    A - Supplies the address of matrix A. The matrix data has been packed
+        using MlasQgemmCopyPackA.
+
+    B - Supplies the address of matrix B. The matrix data has been packed
+        using MlasQgemmCopyPackB.
+
+    C - Supplies the address of matrix C.
+
+    PairCountK - Supplies the number of pairs of columns from matrix A and the
+        number of pairs of rows from matrix B to iterate over.
+
+    CountM - Supplies the maximum number of rows that can be processed for
+        matrix A and matrix C. The actual number of rows handled for this
+        invocation depends on the kernel implementation.
+
+    CountN - Supplies the number of columns from matrix B and matrix C to
+        iterate over.
+
+    lda - Supplies the first dimension of matrix A.
+
+    ldb - Supplies the number of elements between blocks of 16 columns of
+        matrix B.
+
+    ldc - Supplies the first dimension of matrix C.
+
+Return Value:
+
+    Returns the number of rows handled.
+
+--*/
+{
+    MLAS_UNREFERENCED_PARAMETER(CountM);
+    MLAS_UNREFERENCED_PARAMETER(lda);
+    MLAS_UNREFERENCED_PARAMETER(ldc);
+
+    for (size_t n = 0; n < CountN; n += 16) {
+
+        MLAS_DECLSPEC_ALIGN(int32_t Accumulators[16], 16);
+
+        const int16_t* a = A;
+        const int16_t* b = B;
+
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        __m128i Accumulator0 = _mm_setzero_si128();
+        __m128i Accumulator1 = _mm_setzero_si128();
+        __m128i Accumulator2 = _mm_setzero_si128();
+        __m128i Accumulator3 = _mm_setzero_si128();
+
+        for (size_t p = 0; p < PairCountK; p++) {
+
+            int32_t Pair;
+            memcpy(&Pair, a, sizeof(int32_t));
+            __m128i PairBroadcast = _mm_set1_epi32(Pair);
+
+            Accumulator0 = _mm_add_epi32(Accumulator0, _mm_madd_epi16(PairBroadcast, _mm_loadu_si128((const __m128i*)&b[0])));
+            Accumulator1 = _mm_add_epi32(Accumulator1, _mm_madd_epi16(PairBroadcast, _mm_loadu_si128((const __m128i*)&b[8])));
+            Accumulator2 = _mm_add_epi32(Accumulator2, _mm_madd_epi16(PairBroadcast, _mm_loadu_si128((const __m128i*)&b[16])));
+            Accumulator3 = _mm_add_epi32(Accumulator3, _mm_madd_epi16(PairBroadcast, _mm_loadu_si128((const __m128i*)&b[24])));
+
+            a += 2;
+            b += 32;
+        }
+
+        _mm_store_si128((__m128i*)&Accumulators[0], Accumulator0);
+        _mm_store_si128((__m128i*)&Accumulators[4], Accumulator1);
+        _mm_store_si128((__m128i*)&Accumulators[8], Accumulator2);
+        _mm_store_si128((__m128i*)&Accumulators[12], Accumulator3);
+
+#else
+
+        for (size_t c = 0; c < 16; c++) {
+            Accumulators[c] = 0;
+        }
+
+        for (size_t p = 0; p < PairCountK; p++) {
+
+            int32_t a0 = a[0];
+            int32_t a1 = a[1];
+
+            for (size_t c = 0; c < 16; c++) {
+                Accumulators[c] += a0 * b[c * 2] + a1 * b[c * 2 + 1];
+            }
+
+            a += 2;
+            b += 32;
+        }
+
+#endif
+
+        size_t CountColumns = std::min(CountN - n, size_t(16));
+
+        for (size_t c = 0; c < CountColumns; c++) {
+            C[n + c] = ZeroMode ? Accumulators[c] : C[n + c] + Accumulators[c];
+        }
+
+        B += ldb;
+    }
+
+    return 1;
+}
+
+size_t
+MLASCALL
+MlasQgemmKernelZero(
+    const int16_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldb,
+    size_t ldc
+    )
+{
+    return MlasQgemmKernelPortable<true>(A, B, C, PairCountK, CountM, CountN, lda, ldb, ldc);
+}
+
+size_t
+MLASCALL
+MlasQgemmKernelAdd(
+    const int16_t* A,
+    const int16_t* B,
+    int32_t* C,
+    size_t PairCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldb,
+    size_t ldc
+    )
+{
+    return MlasQgemmKernelPortable<false>(A, B, C, PairCountK, CountM, CountN, lda, ldb, ldc);
+}
+
+void
+MlasQgemmU8S8CopyPackA(
+    uint8_t* D,
+    const uint8_t* A,
+    size_t lda,
+    size_t CountM,
+    size_t CountK,
+    int32_t* RowSumVector
+    )
+/*++
+
+Routine Description:
+
+    This routine copies elements from the source matrix to the destination
+    packed buffer for the U8S8 kernels and computes the sum of each row.
+
+    Each row of the packed buffer is padded with zeroes to a multiple of 4
+    columns.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    A - Supplies the address of the source matrix.
+
+    lda - Supplies the number of elements per row of the source matrix.
+
+    CountM - Supplies the number of rows of the source matrix to copy.
+
+    CountK - Supplies the number of columns of the source matrix to copy.
+
+    RowSumVector - Supplies the address of the buffer to receive the sums of
+        the elements of each row.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedCountK = (CountK + 3) & ~size_t(3);
+
+    while (CountM-- > 0) {
+
+        size_t k = 0;
+        int32_t RowSum = 0;
+
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        __m128i Zero = _mm_setzero_si128();
+        __m128i Sums = _mm_setzero_si128();
+
+        for (; k + 16 <= CountK; k += 16) {
+
+            __m128i Bytes = _mm_loadu_si128((const __m128i*)&A[k]);
+
+            _mm_storeu_si128((__m128i*)&D[k], Bytes);
+            Sums = _mm_add_epi32(Sums, _mm_sad_epu8(Bytes, Zero));
+        }
+
+        Sums = _mm_add_epi32(Sums, _mm_shuffle_epi32(Sums, _MM_SHUFFLE(1, 0, 3, 2)));
+        RowSum = _mm_cvtsi128_si32(Sums);
+
+#endif
+
+        for (; k < CountK; k++) {
+            D[k] = A[k];
+            RowSum += A[k];
+        }
+
+        for (; k < AlignedCountK; k++) {
+            D[k] = 0;
+        }
+
+        *RowSumVector++ = RowSum;
+
+        D += AlignedCountK;
+        A += lda;
+    }
+}
+
+template<typename BType>
+void
+MlasQgemmU8S8CopyPackB(
+    uint8_t* D,
+    const BType* B,
+    size_t ldb,
+    size_t CountN,
+    size_t CountK,
+    size_t BlockStride
+    )
+/*++
+
+Routine Description:
+
+    This routine copies elements from the source matrix to the destination
+    packed buffer for the U8S8 kernels. Unsigned values are converted to
+    signed values by flipping the sign bit.
+
+    Columns of the source matrix are packed in blocks of 16 columns. Each
+    block starts with the sums of its 16 columns. The rows of the last block
+    and the last row quad are padded with zeroes.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    B - Supplies the address of the source matrix.
+
+    ldb - Supplies the number of elements per row of the source matrix.
+
+    CountN - Supplies the number of columns of the source matrix to copy.
+
+    CountK - Supplies the number of rows of the source matrix to copy.
+
+    BlockStride - Supplies the number of bytes between blocks of 16 columns of
+        the destination packed buffer.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const uint8_t BitFlip = std::is_signed<BType>::value ? 0 : 0x80;
+
+    for (size_t n = 0; n < CountN; n += 16) {
+
+        int32_t* ColumnSums = (int32_t*)D;
+        uint8_t* d = D + 16 * sizeof(int32_t);
+        const BType* b = B + n;
+        size_t CountColumns = std::min(CountN - n, size_t(16));
+
+        std::fill_n(ColumnSums, 16, 0);
+
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        __m128i BitFlipVector = _mm_set1_epi8(int8_t(BitFlip));
+        __m128i ColumnSums0 = _mm_setzero_si128();
+        __m128i ColumnSums1 = _mm_setzero_si128();
+        __m128i ColumnSums2 = _mm_setzero_si128();
+        __m128i ColumnSums3 = _mm_setzero_si128();
+
+#endif
+
+        for (size_t k = 0; k < CountK; k += 4) {
+
+#if defined(MLAS_SSE2_INTRINSICS)
+
+            if (CountColumns == 16 && k + 4 <= CountK) {
+
+                //
+                // Interleave the four rows to produce the quads of values for
+                // all 16 columns.
+                //
+
+                __m128i Row0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&b[0]), BitFlipVector);
+                __m128i Row1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&b[ldb]), BitFlipVector);
+                __m128i Row2 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&b[ldb * 2]), BitFlipVector);
+                __m128i Row3 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&b[ldb * 3]), BitFlipVector);
+
+                __m128i Pairs01Low = _mm_unpacklo_epi8(Row0, Row1);
+                __m128i Pairs01High = _mm_unpackhi_epi8(Row0, Row1);
+                __m128i Pairs23Low = _mm_unpacklo_epi8(Row2, Row3);
+                __m128i Pairs23High = _mm_unpackhi_epi8(Row2, Row3);
+
+                _mm_storeu_si128((__m128i*)&d[0], _mm_unpacklo_epi16(Pairs01Low, Pairs23Low));
+                _mm_storeu_si128((__m128i*)&d[16], _mm_unpackhi_epi16(Pairs01Low, Pairs23Low));
+                _mm_storeu_si128((__m128i*)&d[32], _mm_unpacklo_epi16(Pairs01High, Pairs23High));
+                _mm_storeu_si128((__m128i*)&d[48], _mm_unpackhi_epi16(Pairs01High, Pairs23High));
+
+                //
+                // Widen the signed values of the four rows and accumulate the
+                // column sums.
+                //
+
+                __m128i SumsLow = _mm_add_epi16(
+                    _mm_add_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(Row0, Row0), 8), _mm_srai_epi16(_mm_unpacklo_epi8(Row1, Row1), 8)),
+                    _mm_add_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(Row2, Row2), 8), _mm_srai_epi16(_mm_unpacklo_epi8(Row3, Row3), 8)));
+                __m128i SumsHigh = _mm_add_epi16(
+                    _mm_add_epi16(_mm_srai_epi16(_mm_unpackhi_epi8(Row0, Row0), 8), _mm_srai_epi16(_mm_unpackhi_epi8(Row1, Row1), 8)),
+                    _mm_add_epi16(_mm_srai_epi16(_mm_unpackhi_epi8(Row2, Row2), 8), _mm_srai_epi16(_mm_unpackhi_epi8(Row3, Row3), 8)));
+
+                ColumnSums0 = _mm_add_epi32(ColumnSums0, _mm_srai_epi32(_mm_unpacklo_epi16(SumsLow, SumsLow), 16));
+                ColumnSums1 = _mm_add_epi32(ColumnSums1, _mm_srai_epi32(_mm_unpackhi_epi16(SumsLow, SumsLow), 16));
+                ColumnSums2 = _mm_add_epi32(ColumnSums2, _mm_srai_epi32(_mm_unpacklo_epi16(SumsHigh, SumsHigh), 16));
+                ColumnSums3 = _mm_add_epi32(ColumnSums3, _mm_srai_epi32(_mm_unpackhi_epi16(SumsHigh, SumsHigh), 16));
+
+                d += 64;
+                b += ldb * 4;
+                continue;
+            }
+
+#endif
+
+            size_t CountRows = std::min(CountK - k, size_t(4));
+
+            for (size_t c = 0; c < 16; c++) {
+
+                for (size_t r = 0; r < 4; r++) {
+
+                    uint8_t Value = 0;
+
+                    if (c < CountColumns && r < CountRows) {
+                        Value = uint8_t(b[r * ldb + c]) ^ BitFlip;
+                        ColumnSums[c] += int8_t(Value);
+                    }
+
+                    d[c * 4 + r] = Value;
+                }
+            }
+
+            d += 64;
+            b += ldb * 4;
+        }
+
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        _mm_storeu_si128((__m128i*)&ColumnSums[0], _mm_add_epi32(_mm_loadu_si128((const __m128i*)&ColumnSums[0]), ColumnSums0));
+        _mm_storeu_si128((__m128i*)&ColumnSums[4], _mm_add_epi32(_mm_loadu_si128((const __m128i*)&ColumnSums[4]), ColumnSums1));
+        _mm_storeu_si128((__m128i*)&ColumnSums[8], _mm_add_epi32(_mm_loadu_si128((const __m128i*)&ColumnSums[8]), ColumnSums2));
+        _mm_storeu_si128((__m128i*)&ColumnSums[12], _mm_add_epi32(_mm_loadu_si128((const __m128i*)&ColumnSums[12]), ColumnSums3));
+
+#endif
+
+        D += BlockStride;
+    }
+}
+
+void
+MlasQgemmU8S8AddCorrections(
+    int32_t* C,
+    size_t ldc,
+    size_t CountM,
+    size_t CountN,
+    const int32_t* RowCorrections,
+    const int32_t* ColumnCorrections
+    )
+/*++
+
+Routine Description:
+
+    This routine applies the zero point corrections to the output of the U8S8
+    kernels.
+
+Arguments:
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    CountM - Supplies the number of rows of matrix C to update.
+
+    CountN - Supplies the number of columns of matrix C to update.
+
+    RowCorrections - Supplies the correction to add to each row.
+
+    ColumnCorrections - Supplies the correction to add to each column.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (CountM-- > 0) {
+
+        const int32_t RowCorrection = *RowCorrections++;
+
+        size_t n = 0;
+
+#if defined(MLAS_SSE2_INTRINSICS)
+
+        __m128i RowCorrectionVector = _mm_set1_epi32(RowCorrection);
+
+        for (; n + 4 <= CountN; n += 4) {
+
+            __m128i Correction = _mm_add_epi32(RowCorrectionVector, _mm_loadu_si128((const __m128i*)&ColumnCorrections[n]));
+
+            _mm_storeu_si128((__m128i*)&C[n], _mm_add_epi32(_mm_loadu_si128((const __m128i*)&C[n]), Correction));
+        }
+
+#endif
+
+        for (; n < CountN; n++) {
+            C[n] += RowCorrection + ColumnCorrections[n];
+        }
+
+        C += ldc;
+    }
+}
+
+void
+MlasQgemmU8S8Operation(
+    const MLAS_QGEMM_WORK_BLOCK* WorkBlock,
+    size_t M,
+    size_t N,
+    const uint8_t* A,
+    const void* B,
+    int32_t* C
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation on a single thread using the U8S8 kernels.
+
+Arguments:
+
+    WorkBlock - Supplies the common parameters of the operation.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    A - Supplies the address of matrix A.
+
+    B - Supplies the address of matrix B. If the work block indicates that
+        matrix B is packed, this is the address of the first block of 16
+        columns to process.
+
+    C - Supplies the address of matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t PanelBlockStride = 16 * sizeof(int32_t) + MLAS_QGEMM_STRIDEK * 16;
+
+    MLAS_DECLSPEC_ALIGN(uint8_t PanelA[MLAS_QGEMM_STRIDEM * MLAS_QGEMM_STRIDEK], 64);
+    MLAS_DECLSPEC_ALIGN(uint8_t PanelB[(MLAS_QGEMM_STRIDEN / 16) * PanelBlockStride], 64);
+    MLAS_DECLSPEC_ALIGN(int32_t RowCorrections[MLAS_QGEMM_STRIDEM], 16);
+    MLAS_DECLSPEC_ALIGN(int32_t ColumnCorrections[MLAS_QGEMM_STRIDEN], 16);
+
+    const size_t K = WorkBlock->K;
+    const size_t lda = WorkBlock->lda;
+    const size_t ldb = WorkBlock->ldb;
+    const size_t ldc = WorkBlock->ldc;
+    const size_t PackedBlockStride = MlasQgemmU8S8PackedBlockStride(K);
+    const int32_t offa = WorkBlock->offa;
+
+    //
+    // Unsigned values of matrix B have their sign bit flipped as they are
+    // packed, so shift the zero point to match. A matrix packed ahead of time
+    // already stores the shifted zero point.
+    //
+
+    int32_t offb = WorkBlock->offb;
+
+    if (!WorkBlock->BIsPacked && !WorkBlock->BIsSigned) {
+        offb -= 128;
+    }
+
+    //
+    // The results of the first slice of K are stored to matrix C. Following
+    // slices accumulate into matrix C.
+    //
+
+    PMLAS_QGEMM_U8S8_KERNEL_ROUTINE KernelRoutine = MlasPlatform.QgemmU8S8KernelZeroRoutine;
+
+    size_t CountK;
+
+    for (size_t k = 0; k < K; k += CountK) {
+
+        CountK = std::min(K - k, size_t(MLAS_QGEMM_STRIDEK));
+
+        const size_t QuadCountK = (CountK + 3) / 4;
+
+        size_t CountN;
+
+        for (size_t n = 0; n < N; n += CountN) {
+
+            CountN = std::min(N - n, size_t(MLAS_QGEMM_STRIDEN));
+
+            //
+            // Copy a panel of matrix B to a local packed buffer, unless the
+            // caller has already packed the whole matrix.
+            //
+            // The column sums of a matrix packed ahead of time span all of K,
+            // so the column corrections are only applied with the first slice.
+            //
+
+            const uint8_t* BlockBase;
+            size_t BlockStride;
+            size_t BlockOffsetK;
+            size_t ColumnCountK;
+
+            if (WorkBlock->BIsPacked) {
+
+                BlockBase = (const uint8_t*)B + (n / 16) * PackedBlockStride;
+                BlockStride = PackedBlockStride;
+                BlockOffsetK = k * 16;
+                ColumnCountK = (k == 0) ? K : 0;
+
+            } else {
+
+                if (WorkBlock->BIsSigned) {
+                    MlasQgemmU8S8CopyPackB(PanelB, (const int8_t*)B + k * ldb + n, ldb, CountN, CountK, PanelBlockStride);
+                } else {
+                    MlasQgemmU8S8CopyPackB(PanelB, (const uint8_t*)B + k * ldb + n, ldb, CountN, CountK, PanelBlockStride);
+                }
+
+                BlockBase = PanelB;
+                BlockStride = PanelBlockStride;
+                BlockOffsetK = 0;
+                ColumnCountK = CountK;
+            }
+
+            for (size_t c = 0; c < CountN; c++) {
+
+                if (ColumnCountK > 0) {
+                    const int32_t* ColumnSums = (const int32_t*)(BlockBase + (c / 16) * BlockStride);
+                    ColumnCorrections[c] = int32_t(ColumnCountK) * offa * offb - offa * ColumnSums[c % 16];
+                } else {
+                    ColumnCorrections[c] = 0;
+                }
+            }
+
+            const uint8_t* b = BlockBase + 16 * sizeof(int32_t) + BlockOffsetK;
+
+            size_t CountM;
+
+            for (size_t m = 0; m < M; m += CountM) {
+
+                CountM = std::min(M - m, size_t(MLAS_QGEMM_STRIDEM));
+
+                MlasQgemmU8S8CopyPackA(PanelA, A + m * lda + k, lda, CountM, CountK, RowCorrections);
+
+                for (size_t r = 0; r < CountM; r++) {
+                    RowCorrections[r] *= -offb;
+                }
+
+                const uint8_t* a = PanelA;
+                int32_t* c = C + m * ldc + n;
+                const int32_t* RowCorrection = RowCorrections;
+                size_t RowsRemaining = CountM;
+
+                do {
+
+                    size_t RowsHandled = KernelRoutine(a, b, c, QuadCountK, RowsRemaining, CountN, QuadCountK * 4, BlockStride, ldc);
+
+                    MlasQgemmU8S8AddCorrections(c, ldc, RowsHandled, CountN, RowCorrection, ColumnCorrections);
+
+                    a += RowsHandled * QuadCountK * 4;
+                    c += RowsHandled * ldc;
+                    RowCorrection += RowsHandled;
+                    RowsRemaining -= RowsHandled;
+
+                } while (RowsRemaining > 0);
+            }
+        }
+
+        KernelRoutine = MlasPlatform.QgemmU8S8KernelAddRoutine;
+    }
+}
+
+void
+MlasQgemmOperation(
+    const MLAS_QGEMM_WORK_BLOCK* WorkBlock,
+    size_t M,
+    size_t N,
+    const uint8_t* A,
+    const void* B,
+    int32_t* C
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation on a single thread.
+
+Arguments:
+
+    WorkBlock - Supplies the common parameters of the operation.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    A - Supplies the address of matrix A.
+
+    B - Supplies the address of matrix B. If the work block indicates that
+        matrix B is packed, this is the address of the first block of 16
+        columns to process.
+
+    C - Supplies the address of matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (MlasQgemmUseU8S8()) {
+        MlasQgemmU8S8Operation(WorkBlock, M, N, A, B, C);
+        return;
+    }
+
+    MLAS_DECLSPEC_ALIGN(int16_t PanelA[MLAS_QGEMM_STRIDEM * MLAS_QGEMM_STRIDEK], 64);
+    MLAS_DECLSPEC_ALIGN(int16_t PanelB[MLAS_QGEMM_STRIDEN * MLAS_QGEMM_STRIDEK], 64);
+
+    const size_t K = WorkBlock->K;
+    const size_t lda = WorkBlock->lda;
+    const size_t ldb = WorkBlock->ldb;
+    const size_t ldc = WorkBlock->ldc;
+    const size_t PackedBlockStride = MlasQgemmPackedBlockStride(K);
+
+    //
+    // The results of the first slice of K are stored to matrix C. Following
+    // slices accumulate into matrix C.
+    //
+
+    PMLAS_QGEMM_KERNEL_ROUTINE KernelRoutine = MlasPlatform.QgemmKernelZeroRoutine;
+
+    size_t CountK;
+
+    for (size_t k = 0; k < K; k += CountK) {
+
+        CountK = std::min(K - k, size_t(MLAS_QGEMM_STRIDEK));
+
+        const size_t PairCountK = (CountK + 1) / 2;
+
+        size_t CountN;
+
+        for (size_t n = 0; n < N; n += CountN) {
+
+            CountN = std::min(N - n, size_t(MLAS_QGEMM_STRIDEN));
+
+            //
+            // Copy a panel of matrix B to a local packed buffer, unless the
+            // caller has already packed the whole matrix.
+            //
+
+            const int16_t* b;
+            size_t BlockStride;
+
+            if (WorkBlock->BIsPacked) {
+
+                b = (const int16_t*)B + (n / 16) * PackedBlockStride + k * 16;
+                BlockStride = PackedBlockStride;
+
+            } else {
+
+                if (WorkBlock->BIsSigned) {
+                    MlasQgemmCopyPackB(PanelB, (const int8_t*)B + k * ldb + n, ldb, CountN, CountK, WorkBlock->offb);
+                } else {
+                    MlasQgemmCopyPackB(PanelB, (const uint8_t*)B + k * ldb + n, ldb, CountN, CountK, WorkBlock->offb);
+                }
+
+                b = PanelB;
+                BlockStride = PairCountK * 32;
+            }
+
+            size_t CountM;
+
+            for (size_t m = 0; m < M; m += CountM) {
+
+                CountM = std::min(M - m, size_t(MLAS_QGEMM_STRIDEM));
+
+                MlasQgemmCopyPackA(PanelA, A + m * lda + k, lda, CountM, CountK, WorkBlock->offa);
+
+                const int16_t* a = PanelA;
+                int32_t* c = C + m * ldc + n;
+                size_t RowsRemaining = CountM;
+
+                do {
+
+                    size_t RowsHandled = KernelRoutine(a, b, c, PairCountK, RowsRemaining, CountN, PairCountK * 2, BlockStride, ldc);
+
+                    a += RowsHandled * PairCountK * 2;
+                    c += RowsHandled * ldc;
+                    RowsRemaining -= RowsHandled;
+
+                } while (RowsRemaining > 0);
+            }
+        }
+
+        KernelRoutine = MlasPlatform.QgemmKernelAddRoutine;
+    }
+}
+
+void
+MlasQgemmOperationThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    QGEMM operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_QGEMM_WORK_BLOCK* WorkBlock = (MLAS_QGEMM_WORK_BLOCK*)Context;
+
+    MLAS_QGEMM_WORK_BLOCK::SEGMENT* Segment = &WorkBlock->Segments[Index];
+
+    MlasQgemmOperation(WorkBlock, Segment->M, Segment->N, Segment->A, Segment->B, Segment->C);
+}
+
+void
+MlasQgemmSchedule(
+    MLAS_QGEMM_WORK_BLOCK* WorkBlock,
+    size_t M,
+    size_t N,
+    const uint8_t* A,
+    const void* B,
+    int32_t* C
+    )
+/*++
+
+Routine Description:
+
+    This routine runs a QGEMM operation across multiple threads or falls back
+    to a single thread based on the GEMM parameters and system configuration.
+
+Arguments:
+
+    WorkBlock - Supplies the common parameters of the operation.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    A - Supplies the address of matrix A.
+
+    B - Supplies the address of matrix B.
+
+    C - Supplies the address of matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t K = WorkBlock->K;
+
+    if (M == 0 || N == 0) {
+        return;
+    }
+
+    //
+    // An empty inner dimension produces a zero matrix.
+    //
+
+    if (K == 0) {
+
+        for (size_t m = 0; m < M; m++) {
+            std::fill_n(C + m * WorkBlock->ldc, N, 0);
+        }
+
+        return;
+    }
+
+    int32_t TargetThreadCount;
+
+    //
+    // Compute the number of target threads given the complexity of the QGEMM
+    // operation. Small requests should run using the single threaded path.
+    //
+
+    double Complexity = double(M) * double(N) * double(K);
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (TargetThreadCount == 1) {
+        MlasQgemmOperation(WorkBlock, M, N, A, B, C);
+        return;
+    }
+
+    //
+    // Segment the operation across multiple threads.
+    //
+
+    int32_t Index = 0;
+
+    if (N > M) {
+
+        size_t StrideN = N / TargetThreadCount;
+
+        if ((StrideN * TargetThreadCount) != N) {
+            StrideN++;
+        }
+
+        StrideN =
+            (StrideN + MLAS_QGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_QGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+        for (size_t CountN, n = 0; n < N; n += CountN) {
+
+            CountN = StrideN;
+
+            if (CountN > (N - n)) {
+                CountN = N - n;
+            }
+
+            const void* b;
+
+            if (WorkBlock->BIsPacked) {
+                b = (const uint8_t*)B + (n / 16) * MlasQgemmPackedBlockBytes(K);
+            } else {
+                b = (const uint8_t*)B + n;
+            }
+
+            WorkBlock->Segments[Index].M = M;
+            WorkBlock->Segments[Index].N = CountN;
+            WorkBlock->Segments[Index].A = A;
+            WorkBlock->Segments[Index].B = b;
+            WorkBlock->Segments[Index].C = C + n;
+
+            Index++;
+        }
+
+    } else {
+
+        size_t StrideM = M / TargetThreadCount;
+
+        if ((StrideM * TargetThreadCount) != M) {
+            StrideM++;
+        }
+
+        for (size_t CountM, m = 0; m < M; m += CountM) {
+
+            CountM = StrideM;
+
+            if (CountM > (M - m)) {
+                CountM = M - m;
+            }
+
+            WorkBlock->Segments[Index].M = CountM;
+            WorkBlock->Segments[Index].N = N;
+            WorkBlock->Segments[Index].A = A + m * WorkBlock->lda;
+            WorkBlock->Segments[Index].B = B;
+            WorkBlock->Segments[Index].C = C + m * WorkBlock->ldc;
+
+            Index++;
+        }
+    }
+
+    MlasExecuteThreaded(MlasQgemmOperationThreaded, WorkBlock, Index);
+}
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    int32_t* C,
+    size_t ldc
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation (QGEMM) for unsigned matrix B.
+
+Arguments:
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    offa - Supplies the zero point of matrix A.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    offb - Supplies the zero point of matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_QGEMM_WORK_BLOCK WorkBlock;
+
+    WorkBlock.K = K;
+    WorkBlock.lda = lda;
+    WorkBlock.ldb = ldb;
+    WorkBlock.ldc = ldc;
+    WorkBlock.offa = offa;
+    WorkBlock.offb = offb;
+    WorkBlock.BIsSigned = false;
+    WorkBlock.BIsPacked = false;
+
+    MlasQgemmSchedule(&WorkBlock, M, N, A, B, C);
+}
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const int8_t* B,
+    size_t ldb,
+    int8_t offb,
+    int32_t* C,
+    size_t ldc
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation (QGEMM) for signed matrix B.
+
+Arguments:
+
+    See the unsigned version of MlasQgemm.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_QGEMM_WORK_BLOCK WorkBlock;
+
+    WorkBlock.K = K;
+    WorkBlock.lda = lda;
+    WorkBlock.ldb = ldb;
+    WorkBlock.ldc = ldc;
+    WorkBlock.offa = offa;
+    WorkBlock.offb = offb;
+    WorkBlock.BIsSigned = true;
+    WorkBlock.BIsPacked = false;
+
+    MlasQgemmSchedule(&WorkBlock, M, N, A, B, C);
+}
+
+size_t
+MLASCALL
+MlasQgemmPackBSize(
+    size_t N,
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the number of bytes required to pack matrix B with
+    MlasQgemmPackB.
+
+Arguments:
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+Return Value:
+
+    Returns the size of the packed buffer in bytes.
+
+--*/
+{
+    if (MlasQgemmUseU8S8()) {
+        return MLAS_QGEMM_U8S8_PACKED_HEADER_SIZE + ((N + 15) / 16) * MlasQgemmU8S8PackedBlockStride(K);
+    }
+
+    return ((N + 15) / 16) * MlasQgemmPackedBlockStride(K) * sizeof(int16_t);
+}
+
+template<typename BType>
+void
+MlasQgemmPackBInternal(
+    size_t N,
+    size_t K,
+    const BType* B,
+    size_t ldb,
+    BType offb,
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine packs matrix B for use with MlasQgemmPacked using the format
+    of the kernels selected for the current platform.
+
+Arguments:
+
+    See MlasQgemmPackB.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (MlasQgemmUseU8S8()) {
+
+        //
+        // The U8S8 kernels apply the zero point after the multiplication, so
+        // store the zero point of the signed values in the header.
+        //
+
+        int32_t* Header = (int32_t*)PackedB;
+
+        std::fill_n(Header, MLAS_QGEMM_U8S8_PACKED_HEADER_SIZE / sizeof(int32_t), 0);
+        Header[0] = std::is_signed<BType>::value ? int32_t(offb) : int32_t(offb) - 128;
+
+        MlasQgemmU8S8CopyPackB((uint8_t*)PackedB + MLAS_QGEMM_U8S8_PACKED_HEADER_SIZE, B, ldb, N, K,
+            MlasQgemmU8S8PackedBlockStride(K));
+
+    } else {
+
+        MlasQgemmCopyPackB((int16_t*)PackedB, B, ldb, N, K, offb);
+    }
+}
+
+void
+MLASCALL
+MlasQgemmPackB(
+    size_t N,
+    size_t K,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine packs unsigned matrix B for use with MlasQgemmPacked.
+
+Arguments:
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    offb - Supplies the zero point of matrix B.
+
+    PackedB - Supplies the address of the packed buffer. The buffer must hold
+        at least MlasQgemmPackBSize bytes.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasQgemmPackBInternal(N, K, B, ldb, offb, PackedB);
+}
+
+void
+MLASCALL
+MlasQgemmPackB(
+    size_t N,
+    size_t K,
+    const int8_t* B,
+    size_t ldb,
+    int8_t offb,
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine packs signed matrix B for use with MlasQgemmPacked.
+
+Arguments:
+
+    See the unsigned version of MlasQgemmPackB.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasQgemmPackBInternal(N, K, B, ldb, offb, PackedB);
+}
+
+void
+MLASCALL
+MlasQgemmPacked(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const void* PackedB,
+    int32_t* C,
+    size_t ldc
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation (QGEMM) using a matrix B packed by MlasQgemmPackB.
+
+Arguments:
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    offa - Supplies the zero point of matrix A.
+
+    PackedB - Supplies the address of the packed matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_QGEMM_WORK_BLOCK WorkBlock;
+
+    WorkBlock.K = K;
+    WorkBlock.lda = lda;
+    WorkBlock.ldb = 0;
+    WorkBlock.ldc = ldc;
+    WorkBlock.offa = offa;
+    WorkBlock.offb = 0;
+    WorkBlock.BIsSigned = false;
+    WorkBlock.BIsPacked = true;
+
+    if (MlasQgemmUseU8S8()) {
+        WorkBlock.offb = int16_t(*(const int32_t*)PackedB);
+        PackedB = (const uint8_t*)PackedB + MLAS_QGEMM_U8S8_PACKED_HEADER_SIZE;
+    }
+
+    MlasQgemmSchedule(&WorkBlock, M, N, A, PackedB, C);
+}
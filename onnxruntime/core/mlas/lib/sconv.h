@@ -0,0 +1,532 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    sconv.h
+
+Abstract:
+
+    This module implements the single precision convolution kernels for the
+    NCHWc blocked layout as templates over the target vector instruction set.
+
+    The kernels are instantiated from the modules that are compiled for the
+    target instruction set, so this header must only be included by those
+    modules. The instruction set traits supply the vector type, the block
+    size, and the number of output columns that can be computed at once
+    without spilling the accumulators to memory.
+
+--*/
+
+#pragma once
+
+//
+// Stores the arguments passed to the convolution kernels.
+//
+
+struct MLAS_CONV_FLOAT_KERNEL_ARGS {
+    const float* Input;
+    const float* Filter;
+    float* Output;
+    size_t StrideWidth;
+    size_t DilationWidth;
+    size_t DilatedInputWidth;
+    size_t FilterStride;
+    size_t OutputStride;
+    size_t KernelHeight;
+    size_t KernelWidth;
+    size_t InputWidth;
+    size_t PaddingLeft;
+    const float* Bias;
+    unsigned KernelFlags;
+};
+
+template<typename Traits, size_t FilterCount, size_t OutputTile>
+inline
+void
+MlasConvPostProcessFloat(
+    const MLAS_CONV_FLOAT_KERNEL_ARGS* Args,
+    typename Traits::VectorType Accumulators[FilterCount][OutputTile],
+    size_t OutputIndex
+    )
+/*++
+
+Routine Description:
+
+    This routine applies the post processing selected by the kernel flags to
+    the accumulators and stores the results to the output buffer.
+
+Arguments:
+
+    Args - Supplies the kernel arguments.
+
+    Accumulators - Supplies the accumulators for each filter and column.
+
+    OutputIndex - Supplies the index of the first output column.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    typedef typename Traits::VectorType VectorType;
+
+    const unsigned KernelFlags = Args->KernelFlags;
+
+    for (size_t f = 0; f < FilterCount; f++) {
+
+        float* Output = Args->Output + f * Args->OutputStride + OutputIndex * Traits::BlockSize;
+
+        for (size_t t = 0; t < OutputTile; t++) {
+
+            VectorType Vector = Accumulators[f][t];
+
+            if ((KernelFlags & MLAS_CONV_KERNEL_FLAG_ACCUMULATE_OUTPUT) != 0) {
+                Vector = Traits::Add(Vector, Traits::Load(Output));
+            }
+
+            if ((KernelFlags & MLAS_CONV_KERNEL_FLAG_BIAS_ADDITION) != 0) {
+                Vector = Traits::Add(Vector, Traits::Load(Args->Bias + f * Traits::BlockSize));
+            }
+
+            if ((KernelFlags & MLAS_CONV_KERNEL_FLAG_RELU_ACTIVATION) != 0) {
+                Vector = Traits::Maximum(Vector, Traits::Zero());
+            }
+
+            Traits::Store(Output, Vector);
+
+            Output += Traits::BlockSize;
+        }
+    }
+}
+
+template<typename Traits, bool BlockedInput, size_t FilterCount, size_t OutputTile, bool CheckBounds>
+inline
+void
+MlasConvFloatComputeColumns(
+    const MLAS_CONV_FLOAT_KERNEL_ARGS* Args,
+    size_t OutputIndex
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a tile of output columns for a set of filter blocks.
+
+    For the NCHWc layout, each input channel of the input block is broadcast
+    and multiplied by the filter vector for that input channel. For the NCHW
+    layout, the input is a single channel plane.
+
+Arguments:
+
+    Args - Supplies the kernel arguments.
+
+    OutputIndex - Supplies the index of the first output column.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    typedef typename Traits::VectorType VectorType;
+
+    constexpr size_t BlockSize = Traits::BlockSize;
+    constexpr size_t InputBlockSize = BlockedInput ? BlockSize : 1;
+
+    VectorType Accumulators[FilterCount][OutputTile];
+
+    for (size_t f = 0; f < FilterCount; f++) {
+        for (size_t t = 0; t < OutputTile; t++) {
+            Accumulators[f][t] = Traits::Zero();
+        }
+    }
+
+    const size_t InputColumnStride = Args->StrideWidth * InputBlockSize;
+    const size_t FilterRowStride = Args->KernelWidth * InputBlockSize * BlockSize;
+    const size_t FirstInputColumn = OutputIndex * Args->StrideWidth;
+
+    const float* InputRow = Args->Input;
+    const float* FilterRow = Args->Filter;
+
+    for (size_t kh = 0; kh < Args->KernelHeight; kh++) {
+
+        for (size_t kw = 0; kw < Args->KernelWidth; kw++) {
+
+            //
+            // The interior columns are known to be inside the input row, so
+            // only the padding columns need to check for the padding region.
+            //
+
+            const size_t InputColumn = FirstInputColumn + kw * Args->DilationWidth;
+
+            if (CheckBounds) {
+                if (InputColumn < Args->PaddingLeft ||
+                    InputColumn - Args->PaddingLeft >= Args->InputWidth) {
+                    continue;
+                }
+            }
+
+            const float* Input = InputRow + (InputColumn - Args->PaddingLeft) * InputBlockSize;
+            const float* Filter = FilterRow + kw * InputBlockSize * BlockSize;
+
+            for (size_t bi = 0; bi < InputBlockSize; bi++) {
+
+                VectorType InputValues[OutputTile];
+
+                for (size_t t = 0; t < OutputTile; t++) {
+                    InputValues[t] = Traits::Broadcast(Input + t * InputColumnStride + bi);
+                }
+
+                for (size_t f = 0; f < FilterCount; f++) {
+
+                    VectorType FilterValue = Traits::Load(Filter + f * Args->FilterStride + bi * BlockSize);
+
+                    for (size_t t = 0; t < OutputTile; t++) {
+                        Accumulators[f][t] = Traits::MultiplyAdd(InputValues[t], FilterValue, Accumulators[f][t]);
+                    }
+                }
+            }
+        }
+
+        InputRow += Args->DilatedInputWidth;
+        FilterRow += FilterRowStride;
+    }
+
+    MlasConvPostProcessFloat<Traits, FilterCount, OutputTile>(Args, Accumulators, OutputIndex);
+}
+
+template<typename Traits, size_t OutputTile, bool CheckBounds>
+inline
+void
+MlasConvDepthwiseFloatComputeColumns(
+    const MLAS_CONV_FLOAT_KERNEL_ARGS* Args,
+    size_t OutputIndex
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a tile of output columns for a depthwise
+    convolution, where each channel of the block has its own filter.
+
+Arguments:
+
+    Args - Supplies the kernel arguments.
+
+    OutputIndex - Supplies the index of the first output column.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    typedef typename Traits::VectorType VectorType;
+
+    constexpr size_t BlockSize = Traits::BlockSize;
+
+    VectorType Accumulators[1][OutputTile];
+
+    for (size_t t = 0; t < OutputTile; t++) {
+        Accumulators[0][t] = Traits::Zero();
+    }
+
+    const size_t InputColumnStride = Args->StrideWidth * BlockSize;
+    const size_t FilterRowStride = Args->KernelWidth * BlockSize;
+    const size_t FirstInputColumn = OutputIndex * Args->StrideWidth;
+
+    const float* InputRow = Args->Input;
+    const float* FilterRow = Args->Filter;
+
+    for (size_t kh = 0; kh < Args->KernelHeight; kh++) {
+
+        for (size_t kw = 0; kw < Args->KernelWidth; kw++) {
+
+            const size_t InputColumn = FirstInputColumn + kw * Args->DilationWidth;
+
+            if (CheckBounds) {
+                if (InputColumn < Args->PaddingLeft ||
+                    InputColumn - Args->PaddingLeft >= Args->InputWidth) {
+                    continue;
+                }
+            }
+
+            const float* Input = InputRow + (InputColumn - Args->PaddingLeft) * BlockSize;
+
+            VectorType FilterValue = Traits::Load(FilterRow + kw * BlockSize);
+
+            for (size_t t = 0; t < OutputTile; t++) {
+                Accumulators[0][t] = Traits::MultiplyAdd(Traits::Load(Input + t * InputColumnStride),
+                    FilterValue, Accumulators[0][t]);
+            }
+        }
+
+        InputRow += Args->DilatedInputWidth;
+        FilterRow += FilterRowStride;
+    }
+
+    MlasConvPostProcessFloat<Traits, 1, OutputTile>(Args, Accumulators, OutputIndex);
+}
+
+template<typename Traits, bool BlockedInput, size_t FilterCount>
+void
+MlasConvFloatKernelFilterSet(
+    const MLAS_CONV_FLOAT_KERNEL_ARGS* Args,
+    size_t OutputCountLeftPad,
+    size_t OutputCount,
+    size_t OutputCountRightPad
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row for a set of filter blocks. The
+    columns that overlap the padding are computed one at a time with bounds
+    checking and the interior columns are computed in tiles.
+
+Arguments:
+
+    Args - Supplies the kernel arguments.
+
+    OutputCountLeftPad - Supplies the number of output columns that overlap
+        the left padding.
+
+    OutputCount - Supplies the number of interior output columns.
+
+    OutputCountRightPad - Supplies the number of output columns that overlap
+        the right padding.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    size_t OutputIndex = 0;
+
+    for (; OutputIndex < OutputCountLeftPad; OutputIndex++) {
+        MlasConvFloatComputeColumns<Traits, BlockedInput, FilterCount, 1, true>(Args, OutputIndex);
+    }
+
+    const size_t InteriorEnd = OutputCountLeftPad + OutputCount;
+
+    for (; OutputIndex + Traits::OutputTile <= InteriorEnd; OutputIndex += Traits::OutputTile) {
+        MlasConvFloatComputeColumns<Traits, BlockedInput, FilterCount, Traits::OutputTile, false>(Args, OutputIndex);
+    }
+
+    for (; OutputIndex < InteriorEnd; OutputIndex++) {
+        MlasConvFloatComputeColumns<Traits, BlockedInput, FilterCount, 1, false>(Args, OutputIndex);
+    }
+
+    const size_t OutputEnd = InteriorEnd + OutputCountRightPad;
+
+    for (; OutputIndex < OutputEnd; OutputIndex++) {
+        MlasConvFloatComputeColumns<Traits, BlockedInput, FilterCount, 1, true>(Args, OutputIndex);
+    }
+}
+
+template<typename Traits, bool BlockedInput>
+void
+MlasConvFloatKernel(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t DilatedInputWidth,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeft,
+    size_t OutputCountLeftPad,
+    size_t OutputCount,
+    size_t OutputCountRightPad,
+    const float* Bias,
+    unsigned KernelFlags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a convolution for up to four
+    filter blocks.
+
+Arguments:
+
+    Input - Supplies the address of the first column of the input row that
+        is aligned with the first valid kernel row.
+
+    Filter - Supplies the address of the first valid kernel row of the first
+        filter block.
+
+    Output - Supplies the address of the output row of the first filter
+        block.
+
+    StrideWidth - Supplies the horizontal stride in columns.
+
+    DilationWidth - Supplies the horizontal dilation in columns.
+
+    FilterCount - Supplies the number of filter blocks to process (1 to 4).
+
+    DilatedInputWidth - Supplies the number of elements between the input
+        rows of consecutive kernel rows.
+
+    FilterStride - Supplies the number of elements between filter blocks.
+
+    OutputStride - Supplies the number of elements between the output rows
+        of consecutive filter blocks.
+
+    KernelHeight - Supplies the number of valid kernel rows.
+
+    KernelWidth - Supplies the width of the kernel.
+
+    InputWidth - Supplies the number of columns of the input row.
+
+    PaddingLeft - Supplies the number of padding columns to the left of the
+        input row.
+
+    OutputCountLeftPad - Supplies the number of output columns that overlap
+        the left padding.
+
+    OutputCount - Supplies the number of interior output columns.
+
+    OutputCountRightPad - Supplies the number of output columns that overlap
+        the right padding.
+
+    Bias - Supplies the bias vector of the first filter block.
+
+    KernelFlags - Supplies the post processing flags.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_CONV_FLOAT_KERNEL_ARGS Args;
+
+    Args.Input = Input;
+    Args.Filter = Filter;
+    Args.Output = Output;
+    Args.StrideWidth = StrideWidth;
+    Args.DilationWidth = DilationWidth;
+    Args.DilatedInputWidth = DilatedInputWidth;
+    Args.FilterStride = FilterStride;
+    Args.OutputStride = OutputStride;
+    Args.KernelHeight = KernelHeight;
+    Args.KernelWidth = KernelWidth;
+    Args.InputWidth = InputWidth;
+    Args.PaddingLeft = PaddingLeft;
+    Args.Bias = Bias;
+    Args.KernelFlags = KernelFlags;
+
+    switch (FilterCount) {
+
+        case 1:
+            MlasConvFloatKernelFilterSet<Traits, BlockedInput, 1>(&Args, OutputCountLeftPad, OutputCount, OutputCountRightPad);
+            break;
+
+        case 2:
+            MlasConvFloatKernelFilterSet<Traits, BlockedInput, 2>(&Args, OutputCountLeftPad, OutputCount, OutputCountRightPad);
+            break;
+
+        case 3:
+            MlasConvFloatKernelFilterSet<Traits, BlockedInput, 3>(&Args, OutputCountLeftPad, OutputCount, OutputCountRightPad);
+            break;
+
+        default:
+            MlasConvFloatKernelFilterSet<Traits, BlockedInput, 4>(&Args, OutputCountLeftPad, OutputCount, OutputCountRightPad);
+            break;
+    }
+}
+
+template<typename Traits>
+void
+MlasConvDepthwiseFloatKernel(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t DilatedInputWidth,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeft,
+    size_t OutputCountLeftPad,
+    size_t OutputCount,
+    size_t OutputCountRightPad,
+    const float* Bias,
+    unsigned KernelFlags
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an output row of a depthwise convolution for a
+    single channel block.
+
+Arguments:
+
+    See MlasConvFloatKernel. The filter count and the filter stride are not
+    used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_UNREFERENCED_PARAMETER(FilterCount);
+    MLAS_UNREFERENCED_PARAMETER(FilterStride);
+
+    MLAS_CONV_FLOAT_KERNEL_ARGS Args;
+
+    Args.Input = Input;
+    Args.Filter = Filter;
+    Args.Output = Output;
+    Args.StrideWidth = StrideWidth;
+    Args.DilationWidth = DilationWidth;
+    Args.DilatedInputWidth = DilatedInputWidth;
+    Args.FilterStride = 0;
+    Args.OutputStride = OutputStride;
+    Args.KernelHeight = KernelHeight;
+    Args.KernelWidth = KernelWidth;
+    Args.InputWidth = InputWidth;
+    Args.PaddingLeft = PaddingLeft;
+    Args.Bias = Bias;
+    Args.KernelFlags = KernelFlags;
+
+    size_t OutputIndex = 0;
+
+    for (; OutputIndex < OutputCountLeftPad; OutputIndex++) {
+        MlasConvDepthwiseFloatComputeColumns<Traits, 1, true>(&Args, OutputIndex);
+    }
+
+    const size_t InteriorEnd = OutputCountLeftPad + OutputCount;
+
+    for (; OutputIndex + Traits::OutputTile <= InteriorEnd; OutputIndex += Traits::OutputTile) {
+        MlasConvDepthwiseFloatComputeColumns<Traits, Traits::OutputTile, false>(&Args, OutputIndex);
+    }
+
+    for (; OutputIndex < InteriorEnd; OutputIndex++) {
+        MlasConvDepthwiseFloatComputeColumns<Traits, 1, false>(&Args, OutputIndex);
+    }
+
+    const size_t OutputEnd = InteriorEnd + OutputCountRightPad;
+
+    for (; OutputIndex < OutputEnd; OutputIndex++) {
+        MlasConvDepthwiseFloatComputeColumns<Traits, 1, true>(&Args, OutputIndex);
+    }
+}
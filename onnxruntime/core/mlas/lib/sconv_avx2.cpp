@@ -0,0 +1,122 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    sconv_avx2.cpp
+
+Abstract:
+
+    This module implements the single precision convolution kernels for the
+    NCHWc blocked layout using AVX2 and FMA3 instructions.
+
+--*/
+
+#include "mlasi.h"
+#include "sconv.h"
+
+struct MLAS_CONV_AVX2_TRAITS {
+
+    typedef __m256 VectorType;
+
+    static constexpr size_t BlockSize = 8;
+    static constexpr size_t OutputTile = 3;
+
+    static VectorType Zero(void) { return _mm256_setzero_ps(); }
+    static VectorType Load(const float* Buffer) { return _mm256_loadu_ps(Buffer); }
+    static VectorType Broadcast(const float* Buffer) { return _mm256_broadcast_ss(Buffer); }
+    static void Store(float* Buffer, VectorType Vector) { _mm256_storeu_ps(Buffer, Vector); }
+    static VectorType Add(VectorType Vector1, VectorType Vector2) { return _mm256_add_ps(Vector1, Vector2); }
+    static VectorType Maximum(VectorType Vector1, VectorType Vector2) { return _mm256_max_ps(Vector1, Vector2); }
+    static VectorType MultiplyAdd(VectorType Vector1, VectorType Vector2, VectorType Vector3) { return _mm256_fmadd_ps(Vector1, Vector2, Vector3); }
+};
+
+void
+MLASCALL
+MlasConvNchwcFloatKernelAvx2(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t DilatedInputWidth,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeft,
+    size_t OutputCountLeftPad,
+    size_t OutputCount,
+    size_t OutputCountRightPad,
+    const float* Bias,
+    unsigned KernelFlags
+    )
+{
+    MlasConvFloatKernel<MLAS_CONV_AVX2_TRAITS, true>(Input, Filter, Output, StrideWidth,
+        DilationWidth, FilterCount, DilatedInputWidth, FilterStride, OutputStride, KernelHeight,
+        KernelWidth, InputWidth, PaddingLeft, OutputCountLeftPad, OutputCount, OutputCountRightPad,
+        Bias, KernelFlags);
+}
+
+void
+MLASCALL
+MlasConvNchwFloatKernelAvx2(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t DilatedInputWidth,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeft,
+    size_t OutputCountLeftPad,
+    size_t OutputCount,
+    size_t OutputCountRightPad,
+    const float* Bias,
+    unsigned KernelFlags
+    )
+{
+    MlasConvFloatKernel<MLAS_CONV_AVX2_TRAITS, false>(Input, Filter, Output, StrideWidth,
+        DilationWidth, FilterCount, DilatedInputWidth, FilterStride, OutputStride, KernelHeight,
+        KernelWidth, InputWidth, PaddingLeft, OutputCountLeftPad, OutputCount, OutputCountRightPad,
+        Bias, KernelFlags);
+}
+
+void
+MLASCALL
+MlasConvDepthwiseFloatKernelAvx2(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t DilatedInputWidth,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeft,
+    size_t OutputCountLeftPad,
+    size_t OutputCount,
+    size_t OutputCountRightPad,
+    const float* Bias,
+    unsigned KernelFlags
+    )
+{
+    MlasConvDepthwiseFloatKernel<MLAS_CONV_AVX2_TRAITS>(Input, Filter, Output, StrideWidth,
+        DilationWidth, FilterCount, DilatedInputWidth, FilterStride, OutputStride, KernelHeight,
+        KernelWidth, InputWidth, PaddingLeft, OutputCountLeftPad, OutputCount, OutputCountRightPad,
+        Bias, KernelFlags);
+}
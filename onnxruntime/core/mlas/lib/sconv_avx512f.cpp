@@ -0,0 +1,124 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    sconv_avx512f.cpp
+
+Abstract:
+
+    This module implements the single precision convolution kernels for the
+    NCHWc blocked layout using AVX512F instructions.
+
+--*/
+
+#include "mlasi.h"
+#include "sconv.h"
+
+struct MLAS_CONV_AVX512F_TRAITS {
+
+    typedef __m512 VectorType;
+
+    static constexpr size_t BlockSize = 16;
+    static constexpr size_t OutputTile = 6;
+
+    static VectorType Zero(void) { return _mm512_setzero_ps(); }
+    static VectorType Load(const float* Buffer) { return _mm512_loadu_ps(Buffer); }
+    static VectorType Broadcast(const float* Buffer) { return _mm512_set1_ps(*Buffer); }
+    static void Store(float* Buffer, VectorType Vector) { _mm512_storeu_ps(Buffer, Vector); }
+    static VectorType Add(VectorType Vector1, VectorType Vector2) { return _mm512_add_ps(Vector1, Vector2); }
+    // N.B. The zero masked form avoids a spurious uninitialized variable
+    // warning from the unmasked form in some versions of the GCC headers.
+    static VectorType Maximum(VectorType Vector1, VectorType Vector2) { return _mm512_maskz_max_ps(0xFFFF, Vector1, Vector2); }
+    static VectorType MultiplyAdd(VectorType Vector1, VectorType Vector2, VectorType Vector3) { return _mm512_fmadd_ps(Vector1, Vector2, Vector3); }
+};
+
+void
+MLASCALL
+MlasConvNchwcFloatKernelAvx512F(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t DilatedInputWidth,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeft,
+    size_t OutputCountLeftPad,
+    size_t OutputCount,
+    size_t OutputCountRightPad,
+    const float* Bias,
+    unsigned KernelFlags
+    )
+{
+    MlasConvFloatKernel<MLAS_CONV_AVX512F_TRAITS, true>(Input, Filter, Output, StrideWidth,
+        DilationWidth, FilterCount, DilatedInputWidth, FilterStride, OutputStride, KernelHeight,
+        KernelWidth, InputWidth, PaddingLeft, OutputCountLeftPad, OutputCount, OutputCountRightPad,
+        Bias, KernelFlags);
+}
+
+void
+MLASCALL
+MlasConvNchwFloatKernelAvx512F(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t DilatedInputWidth,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeft,
+    size_t OutputCountLeftPad,
+    size_t OutputCount,
+    size_t OutputCountRightPad,
+    const float* Bias,
+    unsigned KernelFlags
+    )
+{
+    MlasConvFloatKernel<MLAS_CONV_AVX512F_TRAITS, false>(Input, Filter, Output, StrideWidth,
+        DilationWidth, FilterCount, DilatedInputWidth, FilterStride, OutputStride, KernelHeight,
+        KernelWidth, InputWidth, PaddingLeft, OutputCountLeftPad, OutputCount, OutputCountRightPad,
+        Bias, KernelFlags);
+}
+
+void
+MLASCALL
+MlasConvDepthwiseFloatKernelAvx512F(
+    const float* Input,
+    const float* Filter,
+    float* Output,
+    size_t StrideWidth,
+    size_t DilationWidth,
+    size_t FilterCount,
+    size_t DilatedInputWidth,
+    size_t FilterStride,
+    size_t OutputStride,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t InputWidth,
+    size_t PaddingLeft,
+    size_t OutputCountLeftPad,
+    size_t OutputCount,
+    size_t OutputCountRightPad,
+    const float* Bias,
+    unsigned KernelFlags
+    )
+{
+    MlasConvDepthwiseFloatKernel<MLAS_CONV_AVX512F_TRAITS>(Input, Filter, Output, StrideWidth,
+        DilationWidth, FilterCount, DilatedInputWidth, FilterStride, OutputStride, KernelHeight,
+        KernelWidth, InputWidth, PaddingLeft, OutputCountLeftPad, OutputCount, OutputCountRightPad,
+        Bias, KernelFlags);
+}
@@ -40,12 +40,14 @@ struct MLAS_SGEMM_WORK_BLOCK {
     size_t ldc;
     float alpha;
     float beta;
+    const float* PackedB;
     struct SEGMENT {
         size_t M;
         size_t N;
         const float* A;
         const float* B;
         float* C;
+        size_t PackedStartN;
     } Segments[MLAS_MAXIMUM_THREAD_COUNT];
 };
 
@@ -772,6 +774,154 @@ Return Value:
     }
 }
 
+inline
+void
+MlasSgemmComputePanel(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t CountN,
+    size_t CountK,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* PanelB,
+    float* C,
+    size_t ldc,
+    bool UseKernelZeroRoutine
+    )
+/*++
+
+Routine Description:
+
+    This routine multiplies the rows of matrix A by a packed panel of matrix B
+    using the platform SGEMM kernels.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    CountN - Supplies the number of columns of the packed panel and matrix C.
+
+    CountK - Supplies the number of rows of the packed panel.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A, offset to the first element of the
+        current K slice.
+
+    lda - Supplies the first dimension of matrix A.
+
+    PanelB - Supplies the address of the packed panel of matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    UseKernelZeroRoutine - Supplies true if the existing contents of matrix C
+        should be overwritten, else false if the results are accumulated.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    float PanelA[MLAS_SGEMM_TRANSA_ROWS * MLAS_SGEMM_STRIDEK];
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+    PMLAS_SGEMM_KERNEL_ROUTINE SgemmKernelRoutine =
+        UseKernelZeroRoutine ? MlasPlatform.KernelZeroRoutine : MlasPlatform.KernelAddRoutine;
+#endif
+
+    //
+    // Step through each slice of matrix A along the M dimension.
+    //
+
+    float* c = C;
+
+    size_t RowsRemaining = M;
+    size_t RowsHandled;
+
+    if (TransA == CblasNoTrans) {
+
+        const float* a = A;
+
+        //
+        // Step through the rows of matrix A.
+        //
+
+        do {
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+            RowsHandled = SgemmKernelRoutine(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+#else
+            if (UseKernelZeroRoutine) {
+                RowsHandled = MlasSgemmKernelZero(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+            } else {
+                RowsHandled = MlasSgemmKernelAdd(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+            }
+#endif
+
+            c += ldc * RowsHandled;
+            a += lda * RowsHandled;
+
+            RowsRemaining -= RowsHandled;
+
+        } while (RowsRemaining > 0);
+
+    } else {
+
+        const float* a = A;
+
+        do {
+
+            //
+            // Transpose elements from matrix A into a local buffer.
+            //
+
+            size_t RowsTransposed = RowsRemaining;
+
+            if (RowsTransposed > MLAS_SGEMM_TRANSA_ROWS) {
+                RowsTransposed = MLAS_SGEMM_TRANSA_ROWS;
+            }
+
+            RowsRemaining -= RowsTransposed;
+
+            MlasSgemmTransposeA(PanelA, a, lda, RowsTransposed, CountK);
+
+            a += RowsTransposed;
+
+            //
+            // Step through the rows of the local buffer.
+            //
+
+            const float* pa = PanelA;
+
+            do {
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+                RowsHandled = SgemmKernelRoutine(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+#else
+                if (UseKernelZeroRoutine) {
+                    RowsHandled = MlasSgemmKernelZero(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+                } else {
+                    RowsHandled = MlasSgemmKernelAdd(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+                }
+#endif
+
+                c += ldc * RowsHandled;
+                pa += CountK * RowsHandled;
+
+                RowsTransposed -= RowsHandled;
+
+            } while (RowsTransposed > 0);
+
+        } while (RowsRemaining > 0);
+    }
+}
+
 void
 MlasSgemmOperation(
     CBLAS_TRANSPOSE TransA,
@@ -830,7 +980,6 @@ Return Value:
 
 --*/
 {
-    float PanelA[MLAS_SGEMM_TRANSA_ROWS * MLAS_SGEMM_STRIDEK];
     MLAS_DECLSPEC_ALIGN(float PanelB[MLAS_SGEMM_STRIDEN * MLAS_SGEMM_STRIDEK], 16 * sizeof(float));
 
     //
@@ -932,101 +1081,136 @@ Return Value:
             }
 
             //
-            // Select the kernel routine to use for this panel.
+            // Multiply the rows of matrix A by the packed panel of matrix B.
             //
 
-            bool UseKernelZeroRoutine = (k == 0 && beta == 0.0f);
+            const float* a = (TransA == CblasNoTrans) ? A + k : A + k * lda;
 
-#if defined(MLAS_TARGET_AMD64_IX86)
-            PMLAS_SGEMM_KERNEL_ROUTINE SgemmKernelRoutine =
-                UseKernelZeroRoutine ? MlasPlatform.KernelZeroRoutine : MlasPlatform.KernelAddRoutine;
-#endif
+            MlasSgemmComputePanel(TransA, M, CountN, CountK, alpha, a, lda,
+                PanelB, C + n, ldc, k == 0 && beta == 0.0f);
+        }
+    }
+}
 
-            //
-            // Step through each slice of matrix A along the M dimension.
-            //
+void
+MlasSgemmPackedOperation(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t RangeStartN,
+    size_t RangeCountN,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* PackedB,
+    size_t AlignedN,
+    float beta,
+    float* C,
+    size_t ldc
+    )
+/*++
 
-            float* c = C + n;
+Routine Description:
 
-            size_t RowsRemaining = M;
-            size_t RowsHandled;
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) using a matrix B that was packed by MlasSgemmPackB.
 
-            if (TransA == CblasNoTrans) {
+Arguments:
 
-                const float* a = A + k;
+    TransA - Supplies the transpose operation for matrix A.
 
-                //
-                // Step through the rows of matrix A.
-                //
+    M - Supplies the number of rows of matrix A and matrix C.
 
-                do {
+    RangeStartN - Supplies the starting column from the packed matrix B. The
+        value must be a multiple of 16.
 
-#if defined(MLAS_TARGET_AMD64_IX86)
-                    RowsHandled = SgemmKernelRoutine(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-#else
-                    if (UseKernelZeroRoutine) {
-                        RowsHandled = MlasSgemmKernelZero(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-                    } else {
-                        RowsHandled = MlasSgemmKernelAdd(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-                    }
-#endif
+    RangeCountN - Supplies the number of columns of the packed matrix B and
+        matrix C to process.
 
-                    c += ldc * RowsHandled;
-                    a += lda * RowsHandled;
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
 
-                    RowsRemaining -= RowsHandled;
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
 
-                } while (RowsRemaining > 0);
+    A - Supplies the address of matrix A.
 
-            } else {
+    lda - Supplies the first dimension of matrix A.
 
-                const float* a = A + k * lda;
+    PackedB - Supplies the address of the packed matrix B.
 
-                do {
+    AlignedN - Supplies the number of columns of the packed matrix B rounded
+        up to a multiple of 16.
 
-                    //
-                    // Transpose elements from matrix A into a local buffer.
-                    //
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
 
-                    size_t RowsTransposed = RowsRemaining;
+    C - Supplies the address of matrix C, offset to the column RangeStartN.
 
-                    if (RowsTransposed > MLAS_SGEMM_TRANSA_ROWS) {
-                        RowsTransposed = MLAS_SGEMM_TRANSA_ROWS;
-                    }
+    ldc - Supplies the first dimension of matrix C.
 
-                    RowsRemaining -= RowsTransposed;
+Return Value:
 
-                    MlasSgemmTransposeA(PanelA, a, lda, RowsTransposed, CountK);
+    None.
 
-                    a += RowsTransposed;
+--*/
+{
+    //
+    // Compute the strides to step through slices of the input matrices.
+    //
+    // The K stride is fixed by the layout of the packed buffer. Expand the N
+    // stride if K is small for better utilization of the packed panel.
+    //
 
-                    //
-                    // Step through the rows of the local buffer.
-                    //
+    size_t StrideN = MLAS_SGEMM_STRIDEN;
+    size_t StrideK = MLAS_SGEMM_STRIDEK;
 
-                    const float* pa = PanelA;
+    while (StrideK / 2 >= K && StrideK > 1) {
+        StrideN *= 2;
+        StrideK /= 2;
+    }
 
-                    do {
+    //
+    // Step through each slice of matrix B along the N dimension.
+    //
 
-#if defined(MLAS_TARGET_AMD64_IX86)
-                        RowsHandled = SgemmKernelRoutine(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-#else
-                        if (UseKernelZeroRoutine) {
-                            RowsHandled = MlasSgemmKernelZero(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-                        } else {
-                            RowsHandled = MlasSgemmKernelAdd(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-                        }
-#endif
+    size_t CountN;
+    size_t CountK;
 
-                        c += ldc * RowsHandled;
-                        pa += CountK * RowsHandled;
+    for (size_t n = 0; n < RangeCountN; n += CountN) {
 
-                        RowsTransposed -= RowsHandled;
+        CountN = StrideN;
 
-                    } while (RowsTransposed > 0);
+        if (CountN > (RangeCountN - n)) {
+            CountN = RangeCountN - n;
+        }
+
+        //
+        // Multiply the output matrix by beta as needed.
+        //
 
-                } while (RowsRemaining > 0);
+        if (beta != 0.0f && beta != 1.0f) {
+            MlasSgemmMultiplyBeta(C + n, M, CountN, ldc, beta);
+        }
+
+        //
+        // Step through each slice of matrix B along the K dimension. Each
+        // slice of the packed buffer stores MLAS_SGEMM_STRIDEK rows for all
+        // of the columns in blocks of 16 columns.
+        //
+
+        for (size_t k = 0; k < K; k += CountK) {
+
+            CountK = MLAS_SGEMM_STRIDEK;
+
+            if (CountK > (K - k)) {
+                CountK = K - k;
             }
+
+            const float* PanelB = PackedB + k * AlignedN + (RangeStartN + n) * CountK;
+
+            const float* a = (TransA == CblasNoTrans) ? A + k : A + k * lda;
+
+            MlasSgemmComputePanel(TransA, M, CountN, CountK, alpha, a, lda,
+                PanelB, C + n, ldc, k == 0 && beta == 0.0f);
         }
     }
 }
@@ -1059,10 +1243,20 @@ Return Value:
 
     MLAS_SGEMM_WORK_BLOCK::SEGMENT* Segment = &WorkBlock->Segments[Index];
 
-    MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, Segment->M,
-        Segment->N, WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
-        Segment->B, WorkBlock->ldb, WorkBlock->beta, Segment->C,
-        WorkBlock->ldc);
+    if (WorkBlock->PackedB != nullptr) {
+
+        MlasSgemmPackedOperation(WorkBlock->TransA, Segment->M,
+            Segment->PackedStartN, Segment->N, WorkBlock->K, WorkBlock->alpha,
+            Segment->A, WorkBlock->lda, WorkBlock->PackedB, WorkBlock->ldb,
+            WorkBlock->beta, Segment->C, WorkBlock->ldc);
+
+    } else {
+
+        MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, Segment->M,
+            Segment->N, WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
+            Segment->B, WorkBlock->ldb, WorkBlock->beta, Segment->C,
+            WorkBlock->ldc);
+    }
 }
 
 inline
@@ -1078,6 +1272,7 @@ MlasSgemmTryMultithread(
     size_t lda,
     const float* B,
     size_t ldb,
+    const float* PackedB,
     float beta,
     float* C,
     size_t ldc
@@ -1110,7 +1305,12 @@ Arguments:
 
     B - Supplies the address of matrix B.
 
-    ldb - Supplies the first dimension of matrix B.
+    ldb - Supplies the first dimension of matrix B. If PackedB is not null,
+        supplies the number of columns of the packed matrix B rounded up to a
+        multiple of 16.
+
+    PackedB - Optionally supplies the address of matrix B packed by
+        MlasSgemmPackB. If specified, B and TransB are ignored.
 
     beta - Supplies the scaler beta multiplier (see SGEMM definition).
 
@@ -1166,6 +1366,7 @@ Return Value:
     WorkBlock.ldc = ldc;
     WorkBlock.alpha = alpha;
     WorkBlock.beta = beta;
+    WorkBlock.PackedB = PackedB;
 
     //
     // Segment the operation across multiple threads.
@@ -1197,8 +1398,9 @@ Return Value:
             WorkBlock.Segments[Index].M = M;
             WorkBlock.Segments[Index].N = CountN;
             WorkBlock.Segments[Index].A = A;
-            WorkBlock.Segments[Index].B = B + n * pldb;
+            WorkBlock.Segments[Index].B = (B != nullptr) ? B + n * pldb : nullptr;
             WorkBlock.Segments[Index].C = C + n;
+            WorkBlock.Segments[Index].PackedStartN = n;
 
             Index++;
         }
@@ -1226,6 +1428,7 @@ Return Value:
             WorkBlock.Segments[Index].A = A + m * plda;
             WorkBlock.Segments[Index].B = B;
             WorkBlock.Segments[Index].C = C + m * ldc;
+            WorkBlock.Segments[Index].PackedStartN = 0;
 
             Index++;
         }
@@ -1251,6 +1454,7 @@ Return Value:
     MLAS_UNREFERENCED_PARAMETER(lda);
     MLAS_UNREFERENCED_PARAMETER(B);
     MLAS_UNREFERENCED_PARAMETER(ldb);
+    MLAS_UNREFERENCED_PARAMETER(PackedB);
     MLAS_UNREFERENCED_PARAMETER(beta);
     MLAS_UNREFERENCED_PARAMETER(C);
     MLAS_UNREFERENCED_PARAMETER(ldc);
@@ -1325,7 +1529,171 @@ Return Value:
     // single thread based on the GEMM parameters and system configuration.
     //
 
-    if (!MlasSgemmTryMultithread(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc)) {
+    if (!MlasSgemmTryMultithread(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, nullptr, beta, C, ldc)) {
         MlasSgemmOperation(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
     }
 }
+
+size_t
+MLASCALL
+MlasSgemmPackBSize(
+    size_t N,
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the number of bytes required to pack matrix B with
+    MlasSgemmPackB.
+
+Arguments:
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+Return Value:
+
+    Returns the size of the packed buffer in bytes.
+
+--*/
+{
+    const size_t AlignedN = (N + 15) & ~size_t(15);
+
+    return AlignedN * K * sizeof(float);
+}
+
+void
+MLASCALL
+MlasSgemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine packs the contents of matrix B to the layout consumed by the
+    SGEMM kernels, so that the packing cost is not paid by every call to
+    MlasSgemmPacked.
+
+    The packed buffer is organized as slices of MLAS_SGEMM_STRIDEK rows. Each
+    slice stores all of the columns of matrix B in zero-padded blocks of 16
+    columns, using the same layout as the local panel of MlasSgemmOperation.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    PackedB - Supplies the address of the packed buffer. The buffer must be at
+        least MlasSgemmPackBSize bytes and be aligned to 64 bytes.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedN = (N + 15) & ~size_t(15);
+
+    float* D = (float*)PackedB;
+
+    size_t CountK;
+
+    for (size_t k = 0; k < K; k += CountK) {
+
+        CountK = MLAS_SGEMM_STRIDEK;
+
+        if (CountK > (K - k)) {
+            CountK = K - k;
+        }
+
+        if (TransB == CblasNoTrans) {
+            MlasSgemmCopyPackB(D, B + k * ldb, ldb, N, CountK);
+        } else {
+            MlasSgemmTransposePackB(D, B + k, ldb, N, CountK);
+        }
+
+        D += AlignedN * CountK;
+    }
+}
+
+void
+MLASCALL
+MlasSgemmPacked(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) using a matrix B that was packed by MlasSgemmPackB.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    PackedB - Supplies the address of the packed matrix B.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedN = (N + 15) & ~size_t(15);
+
+    //
+    // Try to run the operation across multiple threads or fall back to a
+    // single thread based on the GEMM parameters and system configuration.
+    //
+
+    if (!MlasSgemmTryMultithread(TransA, CblasNoTrans, M, N, K, alpha, A, lda,
+        nullptr, AlignedN, (const float*)PackedB, beta, C, ldc)) {
+        MlasSgemmPackedOperation(TransA, M, 0, N, K, alpha, A, lda,
+            (const float*)PackedB, AlignedN, beta, C, ldc);
+    }
+}
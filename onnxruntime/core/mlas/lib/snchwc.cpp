@@ -0,0 +1,973 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    snchwc.cpp
+
+Abstract:
+
+    This module implements the single precision operations using the NCHWc
+    blocked layout.
+
+    The channels of a tensor are split into blocks of the platform block size
+    and the channels of a block are stored contiguously for each spatial
+    position. A convolution then computes a full block of output channels
+    with vector instructions for each output position, broadcasting one input
+    channel at a time, without expanding the input to a matrix.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the maximum block size supported by any platform.
+//
+
+#define MLAS_NCHWC_MAXIMUM_BLOCK_SIZE               16
+
+//
+// Define the number of filter blocks computed by a single kernel invocation.
+//
+
+#define MLAS_NCHWC_FILTER_SET_SIZE                  4
+
+//
+// Define the convolution algorithms for the NCHWc layout.
+//
+
+enum MLAS_NCHWC_CONV_ALGORITHM {
+    MlasNchwcConvAlgorithmNchwc,
+    MlasNchwcConvAlgorithmNchw,
+    MlasNchwcConvAlgorithmDepthwise,
+};
+
+//
+// Define the parameters to execute segments of a NCHWc convolution on worker
+// threads.
+//
+
+struct MLAS_NCHWC_CONV_WORK_BLOCK {
+    int32_t TargetThreadCount;
+    MLAS_NCHWC_CONV_ALGORITHM Algorithm;
+    PMLAS_CONV_FLOAT_KERNEL Kernel;
+    const float* Input;
+    const float* Filter;
+    const float* Bias;
+    float* Output;
+    const MLAS_ACTIVATION* Activation;
+    bool ZeroMode;
+    size_t BatchCount;
+    size_t GroupCount;
+    size_t InputBlockCount;
+    size_t FilterBlockCount;
+    size_t InputShape[2];
+    size_t KernelShape[2];
+    size_t DilationShape[2];
+    size_t Padding[4];
+    size_t StrideShape[2];
+    size_t OutputShape[2];
+    size_t OutputCountLeftPad;
+    size_t OutputCount;
+    size_t OutputCountRightPad;
+};
+
+//
+// Define the parameters to execute segments of a NCHWc pooling operation on
+// worker threads.
+//
+
+struct MLAS_NCHWC_POOL_WORK_BLOCK {
+    int32_t TargetThreadCount;
+    MLAS_POOLING_KIND PoolingKind;
+    const float* Input;
+    float* Output;
+    size_t BatchCount;
+    size_t ChannelBlockCount;
+    size_t InputShape[2];
+    size_t KernelShape[2];
+    size_t Padding[4];
+    size_t StrideShape[2];
+    size_t OutputShape[2];
+};
+
+size_t
+MLASCALL
+MlasNchwcGetBlockSize(
+    void
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the NCHWc block size for the platform.
+
+Arguments:
+
+    None.
+
+Return Value:
+
+    Returns the NCHWc block size for the platform. If NCHWc support is not
+    available for the platform, then returns one.
+
+--*/
+{
+    return MlasPlatform.NchwcBlockSize;
+}
+
+void
+MlasNchwcPartitionWork(
+    size_t TotalWork,
+    int32_t TargetThreadCount,
+    int32_t Index,
+    size_t* WorkIndex,
+    size_t* WorkRemaining
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the range of work items to use for a thread.
+
+Arguments:
+
+    TotalWork - Supplies the total number of work items.
+
+    TargetThreadCount - Supplies the number of threads executing the
+        operation.
+
+    Index - Supplies the index of the thread.
+
+    WorkIndex - Receives the index of the first work item for the thread.
+
+    WorkRemaining - Receives the number of work items for the thread.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t WorkPerThread = TotalWork / size_t(TargetThreadCount);
+    const size_t WorkPerThreadExtra = TotalWork % size_t(TargetThreadCount);
+
+    if (uint32_t(Index) < WorkPerThreadExtra) {
+        *WorkIndex = (WorkPerThread + 1) * Index;
+        *WorkRemaining = WorkPerThread + 1;
+    } else {
+        *WorkIndex = WorkPerThread * Index + WorkPerThreadExtra;
+        *WorkRemaining = WorkPerThread;
+    }
+}
+
+void
+MlasNchwcConvThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    NCHWc convolution operation.
+
+    The work is partitioned by output row. Each output row is computed for a
+    set of filter blocks by invoking the kernel once per input block, with
+    the post processing applied after the last input block.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_NCHWC_CONV_WORK_BLOCK* WorkBlock = (const MLAS_NCHWC_CONV_WORK_BLOCK*)Context;
+
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t InputHeight = WorkBlock->InputShape[0];
+    const size_t InputWidth = WorkBlock->InputShape[1];
+    const size_t KernelHeight = WorkBlock->KernelShape[0];
+    const size_t KernelWidth = WorkBlock->KernelShape[1];
+    const size_t DilationHeight = WorkBlock->DilationShape[0];
+    const size_t PaddingTop = WorkBlock->Padding[0];
+    const size_t StrideHeight = WorkBlock->StrideShape[0];
+    const size_t OutputHeight = WorkBlock->OutputShape[0];
+    const size_t OutputWidth = WorkBlock->OutputShape[1];
+
+    const size_t GroupCount = WorkBlock->GroupCount;
+    const size_t InputBlockCount = WorkBlock->InputBlockCount;
+    const size_t FilterBlockCount = WorkBlock->FilterBlockCount;
+    const size_t FilterSetCount = (FilterBlockCount + MLAS_NCHWC_FILTER_SET_SIZE - 1) /
+        MLAS_NCHWC_FILTER_SET_SIZE;
+
+    //
+    // The NCHW algorithm reads a single channel plane per input block and
+    // the depthwise algorithm has a filter vector per kernel position.
+    //
+
+    const size_t InputElementSize =
+        (WorkBlock->Algorithm == MlasNchwcConvAlgorithmNchw) ? 1 : BlockSize;
+    const size_t FilterInputBlockSize =
+        (WorkBlock->Algorithm == MlasNchwcConvAlgorithmNchwc) ? BlockSize : 1;
+
+    const size_t InputPlaneSize = InputHeight * InputWidth * InputElementSize;
+    const size_t FilterInputBlockStride = KernelHeight * KernelWidth * FilterInputBlockSize * BlockSize;
+    const size_t FilterBlockStride = InputBlockCount * FilterInputBlockStride;
+    const size_t OutputPlaneSize = OutputHeight * OutputWidth * BlockSize;
+    const size_t OutputRowSize = OutputWidth * BlockSize;
+    const size_t DilatedInputWidth = DilationHeight * InputWidth * InputElementSize;
+
+    const MLAS_ACTIVATION_KIND ActivationKind = WorkBlock->Activation->ActivationKind;
+
+    //
+    // Compute the range of output rows to use for this thread.
+    //
+
+    const size_t TotalWork = WorkBlock->BatchCount * GroupCount * FilterSetCount * OutputHeight;
+
+    size_t WorkIndex;
+    size_t WorkRemaining;
+
+    MlasNchwcPartitionWork(TotalWork, WorkBlock->TargetThreadCount, Index, &WorkIndex, &WorkRemaining);
+
+    for (; WorkRemaining > 0; WorkRemaining--, WorkIndex++) {
+
+        const size_t ph = WorkIndex % OutputHeight;
+        const size_t FilterSet = (WorkIndex / OutputHeight) % FilterSetCount;
+        const size_t BatchGroup = WorkIndex / (OutputHeight * FilterSetCount);
+        const size_t Group = BatchGroup % GroupCount;
+
+        const size_t FilterBlockIndex = FilterSet * MLAS_NCHWC_FILTER_SET_SIZE;
+        size_t FilterCount = FilterBlockCount - FilterBlockIndex;
+
+        if (FilterCount > MLAS_NCHWC_FILTER_SET_SIZE) {
+            FilterCount = MLAS_NCHWC_FILTER_SET_SIZE;
+        }
+
+        //
+        // Clip the kernel rows to the rows of the input.
+        //
+
+        const ptrdiff_t ihStart = ptrdiff_t(ph * StrideHeight) - ptrdiff_t(PaddingTop);
+
+        size_t khStart = 0;
+        size_t khEnd = KernelHeight;
+
+        while (khStart < khEnd && ihStart + ptrdiff_t(khStart * DilationHeight) < 0) {
+            khStart++;
+        }
+
+        while (khEnd > khStart && ihStart + ptrdiff_t((khEnd - 1) * DilationHeight) >= ptrdiff_t(InputHeight)) {
+            khEnd--;
+        }
+
+        size_t InputRowOffset = 0;
+
+        if (khEnd > khStart) {
+            InputRowOffset = size_t(ihStart + ptrdiff_t(khStart * DilationHeight)) * InputWidth * InputElementSize;
+        }
+
+        const float* input = WorkBlock->Input + BatchGroup * InputBlockCount * InputPlaneSize + InputRowOffset;
+        const float* filter = WorkBlock->Filter + (Group * FilterBlockCount + FilterBlockIndex) * FilterBlockStride +
+            khStart * KernelWidth * FilterInputBlockSize * BlockSize;
+        float* output = WorkBlock->Output + (BatchGroup * FilterBlockCount + FilterBlockIndex) * OutputPlaneSize +
+            ph * OutputRowSize;
+
+        const float* bias = WorkBlock->Bias;
+
+        if (bias != nullptr) {
+            bias += (Group * FilterBlockCount + FilterBlockIndex) * BlockSize;
+        }
+
+        //
+        // Accumulate the contribution of each input block to the output row.
+        //
+
+        for (size_t ib = 0; ib < InputBlockCount; ib++) {
+
+            unsigned KernelFlags = 0;
+
+            if (ib > 0 || !WorkBlock->ZeroMode) {
+                KernelFlags |= MLAS_CONV_KERNEL_FLAG_ACCUMULATE_OUTPUT;
+            }
+
+            if (ib + 1 == InputBlockCount) {
+
+                if (bias != nullptr) {
+                    KernelFlags |= MLAS_CONV_KERNEL_FLAG_BIAS_ADDITION;
+                }
+
+                if (ActivationKind == MlasReluActivation) {
+                    KernelFlags |= MLAS_CONV_KERNEL_FLAG_RELU_ACTIVATION;
+                }
+            }
+
+            WorkBlock->Kernel(input, filter, output, WorkBlock->StrideShape[1],
+                WorkBlock->DilationShape[1], FilterCount, DilatedInputWidth,
+                FilterBlockStride, OutputPlaneSize, khEnd - khStart, KernelWidth,
+                InputWidth, WorkBlock->Padding[1], WorkBlock->OutputCountLeftPad,
+                WorkBlock->OutputCount, WorkBlock->OutputCountRightPad, bias, KernelFlags);
+
+            input += InputPlaneSize;
+            filter += FilterInputBlockStride;
+        }
+
+        //
+        // Apply the activations that are not handled by the kernel.
+        //
+
+        if (ActivationKind != MlasIdentityActivation && ActivationKind != MlasReluActivation) {
+            for (size_t f = 0; f < FilterCount; f++) {
+                float* OutputRow = output + f * OutputPlaneSize;
+                MlasActivation(WorkBlock->Activation, OutputRow, nullptr, 1, OutputRow, OutputRowSize, OutputRowSize);
+            }
+        }
+    }
+}
+
+void
+MLASCALL
+MlasNchwcConv(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    size_t GroupCount,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    const MLAS_ACTIVATION* Activation,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the NCHWc convolution operation.
+
+    The algorithm is selected from the shapes:
+
+    - For a depthwise convolution (the group count, the input channels and
+      the output channels are equal), the input and output are in NCHWc
+      layout and the filter is reordered by MlasReorderFilterOIHWBo.
+
+    - For a single group with fewer input channels than the block size, the
+      input is in NCHW layout, the output is in NCHWc layout and the filter
+      is reordered by MlasReorderFilterOIHWBo.
+
+    - Otherwise, the input and output are in NCHWc layout and the filter is
+      reordered by MlasReorderFilterOIHWBiBo. The input and output channels
+      of each group must be a multiple of the block size.
+
+Arguments:
+
+    InputShape - Supplies the shape of the input tensor (N, C, H, W).
+
+    KernelShape - Supplies the shape of the kernel transformation.
+
+    DilationShape - Supplies the shape of the dilation.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor (top, left, bottom, right).
+
+    StrideShape - Supplies the shape of the stride.
+
+    OutputShape - Supplies the shape of the output tensor (N, C, H, W).
+
+    GroupCount - Supplies the number of channel groups.
+
+    Input - Supplies the input tensor.
+
+    Filter - Supplies the reordered filter tensor.
+
+    Bias - Supplies the optional bias vector, padded to the output channels.
+
+    Output - Supplies the output tensor.
+
+    Activation - Supplies the parameters for the activation to apply to the
+        convolution output.
+
+    ZeroMode - Supplies true if the output tensor must be zero initialized
+        first, else false if the convolution is added to the existing output.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    MLAS_NCHWC_CONV_WORK_BLOCK WorkBlock;
+
+    WorkBlock.Input = Input;
+    WorkBlock.Filter = Filter;
+    WorkBlock.Bias = Bias;
+    WorkBlock.Output = Output;
+    WorkBlock.Activation = Activation;
+    WorkBlock.ZeroMode = ZeroMode;
+    WorkBlock.BatchCount = size_t(InputShape[0]);
+
+    for (size_t dim = 0; dim < 2; dim++) {
+        WorkBlock.InputShape[dim] = size_t(InputShape[dim + 2]);
+        WorkBlock.KernelShape[dim] = size_t(KernelShape[dim]);
+        WorkBlock.DilationShape[dim] = size_t(DilationShape[dim]);
+        WorkBlock.Padding[dim] = size_t(Padding[dim]);
+        WorkBlock.Padding[dim + 2] = size_t(Padding[dim + 2]);
+        WorkBlock.StrideShape[dim] = size_t(StrideShape[dim]);
+        WorkBlock.OutputShape[dim] = size_t(OutputShape[dim + 2]);
+    }
+
+    const size_t InputChannels = size_t(InputShape[1]);
+    const size_t FilterCount = size_t(OutputShape[1]);
+
+    if (GroupCount > 1 && InputChannels == GroupCount && FilterCount == GroupCount) {
+
+        WorkBlock.Algorithm = MlasNchwcConvAlgorithmDepthwise;
+        WorkBlock.Kernel = MlasPlatform.ConvDepthwiseFloatKernel;
+        WorkBlock.GroupCount = InputChannels / BlockSize;
+        WorkBlock.InputBlockCount = 1;
+        WorkBlock.FilterBlockCount = 1;
+
+    } else if (InputChannels < BlockSize) {
+
+        WorkBlock.Algorithm = MlasNchwcConvAlgorithmNchw;
+        WorkBlock.Kernel = MlasPlatform.ConvNchwFloatKernel;
+        WorkBlock.GroupCount = 1;
+        WorkBlock.InputBlockCount = InputChannels;
+        WorkBlock.FilterBlockCount = FilterCount / BlockSize;
+
+    } else {
+
+        WorkBlock.Algorithm = MlasNchwcConvAlgorithmNchwc;
+        WorkBlock.Kernel = MlasPlatform.ConvNchwcFloatKernel;
+        WorkBlock.GroupCount = GroupCount;
+        WorkBlock.InputBlockCount = InputChannels / GroupCount / BlockSize;
+        WorkBlock.FilterBlockCount = FilterCount / GroupCount / BlockSize;
+    }
+
+    //
+    // Compute the number of output columns that overlap the left padding,
+    // the interior columns that can be computed without bounds checking, and
+    // the remaining columns that overlap the right padding.
+    //
+
+    const size_t InputWidth = WorkBlock.InputShape[1];
+    const size_t PaddingLeft = WorkBlock.Padding[1];
+    const size_t StrideWidth = WorkBlock.StrideShape[1];
+    const size_t OutputWidth = WorkBlock.OutputShape[1];
+    const size_t SpanWidth = WorkBlock.DilationShape[1] * (WorkBlock.KernelShape[1] - 1) + 1;
+
+    size_t OutputCountLeftPad = (PaddingLeft + StrideWidth - 1) / StrideWidth;
+
+    if (OutputCountLeftPad > OutputWidth) {
+        OutputCountLeftPad = OutputWidth;
+    }
+
+    size_t InteriorEnd = 0;
+
+    if (InputWidth + PaddingLeft >= SpanWidth) {
+        InteriorEnd = (InputWidth + PaddingLeft - SpanWidth) / StrideWidth + 1;
+        if (InteriorEnd > OutputWidth) {
+            InteriorEnd = OutputWidth;
+        }
+    }
+
+    if (InteriorEnd < OutputCountLeftPad) {
+        InteriorEnd = OutputCountLeftPad;
+    }
+
+    WorkBlock.OutputCountLeftPad = OutputCountLeftPad;
+    WorkBlock.OutputCount = InteriorEnd - OutputCountLeftPad;
+    WorkBlock.OutputCountRightPad = OutputWidth - InteriorEnd;
+
+    //
+    // Schedule the output rows across multiple threads.
+    //
+
+    const size_t FilterSetCount = (WorkBlock.FilterBlockCount + MLAS_NCHWC_FILTER_SET_SIZE - 1) /
+        MLAS_NCHWC_FILTER_SET_SIZE;
+    const size_t TotalWork = WorkBlock.BatchCount * WorkBlock.GroupCount * FilterSetCount *
+        WorkBlock.OutputShape[0];
+
+    int32_t TargetThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (size_t(TargetThreadCount) >= TotalWork) {
+        TargetThreadCount = int32_t(TotalWork);
+    }
+
+    if (TargetThreadCount == 0) {
+        return;
+    }
+
+    WorkBlock.TargetThreadCount = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasNchwcConvThreaded, &WorkBlock, TargetThreadCount);
+}
+
+void
+MlasNchwcPoolThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    NCHWc pooling operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_NCHWC_POOL_WORK_BLOCK* WorkBlock = (const MLAS_NCHWC_POOL_WORK_BLOCK*)Context;
+
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+    const size_t BlockVectorCount = BlockSize / 4;
+
+    const size_t InputHeight = WorkBlock->InputShape[0];
+    const size_t InputWidth = WorkBlock->InputShape[1];
+    const size_t KernelHeight = WorkBlock->KernelShape[0];
+    const size_t KernelWidth = WorkBlock->KernelShape[1];
+    const size_t PaddingTop = WorkBlock->Padding[0];
+    const size_t PaddingLeft = WorkBlock->Padding[1];
+    const size_t StrideHeight = WorkBlock->StrideShape[0];
+    const size_t StrideWidth = WorkBlock->StrideShape[1];
+    const size_t OutputHeight = WorkBlock->OutputShape[0];
+    const size_t OutputWidth = WorkBlock->OutputShape[1];
+
+    const size_t InputPlaneSize = InputHeight * InputWidth * BlockSize;
+    const size_t OutputPlaneSize = OutputHeight * OutputWidth * BlockSize;
+
+    const MLAS_POOLING_KIND PoolingKind = WorkBlock->PoolingKind;
+
+    const MLAS_FLOAT32X4 KernelSizeBroadcast = MlasBroadcastFloat32x4(float(unsigned(KernelHeight * KernelWidth)));
+
+    //
+    // Compute the range of output rows to use for this thread.
+    //
+
+    const size_t TotalWork = WorkBlock->BatchCount * WorkBlock->ChannelBlockCount * OutputHeight;
+
+    size_t WorkIndex;
+    size_t WorkRemaining;
+
+    MlasNchwcPartitionWork(TotalWork, WorkBlock->TargetThreadCount, Index, &WorkIndex, &WorkRemaining);
+
+    for (; WorkRemaining > 0; WorkRemaining--, WorkIndex++) {
+
+        const size_t ph = WorkIndex % OutputHeight;
+        const size_t Plane = WorkIndex / OutputHeight;
+
+        const float* input = WorkBlock->Input + Plane * InputPlaneSize;
+        float* output = WorkBlock->Output + Plane * OutputPlaneSize + ph * OutputWidth * BlockSize;
+
+        const ptrdiff_t ihStart = ptrdiff_t(ph * StrideHeight) - ptrdiff_t(PaddingTop);
+        const size_t ihBegin = size_t(std::max<ptrdiff_t>(ihStart, 0));
+        const size_t ihEnd = size_t(std::min<ptrdiff_t>(ihStart + ptrdiff_t(KernelHeight), ptrdiff_t(InputHeight)));
+
+        for (size_t pw = 0; pw < OutputWidth; pw++) {
+
+            const ptrdiff_t iwStart = ptrdiff_t(pw * StrideWidth) - ptrdiff_t(PaddingLeft);
+            const size_t iwBegin = size_t(std::max<ptrdiff_t>(iwStart, 0));
+            const size_t iwEnd = size_t(std::min<ptrdiff_t>(iwStart + ptrdiff_t(KernelWidth), ptrdiff_t(InputWidth)));
+
+            MLAS_FLOAT32X4 Reduction[MLAS_NCHWC_MAXIMUM_BLOCK_SIZE / 4];
+
+            for (size_t v = 0; v < BlockVectorCount; v++) {
+                if (PoolingKind == MlasMaximumPooling) {
+                    Reduction[v] = MlasBroadcastFloat32x4(std::numeric_limits<float>::lowest());
+                } else {
+                    Reduction[v] = MlasZeroFloat32x4();
+                }
+            }
+
+            for (size_t ih = ihBegin; ih < ihEnd; ih++) {
+
+                const float* InputRow = input + (ih * InputWidth + iwBegin) * BlockSize;
+
+                for (size_t iw = iwBegin; iw < iwEnd; iw++) {
+
+                    for (size_t v = 0; v < BlockVectorCount; v++) {
+
+                        MLAS_FLOAT32X4 InputValue = MlasLoadFloat32x4(InputRow + v * 4);
+
+                        if (PoolingKind == MlasMaximumPooling) {
+                            Reduction[v] = MlasMaximumFloat32x4(Reduction[v], InputValue);
+                        } else {
+                            Reduction[v] = MlasAddFloat32x4(Reduction[v], InputValue);
+                        }
+                    }
+
+                    InputRow += BlockSize;
+                }
+            }
+
+            MLAS_FLOAT32X4 Divisor = KernelSizeBroadcast;
+
+            if (PoolingKind == MlasAveragePoolingExcludePad) {
+                size_t ValidCount = (ihEnd > ihBegin && iwEnd > iwBegin) ? (ihEnd - ihBegin) * (iwEnd - iwBegin) : 1;
+                Divisor = MlasBroadcastFloat32x4(float(unsigned(ValidCount)));
+            }
+
+            for (size_t v = 0; v < BlockVectorCount; v++) {
+
+                MLAS_FLOAT32X4 Vector = Reduction[v];
+
+                if (PoolingKind != MlasMaximumPooling) {
+                    Vector = MlasDivideFloat32x4(Vector, Divisor);
+                }
+
+                MlasStoreFloat32x4(output + v * 4, Vector);
+            }
+
+            output += BlockSize;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasNchwcPool(
+    MLAS_POOLING_KIND PoolingKind,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the NCHWc two dimensional pooling operation.
+
+Arguments:
+
+    PoolingKind - Supplies the kind of pooling operation to perform.
+
+    InputShape - Supplies the shape of the input tensor (N, C, H, W).
+
+    KernelShape - Supplies the shape of the kernel transformation. If nullptr,
+        then global pooling is performed over the spatial dimensions.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor (top, left, bottom, right).
+
+    StrideShape - Supplies the shape of the stride.
+
+    OutputShape - Supplies the shape of the output tensor (N, C, H, W).
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    MLAS_NCHWC_POOL_WORK_BLOCK WorkBlock;
+
+    WorkBlock.PoolingKind = PoolingKind;
+    WorkBlock.Input = Input;
+    WorkBlock.Output = Output;
+    WorkBlock.BatchCount = size_t(InputShape[0]);
+    WorkBlock.ChannelBlockCount = size_t(InputShape[1]) / BlockSize;
+
+    for (size_t dim = 0; dim < 2; dim++) {
+
+        WorkBlock.InputShape[dim] = size_t(InputShape[dim + 2]);
+        WorkBlock.OutputShape[dim] = size_t(OutputShape[dim + 2]);
+
+        if (KernelShape != nullptr) {
+            WorkBlock.KernelShape[dim] = size_t(KernelShape[dim]);
+            WorkBlock.Padding[dim] = size_t(Padding[dim]);
+            WorkBlock.Padding[dim + 2] = size_t(Padding[dim + 2]);
+            WorkBlock.StrideShape[dim] = size_t(StrideShape[dim]);
+        } else {
+            WorkBlock.KernelShape[dim] = WorkBlock.InputShape[dim];
+            WorkBlock.Padding[dim] = 0;
+            WorkBlock.Padding[dim + 2] = 0;
+            WorkBlock.StrideShape[dim] = 1;
+        }
+    }
+
+    //
+    // Schedule the output rows across multiple threads.
+    //
+
+    const size_t TotalWork = WorkBlock.BatchCount * WorkBlock.ChannelBlockCount * WorkBlock.OutputShape[0];
+
+    int32_t TargetThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (size_t(TargetThreadCount) >= TotalWork) {
+        TargetThreadCount = int32_t(TotalWork);
+    }
+
+    if (TargetThreadCount == 0) {
+        return;
+    }
+
+    WorkBlock.TargetThreadCount = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasNchwcPoolThreaded, &WorkBlock, TargetThreadCount);
+}
+
+void
+MLASCALL
+MlasReorderInput(
+    const int64_t* InputShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders an input tensor from NCHW to NCHWc layout. The
+    channels are padded with zeroes to a multiple of the block size.
+
+Arguments:
+
+    InputShape - Supplies the shape of the source tensor (N, C, H, W).
+
+    S - Supplies the address of the source tensor.
+
+    D - Supplies the address of the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t BatchCount = size_t(InputShape[0]);
+    const size_t InputChannels = size_t(InputShape[1]);
+    const size_t InputSize = size_t(InputShape[2]) * size_t(InputShape[3]);
+
+    for (size_t n = 0; n < BatchCount; n++) {
+
+        for (size_t c = 0; c < InputChannels; c += BlockSize) {
+
+            const size_t ChannelCount = std::min(BlockSize, InputChannels - c);
+
+            for (size_t i = 0; i < InputSize; i++) {
+
+                const float* s = S + c * InputSize + i;
+                size_t bc = 0;
+
+                for (; bc < ChannelCount; bc++) {
+                    *D++ = *s;
+                    s += InputSize;
+                }
+
+                for (; bc < BlockSize; bc++) {
+                    *D++ = 0.0f;
+                }
+            }
+        }
+
+        S += InputChannels * InputSize;
+    }
+}
+
+void
+MLASCALL
+MlasReorderOutput(
+    const int64_t* OutputShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders an output tensor from NCHWc to NCHW layout,
+    dropping the channels that pad the last block.
+
+Arguments:
+
+    OutputShape - Supplies the shape of the destination tensor (N, C, H, W).
+
+    S - Supplies the address of the source tensor.
+
+    D - Supplies the address of the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t BatchCount = size_t(OutputShape[0]);
+    const size_t OutputChannels = size_t(OutputShape[1]);
+    const size_t OutputSize = size_t(OutputShape[2]) * size_t(OutputShape[3]);
+
+    const size_t ChannelBlockCount = (OutputChannels + BlockSize - 1) / BlockSize;
+
+    for (size_t n = 0; n < BatchCount; n++) {
+
+        for (size_t c = 0; c < OutputChannels; c++) {
+
+            const float* s = S + (c / BlockSize) * OutputSize * BlockSize + (c % BlockSize);
+
+            for (size_t i = 0; i < OutputSize; i++) {
+                *D++ = *s;
+                s += BlockSize;
+            }
+        }
+
+        S += ChannelBlockCount * OutputSize * BlockSize;
+    }
+}
+
+void
+MLASCALL
+MlasReorderFilterOIHWBiBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders a filter tensor from OIHW to the OIHWBiBo layout
+    used by the NCHWc convolution. The output and input channels are padded
+    with zeroes to a multiple of the block size.
+
+Arguments:
+
+    FilterShape - Supplies the shape of the source tensor (O, I, H, W).
+
+    S - Supplies the address of the source tensor.
+
+    D - Supplies the address of the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t OutputChannels = size_t(FilterShape[0]);
+    const size_t InputChannels = size_t(FilterShape[1]);
+    const size_t KernelSize = size_t(FilterShape[2]) * size_t(FilterShape[3]);
+
+    for (size_t o = 0; o < OutputChannels; o += BlockSize) {
+
+        const size_t OutputCount = std::min(BlockSize, OutputChannels - o);
+
+        for (size_t i = 0; i < InputChannels; i += BlockSize) {
+
+            const size_t InputCount = std::min(BlockSize, InputChannels - i);
+
+            for (size_t k = 0; k < KernelSize; k++) {
+
+                for (size_t bi = 0; bi < BlockSize; bi++) {
+
+                    for (size_t bo = 0; bo < BlockSize; bo++) {
+
+                        if (bi < InputCount && bo < OutputCount) {
+                            *D++ = S[((o + bo) * InputChannels + (i + bi)) * KernelSize + k];
+                        } else {
+                            *D++ = 0.0f;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+MLASCALL
+MlasReorderFilterOIHWBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders a filter tensor from OIHW to the OIHWBo layout
+    used by the NCHW and depthwise NCHWc convolutions. The output channels are
+    padded with zeroes to a multiple of the block size.
+
+Arguments:
+
+    FilterShape - Supplies the shape of the source tensor (O, I, H, W).
+
+    S - Supplies the address of the source tensor.
+
+    D - Supplies the address of the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t OutputChannels = size_t(FilterShape[0]);
+    const size_t InputChannels = size_t(FilterShape[1]);
+    const size_t KernelSize = size_t(FilterShape[2]) * size_t(FilterShape[3]);
+
+    for (size_t o = 0; o < OutputChannels; o += BlockSize) {
+
+        const size_t OutputCount = std::min(BlockSize, OutputChannels - o);
+
+        for (size_t i = 0; i < InputChannels; i++) {
+
+            for (size_t k = 0; k < KernelSize; k++) {
+
+                for (size_t bo = 0; bo < BlockSize; bo++) {
+
+                    if (bo < OutputCount) {
+                        *D++ = S[((o + bo) * InputChannels + i) * KernelSize + k];
+                    } else {
+                        *D++ = 0.0f;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,388 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    softmax.cpp
+
+Abstract:
+
+    This module implements routines to compute the softmax and log softmax
+    functions over the rows of a matrix.
+
+    Each row is processed with three passes: the first pass finds the maximum
+    value, the second pass computes the exponentials of the values offset by
+    the maximum and accumulates their sum, and the third pass normalizes the
+    output. The log softmax does not store the exponentials, so its third pass
+    reads the input directly.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the minimum number of elements processed by a thread.
+//
+
+#define MLAS_SOFTMAX_MINIMUM_ELEMENTS_PER_THREAD    16384
+
+//
+// Structure to encapsulate the parameters for a softmax operation.
+//
+
+struct MLAS_SOFTMAX_WORK_BLOCK {
+    int32_t TargetThreadCount;
+    bool LogSoftmax;
+    const float* Input;
+    float* Output;
+    size_t N;
+    size_t D;
+};
+
+float
+MlasReduceMaximumKernel(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the maximum value of a buffer of elements.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    N - Supplies the number of elements to process. The count must be non-zero.
+
+Return Value:
+
+    Returns the maximum value.
+
+--*/
+{
+    float Maximum = *Input;
+
+    if (N >= 4) {
+
+        MLAS_FLOAT32X4 MaximumVector0 = MlasBroadcastFloat32x4(Maximum);
+
+        if (N >= 16) {
+
+            MLAS_FLOAT32X4 MaximumVector1 = MaximumVector0;
+            MLAS_FLOAT32X4 MaximumVector2 = MaximumVector0;
+            MLAS_FLOAT32X4 MaximumVector3 = MaximumVector0;
+
+            while (N >= 16) {
+
+                MaximumVector0 = MlasMaximumFloat32x4(MaximumVector0, MlasLoadFloat32x4(Input));
+                MaximumVector1 = MlasMaximumFloat32x4(MaximumVector1, MlasLoadFloat32x4(Input + 4));
+                MaximumVector2 = MlasMaximumFloat32x4(MaximumVector2, MlasLoadFloat32x4(Input + 8));
+                MaximumVector3 = MlasMaximumFloat32x4(MaximumVector3, MlasLoadFloat32x4(Input + 12));
+
+                Input += 16;
+                N -= 16;
+            }
+
+            MaximumVector0 = MlasMaximumFloat32x4(MaximumVector0, MaximumVector1);
+            MaximumVector2 = MlasMaximumFloat32x4(MaximumVector2, MaximumVector3);
+            MaximumVector0 = MlasMaximumFloat32x4(MaximumVector0, MaximumVector2);
+        }
+
+        while (N >= 4) {
+
+            MaximumVector0 = MlasMaximumFloat32x4(MaximumVector0, MlasLoadFloat32x4(Input));
+
+            Input += 4;
+            N -= 4;
+        }
+
+        Maximum = MlasReduceMaximumFloat32x4(MaximumVector0);
+    }
+
+    while (N > 0) {
+
+        Maximum = (std::max)(Maximum, *Input);
+
+        Input += 1;
+        N -= 1;
+    }
+
+    return Maximum;
+}
+
+void
+MlasComputeSoftmaxOutputKernel(
+    float* Output,
+    size_t N,
+    float Scale
+    )
+/*++
+
+Routine Description:
+
+    This routine scales a buffer of exponentials by the reciprocal of their
+    sum.
+
+Arguments:
+
+    Output - Supplies the buffer of exponentials, which is updated in place.
+
+    N - Supplies the number of elements to process.
+
+    Scale - Supplies the reciprocal of the sum of the exponentials.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_FLOAT32X4 ScaleVector = MlasBroadcastFloat32x4(Scale);
+
+    while (N >= 16) {
+
+        MlasStoreFloat32x4(Output, MlasMultiplyFloat32x4(ScaleVector, MlasLoadFloat32x4(Output)));
+        MlasStoreFloat32x4(Output + 4, MlasMultiplyFloat32x4(ScaleVector, MlasLoadFloat32x4(Output + 4)));
+        MlasStoreFloat32x4(Output + 8, MlasMultiplyFloat32x4(ScaleVector, MlasLoadFloat32x4(Output + 8)));
+        MlasStoreFloat32x4(Output + 12, MlasMultiplyFloat32x4(ScaleVector, MlasLoadFloat32x4(Output + 12)));
+
+        Output += 16;
+        N -= 16;
+    }
+
+    while (N >= 4) {
+
+        MlasStoreFloat32x4(Output, MlasMultiplyFloat32x4(ScaleVector, MlasLoadFloat32x4(Output)));
+
+        Output += 4;
+        N -= 4;
+    }
+
+    while (N > 0) {
+
+        *Output *= Scale;
+
+        Output += 1;
+        N -= 1;
+    }
+}
+
+void
+MlasComputeLogSoftmaxOutputKernel(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float Offset
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the log softmax output by adding the negative of the
+    maximum and of the logarithm of the sum of the exponentials to the input.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+    Offset - Supplies the negative maximum minus the logarithm of the sum of
+        the exponentials.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_FLOAT32X4 OffsetVector = MlasBroadcastFloat32x4(Offset);
+
+    while (N >= 16) {
+
+        MlasStoreFloat32x4(Output, MlasAddFloat32x4(OffsetVector, MlasLoadFloat32x4(Input)));
+        MlasStoreFloat32x4(Output + 4, MlasAddFloat32x4(OffsetVector, MlasLoadFloat32x4(Input + 4)));
+        MlasStoreFloat32x4(Output + 8, MlasAddFloat32x4(OffsetVector, MlasLoadFloat32x4(Input + 8)));
+        MlasStoreFloat32x4(Output + 12, MlasAddFloat32x4(OffsetVector, MlasLoadFloat32x4(Input + 12)));
+
+        Input += 16;
+        Output += 16;
+        N -= 16;
+    }
+
+    while (N >= 4) {
+
+        MlasStoreFloat32x4(Output, MlasAddFloat32x4(OffsetVector, MlasLoadFloat32x4(Input)));
+
+        Input += 4;
+        Output += 4;
+        N -= 4;
+    }
+
+    while (N > 0) {
+
+        *Output = *Input + Offset;
+
+        Input += 1;
+        Output += 1;
+        N -= 1;
+    }
+}
+
+void
+MlasComputeSoftmaxThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    softmax or log softmax operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const auto* WorkBlock = (MLAS_SOFTMAX_WORK_BLOCK*)Context;
+
+    //
+    // Partition the operation along the N dimension.
+    //
+
+    const size_t N = WorkBlock->N;
+    const size_t D = WorkBlock->D;
+
+    const size_t TargetThreadCount = size_t(WorkBlock->TargetThreadCount);
+    const size_t RowsPerThread = N / TargetThreadCount;
+    const size_t ExtraRows = N % TargetThreadCount;
+
+    size_t n;
+    size_t CountN;
+
+    if (size_t(Index) < ExtraRows) {
+        CountN = RowsPerThread + 1;
+        n = CountN * Index;
+    } else {
+        CountN = RowsPerThread;
+        n = RowsPerThread * Index + ExtraRows;
+    }
+
+    const float* Input = WorkBlock->Input + n * D;
+    float* Output = WorkBlock->Output + n * D;
+
+#if defined(MLAS_TARGET_AMD64)
+    PMLAS_SUM_EXP_KERNEL_ROUTINE ComputeSumExpKernelRoutine = MlasPlatform.ComputeSumExpKernelRoutine;
+#else
+    PMLAS_SUM_EXP_KERNEL_ROUTINE ComputeSumExpKernelRoutine = MlasComputeSumExpKernel;
+#endif
+
+    while (CountN > 0) {
+
+        const float Maximum = MlasReduceMaximumKernel(Input, D);
+        const float NegativeMaximum = -Maximum;
+
+        if (WorkBlock->LogSoftmax) {
+
+            float Accumulation = ComputeSumExpKernelRoutine(Input, nullptr, D, &NegativeMaximum);
+
+            MlasComputeLogSoftmaxOutputKernel(Input, Output, D, NegativeMaximum - std::log(Accumulation));
+
+        } else {
+
+            float Accumulation = ComputeSumExpKernelRoutine(Input, Output, D, &NegativeMaximum);
+
+            MlasComputeSoftmaxOutputKernel(Output, D, 1.0f / Accumulation);
+        }
+
+        Input += D;
+        Output += D;
+        CountN--;
+    }
+}
+
+void
+MLASCALL
+MlasComputeSoftmax(
+    const float* Input,
+    float* Output,
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the softmax or log softmax function over each row of
+    a matrix.
+
+Arguments:
+
+    Input - Supplies the input matrix.
+
+    Output - Supplies the output matrix. The output may be the same buffer as
+        the input.
+
+    N - Supplies the number of rows to process.
+
+    D - Supplies the number of elements in each row.
+
+    LogSoftmax - Supplies true if the log softmax function should be computed,
+        else false if the softmax function should be computed.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (N == 0 || D == 0) {
+        return;
+    }
+
+    MLAS_SOFTMAX_WORK_BLOCK WorkBlock;
+
+    WorkBlock.LogSoftmax = LogSoftmax;
+    WorkBlock.Input = Input;
+    WorkBlock.Output = Output;
+    WorkBlock.N = N;
+    WorkBlock.D = D;
+
+    //
+    // Partition the rows across the worker threads.
+    //
+
+    int32_t TargetThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    const size_t MaximumThreadCount = (N * D + MLAS_SOFTMAX_MINIMUM_ELEMENTS_PER_THREAD - 1) /
+        MLAS_SOFTMAX_MINIMUM_ELEMENTS_PER_THREAD;
+
+    if (size_t(TargetThreadCount) >= MaximumThreadCount) {
+        TargetThreadCount = int32_t(MaximumThreadCount);
+    }
+
+    if (size_t(TargetThreadCount) >= N) {
+        TargetThreadCount = int32_t(N);
+    }
+
+    WorkBlock.TargetThreadCount = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasComputeSoftmaxThreaded, &WorkBlock, TargetThreadCount);
+}
@@ -0,0 +1,303 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    transpose.cpp
+
+Abstract:
+
+    This module implements the transpose of a matrix of 32-bit elements.
+
+    The matrix is processed in cache blocks that keep the source rows and the
+    destination rows of a block resident in the first level cache. Each cache
+    block is transposed with 8x8 or 4x4 register blocks using vector shuffles.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of rows and columns of a cache block.
+//
+
+#define MLAS_TRANSPOSE_CACHE_BLOCK              32
+
+inline
+void
+MlasTranspose4x4Block(
+    const uint32_t* Input,
+    size_t lda,
+    uint32_t* Output,
+    size_t ldb
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a 4x4 block of elements.
+
+Arguments:
+
+    Input - Supplies the input block.
+
+    lda - Supplies the number of elements between rows of the input block.
+
+    Output - Supplies the output block.
+
+    ldb - Supplies the number of elements between rows of the output block.
+
+Return Value:
+
+    None.
+
+--*/
+{
+#if defined(MLAS_SSE2_INTRINSICS)
+
+    __m128i a0 = _mm_loadu_si128((const __m128i*)&Input[lda * 0]);
+    __m128i a1 = _mm_loadu_si128((const __m128i*)&Input[lda * 1]);
+    __m128i a2 = _mm_loadu_si128((const __m128i*)&Input[lda * 2]);
+    __m128i a3 = _mm_loadu_si128((const __m128i*)&Input[lda * 3]);
+
+    __m128i b0 = _mm_unpacklo_epi32(a0, a1);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a1);
+    __m128i b2 = _mm_unpacklo_epi32(a2, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a2, a3);
+
+    _mm_storeu_si128((__m128i*)&Output[ldb * 0], _mm_unpacklo_epi64(b0, b2));
+    _mm_storeu_si128((__m128i*)&Output[ldb * 1], _mm_unpackhi_epi64(b0, b2));
+    _mm_storeu_si128((__m128i*)&Output[ldb * 2], _mm_unpacklo_epi64(b1, b3));
+    _mm_storeu_si128((__m128i*)&Output[ldb * 3], _mm_unpackhi_epi64(b1, b3));
+
+#elif defined(MLAS_NEON_INTRINSICS)
+
+    uint32x4x2_t b01 = vtrnq_u32(vld1q_u32(&Input[lda * 0]), vld1q_u32(&Input[lda * 1]));
+    uint32x4x2_t b23 = vtrnq_u32(vld1q_u32(&Input[lda * 2]), vld1q_u32(&Input[lda * 3]));
+
+    vst1q_u32(&Output[ldb * 0], vcombine_u32(vget_low_u32(b01.val[0]), vget_low_u32(b23.val[0])));
+    vst1q_u32(&Output[ldb * 1], vcombine_u32(vget_low_u32(b01.val[1]), vget_low_u32(b23.val[1])));
+    vst1q_u32(&Output[ldb * 2], vcombine_u32(vget_high_u32(b01.val[0]), vget_high_u32(b23.val[0])));
+    vst1q_u32(&Output[ldb * 3], vcombine_u32(vget_high_u32(b01.val[1]), vget_high_u32(b23.val[1])));
+
+#endif
+}
+
+inline
+void
+MlasTranspose8x8Block(
+    const uint32_t* Input,
+    size_t lda,
+    uint32_t* Output,
+    size_t ldb
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes an 8x8 block of elements.
+
+Arguments:
+
+    Input - Supplies the input block.
+
+    lda - Supplies the number of elements between rows of the input block.
+
+    Output - Supplies the output block.
+
+    ldb - Supplies the number of elements between rows of the output block.
+
+Return Value:
+
+    None.
+
+--*/
+{
+#if defined(MLAS_AVX_INTRINSICS)
+
+    //
+    // The elements are shuffled as single precision values. The shuffles do
+    // not interpret the values, so any bit pattern is preserved.
+    //
+
+    __m256 a0 = _mm256_loadu_ps((const float*)&Input[lda * 0]);
+    __m256 a1 = _mm256_loadu_ps((const float*)&Input[lda * 1]);
+    __m256 a2 = _mm256_loadu_ps((const float*)&Input[lda * 2]);
+    __m256 a3 = _mm256_loadu_ps((const float*)&Input[lda * 3]);
+    __m256 a4 = _mm256_loadu_ps((const float*)&Input[lda * 4]);
+    __m256 a5 = _mm256_loadu_ps((const float*)&Input[lda * 5]);
+    __m256 a6 = _mm256_loadu_ps((const float*)&Input[lda * 6]);
+    __m256 a7 = _mm256_loadu_ps((const float*)&Input[lda * 7]);
+
+    __m256 b0 = _mm256_unpacklo_ps(a0, a1);
+    __m256 b1 = _mm256_unpackhi_ps(a0, a1);
+    __m256 b2 = _mm256_unpacklo_ps(a2, a3);
+    __m256 b3 = _mm256_unpackhi_ps(a2, a3);
+    __m256 b4 = _mm256_unpacklo_ps(a4, a5);
+    __m256 b5 = _mm256_unpackhi_ps(a4, a5);
+    __m256 b6 = _mm256_unpacklo_ps(a6, a7);
+    __m256 b7 = _mm256_unpackhi_ps(a6, a7);
+
+    __m256 c0 = _mm256_shuffle_ps(b0, b2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 c1 = _mm256_shuffle_ps(b0, b2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 c2 = _mm256_shuffle_ps(b1, b3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 c3 = _mm256_shuffle_ps(b1, b3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 c4 = _mm256_shuffle_ps(b4, b6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 c5 = _mm256_shuffle_ps(b4, b6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 c6 = _mm256_shuffle_ps(b5, b7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 c7 = _mm256_shuffle_ps(b5, b7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    _mm256_storeu_ps((float*)&Output[ldb * 0], _mm256_permute2f128_ps(c0, c4, 0x20));
+    _mm256_storeu_ps((float*)&Output[ldb * 1], _mm256_permute2f128_ps(c1, c5, 0x20));
+    _mm256_storeu_ps((float*)&Output[ldb * 2], _mm256_permute2f128_ps(c2, c6, 0x20));
+    _mm256_storeu_ps((float*)&Output[ldb * 3], _mm256_permute2f128_ps(c3, c7, 0x20));
+    _mm256_storeu_ps((float*)&Output[ldb * 4], _mm256_permute2f128_ps(c0, c4, 0x31));
+    _mm256_storeu_ps((float*)&Output[ldb * 5], _mm256_permute2f128_ps(c1, c5, 0x31));
+    _mm256_storeu_ps((float*)&Output[ldb * 6], _mm256_permute2f128_ps(c2, c6, 0x31));
+    _mm256_storeu_ps((float*)&Output[ldb * 7], _mm256_permute2f128_ps(c3, c7, 0x31));
+
+#else
+
+    MlasTranspose4x4Block(&Input[0], lda, &Output[0], ldb);
+    MlasTranspose4x4Block(&Input[4], lda, &Output[ldb * 4], ldb);
+    MlasTranspose4x4Block(&Input[lda * 4], lda, &Output[4], ldb);
+    MlasTranspose4x4Block(&Input[lda * 4 + 4], lda, &Output[ldb * 4 + 4], ldb);
+
+#endif
+}
+
+void
+MlasTransposeCacheBlock(
+    size_t M,
+    size_t N,
+    const uint32_t* Input,
+    size_t lda,
+    uint32_t* Output,
+    size_t ldb
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a cache block of at most MLAS_TRANSPOSE_CACHE_BLOCK
+    rows and columns.
+
+Arguments:
+
+    M - Supplies the number of rows of the input block.
+
+    N - Supplies the number of columns of the input block.
+
+    Input - Supplies the input block.
+
+    lda - Supplies the number of elements between rows of the input block.
+
+    Output - Supplies the output block.
+
+    ldb - Supplies the number of elements between rows of the output block.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    size_t m = 0;
+
+    for (; m + 8 <= M; m += 8) {
+
+        size_t n = 0;
+
+        for (; n + 8 <= N; n += 8) {
+            MlasTranspose8x8Block(&Input[m * lda + n], lda, &Output[n * ldb + m], ldb);
+        }
+
+        for (; n + 4 <= N; n += 4) {
+            MlasTranspose4x4Block(&Input[m * lda + n], lda, &Output[n * ldb + m], ldb);
+            MlasTranspose4x4Block(&Input[(m + 4) * lda + n], lda, &Output[n * ldb + m + 4], ldb);
+        }
+
+        for (; n < N; n++) {
+            for (size_t i = 0; i < 8; i++) {
+                Output[n * ldb + m + i] = Input[(m + i) * lda + n];
+            }
+        }
+    }
+
+    for (; m + 4 <= M; m += 4) {
+
+        size_t n = 0;
+
+        for (; n + 4 <= N; n += 4) {
+            MlasTranspose4x4Block(&Input[m * lda + n], lda, &Output[n * ldb + m], ldb);
+        }
+
+        for (; n < N; n++) {
+            for (size_t i = 0; i < 4; i++) {
+                Output[n * ldb + m + i] = Input[(m + i) * lda + n];
+            }
+        }
+    }
+
+    for (; m < M; m++) {
+        for (size_t n = 0; n < N; n++) {
+            Output[n * ldb + m] = Input[m * lda + n];
+        }
+    }
+}
+
+void
+MLASCALL
+MlasTranspose(
+    size_t M,
+    size_t N,
+    const uint32_t* Input,
+    size_t lda,
+    uint32_t* Output,
+    size_t ldb
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a matrix of 32-bit elements. Element (m, n) of the
+    input matrix is stored to element (n, m) of the output matrix.
+
+Arguments:
+
+    M - Supplies the number of rows of the input matrix and the number of
+        columns of the output matrix.
+
+    N - Supplies the number of columns of the input matrix and the number of
+        rows of the output matrix.
+
+    Input - Supplies the input matrix.
+
+    lda - Supplies the number of elements between rows of the input matrix.
+
+    Output - Supplies the output matrix.
+
+    ldb - Supplies the number of elements between rows of the output matrix.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    for (size_t m = 0; m < M; m += MLAS_TRANSPOSE_CACHE_BLOCK) {
+
+        const size_t CountM = (std::min)(M - m, size_t(MLAS_TRANSPOSE_CACHE_BLOCK));
+
+        for (size_t n = 0; n < N; n += MLAS_TRANSPOSE_CACHE_BLOCK) {
+
+            const size_t CountN = (std::min)(N - n, size_t(MLAS_TRANSPOSE_CACHE_BLOCK));
+
+            MlasTransposeCacheBlock(CountM, CountN, &Input[m * lda + n], lda,
+                &Output[n * ldb + m], ldb);
+        }
+    }
+}
@@ -0,0 +1,958 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    winograd.cpp
+
+Abstract:
+
+    This module implements the Winograd minimal filtering algorithm for two
+    dimensional convolutions with a 3x3 kernel and unit strides.
+
+    The output image is split into tiles of MxM elements. Each tile is
+    computed from an (M+2)x(M+2) patch of the input image, which is
+    transformed with B^T*d*B. The filter is transformed once with G*g*G^T.
+    The element-wise products of the transformed patches and filters are then
+    summed over the input channels, which is expressed as (M+2)^2 independent
+    GEMMs over a block of tiles. The final output tile is recovered with
+    A^T*m*A. Both F(2x2, 3x3) and F(4x4, 3x3) are supported.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the minimum number of input channels and filters to use the
+// Winograd algorithm. The tile transforms are not amortized across enough
+// channels for smaller convolutions.
+//
+
+#define MLAS_CONV_WINOGRAD_MINIMUM_CHANNELS         32
+
+//
+// Define the number of working buffer elements to target per thread for the
+// transformed input and output tiles of a block of tile rows.
+//
+
+#define MLAS_CONV_WINOGRAD_WORKING_BUFFER_SIZE_PER_THREAD (128 * 1024)
+
+//
+// Define the minimum number of tiles to process per work item. This keeps the
+// N dimension of the tile GEMMs large enough to run efficiently.
+//
+
+#define MLAS_CONV_WINOGRAD_MINIMUM_TILE_COUNT       32
+
+//
+// Define the parameters to execute segments of a Winograd convolution on
+// worker threads.
+//
+
+struct MLAS_CONV_WINOGRAD_WORK_BLOCK {
+    const MLAS_CONV_PARAMETERS* Parameters;
+    const float* Input;
+    const float* Filter;
+    const float* Bias;
+    float* WorkingBuffer;
+    float* Output;
+    size_t TileRowBlockCount;
+    size_t WorkingBufferSizePerThread;
+    int32_t TargetThreadCount;
+};
+
+//
+// Define the transforms for F(2x2, 3x3).
+//
+
+struct MLAS_CONV_WINOGRAD_F2K3
+{
+    static constexpr size_t OutputTileSize = 2;
+    static constexpr size_t InputTileSize = 4;
+
+    static
+    inline
+    void
+    TransformInput(
+        const float* d,
+        size_t StrideD,
+        float* r,
+        size_t StrideR
+        )
+    {
+        const float d0 = d[0];
+        const float d1 = d[StrideD];
+        const float d2 = d[2 * StrideD];
+        const float d3 = d[3 * StrideD];
+
+        r[0] = d0 - d2;
+        r[StrideR] = d1 + d2;
+        r[2 * StrideR] = d2 - d1;
+        r[3 * StrideR] = d1 - d3;
+    }
+
+    static
+    inline
+    void
+    TransformFilter(
+        const float* g,
+        size_t StrideG,
+        float* u,
+        size_t StrideU
+        )
+    {
+        const float g0 = g[0];
+        const float g1 = g[StrideG];
+        const float g2 = g[2 * StrideG];
+
+        u[0] = g0;
+        u[StrideU] = 0.5f * (g0 + g1 + g2);
+        u[2 * StrideU] = 0.5f * (g0 - g1 + g2);
+        u[3 * StrideU] = g2;
+    }
+
+    static
+    inline
+    void
+    TransformOutput(
+        const float* m,
+        size_t StrideM,
+        float* y,
+        size_t StrideY
+        )
+    {
+        const float m0 = m[0];
+        const float m1 = m[StrideM];
+        const float m2 = m[2 * StrideM];
+        const float m3 = m[3 * StrideM];
+
+        y[0] = m0 + m1 + m2;
+        y[StrideY] = m1 - m2 - m3;
+    }
+};
+
+//
+// Define the transforms for F(4x4, 3x3).
+//
+
+struct MLAS_CONV_WINOGRAD_F4K3
+{
+    static constexpr size_t OutputTileSize = 4;
+    static constexpr size_t InputTileSize = 6;
+
+    static
+    inline
+    void
+    TransformInput(
+        const float* d,
+        size_t StrideD,
+        float* r,
+        size_t StrideR
+        )
+    {
+        const float d0 = d[0];
+        const float d1 = d[StrideD];
+        const float d2 = d[2 * StrideD];
+        const float d3 = d[3 * StrideD];
+        const float d4 = d[4 * StrideD];
+        const float d5 = d[5 * StrideD];
+
+        const float t0 = d4 - 4.0f * d2;
+        const float t1 = d3 - 4.0f * d1;
+        const float t2 = d4 - d2;
+        const float t3 = 2.0f * (d3 - d1);
+
+        r[0] = 4.0f * d0 - 5.0f * d2 + d4;
+        r[StrideR] = t0 + t1;
+        r[2 * StrideR] = t0 - t1;
+        r[3 * StrideR] = t2 + t3;
+        r[4 * StrideR] = t2 - t3;
+        r[5 * StrideR] = 4.0f * d1 - 5.0f * d3 + d5;
+    }
+
+    static
+    inline
+    void
+    TransformFilter(
+        const float* g,
+        size_t StrideG,
+        float* u,
+        size_t StrideU
+        )
+    {
+        const float g0 = g[0];
+        const float g1 = g[StrideG];
+        const float g2 = g[2 * StrideG];
+
+        const float t0 = g0 + g2;
+        const float t1 = 0.25f * g0 + g2;
+
+        u[0] = 0.25f * g0;
+        u[StrideU] = -(t0 + g1) / 6.0f;
+        u[2 * StrideU] = -(t0 - g1) / 6.0f;
+        u[3 * StrideU] = (t1 + 0.5f * g1) / 6.0f;
+        u[4 * StrideU] = (t1 - 0.5f * g1) / 6.0f;
+        u[5 * StrideU] = g2;
+    }
+
+    static
+    inline
+    void
+    TransformOutput(
+        const float* m,
+        size_t StrideM,
+        float* y,
+        size_t StrideY
+        )
+    {
+        const float m0 = m[0];
+        const float m1 = m[StrideM];
+        const float m2 = m[2 * StrideM];
+        const float m3 = m[3 * StrideM];
+        const float m4 = m[4 * StrideM];
+        const float m5 = m[5 * StrideM];
+
+        const float t0 = m1 + m2;
+        const float t1 = m1 - m2;
+        const float t2 = m3 + m4;
+        const float t3 = m3 - m4;
+
+        y[0] = m0 + t0 + t2;
+        y[StrideY] = t1 + 2.0f * t3;
+        y[2 * StrideY] = t0 + 4.0f * t2;
+        y[3 * StrideY] = t1 + 8.0f * t3 + m5;
+    }
+};
+
+template<typename WinogradTransform>
+void
+MlasConvWinogradTransformFilterGroup(
+    size_t FilterCount,
+    size_t InputChannels,
+    const float* Filter,
+    float* TransformedFilter
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the filters of a single group to the layout used
+    by the Winograd algorithm: [InputTileSize^2][FilterCount][InputChannels].
+
+Arguments:
+
+    FilterCount - Supplies the number of filters of the group.
+
+    InputChannels - Supplies the number of input channels of the group.
+
+    Filter - Supplies the filters in OIHW order.
+
+    TransformedFilter - Supplies the buffer to receive the transformed filters.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t InputTileSize = WinogradTransform::InputTileSize;
+
+    const size_t TransformedFilterStride = FilterCount * InputChannels;
+
+    for (size_t f = 0; f < FilterCount; f++) {
+
+        for (size_t c = 0; c < InputChannels; c++) {
+
+            const float* g = Filter + (f * InputChannels + c) * 9;
+
+            float t[InputTileSize][3];
+            float u[InputTileSize][InputTileSize];
+
+            for (size_t j = 0; j < 3; j++) {
+                WinogradTransform::TransformFilter(g + j, 3, &t[0][j], 3);
+            }
+
+            for (size_t i = 0; i < InputTileSize; i++) {
+                WinogradTransform::TransformFilter(&t[i][0], 1, &u[i][0], 1);
+            }
+
+            float* TransformedFilterElement = TransformedFilter + f * InputChannels + c;
+
+            for (size_t i = 0; i < InputTileSize; i++) {
+                for (size_t j = 0; j < InputTileSize; j++) {
+                    *TransformedFilterElement = u[i][j];
+                    TransformedFilterElement += TransformedFilterStride;
+                }
+            }
+        }
+    }
+}
+
+template<typename WinogradTransform>
+void
+MlasConvWinogradTransformInput(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    size_t TileRowStart,
+    size_t TileRowCount,
+    float* TransformedInput
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the input patches for a block of tile rows to the
+    layout used by the tile GEMMs: [InputTileSize^2][InputChannels][TileCount].
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input tensor for the batch and group.
+
+    TileRowStart - Supplies the first tile row of the block.
+
+    TileRowCount - Supplies the number of tile rows of the block.
+
+    TransformedInput - Supplies the buffer to receive the transformed input.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t OutputTileSize = WinogradTransform::OutputTileSize;
+    constexpr size_t InputTileSize = WinogradTransform::InputTileSize;
+
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t InputWidth = Parameters->InputShape[1];
+    const size_t InputSize = Parameters->InputSize;
+    const size_t PaddingTop = Parameters->Padding[0];
+    const size_t PaddingLeft = Parameters->Padding[1];
+
+    const size_t TileColumnCount = (Parameters->OutputShape[1] + OutputTileSize - 1) / OutputTileSize;
+    const size_t TileCount = TileRowCount * TileColumnCount;
+    const size_t TransformedInputStride = InputChannels * TileCount;
+
+    for (size_t c = 0; c < InputChannels; c++) {
+
+        const float* input = Input + c * InputSize;
+
+        size_t TileIndex = 0;
+
+        for (size_t tr = TileRowStart; tr < TileRowStart + TileRowCount; tr++) {
+
+            const ptrdiff_t ihStart = ptrdiff_t(tr * OutputTileSize) - ptrdiff_t(PaddingTop);
+
+            for (size_t tc = 0; tc < TileColumnCount; tc++, TileIndex++) {
+
+                const ptrdiff_t iwStart = ptrdiff_t(tc * OutputTileSize) - ptrdiff_t(PaddingLeft);
+
+                //
+                // Use the input image directly if the patch is entirely within
+                // the image, else copy the patch with zero padding.
+                //
+
+                const float* d;
+                size_t StrideD;
+                float Patch[InputTileSize][InputTileSize];
+
+                if (ihStart >= 0 && size_t(ihStart) + InputTileSize <= InputHeight &&
+                    iwStart >= 0 && size_t(iwStart) + InputTileSize <= InputWidth) {
+
+                    d = input + size_t(ihStart) * InputWidth + size_t(iwStart);
+                    StrideD = InputWidth;
+
+                } else {
+
+                    for (size_t i = 0; i < InputTileSize; i++) {
+
+                        const size_t ih = size_t(ihStart + ptrdiff_t(i));
+
+                        for (size_t j = 0; j < InputTileSize; j++) {
+
+                            const size_t iw = size_t(iwStart + ptrdiff_t(j));
+
+                            Patch[i][j] = (ih < InputHeight && iw < InputWidth) ?
+                                input[ih * InputWidth + iw] : 0.0f;
+                        }
+                    }
+
+                    d = &Patch[0][0];
+                    StrideD = InputTileSize;
+                }
+
+                float t[InputTileSize][InputTileSize];
+                float v[InputTileSize][InputTileSize];
+
+                for (size_t j = 0; j < InputTileSize; j++) {
+                    WinogradTransform::TransformInput(d + j, StrideD, &t[0][j], InputTileSize);
+                }
+
+                for (size_t i = 0; i < InputTileSize; i++) {
+                    WinogradTransform::TransformInput(&t[i][0], 1, &v[i][0], 1);
+                }
+
+                float* TransformedInputElement = TransformedInput + c * TileCount + TileIndex;
+
+                for (size_t i = 0; i < InputTileSize; i++) {
+                    for (size_t j = 0; j < InputTileSize; j++) {
+                        *TransformedInputElement = v[i][j];
+                        TransformedInputElement += TransformedInputStride;
+                    }
+                }
+            }
+        }
+    }
+}
+
+template<typename WinogradTransform>
+void
+MlasConvWinogradTransformOutput(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* TransformedOutput,
+    size_t TileRowStart,
+    size_t TileRowCount,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the output of the tile GEMMs for a block of tile
+    rows to the output tensor, clipping the tiles at the edges of the output.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    TransformedOutput - Supplies the output of the tile GEMMs in the layout
+        [InputTileSize^2][FilterCount][TileCount].
+
+    TileRowStart - Supplies the first tile row of the block.
+
+    TileRowCount - Supplies the number of tile rows of the block.
+
+    Output - Supplies the output tensor for the batch and group.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t OutputTileSize = WinogradTransform::OutputTileSize;
+    constexpr size_t InputTileSize = WinogradTransform::InputTileSize;
+
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t OutputSize = Parameters->OutputSize;
+
+    const size_t TileColumnCount = (OutputWidth + OutputTileSize - 1) / OutputTileSize;
+    const size_t TileCount = TileRowCount * TileColumnCount;
+    const size_t TransformedOutputStride = FilterCount * TileCount;
+
+    for (size_t f = 0; f < FilterCount; f++) {
+
+        float* output = Output + f * OutputSize;
+
+        size_t TileIndex = 0;
+
+        for (size_t tr = TileRowStart; tr < TileRowStart + TileRowCount; tr++) {
+
+            const size_t ohStart = tr * OutputTileSize;
+            const size_t RowCount = (std::min)(OutputTileSize, OutputHeight - ohStart);
+
+            for (size_t tc = 0; tc < TileColumnCount; tc++, TileIndex++) {
+
+                const size_t owStart = tc * OutputTileSize;
+                const size_t ColumnCount = (std::min)(OutputTileSize, OutputWidth - owStart);
+
+                const float* TransformedOutputElement = TransformedOutput + f * TileCount + TileIndex;
+
+                float m[InputTileSize][InputTileSize];
+
+                for (size_t i = 0; i < InputTileSize; i++) {
+                    for (size_t j = 0; j < InputTileSize; j++) {
+                        m[i][j] = *TransformedOutputElement;
+                        TransformedOutputElement += TransformedOutputStride;
+                    }
+                }
+
+                float t[OutputTileSize][InputTileSize];
+                float y[OutputTileSize][OutputTileSize];
+
+                for (size_t j = 0; j < InputTileSize; j++) {
+                    WinogradTransform::TransformOutput(&m[0][j], InputTileSize, &t[0][j], InputTileSize);
+                }
+
+                for (size_t i = 0; i < OutputTileSize; i++) {
+                    WinogradTransform::TransformOutput(&t[i][0], 1, &y[i][0], 1);
+                }
+
+                for (size_t i = 0; i < RowCount; i++) {
+                    for (size_t j = 0; j < ColumnCount; j++) {
+                        output[(ohStart + i) * OutputWidth + owStart + j] = y[i][j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+template<typename WinogradTransform>
+void
+MlasConvWinogradThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    Winograd convolution operation.
+
+    Each work item is a block of tile rows for one batch and group. The input
+    patches of the block are transformed, multiplied with the transformed
+    filters using one GEMM per element of the input tile, and then transformed
+    to the output tensor.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t OutputTileSize = WinogradTransform::OutputTileSize;
+    constexpr size_t InputTileSize = WinogradTransform::InputTileSize;
+
+    MLAS_CONV_WINOGRAD_WORK_BLOCK* WorkBlock = (MLAS_CONV_WINOGRAD_WORK_BLOCK*)Context;
+
+    const MLAS_CONV_PARAMETERS* Parameters = WorkBlock->Parameters;
+
+    const size_t GroupCount = Parameters->GroupCount;
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t OutputSize = Parameters->OutputSize;
+    const size_t OutputWidth = Parameters->OutputShape[1];
+
+    const size_t TileRowCountTotal = (Parameters->OutputShape[0] + OutputTileSize - 1) / OutputTileSize;
+    const size_t TileColumnCount = (OutputWidth + OutputTileSize - 1) / OutputTileSize;
+    const size_t TileRowsPerBlock = Parameters->u.Winograd.TileRowsPerBlock;
+    const size_t TileRowBlockCount = WorkBlock->TileRowBlockCount;
+
+    const size_t InputGroupSize = InputChannels * Parameters->InputSize;
+    const size_t OutputGroupSize = FilterCount * OutputSize;
+    const size_t FilterGroupSize = InputTileSize * InputTileSize * FilterCount * InputChannels;
+
+    //
+    // Compute the range of work items to use for this thread.
+    //
+
+    const size_t TotalWork = Parameters->BatchCount * GroupCount * TileRowBlockCount;
+    const size_t TargetThreadCount = size_t(WorkBlock->TargetThreadCount);
+
+    const size_t WorkPerThread = TotalWork / TargetThreadCount;
+    const size_t WorkPerThreadExtra = TotalWork % TargetThreadCount;
+
+    size_t WorkIndex;
+    size_t WorkRemaining;
+
+    if (uint32_t(Index) < WorkPerThreadExtra) {
+        WorkIndex = (WorkPerThread + 1) * Index;
+        WorkRemaining = WorkPerThread + 1;
+    } else {
+        WorkIndex = WorkPerThread * Index + WorkPerThreadExtra;
+        WorkRemaining = WorkPerThread;
+    }
+
+    //
+    // Each thread uses a private section of the working buffer for the
+    // transformed input and output tiles.
+    //
+
+    float* TransformedInput = WorkBlock->WorkingBuffer + Index * WorkBlock->WorkingBufferSizePerThread;
+    float* TransformedOutput = TransformedInput +
+        InputTileSize * InputTileSize * InputChannels * TileRowsPerBlock * TileColumnCount;
+
+    for (; WorkRemaining > 0; WorkRemaining--, WorkIndex++) {
+
+        const size_t bg = WorkIndex / TileRowBlockCount;
+        const size_t group = bg % GroupCount;
+
+        const size_t TileRowStart = (WorkIndex % TileRowBlockCount) * TileRowsPerBlock;
+        const size_t TileRowCount = (std::min)(TileRowsPerBlock, TileRowCountTotal - TileRowStart);
+        const size_t TileCount = TileRowCount * TileColumnCount;
+
+        const float* input = WorkBlock->Input + bg * InputGroupSize;
+        const float* filter = WorkBlock->Filter + group * FilterGroupSize;
+        float* output = WorkBlock->Output + bg * OutputGroupSize;
+
+        MlasConvWinogradTransformInput<WinogradTransform>(Parameters, input,
+            TileRowStart, TileRowCount, TransformedInput);
+
+        //
+        // Multiply the transformed filters and input patches for each element
+        // of the input tile.
+        //
+
+        for (size_t i = 0; i < InputTileSize * InputTileSize; i++) {
+
+            MlasSgemmOperation(CblasNoTrans, CblasNoTrans, FilterCount, TileCount,
+                InputChannels, 1.0f, filter + i * FilterCount * InputChannels,
+                InputChannels, TransformedInput + i * InputChannels * TileCount,
+                TileCount, 0.0f, TransformedOutput + i * FilterCount * TileCount,
+                TileCount);
+        }
+
+        MlasConvWinogradTransformOutput<WinogradTransform>(Parameters, TransformedOutput,
+            TileRowStart, TileRowCount, output);
+
+        //
+        // Apply the activation with optional bias to the output rows of the
+        // block.
+        //
+
+        const float* bias = WorkBlock->Bias;
+
+        if (bias != nullptr) {
+            bias += group * FilterCount;
+        }
+
+        const size_t ohStart = TileRowStart * OutputTileSize;
+        const size_t ohCount = (std::min)(TileRowCount * OutputTileSize,
+            Parameters->OutputShape[0] - ohStart);
+
+        float* OutputRows = output + ohStart * OutputWidth;
+
+        MlasActivation(Parameters->Activation, OutputRows, bias, FilterCount,
+            OutputRows, ohCount * OutputWidth, OutputSize);
+    }
+}
+
+bool
+MlasConvWinogradPrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t* WorkingBufferSize
+    )
+/*++
+
+Routine Description:
+
+    This routine determines whether the convolution can be performed with the
+    Winograd algorithm. If so, the routine computes the tile size, the number
+    of tile rows processed per work item, the number of threads, and the
+    required working buffer size.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer for intermediate results.
+
+Return Value:
+
+    Returns true if the Winograd algorithm is selected, else false.
+
+--*/
+{
+    if (Parameters->Dimensions != 2) {
+        return false;
+    }
+
+    for (size_t dim = 0; dim < 2; dim++) {
+
+        if (Parameters->KernelShape[dim] != 3 || Parameters->StrideShape[dim] != 1 ||
+            Parameters->DilationShape[dim] != 1 || Parameters->OutputShape[dim] < 2) {
+            return false;
+        }
+    }
+
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t FilterCount = Parameters->FilterCount;
+
+    if (InputChannels < MLAS_CONV_WINOGRAD_MINIMUM_CHANNELS ||
+        FilterCount < MLAS_CONV_WINOGRAD_MINIMUM_CHANNELS) {
+        return false;
+    }
+
+    //
+    // Use the larger output tile unless the output is too small to fill it.
+    //
+
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+
+    size_t OutputTileSize;
+
+    if (OutputHeight >= MLAS_CONV_WINOGRAD_F4K3::OutputTileSize &&
+        OutputWidth >= MLAS_CONV_WINOGRAD_F4K3::OutputTileSize) {
+        OutputTileSize = MLAS_CONV_WINOGRAD_F4K3::OutputTileSize;
+    } else {
+        OutputTileSize = MLAS_CONV_WINOGRAD_F2K3::OutputTileSize;
+    }
+
+    const size_t InputTileSize = OutputTileSize + 2;
+    const size_t TileRowCount = (OutputHeight + OutputTileSize - 1) / OutputTileSize;
+    const size_t TileColumnCount = (OutputWidth + OutputTileSize - 1) / OutputTileSize;
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // convolution operation. Small requests should run using the single
+    // threaded path.
+    //
+
+    const size_t BatchGroupCount = Parameters->BatchCount * Parameters->GroupCount;
+
+    int32_t TargetThreadCount;
+    double Complexity = double(FilterCount) * double(Parameters->OutputSize) *
+        double(Parameters->K) * double(BatchGroupCount);
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    //
+    // Compute the number of tile rows per work item. The block is limited by
+    // the working buffer budget per thread and is reduced further so that
+    // each thread has at least one work item, but always contains enough
+    // tiles for an efficient GEMM.
+    //
+
+    const size_t TileRowSize = InputTileSize * InputTileSize *
+        (InputChannels + FilterCount) * TileColumnCount;
+
+    size_t TileRowsPerBlock = MLAS_CONV_WINOGRAD_WORKING_BUFFER_SIZE_PER_THREAD / TileRowSize;
+
+    const size_t BlocksPerBatchGroup =
+        (size_t(TargetThreadCount) + BatchGroupCount - 1) / BatchGroupCount;
+    const size_t TileRowsPerThread = (TileRowCount + BlocksPerBatchGroup - 1) / BlocksPerBatchGroup;
+
+    if (TileRowsPerBlock > TileRowsPerThread) {
+        TileRowsPerBlock = TileRowsPerThread;
+    }
+
+    const size_t MinimumTileRowsPerBlock = (MLAS_CONV_WINOGRAD_MINIMUM_TILE_COUNT +
+        TileColumnCount - 1) / TileColumnCount;
+
+    if (TileRowsPerBlock < MinimumTileRowsPerBlock) {
+        TileRowsPerBlock = MinimumTileRowsPerBlock;
+    }
+
+    if (TileRowsPerBlock > TileRowCount) {
+        TileRowsPerBlock = TileRowCount;
+    }
+
+    const size_t TileRowBlockCount = (TileRowCount + TileRowsPerBlock - 1) / TileRowsPerBlock;
+    const size_t TotalWork = BatchGroupCount * TileRowBlockCount;
+
+    if (size_t(TargetThreadCount) > TotalWork) {
+        TargetThreadCount = int32_t(TotalWork);
+    }
+
+    Parameters->Algorithm = MlasConvAlgorithmWinograd;
+    Parameters->u.Winograd.OutputTileSize = OutputTileSize;
+    Parameters->u.Winograd.TileRowsPerBlock = TileRowsPerBlock;
+    Parameters->u.Winograd.ThreadCount = size_t(TargetThreadCount);
+
+    *WorkingBufferSize = size_t(TargetThreadCount) * TileRowSize * TileRowsPerBlock;
+
+    return true;
+}
+
+void
+MlasConvWinograd(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the Winograd convolution algorithm.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input tensor.
+
+    Filter - Supplies the filter tensor transformed by
+        MlasConvWinogradTransformFilter.
+
+    Bias - Supplies the optional bias vector.
+
+    WorkingBuffer - Supplies a working buffer sized to the number of elements
+        returned by MlasConvPrepare.
+
+    Output - Supplies the output tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t OutputTileSize = Parameters->u.Winograd.OutputTileSize;
+    const size_t InputTileSize = OutputTileSize + 2;
+    const size_t TileRowsPerBlock = Parameters->u.Winograd.TileRowsPerBlock;
+
+    const size_t TileRowCount = (Parameters->OutputShape[0] + OutputTileSize - 1) / OutputTileSize;
+    const size_t TileColumnCount = (Parameters->OutputShape[1] + OutputTileSize - 1) / OutputTileSize;
+
+    MLAS_CONV_WINOGRAD_WORK_BLOCK WorkBlock;
+
+    WorkBlock.Parameters = Parameters;
+    WorkBlock.Input = Input;
+    WorkBlock.Filter = Filter;
+    WorkBlock.Bias = Bias;
+    WorkBlock.WorkingBuffer = WorkingBuffer;
+    WorkBlock.Output = Output;
+    WorkBlock.TileRowBlockCount = (TileRowCount + TileRowsPerBlock - 1) / TileRowsPerBlock;
+    WorkBlock.WorkingBufferSizePerThread = InputTileSize * InputTileSize *
+        (Parameters->InputChannels + Parameters->FilterCount) * TileColumnCount * TileRowsPerBlock;
+    WorkBlock.TargetThreadCount = int32_t(Parameters->u.Winograd.ThreadCount);
+
+    PMLAS_THREADED_ROUTINE ThreadedRoutine;
+
+    if (OutputTileSize == MLAS_CONV_WINOGRAD_F4K3::OutputTileSize) {
+        ThreadedRoutine = MlasConvWinogradThreaded<MLAS_CONV_WINOGRAD_F4K3>;
+    } else {
+        ThreadedRoutine = MlasConvWinogradThreaded<MLAS_CONV_WINOGRAD_F2K3>;
+    }
+
+    MlasExecuteThreaded(ThreadedRoutine, &WorkBlock, WorkBlock.TargetThreadCount);
+}
+
+size_t
+MLASCALL
+MlasConvWinogradGetTransformedFilterSize(
+    size_t OutputTileSize,
+    size_t GroupCount,
+    size_t FilterCount,
+    size_t InputChannels
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the number of elements required to store the
+    filters transformed for the Winograd algorithm.
+
+Arguments:
+
+    OutputTileSize - Supplies the output tile size (2 or 4).
+
+    GroupCount - Supplies the number of channel groups.
+
+    FilterCount - Supplies the number of filters per group.
+
+    InputChannels - Supplies the number of input channels per group.
+
+Return Value:
+
+    Returns the number of elements required for the transformed filters or
+    zero if the Winograd algorithm does not support the filters.
+
+--*/
+{
+    if ((OutputTileSize != MLAS_CONV_WINOGRAD_F2K3::OutputTileSize &&
+         OutputTileSize != MLAS_CONV_WINOGRAD_F4K3::OutputTileSize) ||
+        InputChannels < MLAS_CONV_WINOGRAD_MINIMUM_CHANNELS ||
+        FilterCount < MLAS_CONV_WINOGRAD_MINIMUM_CHANNELS) {
+        return 0;
+    }
+
+    const size_t InputTileSize = OutputTileSize + 2;
+
+    return InputTileSize * InputTileSize * GroupCount * FilterCount * InputChannels;
+}
+
+void
+MLASCALL
+MlasConvWinogradTransformFilter(
+    size_t OutputTileSize,
+    size_t GroupCount,
+    size_t FilterCount,
+    size_t InputChannels,
+    const float* Filter,
+    float* TransformedFilter
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the 3x3 filters of a convolution for use by the
+    Winograd algorithm.
+
+Arguments:
+
+    OutputTileSize - Supplies the output tile size (2 or 4).
+
+    GroupCount - Supplies the number of channel groups.
+
+    FilterCount - Supplies the number of filters per group.
+
+    InputChannels - Supplies the number of input channels per group.
+
+    Filter - Supplies the filters in OIHW order.
+
+    TransformedFilter - Supplies the buffer to receive the transformed filters.
+        The buffer must contain the number of elements returned by
+        MlasConvWinogradGetTransformedFilterSize.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t InputTileSize = OutputTileSize + 2;
+    const size_t FilterGroupSize = FilterCount * InputChannels * 9;
+    const size_t TransformedFilterGroupSize =
+        InputTileSize * InputTileSize * FilterCount * InputChannels;
+
+    for (size_t group = 0; group < GroupCount; group++) {
+
+        if (OutputTileSize == MLAS_CONV_WINOGRAD_F4K3::OutputTileSize) {
+            MlasConvWinogradTransformFilterGroup<MLAS_CONV_WINOGRAD_F4K3>(
+                FilterCount, InputChannels, Filter, TransformedFilter);
+        } else {
+            MlasConvWinogradTransformFilterGroup<MLAS_CONV_WINOGRAD_F2K3>(
+                FilterCount, InputChannels, Filter, TransformedFilter);
+        }
+
+        Filter += FilterGroupSize;
+        TransformedFilter += TransformedFilterGroupSize;
+    }
+}
@@ -112,6 +112,22 @@ class Env {
   //This functions is always successful. It can't fail.
   virtual PIDType GetSelfPid() const = 0;
 
+  /// Memory mapped from a file. The deleter unmaps it.
+  using MappedMemoryPtr = std::unique_ptr<char, std::function<void(char*)>>;
+
+  /// \brief Gets the length of a file in bytes.
+  virtual common::Status GetFileLength(const std::string& file_path, size_t& length) const = 0;
+
+  /// \brief Maps a read-only view of part of a file into memory.
+  ///
+  /// "offset" does not need to be aligned to the page size.
+  /// Returns an INVALID_ARGUMENT error if the range is not entirely within the file.
+  /// On success, "mapped_memory" points to the byte at "offset" and stays valid until it is released.
+  /// The mapping is private to the process and is backed by the file, so no memory is committed for
+  /// pages that are never touched.
+  virtual common::Status MapFileIntoMemory(const std::string& file_path, size_t offset, size_t length,
+                                           MappedMemoryPtr& mapped_memory) const = 0;
+
   // \brief Load a dynamic library.
   //
   // Pass "library_filename" to a platform-specific mechanism for dynamically
@@ -18,6 +18,7 @@ limitations under the License.
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <dlfcn.h>
 #include <string.h>
 #include <thread>
@@ -119,6 +120,62 @@ class PosixEnv : public Env {
     return Status::OK();
   }
 
+  common::Status GetFileLength(const std::string& file_path, size_t& length) const override {
+    struct stat buf;
+    if (stat(file_path.c_str(), &buf) != 0) {
+      return common::Status(common::SYSTEM, errno);
+    }
+    length = static_cast<size_t>(buf.st_size);
+    return Status::OK();
+  }
+
+  common::Status MapFileIntoMemory(const std::string& file_path, size_t offset, size_t length,
+                                   MappedMemoryPtr& mapped_memory) const override {
+    mapped_memory.reset();
+    if (length == 0) {
+      return Status::OK();
+    }
+
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (0 > fd) {
+      return common::Status(common::SYSTEM, errno);
+    }
+
+    // accessing a mapped page beyond the end of the file raises SIGBUS, so check the range first
+    struct stat buf;
+    if (fstat(fd, &buf) != 0) {
+      int fstat_errno = errno;
+      close(fd);
+      return common::Status(common::SYSTEM, fstat_errno);
+    }
+
+    const size_t file_length = static_cast<size_t>(buf.st_size);
+    if (offset > file_length || length > file_length - offset) {
+      close(fd);
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Range of ", length, " bytes at offset ", offset,
+                             " is beyond the end of file ", file_path, " which has ", file_length, " bytes");
+    }
+
+    // mmap requires the offset to be a multiple of the page size
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t mapped_offset = offset - (offset % page_size);
+    const size_t mapped_length = length + (offset - mapped_offset);
+
+    void* mapped_base = mmap(nullptr, mapped_length, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(mapped_offset));
+    int mmap_errno = errno;
+
+    // the mapping keeps its own reference to the file
+    close(fd);
+
+    if (mapped_base == MAP_FAILED) {
+      return common::Status(common::SYSTEM, mmap_errno);
+    }
+
+    mapped_memory = MappedMemoryPtr(static_cast<char*>(mapped_base) + (offset - mapped_offset),
+                                    [mapped_base, mapped_length](char*) { munmap(mapped_base, mapped_length); });
+    return Status::OK();
+  }
+
   common::Status LoadDynamicLibrary(const std::string& library_filename, void** handle) const override {
     char* error_str = dlerror();  // clear any old error_str
     *handle = dlopen(library_filename.c_str(), RTLD_NOW | RTLD_LOCAL);
@@ -134,6 +134,75 @@ class WindowsEnv : public Env {
     return Status::OK();
   }
 
+  common::Status GetFileLength(const std::string& file_path, size_t& length) const override {
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(file_path.c_str(), GetFileExInfoStandard, &attributes)) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "GetFileAttributesEx ", file_path, " fail, errcode = ", GetLastError());
+    }
+    length = static_cast<size_t>((static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow);
+    return Status::OK();
+  }
+
+  common::Status MapFileIntoMemory(const std::string& file_path, size_t offset, size_t length,
+                                   MappedMemoryPtr& mapped_memory) const override {
+    mapped_memory.reset();
+    if (length == 0) {
+      return Status::OK();
+    }
+
+    HANDLE file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_READONLY, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "open file ", file_path, " fail, errcode = ", GetLastError());
+    }
+
+    // accessing a view beyond the end of the file raises an access violation, so check the range first
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+      DWORD size_error_code = GetLastError();
+      CloseHandle(file_handle);
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "GetFileSizeEx ", file_path, " fail, errcode = ", size_error_code);
+    }
+
+    const size_t file_length = static_cast<size_t>(file_size.QuadPart);
+    if (offset > file_length || length > file_length - offset) {
+      CloseHandle(file_handle);
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Range of ", length, " bytes at offset ", offset,
+                             " is beyond the end of file ", file_path, " which has ", file_length, " bytes");
+    }
+
+    HANDLE file_mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    DWORD error_code = GetLastError();
+    CloseHandle(file_handle);
+    if (file_mapping_handle == nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "CreateFileMapping ", file_path, " fail, errcode = ", error_code);
+    }
+
+    // MapViewOfFile requires the offset to be a multiple of the allocation granularity
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    const size_t granularity = static_cast<size_t>(sysinfo.dwAllocationGranularity);
+    const uint64_t mapped_offset = static_cast<uint64_t>(offset - (offset % granularity));
+    const size_t mapped_length = length + static_cast<size_t>(offset - mapped_offset);
+
+    void* mapped_base = MapViewOfFile(file_mapping_handle, FILE_MAP_READ,
+                                      static_cast<DWORD>(mapped_offset >> 32),
+                                      static_cast<DWORD>(mapped_offset & 0xFFFFFFFF),
+                                      mapped_length);
+    error_code = GetLastError();
+
+    // the view keeps its own reference to the mapping object
+    CloseHandle(file_mapping_handle);
+
+    if (mapped_base == nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "MapViewOfFile ", file_path, " fail, errcode = ", error_code);
+    }
+
+    mapped_memory = MappedMemoryPtr(static_cast<char*>(mapped_base) + (offset - mapped_offset),
+                                    [mapped_base](char*) { UnmapViewOfFile(mapped_base); });
+    return Status::OK();
+  }
+
   virtual Status LoadDynamicLibrary(const std::string& library_filename, void** handle) const override {
     *handle = ::LoadLibraryA(library_filename.c_str());
     if (!handle)
@@ -15,6 +15,7 @@
 #include "core/framework/op_kernel_context_internal.h"
 #include "core/framework/sequential_executor.h"
 #include "core/framework/session_state.h"
+#include "core/framework/subgraph_execution_context.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/utils.h"
 #include "core/providers/cpu/tensor/utils.h"
@@ -99,8 +100,9 @@ class LoopImpl {
   Status Execute();
 
  private:
-  NameMLValMap CreateInitialFeeds();
-  void UpdateFeeds(const std::vector<MLValue>& last_output, NameMLValMap& next_input);
+  // create the feeds for the first iteration. feed_names is populated with the matching subgraph input names.
+  std::vector<MLValue> CreateInitialFeeds(std::vector<std::string>& feed_names);
+  void UpdateFeeds(const std::vector<MLValue>& last_output, std::vector<MLValue>& next_input);
 
   // create the single Loop output from a collection of per-iteration outputs
   Status ConcatenateLoopOutput(std::vector<MLValue>& per_iteration_output, int output_index);
@@ -226,36 +228,39 @@ Status LoopImpl::Initialize() {
   return status;
 }
 
-NameMLValMap LoopImpl::CreateInitialFeeds() {
-  NameMLValMap feeds;
+std::vector<MLValue> LoopImpl::CreateInitialFeeds(std::vector<std::string>& feed_names) {
+  std::vector<MLValue> feeds;
 
   feeds.reserve(num_subgraph_inputs_ + implicit_inputs_.size());
+  feed_names = subgraph_input_names_;
+  feed_names.reserve(num_subgraph_inputs_ + implicit_inputs_.size());
 
-  feeds[subgraph_input_names_[0]] = iter_num_mlvalue_;
-  feeds[subgraph_input_names_[1]] = condition_mlvalue_;
+  feeds.push_back(iter_num_mlvalue_);
+  feeds.push_back(condition_mlvalue_);
 
   // populate loop carried var inputs which conveniently start at slot 2 in both the Loop and subgraph inputs
   for (int i = 2; i < num_subgraph_inputs_; ++i) {
-    feeds[subgraph_input_names_[i]] = *context_.GetInputMLValue(i);
+    feeds.push_back(*context_.GetInputMLValue(i));
   }
 
   // pass in implicit inputs as feeds.
   for (auto& entry : implicit_inputs_) {
     ORT_ENFORCE(entry.second, "All implicit inputs should have MLValue instances by now. ",
                 entry.first, " did not.");
-    feeds[entry.first] = *entry.second;
+    feed_names.push_back(entry.first);
+    feeds.push_back(*entry.second);
   }
 
   return feeds;
 }
 
-void LoopImpl::UpdateFeeds(const std::vector<MLValue>& last_output, NameMLValMap& next_input) {
+void LoopImpl::UpdateFeeds(const std::vector<MLValue>& last_output, std::vector<MLValue>& next_input) {
   // last_output: cond, loop vars..., loop output...
   // next_input: iter_num, cond, loop_vars. iter_num is re-used
 
   // simple copy for cond and loop carried vars.
   for (int i = 1; i < num_subgraph_inputs_; ++i) {
-    next_input[subgraph_input_names_[i]] = last_output[i - 1];  // skip iter_num in input
+    next_input[i] = last_output[i - 1];  // skip iter_num in input
   }
 
   // save loop outputs as we have to concatenate at the end
@@ -305,9 +310,13 @@ Status LoopImpl::ConcatenateLoopOutput(std::vector<MLValue>& per_iteration_outpu
 Status LoopImpl::Execute() {
   auto status = Status::OK();
 
-  NameMLValMap feeds{CreateInitialFeeds()};
+  std::vector<std::string> feed_names;
+  std::vector<MLValue> feeds{CreateInitialFeeds(feed_names)};
   std::vector<MLValue> fetches;
 
+  // bind the feeds and fetches once, and re-use the execution frame for all iterations
+  SubgraphExecutionContext subgraph_context{session_state_, feed_names, subgraph_output_names_};
+
   auto& iter_num_value = *iter_num_mlvalue_.GetMutable<Tensor>()->MutableData<int64_t>();
 
   while (iter_num_value < max_trip_count_ && *condition_mlvalue_.GetMutable<Tensor>()->MutableData<bool>()) {
@@ -319,8 +328,7 @@ Status LoopImpl::Execute() {
     // loop carried variables can change shape across iterations, and we don't know how many iterations
     // there will be to allocate loop outputs upfront. due to that we can't use a custom fetch allocator
     // for any outputs
-    status = utils::ExecuteGraph(session_state_, feeds, subgraph_output_names_, fetches, {},
-                                 /*sequential_execution*/ true, context_.GetTerminateFlag(), context_.Logger());
+    status = subgraph_context.Execute(feeds, fetches, {}, context_.GetTerminateFlag(), context_.Logger());
     ORT_RETURN_IF_ERROR(status);
 
     condition_mlvalue_ = fetches[0];
@@ -356,7 +364,7 @@ Status LoopImpl::Execute() {
     // no iterations.
     // copy input loop carried vars to output.
     for (int i = 0; i < num_loop_carried_vars_; ++i) {
-      copy_tensor_from_mlvalue_to_output(feeds[subgraph_input_names_[i + 2]], i);  // skip iter# and cond
+      copy_tensor_from_mlvalue_to_output(feeds[i + 2], i);  // skip iter# and cond
     }
 
     // create empty outputs for loop outputs
@@ -150,10 +150,6 @@ Status Scan<8>::Compute(OpKernelContext* ctx) const {
   auto* session_state = ctx_internal->SubgraphSessionState("body");
   ORT_ENFORCE(session_state, "Subgraph SessionState was not found for 'body' attribute.");
 
-  // TODO:
-  //       Consider how usage of ExecutionFrame and SequentialExecutor can be optimized
-  //         - initial implementation is focused on making it work, rather than optimizing.
-
   Scan8Impl scan_impl{*ctx_internal, *session_state, num_scan_inputs_, input_directions_};
 
   auto status = scan_impl.Initialize();
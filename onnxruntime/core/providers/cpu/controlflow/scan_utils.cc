@@ -16,6 +16,7 @@
 #include "core/framework/mldata_type_utils.h"
 #include "core/framework/op_kernel_context_internal.h"
 #include "core/framework/sequential_executor.h"
+#include "core/framework/subgraph_execution_context.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/utils.h"
 
@@ -120,31 +121,41 @@ Status IterateSequence(OpKernelContextInternal& context,
                 "num_variadic_inputs matched the subgraph inputs or required inputs.");
   }
 
-  NameMLValMap feeds;
+  // feeds are the variadic inputs in the subgraph input order, followed by the implicit inputs
+  std::vector<std::string> feed_names;
+  std::vector<MLValue> feeds;
   std::vector<MLValue> fetches;
   std::unordered_map<size_t, IExecutor::CustomAllocator> fetch_allocators;
+  feed_names.reserve(num_variadic_inputs + implicit_inputs.size());
+  feeds.resize(num_variadic_inputs);
   feeds.reserve(num_variadic_inputs + implicit_inputs.size());
   fetches.resize(num_variadic_outputs);
 
+  for (int input = 0; input < num_variadic_inputs; ++input) {
+    // the ordering of the Scan inputs should match the ordering of the subgraph inputs
+    feed_names.push_back((*graph_inputs)[input]->Name());
+  }
+
   // pass in implicit inputs as feeds.
   for (auto& entry : implicit_inputs) {
     ORT_ENFORCE(entry.second, "All implicit inputs should have MLValue instances by now. ", entry.first, " did not.");
-    feeds[entry.first] = *entry.second;
+    feed_names.push_back(entry.first);
+    feeds.push_back(*entry.second);
   }
 
+  // bind the feeds and fetches once, and re-use the execution frame for all iterations
+  SubgraphExecutionContext subgraph_context{session_state, feed_names, subgraph_output_names};
+
   int64_t seq_no = 0;
   for (; seq_no < seq_length; ++seq_no) {
     for (int input = 0; input < num_variadic_inputs; ++input) {
-      // the ordering of the Scan inputs should match the ordering of the subgraph inputs
-      auto name = (*graph_inputs)[input]->Name();
-
       if (input < num_loop_state_variables) {
         // add loop state variable input
-        feeds[name] = loop_state_variables[input].Input();
+        feeds[input] = loop_state_variables[input].Input();
       } else {
         // add sliced input
         auto& iterator = scan_input_stream_iterators[input - num_loop_state_variables];
-        feeds[name] = *iterator;
+        feeds[input] = *iterator;
 
         ++iterator;
       }
@@ -177,9 +188,8 @@ Status IterateSequence(OpKernelContextInternal& context,
       }
     }
 
-    // Create Executor and run graph.
-    status = utils::ExecuteGraph(session_state, feeds, subgraph_output_names, fetches, fetch_allocators,
-                                 /*sequential_execution*/ true, context.GetTerminateFlag(), context.Logger());
+    // Run graph, re-using the execution frame from the previous iteration.
+    status = subgraph_context.Execute(feeds, fetches, fetch_allocators, context.GetTerminateFlag(), context.Logger());
     ORT_RETURN_IF_ERROR(status);
 
     // cycle the LoopStateVariable input/output in preparation for the next iteration
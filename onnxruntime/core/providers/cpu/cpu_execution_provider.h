@@ -13,6 +13,9 @@ namespace onnxruntime {
 // Information needed to construct CPU execution providers.
 struct CPUExecutionProviderInfo {
   bool create_arena{true};
+  ArenaShrinkOptions arena_shrink_options;
+  // serve small allocations from per-thread caches in the arena. see BFCArena.
+  bool enable_arena_thread_cache{false};
 
   explicit CPUExecutionProviderInfo(bool use_arena)
       : create_arena(use_arena) {}
@@ -26,6 +29,8 @@ class CPUExecutionProvider : public IExecutionProvider {
  public:
   explicit CPUExecutionProvider(const CPUExecutionProviderInfo& info) {
     DeviceAllocatorRegistrationInfo device_info({OrtMemTypeDefault, [](int) { return std::make_unique<CPUAllocator>(); }, std::numeric_limits<size_t>::max()});
+    device_info.shrink_options = info.arena_shrink_options;
+    device_info.enable_thread_cache = info.enable_arena_thread_cache;
 #ifdef USE_JEMALLOC
     ORT_UNUSED_PARAMETER(info);
     //JEMalloc already has memory pool, so just use device allocator.
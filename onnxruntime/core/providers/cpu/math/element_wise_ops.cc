@@ -3,6 +3,7 @@
 
 #include "core/providers/cpu/math/element_wise_ops.h"
 #include <unsupported/Eigen/SpecialFunctions>
+#include "core/mlas/inc/mlas.h"
 
 namespace onnxruntime {
 
@@ -318,8 +319,105 @@ ONNX_CPU_OPERATOR_KERNEL(
     KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
     Erf<float>);
 
+namespace {
+
+// Computes the binary operation of two float tensors with multidirectional
+// broadcasting using MLAS. The output tensor must already have the broadcast
+// output shape.
+void MlasBroadcastTensors(MLAS_BINARY_OPERATION_KIND kind, const Tensor& input0, const Tensor& input1, Tensor& output) {
+  const std::vector<int64_t>& output_dims = output.Shape().GetDims();
+  const size_t rank = output_dims.size();
+
+  // Pad the input shapes with leading ones to the rank of the output.
+  std::vector<int64_t> input0_dims(rank, 1);
+  std::vector<int64_t> input1_dims(rank, 1);
+  const std::vector<int64_t>& dims0 = input0.Shape().GetDims();
+  const std::vector<int64_t>& dims1 = input1.Shape().GetDims();
+  std::copy(dims0.begin(), dims0.end(), input0_dims.end() - dims0.size());
+  std::copy(dims1.begin(), dims1.end(), input1_dims.end() - dims1.size());
+
+  MlasBroadcastBinaryOperation(kind,
+                               rank,
+                               input0_dims.data(),
+                               input1_dims.data(),
+                               output_dims.data(),
+                               input0.template Data<float>(),
+                               input1.template Data<float>(),
+                               output.template MutableData<float>());
+}
+
+// Computes a binary operation with MLAS if the element type and the rank of
+// the output are supported. Returns false if the caller must use the Eigen
+// broadcast loop instead.
+template <typename T>
+bool BroadcastTwoMlas(OpKernelContext& /*context*/, MLAS_BINARY_OPERATION_KIND /*kind*/) {
+  return false;
+}
+
+template <>
+bool BroadcastTwoMlas<float>(OpKernelContext& context, MLAS_BINARY_OPERATION_KIND kind) {
+  const Tensor& input0 = *context.Input<Tensor>(0);
+  const Tensor& input1 = *context.Input<Tensor>(1);
+
+  Broadcaster broadcaster(input0.Shape().GetDims(), input1.Shape().GetDims());
+  if (broadcaster.output_shape_.size() > MLAS_MAXIMUM_BROADCAST_DIMENSIONS) {
+    return false;
+  }
+
+  Tensor& output = *context.Output(0, TensorShape(broadcaster.output_shape_));
+  MlasBroadcastTensors(kind, input0, input1, output);
+  return true;
+}
+
+// Variadic form of BroadcastTwoMlas for float tensors, which reduces the inputs
+// pairwise through temporary tensors in the same way as BroadcastVariadic.
+bool BroadcastVariadicMlas(const Node& node, OpKernelContext& context, MLAS_BINARY_OPERATION_KIND kind) {
+  auto input_count = node.InputArgCount().front();
+  if (input_count < 2) {
+    return false;
+  }
+
+  for (int i = 0; i < input_count; i++) {
+    if (context.Input<Tensor>(i)->Shape().NumDimensions() > MLAS_MAXIMUM_BROADCAST_DIMENSIONS) {
+      return false;
+    }
+  }
+
+  std::unique_ptr<Tensor> tempInput;
+  std::unique_ptr<Tensor> tempOutput;
+
+  TensorAllocator<float> tensorAllocator(context);
+
+  for (int i = 0; i < input_count - 1; i++) {
+    auto& tensor0 = tempInput ? *tempInput : *context.Input<Tensor>(0);
+    auto& tensor1 = *context.Input<Tensor>(i + 1);
+
+    Broadcaster broadcaster(tensor0.Shape().GetDims(), tensor1.Shape().GetDims());
+    TensorShape output_shape(broadcaster.output_shape_);
+
+    // Create a temporary output for all but the last iteration, which goes to the real output
+    Tensor* p_output{};
+    if (i == input_count - 2)
+      p_output = context.Output(0, output_shape);
+    else {
+      tempOutput = tensorAllocator.Allocate(output_shape);
+      p_output = tempOutput.get();
+    }
+
+    MlasBroadcastTensors(kind, tensor0, tensor1, *p_output);
+
+    tempInput = std::move(tempOutput);
+  }
+  return true;
+}
+
+}  // namespace
+
 template <typename T>
 Status Add<T>::Compute(OpKernelContext* context) const {
+  if (BroadcastTwoMlas<T>(*context, MlasAddOperation)) {
+    return Status::OK();
+  }
   return BroadcastTwo<T, T>(
       *context,
       [](EigenVectorMap<T> output, T input0, ConstEigenVectorMap<T> input1) { output = input0 + input1.array(); },
@@ -329,6 +427,9 @@ Status Add<T>::Compute(OpKernelContext* context) const {
 
 template <typename T>
 Status Sub<T>::Compute(OpKernelContext* context) const {
+  if (BroadcastTwoMlas<T>(*context, MlasSubtractOperation)) {
+    return Status::OK();
+  }
   return BroadcastTwo<T, T>(
       *context,
       [](EigenVectorMap<T> output, T input0, ConstEigenVectorMap<T> input1) { output = input0 - input1.array(); },
@@ -338,6 +439,9 @@ Status Sub<T>::Compute(OpKernelContext* context) const {
 
 template <typename T>
 Status Mul<T>::Compute(OpKernelContext* context) const {
+  if (BroadcastTwoMlas<T>(*context, MlasMultiplyOperation)) {
+    return Status::OK();
+  }
   return BroadcastTwo<T, T>(
       *context,
       [](EigenVectorMap<T> output, T input0, ConstEigenVectorMap<T> input1) { output = input0 * input1.array(); },
@@ -347,6 +451,9 @@ Status Mul<T>::Compute(OpKernelContext* context) const {
 
 template <typename T>
 Status Div<T>::Compute(OpKernelContext* context) const {
+  if (BroadcastTwoMlas<T>(*context, MlasDivideOperation)) {
+    return Status::OK();
+  }
   return BroadcastTwo<T, T>(
       *context,
       [](EigenVectorMap<T> output, T input0, ConstEigenVectorMap<T> input1) { output = input0 / input1.array(); },
@@ -462,6 +569,9 @@ Status Sum_6<float>::Compute(OpKernelContext* ctx) const {
 
 template <>
 Status Sum_8<float>::Compute(OpKernelContext* context) const {
+  if (BroadcastVariadicMlas(Node(), *context, MlasAddOperation)) {
+    return Status::OK();
+  }
   return BroadcastVariadic<float, float>(
       Node(), *context,
       [](EigenVectorMap<float> output, float input0, ConstEigenVectorMap<float> input1) { output = input0 + input1.array(); },
@@ -489,6 +599,9 @@ Status Min_6<float>::Compute(OpKernelContext* ctx) const {
 
 template <>
 Status Min_8<float>::Compute(OpKernelContext* context) const {
+  if (BroadcastVariadicMlas(Node(), *context, MlasMinimumOperation)) {
+    return Status::OK();
+  }
   return BroadcastVariadic<float, float>(
       Node(), *context,
       [](EigenVectorMap<float> output, float input0, ConstEigenVectorMap<float> input1) { output = input1.array().min(input0); },
@@ -516,6 +629,9 @@ Status Max_6<float>::Compute(OpKernelContext* ctx) const {
 
 template <>
 Status Max_8<float>::Compute(OpKernelContext* context) const {
+  if (BroadcastVariadicMlas(Node(), *context, MlasMaximumOperation)) {
+    return Status::OK();
+  }
   return BroadcastVariadic<float, float>(
       Node(), *context,
       [](EigenVectorMap<float> output, float input0, ConstEigenVectorMap<float> input1) { output = input1.array().max(input0); },
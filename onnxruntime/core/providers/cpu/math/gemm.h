@@ -7,6 +7,7 @@
 #include "core/framework/op_kernel.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
+#include "core/mlas/inc/mlas.h"
 #include "gemm_helper.h"
 
 namespace onnxruntime {
@@ -29,6 +30,39 @@ class Gemm : public OpKernel {
     ORT_ENFORCE(info.GetAttr<float>("beta", &beta_).IsOK());
   }
 
+  Status PrePack(const Tensor& tensor, int input_idx, bool& is_packed) override {
+    is_packed = false;
+
+#if defined(USE_MLAS) && !defined(USE_MKLDNN)
+    // only pack the weights W, which are matrix B of the SGEMM operation.
+    if (input_idx != 1 || tensor.Shape().NumDimensions() != 2) {
+      return Status::OK();
+    }
+
+    const size_t K = static_cast<size_t>(trans_B_ == CblasNoTrans ? tensor.Shape()[0] : tensor.Shape()[1]);
+    const size_t N = static_cast<size_t>(trans_B_ == CblasNoTrans ? tensor.Shape()[1] : tensor.Shape()[0]);
+
+    const size_t packed_w_size = MlasSgemmPackBSize(N, K);
+    if (packed_w_size == 0) {
+      return Status::OK();
+    }
+
+    auto pack_w = [&](void* packed_w_data) {
+      MlasSgemmPackB(trans_B_, N, K, tensor.template Data<T_W>(), static_cast<size_t>(tensor.Shape()[1]),
+                     packed_w_data);
+    };
+    ORT_RETURN_IF_ERROR(Info().GetPrePackedBuffer(tensor, trans_B_ == CblasNoTrans ? "PackB" : "PackBTrans",
+                                                  packed_w_size, pack_w, packed_w_));
+
+    is_packed = true;
+#else
+    // math::Gemm does not use MLAS in this configuration.
+    ORT_UNUSED_PARAMETER(tensor);
+    ORT_UNUSED_PARAMETER(input_idx);
+#endif
+    return Status::OK();
+  }
+
   Status Compute(OpKernelContext* context) const override {
     const auto X = context->Input<Tensor>(0);
     const auto W = context->Input<Tensor>(1);
@@ -95,18 +129,33 @@ class Gemm : public OpKernel {
     }
 
     // W * x
-    math::Gemm<T_X, CPUMathUtil>(
-        trans_A_,
-        trans_B_,
-        M,
-        N,
-        K,
-        alpha_,
-        X->template Data<T_X>(),
-        W->template Data<T_W>(),
-        beta_,
-        y_data,
-        &CPUMathUtil::Instance());
+    if (packed_w_ != nullptr) {
+      MlasSgemmPacked(
+          trans_A_,
+          static_cast<size_t>(M),
+          static_cast<size_t>(N),
+          static_cast<size_t>(K),
+          alpha_,
+          X->template Data<T_X>(),
+          static_cast<size_t>(trans_A_ == CblasNoTrans ? K : M),
+          packed_w_.get(),
+          beta_,
+          y_data,
+          static_cast<size_t>(N));
+    } else {
+      math::Gemm<T_X, CPUMathUtil>(
+          trans_A_,
+          trans_B_,
+          M,
+          N,
+          K,
+          alpha_,
+          X->template Data<T_X>(),
+          W->template Data<T_W>(),
+          beta_,
+          y_data,
+          &CPUMathUtil::Instance());
+    }
 
     FuseActivation<T_Y>(activation_, y_data, M * N, leaky_relu_alpha_);
 
@@ -119,6 +168,10 @@ class Gemm : public OpKernel {
   float alpha_;
   float beta_;
 
+  // weights W packed by MlasSgemmPackB when they are a constant initializer.
+  // shared with other sessions when the initializer is.
+  std::shared_ptr<void> packed_w_;
+
 protected:
   // For fused gemm + activation
   std::string activation_;
@@ -5,6 +5,7 @@
 
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
+#include "core/mlas/inc/mlas.h"
 #include "matmul_helper.h"
 
 namespace onnxruntime {
@@ -16,6 +17,39 @@ ONNX_CPU_OPERATOR_VERSIONED_KERNEL(
   KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
   MatMul<float>);
 
+template <>
+Status MatMul<float>::PrePack(const Tensor& tensor, int input_idx, bool& is_packed) {
+  is_packed = false;
+
+#if defined(USE_MLAS) && !defined(USE_MKLDNN)
+  // only pack matrix B when it's a 2D initializer, so that every batch of
+  // matrix A multiplies the same matrix B.
+  if (input_idx != 1 || tensor.Shape().NumDimensions() != 2) {
+    return Status::OK();
+  }
+
+  const size_t K = static_cast<size_t>(tensor.Shape()[0]);
+  const size_t N = static_cast<size_t>(tensor.Shape()[1]);
+
+  const size_t packed_b_size = MlasSgemmPackBSize(N, K);
+  if (packed_b_size == 0) {
+    return Status::OK();
+  }
+
+  auto pack_b = [&](void* packed_b_data) {
+    MlasSgemmPackB(CblasNoTrans, N, K, tensor.Data<float>(), N, packed_b_data);
+  };
+  ORT_RETURN_IF_ERROR(Info().GetPrePackedBuffer(tensor, "PackB", packed_b_size, pack_b, packed_b_));
+
+  is_packed = true;
+#else
+  // math::Gemm does not use MLAS in this configuration.
+  ORT_UNUSED_PARAMETER(tensor);
+  ORT_UNUSED_PARAMETER(input_idx);
+#endif
+  return Status::OK();
+}
+
 template <>
 Status MatMul<float>::Compute(OpKernelContext* ctx) const {
   const Tensor* left_X = ctx->Input<Tensor>(0);
@@ -26,6 +60,25 @@ Status MatMul<float>::Compute(OpKernelContext* ctx) const {
 
   Tensor* Y = ctx->Output(0, helper.OutputShape());
 
+  if (packed_b_ != nullptr) {
+    const size_t M = static_cast<size_t>(helper.M());
+    const size_t N = static_cast<size_t>(helper.N());
+    const size_t K = static_cast<size_t>(helper.K());
+
+    if (M == 0 || N == 0) {
+      return Status::OK();
+    }
+
+    for (size_t i = 0; i < helper.OutputOffsets().size(); i++) {
+      MlasSgemmPacked(CblasNoTrans, M, N, K, 1.0f,
+                      left_X->template Data<float>() + helper.LeftOffsets()[i], K,
+                      packed_b_.get(), 0.0f,
+                      Y->template MutableData<float>() + helper.OutputOffsets()[i], N);
+    }
+
+    return Status::OK();
+  }
+
   // TODO: replace it with GemmBatch for performance, it's OK for now as GemmBatch unrolls as well
   for (int i = 0; i < helper.OutputOffsets().size(); i++) {
     math::Gemm<float, CPUMathUtil>(
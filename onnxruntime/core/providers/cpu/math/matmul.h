@@ -15,7 +15,14 @@ class MatMul final : public OpKernel {
       : OpKernel(info) {
   }
 
+  Status PrePack(const Tensor& tensor, int input_idx, bool& is_packed) override;
+
   Status Compute(OpKernelContext* context) const override;
+
+ private:
+  // matrix B packed by MlasSgemmPackB when it is a constant 2D initializer.
+  // shared with other sessions when the initializer is.
+  std::shared_ptr<void> packed_b_;
 };
 
 }  // namespace onnxruntime
@@ -18,23 +18,10 @@
 * limitations under the License.
 */
 
-// disable noisy warning about use of std::copy_n by gsl::copy. gsl_algorithm does the same thing
-// but that's too late for the disable to work
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning(disable : 4996)
-#endif
-#include <algorithm>
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif
-
 #include "core/providers/cpu/math/softmax_shared.h"
-#include "core/util/math.h"
-#include "core/util/math_cpuonly.h"
+#include "core/mlas/inc/mlas.h"
 
-#include "gsl/gsl_algorithm"
-#include "gsl/gsl_util"
+#include <sstream>
 
 namespace onnxruntime {
 
@@ -42,11 +29,8 @@ common::Status SoftmaxCPU(const int64_t N,
                           const int64_t D,
                           const float* Xdata,
                           float* Ydata,
-                          float* scale,
-                          const float* sum_multiplier,
-                          bool logarithmic,
-                          float* rowmax) {
-  // the Math functions SoftmaxCPU uses only support int32_t as input, so enforce that
+                          bool logarithmic) {
+  // the sizes are limited to int32_t to match the other math functions of the CPU provider
   if (N * D > INT32_MAX || N > INT32_MAX || D > INT32_MAX) {
     std::ostringstream ss;
     ss << "SoftmaxCPU inputs N, D and N * D must be < " << INT32_MAX << ". N=" << N << ", D=" << D;
@@ -55,35 +39,9 @@ common::Status SoftmaxCPU(const int64_t N,
     return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, msg);
   }
 
-  const int n = gsl::narrow_cast<int>(N);
-  const int d = gsl::narrow_cast<int>(D);
-  const int nd = gsl::narrow_cast<int>(N * D);
-
-  math::RowwiseMax<float, CPUMathUtil>(n, d, Xdata, rowmax, nullptr);
-
-  // Put the intermediate result X - max(X) into Y by first copying X to Y, and then subtracting max from each entry
-  gsl::copy(gsl::make_span(Xdata, nd), gsl::make_span(Ydata, nd));
-
-  math::Gemm<float, CPUMathUtil>(CblasNoTrans, CblasNoTrans, n, d, 1, -1, rowmax, sum_multiplier, 1, Ydata, nullptr);
-
-  // Exponentiation
-  math::Exp<float, CPUMathUtil>(nd, Ydata, Ydata, nullptr);
-  math::Gemv<float, CPUMathUtil>(CblasNoTrans, n, d, 1, Ydata, sum_multiplier, 0, scale, nullptr);
-
-  // Do division
-  if (!logarithmic) {
-    for (int i = 0; i < N; ++i) {
-      for (int j = 0; j < D; ++j) {
-        Ydata[i * D + j] /= scale[i];
-      }
-    }
-  } else {
-    for (int i = 0; i < N; ++i) {
-      for (int j = 0; j < D; ++j) {
-        Ydata[i * D + j] = Xdata[i * D + j] - rowmax[i] - log(fmaxf(scale[i], 1e-20f));
-      }
-    }
-  }
+  // MLAS makes one pass over each row for the maximum, a fused pass that computes and sums the
+  // exponentials, and a pass that normalizes the output, and splits the rows across threads.
+  MlasComputeSoftmax(Xdata, Ydata, static_cast<size_t>(N), static_cast<size_t>(D), logarithmic);
 
   return Status::OK();
 }
@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/cpu/ml/tree_ensemble_common.h"
+
+namespace onnxruntime {
+namespace ml {
+
+constexpr int64_t TreeEnsembleNodes::kRowBlockSize;
+constexpr size_t TreeEnsembleNodes::kTreeBlockSize;
+
+TreeEnsembleNodes::TreeEnsembleNodes(const std::vector<int64_t>& nodes_treeids,
+                                     const std::vector<int64_t>& nodes_nodeids,
+                                     const std::vector<int64_t>& nodes_featureids,
+                                     const std::vector<float>& nodes_values,
+                                     const std::vector<NODE_MODE>& nodes_modes,
+                                     const std::vector<int64_t>& nodes_truenodeids,
+                                     const std::vector<int64_t>& nodes_falsenodeids,
+                                     const std::vector<int64_t>& missing_tracks_true,
+                                     const std::vector<int64_t>& target_treeids,
+                                     const std::vector<int64_t>& target_nodeids,
+                                     const std::vector<int64_t>& target_ids,
+                                     const std::vector<float>& target_weights,
+                                     int64_t target_count)
+    : target_count_(target_count) {
+  const size_t node_count = nodes_treeids.size();
+  ORT_ENFORCE(node_count < static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  ORT_ENFORCE(target_treeids.size() == target_nodeids.size());
+  ORT_ENFORCE(target_treeids.size() == target_ids.size());
+  ORT_ENFORCE(target_treeids.size() == target_weights.size());
+
+  const int64_t kOffset = 4000000000L;
+  const bool use_missing_tracks_true = missing_tracks_true.size() == node_count;
+
+  // make an index so the children and the leaves can be found from their ids
+  std::unordered_map<int64_t, size_t> indices;
+  for (size_t i = 0; i < node_count; ++i) {
+    int64_t id = nodes_treeids[i] * kOffset + nodes_nodeids[i];
+    ORT_ENFORCE(indices.insert(std::make_pair(id, i)).second,
+                "Node id ", nodes_nodeids[i], " appears more than once in tree ", nodes_treeids[i]);
+  }
+
+  // resolve the children, the nodes nobody points at are the roots
+  std::vector<size_t> truenodes(node_count);
+  std::vector<size_t> falsenodes(node_count);
+  std::vector<int64_t> parents(node_count, 0);
+  for (size_t i = 0; i < node_count; ++i) {
+    if (nodes_modes[i] == NODE_MODE::LEAF) continue;
+    ORT_ENFORCE(nodes_featureids[i] >= 0 && nodes_featureids[i] < (int64_t{1} << 24),
+                "Invalid feature id ", nodes_featureids[i], " in tree ", nodes_treeids[i]);
+    // they must be in the same tree
+    auto it = indices.find(nodes_treeids[i] * kOffset + nodes_truenodeids[i]);
+    ORT_ENFORCE(it != indices.end());
+    truenodes[i] = it->second;
+    parents[it->second]++;
+    it = indices.find(nodes_treeids[i] * kOffset + nodes_falsenodeids[i]);
+    ORT_ENFORCE(it != indices.end());
+    falsenodes[i] = it->second;
+    parents[it->second]++;
+  }
+
+  std::vector<size_t> roots;
+  for (size_t i = 0; i < node_count; ++i) {
+    if (parents[i] == 0) {
+      roots.push_back(i);
+    }
+  }
+
+  // every node must be reachable from a root without going around a cycle
+  {
+    std::vector<int64_t> pending(parents);
+    std::vector<size_t> ready(roots);
+    size_t visited = 0;
+    while (!ready.empty()) {
+      size_t i = ready.back();
+      ready.pop_back();
+      ++visited;
+      if (nodes_modes[i] == NODE_MODE::LEAF) continue;
+      if (--pending[truenodes[i]] == 0) ready.push_back(truenodes[i]);
+      if (--pending[falsenodes[i]] == 0) ready.push_back(falsenodes[i]);
+    }
+    ORT_ENFORCE(visited == node_count, "The tree ensemble contains a cycle.");
+  }
+
+  // lay out each tree depth first, the true branch directly after its parent
+  std::vector<int32_t> positions(node_count, -1);
+  std::vector<size_t> order;
+  order.reserve(node_count);
+  std::vector<size_t> stack;
+  for (size_t root : roots) {
+    stack.push_back(root);
+    while (!stack.empty()) {
+      size_t i = stack.back();
+      stack.pop_back();
+      if (positions[i] >= 0) continue;  // shared by several parents
+      positions[i] = static_cast<int32_t>(order.size());
+      order.push_back(i);
+      if (nodes_modes[i] != NODE_MODE::LEAF) {
+        stack.push_back(falsenodes[i]);
+        stack.push_back(truenodes[i]);
+      }
+    }
+    roots_.push_back(positions[root]);
+  }
+
+  // leafnode data, these are the votes that leaves do, grouped per leaf
+  std::vector<std::pair<int32_t, size_t>> leaf_votes;
+  for (size_t i = 0, end = target_ids.size(); i < end; ++i) {
+    auto it = indices.find(target_treeids[i] * kOffset + target_nodeids[i]);
+    if (it == indices.end() || nodes_modes[it->second] != NODE_MODE::LEAF) continue;
+    if (target_ids[i] < 0 || target_ids[i] >= target_count_) continue;
+    leaf_votes.push_back(std::make_pair(positions[it->second], i));
+  }
+  std::stable_sort(leaf_votes.begin(), leaf_votes.end(),
+                   [](const std::pair<int32_t, size_t>& v1, const std::pair<int32_t, size_t>& v2) {
+                     return v1.first < v2.first;
+                   });
+
+  nodes_.resize(node_count);
+  for (size_t n = 0; n < node_count; ++n) {
+    size_t i = order[n];
+    TreeNodeElement& node = nodes_[n];
+    node.mode = static_cast<uint32_t>(nodes_modes[i]);
+    node.missing_tracks_true = use_missing_tracks_true && missing_tracks_true[i] != 0;
+    node.value = nodes_values[i];
+    if (nodes_modes[i] == NODE_MODE::LEAF) {
+      node.feature_id = 0;
+      node.truenode_index = 0;
+      node.falsenode_index = 0;
+    } else {
+      node.feature_id = static_cast<uint32_t>(nodes_featureids[i]);
+      node.truenode_index = positions[truenodes[i]];
+      node.falsenode_index = positions[falsenodes[i]];
+    }
+  }
+
+  leaf_weights_.reserve(leaf_votes.size());
+  for (const auto& vote : leaf_votes) {
+    TreeNodeElement& leaf = nodes_[vote.first];
+    if (leaf.falsenode_index == 0) {
+      leaf.truenode_index = static_cast<int32_t>(leaf_weights_.size());
+    }
+    leaf.falsenode_index++;
+    leaf_weights_.push_back({static_cast<int32_t>(target_ids[vote.second]), target_weights[vote.second]});
+  }
+}
+
+}  // namespace ml
+}  // namespace onnxruntime
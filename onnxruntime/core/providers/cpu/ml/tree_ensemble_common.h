@@ -0,0 +1,191 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+#include "core/common/common.h"
+#include "ml_common.h"
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace onnxruntime {
+namespace ml {
+
+// A tree node packed into 16 bytes. The nodes of a tree are stored contiguously
+// in depth first order, so the true branch of a node immediately follows it.
+// For a leaf, truenode_index and falsenode_index hold the first index into the
+// leaf weights and the number of weights.
+struct TreeNodeElement {
+  uint32_t feature_id : 24;
+  uint32_t mode : 7;
+  uint32_t missing_tracks_true : 1;
+  float value;
+  int32_t truenode_index;
+  int32_t falsenode_index;
+};
+
+static_assert(sizeof(TreeNodeElement) == 16, "TreeNodeElement is expected to be 16 bytes");
+
+struct TreeLeafWeight {
+  int32_t target_id;
+  float value;
+};
+
+// Flattened representation of the trees of TreeEnsembleClassifier and
+// TreeEnsembleRegressor shared by both kernels.
+class TreeEnsembleNodes {
+ public:
+  TreeEnsembleNodes(const std::vector<int64_t>& nodes_treeids,
+                    const std::vector<int64_t>& nodes_nodeids,
+                    const std::vector<int64_t>& nodes_featureids,
+                    const std::vector<float>& nodes_values,
+                    const std::vector<NODE_MODE>& nodes_modes,
+                    const std::vector<int64_t>& nodes_truenodeids,
+                    const std::vector<int64_t>& nodes_falsenodeids,
+                    const std::vector<int64_t>& missing_tracks_true,
+                    const std::vector<int64_t>& target_treeids,
+                    const std::vector<int64_t>& target_nodeids,
+                    const std::vector<int64_t>& target_ids,
+                    const std::vector<float>& target_weights,
+                    int64_t target_count);
+
+  size_t TreeCount() const { return roots_.size(); }
+
+  // Adds the weights of the leaves reached by each of the N rows of x_data to
+  // scores, a row major N x target_count buffer, and sets the matching entries
+  // of has_scores. Blocks of rows are evaluated against one tree at a time so
+  // the nodes of the tree stay in cache. The blocks are distributed over
+  // threads when built with OpenMP; for small batches the trees are split
+  // across threads instead.
+  template <typename T>
+  void ComputeScores(const T* x_data, int64_t N, int64_t stride,
+                     float* scores, unsigned char* has_scores) const;
+
+ private:
+  template <typename T>
+  const TreeNodeElement* ProcessTreeNodeLeave(int32_t root, const T* x_data) const;
+
+  template <typename T>
+  void ComputeBlock(const T* x_data, int64_t row_count, int64_t stride, size_t tree_start, size_t tree_end,
+                    float* scores, unsigned char* has_scores) const;
+
+  std::vector<TreeNodeElement> nodes_;
+  std::vector<TreeLeafWeight> leaf_weights_;
+  std::vector<int32_t> roots_;
+  int64_t target_count_;
+
+  static constexpr int64_t kRowBlockSize = 64;
+  static constexpr size_t kTreeBlockSize = 32;
+};
+
+template <typename T>
+inline const TreeNodeElement* TreeEnsembleNodes::ProcessTreeNodeLeave(int32_t root, const T* x_data) const {
+  const TreeNodeElement* node = nodes_.data() + root;
+  for (;;) {
+    NODE_MODE mode = static_cast<NODE_MODE>(node->mode);
+    if (mode == NODE_MODE::LEAF) {
+      return node;
+    }
+    T val = x_data[node->feature_id];
+    float threshold = node->value;
+    bool condition;
+    switch (mode) {
+      case NODE_MODE::BRANCH_LEQ:
+        condition = val <= threshold;
+        break;
+      case NODE_MODE::BRANCH_LT:
+        condition = val < threshold;
+        break;
+      case NODE_MODE::BRANCH_GTE:
+        condition = val >= threshold;
+        break;
+      case NODE_MODE::BRANCH_GT:
+        condition = val > threshold;
+        break;
+      case NODE_MODE::BRANCH_EQ:
+        condition = val == threshold;
+        break;
+      default:
+        condition = val != threshold;
+        break;
+    }
+    if (!condition && node->missing_tracks_true) {
+      condition = std::isnan(static_cast<float>(val));
+    }
+    node = nodes_.data() + (condition ? node->truenode_index : node->falsenode_index);
+  }
+}
+
+template <typename T>
+void TreeEnsembleNodes::ComputeBlock(const T* x_data, int64_t row_count, int64_t stride,
+                                     size_t tree_start, size_t tree_end,
+                                     float* scores, unsigned char* has_scores) const {
+  for (size_t j = tree_start; j < tree_end; ++j) {
+    const int32_t root = roots_[j];
+    for (int64_t i = 0; i < row_count; ++i) {
+      const TreeNodeElement* leaf = ProcessTreeNodeLeave(root, x_data + i * stride);
+      float* row_scores = scores + i * target_count_;
+      unsigned char* row_has_scores = has_scores + i * target_count_;
+      for (int32_t k = leaf->truenode_index, end = k + leaf->falsenode_index; k < end; ++k) {
+        const TreeLeafWeight& weight = leaf_weights_[k];
+        row_scores[weight.target_id] += weight.value;
+        row_has_scores[weight.target_id] = 1;
+      }
+    }
+  }
+}
+
+template <typename T>
+void TreeEnsembleNodes::ComputeScores(const T* x_data, int64_t N, int64_t stride,
+                                      float* scores, unsigned char* has_scores) const {
+  const int64_t block_count = (N + kRowBlockSize - 1) / kRowBlockSize;
+  const int64_t tree_block_count = static_cast<int64_t>((roots_.size() + kTreeBlockSize - 1) / kTreeBlockSize);
+
+  // splitting the trees only pays off if the blocks of trees run in parallel,
+  // as it costs extra buffers and a reduction.
+#ifdef USE_OPENMP
+  const bool split_trees = block_count == 1 && tree_block_count > 1 && omp_get_max_threads() > 1;
+#else
+  const bool split_trees = false;
+#endif
+
+  if (!split_trees) {
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int64_t b = 0; b < block_count; ++b) {
+      const int64_t row_start = b * kRowBlockSize;
+      ComputeBlock(x_data + row_start * stride, std::min(kRowBlockSize, N - row_start), stride,
+                   0, roots_.size(), scores + row_start * target_count_, has_scores + row_start * target_count_);
+    }
+    return;
+  }
+
+  // Too few rows to keep the threads busy, so evaluate blocks of trees into
+  // separate buffers and reduce them in order.
+  const size_t score_count = static_cast<size_t>(N * target_count_);
+  std::vector<float> partial_scores(tree_block_count * score_count, 0.f);
+  std::vector<unsigned char> partial_has_scores(tree_block_count * score_count, 0);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int64_t b = 0; b < tree_block_count; ++b) {
+    const size_t tree_start = static_cast<size_t>(b) * kTreeBlockSize;
+    ComputeBlock(x_data, N, stride, tree_start, std::min(tree_start + kTreeBlockSize, roots_.size()),
+                 partial_scores.data() + b * score_count, partial_has_scores.data() + b * score_count);
+  }
+
+  for (int64_t b = 0; b < tree_block_count; ++b) {
+    const float* block_scores = partial_scores.data() + b * score_count;
+    const unsigned char* block_has_scores = partial_has_scores.data() + b * score_count;
+    for (size_t k = 0; k < score_count; ++k) {
+      scores[k] += block_scores[k];
+      has_scores[k] |= block_has_scores[k];
+    }
+  }
+}
+
+}  // namespace ml
+}  // namespace onnxruntime
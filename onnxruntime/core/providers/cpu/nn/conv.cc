@@ -6,6 +6,55 @@
 
 namespace onnxruntime {
 
+template <>
+Status Conv<float>::PrePack(const Tensor& tensor, int input_idx, bool& is_packed) {
+  // the original filter is still needed by the other convolution algorithms
+  is_packed = false;
+
+  // only transform a constant 3x3 filter with unit strides and dilations,
+  // which is the only case where MlasConvPrepare selects the Winograd algorithm
+  const TensorShape& shape = tensor.Shape();
+  if (input_idx != 1 || shape.NumDimensions() != 4 || shape[2] != 3 || shape[3] != 3 ||
+      group_ <= 0 || shape[0] % group_ != 0) {
+    return Status::OK();
+  }
+  for (auto stride : strides_) {
+    if (stride != 1) {
+      return Status::OK();
+    }
+  }
+  for (auto dilation : dilations_) {
+    if (dilation != 1) {
+      return Status::OK();
+    }
+  }
+
+  // MlasConvPrepare uses the 4x4 output tile unless the output is smaller than
+  // that, in which case Compute transforms the filter on each call.
+  const size_t output_tile_size = 4;
+  const size_t group_count = static_cast<size_t>(group_);
+  const size_t filter_count = static_cast<size_t>(shape[0] / group_);
+  const size_t input_channels = static_cast<size_t>(shape[1]);
+
+  const size_t transformed_size = MlasConvWinogradGetTransformedFilterSize(
+      output_tile_size, group_count, filter_count, input_channels);
+  if (transformed_size == 0) {
+    return Status::OK();
+  }
+
+  auto transform = [&](void* transformed_data) {
+    MlasConvWinogradTransformFilter(output_tile_size, group_count, filter_count, input_channels,
+                                    tensor.Data<float>(), static_cast<float*>(transformed_data));
+  };
+  ORT_RETURN_IF_ERROR(Info().GetPrePackedBuffer(tensor,
+                                                "Winograd:tile=" + std::to_string(output_tile_size) +
+                                                    ":group=" + std::to_string(group_count),
+                                                sizeof(float) * transformed_size, transform, winograd_filter_));
+  winograd_output_tile_size_ = output_tile_size;
+
+  return Status::OK();
+}
+
 template <>
 Status Conv<float>::Compute(OpKernelContext* context) const {
   size_t num_inputs = OpKernel::Node().InputDefs().size();
@@ -85,9 +134,30 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
     auto working_data = WorkingBufferSize > 0 ? alloc->Alloc(sizeof(float) * WorkingBufferSize) : nullptr;
     BufferUniquePtr working_buffer(working_data, BufferDeleter(alloc));
 
+    // the Winograd algorithm uses a transformed filter, which is cached by
+    // PrePack for constant filters
+    const float* filter_data = W->template Data<float>();
+    BufferUniquePtr transformed_filter_buffer;
+
+    if (Parameters.Algorithm == MlasConvAlgorithmWinograd) {
+      const size_t output_tile_size = Parameters.u.Winograd.OutputTileSize;
+      if (winograd_filter_ != nullptr && winograd_output_tile_size_ == output_tile_size) {
+        filter_data = static_cast<const float*>(winograd_filter_.get());
+      } else {
+        const size_t transformed_size = MlasConvWinogradGetTransformedFilterSize(
+            output_tile_size, Parameters.GroupCount, Parameters.FilterCount, Parameters.InputChannels);
+        auto transformed_data = alloc->Alloc(sizeof(float) * transformed_size);
+        transformed_filter_buffer = BufferUniquePtr(transformed_data, BufferDeleter(alloc));
+        MlasConvWinogradTransformFilter(output_tile_size, Parameters.GroupCount, Parameters.FilterCount,
+                                        Parameters.InputChannels, filter_data,
+                                        static_cast<float*>(transformed_data));
+        filter_data = static_cast<const float*>(transformed_data);
+      }
+    }
+
     MlasConv(&Parameters,
              Xdata,
-             W->template Data<float>(),
+             filter_data,
              B != nullptr ? B->template Data<float>() : nullptr,
              static_cast<float*>(working_buffer.get()),
              Ydata);
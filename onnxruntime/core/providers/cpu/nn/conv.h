@@ -27,7 +27,16 @@ class Conv : public OpKernel, public ConvBase {
   Conv(const OpKernelInfo& info) : OpKernel(info), ConvBase(info) {
   }
 
+  Status PrePack(const Tensor& tensor, int input_idx, bool& is_packed) override;
+
   Status Compute(OpKernelContext* context) const override;
+
+ private:
+  // filter transformed by MlasConvWinogradTransformFilter when it is a
+  // constant 3x3 initializer. shared with other sessions when the
+  // initializer is.
+  std::shared_ptr<void> winograd_filter_;
+  size_t winograd_output_tile_size_ = 0;
 };
 
 }  // namespace onnxruntime
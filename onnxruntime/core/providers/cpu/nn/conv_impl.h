@@ -24,6 +24,14 @@
 
 namespace onnxruntime {
 
+template <typename T>
+Status Conv<T>::PrePack(const Tensor& tensor, int input_idx, bool& is_packed) {
+  ORT_UNUSED_PARAMETER(tensor);
+  ORT_UNUSED_PARAMETER(input_idx);
+  is_packed = false;
+  return Status::OK();
+}
+
 template <typename T>
 Status Conv<T>::Compute(OpKernelContext* context) const {
   size_t num_inputs = OpKernel::Node().InputDefs().size();
@@ -147,6 +155,9 @@ Status Conv<T>::Compute(OpKernelContext* context) const {
   return Status::OK();
 }
 
+template <>
+Status Conv<float>::PrePack(const Tensor& tensor, int input_idx, bool& is_packed);
+
 template <>
 Status Conv<float>::Compute(OpKernelContext* context) const;
 
@@ -9,6 +9,11 @@ namespace onnxruntime {
 
 template <typename T, typename PoolType>
 Status Pool<T, PoolType>::Compute(OpKernelContext* context) const {
+  return ComputeGeneric(context);
+}
+
+template <typename T, typename PoolType>
+Status Pool<T, PoolType>::ComputeGeneric(OpKernelContext* context) const {
   const Tensor* X = context->Input<Tensor>(0);
   const TensorShape& x_shape = X->Shape();
 
@@ -209,6 +214,18 @@ Status Pool<float, AveragePool>::Compute(OpKernelContext* context) const {
   return PoolBase::Compute(context, count_include_pad_ ? MlasAveragePoolingIncludePad : MlasAveragePoolingExcludePad);
 }
 
+template <>
+Status Pool<float, LpPool>::Compute(OpKernelContext* context) const {
+  // Use MLAS pooling for the L1 and L2 norms.
+  if (pool_context_.p() == 1) {
+    return PoolBase::Compute(context, MlasL1NormPooling);
+  }
+  if (pool_context_.p() == 2) {
+    return PoolBase::Compute(context, MlasL2NormPooling);
+  }
+  return ComputeGeneric(context);
+}
+
 template <>
 Status Pool<float, MaxPool<8 /*VERSION*/>>::Compute(OpKernelContext* context) const {
   // Use MLAS pooling if the index output tensor is not used.
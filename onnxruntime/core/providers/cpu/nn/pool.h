@@ -22,6 +22,8 @@ class Pool : public OpKernel, public PoolBase {
   Status Compute(OpKernelContext* context) const override;
 
  private:
+  Status ComputeGeneric(OpKernelContext* context) const;
+
   PoolProcessContext pool_context_;
 };
 
@@ -29,6 +29,9 @@ class PoolProcessContext {
   void init(const OpKernelInfo& info) {
     ORT_ENFORCE(info.GetAttr<int64_t>("p", &p_).IsOK());
   }
+  int64_t p() const {
+    return p_;
+  }
 };
 
 class AveragePool {
@@ -101,7 +104,8 @@ class PoolBase {
  protected:
   PoolBase(const OpKernelInfo& info) {
     op_name_ = info.GetKernelDef().OpName();
-    global_pooling_ = (op_name_ == "GlobalAveragePool" || op_name_ == "GlobalMaxPool" || op_name_ == "GlobalLpPool");
+    global_pooling_ = (op_name_ == "GlobalAveragePool" || op_name_ == "GlobalMaxPool" || op_name_ == "GlobalLpPool" ||
+                       op_name_ == "NchwcGlobalAveragePool" || op_name_ == "NchwcGlobalMaxPool");
 
     if (!global_pooling_) {
       ORT_ENFORCE(info.GetAttrs<int64_t>("kernel_shape", kernel_shape_).IsOK(),
@@ -119,7 +123,7 @@ class PoolBase {
         strides_.resize(kernel_shape_.size(), 1);
       }
 
-      if (op_name_ == "AveragePool") {
+      if (op_name_ == "AveragePool" || op_name_ == "NchwcAveragePool") {
         int64_t temp;
         ORT_ENFORCE(info.GetAttr<int64_t>("count_include_pad", &temp).IsOK());
         count_include_pad_ = (temp != 0);
@@ -35,11 +35,54 @@ REGISTER_UNARY_ELEMENTWISE_KERNEL(ReduceSumSquare, 1);
 REGISTER_UNARY_ELEMENTWISE_KERNEL(ArgMax, 1);
 REGISTER_UNARY_ELEMENTWISE_KERNEL(ArgMin, 1);
 
-// When all reduce axises located at the tail of the dims, quite general cases, transpose and extra
-// copy could be skiped to improve performance, if required by check_no_transpose = true;
-// return value: true means transposedInputData is not created/copied, input tensor data could
-//               be direct use as row major matrix [block_size, blocks], where blocks is the
-//               size of each reduce.
+// The input of a reduction viewed as a row major [outer, reduced, inner] tensor,
+// where the reduced axes are contiguous. The output is [outer, inner].
+struct FastReduceShape {
+  int64_t outer;
+  int64_t reduced;
+  int64_t inner;
+};
+
+// Returns true if the reduced axes form a single run once the dimensions of
+// size 1 are ignored. This covers reducing the trailing axes, the leading axes
+// or a run of middle axes, which can then read the input in place.
+static bool TryGetFastReduceShape(const std::vector<int64_t>& dims, const std::vector<bool>& keep_axis,
+                                  FastReduceShape& shape) {
+  // Merge adjacent axes that are both kept or both reduced.
+  std::vector<std::pair<bool, int64_t>> runs;
+  for (size_t i = 0; i < dims.size(); i++) {
+    if (dims[i] == 1) {
+      continue;
+    }
+    if (!runs.empty() && runs.back().first == keep_axis[i]) {
+      runs.back().second *= dims[i];
+    } else {
+      runs.emplace_back(keep_axis[i], dims[i]);
+    }
+  }
+
+  shape.outer = 1;
+  shape.reduced = 1;
+  shape.inner = 1;
+
+  size_t run = 0;
+  if (run < runs.size() && runs[run].first) {
+    shape.outer = runs[run++].second;
+  }
+  if (run < runs.size() && !runs[run].first) {
+    shape.reduced = runs[run++].second;
+  }
+  if (run < runs.size() && runs[run].first) {
+    shape.inner = runs[run++].second;
+  }
+
+  return run == runs.size();
+}
+
+// When the reduced axes are contiguous, quite general cases, transpose and extra copy could be
+// skipped to improve performance, if requested by passing fast_shape;
+// return value: true means transposedInputData is not created/copied, and fast_shape describes
+//               how to read the input tensor data directly.
 template <typename T>
 bool PrepareForReduce(OpKernelContext* ctx,
                       std::vector<T>& transposedInputData,
@@ -48,7 +91,7 @@ bool PrepareForReduce(OpKernelContext* ctx,
                       int64_t& blocks,
                       const std::vector<int64_t>& axes_,
                       bool keepdims_,
-                      bool check_no_transpose = false) {
+                      FastReduceShape* fast_shape = nullptr) {
   const Tensor* input_tensor_ptr = ctx->Input<Tensor>(0);
   ORT_ENFORCE(input_tensor_ptr != nullptr);
   const Tensor& input = *input_tensor_ptr;
@@ -67,13 +110,6 @@ bool PrepareForReduce(OpKernelContext* ctx,
 
   std::sort(axes.begin(), axes.end());
 
-  // If all reduced axes are located at the tail of the input shape, then copy could be skipped is required
-  bool need_copy = true;
-  if (axes.size() <= ndim && axes.front() == static_cast<int64_t>(ndim - axes.size()) 
-      && axes.back() == static_cast<int64_t>(ndim) - 1) {
-    need_copy = false;
-  }
-
   vector<bool> keep_axis(ndim, true);
   for (auto i : axes) {
     keep_axis[i] = false;
@@ -128,7 +164,7 @@ bool PrepareForReduce(OpKernelContext* ctx,
   block_size = input.Shape().Size() / first_dim;
   blocks = first_dim;
 
-  if (!need_copy && check_no_transpose) {
+  if (fast_shape != nullptr && count > 0 && TryGetFastReduceShape(in_dims, keep_axis, *fast_shape)) {
     return true;
   }
 
@@ -198,6 +234,148 @@ bool PrepareForReduce(OpKernelContext* ctx,
   return false;
 }
 
+// The number of inner elements accumulated together when the reduced axes are
+// not the trailing axes. The accumulators stay in the first level cache while
+// the rows of the reduced axes are streamed.
+constexpr int64_t kReduceInnerBlockSize = 256;
+
+// Reductions over contiguous axes are done by the following operators. Reduce
+// returns the reduction of a contiguous vector. Initialize, Accumulate and
+// Finalize reduce rows element-wise into a vector of accumulators.
+template <typename T>
+struct ReduceSumOp {
+  static T Reduce(const ConstEigenVectorArrayMap<T>& x) { return x.sum(); }
+  static void Initialize(EigenVectorArrayMap<T>& y, const ConstEigenVectorArrayMap<T>& x) { y = x; }
+  static void Accumulate(EigenVectorArrayMap<T>& y, const ConstEigenVectorArrayMap<T>& x) { y += x; }
+  static void Finalize(EigenVectorArrayMap<T>&, int64_t) {}
+};
+
+template <typename T>
+struct ReduceSumSquareOp {
+  static T Reduce(const ConstEigenVectorArrayMap<T>& x) { return x.square().sum(); }
+  static void Initialize(EigenVectorArrayMap<T>& y, const ConstEigenVectorArrayMap<T>& x) { y = x.square(); }
+  static void Accumulate(EigenVectorArrayMap<T>& y, const ConstEigenVectorArrayMap<T>& x) { y += x.square(); }
+  static void Finalize(EigenVectorArrayMap<T>&, int64_t) {}
+};
+
+template <typename T>
+struct ReduceMeanOp {
+  static T Reduce(const ConstEigenVectorArrayMap<T>& x) { return x.mean(); }
+  static void Initialize(EigenVectorArrayMap<T>& y, const ConstEigenVectorArrayMap<T>& x) { y = x; }
+  static void Accumulate(EigenVectorArrayMap<T>& y, const ConstEigenVectorArrayMap<T>& x) { y += x; }
+  static void Finalize(EigenVectorArrayMap<T>& y, int64_t reduced) { y /= static_cast<T>(reduced); }
+};
+
+template <typename T>
+struct ReduceMaxOp {
+  static T Reduce(const ConstEigenVectorArrayMap<T>& x) { return x.maxCoeff(); }
+  static void Initialize(EigenVectorArrayMap<T>& y, const ConstEigenVectorArrayMap<T>& x) { y = x; }
+  static void Accumulate(EigenVectorArrayMap<T>& y, const ConstEigenVectorArrayMap<T>& x) { y = y.max(x); }
+  static void Finalize(EigenVectorArrayMap<T>&, int64_t) {}
+};
+
+template <typename T>
+struct ReduceMinOp {
+  static T Reduce(const ConstEigenVectorArrayMap<T>& x) { return x.minCoeff(); }
+  static void Initialize(EigenVectorArrayMap<T>& y, const ConstEigenVectorArrayMap<T>& x) { y = x; }
+  static void Accumulate(EigenVectorArrayMap<T>& y, const ConstEigenVectorArrayMap<T>& x) { y = y.min(x); }
+  static void Finalize(EigenVectorArrayMap<T>&, int64_t) {}
+};
+
+// FastReduce: reduces the input in place for the shapes found by
+// TryGetFastReduceShape. Work is split across the kept elements.
+template <typename T, typename Op>
+static void FastReduce(const FastReduceShape& shape, const T* input, T* output) {
+  const int64_t outer = shape.outer;
+  const int64_t reduced = shape.reduced;
+  const int64_t inner = shape.inner;
+
+  if (inner == 1) {
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int64_t o = 0; o < outer; ++o) {
+      output[o] = Op::Reduce(ConstEigenVectorArrayMap<T>(input + o * reduced, reduced));
+    }
+    return;
+  }
+
+  const int64_t inner_blocks = (inner + kReduceInnerBlockSize - 1) / kReduceInnerBlockSize;
+  const int64_t task_count = outer * inner_blocks;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int64_t task = 0; task < task_count; ++task) {
+    const int64_t o = task / inner_blocks;
+    const int64_t i = (task % inner_blocks) * kReduceInnerBlockSize;
+    const int64_t n = std::min(kReduceInnerBlockSize, inner - i);
+    const T* x = input + o * reduced * inner + i;
+
+    EigenVectorArrayMap<T> y(output + o * inner + i, n);
+    Op::Initialize(y, ConstEigenVectorArrayMap<T>(x, n));
+    for (int64_t r = 1; r < reduced; ++r) {
+      Op::Accumulate(y, ConstEigenVectorArrayMap<T>(x + r * inner, n));
+    }
+    Op::Finalize(y, reduced);
+  }
+}
+
+// FastReduceLogSumExp: same as FastReduce for ReduceLogSumExp, which needs a
+// pass to find the maximum before the pass that sums the exponentials.
+template <typename T>
+static void FastReduceLogSumExp(const FastReduceShape& shape, const T* input, T* output) {
+  const int64_t outer = shape.outer;
+  const int64_t reduced = shape.reduced;
+  const int64_t inner = shape.inner;
+
+  if (inner == 1) {
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int64_t o = 0; o < outer; ++o) {
+      const T* x = input + o * reduced;
+      const T max_value = ConstEigenVectorArrayMap<T>(x, reduced).maxCoeff();
+      T scaled_exp_sum = 0;
+      for (int64_t r = 0; r < reduced; ++r) {
+        scaled_exp_sum += static_cast<T>(std::exp(x[r] - max_value));
+      }
+      output[o] = static_cast<T>(std::log(scaled_exp_sum) + max_value);
+    }
+    return;
+  }
+
+  const int64_t inner_blocks = (inner + kReduceInnerBlockSize - 1) / kReduceInnerBlockSize;
+  const int64_t task_count = outer * inner_blocks;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int64_t task = 0; task < task_count; ++task) {
+    const int64_t o = task / inner_blocks;
+    const int64_t i = (task % inner_blocks) * kReduceInnerBlockSize;
+    const int64_t n = std::min(kReduceInnerBlockSize, inner - i);
+    const T* x = input + o * reduced * inner + i;
+    T* y = output + o * inner + i;
+
+    EigenVectorArrayMap<T> max_values(y, n);
+    max_values = ConstEigenVectorArrayMap<T>(x, n);
+    for (int64_t r = 1; r < reduced; ++r) {
+      max_values = max_values.max(ConstEigenVectorArrayMap<T>(x + r * inner, n));
+    }
+
+    T scaled_exp_sums[kReduceInnerBlockSize] = {};
+    for (int64_t r = 0; r < reduced; ++r) {
+      for (int64_t j = 0; j < n; ++j) {
+        scaled_exp_sums[j] += static_cast<T>(std::exp(x[r * inner + j] - y[j]));
+      }
+    }
+    for (int64_t j = 0; j < n; ++j) {
+      y[j] = static_cast<T>(std::log(scaled_exp_sums[j]) + y[j]);
+    }
+  }
+}
+
 template <typename T>
 Status ReduceL1<T>::Compute(OpKernelContext* ctx) const {
   std::vector<T> transposedInputData;
@@ -252,10 +430,16 @@ Status ReduceLogSumExp<T>::Compute(OpKernelContext* ctx) const {
   std::vector<T> transposedInputData;
   int64_t block_size, blocks;
   Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+  FastReduceShape fast_shape;
+  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, &fast_shape);
 
   T* output_data = reduced->template MutableData<T>();
 
+  if (no_transpose) {
+    FastReduceLogSumExp<T>(fast_shape, ctx->Input<Tensor>(0)->template Data<T>(), output_data);
+    return Status::OK();
+  }
+
   for (int j = 0; j < block_size; ++j) {
     T max_value = std::numeric_limits<T>::lowest();
     for (int i = 0; i < blocks; ++i) {
@@ -275,10 +459,16 @@ Status ReduceMax<T>::Compute(OpKernelContext* ctx) const {
   std::vector<T> transposedInputData;
   int64_t block_size, blocks;
   Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+  FastReduceShape fast_shape;
+  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, &fast_shape);
 
   T* output_data = reduced->template MutableData<T>();
 
+  if (no_transpose) {
+    FastReduce<T, ReduceMaxOp<T>>(fast_shape, ctx->Input<Tensor>(0)->template Data<T>(), output_data);
+    return Status::OK();
+  }
+
   EigenVectorMap<T> out_vec(output_data, block_size);
   out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().maxCoeff();
 
@@ -290,21 +480,14 @@ Status ReduceMean<T>::Compute(OpKernelContext* ctx) const {
   std::vector<T> transposedInputData;
   int64_t block_size, blocks;
   Tensor* reduced;
-  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, true);
+  FastReduceShape fast_shape;
+  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, &fast_shape);
 
   T* output_data = reduced->template MutableData<T>();
 
   if (no_transpose) {
-    const T* input_data = ctx->Input<Tensor>(0)->template Data<T>();
-
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-    for (int64_t i = 0; i < block_size; ++i) {
-      output_data[i] = ConstEigenVectorMap<T>(input_data + (i * blocks), blocks).mean();
-    }
-  }
-  else {
+    FastReduce<T, ReduceMeanOp<T>>(fast_shape, ctx->Input<Tensor>(0)->template Data<T>(), output_data);
+  } else {
     EigenVectorMap<T> out_vec(output_data, block_size);
     out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().mean();
   }
@@ -317,10 +500,16 @@ Status ReduceMin<T>::Compute(OpKernelContext* ctx) const {
   std::vector<T> transposedInputData;
   int64_t block_size, blocks;
   Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+  FastReduceShape fast_shape;
+  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, &fast_shape);
 
   T* output_data = reduced->template MutableData<T>();
 
+  if (no_transpose) {
+    FastReduce<T, ReduceMinOp<T>>(fast_shape, ctx->Input<Tensor>(0)->template Data<T>(), output_data);
+    return Status::OK();
+  }
+
   EigenVectorMap<T> out_vec(output_data, block_size);
   out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().minCoeff();
 
@@ -347,21 +536,14 @@ Status ReduceSum<T>::Compute(OpKernelContext* ctx) const {
   std::vector<T> transposedInputData;
   int64_t block_size, blocks;
   Tensor* reduced;
-  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, true);
+  FastReduceShape fast_shape;
+  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, &fast_shape);
 
   T* output_data = reduced->template MutableData<T>();
 
   if (no_transpose) {
-    const T* input_data = ctx->Input<Tensor>(0)->template Data<T>();
-
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-    for (int64_t i = 0; i < block_size; ++i) {
-      output_data[i] = ConstEigenVectorMap<T>(input_data + (i * blocks), blocks).sum();
-    }
-  }
-  else {
+    FastReduce<T, ReduceSumOp<T>>(fast_shape, ctx->Input<Tensor>(0)->template Data<T>(), output_data);
+  } else {
     EigenVectorMap<T> out_vec(output_data, block_size);
     out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().sum();
   }
@@ -374,10 +556,16 @@ Status ReduceSumSquare<T>::Compute(OpKernelContext* ctx) const {
   std::vector<T> transposedInputData;
   int64_t block_size, blocks;
   Tensor* reduced;
-  PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_);
+  FastReduceShape fast_shape;
+  bool no_transpose = PrepareForReduce<T>(ctx, transposedInputData, &reduced, block_size, blocks, axes_, keepdims_, &fast_shape);
 
   T* output_data = reduced->template MutableData<T>();
 
+  if (no_transpose) {
+    FastReduce<T, ReduceSumSquareOp<T>>(fast_shape, ctx->Input<Tensor>(0)->template Data<T>(), output_data);
+    return Status::OK();
+  }
+
   EigenVectorMap<T> out_vec(output_data, block_size);
   out_vec = ConstEigenMatrixMap<T>(&transposedInputData[0], block_size, blocks).rowwise().squaredNorm();
 
@@ -178,9 +178,9 @@ class UniDirectionalGru {
                     const ActivationFuncs::Entry& activation_func_g,
                     const float clip,
 #ifdef USE_EIGEN_THREADPOOL
-                    Eigen::NonBlockingThreadPool& ttp_);
+                    Eigen::NonBlockingThreadPool* ttp);
 #else
-                    TaskThreadPool& ttp_);
+                    TaskThreadPool* ttp);
 #endif
 
   void Compute(const gsl::span<const T>& inputs,
@@ -188,6 +188,9 @@ class UniDirectionalGru {
                const int num_directions,
                const gsl::span<const T>& input_weights,
                const gsl::span<const T>& recurrent_weights,
+               const void* packed_input_weights,
+               const void* packed_recurrent_weights_zr,
+               const void* packed_recurrent_weights_h,
                gsl::span<T>& outputs,
                gsl::span<T>& final_hidden_state);
 
@@ -197,10 +200,11 @@ class UniDirectionalGru {
   AllocatorPtr allocator_;
   const logging::Logger& logger_;
 
+  // session thread pool. may be nullptr.
 #ifdef USE_EIGEN_THREADPOOL
-  Eigen::NonBlockingThreadPool& ttp_;
+  Eigen::NonBlockingThreadPool* ttp_;
 #else
-  TaskThreadPool& ttp_;
+  TaskThreadPool* ttp_;
 #endif
 
   int seq_length_;
@@ -215,7 +219,7 @@ class UniDirectionalGru {
   bool use_bias_;
   bool batch_parallel_;
 
-  int hidden_num_threads_ = -1;
+  int num_batch_tasks_ = 1;
 
   IAllocatorUniquePtr<T> outputZRH_ptr_;
   gsl::span<T> outputZRH_;
@@ -249,6 +253,10 @@ class UniDirectionalGru {
   gsl::span<T> inputs_reverse_;
   gsl::span<T> outputs_reverse_;
 
+  // buffers for processing variable length sequences in sorted order
+  IAllocatorUniquePtr<T> packed_inputs_ptr_, packed_outputs_ptr_, packed_final_hidden_state_ptr_;
+  gsl::span<T> packed_inputs_;
+
   deepcpu::ClipWithBiasFuncPtr clip_with_bias_ptr_ = nullptr;
 
   float zr_alpha_ = 0.f, zr_beta_ = 0.f;
@@ -270,6 +278,66 @@ class UniDirectionalGru {
 #define DumpMatrix(...) ((void)0)
 #endif
 
+Status DeepCpuGruOp::PrePack(const Tensor& tensor, int input_idx, bool& is_packed) {
+  is_packed = false;
+
+#if defined(USE_MLAS) && !defined(USE_MKLDNN)
+  // pack the weights W [num_directions, 3*hidden_size, input_size] and R [num_directions, 3*hidden_size, hidden_size]
+  // of each direction, which are matrix B of the transposed GEMMs.
+  if ((input_idx != 1 && input_idx != 2) || tensor.DataType() != DataTypeImpl::GetType<float>()) {
+    return Status::OK();
+  }
+
+  const auto& shape = tensor.Shape();
+  if (shape.NumDimensions() != 3 || shape[0] != num_directions_ || shape[1] != 3 * hidden_size_) {
+    return Status::OK();
+  }
+
+  const size_t N = static_cast<size_t>(shape[1]);
+  const size_t K = static_cast<size_t>(shape[2]);
+  const size_t hidden_size = static_cast<size_t>(hidden_size_);
+
+  // offset is the element offset of matrix B in tensor, which also identifies the packed buffer.
+  // packed is left empty if MLAS doesn't pack a matrix of this size.
+  auto pack = [this, &tensor](size_t offset, size_t N, size_t K, std::shared_ptr<void>& packed) {
+    const size_t packed_size = MlasSgemmPackBSize(N, K);
+    if (packed_size == 0) {
+      return Status::OK();
+    }
+
+    auto pack_fn = [&](void* packed_data) {
+      MlasSgemmPackB(CblasTrans, N, K, tensor.Data<float>() + offset, K, packed_data);
+    };
+    return Info().GetPrePackedBuffer(tensor, "PackBTrans:offset=" + std::to_string(offset), packed_size, pack_fn,
+                                     packed);
+  };
+
+  for (int i = 0; i < num_directions_; ++i) {
+    const size_t offset = i * N * K;
+
+    if (input_idx == 1) {
+      ORT_RETURN_IF_ERROR(pack(offset, N, K, packed_W_[i]));
+      if (packed_W_[i] == nullptr) {
+        return Status::OK();
+      }
+    } else {
+      // R[zr] and R[h] are consecutive in R
+      ORT_RETURN_IF_ERROR(pack(offset, 2 * hidden_size, K, packed_R_zr_[i]));
+      ORT_RETURN_IF_ERROR(pack(offset + 2 * hidden_size * K, hidden_size, K, packed_R_h_[i]));
+      if (packed_R_zr_[i] == nullptr || packed_R_h_[i] == nullptr) {
+        return Status::OK();
+      }
+    }
+  }
+
+  is_packed = true;
+#else
+  ORT_UNUSED_PARAMETER(tensor);
+  ORT_UNUSED_PARAMETER(input_idx);
+#endif
+  return Status::OK();
+}
+
 Status DeepCpuGruOp::Compute(OpKernelContext* context) const {
   const Tensor& X = *context->Input<Tensor>(0);  // inputs. [seq_length, batch_size, input_size]
 
@@ -364,6 +432,8 @@ Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
 
   gsl::span<T> hidden_output_1 = hidden_output.subspan(0, hidden_output_size_per_direction);
 
+  auto* thread_pool = context.GetOperatorThreadPool();
+
   if (direction_ == Direction::kBidirectional) {
     // spans for second direction
     gsl::span<const T> input_weights_2 = input_weights.subspan(input_weights_size_per_direction,
@@ -383,84 +453,56 @@ Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
     gsl::span<T> hidden_output_2 = hidden_output.subspan(hidden_output_size_per_direction,
                                                          hidden_output_size_per_direction);
 
-#ifndef USE_MKLDNN
+    auto compute_direction = [&](int i) {
+      if (i == 0) {
+        std::unique_ptr<detail::UniDirectionalGru<T>> fw = std::make_unique<detail::UniDirectionalGru<T>>(
+            alloc, logger,
+            seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, Direction::kForward,
+            bias_1, initial_hidden_1,
+            activation_funcs_.Entries()[0],
+            activation_funcs_.Entries()[1],
+            clip_, thread_pool);
+        fw->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1,
+                    packed_W_[0].get(), packed_R_zr_[0].get(), packed_R_h_[0].get(), output_1, hidden_output_1);
+      } else {
+        std::unique_ptr<detail::UniDirectionalGru<T>> bw = std::make_unique<detail::UniDirectionalGru<T>>(
+            alloc, logger,
+            seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, Direction::kReverse,
+            bias_2, initial_hidden_2,
+            activation_funcs_.Entries()[2],
+            activation_funcs_.Entries()[3],
+            clip_, thread_pool);
+        bw->Compute(input, sequence_lens_span, num_directions_, input_weights_2, recurrent_weights_2,
+                    packed_W_[1].get(), packed_R_zr_[1].get(), packed_R_h_[1].get(), output_2, hidden_output_2);
+      }
+    };
 
-#ifdef USE_EIGEN_THREADPOOL
-    auto fn =
-#else
-    std::packaged_task<void()> task_fw{
-#endif
-        [&]() {
-#endif  // ! USE_MKLDNN
-          std::unique_ptr<detail::UniDirectionalGru<T>> fw = std::make_unique<detail::UniDirectionalGru<T>>(
-              alloc, logger,
-              seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, Direction::kForward,
-              bias_1, initial_hidden_1,
-              activation_funcs_.Entries()[0],
-              activation_funcs_.Entries()[1],
-              clip_, ttp_);
-          fw->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1, output_1, hidden_output_1);
-#ifndef USE_MKLDNN
-
-#ifndef USE_EIGEN_THREADPOOL
-        }
-  };
-  auto task_results_fw = task_fw.get_future();
-  ttp_.RunTask(std::move(task_fw));
-#else
-        };
-    OrtCondVar cv;
-    OrtMutex lock;
-    bool done = false;
-
-    ttp_.Schedule([&]() {
-      fn();
-      auto ul = std::unique_lock<OrtMutex>(lock);
-      done = true;
-      cv.notify_one();
-    });
-#endif  // USE_EIGEN_THREADPOOL
-
-#endif  // ! USE_MKLDNN
-
-  std::unique_ptr<detail::UniDirectionalGru<T>> bw = std::make_unique<detail::UniDirectionalGru<T>>(
-      alloc, logger,
-      seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, Direction::kReverse,
-      bias_2, initial_hidden_2,
-      activation_funcs_.Entries()[2],
-      activation_funcs_.Entries()[3],
-      clip_, ttp_);
-  bw->Compute(input, sequence_lens_span, num_directions_, input_weights_2, recurrent_weights_2, output_2, hidden_output_2);
-
-#ifndef USE_MKLDNN
-#ifdef USE_EIGEN_THREADPOOL
-  auto ul = std::unique_lock<OrtMutex>(lock);
-    if (!done) cv.wait(ul);
+#ifdef USE_MKLDNN
+    // the MKL-DNN GEMMs are multithreaded, so compute one direction at a time
+    ExecuteLambdaInParallel("Processing directions", compute_direction, 2, 1, nullptr, logger);
 #else
-    task_results_fw.get();
+    ExecuteLambdaInParallel("Processing directions", compute_direction, 2, 1, thread_pool, logger);
 #endif
+  } else {
+    std::unique_ptr<detail::UniDirectionalGru<T>> gru_p = std::make_unique<detail::UniDirectionalGru<T>>(
+        alloc, logger,
+        seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, direction_,
+        bias_1, initial_hidden_1,
+        activation_funcs_.Entries()[0],
+        activation_funcs_.Entries()[1],
+        clip_, thread_pool);
+
+    gru_p->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1,
+                   packed_W_[0].get(), packed_R_zr_[0].get(), packed_R_h_[0].get(), output_1, hidden_output_1);
+  }
 
-#endif  // ! USE_MKLDNN
-}  // namespace onnxruntime
-else {
-  std::unique_ptr<detail::UniDirectionalGru<T>> gru_p = std::make_unique<detail::UniDirectionalGru<T>>(
-      alloc, logger,
-      seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, direction_,
-      bias_1, initial_hidden_1,
-      activation_funcs_.Entries()[0],
-      activation_funcs_.Entries()[1],
-      clip_, ttp_);
-
-  gru_p->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1, output_1, hidden_output_1);
-}
-
-if (!output.empty())
-  DumpMatrix("Y", output.data(), seq_length* num_directions_* batch_size, hidden_size_);
+  if (!output.empty())
+    DumpMatrix("Y", output.data(), seq_length * num_directions_ * batch_size, hidden_size_);
 
-DumpMatrix("Y_h", hidden_output.data(), num_directions_* batch_size, hidden_size_);
+  DumpMatrix("Y_h", hidden_output.data(), num_directions_ * batch_size, hidden_size_);
 
-return Status::OK();
-}  // namespace onnxruntime
+  return Status::OK();
+}
 
 //
 // Implementation of internal helper code
@@ -481,9 +523,9 @@ UniDirectionalGru<T>::UniDirectionalGru(AllocatorPtr allocator,
                                         const ActivationFuncs::Entry& activation_func_g,
                                         const float clip,
 #ifdef USE_EIGEN_THREADPOOL
-                                        Eigen::NonBlockingThreadPool& ttp)
+                                        Eigen::NonBlockingThreadPool* ttp)
 #else
-                                        TaskThreadPool& ttp)
+                                        TaskThreadPool* ttp)
 #endif
     : allocator_(allocator),
       logger_(logger),
@@ -561,14 +603,18 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
                                    const int num_directions,
                                    const gsl::span<const T>& input_weights,
                                    const gsl::span<const T>& recurrent_weights,
+                                   const void* packed_input_weights,
+                                   const void* packed_recurrent_weights_zr,
+                                   const void* packed_recurrent_weights_h,
                                    gsl::span<T>& outputs,
-                                   gsl::span<T>& final_hidden_state) {
+                                   gsl::span<T>& final_hidden_state_arg) {
   using span_T_const_iter = typename gsl::span<T>::const_iterator;
   using span_T_iter = typename gsl::span<T>::iterator;
 
   // copy inputs_arg as we may change it to point to inputs_reverse_
   gsl::span<const T> inputs = inputs_arg;
   gsl::span<const int> sequence_lengths = sequence_lengths_arg;
+  gsl::span<T> final_hidden_state = final_hidden_state_arg;
 
   // if sequence lengths weren't provided, use internal array and init all to seq_length
   if (sequence_lengths.empty()) {
@@ -586,7 +632,28 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
   gsl::span<T> original_outputs = outputs;
   const bool output_sequence = !outputs.empty();
 
-  if (direction_ == kReverse) {
+  // if the sequence lengths differ the batch is sorted by length and only the rows that are still active at
+  // each step are processed. see UniDirectionalLstm::Compute.
+  PackedSequences packed;
+  const bool use_packed = PackSequenceLengths(sequence_lengths, packed);
+
+  if (use_packed) {
+    packed_inputs_ = Allocate(allocator_, packed.TotalRows() * input_size_, packed_inputs_ptr_);
+    PackSequenceInput(inputs, packed_inputs_, packed, batch_size_, input_size_, direction_ == kReverse);
+    inputs = packed_inputs_;
+    sequence_lengths = packed.sorted_lengths;
+
+    if (output_sequence) {
+      outputs = Allocate(allocator_, packed.TotalRows() * hidden_size_, packed_outputs_ptr_);
+    }
+
+    final_hidden_state = Allocate(allocator_, batch_size_ * hidden_size_, packed_final_hidden_state_ptr_);
+
+    // initial state in sorted order
+    std::vector<T> initial_state(batched_hidden0_.cbegin(), batched_hidden0_.cend());
+    PermuteBatchRows<T>(initial_state, batched_hidden0_, packed, hidden_size_, true);
+
+  } else if (direction_ == kReverse) {
     ReverseSequence(inputs, inputs_reverse_, sequence_lengths, seq_length_, batch_size_, input_size_, 1);
     // DumpMatrix("Reversed inputs", inputs_reverse_.data(), seq_length_ * batch_size_, input_size_);
 
@@ -604,7 +671,7 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
 
   const int hidden_size_x2 = 2 * hidden_size_;
   const int hidden_size_x3 = 3 * hidden_size_;
-  const int total_rows = max_sequence_length * batch_size_;
+  const int total_rows = use_packed ? packed.TotalRows() : max_sequence_length * batch_size_;
 
   float alpha = 1.0f;
   float beta = 0.0f;  // zero out outputZRH_ when calling ComputeGemm.
@@ -614,7 +681,7 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
               inputs.cbegin(), inputs.cend(),
               input_size_,
               input_weights.cbegin(), input_weights.cend(),
-              input_size_, beta,
+              input_size_, packed_input_weights, beta,
               outputZRH_.begin(), outputZRH_.end(),
               hidden_size_x3);
 
@@ -633,6 +700,13 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
   if (direction_ == kForward && num_directions == 2)
     output_step_length = 2 * batch_size_ * hidden_size_;
 
+  // number of rows processed in a step, and the offset of the first row of a step in outputZRH_ and outputs
+  auto step_rows = [&](int step) { return use_packed ? packed.ActiveRows(step) : batch_size_; };
+  auto step_first_row = [&](int step) { return use_packed ? packed.step_offsets[step] : step * batch_size_; };
+  auto step_output_offset = [&](int step) {
+    return use_packed ? packed.step_offsets[step] * hidden_size_ : step * output_step_length;
+  };
+
   // convenience end iterators we use in the loops below to detect any bounds issues
   span_T_const_iter batched_bias_WRz_local_end = batched_bias_WRz_.cend();
   span_T_const_iter batched_bias_WRr_local_end = batched_bias_WRr_.cend();
@@ -641,8 +715,8 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
   span_T_const_iter batched_bias_WRh_local_end = batched_bias_WRh_.cend();
 
   if (batch_parallel_) {
-    int fused_hidden_rows = batch_size_ / hidden_num_threads_;
-    if (batch_size_ % hidden_num_threads_ != 0)
+    int fused_hidden_rows = batch_size_ / num_batch_tasks_;
+    if (batch_size_ % num_batch_tasks_ != 0)
       fused_hidden_rows++;
 
     // lambda executed by Eigen::NonBlockingThreadPool
@@ -681,35 +755,42 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
       }
 
       for (int step = 0; step < max_sequence_length; step++) {
+#if defined(DUMP_MATRIXES)
         const std::string row_str = " [row=" + std::to_string(row) + ",seqno=" + std::to_string(step) + "]";
+#endif
+
+        // the batch is sorted by length so once a row has finished so have all the rows after it
+        const int active_rows = std::min(local_fused_hidden_rows, step_rows(step) - row);
+        if (active_rows <= 0)
+          break;
 
-        DumpMatrix("Ht-1" + row_str, &*prev_Ht, local_fused_hidden_rows, hidden_size_);
+        DumpMatrix("Ht-1" + row_str, &*prev_Ht, active_rows, hidden_size_);
 
-        out_added_offset = (step * batch_size_ + row) * hidden_size_x3;
+        out_added_offset = (step_first_row(step) + row) * hidden_size_x3;
 
         // calculate Ht-1*R[zr], and add to the weighted inputs that are in outputZRH_
-        ComputeGemm(local_fused_hidden_rows, hidden_size_x2, hidden_size_, alpha,
+        ComputeGemm(active_rows, hidden_size_x2, hidden_size_, alpha,
                     prev_Ht, prev_Ht_end,
                     hidden_size_,
                     recurrent_weightsZR.cbegin(), recurrent_weightsZR.cend(),
-                    hidden_size_, beta,
+                    hidden_size_, packed_recurrent_weights_zr, beta,
                     outputZRH_.begin() + out_added_offset, outputZRH_.end(),
                     hidden_size_x3);
 
         DumpMatrix("Xt*(W[zr]^T) + Ht-1 * R[zr]" + row_str,
-                   outputZRH_.data() + out_added_offset, local_fused_hidden_rows, hidden_size_x2, 0, hidden_size_x3);
+                   outputZRH_.data() + out_added_offset, active_rows, hidden_size_x2, 0, hidden_size_x3);
 
         if (linear_before_reset_) {
           // copy Rbh to linear output
-          gsl::copy(batched_bias_Rh_.subspan(batched_bias_Rh_local - batched_bias_Rh_.begin(), local_fused_hidden_rows * hidden_size_),
+          gsl::copy(batched_bias_Rh_.subspan(batched_bias_Rh_local - batched_bias_Rh_.begin(), active_rows * hidden_size_),
                     linear_output_.subspan(linear_output_local - linear_output_.begin(), linear_output_local_end - linear_output_local));
 
           // compute Ht-1 * (Rh^T) + Rbh
-          ComputeGemm(local_fused_hidden_rows, hidden_size_, hidden_size_, alpha,
+          ComputeGemm(active_rows, hidden_size_, hidden_size_, alpha,
                       prev_Ht, prev_Ht_end,  // Ht-1
                       hidden_size_,
                       recurrent_weightsH.cbegin(), recurrent_weightsH.cend(),  // Rh^T
-                      hidden_size_, beta,
+                      hidden_size_, packed_recurrent_weights_h, beta,
                       linear_output_local, linear_output_.end(),  // pre: Rbh, post:output
                       hidden_size_);
 
@@ -717,7 +798,7 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
         }
 
         // 1st Set Of Activations
-        for (int r = 0; r < local_fused_hidden_rows; r++) {
+        for (int r = 0; r < active_rows; r++) {
           const T* p_bias_r = use_bias_ ? SafeRawConstPointer<T>(batched_bias_WRr_local + r * hidden_size_,
                                                                  batched_bias_WRr_local_end, hidden_size_)
                                         : nullptr;
@@ -748,8 +829,10 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
           }
         }
 
+#if defined(DUMP_MATRIXES)
         std::string label = linear_before_reset_ ? "rt (.) (Ht-1 * (Rh^T) + Rbh)" : "rt (.) Ht-1";
-        DumpMatrix(label + row_str, &*cur_h_local, local_fused_hidden_rows, hidden_size_);
+#endif
+        DumpMatrix(label + row_str, &*cur_h_local, active_rows, hidden_size_);
 
         if (linear_before_reset_) {
           // input contains rt (.) (Ht-1*(Rh^T) + Rbh)
@@ -757,7 +840,7 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
           // out_H currently contains Xt*(W[zrh]^T).
           auto out_H = outputZRH_.begin() + out_added_offset;
 
-          for (int r = 0; r < local_fused_hidden_rows; r++) {
+          for (int r = 0; r < active_rows; r++) {
             // skip over the inputs with Z and R weights
             out_H += hidden_size_x2;
             for (int h = 0; h < hidden_size_; ++h) {
@@ -767,25 +850,27 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
             }
           }
         } else {
+#if defined(DUMP_MATRIXES)
           label += " * Rh^T";
-          ComputeGemm(local_fused_hidden_rows, hidden_size_, hidden_size_, alpha,
+#endif
+          ComputeGemm(active_rows, hidden_size_, hidden_size_, alpha,
                       cur_h_local, cur_h_local_end,
                       hidden_size_,
                       recurrent_weightsH.cbegin(), recurrent_weightsH.cend(),
-                      hidden_size_, beta,
+                      hidden_size_, packed_recurrent_weights_h, beta,
                       outputZRH_.begin() + out_added_offset + hidden_size_x2, outputZRH_.end(),
                       hidden_size_x3);
         }
 
         DumpMatrix("Xt*(Wh^T) + (" + label + ")" + row_str,
-                   outputZRH_.data() + out_added_offset, local_fused_hidden_rows, hidden_size_,
+                   outputZRH_.data() + out_added_offset, active_rows, hidden_size_,
                    hidden_size_x2, hidden_size_x3);
 
         // 2nd Set of Activations
         span_T_iter output;
         span_T_iter output_end;
         if (output_sequence) {
-          output = outputs.begin() + step * output_step_length + row * hidden_size_;
+          output = outputs.begin() + step_output_offset(step) + row * hidden_size_;
           output_end = outputs.end();
 
         } else {
@@ -793,7 +878,7 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
           output_end = final_hidden_state.end();
         }
 
-        for (int r = 0; r < local_fused_hidden_rows; r++) {
+        for (int r = 0; r < active_rows; r++) {
           if (step >= min_sequence_length && step >= sequence_lengths[row + r]) {
             if (output_sequence) {
               auto fill_output = output + r * hidden_size_;
@@ -886,43 +971,47 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
 
     // for each item in sequence run all calculations
     for (int step = 0; step < max_sequence_length; step++) {
+#if defined(DUMP_MATRIXES)
       const std::string seqno_str = " [seqno=" + std::to_string(step) + "]";
+#endif
+
+      const int active_rows = step_rows(step);
 
-      DumpMatrix("Ht-1" + seqno_str, &*prev_Ht, batch_size_, hidden_size_);
+      DumpMatrix("Ht-1" + seqno_str, &*prev_Ht, active_rows, hidden_size_);
 
-      out_added_offset = (step * batch_size_) * hidden_size_x3;
+      out_added_offset = step_first_row(step) * hidden_size_x3;
 
       // calculate Ht-1*R[zr], and add to the weighted inputs that are in outputZRH_
       // Ht-1 * R[zr] + Xt*(W[zr]^T)
-      ComputeGemm(batch_size_, hidden_size_x2, hidden_size_, alpha,
+      ComputeGemm(active_rows, hidden_size_x2, hidden_size_, alpha,
                   prev_Ht, prev_Ht_end,
                   hidden_size_,
                   recurrent_weightsZR.cbegin(), recurrent_weightsZR.cend(),
-                  hidden_size_, beta,
+                  hidden_size_, packed_recurrent_weights_zr, beta,
                   outputZRH_.begin() + out_added_offset, outputZRH_.end(),
                   hidden_size_x3);
 
       DumpMatrix("Ht-1 * R[zr] + Xt*(W[zr]^T)" + seqno_str,
-                 outputZRH_.data() + out_added_offset, batch_size_, hidden_size_x2, 0, hidden_size_x3);
+                 outputZRH_.data() + out_added_offset, active_rows, hidden_size_x2, 0, hidden_size_x3);
 
       if (linear_before_reset_) {
         // copy Rbh to linear output
         gsl::copy(batched_bias_Rh_.subspan(batched_bias_Rh_local - batched_bias_Rh_.begin(), batched_bias_Rh_local_end - batched_bias_Rh_local), linear_output_);
 
         // compute Ht-1 * (Rh^T) + Rbh
-        ComputeGemm(batch_size_, hidden_size_, hidden_size_, alpha,
+        ComputeGemm(active_rows, hidden_size_, hidden_size_, alpha,
                     prev_Ht, prev_Ht_end,  // Ht-1
                     hidden_size_,
                     recurrent_weightsH.cbegin(), recurrent_weightsH.cend(),  // Rh^T
-                    hidden_size_, beta,
+                    hidden_size_, packed_recurrent_weights_h, beta,
                     linear_output_.begin(), linear_output_.end(),  // pre: Rbh, post:output
                     hidden_size_);
 
-        DumpMatrix("Ht-1 * (Rh^T) + Rbh " + seqno_str, linear_output_.data(), batch_size_, hidden_size_);
+        DumpMatrix("Ht-1 * (Rh^T) + Rbh " + seqno_str, linear_output_.data(), active_rows, hidden_size_);
       }
 
       // 1st Set Of Activations
-      for (int r = 0; r < batch_size_; r++) {
+      for (int r = 0; r < active_rows; r++) {
         const T* p_bias_r = use_bias_ ? SafeRawConstPointer<T>(batched_bias_WRr_local + r * hidden_size_,
                                                                batched_bias_WRr_local_end, hidden_size_)
                                       : nullptr;
@@ -952,8 +1041,10 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
         }
       }
 
+#if defined(DUMP_MATRIXES)
       std::string label = linear_before_reset_ ? "rt (.) (Ht-1 * (Rh^T) + Rbh)" : "rt (.) Ht-1";
-      DumpMatrix(label + seqno_str, &*cur_h_local, batch_size_, hidden_size_);
+#endif
+      DumpMatrix(label + seqno_str, &*cur_h_local, active_rows, hidden_size_);
 
       if (linear_before_reset_) {
         // input contains rt (.) (Ht-1*(Rh^T) + Rbh)
@@ -961,7 +1052,7 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
         // out_H currently contains Xt*(W[zrh]^T).
         auto out_H = outputZRH_.begin() + out_added_offset;
 
-        for (int r = 0; r < batch_size_; r++) {
+        for (int r = 0; r < active_rows; r++) {
           // skip over the inputs with Z and R weights
           out_H += hidden_size_x2;
           for (int h = 0; h < hidden_size_; ++h) {
@@ -971,29 +1062,31 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
           }
         }
       } else {
+#if defined(DUMP_MATRIXES)
         label += " * Rh^T";
+#endif
 
         // out_H currently contains Xt*(Wh^T).
         auto out_H = outputZRH_.begin() + out_added_offset + hidden_size_x2;
 
         // Calculate Xt*(Wh^T) + rt (.) Ht-1 * Rh
-        ComputeGemm(batch_size_, hidden_size_, hidden_size_, alpha,
+        ComputeGemm(active_rows, hidden_size_, hidden_size_, alpha,
                     cur_h_local, cur_h_local_end,  // rt (.) Ht-1
                     hidden_size_,
                     recurrent_weightsH.cbegin(), recurrent_weightsH.cend(),  // Rh^T
-                    hidden_size_, beta,
+                    hidden_size_, packed_recurrent_weights_h, beta,
                     out_H, outputZRH_.end(),
                     hidden_size_x3);
       }
 
       DumpMatrix("Xt*(Wh^T) + (" + label + ")" + seqno_str, outputZRH_.data() + out_added_offset,
-                 batch_size_, hidden_size_, hidden_size_x2, hidden_size_x3);
+                 active_rows, hidden_size_, hidden_size_x2, hidden_size_x3);
 
       //2nd Set of Activations
       span_T_iter output;
       span_T_iter output_end;
       if (output_sequence) {
-        output = outputs.begin() + step * output_step_length;
+        output = outputs.begin() + step_output_offset(step);
         output_end = outputs.end();
 
       } else {
@@ -1001,7 +1094,7 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
         output_end = final_hidden_state.end();
       }
 
-      for (int r = 0; r < batch_size_; r++) {
+      for (int r = 0; r < active_rows; r++) {
         if (step >= min_sequence_length && step >= sequence_lengths[r]) {
           if (output_sequence) {
             auto fill_output = output + r * hidden_size_;
@@ -1058,7 +1151,7 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
         output_gate_(p_ht, p_zt, p_prev_Ht, p_Ht, hidden_size_, h_alpha_, h_beta_);  // calculate ht and Ht
       }
 
-      DumpMatrix("output" + seqno_str, &*output, batch_size_, hidden_size_);
+      DumpMatrix("output" + seqno_str, &*output, active_rows, hidden_size_);
 
       prev_Ht = output;
       prev_Ht_end = output_end;
@@ -1069,17 +1162,24 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
     // copy last output to final_hidden_state
     for (int i = 0; i < batch_size_; i++) {
       const int seq_len = sequence_lengths[i];
-      auto src = outputs.subspan((seq_len - 1) * output_step_length + i * hidden_size_, hidden_size_);
+      auto src = outputs.subspan(step_output_offset(seq_len - 1) + i * hidden_size_, hidden_size_);
       auto dest = final_hidden_state.subspan(i * hidden_size_, hidden_size_);
       gsl::copy(src, dest);
     }
 
-    if (direction_ == kReverse) {
+    if (use_packed) {
+      UnpackSequenceOutput<T>(outputs, original_outputs, packed, seq_length_,
+                              batch_size_, hidden_size_, num_directions, direction_ == kReverse);
+    } else if (direction_ == kReverse) {
       ReverseSequence<T>(outputs, original_outputs,
                          sequence_lengths, seq_length_,
                          batch_size_, hidden_size_, num_directions);
     }
   }
+
+  if (use_packed) {
+    PermuteBatchRows<T>(final_hidden_state, final_hidden_state_arg, packed, hidden_size_, false);
+  }
 }
 
 template <typename T>
@@ -1112,12 +1212,10 @@ void UniDirectionalGru<T>::AllocateBuffers() {
 
 template <typename T>
 void UniDirectionalGru<T>::SetNumThreads() {
-  int threads = std::thread::hardware_concurrency() - 1;
+  // the calling thread processes a share of the batch along with the threads of the session thread pool
+  int threads = ttp_ != nullptr ? static_cast<int>(ttp_->NumThreads()) + 1 : 1;
 
-  if (threads < 1)
-    threads = 1;
-
-  hidden_num_threads_ = threads;
+  num_batch_tasks_ = std::min(threads, batch_size_);
   batch_parallel_ = false;
 
   // for readability of the below logic
@@ -1125,14 +1223,13 @@ void UniDirectionalGru<T>::SetNumThreads() {
   const auto num_columns = hidden_size_;
 
   // parallelize by partitioning the batch rows
-  if (num_rows > 4 ||
-      (num_rows >= 2 && num_columns <= 256) ||
-      (num_rows >= 3 && num_columns <= 512)) {
+  if (num_batch_tasks_ > 1 &&
+      (num_rows > 4 ||
+       (num_rows >= 2 && num_columns <= 256) ||
+       (num_rows >= 3 && num_columns <= 512))) {
     batch_parallel_ = true;
-    VLOGS(logger_, 1) << "Hidden Threads : " << hidden_num_threads_;
+    VLOGS(logger_, 1) << "Batch tasks : " << num_batch_tasks_;
   }
-
-  ORT_ENFORCE(hidden_num_threads_ >= 1);
 }
 }  // namespace detail
 }  // namespace onnxruntime
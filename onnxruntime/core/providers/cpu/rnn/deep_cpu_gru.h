@@ -52,6 +52,8 @@ class DeepCpuGruOp final : public OpKernel {
                                                      activation_func_betas);
   }
 
+  Status PrePack(const Tensor& tensor, int input_idx, bool& is_packed) override;
+
   Status Compute(OpKernelContext* context) const override;
 
   ~DeepCpuGruOp() override = default;
@@ -66,15 +68,12 @@ class DeepCpuGruOp final : public OpKernel {
 
   rnn::detail::ActivationFuncs activation_funcs_;
 
-  // Threadpool for operator. If concurrent Compute calls are possible, it will be shared
-  // across them. mutable due to this.
-  // The alternative would be to create a threadpool in each call to Compute but that would incur thread creation
-  // cost on every call.
-#ifdef USE_EIGEN_THREADPOOL
-  mutable Eigen::NonBlockingThreadPool ttp_{static_cast<int>(std::thread::hardware_concurrency())};
-#else
-  mutable TaskThreadPool ttp_{std::thread::hardware_concurrency()};
-#endif
+  // W, R[zr] and R[h] of each direction packed by MlasSgemmPackB when they are constant initializers.
+  // R[zr] and R[h] are packed separately as they are applied by separate GEMMs.
+  // shared with other sessions when the initializers are.
+  std::shared_ptr<void> packed_W_[2];
+  std::shared_ptr<void> packed_R_zr_[2];
+  std::shared_ptr<void> packed_R_h_[2];
 
   template <typename T>
   Status ComputeImpl(OpKernelContext& context) const;
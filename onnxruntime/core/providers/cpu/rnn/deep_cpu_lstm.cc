@@ -204,9 +204,9 @@ class UniDirectionalLstm {
                      const ActivationFuncs::Entry& activation_func_h,
                      const float clip,
 #ifdef USE_EIGEN_THREADPOOL
-                     Eigen::NonBlockingThreadPool& ttp);
+                     Eigen::NonBlockingThreadPool* ttp);
 #else
-                     TaskThreadPool& ttp);
+                     TaskThreadPool* ttp);
 #endif
 
   void Compute(const gsl::span<const T>& inputs,
@@ -214,6 +214,8 @@ class UniDirectionalLstm {
                const int num_directions,
                const gsl::span<const T>& input_weights,
                const gsl::span<const T>& recurrent_weights,
+               const void* packed_input_weights,
+               const void* packed_recurrent_weights,
                gsl::span<T>& outputs,
                gsl::span<T>& final_hidden_state,
                gsl::span<T>& final_cell_state);
@@ -262,7 +264,7 @@ class UniDirectionalLstm {
   bool use_bias_;
   bool use_peepholes_;
 
-  int hidden_num_threads_ = -1;
+  int num_batch_tasks_ = 1;
 
   IAllocatorUniquePtr<T> output_iofc_ptr_;
   IAllocatorUniquePtr<T> hidden0_ptr_, batched_hidden0_ptr_;
@@ -276,14 +278,20 @@ class UniDirectionalLstm {
   gsl::span<T> internal_memory_cur_, batched_internal_memory_cur_;
   gsl::span<T> batched_internal_memory_clipped_;
 
-  IAllocatorUniquePtr<T> bias_WRi_ptr_, bias_WRf_ptr_, bias_WRo_ptr_, bias_WRc_ptr_;
-  IAllocatorUniquePtr<T> batched_bias_WRi_ptr_, batched_bias_WRf_ptr_, batched_bias_WRo_ptr_, batched_bias_WRc_ptr_;
+  // Wb[iofc] + Rb[iofc] in the same layout as the gates, so the bias of all the gates can be added in one pass.
+  // bias_WRi_ etc. are views of each gate.
+  IAllocatorUniquePtr<T> bias_WR_ptr_;
   IAllocatorUniquePtr<T> peephole_i_ptr_, peephole_f_ptr_, peephole_o_ptr_;
   IAllocatorUniquePtr<T> inputs_reverse_ptr_, outputs_reverse_ptr_;
+  gsl::span<T> bias_WR_;
   gsl::span<T> bias_WRi_, bias_WRf_, bias_WRo_, bias_WRc_;
-  gsl::span<T> batched_bias_WRi_, batched_bias_WRf_, batched_bias_WRo_, *batched_bias_WRc_;
   gsl::span<T> inputs_reverse_, outputs_reverse_;
 
+  // buffers for processing variable length sequences in sorted order
+  IAllocatorUniquePtr<T> packed_inputs_ptr_, packed_outputs_ptr_;
+  IAllocatorUniquePtr<T> packed_final_hidden_state_ptr_, packed_final_cell_state_ptr_;
+  gsl::span<T> packed_inputs_;
+
 #if defined(LSTM_NO_PEEPHOLE_COPY)
   gsl::span<const T> peephole_i_, peephole_f_, peephole_o_;
 #else
@@ -299,15 +307,57 @@ class UniDirectionalLstm {
   ActivationInfo<deepcpu::ActivationFuncPtr> activation_g_;
   ActivationInfo<deepcpu::LstmMergeGatesFuncPtr> activation_h_;
 
+  // session thread pool. may be nullptr.
 #ifdef USE_EIGEN_THREADPOOL
-  Eigen::NonBlockingThreadPool& ttp_;
+  Eigen::NonBlockingThreadPool* ttp_;
 #else
-  TaskThreadPool& ttp_;
+  TaskThreadPool* ttp_;
 #endif
 };
 
 }  // namespace detail
 
+Status DeepCpuLstmOp::PrePack(const Tensor& tensor, int input_idx, bool& is_packed) {
+  is_packed = false;
+
+#if defined(USE_MLAS) && !defined(USE_MKLDNN)
+  // pack the weights W [num_directions, 4*hidden_size, input_size] and R [num_directions, 4*hidden_size, hidden_size]
+  // of each direction, which are matrix B of the transposed GEMMs.
+  if ((input_idx != 1 && input_idx != 2) || tensor.DataType() != DataTypeImpl::GetType<float>()) {
+    return Status::OK();
+  }
+
+  const auto& shape = tensor.Shape();
+  if (shape.NumDimensions() != 3 || shape[0] != num_directions_ || shape[1] != 4 * hidden_size_) {
+    return Status::OK();
+  }
+
+  const size_t N = static_cast<size_t>(shape[1]);
+  const size_t K = static_cast<size_t>(shape[2]);
+
+  const size_t packed_size = MlasSgemmPackBSize(N, K);
+  if (packed_size == 0) {
+    return Status::OK();
+  }
+
+  std::shared_ptr<void>* packed = input_idx == 1 ? packed_W_ : packed_R_;
+
+  for (int i = 0; i < num_directions_; ++i) {
+    auto pack = [&](void* packed_data) {
+      MlasSgemmPackB(CblasTrans, N, K, tensor.Data<float>() + i * N * K, K, packed_data);
+    };
+    ORT_RETURN_IF_ERROR(Info().GetPrePackedBuffer(tensor, "PackBTrans:direction=" + std::to_string(i),
+                                                  packed_size, pack, packed[i]));
+  }
+
+  is_packed = true;
+#else
+  ORT_UNUSED_PARAMETER(tensor);
+  ORT_UNUSED_PARAMETER(input_idx);
+#endif
+  return Status::OK();
+}
+
 Status
 DeepCpuLstmOp::Compute(OpKernelContext* context) const {
   const Tensor& X = *context->Input<Tensor>(0);  // inputs. [seq_length, batch_size, input_size]
@@ -435,6 +485,8 @@ Status DeepCpuLstmOp::ComputeImpl(OpKernelContext& context) const {
 
   gsl::span<T> last_cell_1 = last_cell.subspan(0, last_cell_size_per_direction);
 
+  auto* thread_pool = context.GetOperatorThreadPool();
+
   std::unique_ptr<detail::UniDirectionalLstm<T>> fw;
   std::unique_ptr<detail::UniDirectionalLstm<T>> bw;
 
@@ -473,7 +525,7 @@ Status DeepCpuLstmOp::ComputeImpl(OpKernelContext& context) const {
                                                          activation_funcs_.Entries()[0],
                                                          activation_funcs_.Entries()[1],
                                                          activation_funcs_.Entries()[2],
-                                                         clip_, ttp_);
+                                                         clip_, thread_pool);
 
     bw = std::make_unique<detail::UniDirectionalLstm<T>>(alloc, logger,
                                                          seq_length, batch_size, input_size,
@@ -482,10 +534,12 @@ Status DeepCpuLstmOp::ComputeImpl(OpKernelContext& context) const {
                                                          activation_funcs_.Entries()[3],
                                                          activation_funcs_.Entries()[4],
                                                          activation_funcs_.Entries()[5],
-                                                         clip_, ttp_);
+                                                         clip_, thread_pool);
 
-    fw->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1, output_1, hidden_output_1, last_cell_1);
-    bw->Compute(input, sequence_lens_span, num_directions_, input_weights_2, hidden_weights_2, output_2, hidden_output_2, last_cell_2);
+    fw->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1,
+                packed_W_[0].get(), packed_R_[0].get(), output_1, hidden_output_1, last_cell_1);
+    bw->Compute(input, sequence_lens_span, num_directions_, input_weights_2, hidden_weights_2,
+                packed_W_[1].get(), packed_R_[1].get(), output_2, hidden_output_2, last_cell_2);
   } else {
     fw = std::make_unique<detail::UniDirectionalLstm<T>>(alloc, logger,
                                                          seq_length, batch_size, input_size,
@@ -494,9 +548,10 @@ Status DeepCpuLstmOp::ComputeImpl(OpKernelContext& context) const {
                                                          activation_funcs_.Entries()[0],
                                                          activation_funcs_.Entries()[1],
                                                          activation_funcs_.Entries()[2],
-                                                         clip_, ttp_);
+                                                         clip_, thread_pool);
 
-    fw->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1, output_1, hidden_output_1, last_cell_1);
+    fw->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1,
+                packed_W_[0].get(), packed_R_[0].get(), output_1, hidden_output_1, last_cell_1);
   }
 
   if (!output.empty())
@@ -567,9 +622,9 @@ UniDirectionalLstm<T>::UniDirectionalLstm(AllocatorPtr allocator,
                                           const ActivationFuncs::Entry& activation_func_h,
                                           const float clip,
 #ifdef USE_EIGEN_THREADPOOL
-                                          Eigen::NonBlockingThreadPool& ttp)
+                                          Eigen::NonBlockingThreadPool* ttp)
 #else
-                                          TaskThreadPool& ttp)
+                                          TaskThreadPool* ttp)
 #endif
     : allocator_(allocator),
       logger_(logger),
@@ -626,10 +681,11 @@ void UniDirectionalLstm<T>::AllocateBuffers() {
   output_iofc_ = Allocate(allocator_, hidden_size_ * 4 * batch_size_ * seq_length_, output_iofc_ptr_, fill);
 
   if (use_bias_) {
-    bias_WRi_ = Allocate(allocator_, hidden_size_, bias_WRi_ptr_);
-    bias_WRf_ = Allocate(allocator_, hidden_size_, bias_WRf_ptr_);
-    bias_WRo_ = Allocate(allocator_, hidden_size_, bias_WRo_ptr_);
-    bias_WRc_ = Allocate(allocator_, hidden_size_, bias_WRc_ptr_);
+    bias_WR_ = Allocate(allocator_, 4 * hidden_size_, bias_WR_ptr_);
+    bias_WRi_ = bias_WR_.subspan(0 * hidden_size_, hidden_size_);
+    bias_WRo_ = bias_WR_.subspan(1 * hidden_size_, hidden_size_);
+    bias_WRf_ = bias_WR_.subspan(2 * hidden_size_, hidden_size_);
+    bias_WRc_ = bias_WR_.subspan(3 * hidden_size_, hidden_size_);
   }
 
   if (direction_ == kReverse) {
@@ -736,12 +792,16 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
                                     const int num_directions,
                                     const gsl::span<const T>& input_weights,
                                     const gsl::span<const T>& recurrent_weights,
+                                    const void* packed_input_weights,
+                                    const void* packed_recurrent_weights,
                                     gsl::span<T>& outputs,
-                                    gsl::span<T>& final_hidden_state,
-                                    gsl::span<T>& final_cell_state) {
+                                    gsl::span<T>& final_hidden_state_arg,
+                                    gsl::span<T>& final_cell_state_arg) {
   // copy spans (just T* and size, not data in span) as we may change them
   gsl::span<const T> inputs = inputs_arg;
   gsl::span<const int> sequence_lengths = sequence_lengths_arg;
+  gsl::span<T> final_hidden_state = final_hidden_state_arg;
+  gsl::span<T> final_cell_state = final_cell_state_arg;
 
   // if sequence lengths weren't provided, use internal array and init all to seq_length
   if (sequence_lengths.empty()) {
@@ -769,7 +829,31 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
   gsl::span<T> original_outputs = outputs;
   const bool output_sequence = !outputs.empty();
 
-  if (direction_ == kReverse) {
+  // if the sequence lengths differ the batch is sorted by length and only the rows that are still active at
+  // each step are processed. the inputs are packed, including reversing them if needed, and the results are
+  // written to sorted buffers that are unpacked to the real outputs at the end.
+  PackedSequences packed;
+  const bool use_packed = PackSequenceLengths(sequence_lengths, packed);
+
+  if (use_packed) {
+    packed_inputs_ = Allocate(allocator_, packed.TotalRows() * input_size_, packed_inputs_ptr_);
+    PackSequenceInput(inputs, packed_inputs_, packed, batch_size_, input_size_, direction_ == kReverse);
+    inputs = packed_inputs_;
+    sequence_lengths = packed.sorted_lengths;
+
+    if (output_sequence)
+      outputs = Allocate(allocator_, packed.TotalRows() * hidden_size_, packed_outputs_ptr_);
+
+    final_hidden_state = Allocate(allocator_, batch_size_ * hidden_size_, packed_final_hidden_state_ptr_);
+    final_cell_state = Allocate(allocator_, batch_size_ * hidden_size_, packed_final_cell_state_ptr_);
+
+    // initial state in sorted order
+    std::vector<T> initial_state(batched_hidden0_.cbegin(), batched_hidden0_.cend());
+    PermuteBatchRows<T>(initial_state, batched_hidden0_, packed, hidden_size_, true);
+    std::copy(batched_internal_memory_prev_.cbegin(), batched_internal_memory_prev_.cend(), initial_state.begin());
+    PermuteBatchRows<T>(initial_state, batched_internal_memory_prev_, packed, hidden_size_, true);
+
+  } else if (direction_ == kReverse) {
     ReverseSequence(inputs, inputs_reverse_, sequence_lengths, seq_length_, batch_size_, input_size_, 1);
     inputs = inputs_reverse_;
 
@@ -784,19 +868,26 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
   int32_t min_sequence_length = std::min(seq_length_, *std::min_element(sequence_lengths.cbegin(),
                                                                         sequence_lengths.cend()));
 
+  // number of rows processed in a step, and the offset of the first row of a step in output_iofc_ and outputs
+  auto step_rows = [&](int step) { return use_packed ? packed.ActiveRows(step) : batch_size_; };
+  auto step_first_row = [&](int step) { return use_packed ? packed.step_offsets[step] : step * batch_size_; };
+  auto step_output_offset = [&](int step) {
+    return use_packed ? packed.step_offsets[step] * hidden_size_ : step * output_step_length;
+  };
+
   ///**************************LSTM Calculations****************************/
   float alpha = 1.0f;
   float beta = 0.0f;  // first call to ComputeGemm zeros out any existing data
 
   const int hidden_size_x4 = 4 * hidden_size_;
-  const int total_rows = max_sequence_length * batch_size_;
+  const int total_rows = use_packed ? packed.TotalRows() : max_sequence_length * batch_size_;
 
   // apply the weights to all the inputs and save to output_IOFC
   ComputeGemm(total_rows, hidden_size_x4, input_size_, alpha,
               inputs.cbegin(), inputs.cend(),
               input_size_,
               input_weights.cbegin(), input_weights.cend(),  // W[iofc]
-              input_size_, beta,
+              input_size_, packed_input_weights, beta,
               output_iofc_.begin(), output_iofc_.end(),
               hidden_size_x4);
 
@@ -813,8 +904,8 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
   span_T_const_iter previous_state_end = batched_hidden_state_one_step.end();
 
   if (batch_parallel_) {
-    int fused_hidden_rows = batch_size_ / hidden_num_threads_;
-    if (batch_size_ % hidden_num_threads_ != 0)
+    int fused_hidden_rows = batch_size_ / num_batch_tasks_;
+    if (batch_size_ % num_batch_tasks_ != 0)
       fused_hidden_rows++;
 
     // lambda to do all processing on fused_hidden_rows rows
@@ -838,23 +929,28 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
         const std::string row_str = " [row=" + std::to_string(row) + ",seqno=" + std::to_string(step) + "]";
 #endif
 
-        span_T_iter step_out_IOFC = output_iofc_.begin() + (step * batch_size_ + row) * hidden_size_x4;
+        // the batch is sorted by length so once a row has finished so have all the rows after it
+        const int active_rows = std::min(local_fused_hidden_rows, step_rows(step) - row);
+        if (active_rows <= 0)
+          break;
+
+        span_T_iter step_out_IOFC = output_iofc_.begin() + (step_first_row(step) + row) * hidden_size_x4;
 
         // calculate Xt*(W[iofc]^T) + Ht-t*R[iofc]
-        ComputeGemm(local_fused_hidden_rows, hidden_size_x4, hidden_size_, alpha,
+        ComputeGemm(active_rows, hidden_size_x4, hidden_size_, alpha,
                     previous_state, previous_state_end,  // Ht-1
                     hidden_size_,
                     recurrent_weights.cbegin(), recurrent_weights.cend(),  // R[iofc]
-                    hidden_size_, beta,
+                    hidden_size_, packed_recurrent_weights, beta,
                     step_out_IOFC, output_iofc_.end(),  // input contains Xt*(W[iofc]^T)
                     hidden_size_x4);
 
         DumpMatrix("Xt*(W[iofc]^T) + Ht-t*R[iofc]" + row_str,
-                   &*step_out_IOFC, local_fused_hidden_rows, hidden_size_x4);
+                   &*step_out_IOFC, active_rows, hidden_size_x4);
 
         span_T_iter batched_output, batched_output_end;
         if (output_sequence) {
-          batched_output = outputs.begin() + step * output_step_length;
+          batched_output = outputs.begin() + step_output_offset(step);
           batched_output_end = outputs.end();
 
         } else {
@@ -862,15 +958,15 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
           batched_output_end = final_hidden_state.end();
         }
 
-        span_T_iter step_out_IOFC_end = step_out_IOFC + local_fused_hidden_rows * hidden_size_x4;
+        span_T_iter step_out_IOFC_end = step_out_IOFC + active_rows * hidden_size_x4;
         GateComputations(step_out_IOFC, step_out_IOFC_end,
                          c_prev, C_prev_end,
                          c_prev_clipped, C_prev_clipped_end,
                          batched_output, batched_output_end,
-                         sequence_lengths, min_sequence_length, step, row, local_fused_hidden_rows, output_sequence);
+                         sequence_lengths, min_sequence_length, step, row, active_rows, output_sequence);
 
         // copy last row to final_cell_state
-        for (int lrow = row; lrow < row + local_fused_hidden_rows; ++lrow) {
+        for (int lrow = row; lrow < row + active_rows; ++lrow) {
           if ((step + 1) == sequence_lengths[lrow]) {
             gsl::span<const T> src = batched_internal_memory_prev_.subspan(lrow * hidden_size_, hidden_size_);
             gsl::span<T> dst = final_cell_state.subspan(lrow * hidden_size_, hidden_size_);
@@ -878,16 +974,6 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
           }
         }
 
-        if (output_sequence) {
-          // set to 0 if step >= sequence_length
-          for (int lrow = row; lrow < row + local_fused_hidden_rows; lrow++) {
-            if (step >= min_sequence_length && step >= sequence_lengths[lrow]) {
-              auto output_lrow = outputs.begin() + step * output_step_length + lrow * hidden_size_;
-              std::fill_n(output_lrow, hidden_size_, (T)0);
-            }
-          }
-        }
-
         previous_state = batched_output + row * hidden_size_;
         previous_state_end = batched_output_end;
       }
@@ -909,22 +995,24 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
       const std::string seqno_str = " [seqno=" + std::to_string(step) + "]";
 #endif
 
-      DumpMatrix("previous_state" + seqno_str, &*previous_state, batch_size_, hidden_size_);
+      const int active_rows = step_rows(step);
+
+      DumpMatrix("previous_state" + seqno_str, &*previous_state, active_rows, hidden_size_);
 
-      span_T_iter step_out_IOFC = output_iofc_.begin() + (step * batch_size_) * hidden_size_x4;
+      span_T_iter step_out_IOFC = output_iofc_.begin() + step_first_row(step) * hidden_size_x4;
 
       // calculate Xt*(W[iofc]^T) + Ht-t*R[iofc]
-      ComputeGemm(batch_size_, hidden_size_x4, hidden_size_, alpha,
+      ComputeGemm(active_rows, hidden_size_x4, hidden_size_, alpha,
                   previous_state, previous_state_end,  // Ht-1
                   hidden_size_,
                   recurrent_weights.cbegin(), recurrent_weights.cend(),  // R[iofc]
-                  hidden_size_, beta,
+                  hidden_size_, packed_recurrent_weights, beta,
                   step_out_IOFC, output_iofc_.end(),  // input contains Xt*(W[iofc]^T)
                   hidden_size_x4);
 
       span_T_iter batched_output, batched_output_end;
       if (output_sequence) {
-        batched_output = outputs.begin() + step * output_step_length;
+        batched_output = outputs.begin() + step_output_offset(step);
         batched_output_end = outputs.end();
 
       } else {
@@ -932,31 +1020,21 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
         batched_output_end = final_hidden_state.end();
       }
 
-      span_T_iter step_out_IOFC_end = step_out_IOFC + batch_size_ * hidden_size_x4;
+      span_T_iter step_out_IOFC_end = step_out_IOFC + active_rows * hidden_size_x4;
       GateComputations(step_out_IOFC, step_out_IOFC_end,
                        c_prev, C_prev_end,
                        c_prev_clipped, C_prev_clipped_end,
                        batched_output, batched_output_end,
-                       sequence_lengths, min_sequence_length, step, 0, batch_size_, output_sequence);
+                       sequence_lengths, min_sequence_length, step, 0, active_rows, output_sequence);
 
       // copy last row to final_cell_state
-      for (int lrow = 0; lrow < batch_size_; lrow++) {
+      for (int lrow = 0; lrow < active_rows; lrow++) {
         if ((step + 1) == sequence_lengths[lrow]) {
           gsl::copy(batched_internal_memory_prev_.subspan(lrow * hidden_size_, hidden_size_),
                     final_cell_state.subspan(lrow * hidden_size_, hidden_size_));
         }
       }
 
-      if (output_sequence) {
-        //set to 0 if step >= sequence_length
-        for (int lrow = 0; lrow < batch_size_; lrow++) {
-          if (step >= min_sequence_length && step >= sequence_lengths[lrow]) {
-            auto dst = outputs.begin() + step * output_step_length + lrow * hidden_size_;
-            std::fill_n(dst, hidden_size_, (T)0);
-          }
-        }
-      }
-
       previous_state = batched_output;
       previous_state_end = batched_output_end;
     }
@@ -966,15 +1044,23 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
     // copy last output to final_hidden_state
     for (int i = 0; i < batch_size_; i++) {
       const int seq_len = sequence_lengths[i];
-      auto src = outputs.subspan((seq_len - 1) * output_step_length + i * hidden_size_, hidden_size_);
+      auto src = outputs.subspan(step_output_offset(seq_len - 1) + i * hidden_size_, hidden_size_);
       auto dest = final_hidden_state.subspan(i * hidden_size_, hidden_size_);
       gsl::copy(src, dest);
     }
 
-    if (direction_ == Direction::kReverse)
+    if (use_packed)
+      UnpackSequenceOutput<T>(outputs, original_outputs, packed, seq_length_,
+                              batch_size_, hidden_size_, num_directions, direction_ == Direction::kReverse);
+    else if (direction_ == Direction::kReverse)
       ReverseSequence<T>(outputs, original_outputs, sequence_lengths, seq_length_,
                          batch_size_, hidden_size_, num_directions);
   }
+
+  if (use_packed) {
+    PermuteBatchRows<T>(final_hidden_state, final_hidden_state_arg, packed, hidden_size_, false);
+    PermuteBatchRows<T>(final_cell_state, final_cell_state_arg, packed, hidden_size_, false);
+  }
 }
 
 // #define PREVIOUS_BROKEN_VERSION
@@ -1019,61 +1105,73 @@ void UniDirectionalLstm<T>::GateComputations(span_T_iter& out, span_T_iter& out_
 
     // DumpMatrix("C_prev" + row_str, pCprev_hidden_size, 1, hidden_size_);
 
-    // Input Gate
-    if (use_peepholes_) {
-      deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_i_, 0, hidden_size_),
-                                   pi, hidden_size_);
-    }
+    // C_current. use previous C value as input, and update in-place
+    float* pC_cur = pCprev_hidden_size;
 
-    const float* pBi = use_bias_ ? SafeRawConstPointer<T>(bias_WRi_, 0, hidden_size_) : nullptr;
-    clip_with_bias_ptr_(clip_, pBi, pi, hidden_size_);  // post: pi has input to f() to calculate i
-    activation_f_.func(pi, hidden_size_, activation_f_.alpha, activation_f_.beta);
-    // DumpMatrix("i" + row_str, pi, 1, hidden_size_);
+    if (!use_peepholes_ && !input_forget_) {
+      // the gates only depend on their own inputs, so add the bias to all of them in one pass and
+      // apply f() to the contiguous i, o and f gates with a single call.
+      const float* pB = use_bias_ ? SafeRawConstPointer<T>(bias_WR_, 0, hidden_size_x4) : nullptr;
+      clip_with_bias_ptr_(clip_, pB, pi, hidden_size_x4);
+      activation_f_.func(pi, 3 * hidden_size_, activation_f_.alpha, activation_f_.beta);
+      activation_g_.func(pc, hidden_size_, activation_g_.alpha, activation_g_.beta);
 
-    // Forget Gate
-    if (input_forget_) {
-      for (int i = 0; i < hidden_size_; i++)
-        pf[i] = 1.0f - pi[i];
+      deepcpu::merge_lstm_gates_to_memory(pCprev_hidden_size, pi, pf, pc, pC_cur, hidden_size_);
     } else {
+      // Input Gate
       if (use_peepholes_) {
-        deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_f_, 0, hidden_size_),
-                                     pf, hidden_size_);
+        deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_i_, 0, hidden_size_),
+                                     pi, hidden_size_);
       }
 
-      const float* pBf = use_bias_ ? SafeRawConstPointer<T>(bias_WRf_, 0, hidden_size_) : nullptr;
-      clip_with_bias_ptr_(clip_, pBf, pf, hidden_size_);
-      activation_f_.func(pf, hidden_size_, activation_f_.alpha, activation_f_.beta);
-    }
+      const float* pBi = use_bias_ ? SafeRawConstPointer<T>(bias_WRi_, 0, hidden_size_) : nullptr;
+      clip_with_bias_ptr_(clip_, pBi, pi, hidden_size_);  // post: pi has input to f() to calculate i
+      activation_f_.func(pi, hidden_size_, activation_f_.alpha, activation_f_.beta);
+      // DumpMatrix("i" + row_str, pi, 1, hidden_size_);
 
-    // DumpMatrix("f" + row_str, pf, 1, hidden_size_);
+      // Forget Gate
+      if (input_forget_) {
+        for (int i = 0; i < hidden_size_; i++)
+          pf[i] = 1.0f - pi[i];
+      } else {
+        if (use_peepholes_) {
+          deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_f_, 0, hidden_size_),
+                                       pf, hidden_size_);
+        }
 
-    // Block Gate
-    const float* pBc = use_bias_ ? SafeRawConstPointer<T>(bias_WRc_, 0, hidden_size_) : nullptr;
-    clip_with_bias_ptr_(clip_, pBc, pc, hidden_size_);
-    activation_g_.func(pc, hidden_size_, activation_g_.alpha, activation_g_.beta);
+        const float* pBf = use_bias_ ? SafeRawConstPointer<T>(bias_WRf_, 0, hidden_size_) : nullptr;
+        clip_with_bias_ptr_(clip_, pBf, pf, hidden_size_);
+        activation_f_.func(pf, hidden_size_, activation_f_.alpha, activation_f_.beta);
+      }
 
-    // DumpMatrix("c" + row_str, pc, 1, hidden_size_);
+      // DumpMatrix("f" + row_str, pf, 1, hidden_size_);
+
+      // Block Gate
+      const float* pBc = use_bias_ ? SafeRawConstPointer<T>(bias_WRc_, 0, hidden_size_) : nullptr;
+      clip_with_bias_ptr_(clip_, pBc, pc, hidden_size_);
+      activation_g_.func(pc, hidden_size_, activation_g_.alpha, activation_g_.beta);
+
+      // DumpMatrix("c" + row_str, pc, 1, hidden_size_);
 
-    // C_current. use previous C value as input, and update in-place
-    float* pC_cur = pCprev_hidden_size;
 #ifdef PREVIOUS_BROKEN_VERSION
-    deepcpu::merge_lstm_gates_to_memory(pCprev_hidden_size + b * hidden_size_, pi, pf, pc, pCprev_hidden_size + b * hidden_size_, hidden_size_);
-    // DumpMatrix("C", pCprev_hidden_size + b * hidden_size_, 1, hidden_size_);
+      deepcpu::merge_lstm_gates_to_memory(pCprev_hidden_size + b * hidden_size_, pi, pf, pc, pCprev_hidden_size + b * hidden_size_, hidden_size_);
+      // DumpMatrix("C", pCprev_hidden_size + b * hidden_size_, 1, hidden_size_);
 #else
-    deepcpu::merge_lstm_gates_to_memory(pCprev_hidden_size, pi, pf, pc, pC_cur, hidden_size_);
-    // DumpMatrix("C", pC_cur, 1, hidden_size_);
+      deepcpu::merge_lstm_gates_to_memory(pCprev_hidden_size, pi, pf, pc, pC_cur, hidden_size_);
+      // DumpMatrix("C", pC_cur, 1, hidden_size_);
 #endif
 
-    // Output Gate
-    if (use_peepholes_)
-      deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_o_, 0, hidden_size_),
-                                   po, hidden_size_);
+      // Output Gate
+      if (use_peepholes_)
+        deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_o_, 0, hidden_size_),
+                                     po, hidden_size_);
 
-    // calculate 'ot'
-    const float* pBo = use_bias_ ? SafeRawConstPointer<T>(bias_WRo_, 0, hidden_size_) : nullptr;
-    clip_with_bias_ptr_(clip_, pBo, po, hidden_size_);
-    activation_f_.func(po, hidden_size_, activation_f_.alpha, activation_f_.beta);
-    // DumpMatrix("o" + row_str, po, 1, hidden_size_);
+      // calculate 'ot'
+      const float* pBo = use_bias_ ? SafeRawConstPointer<T>(bias_WRo_, 0, hidden_size_) : nullptr;
+      clip_with_bias_ptr_(clip_, pBo, po, hidden_size_);
+      activation_f_.func(po, hidden_size_, activation_f_.alpha, activation_f_.beta);
+      // DumpMatrix("o" + row_str, po, 1, hidden_size_);
+    }
 
     // calculate 'Ht'
     float* pH = SafeRawPointer<T>(batched_output + row * hidden_size_ + b * hidden_size_,
@@ -1094,8 +1192,10 @@ void UniDirectionalLstm<T>::GateComputations(span_T_iter& out, span_T_iter& out_
     // DumpMatrix("H" + row_str, pH, 1, hidden_size_);
   }
 
+#if defined(DUMP_MATRIXES)
   auto num_rows = local_fused_hidden_rows - row;
   std::string rows_str = " rows[" + std::to_string(row) + ".." + std::to_string(num_rows) + "]";
+#endif
 
   DumpMatrix("i" + rows_str, &*out, num_rows, hidden_size_, 0, hidden_size_x4);
   DumpMatrix("o" + rows_str, &*out, num_rows, hidden_size_, 1 * hidden_size_, hidden_size_x4);
@@ -1107,12 +1207,10 @@ void UniDirectionalLstm<T>::GateComputations(span_T_iter& out, span_T_iter& out_
 
 template <typename T>
 void UniDirectionalLstm<T>::SetNumThreads() {
-  int threads = std::thread::hardware_concurrency() - 1;
-
-  if (threads < 1)
-    threads = 1;
+  // the calling thread processes a share of the batch along with the threads of the session thread pool
+  int threads = ttp_ != nullptr ? static_cast<int>(ttp_->NumThreads()) + 1 : 1;
 
-  hidden_num_threads_ = threads;
+  num_batch_tasks_ = std::min(threads, batch_size_);
   batch_parallel_ = false;
 
   // for readability of the below logic
@@ -1120,9 +1218,9 @@ void UniDirectionalLstm<T>::SetNumThreads() {
   const auto num_columns = hidden_size_;
 
   // parallelize by partitioning the batch rows
-  if (num_rows > 4 || (num_rows >= 2 && num_columns <= 256)) {
+  if (num_batch_tasks_ > 1 && (num_rows > 4 || (num_rows >= 2 && num_columns <= 256))) {
     batch_parallel_ = true;
-    VLOGS(logger_, 1) << "Hidden Threads : " << hidden_num_threads_;
+    VLOGS(logger_, 1) << "Batch tasks : " << num_batch_tasks_;
   }
 }
 
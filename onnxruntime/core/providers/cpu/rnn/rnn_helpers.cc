@@ -7,12 +7,14 @@
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <numeric>
 #include <stdlib.h>
 #include <string>
 #include <unordered_map>
 
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/providers/cpu/rnn/rnn_activation_functors.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
@@ -101,6 +103,39 @@ Status ValidateCommonRnnInputs(const Tensor& X,
   return Status::OK();
 }  // namespace detail
 
+bool PackSequenceLengths(gsl::span<const int> sequence_lengths, PackedSequences& packed) {
+  const auto min_max = std::minmax_element(sequence_lengths.cbegin(), sequence_lengths.cend());
+  if (*min_max.first == *min_max.second)
+    return false;
+
+  const int batch_size = static_cast<int>(sequence_lengths.size());
+  const int max_sequence_length = *min_max.second;
+
+  packed.sorted_indices.resize(batch_size);
+  std::iota(packed.sorted_indices.begin(), packed.sorted_indices.end(), 0);
+
+  // stable so entries with the same length keep their relative order
+  std::stable_sort(packed.sorted_indices.begin(), packed.sorted_indices.end(),
+                   [&sequence_lengths](int a, int b) { return sequence_lengths[a] > sequence_lengths[b]; });
+
+  packed.sorted_lengths.resize(batch_size);
+  for (int i = 0; i < batch_size; i++)
+    packed.sorted_lengths[i] = sequence_lengths[packed.sorted_indices[i]];
+
+  // the number of active rows at a step is the number of entries that are longer than the step
+  packed.step_offsets.resize(max_sequence_length + 1);
+  packed.step_offsets[0] = 0;
+  int active_rows = batch_size;
+  for (int step = 0; step < max_sequence_length; step++) {
+    while (packed.sorted_lengths[active_rows - 1] <= step)
+      --active_rows;
+
+    packed.step_offsets[step + 1] = packed.step_offsets[step] + active_rows;
+  }
+
+  return true;
+}
+
 // map of arg name and whether the alpha and/or beta arguments are required
 static std::unordered_map<std::string, std::pair<bool, bool>>
     NameToArgUsageMap{{"affine", {1, 1}},
@@ -205,62 +240,6 @@ void DumpMatrixImpl(const std::string& name, const float* src, int row, int col,
 
 namespace deepcpu {
 
-const float alpha_1 = 4.89352455891786e-03f;
-const float alpha_3 = 6.37261928875436e-04f;
-const float alpha_5 = 1.48572235717979e-05f;
-const float alpha_7 = 5.12229709037114e-08f;
-const float alpha_9 = -8.60467152213735e-11f;
-const float alpha_11 = 2.00018790482477e-13f;
-const float alpha_13 = -2.76076847742355e-16f;
-
-const float beta_0 = 4.89352518554385e-03f;
-const float beta_2 = 2.26843463243900e-03f;
-const float beta_4 = 1.18534705686654e-04f;
-const float beta_6 = 1.19825839466702e-06f;
-
-const float sigmoid_bound = 20.0f;
-const float tanh_bound = 10.0f;
-
-inline void clip_for_sigmoid_in_place(float* ps, int c) {
-  for (int i = 0; i < c; i++) {
-    if (ps[i] < -sigmoid_bound)
-      ps[i] = -sigmoid_bound;
-    else if (ps[i] > sigmoid_bound)
-      ps[i] = sigmoid_bound;
-  }
-}
-
-inline void clip_for_tanh_in_place(float* ps, int c) {
-  for (int i = 0; i < c; i++) {
-    if (ps[i] < -tanh_bound)
-      ps[i] = -tanh_bound;
-    else if (ps[i] > tanh_bound)
-      ps[i] = tanh_bound;
-  }
-}
-
-inline void clip_for_sigmoid(const float* ps, float* pd, int c) {
-  for (int i = 0; i < c; i++) {
-    if (ps[i] < -sigmoid_bound)
-      pd[i] = -sigmoid_bound;
-    else if (ps[i] > sigmoid_bound)
-      pd[i] = sigmoid_bound;
-    else
-      pd[i] = ps[i];
-  }
-}
-
-inline void clip_for_tanh(const float* ps, float* pd, int c) {
-  for (int i = 0; i < c; i++) {
-    if (ps[i] < -tanh_bound)
-      pd[i] = -tanh_bound;
-    else if (ps[i] > tanh_bound)
-      pd[i] = tanh_bound;
-    else
-      pd[i] = ps[i];
-  }
-}
-
 void add_bias_into_ignore(const float* ps, float* pd, const int c) {
   ORT_UNUSED_PARAMETER(ps);
   ORT_UNUSED_PARAMETER(pd);
@@ -314,22 +293,11 @@ void sigmoid_m(const float* ps1, float* ps1_c, const float* ps2, float* pd, int
   ORT_UNUSED_PARAMETER(alpha);
   ORT_UNUSED_PARAMETER(beta);
 
-  clip_for_sigmoid(ps1, ps1_c, c);
+  // ps1_c is scratch space, so use it to hold the activated values
+  MlasComputeLogistic(ps1, ps1_c, static_cast<size_t>(c));
 
   for (int i = 0; i < c; i++) {
-    float x = 0.5f * ps1_c[i];
-    float x2 = x * x;
-    float p = x2 * alpha_13 + alpha_11;
-    p = x2 * p + alpha_9;
-    p = x2 * p + alpha_7;
-    p = x2 * p + alpha_5;
-    p = x2 * p + alpha_3;
-    p = x2 * p + alpha_1;
-    p = x * p;
-    float q = x2 * beta_6 + beta_4;
-    q = x2 * q + beta_2;
-    q = x2 * q + beta_0;
-    pd[i] = ps2[i] * 0.5f * (1 + (p / q));
+    pd[i] = ps2[i] * ps1_c[i];
   }
 }
 
@@ -338,22 +306,11 @@ void tanh_m(const float* ps1, float* ps1_c, const float* ps2, float* pd, int c,
   ORT_UNUSED_PARAMETER(alpha);
   ORT_UNUSED_PARAMETER(beta);
 
-  clip_for_tanh(ps1, ps1_c, c);
+  // ps1_c is scratch space, so use it to hold the activated values
+  MlasComputeTanh(ps1, ps1_c, static_cast<size_t>(c));
 
   for (int i = 0; i < c; i++) {
-    float x = ps1_c[i];
-    float x2 = x * x;
-    float p = x2 * alpha_13 + alpha_11;
-    p = x2 * p + alpha_9;
-    p = x2 * p + alpha_7;
-    p = x2 * p + alpha_5;
-    p = x2 * p + alpha_3;
-    p = x2 * p + alpha_1;
-    p = x * p;
-    float q = x2 * beta_6 + beta_4;
-    q = x2 * q + beta_2;
-    q = x2 * q + beta_0;
-    pd[i] = ps2[i] * p / q;
+    pd[i] = ps2[i] * ps1_c[i];
   }
 }
 
@@ -405,46 +362,14 @@ void sigmoid(float* pd, int c, const float alpha, const float beta) {
   ORT_UNUSED_PARAMETER(alpha);
   ORT_UNUSED_PARAMETER(beta);
 
-  clip_for_sigmoid_in_place(pd, c);
-
-  for (int i = 0; i < c; i++) {
-    float x = 0.5f * pd[i];
-    float x2 = x * x;
-    float p = x2 * alpha_13 + alpha_11;
-    p = x2 * p + alpha_9;
-    p = x2 * p + alpha_7;
-    p = x2 * p + alpha_5;
-    p = x2 * p + alpha_3;
-    p = x2 * p + alpha_1;
-    p = x * p;
-    float q = x2 * beta_6 + beta_4;
-    q = x2 * q + beta_2;
-    q = x2 * q + beta_0;
-    pd[i] = 0.5f * (1 + (p / q));
-  }
+  MlasComputeLogistic(pd, pd, static_cast<size_t>(c));
 }
 
 void tanh(float* pd, int c, const float alpha, const float beta) {
   ORT_UNUSED_PARAMETER(alpha);
   ORT_UNUSED_PARAMETER(beta);
 
-  clip_for_tanh_in_place(pd, c);
-
-  for (int i = 0; i < c; i++) {
-    float x = pd[i];
-    float x2 = x * x;
-    float p = x2 * alpha_13 + alpha_11;
-    p = x2 * p + alpha_9;
-    p = x2 * p + alpha_7;
-    p = x2 * p + alpha_5;
-    p = x2 * p + alpha_3;
-    p = x2 * p + alpha_1;
-    p = x * p;
-    float q = x2 * beta_6 + beta_4;
-    q = x2 * q + beta_2;
-    q = x2 * q + beta_0;
-    pd[i] = p / q;
-  }
+  MlasComputeTanh(pd, pd, static_cast<size_t>(c));
 }
 
 void relu(float* pd, int c, const float alpha, const float beta) {
@@ -489,22 +414,10 @@ void gru_reset_gate_tanh(const float* ps1, float* ps2, float* pd, const int c,
   ORT_UNUSED_PARAMETER(alpha);
   ORT_UNUSED_PARAMETER(beta);
 
-  clip_for_tanh_in_place(ps2, c);
+  MlasComputeTanh(ps2, ps2, static_cast<size_t>(c));
 
   for (int i = 0; i < c; i++) {
-    float x = ps2[i];
-    float x2 = x * x;
-    float p = x2 * alpha_13 + alpha_11;
-    p = x2 * p + alpha_9;
-    p = x2 * p + alpha_7;
-    p = x2 * p + alpha_5;
-    p = x2 * p + alpha_3;
-    p = x2 * p + alpha_1;
-    p = x * p;
-    float q = x2 * beta_6 + beta_4;
-    q = x2 * q + beta_2;
-    q = x2 * q + beta_0;
-    pd[i] = ps1[i] * p / q;
+    pd[i] = ps1[i] * ps2[i];
   }
 }
 
@@ -513,22 +426,10 @@ void gru_reset_gate_sigmoid(const float* ps1, float* ps2, float* pd, const int c
   ORT_UNUSED_PARAMETER(alpha);
   ORT_UNUSED_PARAMETER(beta);
 
-  clip_for_sigmoid_in_place(ps2, c);
+  MlasComputeLogistic(ps2, ps2, static_cast<size_t>(c));
 
   for (int i = 0; i < c; i++) {
-    float x = 0.5f * ps2[i];
-    float x2 = x * x;
-    float p = x2 * alpha_13 + alpha_11;
-    p = x2 * p + alpha_9;
-    p = x2 * p + alpha_7;
-    p = x2 * p + alpha_5;
-    p = x2 * p + alpha_3;
-    p = x2 * p + alpha_1;
-    p = x * p;
-    float q = x2 * beta_6 + beta_4;
-    q = x2 * q + beta_2;
-    q = x2 * q + beta_0;
-    pd[i] = ps1[i] * 0.5f * (1 + p / q);
+    pd[i] = ps1[i] * ps2[i];
   }
 }
 
@@ -556,22 +457,10 @@ void gru_output_gate_tanh(float* ph, const float* pz, const float* ps, float* po
   ORT_UNUSED_PARAMETER(alpha);
   ORT_UNUSED_PARAMETER(beta);
 
-  clip_for_tanh_in_place(ph, c);
+  MlasComputeTanh(ph, ph, static_cast<size_t>(c));
 
   for (int i = 0; i < c; i++) {
-    float x = ph[i];
-    float x2 = x * x;
-    float p = x2 * alpha_13 + alpha_11;
-    p = x2 * p + alpha_9;
-    p = x2 * p + alpha_7;
-    p = x2 * p + alpha_5;
-    p = x2 * p + alpha_3;
-    p = x2 * p + alpha_1;
-    p = x * p;
-    float q = x2 * beta_6 + beta_4;
-    q = x2 * q + beta_2;
-    q = x2 * q + beta_0;
-    po[i] = (1 - pz[i]) * (p / q) + pz[i] * ps[i];
+    po[i] = (1 - pz[i]) * ph[i] + pz[i] * ps[i];
   }
 }
 
@@ -599,22 +488,10 @@ void gru_output_gate_sigmoid(float* ph, const float* pz, const float* ps, float*
   ORT_UNUSED_PARAMETER(alpha);
   ORT_UNUSED_PARAMETER(beta);
 
-  clip_for_sigmoid_in_place(ph, c);
+  MlasComputeLogistic(ph, ph, static_cast<size_t>(c));
 
   for (int i = 0; i < c; i++) {
-    float x = 0.5f * (ph[i]);
-    float x2 = x * x;
-    float p = x2 * alpha_13 + alpha_11;
-    p = x2 * p + alpha_9;
-    p = x2 * p + alpha_7;
-    p = x2 * p + alpha_5;
-    p = x2 * p + alpha_3;
-    p = x2 * p + alpha_1;
-    p = x * p;
-    float q = x2 * beta_6 + beta_4;
-    q = x2 * q + beta_2;
-    q = x2 * q + beta_0;
-    po[i] = (1 - pz[i]) * 0.5f * (1 + (p / q)) + pz[i] * ps[i];
+    po[i] = (1 - pz[i]) * ph[i] + pz[i] * ps[i];
   }
 }
 
@@ -8,8 +8,11 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <functional>
 #include <future>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -19,6 +22,8 @@
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
 #include "core/framework/allocator.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/ort_mutex.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 
@@ -148,6 +153,100 @@ void ReverseSequence(gsl::span<const T> inputs,
   }
 }
 
+// Layout of a batch of variable length sequences in 'packed' form. The batch entries are sorted by descending
+// sequence length so the entries that are still active at a step are always a prefix of the sorted batch, and
+// only those rows are stored for each step. This allows the recurrent computations to shrink the batch as
+// sequences finish instead of computing the padding.
+struct PackedSequences {
+  std::vector<int> sorted_indices;  // original batch index of each entry in sorted order
+  std::vector<int> sorted_lengths;  // sequence length of each entry in sorted order
+  std::vector<int> step_offsets;    // first packed row of each step. last entry is the total number of rows.
+
+  int NumSteps() const { return static_cast<int>(step_offsets.size()) - 1; }
+  int TotalRows() const { return step_offsets.back(); }
+  int ActiveRows(int step) const { return step_offsets[step + 1] - step_offsets[step]; }
+};
+
+// Returns true if the sequence lengths differ, in which case 'packed' is populated.
+bool PackSequenceLengths(gsl::span<const int> sequence_lengths, PackedSequences& packed);
+
+// Copy input of shape [seq_length, batch_size, input_size] to packed form.
+// If reverse is true each sequence is reversed, matching the output of ReverseSequence.
+template <typename T>
+void PackSequenceInput(gsl::span<const T> inputs,
+                       gsl::span<T> packed_inputs,
+                       const PackedSequences& packed,
+                       const int batch_size,
+                       const int input_size,
+                       const bool reverse) {
+  const int num_entries = static_cast<int>(packed.sorted_indices.size());
+
+  for (int i = 0; i < num_entries; i++) {
+    const int batch = packed.sorted_indices[i];
+    const int seq_len = packed.sorted_lengths[i];
+
+    for (int step = 0; step < seq_len; step++) {
+      const int src_step = reverse ? seq_len - step - 1 : step;
+      gsl::span<const T> src = inputs.subspan((src_step * batch_size + batch) * input_size, input_size);
+      gsl::span<T> dest = packed_inputs.subspan((packed.step_offsets[step] + i) * input_size, input_size);
+
+      gsl::copy(src, dest);
+    }
+  }
+}
+
+// Copy packed output to shape [seq_length, num_directions, batch_size, hidden_size], restoring the original
+// batch order and zeroing the output for the steps past the end of each sequence.
+// If reverse is true each sequence is reversed, matching the output of ReverseSequence.
+template <typename T>
+void UnpackSequenceOutput(gsl::span<const T> packed_outputs,
+                          gsl::span<T> outputs,
+                          const PackedSequences& packed,
+                          const int seq_length,
+                          const int batch_size,
+                          const int hidden_size,
+                          const int num_directions,
+                          const bool reverse) {
+  const int num_entries = static_cast<int>(packed.sorted_indices.size());
+  const int output_step_length = num_directions * batch_size * hidden_size;
+
+  for (int i = 0; i < num_entries; i++) {
+    const int batch = packed.sorted_indices[i];
+    const int seq_len = packed.sorted_lengths[i];
+
+    for (int step = 0; step < seq_len; step++) {
+      const int dest_step = reverse ? seq_len - step - 1 : step;
+      gsl::span<const T> src = packed_outputs.subspan((packed.step_offsets[step] + i) * hidden_size, hidden_size);
+      gsl::span<T> dest = outputs.subspan(dest_step * output_step_length + batch * hidden_size, hidden_size);
+
+      gsl::copy(src, dest);
+    }
+
+    for (int step = seq_len; step < seq_length; step++) {
+      auto dest = outputs.begin() + step * output_step_length + batch * hidden_size;
+      std::fill_n(dest, hidden_size, T{});
+    }
+  }
+}
+
+// Reorder the rows of a [batch_size, row_size] buffer between the original and the sorted batch order.
+template <typename T>
+void PermuteBatchRows(gsl::span<const T> src,
+                      gsl::span<T> dest,
+                      const PackedSequences& packed,
+                      const int row_size,
+                      const bool to_sorted) {
+  const int num_entries = static_cast<int>(packed.sorted_indices.size());
+
+  for (int i = 0; i < num_entries; i++) {
+    const int batch = packed.sorted_indices[i];
+    const int src_row = to_sorted ? batch : i;
+    const int dest_row = to_sorted ? i : batch;
+
+    gsl::copy(src.subspan(src_row * row_size, row_size), dest.subspan(dest_row * row_size, row_size));
+  }
+}
+
 // A has size M x K, B has size N x K (transposed), and C has size M x N
 // We check that A, B and C are large enough before calling the lower level GEMM implementation
 template <typename TSpanAIter, typename TSpanBIter, typename TSpanCIter>
@@ -180,6 +279,38 @@ void ComputeGemm(const int M,
       &*C, ldc, &CPUMathUtil::Instance());
 }
 
+// As above, but uses the weights packed by MlasSgemmPackB if packed_B is not nullptr.
+// B must be provided in either case as it is used to validate the inputs.
+template <typename TSpanAIter, typename TSpanBIter, typename TSpanCIter>
+void ComputeGemm(const int M,
+                 const int N,
+                 const int K,
+                 const float alpha,
+                 TSpanAIter A,
+                 TSpanAIter A_end,
+                 const int lda,
+                 TSpanBIter B,
+                 TSpanBIter B_end,
+                 const int ldb,
+                 const void* packed_B,
+                 const float beta,
+                 TSpanCIter C,
+                 TSpanCIter C_end,
+                 const int ldc) {
+  if (packed_B == nullptr) {
+    ComputeGemm(M, N, K, alpha, A, A_end, lda, B, B_end, ldb, beta, C, C_end, ldc);
+    return;
+  }
+
+  ORT_ENFORCE(lda >= K && ldb >= K && ldc >= N);
+  ORT_ENFORCE(A + (M * lda - (lda - K)) <= A_end);
+  ORT_ENFORCE(B + (N * ldb - (ldb - K)) <= B_end);
+  ORT_ENFORCE(C + (M * ldc - (ldc - N)) <= C_end);
+
+  MlasSgemmPacked(CblasNoTrans, static_cast<size_t>(M), static_cast<size_t>(N), static_cast<size_t>(K),
+                  alpha, &*A, static_cast<size_t>(lda), packed_B, beta, &*C, static_cast<size_t>(ldc));
+}
+
 // helper to convert a span to a raw pointer
 // after validating the memory covered by the span supports the size required
 template <typename T>
@@ -216,60 +347,86 @@ T* SafeRawPointer(typename gsl::span<T> span, size_t offset, size_t size) {
   return span.data() + offset;
 }
 
+// Execute lambda(i) for i in [0, max) with the given step, using the session thread pool if one is provided.
+// The calling thread also executes tasks, and the pool threads only pick up tasks that have not been
+// started yet. This means the call completes even if every thread of the pool is busy, which is the case
+// when the node itself is being run on a pool thread by the parallel executor.
 template <typename TLambda>
 void ExecuteLambdaInParallel(const std::string& name, TLambda lambda, int max, int step,
 #ifdef USE_EIGEN_THREADPOOL
-                             Eigen::NonBlockingThreadPool& ttp,
+                             Eigen::NonBlockingThreadPool* ttp,
 #else
-                             TaskThreadPool& ttp,
+                             TaskThreadPool* ttp,
 #endif
                              const ::onnxruntime::logging::Logger& logger) {
+  const int num_tasks = step > 0 ? (max + step - 1) / step : 0;
+
   // #define NOTHREADS to execute the lambdas directly and in order if you need to do that to debug
+#ifndef NOTHREADS
+  if (ttp != nullptr && num_tasks > 1) {
+    struct SharedState {
+      std::atomic<int> next_task{0};
+      std::atomic<int> completed_tasks{0};
+      OrtMutex mutex;
+      OrtCondVar completed;
+      std::exception_ptr error;
+    };
+
+    // the state is shared with the helpers as they may start after all the tasks have been completed.
+    auto state = std::make_shared<SharedState>();
+
+    // helpers only reference the lambda after claiming a task, which completes before this function returns.
+    auto run_tasks = [state, &lambda, num_tasks, step]() {
+      for (int task = state->next_task++; task < num_tasks; task = state->next_task++) {
+        try {
+          lambda(task * step);
+        } catch (...) {
+          std::lock_guard<OrtMutex> lock(state->mutex);
+          if (!state->error)
+            state->error = std::current_exception();
+        }
+
+        if (++state->completed_tasks == num_tasks) {
+          std::lock_guard<OrtMutex> lock(state->mutex);
+          state->completed.notify_all();
+        }
+      }
+    };
+
+    const int num_helpers = std::min(static_cast<int>(ttp->NumThreads()), num_tasks - 1);
+    for (int i = 0; i < num_helpers; ++i) {
+#ifdef USE_EIGEN_THREADPOOL
+      ttp->Schedule(run_tasks);
+#else
+      ttp->RunTask(std::packaged_task<void()>{run_tasks});
+#endif
+    }
 
-#ifdef NOTHREADS
-  ORT_UNUSED_PARAMETER(ttp);
-  ORT_UNUSED_PARAMETER(logger);
+    run_tasks();
 
-  for (int i = 0; i < max; i += step) {
-    (void)name;
-    std::bind(lambda, i)();
-  }
-#else
+    std::unique_lock<OrtMutex> lock(state->mutex);
+    state->completed.wait(lock, [&state, num_tasks]() { return state->completed_tasks == num_tasks; });
 
-#ifdef USE_EIGEN_THREADPOOL
-  ORT_UNUSED_PARAMETER(name);
-  ORT_UNUSED_PARAMETER(logger);
+    if (state->error) {
+      try {
+        std::rethrow_exception(state->error);
+      } catch (const std::exception& ex) {
+        LOGS(logger, ERROR) << name << " - exception running tasks: " << ex.what();
+        throw;
+      }
+    }
 
-  std::atomic<int> done(0);
-  for (int i = 0; i < max; i += step) {
-    ttp.Schedule([lambda, i, &done]() {
-      lambda(i);
-      ++done;
-    });
+    return;
   }
+#endif  // NOTHREADS
 
-  int totalTasks = (int)max / (step > 0 ? step : 1) + (max % step > 0 ? 1 : 0);
-  while (done != totalTasks) {
-  }
-#else
-  std::vector<std::future<void> > task_results{};
-  task_results.reserve(static_cast<size_t>(std::ceil(max / step)));
+  ORT_UNUSED_PARAMETER(name);
+  ORT_UNUSED_PARAMETER(ttp);
+  ORT_UNUSED_PARAMETER(logger);
 
-  for (int i = 0; i < max; i += step) {
-    std::packaged_task<void()> task{std::bind(lambda, i)};
-    task_results.emplace_back(task.get_future());
-    ttp.RunTask(std::move(task));
-  }
-  try {
-    // wait for all and propagate any exceptions
-    for (auto& future : task_results)
-      future.get();
-  } catch (const std::exception& ex) {
-    LOGS(logger, ERROR) << name << " - exception running tasks: " << ex.what();
-    throw;
+  for (int task = 0; task < num_tasks; ++task) {
+    lambda(task * step);
   }
-#endif  // else part of #ifdef USE_EIGEN_THREADPOOLs
-#endif  // else part of #ifdef NOTHREADS
 }
 
 void DumpMatrixImpl(const std::string& name, const float* src, int row, int col,
@@ -3,6 +3,8 @@
 
 #include "core/providers/cpu/tensor/transpose.h"
 #include "core/framework/utils.h"
+#include "core/mlas/inc/mlas.h"
+#include <algorithm>
 
 namespace onnxruntime {
 
@@ -13,122 +15,270 @@ namespace onnxruntime {
    etc.
    */
 
-// ComputeOffset: compute offset into a tensor. This is essentially the dot-product of
-// index and stride, restricted to the specified number of axes.
-size_t ComputeOffset(const std::vector<int64_t>& index, const std::vector<size_t>& stride, int64_t num_axes) {
-  size_t offset = 0;
-  for (int64_t j = 0; j < num_axes; ++j) {
-    offset += index[j] * stride[j];
+namespace {
+
+// The transpose is split into tasks of at least this many elements for
+// parallel execution.
+constexpr int64_t kMinimumElementsPerTask = 16384;
+
+// Removes the dimensions of size 1 and merges runs of input axes that stay
+// adjacent and in order in the output. The coalesced transpose moves the same
+// elements as the original transpose, but with fewer axes to iterate over.
+void CoalesceDimensions(const std::vector<int64_t>& input_dims, const std::vector<int64_t>& permutations,
+                        std::vector<int64_t>& dims, std::vector<size_t>& perm) {
+  const size_t rank = input_dims.size();
+
+  std::vector<int64_t> squeezed_dims;
+  std::vector<size_t> squeezed_axis(rank);
+  for (size_t i = 0; i < rank; i++) {
+    squeezed_axis[i] = squeezed_dims.size();
+    if (input_dims[i] != 1) {
+      squeezed_dims.push_back(input_dims[i]);
+    }
+  }
+
+  std::vector<size_t> squeezed_perm;
+  for (size_t i = 0; i < rank; i++) {
+    if (input_dims[permutations[i]] != 1) {
+      squeezed_perm.push_back(squeezed_axis[permutations[i]]);
+    }
+  }
+
+  // An input axis starts a new group unless it directly follows the previous
+  // input axis in the output.
+  const size_t squeezed_rank = squeezed_dims.size();
+  std::vector<bool> starts_group(squeezed_rank, true);
+  for (size_t i = 1; i < squeezed_rank; i++) {
+    if (squeezed_perm[i] == squeezed_perm[i - 1] + 1) {
+      starts_group[squeezed_perm[i]] = false;
+    }
+  }
+
+  std::vector<size_t> group_axis(squeezed_rank);
+  dims.clear();
+  for (size_t i = 0; i < squeezed_rank; i++) {
+    if (starts_group[i]) {
+      dims.push_back(squeezed_dims[i]);
+    } else {
+      dims.back() *= squeezed_dims[i];
+    }
+    group_axis[i] = dims.size() - 1;
   }
-  return offset;
-}
 
-// IncrementIndex: Increment an index into a tensor (in lexicographic ordering), wrapping
-// around the specified upper_bound.
-void IncrementIndex(std::vector<int64_t>& index, const std::vector<int64_t>& upper_bound, int64_t num_axes) {
-  for (int64_t k = num_axes - 1; k >= 0; --k) {
-    index[k]++;
-    if (index[k] < upper_bound[k]) break;
-    index[k] = 0;
+  perm.clear();
+  for (size_t i = 0; i < squeezed_rank; i++) {
+    if (starts_group[squeezed_perm[i]]) {
+      perm.push_back(group_axis[squeezed_perm[i]]);
+    }
   }
 }
 
-// DoTranspose: copies source tensor to target, transposing elements.
-// The stride vector indicates the transposition.
+// The output axes that are iterated over outside of the inner copy or
+// transpose, in output order.
+struct OuterAxes {
+  std::vector<int64_t> dims;
+  std::vector<size_t> input_strides;
+  std::vector<size_t> output_strides;
+
+  void Add(int64_t dim, size_t input_stride, size_t output_stride) {
+    dims.push_back(dim);
+    input_strides.push_back(input_stride);
+    output_strides.push_back(output_stride);
+  }
+
+  int64_t Count() const {
+    int64_t count = 1;
+    for (auto dim : dims) {
+      count *= dim;
+    }
+    return count;
+  }
+};
+
+// Tracks the input and output offsets while iterating over the outer axes in
+// lexicographic order, starting at the specified position.
+class OuterAxesIterator {
+ public:
+  OuterAxesIterator(const OuterAxes& axes, int64_t position) : axes_(axes), index_(axes.dims.size()) {
+    for (size_t k = axes.dims.size(); k > 0; k--) {
+      index_[k - 1] = position % axes.dims[k - 1];
+      position /= axes.dims[k - 1];
+      input_offset_ += index_[k - 1] * axes.input_strides[k - 1];
+      output_offset_ += index_[k - 1] * axes.output_strides[k - 1];
+    }
+  }
+
+  size_t InputOffset() const { return input_offset_; }
+  size_t OutputOffset() const { return output_offset_; }
+
+  void Advance() {
+    for (size_t k = axes_.dims.size(); k > 0; k--) {
+      input_offset_ += axes_.input_strides[k - 1];
+      output_offset_ += axes_.output_strides[k - 1];
+      if (++index_[k - 1] < axes_.dims[k - 1]) {
+        break;
+      }
+      input_offset_ -= axes_.dims[k - 1] * axes_.input_strides[k - 1];
+      output_offset_ -= axes_.dims[k - 1] * axes_.output_strides[k - 1];
+      index_[k - 1] = 0;
+    }
+  }
+
+ private:
+  const OuterAxes& axes_;
+  std::vector<int64_t> index_;
+  size_t input_offset_ = 0;
+  size_t output_offset_ = 0;
+};
+
+// Transpose2D: copies element (m, n) of the M x N input matrix to element
+// (n, m) of the output matrix. The matrix is processed in blocks that fit in
+// the cache. Element types of 4 bytes use the vectorized MLAS kernel.
 template <typename T>
-static void DoTransposeImpl(int64_t num_axes, const std::vector<int64_t>& target_dims,
-                            size_t num_blocks, size_t num_elts_in_block, const std::vector<size_t>& stride,
-                            const T* source, T* target) {
-  size_t blocksize = num_elts_in_block * sizeof(float);
-  // index used to iterate over target iteration-space
-  std::vector<int64_t> target_index(num_axes, 0);
-  for (size_t i = 0; i < num_blocks; ++i) {
-    // convert target_index into an offset in source data
-    size_t source_offset = ComputeOffset(target_index, stride, num_axes);
-
-    // copy
-    memcpy(target, source + source_offset, blocksize);
-
-    // increment target_index:
-    IncrementIndex(target_index, target_dims, num_axes);
-    target += num_elts_in_block;
+void Transpose2D(size_t M, size_t N, const T* input, size_t lda, T* output, size_t ldb) {
+  constexpr size_t block_size = 16;
+  for (size_t m0 = 0; m0 < M; m0 += block_size) {
+    const size_t m1 = std::min(M, m0 + block_size);
+    for (size_t n0 = 0; n0 < N; n0 += block_size) {
+      const size_t n1 = std::min(N, n0 + block_size);
+      for (size_t m = m0; m < m1; m++) {
+        for (size_t n = n0; n < n1; n++) {
+          output[n * ldb + m] = input[m * lda + n];
+        }
+      }
+    }
   }
 }
 
-// DoTransposeEltWise: specialization of DoTranspose for the num_elts_in_block=1 case.
-// copies source tensor to target, transposing elements.
-// The stride vector indicates the transposition.
-template <typename T>
-static void DoTransposeEltWise(int64_t num_axes, const std::vector<int64_t>& target_dims, size_t num_blocks,
-                               const std::vector<size_t>& stride, const T* source, T* target) {
-  // index used to iterate over target iteration-space
-  std::vector<int64_t> target_index(num_axes, 0);
-  for (size_t i = 0; i < num_blocks; ++i) {
-    // convert target_index into an offset in source data
-    size_t source_offset = ComputeOffset(target_index, stride, num_axes);
+void Transpose2D(size_t M, size_t N, const float* input, size_t lda, float* output, size_t ldb) {
+  MlasTranspose(M, N, reinterpret_cast<const uint32_t*>(input), lda, reinterpret_cast<uint32_t*>(output), ldb);
+}
+
+void Transpose2D(size_t M, size_t N, const int32_t* input, size_t lda, int32_t* output, size_t ldb) {
+  MlasTranspose(M, N, reinterpret_cast<const uint32_t*>(input), lda, reinterpret_cast<uint32_t*>(output), ldb);
+}
+
+void Transpose2D(size_t M, size_t N, const uint32_t* input, size_t lda, uint32_t* output, size_t ldb) {
+  MlasTranspose(M, N, input, lda, output, ldb);
+}
 
-    // copy
-    *target = *(source + source_offset);
+// DoTransposeBlocks: specialization of DoTranspose for the case where the
+// innermost axis is not moved. Each output row is a contiguous block of the
+// input.
+template <typename T>
+void DoTransposeBlocks(const OuterAxes& outer, int64_t block_size, const T* source, T* target) {
+  const int64_t block_count = outer.Count();
+  const int64_t blocks_per_task = std::max<int64_t>(1, kMinimumElementsPerTask / block_size);
+  const int64_t task_count = (block_count + blocks_per_task - 1) / blocks_per_task;
 
-    // increment target_index:
-    IncrementIndex(target_index, target_dims, num_axes);
-    target++;
+#ifdef USE_OPENMP
+#pragma omp parallel for if (task_count > 1)
+#endif
+  for (int64_t task = 0; task < task_count; task++) {
+    const int64_t start = task * blocks_per_task;
+    const int64_t end = std::min(block_count, start + blocks_per_task);
+    OuterAxesIterator it(outer, start);
+    for (int64_t i = start; i < end; i++) {
+      std::copy_n(source + it.InputOffset(), block_size, target + it.OutputOffset());
+      it.Advance();
+    }
   }
 }
 
-// DoTransposeSingleBlock: specialization of DoTranspose for the num_blocks=1 case.
-// copies source tensor to target, transposing elements.
+// DoTransposeTiles: copies source tensor to target for the case where the
+// innermost axis is moved. The innermost input axis and the input axis that
+// becomes the innermost output axis form a strided 2D transpose, which is
+// repeated over the remaining outer axes.
 template <typename T>
-static void DoTransposeSingleBlock(size_t num_elts_in_block, const T* source, T* target) {
-  size_t blocksize = num_elts_in_block * sizeof(T);
-  // copy
-  memcpy(target, source, blocksize);
+void DoTransposeTiles(const OuterAxes& outer, size_t M, size_t N, size_t lda, size_t ldb,
+                      const T* source, T* target) {
+  const int64_t outer_count = outer.Count();
+
+  // Split large matrices by rows and batch small matrices together so that
+  // each task has a reasonable amount of work.
+  const int64_t matrix_size = static_cast<int64_t>(M * N);
+  int64_t rows_per_task = static_cast<int64_t>(M);
+  int64_t matrices_per_task = 1;
+  if (matrix_size >= 2 * kMinimumElementsPerTask) {
+    rows_per_task = std::max<int64_t>(8, (kMinimumElementsPerTask / static_cast<int64_t>(N) + 7) & ~int64_t{7});
+  } else {
+    matrices_per_task = std::max<int64_t>(1, kMinimumElementsPerTask / matrix_size);
+  }
+  const int64_t row_tasks = (static_cast<int64_t>(M) + rows_per_task - 1) / rows_per_task;
+  const int64_t matrix_tasks = (outer_count + matrices_per_task - 1) / matrices_per_task;
+  const int64_t task_count = row_tasks * matrix_tasks;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for if (task_count > 1)
+#endif
+  for (int64_t task = 0; task < task_count; task++) {
+    const int64_t start = (task / row_tasks) * matrices_per_task;
+    const int64_t end = std::min(outer_count, start + matrices_per_task);
+    const size_t m = static_cast<size_t>((task % row_tasks) * rows_per_task);
+    const size_t rows = std::min(M - m, static_cast<size_t>(rows_per_task));
+    OuterAxesIterator it(outer, start);
+    for (int64_t i = start; i < end; i++) {
+      Transpose2D(rows, N, source + it.InputOffset() + m * lda, lda, target + it.OutputOffset() + m, ldb);
+      it.Advance();
+    }
+  }
 }
 
+}  // namespace
+
 template <typename T>
 static Status DoTypedTranspose(const std::vector<int64_t>& permutations, const Tensor& input, Tensor& output) {
-  const auto& input_shape = input.Shape();
-  const auto& input_dims = input_shape.GetDims();
-  auto rank = input_shape.NumDimensions();
-
-  std::vector<size_t> stride(rank);
-  for (int i = 0; i < rank; i++) {
-    size_t inpdim = permutations[i];
-    if (inpdim + 1 < rank)
-      stride[i] = input_shape.SizeFromDimension(inpdim + 1);
-    else
-      stride[i] = 1;
-  }
-
-  // Partition the permutation into a prefix and the largest suffix such that
-  // every axis i in the suffix is mapped to i.
-  int64_t num_axes_in_prefix = 0;  // number of axes in prefix
-  size_t suffix_blocksize = 1;     // product of dimensions in the suffix
-  size_t prefix_blocksize = 1;     // product of dimensions in the prefix
-  bool is_suffix = true;
-
-  for (int64_t i = rank - 1; i >= 0; --i) {
-    int64_t input_axis = permutations[i];
-    if (is_suffix && (input_axis == i)) {
-      suffix_blocksize *= input_dims[input_axis];
-    } else {
-      is_suffix = false;
-      prefix_blocksize *= input_dims[input_axis];
-      ++num_axes_in_prefix;
-    }
+  const int64_t total_size = input.Shape().Size();
+
+  // There is nothing to move for an empty tensor. The task splitting below
+  // divides by the dimensions, so this must be handled first.
+  if (total_size == 0) {
+    return Status::OK();
   }
 
   const T* input_data = input.Data<T>();
   T* output_data = output.MutableData<T>();
 
-  if (1 == prefix_blocksize)
-    DoTransposeSingleBlock<T>(suffix_blocksize, input_data, output_data);
-  else if (1 == suffix_blocksize)
-    DoTransposeEltWise<T>(num_axes_in_prefix, output.Shape().GetDims(), prefix_blocksize, stride,
-                          input_data, output_data);
-  else
-    DoTransposeImpl<T>(num_axes_in_prefix, output.Shape().GetDims(), prefix_blocksize, suffix_blocksize, stride,
-                       input_data, output_data);
+  std::vector<int64_t> dims;
+  std::vector<size_t> perm;
+  CoalesceDimensions(input.Shape().GetDims(), permutations, dims, perm);
+  const size_t rank = dims.size();
+
+  // The elements are already in output order.
+  if (rank <= 1) {
+    std::copy_n(input_data, total_size, output_data);
+    return Status::OK();
+  }
+
+  std::vector<size_t> input_strides(rank);
+  std::vector<size_t> output_strides(rank);
+  input_strides[rank - 1] = 1;
+  output_strides[rank - 1] = 1;
+  for (size_t i = rank - 1; i > 0; i--) {
+    input_strides[i - 1] = input_strides[i] * dims[i];
+    output_strides[i - 1] = output_strides[i] * dims[perm[i]];
+  }
+
+  OuterAxes outer;
+
+  if (perm[rank - 1] == rank - 1) {
+    for (size_t i = 0; i < rank - 1; i++) {
+      outer.Add(dims[perm[i]], input_strides[perm[i]], output_strides[i]);
+    }
+    DoTransposeBlocks<T>(outer, dims[rank - 1], input_data, output_data);
+  } else {
+    // The rows of the 2D transpose come from the input axis that becomes the
+    // innermost output axis and the columns from the innermost input axis.
+    const size_t row_axis = perm[rank - 1];
+    const size_t column_position = std::find(perm.begin(), perm.end(), rank - 1) - perm.begin();
+    for (size_t i = 0; i < rank - 1; i++) {
+      if (i != column_position) {
+        outer.Add(dims[perm[i]], input_strides[perm[i]], output_strides[i]);
+      }
+    }
+    DoTransposeTiles<T>(outer, dims[row_axis], dims[rank - 1], input_strides[row_axis],
+                        output_strides[column_position], input_data, output_data);
+  }
 
   return Status::OK();
 }
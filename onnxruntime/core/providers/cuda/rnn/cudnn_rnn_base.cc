@@ -134,12 +134,18 @@ Status CudnnRnnBase<T>::CacheCudnnRnnWeights(const OpKernelInfo& info) {
   // Cache the weight
   const Tensor* W;
   const Tensor* R;
-  const Tensor* B;
+  const Tensor* B = nullptr;
   bool get_W = info.TryGetConstantInput(Input_Index::W, &W);
   bool get_R = info.TryGetConstantInput(Input_Index::R, &R);
 
   if (get_W && get_R) {
-    info.TryGetConstantInput(Input_Index::B, &B);
+    // the bias is folded into the cached weights, so it must be constant too if it's provided
+    bool get_B = info.TryGetConstantInput(Input_Index::B, &B);
+    const auto& input_defs = info.node().InputDefs();
+    if (!get_B && input_defs.size() > static_cast<size_t>(Input_Index::B) && input_defs[Input_Index::B]->Exists()) {
+      return Status::OK();
+    }
+
     ORT_RETURN_IF_ERROR(ReorganizeWeights(W, R, B, w_data_cache_, w_desc_cache_));
     weight_cached_ = true;
   }
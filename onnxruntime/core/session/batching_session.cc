@@ -0,0 +1,383 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/batching_session.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "core/common/task_thread_pool.h"
+#include "core/framework/data_types.h"
+#include "core/framework/tensor.h"
+
+namespace onnxruntime {
+
+using Clock = std::chrono::steady_clock;
+
+struct BatchingSession::Request {
+  const NameMLValMap* feeds = nullptr;
+  const std::vector<std::string>* output_names = nullptr;
+  std::vector<MLValue>* fetches = nullptr;
+  BatchingRunInfo* run_info = nullptr;
+
+  // size of dimension 0 shared by all feeds. -1 if the request can't be batched with others.
+  int64_t rows = -1;
+  Clock::time_point enqueue_time;
+
+  OrtMutex mutex;
+  OrtCondVar cv;
+  bool done = false;  // protected by mutex
+  Status status;
+};
+
+// returns the size of dimension 0 shared by all the feeds, or -1 if the feeds can't be concatenated
+static int64_t GetBatchRows(const NameMLValMap& feeds) {
+  int64_t rows = -1;
+
+  for (const auto& feed : feeds) {
+    if (!feed.second.IsTensor()) {
+      return -1;
+    }
+
+    const auto& tensor = feed.second.Get<Tensor>();
+    const auto& dims = tensor.Shape().GetDims();
+    if (dims.empty() ||
+        tensor.DataType() == DataTypeImpl::GetType<std::string>() ||
+        strcmp(tensor.Location().name, CPU) != 0) {
+      return -1;
+    }
+
+    if (rows == -1) {
+      rows = dims[0];
+    } else if (rows != dims[0]) {
+      return -1;
+    }
+  }
+
+  return rows;
+}
+
+BatchingSession::BatchingSession(InferenceSession& session, const BatchingOptions& options)
+    : session_{session},
+      options_{options},
+      allocator_{std::make_shared<CPUAllocator>()} {
+  ORT_ENFORCE(options_.max_batch_size > 0, "max_batch_size must be positive. Got ", options_.max_batch_size);
+  ORT_ENFORCE(options_.num_batch_threads >= 0, "num_batch_threads must not be negative. Got ",
+              options_.num_batch_threads);
+
+  num_batch_threads_ = options_.num_batch_threads == 0
+                           ? static_cast<int>(std::thread::hardware_concurrency() / 2)
+                           : options_.num_batch_threads;
+  if (num_batch_threads_ < 1)
+    num_batch_threads_ = 1;
+
+#ifdef USE_EIGEN_THREADPOOL
+  batch_thread_pool_ = std::make_unique<Eigen::NonBlockingThreadPool>(num_batch_threads_);
+#else
+  batch_thread_pool_ = std::make_unique<TaskThreadPool>(num_batch_threads_);
+#endif
+
+  dispatcher_ = std::thread(&BatchingSession::DispatchLoop, this);
+}
+
+BatchingSession::~BatchingSession() {
+  {
+    std::lock_guard<OrtMutex> lock(queue_mutex_);
+    shutdown_ = true;
+  }
+  queue_cv_.notify_all();
+  dispatcher_.join();
+
+  // the pool doesn't drain queued tasks when destroyed, so wait for the batches the dispatcher scheduled
+  std::unique_lock<OrtMutex> lock(queue_mutex_);
+  while (num_running_batches_ > 0) batch_done_cv_.wait(lock);
+}
+
+common::Status BatchingSession::Run(const NameMLValMap& feeds,
+                                    const std::vector<std::string>& output_names,
+                                    std::vector<MLValue>* p_fetches,
+                                    BatchingRunInfo* run_info) {
+  if (p_fetches == nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Output vector pointer is NULL");
+  }
+
+  Request request;
+  request.feeds = &feeds;
+  request.output_names = &output_names;
+  request.fetches = p_fetches;
+  request.run_info = run_info;
+  request.enqueue_time = Clock::now();
+
+  // pre-allocated fetches are filled in place by the session so those requests are never combined
+  request.rows = p_fetches->empty() ? GetBatchRows(feeds) : -1;
+
+  {
+    std::lock_guard<OrtMutex> lock(queue_mutex_);
+    queue_.push_back(&request);
+  }
+  queue_cv_.notify_all();
+
+  std::unique_lock<OrtMutex> lock(request.mutex);
+  while (!request.done) request.cv.wait(lock);
+
+  return request.status;
+}
+
+BatchingStats BatchingSession::GetStats() const {
+  std::lock_guard<OrtMutex> lock(stats_mutex_);
+  return stats_;
+}
+
+bool BatchingSession::IsCompatible(const Request& first, const Request& other) const {
+  if (other.rows <= 0 || *first.output_names != *other.output_names || first.feeds->size() != other.feeds->size()) {
+    return false;
+  }
+
+  for (const auto& feed : *first.feeds) {
+    auto entry = other.feeds->find(feed.first);
+    if (entry == other.feeds->cend()) {
+      return false;
+    }
+
+    const auto& tensor = feed.second.Get<Tensor>();
+    const auto& other_tensor = entry->second.Get<Tensor>();
+    if (tensor.DataType() != other_tensor.DataType()) {
+      return false;
+    }
+
+    const auto& dims = tensor.Shape().GetDims();
+    const auto& other_dims = other_tensor.Shape().GetDims();
+    if (dims.size() != other_dims.size() || !std::equal(dims.cbegin() + 1, dims.cend(), other_dims.cbegin() + 1)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void BatchingSession::DispatchLoop() {
+  std::unique_lock<OrtMutex> lock(queue_mutex_);
+
+  while (true) {
+    while (queue_.empty() && !shutdown_) queue_cv_.wait(lock);
+
+    if (queue_.empty()) {
+      break;  // shutdown and nothing left to run
+    }
+
+    // don't form a new batch until a pool thread can run it. requests arriving meanwhile can then
+    // still be added to it rather than waiting behind a batch sitting in the pool's queue.
+    while (num_running_batches_ >= num_batch_threads_) batch_done_cv_.wait(lock);
+
+    Batch batch{queue_.front()};
+    queue_.pop_front();
+
+    Request& first = *batch.front();
+    int64_t total_rows = first.rows;
+
+    if (first.rows > 0 && first.rows < options_.max_batch_size) {
+      const auto deadline = first.enqueue_time + options_.max_delay;
+
+      while (true) {
+        // pull in any compatible requests that fit, preserving arrival order for everything else
+        for (auto it = queue_.begin(); it != queue_.end() && total_rows < options_.max_batch_size;) {
+          if (total_rows + (*it)->rows <= options_.max_batch_size && IsCompatible(first, **it)) {
+            total_rows += (*it)->rows;
+            batch.push_back(*it);
+            it = queue_.erase(it);
+          } else {
+            ++it;
+          }
+        }
+
+        if (total_rows >= options_.max_batch_size || shutdown_ || Clock::now() >= deadline) {
+          break;
+        }
+
+        queue_cv_.wait_for(lock, deadline - Clock::now());
+      }
+    }
+
+    ++num_running_batches_;
+    lock.unlock();
+    ScheduleBatch(std::move(batch));
+    lock.lock();
+  }
+}
+
+void BatchingSession::ScheduleBatch(Batch batch) {
+  std::function<void()> run_fn = [this, batch]() mutable {
+    RunBatch(batch);
+
+    std::lock_guard<OrtMutex> lock(queue_mutex_);
+    --num_running_batches_;
+    batch_done_cv_.notify_all();
+  };
+
+#ifdef USE_EIGEN_THREADPOOL
+  batch_thread_pool_->Schedule(std::move(run_fn));
+#else
+  batch_thread_pool_->RunTask(std::packaged_task<void()>{std::move(run_fn)});
+#endif
+}
+
+void BatchingSession::RunBatch(Batch& batch) {
+  if (batch.size() == 1) {
+    RunSingle(*batch.front());
+    return;
+  }
+
+  int64_t total_rows = 0;
+  for (const auto* request : batch) {
+    total_rows += request->rows;
+  }
+
+  auto start = Clock::now();
+  bool can_split = true;
+  auto status = RunCombined(batch, total_rows, can_split);
+  if (can_split) {
+    // a failure running the batch is returned to every request in it. running them again one at a
+    // time would most likely fail the same way and multiply the cost of the failure.
+    if (!status.IsOK()) {
+      for (auto* request : batch) {
+        request->fetches->clear();
+      }
+    }
+
+    Complete(batch, status, start, Clock::now(), total_rows);
+    return;
+  }
+
+  // the model didn't produce outputs that can be split along the batch dimension, so fall back to
+  // running each request on its own.
+  for (auto* request : batch) {
+    request->fetches->clear();
+    RunSingle(*request);
+  }
+}
+
+common::Status BatchingSession::RunCombined(Batch& batch, int64_t total_rows, bool& can_split) {
+  const Request& first = *batch.front();
+  can_split = true;
+
+  NameMLValMap feeds;
+  for (const auto& feed : *first.feeds) {
+    const auto& tensor = feed.second.Get<Tensor>();
+    auto dims = tensor.Shape().GetDims();
+    dims[0] = total_rows;
+
+    TensorShape shape(dims);
+    const auto element_type = tensor.DataType();
+    void* buffer = allocator_->Alloc(element_type->Size() * shape.Size());
+    auto p_tensor = std::make_unique<Tensor>(element_type, shape, buffer, allocator_->Info(), allocator_);
+
+    char* dst = static_cast<char*>(p_tensor->MutableDataRaw());
+    for (const auto* request : batch) {
+      const auto& src = request->feeds->at(feed.first).Get<Tensor>();
+      memcpy(dst, src.DataRaw(), src.Size());
+      dst += src.Size();
+    }
+
+    MLValue mlvalue;
+    mlvalue.Init(p_tensor.release(),
+                 DataTypeImpl::GetType<Tensor>(),
+                 DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+    feeds.insert({feed.first, mlvalue});
+  }
+
+  std::vector<MLValue> fetches;
+  ORT_RETURN_IF_ERROR(session_.Run(feeds, *first.output_names, &fetches));
+
+  for (const auto& fetch : fetches) {
+    if (!fetch.IsTensor()) {
+      can_split = false;
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Batched run produced a non-tensor output.");
+    }
+
+    const auto& tensor = fetch.Get<Tensor>();
+    const auto& dims = tensor.Shape().GetDims();
+    if (dims.empty() || dims[0] != total_rows || tensor.DataType() == DataTypeImpl::GetType<std::string>()) {
+      can_split = false;
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Batched run produced an output without the batch dimension.");
+    }
+  }
+
+  for (auto* request : batch) {
+    request->fetches->resize(fetches.size());
+  }
+
+  for (size_t i = 0, end = fetches.size(); i < end; ++i) {
+    const auto& tensor = fetches[i].Get<Tensor>();
+    const auto element_type = tensor.DataType();
+    const size_t bytes_per_row = total_rows == 0 ? 0 : tensor.Size() / static_cast<size_t>(total_rows);
+    const char* src = static_cast<const char*>(tensor.DataRaw());
+
+    for (auto* request : batch) {
+      auto dims = tensor.Shape().GetDims();
+      dims[0] = request->rows;
+
+      TensorShape shape(dims);
+      void* buffer = allocator_->Alloc(element_type->Size() * shape.Size());
+      auto p_tensor = std::make_unique<Tensor>(element_type, shape, buffer, allocator_->Info(), allocator_);
+
+      const size_t bytes = bytes_per_row * static_cast<size_t>(request->rows);
+      memcpy(p_tensor->MutableDataRaw(), src, bytes);
+      src += bytes;
+
+      (*request->fetches)[i].Init(p_tensor.release(),
+                                  DataTypeImpl::GetType<Tensor>(),
+                                  DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+    }
+  }
+
+  return Status::OK();
+}
+
+void BatchingSession::RunSingle(Request& request) {
+  auto start = Clock::now();
+  auto status = session_.Run(*request.feeds, *request.output_names, request.fetches);
+
+  Batch batch{&request};
+  Complete(batch, status, start, Clock::now(), std::max<int64_t>(request.rows, 1));
+}
+
+void BatchingSession::Complete(Batch& batch, const common::Status& status,
+                               Clock::time_point start, Clock::time_point end,
+                               int64_t total_rows) {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+
+  const auto run_time = duration_cast<microseconds>(end - start);
+
+  {
+    std::lock_guard<OrtMutex> lock(stats_mutex_);
+    ++stats_.num_batches;
+    stats_.num_rows += total_rows;
+    stats_.total_run_time += run_time;
+
+    for (const auto* request : batch) {
+      const auto queue_time = duration_cast<microseconds>(start - request->enqueue_time);
+      ++stats_.num_requests;
+      stats_.total_queue_time += queue_time;
+      stats_.max_latency = std::max(stats_.max_latency, queue_time + run_time);
+    }
+  }
+
+  for (auto* request : batch) {
+    if (request->run_info) {
+      request->run_info->batch_size = total_rows;
+      request->run_info->num_requests_in_batch = batch.size();
+      request->run_info->queue_time = duration_cast<microseconds>(start - request->enqueue_time);
+      request->run_info->run_time = run_time;
+    }
+
+    // notify while holding the lock as the request lives on the stack of the waiting Run call
+    std::lock_guard<OrtMutex> lock(request->mutex);
+    request->status = status;
+    request->done = true;
+    request->cv.notify_all();
+  }
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,148 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/framework/allocator.h"
+#include "core/framework/framework_common.h"
+#include "core/framework/ml_value.h"
+#include "core/platform/ort_mutex.h"
+#include "core/session/inference_session.h"
+
+#ifdef USE_EIGEN_THREADPOOL
+#include <unsupported/Eigen/CXX11/ThreadPool>
+#endif
+
+namespace onnxruntime {
+#ifndef USE_EIGEN_THREADPOOL
+class TaskThreadPool;
+#endif
+
+/**
+  * Configuration for a BatchingSession.
+  */
+struct BatchingOptions {
+  // maximum number of rows (size of dimension 0, summed over the coalesced requests) in one batch.
+  int64_t max_batch_size = 8;
+
+  // how long the oldest queued request may wait for other requests to join its batch.
+  std::chrono::microseconds max_delay{1000};
+
+  // number of batches that may execute concurrently. 0 uses half the number of hardware threads.
+  int num_batch_threads = 0;
+};
+
+/**
+  * Per request timing, optionally returned by BatchingSession::Run.
+  */
+struct BatchingRunInfo {
+  int64_t batch_size = 0;          ///< rows in the batch the request was executed in
+  size_t num_requests_in_batch = 0;  ///< number of requests coalesced into that batch
+  std::chrono::microseconds queue_time{0};  ///< time from Run being called until the batch started
+  std::chrono::microseconds run_time{0};    ///< time taken by InferenceSession::Run for the batch
+};
+
+/**
+  * Aggregated counters for all requests handled by a BatchingSession.
+  */
+struct BatchingStats {
+  int64_t num_requests = 0;
+  int64_t num_batches = 0;
+  int64_t num_rows = 0;  ///< sum of the batch sizes of all batches
+  std::chrono::microseconds total_queue_time{0};
+  std::chrono::microseconds total_run_time{0};
+  std::chrono::microseconds max_latency{0};  ///< largest queue_time + run_time seen by a request
+
+  /** Average fraction of max_batch_size that was filled by a batch. */
+  double AverageBatchFill(int64_t max_batch_size) const {
+    return num_batches == 0 ? 0.0
+                            : static_cast<double>(num_rows) / (static_cast<double>(num_batches) * max_batch_size);
+  }
+};
+
+/**
+  * @brief Coalesces concurrent Run calls on an InferenceSession into batched executions.
+  * Requests with the same feed names, element types and shapes (ignoring dimension 0) and the same
+  * output names are concatenated along dimension 0, executed with a single InferenceSession::Run, and
+  * the fetches are split back along dimension 0. Requests that can't be batched (non-tensor or string
+  * feeds, feeds that don't agree on dimension 0, outputs that don't have the batch dimension) are
+  * executed on their own. If the batched run fails its status is returned to every request in the batch.
+  * Batches are formed by a single dispatcher thread and executed on a pool of num_batch_threads threads.
+  * Sample usage:
+  *  InferenceSession session{so};
+  *  session.Load(MODEL_URI);
+  *  session.Initialize();
+  *  BatchingSession batching_session{session, BatchingOptions{}};
+  *  // from any number of threads
+  *  batching_session.Run(feeds, output_names, &fetches);
+  */
+class BatchingSession {
+ public:
+  /**
+    * @param session Initialized session to run the batches with. Must outlive the BatchingSession.
+    */
+  BatchingSession(InferenceSession& session, const BatchingOptions& options);
+
+  ~BatchingSession();
+
+  /**
+    * Queue a request and block until the batch containing it has completed.
+    * Thread-safe.
+    * @param run_info optional per request timing information.
+    */
+  common::Status Run(const NameMLValMap& feeds,
+                     const std::vector<std::string>& output_names,
+                     std::vector<MLValue>* p_fetches,
+                     BatchingRunInfo* run_info = nullptr);
+
+  BatchingStats GetStats() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(BatchingSession);
+
+  struct Request;
+  using Batch = std::vector<Request*>;
+
+  void DispatchLoop();
+  bool IsCompatible(const Request& first, const Request& other) const;
+  void ScheduleBatch(Batch batch);
+  void RunBatch(Batch& batch);
+  common::Status RunCombined(Batch& batch, int64_t total_rows, bool& can_split);
+  void RunSingle(Request& request);
+  void Complete(Batch& batch, const common::Status& status,
+                std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end,
+                int64_t total_rows);
+
+  InferenceSession& session_;
+  const BatchingOptions options_;
+  AllocatorPtr allocator_;
+
+  mutable OrtMutex queue_mutex_;
+  OrtCondVar queue_cv_;
+  std::deque<Request*> queue_;  // protected by queue_mutex_
+  bool shutdown_ = false;       // protected by queue_mutex_
+  int num_running_batches_ = 0;  // protected by queue_mutex_
+  OrtCondVar batch_done_cv_;
+
+  mutable OrtMutex stats_mutex_;
+  BatchingStats stats_;  // protected by stats_mutex_
+
+  int num_batch_threads_;
+#ifdef USE_EIGEN_THREADPOOL
+  std::unique_ptr<Eigen::NonBlockingThreadPool> batch_thread_pool_;
+#else
+  std::unique_ptr<TaskThreadPool> batch_thread_pool_;
+#endif
+
+  std::thread dispatcher_;
+};
+}  // namespace onnxruntime
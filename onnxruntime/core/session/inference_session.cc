@@ -7,7 +7,11 @@
 
 #include "core/session/inference_session.h"
 
+#include <cstring>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include "core/platform/ort_mutex.h"
 #include <sstream>
 #include <unordered_set>
@@ -43,6 +47,7 @@
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/session/CustomOpsLoader.h"
 #include "core/session/IOBinding.h"
+#include "core/session/optimized_model_cache.h"
 
 #ifdef USE_EIGEN_THREADPOOL
 #include <unsupported/Eigen/CXX11/ThreadPool>
@@ -65,22 +70,26 @@ class InferenceSession::Impl {
 
     InitLogger(logging_manager);
 
-    // currently the threadpool is used by the parallel executor only and hence
-    // there is no point creating it when only sequential execution is enabled.
-    if (!session_options.enable_sequential_execution) {
-      int pool_size = session_options_.session_thread_pool_size == 0
-                          ? std::thread::hardware_concurrency() / 2
-                          : session_options_.session_thread_pool_size;
+    thread_pool_size_ = session_options_.session_thread_pool_size == 0
+                            ? static_cast<int>(std::thread::hardware_concurrency() / 2)
+                            : session_options_.session_thread_pool_size;
+    if (thread_pool_size_ < 1)
+      thread_pool_size_ = 1;
 
-#ifdef USE_EIGEN_THREADPOOL
-      thread_pool_ = std::make_unique<Eigen::NonBlockingThreadPool>(pool_size);
-#else
-      thread_pool_ = std::make_unique<TaskThreadPool>(pool_size);
-#endif
+    // the threadpool is needed up front by the parallel executors. with sequential execution it is only
+    // used by kernels that parallelize their own work, so it is created the first time a kernel asks for it
+    // (see OpKernelContext::GetOperatorThreadPool).
+    if (!session_options.enable_sequential_execution) {
+      GetOrCreateThreadPool();
     }
 
     session_state_.SetThreadPool(thread_pool_.get());
+    session_state_.SetThreadPoolFactory([this]() { return GetOrCreateThreadPool(); });
     session_state_.SetEnableMemoryPattern(session_options.enable_mem_pattern);
+    session_state_.SetEnableWorkStealing(session_options.enable_work_stealing_execution);
+    session_state_.SetMemoryPatternCacheSize(session_options.mem_pattern_cache_size);
+    session_state_.SetMemoryPatternDimBuckets(session_options.mem_pattern_dim_buckets);
+    session_state_.SetSharedWeightsStore(session_options.shared_weights_store);
     session_profiler_.Initialize(session_logger_);
     session_state_.SetProfiler(session_profiler_);
     if (session_options.enable_profiling) {
@@ -88,6 +97,14 @@ class InferenceSession::Impl {
     }
   }
 
+  ~Impl() {
+    // wait for any queued RunAsync calls to complete as they use the session state
+    std::unique_lock<OrtMutex> lock(run_async_mutex_);
+    while (num_pending_async_runs_ > 0) {
+      run_async_completed_.wait(lock);
+    }
+  }
+
   common::Status RegisterExecutionProvider(std::unique_ptr<IExecutionProvider> p_exec_provider) {
     if (p_exec_provider == nullptr) {
       return Status(common::ONNXRUNTIME, common::FAIL, "Received nullptr for exec provider");
@@ -171,6 +188,8 @@ class InferenceSession::Impl {
 
   template <typename T>
   common::Status Load(const T& model_uri) {
+    SaveModelDirectory(model_uri);
+
     auto loader = [this, &model_uri](std::shared_ptr<onnxruntime::Model>& model) {
       return onnxruntime::Model::Load(model_uri, model, HasLocalSchema() ? &custom_schema_registries_ : nullptr);
     };
@@ -210,26 +229,52 @@ class InferenceSession::Impl {
     return Load(loader, "model_loading_istream");
   }
 
-  static common::Status TransformGraph(onnxruntime::Graph& graph,
-                                       const onnxruntime::GraphTransformerManager& graph_transformer_mgr,
-                                       const ExecutionProviders& providers,
-                                       KernelRegistryManager& kernel_registry_manager,
-                                       const InsertCastTransformer& insert_cast_transformer,
-                                       SessionState& session_state) {
-    // The transformer order:
-    // 1. built-in graph rewriter
-    // 2. each execution provider's transformer
-    // 3. do node placement according to kernel definition
-    // 4. insert copy nodes
-    // 5. insert cast nodes.
+  // initializers stored as external data are located relative to the model file.
+  // the path is also used to compute the optimized model cache key from the file contents.
+  void SaveModelDirectory(const std::string& model_uri) {
+    auto pos = model_uri.find_last_of("/\\");
+    model_directory_ = pos == std::string::npos ? std::string() : model_uri.substr(0, pos);
+    model_path_ = model_uri;
+  }
+
+#ifdef _WIN32
+  void SaveModelDirectory(const std::wstring& /*model_uri*/) {
+    // the Env file mapping takes narrow paths so external data is resolved against the current directory
+    model_directory_.clear();
+    model_path_.clear();
+  }
+#endif
 
+  // The transformer order:
+  // 1. built-in graph rewriter
+  // 2. each execution provider's transformer
+  // 3. do node placement according to kernel definition
+  // 4. insert copy nodes
+  // 5. insert cast nodes.
+  // Steps 1 to 3 are skipped if the graph was loaded from the optimized model cache, as the cached graph
+  // has already been rewritten and carries the node placement.
+  static common::Status OptimizeAndPartitionGraph(onnxruntime::Graph& graph,
+                                                  const onnxruntime::GraphTransformerManager& graph_transformer_mgr,
+                                                  const ExecutionProviders& providers,
+                                                  KernelRegistryManager& kernel_registry_manager,
+                                                  SessionState& session_state,
+                                                  bool apply_graph_transformers) {
     // first apply the default/system/basic graph to graph optimizations.
-    ORT_RETURN_IF_ERROR(graph_transformer_mgr.ApplyAll(graph));
+    if (apply_graph_transformers) {
+      ORT_RETURN_IF_ERROR(graph_transformer_mgr.ApplyAll(graph));
+    }
 
-    // Do partitioning based on execution providers' capability.
+    // Do partitioning based on execution providers' capability. Nodes that are already assigned keep their provider.
     GraphPartitioner partitioner(kernel_registry_manager, providers);
     ORT_RETURN_IF_ERROR(partitioner.Partition(graph, session_state.ExportDll(), session_state.GetMutableFuncMgr()));
 
+    return common::Status::OK();
+  }
+
+  static common::Status InsertCastAndCopyNodes(onnxruntime::Graph& graph,
+                                               const ExecutionProviders& providers,
+                                               KernelRegistryManager& kernel_registry_manager,
+                                               const InsertCastTransformer& insert_cast_transformer) {
     bool modified = false;
 
     // Insert cast node/s.
@@ -247,6 +292,48 @@ class InferenceSession::Impl {
     return common::Status::OK();
   }
 
+  /// Look up the optimized model cache entry for the loaded model. If there is one, model_ is replaced with it.
+  void LoadFromOptimizedModelCache(std::unique_ptr<OptimizedModelCache>& model_cache, bool& loaded_from_cache) {
+    std::vector<std::string> provider_types;
+    for (auto& provider_ptr : execution_providers_) {
+      provider_types.push_back(provider_ptr->Type());
+    }
+
+    // hashing the file is much cheaper than serializing the loaded model, so only serialize if there's no file
+    std::string key;
+    Status key_status = Status::OK();
+    if (!model_path_.empty()) {
+      key_status = OptimizedModelCache::ComputeKey(model_path_, provider_types,
+                                                   graph_transformation_mgr_.TransformerNames(),
+                                                   session_options_.max_num_graph_transformation_steps, key);
+    }
+
+    if (model_path_.empty() || !key_status.IsOK()) {
+      key = OptimizedModelCache::ComputeKey(model_->ToProto(), provider_types,
+                                            graph_transformation_mgr_.TransformerNames(),
+                                            session_options_.max_num_graph_transformation_steps);
+    }
+
+    model_cache = std::make_unique<OptimizedModelCache>(session_options_.optimized_model_cache_dir, key);
+
+    loaded_from_cache = false;
+    if (!model_cache->Exists()) {
+      return;
+    }
+
+    std::shared_ptr<onnxruntime::Model> cached_model;
+    auto status = model_cache->Load(cached_model, HasLocalSchema() ? &custom_schema_registries_ : nullptr);
+    if (!status.IsOK()) {
+      LOGS(*session_logger_, WARNING) << "Ignoring optimized model cache entry " << model_cache->Path() << ". "
+                                      << status.ErrorMessage();
+      return;
+    }
+
+    LOGS(*session_logger_, INFO) << "Loaded optimized model from " << model_cache->Path();
+    model_ = cached_model;
+    loaded_from_cache = true;
+  }
+
   /// Create SessionState instance for each subgraph as we need that for the GraphPartitioner
   /// This will be initialized by InitializeSubgraphSessions.
   common::Status CreateSubgraphSessionState(Graph& graph, SessionState& session_state) {
@@ -259,6 +346,12 @@ class InferenceSession::Impl {
         auto subgraph_session_state = std::make_unique<SessionState>(execution_providers_);
         subgraph_session_state->SetProfiler(session_profiler_);
         subgraph_session_state->SetLogger(*session_logger_);
+        subgraph_session_state->SetExternalDataDirectory(model_directory_);
+        subgraph_session_state->SetThreadPool(thread_pool_.get());
+        subgraph_session_state->SetThreadPoolFactory([this]() { return GetOrCreateThreadPool(); });
+        subgraph_session_state->SetMemoryPatternCacheSize(session_options_.mem_pattern_cache_size);
+        subgraph_session_state->SetMemoryPatternDimBuckets(session_options_.mem_pattern_dim_buckets);
+        subgraph_session_state->SetSharedWeightsStore(session_options_.shared_weights_store);
 
         // recurse
         ORT_RETURN_IF_ERROR(CreateSubgraphSessionState(*subgraph, *subgraph_session_state));
@@ -327,11 +420,20 @@ class InferenceSession::Impl {
       if (!execution_providers_.Get(onnxruntime::kCpuExecutionProvider)) {
         LOGS(*session_logger_, INFO) << "Adding default CPU execution provider.";
         CPUExecutionProviderInfo epi{session_options_.enable_cpu_mem_arena};
+        epi.arena_shrink_options = session_options_.cpu_arena_shrink_options;
+        epi.enable_arena_thread_cache = session_options_.enable_cpu_arena_thread_cache;
         ORT_RETURN_IF_ERROR(execution_providers_.Add(onnxruntime::kCpuExecutionProvider,
                                                      std::make_unique<CPUExecutionProvider>(epi)));
       }
 
+      std::unique_ptr<OptimizedModelCache> model_cache;
+      bool loaded_from_cache = false;
+      if (!session_options_.optimized_model_cache_dir.empty()) {
+        LoadFromOptimizedModelCache(model_cache, loaded_from_cache);
+      }
+
       onnxruntime::Graph& graph = model_->MainGraph();
+      session_state_.SetExternalDataDirectory(model_directory_);
 
       // Collect the kernel registries from execution provider instances;
       // There are 2 kinds of kernel registries with priority from high to low as below,
@@ -352,10 +454,20 @@ class InferenceSession::Impl {
       ORT_RETURN_IF_ERROR(CreateSubgraphSessionState(graph, session_state_));
 
       // apply any transformations to the main graph and any subgraphs
-      ORT_RETURN_IF_ERROR(TransformGraph(graph, graph_transformation_mgr_,
-                                         execution_providers_, kernel_registry_manager_,
-                                         insert_cast_transformer_,
-                                         session_state_));
+      ORT_RETURN_IF_ERROR(OptimizeAndPartitionGraph(graph, graph_transformation_mgr_,
+                                                    execution_providers_, kernel_registry_manager_,
+                                                    session_state_, !loaded_from_cache));
+
+      if (model_cache && !loaded_from_cache) {
+        auto cache_status = model_cache->Save(*model_);
+        if (!cache_status.IsOK()) {
+          LOGS(*session_logger_, WARNING) << "Failed to save optimized model to " << model_cache->Path() << ". "
+                                          << cache_status.ErrorMessage();
+        }
+      }
+
+      ORT_RETURN_IF_ERROR(InsertCastAndCopyNodes(graph, execution_providers_, kernel_registry_manager_,
+                                                 insert_cast_transformer_));
 
       // now that all the transforms are done, call Resolve on the main graph. this will recurse into the subgraphs.
       ORT_RETURN_IF_ERROR(graph.Resolve());
@@ -388,6 +500,87 @@ class InferenceSession::Impl {
     return status;
   }
 
+  common::Status PrewarmMemoryPatterns(
+      const std::vector<std::unordered_map<std::string, std::vector<int64_t>>>& input_shapes) {
+    {
+      std::lock_guard<onnxruntime::OrtMutex> l(session_mutex_);
+      if (!is_inited_) {
+        LOGS(*session_logger_, ERROR) << "Session was not initialized";
+        return common::Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+      }
+    }
+
+    if (!session_state_.GetEnableMemoryPattern()) {
+      return Status::OK();
+    }
+
+    AllocatorPtr allocator = execution_providers_.Get(onnxruntime::kCpuExecutionProvider)->GetAllocator(0, OrtMemTypeDefault);
+
+    std::vector<std::string> output_names;
+    for (const auto* output : output_def_list_) {
+      output_names.push_back(output->Name());
+    }
+
+    for (const auto& shapes : input_shapes) {
+      NameMLValMap feeds;
+      for (const auto* input : required_input_def_list_) {
+        auto entry = shapes.find(input->Name());
+        if (entry == shapes.cend()) {
+          return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "No shape provided for input ", input->Name());
+        }
+
+        auto input_type = utils::GetMLDataType(*input);
+        if (!input_type->IsTensorType()) {
+          return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input ", input->Name(), " is not a tensor.");
+        }
+
+        const auto element_type = input_type->AsTensorType()->GetElementType();
+        if (element_type == DataTypeImpl::GetType<std::string>()) {
+          return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED, "Input ", input->Name(), " is a string tensor.");
+        }
+
+        const TensorShape shape = session_state_.GetBucketedShapes({TensorShape(entry->second)})[0];
+        const size_t bytes = element_type->Size() * shape.Size();
+        void* buffer = bytes > 0 ? allocator->Alloc(bytes) : nullptr;
+        if (buffer != nullptr) {
+          memset(buffer, 0, bytes);
+        }
+
+        auto p_tensor = std::make_unique<Tensor>(element_type, shape, buffer, allocator->Info(), allocator);
+        MLValue mlvalue;
+        mlvalue.Init(p_tensor.release(),
+                     DataTypeImpl::GetType<Tensor>(),
+                     DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+        feeds.insert({input->Name(), mlvalue});
+      }
+
+      // the executor generates and caches the pattern for these shapes as part of the run
+      std::vector<MLValue> fetches;
+      ORT_RETURN_IF_ERROR(Run(feeds, output_names, &fetches));
+    }
+
+    return Status::OK();
+  }
+
+  common::Status TrimArenas(size_t* bytes_released) {
+    size_t bytes = 0;
+    for (auto& provider_ptr : execution_providers_) {
+      for (auto& allocator : provider_ptr->GetAllocatorMap()) {
+        auto* arena = dynamic_cast<IArenaAllocator*>(allocator.get());
+        if (arena != nullptr) {
+          bytes += arena->Shrink();
+        }
+      }
+    }
+
+    LOGS(*session_logger_, INFO) << "Released " << bytes << " bytes held by the arenas.";
+    if (bytes_released != nullptr) {
+      *bytes_released = bytes;
+    }
+
+    return Status::OK();
+  }
+
   int GetCurrentNumRuns() const {
     return current_num_runs_.load();
   }
@@ -632,6 +825,10 @@ class InferenceSession::Impl {
     return std::make_pair(common::Status::OK(), &output_def_list_);
   }
 
+  const SessionState& GetSessionState() const {
+    return session_state_;
+  }
+
   common::Status NewIOBinding(std::unique_ptr<IOBinding>* io_binding) {
     {
       std::lock_guard<onnxruntime::OrtMutex> l(session_mutex_);
@@ -657,6 +854,74 @@ class InferenceSession::Impl {
     return Run(run_options, io_binding);
   }
 
+  common::Status RunAsync(const RunOptions& run_options,
+                          const NameMLValMap& feeds,
+                          const std::vector<std::string>& output_names,
+                          InferenceSession::RunAsyncCallback callback) {
+    if (!callback) {
+      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "RunAsync requires a callback");
+    }
+
+    {
+      std::lock_guard<onnxruntime::OrtMutex> l(session_mutex_);
+      if (!is_inited_) {
+        LOGS(*session_logger_, ERROR) << "Session was not initialized";
+        return Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+      }
+    }
+
+    {
+      std::lock_guard<OrtMutex> l(run_async_mutex_);
+
+      // The runs can't be executed on thread_pool_ as the parallel executor and kernels that parallelize their
+      // own work block waiting for tasks they add to it. Use a separate pool of the same size, created on first use.
+      if (!run_async_thread_pool_) {
+#ifdef USE_EIGEN_THREADPOOL
+        run_async_thread_pool_ = std::make_unique<Eigen::NonBlockingThreadPool>(thread_pool_size_);
+#else
+        run_async_thread_pool_ = std::make_unique<TaskThreadPool>(thread_pool_size_);
+#endif
+      }
+
+      ++num_pending_async_runs_;
+    }
+
+    // MLValue instances share the underlying data so copying the feeds is cheap
+    std::function<void()> run_fn = [this, &run_options, feeds, output_names, callback]() {
+      std::vector<MLValue> fetches;
+      Status status = Run(run_options, feeds, output_names, &fetches);
+      if (!status.IsOK()) {
+        fetches.clear();
+      }
+
+      try {
+        callback(status, fetches);
+      } catch (const std::exception& ex) {
+        LOGS(*session_logger_, ERROR) << "Exception in RunAsync callback: " << ex.what();
+      } catch (...) {
+        LOGS(*session_logger_, ERROR) << "Unknown exception in RunAsync callback";
+      }
+
+      std::lock_guard<OrtMutex> l(run_async_mutex_);
+      --num_pending_async_runs_;
+      run_async_completed_.notify_all();
+    };
+
+#ifdef USE_EIGEN_THREADPOOL
+    run_async_thread_pool_->Schedule(std::move(run_fn));
+#else
+    run_async_thread_pool_->RunTask(std::packaged_task<void()>{std::move(run_fn)});
+#endif
+
+    return Status::OK();
+  }
+
+  common::Status RunAsync(const NameMLValMap& feeds,
+                          const std::vector<std::string>& output_names,
+                          InferenceSession::RunAsyncCallback callback) {
+    return RunAsync(default_run_options_, feeds, output_names, std::move(callback));
+  }
+
   void StartProfiling(const std::string& file_prefix) {
     std::ostringstream ss;
     ss << file_prefix << "_" << GetCurrentTimeString() << ".json";
@@ -792,6 +1057,21 @@ class InferenceSession::Impl {
     session_state_.SetLogger(*session_logger_);
   }
 
+#ifdef USE_EIGEN_THREADPOOL
+  Eigen::NonBlockingThreadPool* GetOrCreateThreadPool() {
+#else
+  TaskThreadPool* GetOrCreateThreadPool() {
+#endif
+    std::call_once(thread_pool_once_, [this]() {
+#ifdef USE_EIGEN_THREADPOOL
+      thread_pool_ = std::make_unique<Eigen::NonBlockingThreadPool>(thread_pool_size_);
+#else
+      thread_pool_ = std::make_unique<TaskThreadPool>(thread_pool_size_);
+#endif
+    });
+    return thread_pool_.get();
+  }
+
   common::Status WaitForNotification(Notification* p_executor_done, int64_t timeout_in_ms) {
     if (timeout_in_ms > 0) {
       ORT_NOT_IMPLEMENTED(__FUNCTION__, "timeout_in_ms >0 is not supported");  // TODO
@@ -831,6 +1111,10 @@ class InferenceSession::Impl {
   // if they need.
   std::shared_ptr<onnxruntime::Model> model_;
 
+  // directory of the model file if it was loaded from a path. external data locations are relative to it.
+  std::string model_directory_;
+  std::string model_path_;  // empty if the model was not loaded from a file
+
   // A set of executors that can run in parallel.
   std::vector<std::unique_ptr<IExecutor>> executors_;  // TODO do we need this vector?
 
@@ -852,13 +1136,31 @@ class InferenceSession::Impl {
   // statically allocated pointer, no need to manage its lifetime.
   //Env* env_;
 
-  // Threadpool for this session
-  //thread::ThreadPool thread_pool_; // not used for now; will add it later when implementing RunAsync
+  // Threadpool for this session. Created in the constructor for the parallel executors, otherwise by
+  // GetOrCreateThreadPool the first time a kernel asks for it.
 #ifdef USE_EIGEN_THREADPOOL
   std::unique_ptr<Eigen::NonBlockingThreadPool> thread_pool_;
 #else
   std::unique_ptr<TaskThreadPool> thread_pool_;
 #endif
+  int thread_pool_size_;
+  std::once_flag thread_pool_once_;
+
+  // Number of RunAsync calls that are queued or running. The destructor waits for this to reach zero.
+  int num_pending_async_runs_ = 0;  // GUARDED_BY(run_async_mutex_)
+  OrtMutex run_async_mutex_;
+  OrtCondVar run_async_completed_;
+
+  // used by RunAsync calls that don't provide RunOptions, as the instance must outlive the run
+  const RunOptions default_run_options_{};
+
+  // Threadpool for RunAsync. Created on first use.
+  // Declared after the members used by the queued runs so its threads are joined first on destruction.
+#ifdef USE_EIGEN_THREADPOOL
+  std::unique_ptr<Eigen::NonBlockingThreadPool> run_async_thread_pool_;  // GUARDED_BY(run_async_mutex_)
+#else
+  std::unique_ptr<TaskThreadPool> run_async_thread_pool_;  // GUARDED_BY(run_async_mutex_)
+#endif
 
   // Number of concurrently running executors
   std::atomic<int> current_num_runs_;
@@ -896,6 +1198,15 @@ common::Status InferenceSession::Initialize() {
   return impl_->Initialize();
 }
 
+common::Status InferenceSession::TrimArenas(size_t* bytes_released) {
+  return impl_->TrimArenas(bytes_released);
+}
+
+common::Status InferenceSession::PrewarmMemoryPatterns(
+    const std::vector<std::unordered_map<std::string, std::vector<int64_t>>>& input_shapes) {
+  return impl_->PrewarmMemoryPatterns(input_shapes);
+}
+
 common::Status InferenceSession::Run(const NameMLValMap& feeds,
                                      const std::vector<std::string>& output_names,
                                      std::vector<MLValue>* p_fetches) {
@@ -921,6 +1232,10 @@ std::pair<common::Status, const OutputDefList*> InferenceSession::GetModelOutput
   return impl_->GetModelOutputs();
 }
 
+const SessionState& InferenceSession::GetSessionState() const {
+  return impl_->GetSessionState();
+}
+
 int InferenceSession::GetCurrentNumRuns() {
   return impl_->GetCurrentNumRuns();
 }
@@ -969,6 +1284,19 @@ common::Status InferenceSession::Run(IOBinding& io_binding) {
   return impl_->Run(io_binding);
 }
 
+common::Status InferenceSession::RunAsync(const RunOptions& run_options,
+                                          const NameMLValMap& feeds,
+                                          const std::vector<std::string>& output_names,
+                                          RunAsyncCallback callback) {
+  return impl_->RunAsync(run_options, feeds, output_names, std::move(callback));
+}
+
+common::Status InferenceSession::RunAsync(const NameMLValMap& feeds,
+                                          const std::vector<std::string>& output_names,
+                                          RunAsyncCallback callback) {
+  return impl_->RunAsync(feeds, output_names, std::move(callback));
+}
+
 common::Status InferenceSession::LoadCustomOps(const std::vector<std::string>& dso_list) {
   return impl_->LoadCustomOps(dso_list);
 }
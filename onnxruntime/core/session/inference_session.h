@@ -3,11 +3,15 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "core/common/common.h"
 #include "core/common/status.h"
+#include "core/framework/arena.h"
 #include "core/framework/framework_common.h"
 #include "core/graph/basic_types.h"
 #include "core/common/logging/logging.h"
@@ -23,6 +27,8 @@ class ModelProto;
 namespace onnxruntime {
 class IExecutionProvider;  // forward decl
 class IOBinding;
+class SessionState;
+class SharedWeightsStore;
 
 class CustomRegistry;
 
@@ -37,6 +43,10 @@ struct SessionOptions {
   //int num_threads; // not used now until we re-introduce threadpools for async execution
   bool enable_sequential_execution = true;  // TODO: should we default to sequential execution?
 
+  // when enable_sequential_execution is false, run the graph with the work stealing executor
+  // (per-thread node queues ordered by critical path) instead of submitting every node to the thread pool.
+  bool enable_work_stealing_execution = false;
+
   // enable profiling for this session.
   bool enable_profiling = false;
 
@@ -51,6 +61,14 @@ struct SessionOptions {
   // set this option to false if you don't want it.
   bool enable_cpu_mem_arena = true;
 
+  // when the CPU arena returns unused memory to the system. by default it keeps everything it has allocated.
+  // see also InferenceSession::TrimArenas.
+  ArenaShrinkOptions cpu_arena_shrink_options;
+
+  // serve small allocations in the CPU arena from per-thread caches, so kernels running on the session thread pool
+  // don't contend on the arena lock. each thread using the arena caches up to 32 free blocks per size class.
+  bool enable_cpu_arena_thread_cache = false;
+
   // the prefix of the profile file. The current time will be appended to the file name.
   std::string profile_file_prefix = "onnxruntime_profile_";
 
@@ -61,6 +79,25 @@ struct SessionOptions {
 
   // How many threads in the session thread pool.
   int session_thread_pool_size = 0;
+
+  // maximum number of memory patterns cached per graph. the least recently used pattern is evicted once
+  // the limit is reached. 0 means unbounded.
+  size_t mem_pattern_cache_size = 64;
+
+  // ascending bucket boundaries input dimensions are rounded up to when looking up memory patterns, so that
+  // inputs with varying sequence lengths share a pattern per bucket. the pattern of a bucket is regenerated
+  // when a larger shape in it is run. dimensions beyond the last bucket are used as is. empty disables bucketing.
+  std::vector<int64_t> mem_pattern_dim_buckets;
+
+  // directory to cache the transformed and partitioned graph in. when set, Initialize reuses a cached graph
+  // for the same model, execution providers and graph transformers instead of re-running the transformers
+  // and the partitioner, and saves the graph it produces otherwise. empty disables the cache.
+  std::string optimized_model_cache_dir;
+
+  // store to share CPU initializers with other sessions loading the same model. when several sessions use the
+  // same instance each weight, and each copy a kernel prepacks from it, is held in memory once instead of once per
+  // session. nullptr disables sharing.
+  std::shared_ptr<SharedWeightsStore> shared_weights_store;
 };
 
 /**
@@ -172,6 +209,18 @@ class InferenceSession {
     */
   common::Status Initialize();
 
+  /**
+    * Generate and cache memory patterns for a list of expected input shapes, so that the first request with
+    * each shape doesn't pay for tracing the allocations. The model is run once per entry with zero filled
+    * inputs after rounding the shapes up to SessionOptions::mem_pattern_dim_buckets, so the pattern generated
+    * fits every shape in the bucket.
+    * Call after Initialize and before serving requests. Only tensor inputs are supported.
+    * @param input_shapes each entry maps every required model input name to its shape.
+    * @return OK if success.
+    */
+  common::Status PrewarmMemoryPatterns(
+      const std::vector<std::unordered_map<std::string, std::vector<int64_t>>>& input_shapes);
+
   /**
     * Run a pre-loaded and pre-intialized model.
     * Multiple threads are allowed to run this function; hence its thread-safe.
@@ -206,6 +255,48 @@ class InferenceSession {
   common::Status Run(const RunOptions& run_options, IOBinding& io_binding);
   common::Status Run(IOBinding& io_binding);
 
+  /**
+    * Called on completion of RunAsync with the status of the run and the output values in the order
+    * specified by output_names. fetches is empty if status is not OK.
+    */
+  using RunAsyncCallback = std::function<void(const common::Status& status, std::vector<MLValue>& fetches)>;
+
+  /**
+    * Run a pre-loaded and pre-initialized model asynchronously.
+    * The request is queued and the call returns immediately. The model is run on a thread owned by the session
+    * and callback is invoked on that thread when the run completes.
+    * Multiple threads are allowed to call this function; hence its thread-safe.
+    * @param run_options use this to tune the Run call to your needs. Must remain valid until callback is invoked.
+    *        Setting terminate will stop the run.
+    * @param feeds named inputs owned by client code. The values must not be changed until callback is invoked.
+    * @param output_names output names
+    * @param callback called with the result of the run. Must not destroy the session.
+    * @return OK if the run was queued. callback is not invoked if an error is returned.
+    * @note The session destructor waits for all queued runs to complete.
+    */
+  common::Status RunAsync(const RunOptions& run_options,
+                          const NameMLValMap& feeds,
+                          const std::vector<std::string>& output_names,
+                          RunAsyncCallback callback);
+
+  /**
+    * See RunAsync(const RunOptions& run_options, const NameMLValMap& feeds,
+    *              const std::vector<std::string>& output_names, RunAsyncCallback callback)
+    * for details. Uses the default RunOptions.
+    */
+  common::Status RunAsync(const NameMLValMap& feeds,
+                          const std::vector<std::string>& output_names,
+                          RunAsyncCallback callback);
+
+  /**
+    * Return memory held by the arenas of the registered execution providers that is not currently in use.
+    * Useful for long running servers after an unusually large request, or when the session becomes idle.
+    * Thread-safe. Memory in use by concurrent Run calls is not affected.
+    * @param bytes_released optional. set to the number of bytes returned to the device allocators.
+    * @return OK if success.
+    */
+  common::Status TrimArenas(size_t* bytes_released = nullptr);
+
   /**
     * @return pair.first = OK; FAIL otherwise. pair.second is non-NULL when pair.first = OK.
     * @note lifetime of the returned pointer is valid as long as the Session object is live.
@@ -267,6 +358,11 @@ class InferenceSession {
     */
   common::Status Load(std::unique_ptr<ONNX_NAMESPACE::ModelProto> p_model_proto);
 
+  /**
+    * Get the session state of the main graph, for tests that inspect an initialized session.
+    */
+  const SessionState& GetSessionState() const;
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(InferenceSession);
 
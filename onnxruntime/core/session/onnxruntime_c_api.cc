@@ -454,6 +454,83 @@ ORT_API_STATUS_IMPL(OrtRun, _In_ OrtSession* sess,
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtRunAsync, _In_ OrtSession* sess,
+                    _In_opt_ OrtRunOptions* run_options,
+                    _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
+                    _In_ const char* const* output_names1, size_t output_names_len,
+                    _In_ OrtRunAsyncCallback callback, _In_opt_ void* user_data) {
+  API_IMPL_BEGIN
+  if (callback == nullptr) {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "callback cannot be NULL");
+  }
+
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  ::onnxruntime::NameMLValMap in;
+  const int queue_id = 0;
+  for (size_t i = 0; i != input_len; ++i) {
+    auto kvp = in.insert(std::make_pair(std::string(input_names[i]),
+                                        *reinterpret_cast<const ::onnxruntime::MLValue*>(input[i])));
+    if (!kvp.second) {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "duplicated input name");
+    }
+    ::onnxruntime::MLValue& value = kvp.first->second;
+    if (value.Fence())
+      value.Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, queue_id);
+  }
+
+  std::vector<std::string> output_names(output_names_len);
+  for (size_t i = 0; i != output_names_len; ++i) {
+    if (output_names1[i] == nullptr || output_names1[i][0] == '\0') {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "output name cannot be empty");
+    }
+    output_names[i] = output_names1[i];
+  }
+
+  auto on_complete = [callback, user_data, output_names_len](const Status& status, std::vector<MLValue>& fetches) {
+    if (!status.IsOK()) {
+      callback(user_data, ToOrtStatus(status), nullptr, output_names_len);
+      return;
+    }
+
+    // the callback must be invoked exactly once, so a failure converting the outputs is reported through it
+    // rather than escaping to the session's thread pool
+    std::vector<OrtValue*> output(output_names_len, nullptr);
+    OrtStatus* conversion_status = nullptr;
+    try {
+      for (size_t i = 0; i != output_names_len; ++i) {
+        ::onnxruntime::MLValue& value = fetches.at(i);
+        if (value.Fence())
+          value.Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, queue_id);
+        output[i] = reinterpret_cast<OrtValue*>(new MLValue(value));
+      }
+    } catch (const std::exception& ex) {
+      conversion_status = OrtCreateStatus(ORT_RUNTIME_EXCEPTION, ex.what());
+    } catch (...) {
+      conversion_status = OrtCreateStatus(ORT_RUNTIME_EXCEPTION, "Unknown exception converting RunAsync outputs");
+    }
+
+    if (conversion_status != nullptr) {
+      for (OrtValue* value : output) {
+        delete reinterpret_cast<MLValue*>(value);
+      }
+      callback(user_data, conversion_status, nullptr, output_names_len);
+      return;
+    }
+
+    callback(user_data, nullptr, output.data(), output_names_len);
+  };
+
+  Status status;
+  if (run_options == nullptr) {
+    status = session->RunAsync(in, output_names, on_complete);
+  } else {
+    status = session->RunAsync(*run_options, in, output_names, on_complete);
+  }
+
+  return ToOrtStatus(status);
+  API_IMPL_END
+}
+
 ORT_API_STATUS_IMPL(OrtGetTensorMutableData, _In_ OrtValue* value, _Out_ void** output) {
   TENSOR_READWRITE_API_BEGIN
   //TODO: test if it's a string tensor
@@ -0,0 +1,267 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/optimized_model_cache.h"
+
+#include <atomic>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+#include "core/graph/graph.h"
+#include "core/platform/env.h"
+
+using namespace ONNX_NAMESPACE;
+
+namespace onnxruntime {
+
+// bump when the contents of a cache entry change in an incompatible way
+static constexpr int kCacheFormatVersion = 2;
+
+// the transformers and kernels differ between releases and between builds with different libraries, so an entry
+// written by one build must not be loaded by another.
+#ifndef ORT_VERSION
+#error ORT_VERSION must be defined by the build
+#endif
+static const char* const kBuildConfiguration = ORT_VERSION
+#ifdef USE_MLAS
+    ";mlas"
+#endif
+#ifdef USE_MKLDNN
+    ";mkldnn"
+#endif
+#ifdef USE_MKLML
+    ";mklml"
+#endif
+#ifdef USE_OPENBLAS
+    ";openblas"
+#endif
+#ifdef USE_EIGEN_FOR_BLAS
+    ";eigen_blas"
+#endif
+#ifdef USE_CUDA
+    ";cuda"
+#endif
+#ifdef USE_TRT
+    ";trt"
+#endif
+#ifdef USE_NUPHAR
+    ";nuphar"
+#endif
+#ifdef USE_TVM
+    ";tvm"
+#endif
+    "";
+
+// metadata entry holding "<scope><first output name>\t<provider type>\n" for every assigned node.
+// the first output uniquely identifies a node within its graph and survives the re-ordering done when the graph
+// is serialized. for nodes in a subgraph the scope is "<first output of the parent node>\t<attribute name>\t",
+// repeated for each level of nesting.
+static const char* const kProviderAssignmentsKey = "onnxruntime.optimized_model_cache.providers";
+
+// 64-bit FNV-1a
+static void HashBytes(const char* data, size_t length, uint64_t& hash) {
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+}
+
+static void HashString(const std::string& str, uint64_t& hash) {
+  // include the terminator so adjacent strings can't alias
+  HashBytes(str.c_str(), str.size() + 1, hash);
+}
+
+static std::string ComputeKeyImpl(uint64_t hash,
+                                  const std::vector<std::string>& provider_types,
+                                  const std::vector<std::string>& transformer_names,
+                                  unsigned max_num_graph_transformation_steps) {
+  for (const auto& provider_type : provider_types) {
+    HashString(provider_type, hash);
+  }
+
+  for (const auto& transformer_name : transformer_names) {
+    HashString(transformer_name, hash);
+  }
+
+  HashString(std::to_string(max_num_graph_transformation_steps), hash);
+  HashString(std::to_string(kCacheFormatVersion), hash);
+  HashString(kBuildConfiguration, hash);
+
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return key.str();
+}
+
+static void WriteProviderAssignments(Graph& graph, const std::string& scope, std::ostringstream& assignments) {
+  for (auto& node : graph.Nodes()) {
+    if (node.OutputDefs().empty()) {
+      continue;
+    }
+
+    const std::string& node_name = node.OutputDefs()[0]->Name();
+    if (!node.GetExecutionProviderType().empty()) {
+      assignments << scope << node_name << '\t' << node.GetExecutionProviderType() << '\n';
+    }
+
+    for (auto& entry : node.GetAttributeNameToMutableSubgraphMap()) {
+      WriteProviderAssignments(*entry.second, scope + node_name + '\t' + entry.first + '\t', assignments);
+    }
+  }
+}
+
+static void ApplyProviderAssignments(Graph& graph, const std::string& scope,
+                                     const std::unordered_map<std::string, std::string>& assignments) {
+  for (auto& node : graph.Nodes()) {
+    if (node.OutputDefs().empty()) {
+      continue;
+    }
+
+    const std::string& node_name = node.OutputDefs()[0]->Name();
+    auto assignment = assignments.find(scope + node_name);
+    if (assignment != assignments.cend()) {
+      node.SetExecutionProviderType(assignment->second);
+    }
+
+    for (auto& entry : node.GetAttributeNameToMutableSubgraphMap()) {
+      ApplyProviderAssignments(*entry.second, scope + node_name + '\t' + entry.first + '\t', assignments);
+    }
+  }
+}
+
+static bool HasFusedNodes(Graph& graph) {
+  for (auto& node : graph.Nodes()) {
+    if (node.NodeType() == Node::Type::Fused) {
+      return true;
+    }
+
+    for (const auto& entry : node.GetAttributeNameToMutableSubgraphMap()) {
+      if (HasFusedNodes(*entry.second)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+OptimizedModelCache::OptimizedModelCache(const std::string& cache_dir, const std::string& key) {
+  path_ = cache_dir;
+  if (!path_.empty() && path_.back() != '/' && path_.back() != '\\') {
+    path_ += '/';
+  }
+
+  path_ += key + ".onnx";
+}
+
+std::string OptimizedModelCache::ComputeKey(const ModelProto& model_proto,
+                                            const std::vector<std::string>& provider_types,
+                                            const std::vector<std::string>& transformer_names,
+                                            unsigned max_num_graph_transformation_steps) {
+  uint64_t hash = 14695981039346656037ULL;
+
+  const std::string serialized = model_proto.SerializeAsString();
+  HashBytes(serialized.data(), serialized.size(), hash);
+
+  return ComputeKeyImpl(hash, provider_types, transformer_names, max_num_graph_transformation_steps);
+}
+
+common::Status OptimizedModelCache::ComputeKey(const std::string& model_path,
+                                               const std::vector<std::string>& provider_types,
+                                               const std::vector<std::string>& transformer_names,
+                                               unsigned max_num_graph_transformation_steps,
+                                               std::string& key) {
+  size_t length = 0;
+  ORT_RETURN_IF_ERROR(Env::Default().GetFileLength(model_path, length));
+
+  uint64_t hash = 14695981039346656037ULL;
+  if (length > 0) {
+    // the file was mapped by Model::Load so this is normally served from the page cache
+    Env::MappedMemoryPtr mapped;
+    ORT_RETURN_IF_ERROR(Env::Default().MapFileIntoMemory(model_path, 0, length, mapped));
+    HashBytes(mapped.get(), length, hash);
+  }
+
+  key = ComputeKeyImpl(hash, provider_types, transformer_names, max_num_graph_transformation_steps);
+  return Status::OK();
+}
+
+bool OptimizedModelCache::Exists() const {
+  size_t length = 0;
+  return Env::Default().GetFileLength(path_, length).IsOK() && length > 0;
+}
+
+common::Status OptimizedModelCache::Load(std::shared_ptr<Model>& p_model,
+                                         const IOnnxRuntimeOpSchemaRegistryList* local_registries) const {
+  std::shared_ptr<Model> model;
+  ORT_RETURN_IF_ERROR(Model::Load(path_, model, local_registries));
+
+  const auto& metadata = model->MetaData();
+  auto entry = metadata.find(kProviderAssignmentsKey);
+  if (entry == metadata.cend()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_GRAPH, "Optimized model cache entry ", path_,
+                           " has no execution provider assignments.");
+  }
+
+  std::unordered_map<std::string, std::string> assignments;
+  std::istringstream lines(entry->second);
+  std::string line;
+  while (std::getline(lines, line)) {
+    // the provider type follows the last separator. everything before it identifies the node.
+    auto separator = line.rfind('\t');
+    if (separator == std::string::npos) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_GRAPH, "Invalid provider assignment in ", path_, ": ", line);
+    }
+
+    assignments[line.substr(0, separator)] = line.substr(separator + 1);
+  }
+
+  ApplyProviderAssignments(model->MainGraph(), "", assignments);
+
+  p_model = model;
+  return Status::OK();
+}
+
+common::Status OptimizedModelCache::Save(Model& model) const {
+  Graph& graph = model.MainGraph();
+  if (HasFusedNodes(graph)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED,
+                           "Graphs with nodes fused by an execution provider can't be cached.");
+  }
+
+  std::ostringstream assignments;
+  WriteProviderAssignments(graph, "", assignments);
+
+  ModelProto model_proto = model.ToProto();
+  auto* prop = model_proto.add_metadata_props();
+  prop->set_key(kProviderAssignmentsKey);
+  prop->set_value(assignments.str());
+
+  // write to a temporary file and rename it into place so concurrently starting sessions never see a
+  // partially written entry. the counter keeps sessions of the same process from sharing a temporary file.
+  static std::atomic<uint64_t> num_saves{0};
+  const std::string temp_path = path_ + "." + std::to_string(Env::Default().GetSelfPid()) + "." +
+                                std::to_string(num_saves++) + ".tmp";
+
+  int fd;
+  ORT_RETURN_IF_ERROR(Env::Default().FileOpenWr(temp_path, fd));
+  const bool serialized = model_proto.SerializeToFileDescriptor(fd);
+  ORT_RETURN_IF_ERROR(Env::Default().FileClose(fd));
+
+  if (!serialized) {
+    std::remove(temp_path.c_str());
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_PROTOBUF, "Failed to write optimized model cache entry ", temp_path);
+  }
+
+  if (std::rename(temp_path.c_str(), path_.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+    // another session may have created the entry in the meantime
+    if (!Exists()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to create optimized model cache entry ", path_);
+    }
+  }
+
+  return Status::OK();
+}
+}  // namespace onnxruntime
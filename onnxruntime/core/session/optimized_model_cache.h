@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/graph/model.h"
+#include "core/graph/onnx_protobuf.h"
+
+namespace onnxruntime {
+
+/**
+  * @brief Persists the graph produced by the graph transformers and the GraphPartitioner so that later
+  * sessions for the same model and provider set can skip those steps.
+  * The cache entry is an ONNX model holding the optimized graph. The execution provider assigned to each
+  * node of the main graph and of any subgraphs is recorded in the model metadata and re-applied on load, so
+  * the partitioner (and hence kernel lookup) picks the same kernels without re-evaluating provider capabilities.
+  * Entries are keyed by a hash of the original model, the execution provider types in preference order
+  * and the registered graph transformers, plus the runtime version and the libraries it was built with, so an
+  * upgraded runtime doesn't load entries written by an older one. For a model loaded from a file the bytes of the
+  * file are hashed, otherwise the serialized ModelProto is.
+  */
+class OptimizedModelCache {
+ public:
+  /**
+    * @param cache_dir directory the cache entries are stored in.
+    * @param key key for the model, see ComputeKey.
+    */
+  OptimizedModelCache(const std::string& cache_dir, const std::string& key);
+
+  static std::string ComputeKey(const ONNX_NAMESPACE::ModelProto& model_proto,
+                                const std::vector<std::string>& provider_types,
+                                const std::vector<std::string>& transformer_names,
+                                unsigned max_num_graph_transformation_steps);
+
+  /**
+    * Compute the key from the contents of a model file. This avoids serializing the loaded model.
+    */
+  static common::Status ComputeKey(const std::string& model_path,
+                                   const std::vector<std::string>& provider_types,
+                                   const std::vector<std::string>& transformer_names,
+                                   unsigned max_num_graph_transformation_steps,
+                                   std::string& key);
+
+  const std::string& Path() const noexcept { return path_; }
+
+  bool Exists() const;
+
+  /**
+    * Load the optimized model and re-apply the execution provider assignments of the main graph and subgraphs.
+    */
+  common::Status Load(std::shared_ptr<Model>& p_model, const IOnnxRuntimeOpSchemaRegistryList* local_registries) const;
+
+  /**
+    * Save a model that has been transformed and partitioned. Fails if the graph contains nodes that were fused
+    * by an execution provider, as those can't be reconstructed from the ONNX model.
+    */
+  common::Status Save(Model& model) const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(OptimizedModelCache);
+
+  std::string path_;
+};
+}  // namespace onnxruntime
@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "core/common/common.h"
+#include "core/framework/tensor.h"
+
+namespace onnxruntime {
+
+// Converts a positive real multiplier into a Q31 fixed point multiplier in the
+// range [0.5, 1) and a right shift. A negative right shift indicates that the
+// real multiplier is greater than one.
+inline void QuantizeMultiplier(float fp_multiplier, int32_t* integer_multiplier, int* right_shift) {
+  uint32_t fp_as_bits;
+  std::memcpy(&fp_as_bits, &fp_multiplier, sizeof(fp_as_bits));
+  auto current_exponent = static_cast<int>(fp_as_bits >> 23);
+  // bring multiplier in [.5,1) range and calculate the shift
+  uint32_t bumped_multiplier_as_bits = (fp_as_bits & UINT32_C(0x007fffff)) | UINT32_C(0x3f000000);
+  float bumped_multiplier;
+  std::memcpy(&bumped_multiplier, &bumped_multiplier_as_bits, sizeof(bumped_multiplier));
+  int shift = 126 - current_exponent;
+  // convert to fixed point number
+  int64_t int_multiplier = static_cast<int64_t>(std::round(bumped_multiplier * (1ll << 31)));
+
+  *integer_multiplier = static_cast<int32_t>(int_multiplier);
+  *right_shift = shift;
+}
+
+// Returns the high 32 bits of 2*a*b with rounding, saturating the single
+// overflow case of INT32_MIN*INT32_MIN.
+inline int32_t SaturatingRoundingDoublingHighMul(int32_t a, int32_t b) {
+  if (a == b && a == std::numeric_limits<int32_t>::min()) {
+    return std::numeric_limits<int32_t>::max();
+  }
+  int64_t ab = static_cast<int64_t>(a) * static_cast<int64_t>(b);
+  int64_t nudge = ab >= 0 ? (1ll << 30) : (1 - (1ll << 30));
+  return static_cast<int32_t>((ab + nudge) / (1ll << 31));
+}
+
+// Divides by 2^exponent, rounding half away from zero. Tiny real multipliers
+// give exponents of 31 or more, so the division is done in 64 bits with the
+// exponent clamped to a valid shift count; every such shift still rounds x
+// exactly.
+inline int32_t RoundingDivideByPOT(int32_t x, int exponent) {
+  exponent = std::min(exponent, 62);
+  const int64_t mask = (int64_t{1} << exponent) - 1;
+  const int64_t remainder = x & mask;
+  const int64_t threshold = (mask >> 1) + (x < 0 ? 1 : 0);
+  return static_cast<int32_t>((static_cast<int64_t>(x) >> exponent) + (remainder > threshold ? 1 : 0));
+}
+
+// Requantizes a row major M x N block of 32-bit accumulators to uint8 using a
+// fixed point multiplier from QuantizeMultiplier. The optional bias supplies
+// one value per row. The arithmetic matches the gemmlowp output pipeline of
+// OutputStageBiasAddition, OutputStageQuantizeDownInt32ByFixedPoint and
+// OutputStageSaturatingCastToUint8.
+inline void RequantizeOutput(const int32_t* input, size_t ld_input, uint8_t* output, size_t ld_output,
+                             const int32_t* bias, size_t M, size_t N, int32_t integer_multiplier,
+                             int right_shift, uint8_t output_offset) {
+  const int left_shift = right_shift < 0 ? std::min(-right_shift, 31) : 0;
+  right_shift = right_shift > 0 ? right_shift : 0;
+
+  for (size_t m = 0; m < M; m++) {
+    const int32_t row_bias = bias != nullptr ? bias[m] : 0;
+    for (size_t n = 0; n < N; n++) {
+      int64_t value = static_cast<int64_t>(input[n]) + row_bias;
+      value *= (int64_t{1} << left_shift);
+      value = std::min<int64_t>(std::max<int64_t>(value, std::numeric_limits<int32_t>::min()),
+                                std::numeric_limits<int32_t>::max());
+      int32_t scaled = SaturatingRoundingDoublingHighMul(static_cast<int32_t>(value), integer_multiplier);
+      scaled = RoundingDivideByPOT(scaled, right_shift) + output_offset;
+      output[n] = static_cast<uint8_t>(std::min(std::max(scaled, 0), 255));
+    }
+    input += ld_input;
+    output += ld_output;
+  }
+}
+
+inline void ScaleAndZeropointPairValidationHelper(const Tensor* scale, const Tensor* zeropoint) {
+  ORT_ENFORCE(scale->Shape().NumDimensions() == 0 ||
+                  (scale->Shape().NumDimensions() == 1 && scale->Shape().GetDims().size() == 1),
+              "scale must be a scalar");
+  ORT_ENFORCE(zeropoint->Shape().NumDimensions() == 0 ||
+                  (zeropoint->Shape().NumDimensions() == 1 && zeropoint->Shape().GetDims().size() == 1),
+              "zeropoint must be a scalar");
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+#include <algorithm>
+#include <cmath>
+
+namespace onnxruntime {
+namespace test {
+
+static std::vector<float> ComputeAttention(const std::vector<float>& X, const std::vector<float>& W,
+                                           const std::vector<float>& B, const std::vector<int32_t>& mask_index,
+                                           int64_t batch_size, int64_t sequence_length,
+                                           int64_t hidden_size, int64_t num_heads) {
+  const int64_t head_size = hidden_size / num_heads;
+  std::vector<double> qkv(batch_size * sequence_length * 3 * hidden_size);
+  for (int64_t r = 0; r < batch_size * sequence_length; r++) {
+    for (int64_t c = 0; c < 3 * hidden_size; c++) {
+      double sum = B[c];
+      for (int64_t k = 0; k < hidden_size; k++) {
+        sum += X[r * hidden_size + k] * W[k * 3 * hidden_size + c];
+      }
+      qkv[r * 3 * hidden_size + c] = sum;
+    }
+  }
+
+  std::vector<float> Y(batch_size * sequence_length * hidden_size, 0.0f);
+  for (int64_t b = 0; b < batch_size; b++) {
+    const int64_t length = mask_index.empty() ? sequence_length : mask_index[b];
+    for (int64_t h = 0; h < num_heads; h++) {
+      for (int64_t i = 0; i < sequence_length; i++) {
+        const double* q = &qkv[((b * sequence_length + i) * 3) * hidden_size + h * head_size];
+        std::vector<double> p(length);
+        double max_score = -INFINITY;
+        for (int64_t j = 0; j < length; j++) {
+          const double* k = &qkv[((b * sequence_length + j) * 3 + 1) * hidden_size + h * head_size];
+          double score = 0.0;
+          for (int64_t e = 0; e < head_size; e++) {
+            score += q[e] * k[e];
+          }
+          p[j] = score / std::sqrt(static_cast<double>(head_size));
+          max_score = std::max(max_score, p[j]);
+        }
+        double sum = 0.0;
+        for (auto& s : p) {
+          s = std::exp(s - max_score);
+          sum += s;
+        }
+        for (int64_t e = 0; e < head_size; e++) {
+          double value = 0.0;
+          for (int64_t j = 0; j < length; j++) {
+            value += p[j] / sum * qkv[((b * sequence_length + j) * 3 + 2) * hidden_size + h * head_size + e];
+          }
+          Y[(b * sequence_length + i) * hidden_size + h * head_size + e] = static_cast<float>(value);
+        }
+      }
+    }
+  }
+  return Y;
+}
+
+static void RunAttentionTest(int64_t batch_size, int64_t sequence_length, int64_t hidden_size, int64_t num_heads,
+                             const std::vector<int32_t>& mask_index) {
+  std::vector<float> X(batch_size * sequence_length * hidden_size);
+  std::vector<float> W(hidden_size * 3 * hidden_size);
+  std::vector<float> B(3 * hidden_size);
+  for (size_t i = 0; i < X.size(); i++) {
+    X[i] = std::sin(static_cast<float>(i) * 0.37f);
+  }
+  for (size_t i = 0; i < W.size(); i++) {
+    W[i] = std::cos(static_cast<float>(i) * 0.11f) * 0.5f;
+  }
+  for (size_t i = 0; i < B.size(); i++) {
+    B[i] = 0.01f * static_cast<float>(i % 13) - 0.05f;
+  }
+
+  OpTester test("Attention", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("num_heads", num_heads);
+  test.AddInput<float>("input", {batch_size, sequence_length, hidden_size}, X);
+  test.AddInput<float>("weight", {hidden_size, 3 * hidden_size}, W);
+  test.AddInput<float>("bias", {3 * hidden_size}, B);
+  if (!mask_index.empty()) {
+    test.AddInput<int32_t>("mask_index", {batch_size}, mask_index);
+  }
+  test.AddOutput<float>("output", {batch_size, sequence_length, hidden_size},
+                        ComputeAttention(X, W, B, mask_index, batch_size, sequence_length, hidden_size, num_heads));
+  test.Run();
+}
+
+TEST(ContribOpTest, Attention) {
+  RunAttentionTest(2, 3, 8, 2, {});
+}
+
+// Splits the query rows of each head into several blocks.
+TEST(ContribOpTest, Attention_LongSequence) {
+  RunAttentionTest(1, 300, 8, 4, {});
+}
+
+// Only the first mask_index[b] keys of each batch are attended.
+TEST(ContribOpTest, Attention_MaskIndex) {
+  RunAttentionTest(2, 5, 6, 3, {3, 5});
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+#include <cmath>
+
+namespace onnxruntime {
+namespace test {
+
+// Swish with a per-channel scale and a scalar bias: X * Sigmoid(X * scale + bias).
+TEST(ContribOpTest, FusedElementwise_Swish) {
+  std::vector<float> X(24);
+  for (size_t i = 0; i < X.size(); i++) {
+    X[i] = static_cast<float>(i) * 0.25f - 3.0f;
+  }
+  std::vector<float> scale{0.5f, -1.0f, 2.0f};
+  float bias = 1.0f;
+
+  std::vector<float> Y(X.size());
+  for (size_t i = 0; i < X.size(); i++) {
+    float t = X[i] * scale[(i / 4) % 3] + bias;
+    Y[i] = X[i] / (1.0f + std::exp(-t));
+  }
+
+  OpTester test("FusedElementwise", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("ops", std::vector<std::string>{"Mul", "Add", "Sigmoid", "Mul"});
+  test.AddAttribute("operands", std::vector<int64_t>{0, 1, 3, 2, 4, -1, 0, 5});
+  test.AddInput<float>("X", {2, 3, 4}, X);
+  test.AddInput<float>("scale", {3, 1}, scale);
+  test.AddInput<float>("bias", {1}, {bias});
+  test.AddOutput<float>("Y", {2, 3, 4}, Y);
+  test.Run();
+}
+
+// Broadcasts both inputs and spans several tiles of the output.
+TEST(ContribOpTest, FusedElementwise_BroadcastLeakyRelu) {
+  const int64_t rows = 5;
+  const int64_t columns = 700;
+  std::vector<float> A(rows);
+  std::vector<float> B(columns);
+  for (int64_t i = 0; i < rows; i++) {
+    A[i] = static_cast<float>(i) - 2.0f;
+  }
+  for (int64_t i = 0; i < columns; i++) {
+    B[i] = static_cast<float>(i % 7) - 3.0f;
+  }
+
+  std::vector<float> Y(rows * columns);
+  for (int64_t r = 0; r < rows; r++) {
+    for (int64_t c = 0; c < columns; c++) {
+      float t = A[r] - B[c];
+      Y[r * columns + c] = -(t >= 0.0f ? t : 0.1f * t);
+    }
+  }
+
+  OpTester test("FusedElementwise", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("ops", std::vector<std::string>{"Sub", "LeakyRelu", "Neg"});
+  test.AddAttribute("operands", std::vector<int64_t>{0, 1, 2, -1, 3, -1});
+  test.AddAttribute("alphas", std::vector<float>{0.0f, 0.1f, 0.0f});
+  test.AddInput<float>("A", {rows, 1}, A);
+  test.AddInput<float>("B", {columns}, B);
+  test.AddOutput<float>("Y", {rows, columns}, Y);
+  test.Run();
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+#include <cmath>
+
+namespace onnxruntime {
+namespace test {
+
+// Covers the saturated range of erf and spans several blocks of the kernel.
+TEST(ContribOpTest, Gelu) {
+  std::vector<float> X(10000);
+  for (size_t i = 0; i < X.size(); i++) {
+    X[i] = static_cast<float>(i) * 0.002f - 10.0f;
+  }
+
+  std::vector<float> Y(X.size());
+  for (size_t i = 0; i < X.size(); i++) {
+    Y[i] = static_cast<float>(0.5 * X[i] * (1.0 + std::erf(X[i] / std::sqrt(2.0))));
+  }
+
+  OpTester test("Gelu", 1, onnxruntime::kMSDomain);
+  test.AddInput<float>("X", {100, 100}, X);
+  test.AddOutput<float>("Y", {100, 100}, Y);
+  test.Run();
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+#include <cmath>
+
+namespace onnxruntime {
+namespace test {
+
+static std::vector<float> ComputeLayerNorm(const std::vector<float>& X, const std::vector<float>& scale,
+                                           const std::vector<float>& B, size_t norm_size, float epsilon) {
+  std::vector<float> Y(X.size());
+  for (size_t row = 0; row < X.size() / norm_size; row++) {
+    const float* x = X.data() + row * norm_size;
+    double mean = 0.0;
+    for (size_t i = 0; i < norm_size; i++) {
+      mean += x[i];
+    }
+    mean /= norm_size;
+    double variance = 0.0;
+    for (size_t i = 0; i < norm_size; i++) {
+      variance += (x[i] - mean) * (x[i] - mean);
+    }
+    variance /= norm_size;
+    for (size_t i = 0; i < norm_size; i++) {
+      Y[row * norm_size + i] = static_cast<float>((x[i] - mean) / std::sqrt(variance + epsilon) * scale[i] + B[i]);
+    }
+  }
+  return Y;
+}
+
+TEST(ContribOpTest, LayerNormalization_LastAxis) {
+  std::vector<float> X{1.0f, 2.0f, 3.0f, 4.0f,
+                       -1.0f, 0.5f, 8.0f, 2.0f,
+                       10.0f, 10.0f, 10.0f, 10.0f};
+  std::vector<float> scale{1.0f, 0.5f, 2.0f, -1.0f};
+  std::vector<float> B{0.0f, 1.0f, -0.5f, 0.25f};
+
+  OpTester test("LayerNormalization", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("epsilon", 1e-5f);
+  test.AddInput<float>("X", {3, 4}, X);
+  test.AddInput<float>("scale", {4}, scale);
+  test.AddInput<float>("B", {4}, B);
+  test.AddOutput<float>("Y", {3, 4}, ComputeLayerNorm(X, scale, B, 4, 1e-5f));
+  test.Run();
+}
+
+// Normalizes over the trailing two dimensions.
+TEST(ContribOpTest, LayerNormalization_MultipleAxes) {
+  std::vector<float> X(2 * 3 * 5);
+  for (size_t i = 0; i < X.size(); i++) {
+    X[i] = std::sin(static_cast<float>(i)) * 4.0f + static_cast<float>(i % 7);
+  }
+  std::vector<float> scale(3 * 5);
+  std::vector<float> B(3 * 5);
+  for (size_t i = 0; i < scale.size(); i++) {
+    scale[i] = 0.1f * static_cast<float>(i) - 0.5f;
+    B[i] = 0.05f * static_cast<float>(i);
+  }
+
+  OpTester test("LayerNormalization", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("axis", static_cast<int64_t>(1));
+  test.AddAttribute("epsilon", 1e-3f);
+  test.AddInput<float>("X", {2, 3, 5}, X);
+  test.AddInput<float>("scale", {3, 5}, scale);
+  test.AddInput<float>("B", {3, 5}, B);
+  test.AddOutput<float>("Y", {2, 3, 5}, ComputeLayerNorm(X, scale, B, 15, 1e-3f));
+  test.Run();
+}
+
+// The deviations are small relative to the mean, so computing the variance as
+// E[x^2] - E[x]^2 in float would lose them to cancellation.
+TEST(ContribOpTest, LayerNormalization_LargeMean) {
+  std::vector<float> X{4096.25f, 4095.5f, 4096.75f, 4095.5f,
+                       -8192.5f, -8191.5f, -8192.5f, -8191.5f};
+  std::vector<float> scale{1.0f, 1.0f, 1.0f, 1.0f};
+  std::vector<float> B{0.0f, 0.0f, 0.0f, 0.0f};
+
+  OpTester test("LayerNormalization", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("epsilon", 1e-5f);
+  test.AddInput<float>("X", {2, 4}, X);
+  test.AddInput<float>("scale", {4}, scale);
+  test.AddInput<float>("B", {4}, B);
+  test.AddOutput<float>("Y", {2, 4}, ComputeLayerNorm(X, scale, B, 4, 1e-5f));
+  test.Run();
+}
+
+}  // namespace test
+}  // namespace onnxruntime
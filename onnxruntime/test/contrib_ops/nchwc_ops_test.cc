@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+#include "core/mlas/inc/mlas.h"
+
+namespace onnxruntime {
+namespace test {
+
+TEST(ContribOpTest, NchwcReorderInputOutput) {
+  const int64_t block_size = static_cast<int64_t>(MlasNchwcGetBlockSize());
+  if (block_size == 1) {
+    return;
+  }
+
+  const int64_t N = 2, C = block_size * 2, H = 2, W = 3;
+  std::vector<float> nchw(N * C * H * W);
+  std::vector<float> nchwc(nchw.size());
+  for (size_t i = 0; i < nchw.size(); i++) {
+    nchw[i] = static_cast<float>(i);
+  }
+  for (int64_t n = 0; n < N; n++) {
+    for (int64_t c = 0; c < C; c++) {
+      for (int64_t hw = 0; hw < H * W; hw++) {
+        const int64_t cb = n * (C / block_size) + c / block_size;
+        nchwc[(cb * H * W + hw) * block_size + c % block_size] = nchw[(n * C + c) * H * W + hw];
+      }
+    }
+  }
+
+  OpTester reorder_input("ReorderInput", 1, onnxruntime::kMSDomain);
+  reorder_input.AddInput<float>("X", {N, C, H, W}, nchw);
+  reorder_input.AddOutput<float>("Y", {N, C, H, W}, nchwc);
+  reorder_input.Run();
+
+  OpTester reorder_output("ReorderOutput", 1, onnxruntime::kMSDomain);
+  reorder_output.AddInput<float>("X", {N, C, H, W}, nchwc);
+  reorder_output.AddOutput<float>("Y", {N, C, H, W}, nchw);
+  reorder_output.Run();
+}
+
+TEST(ContribOpTest, NchwcConvIdentityWithSumAndRelu) {
+  const int64_t block_size = static_cast<int64_t>(MlasNchwcGetBlockSize());
+  if (block_size == 1) {
+    return;
+  }
+
+  // A 1x1 identity filter has the same layout after reordering, so each
+  // output element is the matching input element plus the bias and sum.
+  const int64_t C = block_size, H = 3, W = 5;
+  std::vector<float> X(C * H * W);
+  std::vector<float> Sum(X.size());
+  std::vector<float> Y(X.size());
+  std::vector<float> filter(C * C, 0.0f);
+  std::vector<float> bias(C);
+  for (int64_t c = 0; c < C; c++) {
+    filter[c * C + c] = 1.0f;
+    bias[c] = static_cast<float>(c) - 4.0f;
+  }
+  for (size_t i = 0; i < X.size(); i++) {
+    X[i] = static_cast<float>(i % 7) - 3.0f;
+    Sum[i] = static_cast<float>(i % 3);
+    Y[i] = std::max(X[i] + bias[i % C] + Sum[i], 0.0f);
+  }
+
+  OpTester test("NchwcConv", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("activation", "Relu");
+  test.AddInput<float>("X", {1, C, H, W}, X);
+  test.AddInput<float>("W", {C, C, 1, 1}, filter);
+  test.AddInput<float>("B", {C}, bias);
+  test.AddInput<float>("Sum", {1, C, H, W}, Sum);
+  test.AddOutput<float>("Y", {1, C, H, W}, Y);
+  test.Run();
+}
+
+TEST(ContribOpTest, NchwcGlobalMaxPool) {
+  const int64_t block_size = static_cast<int64_t>(MlasNchwcGetBlockSize());
+  if (block_size == 1) {
+    return;
+  }
+
+  const int64_t C = block_size * 2, H = 2, W = 2;
+  std::vector<float> X(C * H * W);
+  std::vector<float> Y(C, std::numeric_limits<float>::lowest());
+  for (size_t i = 0; i < X.size(); i++) {
+    X[i] = static_cast<float>((i * 13) % 17);
+    const size_t c = (i / (H * W * block_size)) * block_size + i % block_size;
+    Y[c] = std::max(Y[c], X[i]);
+  }
+
+  OpTester test("NchwcGlobalMaxPool", 1, onnxruntime::kMSDomain);
+  test.AddInput<float>("X", {1, C, H, W}, X);
+  test.AddOutput<float>("Y", {1, C, 1, 1}, Y);
+  test.Run();
+}
+
+}  // namespace test
+}  // namespace onnxruntime
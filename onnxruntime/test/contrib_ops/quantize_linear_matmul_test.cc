@@ -58,5 +58,20 @@ TEST(QuantizeLinearMatmulOpTest, QLinearMatMul) {
   test.AddOutput<uint8_t>("T3", {2, 3}, {168, 115, 255, 1, 66, 151});
   test.Run();
 }
+
+// the real multiplier is about 1e-20, so requantizing shifts right by more than 31 bits
+TEST(QuantizeLinearMatmulOpTest, QLinearMatMulTinyScale) {
+  OpTester test("QLinearMatMul", 1, onnxruntime::kMSDomain);
+  test.AddInput<uint8_t>("T1", {2, 4}, {208, 236, 0, 238, 3, 214, 255, 29});
+  test.AddInput<float>("a_scale", {}, {1e-10f});
+  test.AddInput<uint8_t>("a_zero_point", {}, {113});
+  test.AddInput<uint8_t>("T2", {4, 3}, {152, 51, 244, 60, 26, 255, 0, 127, 246, 127, 254, 247});
+  test.AddInput<float>("b_scale", {}, {1e-10f});
+  test.AddInput<uint8_t>("b_zero_point", {}, {114});
+  test.AddInput<float>("y_scale", {}, {1.f});
+  test.AddInput<uint8_t>("y_zero_point", {}, {118});
+  test.AddOutput<uint8_t>("T3", {2, 3}, {118, 118, 118, 118, 118, 118});
+  test.Run();
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -3,7 +3,15 @@
 
 #include "core/framework/bfc_arena.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <cstdlib>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace onnxruntime {
 namespace test {
@@ -234,5 +242,333 @@ TEST(BFCArenaTest, TestReserve) {
   a.GetStats(&stats);
   EXPECT_EQ(stats.total_allocated_bytes, 1048576);
 }
+
+TEST(BFCArenaTest, ThreadCacheReuse) {
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, true);
+
+  void* first = a.Alloc(100);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(256u, a.AllocatedSize(first));
+  a.Free(first);
+
+  // the block freed to the thread cache is handed out again without going to the arena
+  void* second = a.Alloc(200);
+  EXPECT_EQ(first, second);
+  a.Free(second);
+
+  // allocations larger than the cached size classes still come from the bins
+  void* large = a.Alloc(1 << 20);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(size_t{1 << 20}, a.RequestedSize(large));
+  a.Free(large);
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(1, stats.num_thread_cache_misses);
+  EXPECT_EQ(1, stats.num_thread_cache_hits);
+  EXPECT_DOUBLE_EQ(0.5, stats.ThreadCacheHitRate());
+}
+
+TEST(BFCArenaTest, ThreadCacheConcurrentAllocations) {
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, true);
+
+  const int num_threads = 4;
+  const int num_iterations = 200;
+  std::vector<std::vector<void*>> freed_by_other_thread(num_threads);
+  std::vector<std::thread> threads;
+  // not vector<bool> as its elements share storage, so writes from different threads would race
+  std::vector<char> ok(num_threads, 1);
+
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      std::vector<std::pair<unsigned char*, size_t>> live;
+      for (int i = 0; i < num_iterations; ++i) {
+        const size_t size = 1 + (i * 97 + t * 31) % 20000;
+        auto* p = static_cast<unsigned char*>(a.Alloc(size));
+        memset(p, t + 1, size);
+        live.emplace_back(p, size);
+
+        // free every third allocation straight away so blocks cycle through the caches
+        if (i % 3 == 0) {
+          auto entry = live.front();
+          live.erase(live.begin());
+          for (size_t j = 0; j < entry.second; ++j) {
+            if (entry.first[j] != t + 1) ok[t] = 0;
+          }
+          a.Free(entry.first);
+        }
+      }
+
+      for (auto& entry : live) {
+        for (size_t j = 0; j < entry.second; ++j) {
+          if (entry.first[j] != t + 1) ok[t] = 0;
+        }
+        freed_by_other_thread[(t + 1) % num_threads].push_back(entry.first);
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < num_threads; ++t) {
+    EXPECT_TRUE(ok[t]) << "thread " << t << " saw its memory overwritten";
+  }
+
+  // free from threads other than the allocating ones
+  threads.clear();
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (void* p : freed_by_other_thread[t]) {
+        a.Free(p);
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_GT(stats.num_thread_cache_hits, 0);
+  EXPECT_EQ(0, stats.bytes_in_use);
+}
+
+TEST(BFCArenaTest, ThreadCacheStats) {
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, true);
+
+  std::vector<void*> blocks;
+  for (int i = 0; i < 10; ++i) {
+    blocks.push_back(a.Alloc(100));
+  }
+
+  // blocks handed out count as allocations and bytes in use. the rest of the slab doesn't.
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(10, stats.num_allocs);
+  EXPECT_EQ(10 * 256, stats.bytes_in_use);
+  EXPECT_EQ((1 << 20) - 10 * 256, stats.bytes_in_thread_caches);
+  EXPECT_EQ(1, stats.num_thread_caches);
+
+  for (void* p : blocks) {
+    a.Free(p);
+  }
+
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(1 << 20, stats.bytes_in_thread_caches);
+}
+
+TEST(BFCArenaTest, ThreadCacheReleasedOnThreadExit) {
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, true);
+
+  // a refill moves 16 blocks into the cache, so after this the thread's cache holds exactly these blocks
+  std::vector<void*> blocks;
+  std::thread thread([&a, &blocks]() {
+    for (int i = 0; i < 16; ++i) {
+      blocks.push_back(a.Alloc(100));
+    }
+
+    for (void* p : blocks) {
+      a.Free(p);
+    }
+  });
+  thread.join();
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.num_thread_caches);
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(1, stats.num_thread_cache_misses);
+  EXPECT_EQ(15, stats.num_thread_cache_hits);
+
+  // returning the thread's blocks left the whole slab free, so it was released
+  EXPECT_EQ(0, stats.bytes_in_thread_caches);
+  EXPECT_EQ(0, stats.total_allocated_bytes);
+  EXPECT_EQ(0, stats.num_regions);
+  EXPECT_EQ(1, stats.num_regions_released);
+
+  void* p = a.Alloc(100);
+  ASSERT_NE(p, nullptr);
+  a.Free(p);
+
+  a.GetStats(&stats);
+  EXPECT_EQ(1, stats.num_thread_caches);
+  EXPECT_EQ(1 << 20, stats.bytes_in_thread_caches);
+}
+
+TEST(BFCArenaTest, ThreadCacheSlabReleasedWhenFree) {
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, true);
+
+  // the 32KiB size class has 32 blocks per slab, so these are all the blocks of one slab
+  std::vector<void*> blocks;
+  for (int i = 0; i < 32; ++i) {
+    blocks.push_back(a.Alloc(32 << 10));
+  }
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(1, stats.num_regions);
+  EXPECT_EQ(1 << 20, stats.total_allocated_bytes);
+  EXPECT_EQ(0, stats.bytes_in_thread_caches);
+
+  // the blocks freed by another thread fill its cache, and return to the shared free list when it exits
+  std::thread thread([&a, &blocks]() {
+    for (void* p : blocks) {
+      a.Free(p);
+    }
+  });
+  thread.join();
+
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.num_regions);
+  EXPECT_EQ(1, stats.num_regions_released);
+  EXPECT_EQ(0, stats.total_allocated_bytes);
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(0, stats.bytes_in_thread_caches);
+}
+
+TEST(BFCArenaTest, ThreadCacheSlabsDontPinRegions) {
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, true);
+
+  void* large = a.Alloc(4 << 20);
+  void* small = a.Alloc(100);
+  ASSERT_NE(large, nullptr);
+  ASSERT_NE(small, nullptr);
+  a.Free(large);
+
+  // the slab the small block was carved from is not part of the region of the large allocation
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(2, stats.num_regions);
+  EXPECT_EQ(size_t{4 << 20}, a.Shrink());
+
+  a.GetStats(&stats);
+  EXPECT_EQ(1, stats.num_regions);
+  EXPECT_EQ(1 << 20, stats.total_allocated_bytes);
+  EXPECT_EQ(256, stats.bytes_in_use);
+  a.Free(small);
+}
+
+TEST(BFCArenaTest, ThreadCacheOutlivedByThread) {
+  // the thread keeps running after the arenas it used are destroyed, and uses new arenas afterwards
+  std::mutex mutex;
+  std::condition_variable cv;
+  int step = 0;
+  std::unique_ptr<BFCArena> arena;
+  auto run_step = [&](int expected_step, const std::function<void()>& fn) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return step == expected_step; });
+    fn();
+    ++step;
+    cv.notify_all();
+  };
+
+  const int num_arenas = 3;
+  std::thread thread([&]() {
+    for (int i = 0; i < num_arenas; ++i) {
+      run_step(3 * i + 1, [&]() {
+        void* p = arena->Alloc(100);
+        arena->Free(p);
+      });
+    }
+  });
+
+  for (int i = 0; i < num_arenas; ++i) {
+    run_step(3 * i, [&]() {
+      arena = std::make_unique<BFCArena>(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, true);
+    });
+    run_step(3 * i + 2, [&]() {
+      AllocatorStats stats;
+      arena->GetStats(&stats);
+      EXPECT_EQ(1, stats.num_thread_caches);
+      EXPECT_EQ(0, stats.bytes_in_use);
+      arena.reset();
+    });
+  }
+
+  thread.join();
+}
+
+TEST(BFCArenaTest, Shrink) {
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30);
+
+  void* small = a.Alloc(1024);
+  void* large = a.Alloc(8 << 20);
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_regions, 2);
+  const int64_t total_allocated_bytes = stats.total_allocated_bytes;
+
+  // the region holding 'small' is in use so only the large one can be released
+  a.Free(large);
+  size_t released = a.Shrink();
+  EXPECT_GE(released, size_t{8 << 20});
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_regions, 1);
+  EXPECT_EQ(stats.num_regions_released, 1);
+  EXPECT_EQ(stats.total_allocated_bytes, total_allocated_bytes - static_cast<int64_t>(released));
+
+  memset(small, 0, 1024);
+  a.Free(small);
+  EXPECT_GT(a.Shrink(), 0u);
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_regions, 0);
+  EXPECT_EQ(stats.total_allocated_bytes, 0);
+
+  // the arena grows again after being emptied
+  void* p = a.Alloc(4096);
+  EXPECT_NE(p, nullptr);
+  a.Free(p);
+  EXPECT_EQ(a.Shrink(), 1048576u);
+}
+
+TEST(BFCArenaTest, ShrinkAboveHighWatermark) {
+  ArenaShrinkOptions options;
+  options.high_watermark_bytes = 2 << 20;
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, false, options);
+
+  void* small = a.Alloc(1024);
+  void* large = a.Alloc(8 << 20);
+  a.Free(large);
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_regions, 1);
+  EXPECT_EQ(stats.num_regions_released, 1);
+
+  // below the watermark the remaining region is kept
+  a.Free(small);
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_regions, 1);
+  EXPECT_EQ(stats.num_regions_released, 1);
+}
+
+TEST(BFCArenaTest, ShrinkIdleRegions) {
+  ArenaShrinkOptions options;
+  options.max_idle_time = std::chrono::milliseconds(10);
+  BFCArena a(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30, false, options);
+
+  void* small = a.Alloc(1024);
+  void* large = a.Alloc(8 << 20);
+  a.Free(large);
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_regions, 2);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  // idle regions are released by the next Alloc that takes the lock, even without a Free
+  void* p = a.Alloc(16);
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_regions, 1);
+  EXPECT_EQ(stats.num_regions_released, 1);
+  a.Free(p);
+
+  a.Free(small);
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -5,8 +5,11 @@
 
 #include <algorithm>
 #include <cfloat>
+#include <cstdio>
 #include <functional>
+#include <future>
 #include <iterator>
+#include <sstream>
 #include <thread>
 #include <fstream>
 
@@ -14,10 +17,12 @@
 #include "core/platform/env.h"
 #include "core/common/logging/logging.h"
 #include "core/common/profiler.h"
+#include "core/framework/bfc_arena.h"
 #include "core/framework/execution_provider.h"
 #include "core/framework/kernel_registry.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
+#include "core/framework/shared_weights_store.h"
 #include "core/graph/graph_viewer.h"
 #include "core/framework/compute_capability.h"
 #include "core/graph/model.h"
@@ -26,7 +31,10 @@
 #include "core/providers/cpu/math/element_wise_ops.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/session/IOBinding.h"
+#include "core/session/batching_session.h"
+#include "core/session/optimized_model_cache.h"
 #include "test/capturing_sink.h"
+#include "test/temp_dir.h"
 #include "test/test_environment.h"
 #include "test/providers/provider_test_utils.h"
 #include "test_utils.h"
@@ -340,6 +348,500 @@ TEST(InferenceSessionTests, DisableCPUArena) {
   RunModel(session_object, run_options);
 }
 
+TEST(InferenceSessionTests, TrimArenas) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.TrimArenas";
+
+  // register the CPU provider so the test can look at its arena. no shrink options, so the arena keeps
+  // everything until it is trimmed.
+  auto cpu_provider = std::make_unique<CPUExecutionProvider>(CPUExecutionProviderInfo{});
+  auto allocator = cpu_provider->GetAllocator(0, OrtMemTypeDefault);
+  auto* arena = dynamic_cast<BFCArena*>(allocator.get());
+  ASSERT_NE(arena, nullptr);
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.RegisterExecutionProvider(std::move(cpu_provider)).IsOK());
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  run_options.run_tag = "InferenceSessionTests.TrimArenas";
+  RunModel(session_object, run_options);
+
+  // a large allocation gets a region of its own, which is entirely free once it is freed
+  const size_t large_size = 16 << 20;
+  allocator->Free(allocator->Alloc(large_size));
+
+  AllocatorStats before;
+  arena->GetStats(&before);
+
+  size_t bytes_released = 0;
+  ASSERT_TRUE(session_object.TrimArenas(&bytes_released).IsOK());
+
+  AllocatorStats after;
+  arena->GetStats(&after);
+  EXPECT_GE(bytes_released, large_size);
+  EXPECT_EQ(before.total_allocated_bytes - static_cast<int64_t>(bytes_released), after.total_allocated_bytes);
+  EXPECT_LT(after.num_regions, before.num_regions);
+  EXPECT_EQ(before.bytes_in_use, after.bytes_in_use);
+
+  // the arena grows again as needed
+  RunModel(session_object, run_options);
+}
+
+TEST(InferenceSessionTests, WorkStealingExecution) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.WorkStealingExecution";
+  so.enable_sequential_execution = false;
+  so.enable_work_stealing_execution = true;
+  so.session_thread_pool_size = 2;
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  run_options.run_tag = "one session/one tag";
+  RunModel(session_object, run_options);
+
+  // second run uses the memory pattern generated by the first one
+  RunModel(session_object, run_options);
+}
+
+TEST(InferenceSessionTests, WorkStealingExecutionConcurrentRuns) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.WorkStealingExecutionConcurrentRuns";
+  so.enable_sequential_execution = false;
+  so.enable_work_stealing_execution = true;
+  so.session_thread_pool_size = 2;
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  std::vector<int64_t> dims_mul_x = {3, 2};
+  std::vector<float> values_mul_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  std::vector<float> expected_values_mul_y = {1.0f, 4.0f, 9.0f, 16.0f, 25.0f, 36.0f};
+
+  // more concurrent runs than pool threads so the runs compete for the helpers
+  constexpr int num_threads = 8;
+  constexpr int num_runs_per_thread = 20;
+  std::vector<Status> statuses(num_threads * num_runs_per_thread);
+  std::vector<std::vector<MLValue>> outputs(num_threads * num_runs_per_thread);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < num_runs_per_thread; ++i) {
+        MLValue ml_value;
+        CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_mul_x,
+                             values_mul_x, &ml_value);
+        NameMLValMap feeds{{"X", ml_value}};
+
+        const int run = t * num_runs_per_thread + i;
+        statuses[run] = session_object.Run(RunOptions{}, feeds, {"Y"}, &outputs[run]);
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t run = 0; run < statuses.size(); ++run) {
+    ASSERT_TRUE(statuses[run].IsOK()) << "run " << run << ": " << statuses[run].ErrorMessage();
+    VerifyOutputs(outputs[run], dims_mul_x, expected_values_mul_y);
+  }
+}
+
+// creates a model with four independent branches of two nodes each that are joined by a tree of Add nodes,
+// so the work stealing executor has nodes that can run on helper threads at the same time.
+static ONNX_NAMESPACE::ModelProto CreateBranchingModel() {
+  Model model("BranchingModel");
+  auto& graph = model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+
+  auto add_node = [&graph, &float_tensor](const std::string& op_type, const std::vector<NodeArg*>& inputs,
+                                          const std::string& output_name) -> NodeArg* {
+    auto* output = &graph.GetOrCreateNodeArg(output_name, &float_tensor);
+    graph.AddNode(output_name, op_type, op_type + " node", inputs, {output});
+    return output;
+  };
+
+  NodeArg* branch_0 = add_node("Abs", {add_node("Mul", {&x, &x}, "mul_0")}, "branch_0");
+  NodeArg* branch_1 = add_node("Neg", {add_node("Add", {&x, &x}, "add_1")}, "branch_1");
+  NodeArg* branch_2 = add_node("Mul", {add_node("Sub", {&x, &x}, "sub_2"), &x}, "branch_2");
+  NodeArg* branch_3 = add_node("Add", {add_node("Abs", {&x}, "abs_3"), &x}, "branch_3");
+
+  NodeArg* join_0 = add_node("Add", {branch_0, branch_1}, "join_0");
+  NodeArg* join_1 = add_node("Mul", {branch_2, branch_3}, "join_1");
+  graph.AddNode("join", "Add", "Add node", {join_0, join_1}, {&y});
+
+  auto status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  return model.ToProto();
+}
+
+static void RunBranchingModel(InferenceSession& session_object, const std::vector<float>& values_x,
+                              std::vector<float>& values_y) {
+  MLValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {3, 2}, values_x, &ml_value);
+  NameMLValMap feeds{{"X", ml_value}};
+
+  std::vector<MLValue> fetches;
+  auto status = session_object.Run(RunOptions{}, feeds, {"Y"}, &fetches);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  const auto& y = fetches.front().Get<Tensor>();
+  values_y.assign(y.Data<float>(), y.Data<float>() + y.Shape().Size());
+}
+
+// the work stealing executor must produce the same results as the sequential executor for a graph where the
+// helper threads take branches, steal nodes from each other and release the join node, for repeated and
+// concurrent runs.
+TEST(InferenceSessionTests, WorkStealingExecutionBranches) {
+  std::stringstream model_stream;
+  CreateBranchingModel().SerializeToOstream(&model_stream);
+  const std::string model_data = model_stream.str();
+
+  auto create_session = [&model_data](bool work_stealing) {
+    SessionOptions so;
+    so.session_logid = "InferenceSessionTests.WorkStealingExecutionBranches";
+    so.enable_sequential_execution = !work_stealing;
+    so.enable_work_stealing_execution = work_stealing;
+    so.session_thread_pool_size = 4;
+
+    auto session_object = std::make_unique<InferenceSession>(so, &DefaultLoggingManager());
+    std::istringstream session_model_stream(model_data);
+    EXPECT_TRUE(session_object->Load(session_model_stream).IsOK());
+    auto status = session_object->Initialize();
+    EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+    return session_object;
+  };
+
+  auto sequential_session = create_session(false);
+  auto work_stealing_session = create_session(true);
+
+  constexpr int num_inputs = 4;
+  std::vector<std::vector<float>> inputs(num_inputs);
+  std::vector<std::vector<float>> expected_outputs(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    for (int j = 0; j < 6; ++j) {
+      inputs[i].push_back(static_cast<float>((i * 6 + j) % 7) - 3.f);
+    }
+    RunBranchingModel(*sequential_session, inputs[i], expected_outputs[i]);
+  }
+
+  // repeated runs
+  for (int run = 0; run < 20; ++run) {
+    std::vector<float> values_y;
+    RunBranchingModel(*work_stealing_session, inputs[run % num_inputs], values_y);
+    ASSERT_EQ(expected_outputs[run % num_inputs], values_y) << "run " << run;
+  }
+
+  // concurrent runs, more than the pool has threads, so the runs compete for the helpers
+  constexpr int num_threads = 8;
+  constexpr int num_runs_per_thread = 20;
+  std::vector<std::vector<float>> outputs(num_threads * num_runs_per_thread);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < num_runs_per_thread; ++i) {
+        const int run = t * num_runs_per_thread + i;
+        RunBranchingModel(*work_stealing_session, inputs[run % num_inputs], outputs[run]);
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t run = 0; run < outputs.size(); ++run) {
+    ASSERT_EQ(expected_outputs[run % num_inputs], outputs[run]) << "run " << run;
+  }
+}
+
+TEST(InferenceSessionTests, OptimizedModelCache) {
+  TemporaryDirectory temp_dir;
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.OptimizedModelCache";
+  so.optimized_model_cache_dir = temp_dir.Directory();
+
+  std::string key;
+  ASSERT_TRUE(OptimizedModelCache::ComputeKey(MODEL_URI, {kCpuExecutionProvider}, {},
+                                              so.max_num_graph_transformation_steps, key)
+                  .IsOK());
+  OptimizedModelCache cache{so.optimized_model_cache_dir, key};
+  ASSERT_EQ(cache.Path(), temp_dir.Path(key + ".onnx"));
+
+  RunOptions run_options;
+  run_options.run_tag = "OptimizedModelCache";
+
+  // first session creates the cache entry
+  {
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+    RunModel(session_object, run_options);
+  }
+
+  ASSERT_TRUE(cache.Exists());
+
+  std::shared_ptr<Model> cached_model;
+  ASSERT_TRUE(cache.Load(cached_model, nullptr).IsOK());
+  for (const auto& node : cached_model->MainGraph().Nodes()) {
+    EXPECT_EQ(kCpuExecutionProvider, node.GetExecutionProviderType());
+  }
+
+  // second session initializes from the cache entry
+  {
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+    RunModel(session_object, run_options);
+  }
+}
+
+static void CheckSubgraphProviders(Graph& graph, int& num_subgraph_nodes) {
+  for (auto& node : graph.Nodes()) {
+    for (auto& entry : node.GetAttributeNameToMutableSubgraphMap()) {
+      for (const auto& subgraph_node : entry.second->Nodes()) {
+        EXPECT_EQ(kCpuExecutionProvider, subgraph_node.GetExecutionProviderType()) << subgraph_node.Name();
+        ++num_subgraph_nodes;
+      }
+
+      CheckSubgraphProviders(*entry.second, num_subgraph_nodes);
+    }
+  }
+}
+
+TEST(InferenceSessionTests, OptimizedModelCacheSubgraphs) {
+  TemporaryDirectory temp_dir;
+  const std::string model_uri = "testdata/scan_1.pb";
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.OptimizedModelCacheSubgraphs";
+  so.optimized_model_cache_dir = temp_dir.Directory();
+
+  std::string key;
+  ASSERT_TRUE(OptimizedModelCache::ComputeKey(model_uri, {kCpuExecutionProvider}, {},
+                                              so.max_num_graph_transformation_steps, key)
+                  .IsOK());
+  OptimizedModelCache cache{so.optimized_model_cache_dir, key};
+  ASSERT_EQ(cache.Path(), temp_dir.Path(key + ".onnx"));
+
+  {
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(model_uri).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+  }
+
+  ASSERT_TRUE(cache.Exists());
+
+  // the provider assignments of the Scan body are restored when the entry is loaded
+  std::shared_ptr<Model> cached_model;
+  ASSERT_TRUE(cache.Load(cached_model, nullptr).IsOK());
+  int num_subgraph_nodes = 0;
+  CheckSubgraphProviders(cached_model->MainGraph(), num_subgraph_nodes);
+  EXPECT_GT(num_subgraph_nodes, 0);
+
+  {
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(model_uri).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+  }
+}
+
+TEST(InferenceSessionTests, BatchingSessionConcurrentRuns) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.BatchingSessionConcurrentRuns";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  // each request has 3 rows so every batch is full with 2 requests. the long delay means a batch is only
+  // dispatched once it is full, which makes the batch composition deterministic.
+  BatchingOptions batching_options;
+  batching_options.max_batch_size = 6;
+  batching_options.max_delay = std::chrono::seconds(10);
+  batching_options.num_batch_threads = 2;
+
+  const int num_requests = 4;
+  std::vector<int64_t> dims_mul_x = {3, 2};
+  std::vector<Status> statuses(num_requests);
+  std::vector<std::vector<MLValue>> fetches(num_requests);
+  std::vector<BatchingRunInfo> run_infos(num_requests);
+  std::vector<std::vector<float>> expected_values(num_requests);
+
+  BatchingStats stats;
+  {
+    BatchingSession batching_session{session_object, batching_options};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_requests; ++i) {
+      // each request uses different values so a mixed up split would be detected
+      std::vector<float> values_mul_x(6);
+      expected_values[i].resize(6);
+      for (int j = 0; j < 6; ++j) {
+        values_mul_x[j] = static_cast<float>(i * 6 + j);
+        expected_values[i][j] = values_mul_x[j] * values_mul_x[j];
+      }
+
+      MLValue ml_value;
+      CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_mul_x,
+                           values_mul_x, &ml_value);
+
+      threads.emplace_back([&, i, ml_value]() {
+        NameMLValMap feeds{{"X", ml_value}};
+        statuses[i] = batching_session.Run(feeds, {"Y"}, &fetches[i], &run_infos[i]);
+      });
+    }
+
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    stats = batching_session.GetStats();
+  }
+
+  for (int i = 0; i < num_requests; ++i) {
+    ASSERT_TRUE(statuses[i].IsOK()) << statuses[i].ErrorMessage();
+    EXPECT_EQ(6, run_infos[i].batch_size);
+    EXPECT_EQ(2u, run_infos[i].num_requests_in_batch);
+    VerifyOutputs(fetches[i], dims_mul_x, expected_values[i]);
+  }
+
+  EXPECT_EQ(num_requests, stats.num_requests);
+  EXPECT_EQ(num_requests / 2, stats.num_batches);
+  EXPECT_EQ(num_requests * 3, stats.num_rows);
+  EXPECT_DOUBLE_EQ(1.0, stats.AverageBatchFill(batching_options.max_batch_size));
+}
+
+TEST(InferenceSessionTests, BatchingSessionFailedBatch) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.BatchingSessionFailedBatch";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  BatchingOptions batching_options;
+  batching_options.max_batch_size = 6;
+  batching_options.max_delay = std::chrono::seconds(10);
+
+  // the requests are compatible with each other but the feed name isn't a model input, so the batch fails
+  const int num_requests = 2;
+  std::vector<int64_t> dims_mul_x = {3, 2};
+  std::vector<float> values_mul_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  std::vector<Status> statuses(num_requests);
+  std::vector<std::vector<MLValue>> fetches(num_requests);
+
+  BatchingStats stats;
+  {
+    BatchingSession batching_session{session_object, batching_options};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_requests; ++i) {
+      MLValue ml_value;
+      CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_mul_x,
+                           values_mul_x, &ml_value);
+
+      threads.emplace_back([&, i, ml_value]() {
+        NameMLValMap feeds{{"NotAnInput", ml_value}};
+        statuses[i] = batching_session.Run(feeds, {"Y"}, &fetches[i]);
+      });
+    }
+
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    stats = batching_session.GetStats();
+  }
+
+  for (int i = 0; i < num_requests; ++i) {
+    ASSERT_FALSE(statuses[i].IsOK());
+    EXPECT_EQ(statuses[0].ErrorMessage(), statuses[i].ErrorMessage());
+    EXPECT_TRUE(fetches[i].empty());
+  }
+
+  // the failed batch is not re-run one request at a time
+  EXPECT_EQ(num_requests, stats.num_requests);
+  EXPECT_EQ(1, stats.num_batches);
+}
+
+TEST(InferenceSessionTests, RunAsync) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.RunAsync";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  const int num_requests = 4;
+  std::vector<std::promise<std::vector<MLValue>>> results(num_requests);
+  std::vector<std::vector<float>> expected_values(num_requests);
+  std::vector<int64_t> dims_mul_x = {3, 2};
+
+  for (int i = 0; i < num_requests; ++i) {
+    // each request uses different values so mixed up outputs would be detected
+    std::vector<float> values_mul_x(6);
+    expected_values[i].resize(6);
+    for (int j = 0; j < 6; ++j) {
+      values_mul_x[j] = static_cast<float>(i * 6 + j);
+      expected_values[i][j] = values_mul_x[j] * values_mul_x[j];
+    }
+
+    MLValue ml_value;
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_mul_x, values_mul_x,
+                         &ml_value);
+    NameMLValMap feeds;
+    feeds.insert(std::make_pair("X", ml_value));
+
+    auto& result = results[i];
+    auto st = session_object.RunAsync(feeds, {"Y"}, [&result](const Status& status, std::vector<MLValue>& fetches) {
+      if (status.IsOK()) {
+        result.set_value(fetches);
+      } else {
+        result.set_exception(std::make_exception_ptr(std::runtime_error(status.ErrorMessage())));
+      }
+    });
+    ASSERT_TRUE(st.IsOK()) << st.ErrorMessage();
+  }
+
+  for (int i = 0; i < num_requests; ++i) {
+    auto fetches = results[i].get_future().get();
+    VerifyOutputs(fetches, dims_mul_x, expected_values[i]);
+  }
+
+  // no callback is made if the run can't be queued
+  InferenceSession uninitialized_session{so, &DefaultLoggingManager()};
+  bool called = false;
+  auto st = uninitialized_session.RunAsync({}, {"Y"}, [&called](const Status&, std::vector<MLValue>&) {
+    called = true;
+  });
+  ASSERT_FALSE(st.IsOK());
+  ASSERT_FALSE(called);
+}
+
 #ifdef ORT_RUN_EXTERNAL_ONNX_TESTS
 static bool Compare(const InputDefList& f_arg, const InputDefList& s_arg) {
   if (f_arg.size() != s_arg.size()) {
@@ -818,6 +1320,68 @@ TEST(InferenceSessionTests, TestBindCudaPreallocateOutputOnCpu2) {
 
 #endif
 
+TEST(InferenceSessionTests, ExternalDataInitializer) {
+  TemporaryDirectory temp_dir;
+  const std::string model_file_name = temp_dir.Path("external_data.onnx");
+  const std::string data_file_name = temp_dir.Path("external_data.bin");
+
+  // the weights start after some padding so a non-zero offset is used
+  const size_t offset = 16;
+  std::vector<float> weights = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  {
+    std::ofstream out(data_file_name, std::ios::binary);
+    std::vector<char> padding(offset, 0);
+    out.write(padding.data(), padding.size());
+    out.write(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(float));
+  }
+
+  {
+    onnxruntime::Model model("ExternalDataInitializer");
+    auto& graph = model.MainGraph();
+
+    // the location is relative to the directory of the model file
+    TensorProto tensor_proto;
+    tensor_proto.set_name("W");
+    tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+    tensor_proto.add_dims(3);
+    tensor_proto.add_dims(2);
+    tensor_proto.set_data_location(TensorProto_DataLocation_EXTERNAL);
+    auto* location = tensor_proto.add_external_data();
+    location->set_key("location");
+    location->set_value("external_data.bin");
+    auto* offset_entry = tensor_proto.add_external_data();
+    offset_entry->set_key("offset");
+    offset_entry->set_value(std::to_string(offset));
+    graph.AddInitializedTensor(tensor_proto);
+
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+    auto& input_arg = graph.GetOrCreateNodeArg("X", &float_tensor);
+    auto& weights_arg = graph.GetOrCreateNodeArg("W", &float_tensor);
+    auto& output_arg = graph.GetOrCreateNodeArg("Y", &float_tensor);
+    graph.AddNode("mul", "Mul", "multiply by the external weights", {&input_arg, &weights_arg}, {&output_arg});
+
+    ASSERT_TRUE(graph.Resolve().IsOK());
+    ASSERT_TRUE(onnxruntime::Model::Save(model, model_file_name).IsOK());
+  }
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.ExternalDataInitializer";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  auto status = session_object.Load(model_file_name);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  status = session_object.Initialize();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  RunOptions run_options;
+  run_options.run_tag = so.session_logid;
+  RunModel(session_object, run_options);
+}
+
 TEST(InferenceSessionTests, ModelWithoutOpset) {
   SessionOptions so;
 
@@ -955,6 +1519,183 @@ TEST(InferenceSessionTests, TestOptionalInputs) {
   EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("Missing required inputs: required_input"));
 }
 
+// creates a model multiplying X [2,3] by the weights W [3,2] with MatMul or Gemm.
+// if weights_are_graph_inputs is false, only X is listed in the graph inputs so the initializers are constant.
+static ONNX_NAMESPACE::ModelProto CreatePrePackModel(const std::string& op_type, bool weights_are_graph_inputs) {
+  Model model("PrePackModel");
+  auto& graph = model.MainGraph();
+
+  TensorProto weights;
+  weights.set_name("W");
+  weights.set_data_type(TensorProto_DataType_FLOAT);
+  weights.add_dims(3);
+  weights.add_dims(2);
+  for (int i = 1; i <= 6; ++i) {
+    weights.add_float_data(static_cast<float>(i));
+  }
+  graph.AddInitializedTensor(weights);
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+
+  std::vector<NodeArg*> inputs{&graph.GetOrCreateNodeArg("X", &float_tensor),
+                               &graph.GetOrCreateNodeArg("W", nullptr)};
+
+  if (op_type == "Gemm") {
+    TensorProto bias;
+    bias.set_name("C");
+    bias.set_data_type(TensorProto_DataType_FLOAT);
+    bias.add_dims(2);
+    bias.add_float_data(0.f);
+    bias.add_float_data(0.f);
+    graph.AddInitializedTensor(bias);
+    inputs.push_back(&graph.GetOrCreateNodeArg("C", nullptr));
+  }
+
+  auto& output_arg = graph.GetOrCreateNodeArg("Y", nullptr);
+  graph.AddNode("node", op_type, "multiply by the weights", inputs, {&output_arg});
+
+  auto status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  auto model_proto = model.ToProto();
+  if (!weights_are_graph_inputs) {
+    auto* graph_inputs = model_proto.mutable_graph()->mutable_input();
+    for (int i = graph_inputs->size() - 1; i >= 0; --i) {
+      if (graph_inputs->Get(i).name() != "X") {
+        graph_inputs->DeleteSubrange(i, 1);
+      }
+    }
+  }
+
+  return model_proto;
+}
+
+static common::Status RunPrePackModel(InferenceSession& session_object,
+                                      const std::vector<float>* weights,
+                                      const std::vector<float>& expected_values) {
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+
+  NameMLValMap feeds;
+  MLValue x_mlvalue;
+  CreateMLValue<float>(allocator, {2, 3}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f}, &x_mlvalue);
+  feeds.insert(std::make_pair("X", x_mlvalue));
+
+  if (weights != nullptr) {
+    MLValue w_mlvalue;
+    CreateMLValue<float>(allocator, {3, 2}, *weights, &w_mlvalue);
+    feeds.insert(std::make_pair("W", w_mlvalue));
+  }
+
+  RunOptions run_options;
+  run_options.run_tag = "InferenceSessionTests.PrePackedWeightsOverride";
+  std::vector<std::string> output_names{"Y"};
+  std::vector<MLValue> fetches;
+  ORT_RETURN_IF_ERROR(session_object.Run(run_options, feeds, output_names, &fetches));
+
+  const auto& y = fetches.front().Get<Tensor>();
+  std::vector<float> y_values(y.Data<float>(), y.Data<float>() + y.Shape().Size());
+  if (y_values != expected_values) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Unexpected output values");
+  }
+
+  return Status::OK();
+}
+
+TEST(InferenceSessionTests, PrePackedWeightsOverride) {
+  const std::vector<float> override_weights = {1.f, 0.f, 0.f, 1.f, 0.f, 0.f};
+
+  for (const std::string op_type : {"MatMul", "Gemm"}) {
+    for (bool weights_are_graph_inputs : {true, false}) {
+      SessionOptions so;
+      so.session_logid = "InferenceSessionTests.PrePackedWeightsOverride";
+
+      InferenceSession session_object{so, &DefaultLoggingManager()};
+      std::stringstream model_stream;
+      CreatePrePackModel(op_type, weights_are_graph_inputs).SerializeToOstream(&model_stream);
+      ASSERT_TRUE(session_object.Load(model_stream).IsOK());
+      ASSERT_TRUE(session_object.Initialize().IsOK());
+
+      // the initializer values are used if W is not fed
+      auto status = RunPrePackModel(session_object, nullptr, {22.f, 28.f, 49.f, 64.f});
+      ASSERT_TRUE(status.IsOK()) << op_type << ": " << status.ErrorMessage();
+
+      status = RunPrePackModel(session_object, &override_weights, {1.f, 2.f, 4.f, 5.f});
+      if (weights_are_graph_inputs) {
+        // the fed values must be used, so the weights can't have been packed by the kernel
+        ASSERT_TRUE(status.IsOK()) << op_type << ": " << status.ErrorMessage();
+      } else {
+        // constant weights can't be overridden
+        ASSERT_FALSE(status.IsOK());
+        EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("Invalid Feed Input Names: W"));
+      }
+
+      // the initializer values are used again after a run that fed W
+      status = RunPrePackModel(session_object, nullptr, {22.f, 28.f, 49.f, 64.f});
+      ASSERT_TRUE(status.IsOK()) << op_type << ": " << status.ErrorMessage();
+    }
+  }
+}
+
+// exposes the session state so the test can check which buffer an initializer uses
+class InferenceSessionGetSessionState : public InferenceSession {
+ public:
+  using InferenceSession::InferenceSession;
+  using InferenceSession::GetSessionState;
+};
+
+TEST(InferenceSessionTests, SharedWeightsStore) {
+  auto shared_weights_store = std::make_shared<SharedWeightsStore>();
+
+  std::stringstream model_stream;
+  CreatePrePackModel("MatMul", false).SerializeToOstream(&model_stream);
+  const std::string model_data = model_stream.str();
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.SharedWeightsStore";
+  so.shared_weights_store = shared_weights_store;
+
+  std::vector<std::unique_ptr<InferenceSessionGetSessionState>> sessions;
+  std::vector<const void*> weights_data;
+  for (int i = 0; i < 2; ++i) {
+    auto session_object = std::make_unique<InferenceSessionGetSessionState>(so, &DefaultLoggingManager());
+    std::istringstream session_model_stream(model_data);
+    ASSERT_TRUE(session_object->Load(session_model_stream).IsOK());
+    auto status = session_object->Initialize();
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+    const auto& session_state = session_object->GetSessionState();
+    int weights_idx;
+    ASSERT_TRUE(session_state.GetMLValueNameIdxMap().GetIdx("W", weights_idx).IsOK());
+    const auto& initializers = session_state.GetInitializedTensors();
+    auto weights = initializers.find(weights_idx);
+    ASSERT_NE(weights, initializers.end());
+    weights_data.push_back(weights->second.Get<Tensor>().DataRaw());
+
+    sessions.push_back(std::move(session_object));
+  }
+
+  // both sessions use one copy of the weights
+  EXPECT_EQ(weights_data[0], weights_data[1]);
+  EXPECT_EQ(1u, shared_weights_store->NumEntries());
+#if defined(USE_MLAS) && !defined(USE_MKLDNN)
+  // and one copy of the weights MatMul packs
+  EXPECT_EQ(1u, shared_weights_store->NumPackedEntries());
+#endif
+
+  for (auto& session_object : sessions) {
+    auto status = RunPrePackModel(*session_object, nullptr, {22.f, 28.f, 49.f, 64.f});
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  }
+
+  // the shared buffers are released with the last session using them
+  sessions.clear();
+  EXPECT_EQ(0u, shared_weights_store->NumEntries());
+  EXPECT_EQ(0u, shared_weights_store->NumPackedEntries());
+}
+
 TEST(ExecutionProviderTest, FunctionTest) {
   onnxruntime::Model model("graph_1");
   auto& graph = model.MainGraph();
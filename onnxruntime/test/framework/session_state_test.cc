@@ -65,5 +65,103 @@ TEST(SessionStateTest, AddGetKernelTest) {
   std::cout << "orig: " << orig_num_outputs << " new: " << test_kernel->Node().OutputDefs().size() << std::endl;
   EXPECT_EQ(orig_num_outputs, test_kernel->Node().OutputDefs().size());
 }
+
+TEST(SessionStateTest, MemoryPatternCacheLRU) {
+  ExecutionProviders execution_providers;
+  SessionState s{execution_providers};
+  s.SetMemoryPatternCacheSize(2);
+
+  std::vector<TensorShape> shape_a{TensorShape({1, 2})};
+  std::vector<TensorShape> shape_b{TensorShape({2, 1})};
+  std::vector<TensorShape> shape_c{TensorShape({3, 4})};
+
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shape_a, std::make_unique<MemoryPatternGroup>()).IsOK());
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shape_b, std::make_unique<MemoryPatternGroup>()).IsOK());
+  EXPECT_EQ(2u, s.GetNumMemoryPatterns());
+
+  // shapes with the same dims in a different order must not share a pattern
+  auto pattern_a = s.GetMemoryPatternGroup(shape_a);
+  auto pattern_b = s.GetMemoryPatternGroup(shape_b);
+  ASSERT_NE(nullptr, pattern_a);
+  ASSERT_NE(nullptr, pattern_b);
+  EXPECT_NE(pattern_a, pattern_b);
+
+  // b is the most recently used so a is evicted
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shape_c, std::make_unique<MemoryPatternGroup>()).IsOK());
+  EXPECT_EQ(2u, s.GetNumMemoryPatterns());
+  EXPECT_EQ(nullptr, s.GetMemoryPatternGroup(shape_a));
+  EXPECT_NE(nullptr, s.GetMemoryPatternGroup(shape_b));
+  EXPECT_NE(nullptr, s.GetMemoryPatternGroup(shape_c));
+
+  // an evicted pattern stays valid while it is in use
+  EXPECT_TRUE(pattern_a->locations.empty());
+}
+
+TEST(SessionStateTest, MemoryPatternDimBuckets) {
+  ExecutionProviders execution_providers;
+  SessionState s{execution_providers};
+  s.SetMemoryPatternDimBuckets({1, 16, 32, 64});
+
+  std::vector<TensorShape> shape_17{TensorShape({1, 17})};
+  std::vector<TensorShape> shape_30{TensorShape({1, 30})};
+  std::vector<TensorShape> shape_33{TensorShape({1, 33})};
+  std::vector<TensorShape> shape_100{TensorShape({1, 100})};
+
+  EXPECT_EQ(TensorShape({1, 32}), s.GetBucketedShapes(shape_17)[0]);
+  EXPECT_EQ(TensorShape({1, 100}), s.GetBucketedShapes(shape_100)[0]);
+
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shape_17, std::make_unique<MemoryPatternGroup>()).IsOK());
+  auto pattern_17 = s.GetMemoryPatternGroup(shape_17);
+  EXPECT_NE(nullptr, pattern_17);
+  EXPECT_EQ(nullptr, s.GetMemoryPatternGroup(shape_33));
+
+  // the pattern generated for 17 is too small for 30, so the caller traces a new one which replaces it
+  EXPECT_EQ(nullptr, s.GetMemoryPatternGroup(shape_30));
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shape_30, std::make_unique<MemoryPatternGroup>()).IsOK());
+  auto pattern_30 = s.GetMemoryPatternGroup(shape_30);
+  EXPECT_NE(nullptr, pattern_30);
+  EXPECT_NE(pattern_17, pattern_30);
+  EXPECT_EQ(pattern_30, s.GetMemoryPatternGroup(shape_17));
+  EXPECT_EQ(1u, s.GetNumMemoryPatterns());
+
+  // a pattern for a smaller shape doesn't replace the one for the larger shape
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shape_17, std::make_unique<MemoryPatternGroup>()).IsOK());
+  EXPECT_EQ(pattern_30, s.GetMemoryPatternGroup(shape_17));
+  EXPECT_EQ(1u, s.GetNumMemoryPatterns());
+}
+
+TEST(SessionStateTest, MemoryPatternDimBucketsNonComparableShapes) {
+  ExecutionProviders execution_providers;
+  SessionState s{execution_providers};
+  s.SetMemoryPatternDimBuckets({1, 8});
+
+  // all in the same bucket, and neither of [2,5] and [3,4] covers the other
+  std::vector<TensorShape> shape_2_5{TensorShape({2, 5})};
+  std::vector<TensorShape> shape_3_4{TensorShape({3, 4})};
+  std::vector<TensorShape> shape_2_4{TensorShape({2, 4})};
+  std::vector<TensorShape> shape_3_5{TensorShape({3, 5})};
+
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shape_2_5, std::make_unique<MemoryPatternGroup>()).IsOK());
+  EXPECT_EQ(nullptr, s.GetMemoryPatternGroup(shape_3_4));
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shape_3_4, std::make_unique<MemoryPatternGroup>()).IsOK());
+  EXPECT_EQ(2u, s.GetNumMemoryPatterns());
+
+  // both stay cached instead of replacing each other
+  auto pattern_2_5 = s.GetMemoryPatternGroup(shape_2_5);
+  auto pattern_3_4 = s.GetMemoryPatternGroup(shape_3_4);
+  ASSERT_NE(nullptr, pattern_2_5);
+  ASSERT_NE(nullptr, pattern_3_4);
+  EXPECT_NE(pattern_2_5, pattern_3_4);
+  EXPECT_NE(nullptr, s.GetMemoryPatternGroup(shape_2_4));
+
+  // a pattern for shapes covering both replaces them
+  EXPECT_EQ(nullptr, s.GetMemoryPatternGroup(shape_3_5));
+  ASSERT_TRUE(s.UpdateMemoryPatternGroupCache(shape_3_5, std::make_unique<MemoryPatternGroup>()).IsOK());
+  EXPECT_EQ(1u, s.GetNumMemoryPatterns());
+  auto pattern_3_5 = s.GetMemoryPatternGroup(shape_3_5);
+  ASSERT_NE(nullptr, pattern_3_5);
+  EXPECT_EQ(pattern_3_5, s.GetMemoryPatternGroup(shape_2_5));
+  EXPECT_EQ(pattern_3_5, s.GetMemoryPatternGroup(shape_3_4));
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -0,0 +1,190 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/shared_weights_store.h"
+
+#include <algorithm>
+#include <string>
+
+#include "core/framework/tensor.h"
+#include "core/graph/onnx_protobuf.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+static ONNX_NAMESPACE::TensorProto CreateWeights(const std::string& name, const std::vector<float>& values) {
+  ONNX_NAMESPACE::TensorProto proto;
+  proto.set_name(name);
+  proto.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  proto.add_dims(static_cast<int64_t>(values.size()));
+  proto.set_raw_data(values.data(), values.size() * sizeof(float));
+  return proto;
+}
+
+TEST(SharedWeightsStoreTest, SharesMatchingWeights) {
+  SharedWeightsStore store;
+
+  auto weights = CreateWeights("W", {1.f, 2.f, 3.f});
+
+  std::shared_ptr<const MLValue> value_1;
+  std::shared_ptr<const MLValue> value_2;
+  ASSERT_TRUE(store.GetOrCreate(weights, value_1).IsOK());
+  ASSERT_TRUE(store.GetOrCreate(weights, value_2).IsOK());
+
+  // both users get the same buffer
+  EXPECT_EQ(value_1->Get<Tensor>().DataRaw(), value_2->Get<Tensor>().DataRaw());
+  EXPECT_EQ(TensorShape(std::vector<int64_t>{3}), value_1->Get<Tensor>().Shape());
+  EXPECT_EQ(2.f, value_1->Get<Tensor>().Data<float>()[1]);
+  EXPECT_EQ(1u, store.NumEntries());
+
+  // same name with different content is a different weight
+  auto other_weights = CreateWeights("W", {4.f, 5.f, 6.f});
+  std::shared_ptr<const MLValue> value_3;
+  ASSERT_TRUE(store.GetOrCreate(other_weights, value_3).IsOK());
+  EXPECT_NE(value_1->Get<Tensor>().DataRaw(), value_3->Get<Tensor>().DataRaw());
+  EXPECT_EQ(5.f, value_3->Get<Tensor>().Data<float>()[1]);
+  EXPECT_EQ(2u, store.NumEntries());
+}
+
+TEST(SharedWeightsStoreTest, ReleasedWhenUnused) {
+  SharedWeightsStore store;
+
+  auto weights = CreateWeights("W", {1.f, 2.f, 3.f});
+
+  std::shared_ptr<const MLValue> value;
+  ASSERT_TRUE(store.GetOrCreate(weights, value).IsOK());
+  EXPECT_EQ(1u, store.NumEntries());
+
+  value = nullptr;
+  EXPECT_EQ(0u, store.NumEntries());
+
+  // recreated on the next request
+  ASSERT_TRUE(store.GetOrCreate(weights, value).IsOK());
+  EXPECT_EQ(3.f, value->Get<Tensor>().Data<float>()[2]);
+  EXPECT_EQ(1u, store.NumEntries());
+}
+
+TEST(SharedWeightsStoreTest, SharesTypedDataWeights) {
+  SharedWeightsStore store;
+
+  // small initializers usually use the typed data fields instead of raw_data
+  auto weights = CreateWeights("W", {1.f, 2.f, 3.f});
+  weights.clear_raw_data();
+  for (float value : {1.f, 2.f, 3.f}) {
+    weights.add_float_data(value);
+  }
+
+  // int8 values are widened to int32_data, so they are compared after deserializing them
+  ONNX_NAMESPACE::TensorProto int8_weights;
+  int8_weights.set_name("I");
+  int8_weights.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_INT8);
+  int8_weights.add_dims(2);
+  int8_weights.add_int32_data(-1);
+  int8_weights.add_int32_data(1);
+
+  for (const auto* proto : {&weights, &int8_weights}) {
+    std::shared_ptr<const MLValue> value_1;
+    std::shared_ptr<const MLValue> value_2;
+    ASSERT_TRUE(store.GetOrCreate(*proto, value_1).IsOK());
+    ASSERT_TRUE(store.GetOrCreate(*proto, value_2).IsOK());
+    EXPECT_EQ(value_1->Get<Tensor>().DataRaw(), value_2->Get<Tensor>().DataRaw());
+  }
+}
+
+TEST(SharedWeightsStoreTest, SharesPackedBuffers) {
+  SharedWeightsStore store;
+
+  auto weights = CreateWeights("W", {1.f, 2.f, 3.f});
+  std::shared_ptr<const MLValue> value;
+  ASSERT_TRUE(store.GetOrCreate(weights, value).IsOK());
+  const auto& tensor = value->Get<Tensor>();
+  ASSERT_TRUE(store.IsSharedWeight(tensor));
+
+  int num_packs = 0;
+  auto pack_fn = [&tensor, &num_packs](void* buffer) {
+    ++num_packs;
+    const float* data = tensor.Data<float>();
+    std::copy(data, data + 3, static_cast<float*>(buffer));
+  };
+
+  std::shared_ptr<void> packed_1;
+  std::shared_ptr<void> packed_2;
+  ASSERT_TRUE(store.GetOrCreatePacked(tensor, "Copy", 3 * sizeof(float), pack_fn, packed_1).IsOK());
+  ASSERT_TRUE(store.GetOrCreatePacked(tensor, "Copy", 3 * sizeof(float), pack_fn, packed_2).IsOK());
+
+  // the weights are only packed once
+  EXPECT_EQ(packed_1.get(), packed_2.get());
+  EXPECT_EQ(1, num_packs);
+  EXPECT_EQ(2.f, static_cast<const float*>(packed_1.get())[1]);
+  EXPECT_EQ(1u, store.NumPackedEntries());
+
+  // a different packing of the same weights is a different buffer
+  std::shared_ptr<void> packed_3;
+  ASSERT_TRUE(store.GetOrCreatePacked(tensor, "OtherCopy", 3 * sizeof(float), pack_fn, packed_3).IsOK());
+  EXPECT_NE(packed_1.get(), packed_3.get());
+  EXPECT_EQ(2, num_packs);
+  EXPECT_EQ(2u, store.NumPackedEntries());
+
+  packed_1 = nullptr;
+  packed_2 = nullptr;
+  packed_3 = nullptr;
+  EXPECT_EQ(0u, store.NumPackedEntries());
+
+  // tensors that don't come from the store are not shared
+  Tensor other_tensor(DataTypeImpl::GetType<float>(), TensorShape({2}), const_cast<float*>(tensor.Data<float>()) + 1,
+                      tensor.Location());
+  EXPECT_FALSE(store.IsSharedWeight(other_tensor));
+  std::shared_ptr<void> packed_4;
+  EXPECT_FALSE(store.GetOrCreatePacked(other_tensor, "Copy", 3 * sizeof(float), pack_fn, packed_4).IsOK());
+}
+
+TEST(SharedWeightsStoreTest, LiveEntriesSurvivePruning) {
+  SharedWeightsStore store;
+
+  auto weights = CreateWeights("W", {1.f, 2.f, 3.f});
+  std::shared_ptr<const MLValue> value;
+  ASSERT_TRUE(store.GetOrCreate(weights, value).IsOK());
+  const auto& tensor = value->Get<Tensor>();
+
+  auto pack_fn = [](void* buffer) { std::fill_n(static_cast<float*>(buffer), 3, 0.f); };
+  std::shared_ptr<void> packed;
+  ASSERT_TRUE(store.GetOrCreatePacked(tensor, "Copy", 3 * sizeof(float), pack_fn, packed).IsOK());
+
+  // enough released weights and packed buffers for the store to erase their entries several times
+  for (int i = 0; i < 1000; i++) {
+    std::shared_ptr<const MLValue> released_value;
+    ASSERT_TRUE(store.GetOrCreate(CreateWeights("R" + std::to_string(i), {float(i)}), released_value).IsOK());
+    std::shared_ptr<void> released_packed;
+    ASSERT_TRUE(store.GetOrCreatePacked(released_value->Get<Tensor>(), "Copy", sizeof(float),
+                                        [](void* buffer) { *static_cast<float*>(buffer) = 0.f; }, released_packed)
+                    .IsOK());
+  }
+
+  EXPECT_EQ(1u, store.NumEntries());
+  EXPECT_EQ(1u, store.NumPackedEntries());
+  EXPECT_TRUE(store.IsSharedWeight(tensor));
+
+  std::shared_ptr<const MLValue> value_2;
+  ASSERT_TRUE(store.GetOrCreate(weights, value_2).IsOK());
+  EXPECT_EQ(tensor.DataRaw(), value_2->Get<Tensor>().DataRaw());
+  std::shared_ptr<void> packed_2;
+  ASSERT_TRUE(store.GetOrCreatePacked(tensor, "Copy", 3 * sizeof(float), pack_fn, packed_2).IsOK());
+  EXPECT_EQ(packed.get(), packed_2.get());
+}
+
+TEST(SharedWeightsStoreTest, ExternalDataNotSupported) {
+  SharedWeightsStore store;
+
+  auto weights = CreateWeights("W", {1.f, 2.f, 3.f});
+  weights.clear_raw_data();
+  weights.set_data_location(ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL);
+  auto* location = weights.add_external_data();
+  location->set_key("location");
+  location->set_value("weights.bin");
+
+  std::shared_ptr<const MLValue> value;
+  EXPECT_FALSE(store.GetOrCreate(weights, value).IsOK());
+}
+}  // namespace test
+}  // namespace onnxruntime
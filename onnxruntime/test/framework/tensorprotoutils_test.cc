@@ -5,8 +5,11 @@
 #include "core/framework/tensor.h"
 #include "core/graph/onnx_protobuf.h"
 #include "core/framework/tensorprotoutils.h"
+#include "test/temp_dir.h"
 #include "gtest/gtest.h"
 #include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <cstring>
+#include <fstream>
 #include <sstream>
 
 namespace onnxruntime {
@@ -27,5 +30,71 @@ TEST(TensorProtoUtilsTest, test1) {
   ASSERT_TRUE(st.IsOK());
 }
 #endif
+
+TEST(TensorProtoUtilsTest, ExternalDataInfo) {
+  ONNX_NAMESPACE::TensorProto proto;
+  proto.set_name("weights");
+  proto.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  proto.add_dims(2);
+  proto.add_dims(3);
+  ASSERT_FALSE(utils::HasExternalData(proto));
+
+  proto.set_data_location(ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL);
+  auto* location = proto.add_external_data();
+  location->set_key("location");
+  location->set_value("weights.bin");
+  auto* offset_entry = proto.add_external_data();
+  offset_entry->set_key("offset");
+  offset_entry->set_value("4100");
+  ASSERT_TRUE(utils::HasExternalData(proto));
+
+  std::string file_path;
+  size_t offset;
+  size_t length;
+  ASSERT_TRUE(utils::GetExternalDataInfo(proto, "model_dir", file_path, offset, length).IsOK());
+  EXPECT_EQ("model_dir/weights.bin", file_path);
+  EXPECT_EQ(4100u, offset);
+  // length defaults to the size implied by the type and shape
+  EXPECT_EQ(6 * sizeof(float), length);
+
+  offset_entry->set_value("not a number");
+  EXPECT_FALSE(utils::GetExternalDataInfo(proto, "model_dir", file_path, offset, length).IsOK());
+}
+
+TEST(TensorProtoUtilsTest, MapFileIntoMemory) {
+  TemporaryDirectory temp_dir;
+  const std::string filename = temp_dir.Path("map_file_into_memory_test.bin");
+  std::vector<char> contents(10000);
+  for (size_t i = 0; i < contents.size(); ++i) {
+    contents[i] = static_cast<char>(i % 251);
+  }
+
+  {
+    std::ofstream out(filename, std::ios::binary);
+    out.write(contents.data(), contents.size());
+  }
+
+  size_t length = 0;
+  ASSERT_TRUE(Env::Default().GetFileLength(filename, length).IsOK());
+  EXPECT_EQ(contents.size(), length);
+
+  // offset that is not page aligned
+  const size_t offset = 4097;
+  Env::MappedMemoryPtr mapped;
+  ASSERT_TRUE(Env::Default().MapFileIntoMemory(filename, offset, 1000, mapped).IsOK());
+  EXPECT_EQ(0, memcmp(contents.data() + offset, mapped.get(), 1000));
+  mapped.reset();
+
+  EXPECT_FALSE(Env::Default().MapFileIntoMemory(temp_dir.Directory() + "/no_such_file.bin", 0, 10, mapped).IsOK());
+
+  // ranges that extend beyond the end of a truncated file are rejected instead of faulting on access
+  ASSERT_TRUE(Env::Default().MapFileIntoMemory(filename, 0, contents.size(), mapped).IsOK());
+  mapped.reset();
+  auto status = Env::Default().MapFileIntoMemory(filename, offset, contents.size(), mapped);
+  EXPECT_EQ(common::INVALID_ARGUMENT, status.Code());
+  EXPECT_EQ(nullptr, mapped.get());
+  status = Env::Default().MapFileIntoMemory(filename, contents.size() + 1, 1, mapped);
+  EXPECT_EQ(common::INVALID_ARGUMENT, status.Code());
+}
 }  // namespace test
 }  // namespace onnxruntime
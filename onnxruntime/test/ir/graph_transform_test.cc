@@ -15,9 +15,16 @@
 #include "core/graph/conv_activation_fusion.h"
 #include "core/graph/matmul_add_fusion.h"
 #include "core/graph/gemm_activation_fusion.h"
+#include "core/graph/nchwc_transformer.h"
+#include "core/graph/elementwise_fusion.h"
+#include "core/graph/attention_fusion.h"
+#include "core/graph/layer_norm_fusion.h"
+#include "core/graph/gelu_fusion.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/platform/env.h"
 
 #include "test/capturing_sink.h"
+#include "test/framework/test_utils.h"
 #include "test/test_environment.h"
 #include "gtest/gtest.h"
 
@@ -42,6 +49,126 @@ std::map<std::string, int> CountOpsInGraph(const Graph& graph) {
   return op_to_count;
 }
 
+// Add a float initializer with the given shape and values to the graph.
+static void AddFloatInitializer(Graph& graph, const std::string& name,
+                                const std::vector<int64_t>& dims, const std::vector<float>& values) {
+  TensorProto tensor;
+  tensor.set_name(name);
+  tensor.set_data_type(TensorProto_DataType_FLOAT);
+  for (auto dim : dims) {
+    tensor.add_dims(dim);
+  }
+  for (auto value : values) {
+    tensor.add_float_data(value);
+  }
+  graph.AddInitializedTensor(tensor);
+}
+
+// Add an int64 initializer with the given values to the graph as a 1D tensor.
+static void AddInt64Initializer(Graph& graph, const std::string& name, const std::vector<int64_t>& values) {
+  TensorProto tensor;
+  tensor.set_name(name);
+  tensor.set_data_type(TensorProto_DataType_INT64);
+  tensor.add_dims(static_cast<int64_t>(values.size()));
+  for (auto value : values) {
+    tensor.add_int64_data(value);
+  }
+  graph.AddInitializedTensor(tensor);
+}
+
+// Return a deterministic sequence of small values to fill test tensors.
+static std::vector<float> TransformTestValues(size_t count, float scale) {
+  std::vector<float> values(count);
+  for (size_t i = 0; i < count; i++) {
+    values[i] = static_cast<float>(static_cast<int>((i * 7) % 13) - 6) * scale;
+  }
+  return values;
+}
+
+// Serialize a model built in code. The Graph adds every initializer to the graph
+// inputs when it is resolved, so unless initializers_are_graph_inputs is set, keep
+// only the inputs in input_names so that the initializers are constants.
+static ModelProto TransformTestModelProto(Model& model, const std::vector<std::string>& input_names,
+                                          bool initializers_are_graph_inputs) {
+  auto model_proto = model.ToProto();
+  if (!initializers_are_graph_inputs) {
+    auto* graph_inputs = model_proto.mutable_graph()->mutable_input();
+    for (int i = graph_inputs->size() - 1; i >= 0; --i) {
+      if (std::find(input_names.begin(), input_names.end(), graph_inputs->Get(i).name()) == input_names.end()) {
+        graph_inputs->DeleteSubrange(i, 1);
+      }
+    }
+  }
+  return model_proto;
+}
+
+// Apply the transformer to the model and return the number of occurrences of
+// each operator in the transformed graph.
+static std::map<std::string, int> CountOpsAfterTransform(const ModelProto& model_proto,
+                                                         std::unique_ptr<GraphTransformer> transformer) {
+  std::shared_ptr<Model> model;
+  auto status = Model::Load(model_proto, model);
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+  Graph& graph = model->MainGraph();
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  EXPECT_TRUE(graph_transformation_mgr.Register(std::move(transformer)).IsOK());
+  status = graph_transformation_mgr.ApplyAll(graph);
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+  return CountOpsInGraph(graph);
+}
+
+// Run the model with the float feeds, registering the transformer if not null,
+// and return the values of the float output.
+static void RunTransformTestModel(const ModelProto& model_proto, std::unique_ptr<GraphTransformer> transformer,
+                                  const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>>& feeds,
+                                  const std::string& output_name, std::vector<float>& output_values) {
+  SessionOptions so;
+  so.session_logid = "GraphTransformationTests.RunTransformTestModel";
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  if (transformer != nullptr) {
+    ASSERT_TRUE(session_object.RegisterGraphTransformer(std::move(transformer)).IsOK());
+  }
+
+  std::stringstream model_stream;
+  model_proto.SerializeToOstream(&model_stream);
+  ASSERT_TRUE(session_object.Load(model_stream).IsOK());
+  auto status = session_object.Initialize();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  NameMLValMap feed_values;
+  for (const auto& feed : feeds) {
+    MLValue mlvalue;
+    CreateMLValue<float>(allocator, feed.second.first, feed.second.second, &mlvalue);
+    feed_values.insert(std::make_pair(feed.first, mlvalue));
+  }
+
+  std::vector<MLValue> fetches;
+  status = session_object.Run(feed_values, {output_name}, &fetches);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  ASSERT_EQ(fetches.size(), 1u);
+
+  const auto& output = fetches[0].Get<Tensor>();
+  const float* data = output.Data<float>();
+  output_values.assign(data, data + output.Shape().Size());
+}
+
+// Check that the transformed model produces the same output as the original model.
+static void CheckTransformParity(const ModelProto& model_proto, std::unique_ptr<GraphTransformer> transformer,
+                                 const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>>& feeds,
+                                 const std::string& output_name) {
+  std::vector<float> expected_values;
+  RunTransformTestModel(model_proto, nullptr, feeds, output_name, expected_values);
+  std::vector<float> output_values;
+  RunTransformTestModel(model_proto, std::move(transformer), feeds, output_name, output_values);
+
+  ASSERT_EQ(expected_values.size(), output_values.size());
+  for (size_t i = 0; i < expected_values.size(); i++) {
+    EXPECT_NEAR(expected_values[i], output_values[i], 1e-4f * std::max(1.0f, std::abs(expected_values[i])))
+        << "index " << i;
+  }
+}
+
 TEST(GraphTransformationTests, IdentityElimination) {
   string model_uri = MODEL_FOLDER + "abs-id-max.onnx";
   std::shared_ptr<Model> model;
@@ -282,6 +409,443 @@ TEST(GraphTransformationTests, Gemm_Relu_three_input) {
   ASSERT_TRUE(session_object.Initialize().IsOK());
 }
 
+// X -> Conv -> Relu -> MaxPool -> Conv -> Y with 3x3 and 1x1 convolutions.
+static ModelProto CreateNchwcTestModel(bool filters_are_graph_inputs) {
+  Model model("NchwcTransformer");
+  auto& graph = model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  for (int64_t dim : {1, 16, 8, 8}) {
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+
+  AddFloatInitializer(graph, "W1", {32, 16, 3, 3}, TransformTestValues(32 * 16 * 3 * 3, 0.01f));
+  AddFloatInitializer(graph, "B1", {32}, TransformTestValues(32, 0.1f));
+  AddFloatInitializer(graph, "W2", {32, 32, 1, 1}, TransformTestValues(32 * 32, 0.02f));
+
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& conv1_out = graph.GetOrCreateNodeArg("conv1_out", nullptr);
+  auto& relu_out = graph.GetOrCreateNodeArg("relu_out", nullptr);
+  auto& pool_out = graph.GetOrCreateNodeArg("pool_out", nullptr);
+  auto& y = graph.GetOrCreateNodeArg("Y", nullptr);
+
+  auto& conv1 = graph.AddNode("conv1", "Conv", "3x3 convolution",
+                              {&x, &graph.GetOrCreateNodeArg("W1", nullptr), &graph.GetOrCreateNodeArg("B1", nullptr)},
+                              {&conv1_out});
+  conv1.AddAttribute("pads", std::vector<int64_t>{1, 1, 1, 1});
+  graph.AddNode("relu", "Relu", "activation", {&conv1_out}, {&relu_out});
+  auto& pool = graph.AddNode("pool", "MaxPool", "pooling", {&relu_out}, {&pool_out});
+  pool.AddAttribute("kernel_shape", std::vector<int64_t>{2, 2});
+  pool.AddAttribute("strides", std::vector<int64_t>{2, 2});
+  graph.AddNode("conv2", "Conv", "1x1 convolution",
+                {&pool_out, &graph.GetOrCreateNodeArg("W2", nullptr)}, {&y});
+
+  auto status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  return TransformTestModelProto(model, {"X"}, filters_are_graph_inputs);
+}
+
+TEST(GraphTransformationTests, NchwcTransformer) {
+  if (MlasNchwcGetBlockSize() <= 1) {
+    return;
+  }
+
+  const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>> feeds{
+      {"X", {{1, 16, 8, 8}, TransformTestValues(16 * 8 * 8, 0.1f)}}};
+
+  auto model_proto = CreateNchwcTestModel(false);
+  auto op_to_count = CountOpsAfterTransform(model_proto, std::make_unique<NchwcTransformer>());
+  EXPECT_EQ(op_to_count["Conv"], 0);
+  EXPECT_EQ(op_to_count["Relu"], 0);
+  EXPECT_EQ(op_to_count["MaxPool"], 0);
+  EXPECT_EQ(op_to_count["NchwcConv"], 2);
+  EXPECT_EQ(op_to_count["NchwcMaxPool"], 1);
+  // The input is reordered once and the output is reordered back once. The
+  // tensors passed between the NCHWc nodes are not reordered.
+  EXPECT_EQ(op_to_count["ReorderInput"], 1);
+  EXPECT_EQ(op_to_count["ReorderOutput"], 1);
+
+  CheckTransformParity(model_proto, std::make_unique<NchwcTransformer>(), feeds, "Y");
+}
+
+TEST(GraphTransformationTests, NchwcTransformerFilterIsGraphInput) {
+  if (MlasNchwcGetBlockSize() <= 1) {
+    return;
+  }
+
+  const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>> feeds{
+      {"X", {{1, 16, 8, 8}, TransformTestValues(16 * 8 * 8, 0.1f)}}};
+
+  // The filters can be overridden by a feed, so they must not be reordered and
+  // the convolutions are left alone.
+  auto model_proto = CreateNchwcTestModel(true);
+  auto op_to_count = CountOpsAfterTransform(model_proto, std::make_unique<NchwcTransformer>());
+  EXPECT_EQ(op_to_count["Conv"], 2);
+  EXPECT_EQ(op_to_count["Relu"], 1);
+  EXPECT_EQ(op_to_count["MaxPool"], 1);
+  EXPECT_EQ(op_to_count["NchwcConv"], 0);
+  EXPECT_EQ(op_to_count["ReorderInput"], 0);
+  EXPECT_EQ(op_to_count["ReorderOutput"], 0);
+
+  CheckTransformParity(model_proto, std::make_unique<NchwcTransformer>(), feeds, "Y");
+}
+
+// Y = Tanh(LeakyRelu((X + B) * S) - X). If mul_has_other_consumer is set, the
+// output of the Mul is also consumed by an Identity node producing M.
+static ModelProto CreateElementwiseTestModel(bool mul_has_other_consumer) {
+  Model model("ElementwiseFusion");
+  auto& graph = model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  for (int64_t dim : {2, 3, 4}) {
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+
+  AddFloatInitializer(graph, "B", {4}, {0.5f, -0.25f, 1.0f, -1.5f});
+  AddFloatInitializer(graph, "S", {}, {1.5f});
+
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& add_out = graph.GetOrCreateNodeArg("add_out", nullptr);
+  auto& mul_out = graph.GetOrCreateNodeArg("mul_out", nullptr);
+  auto& leaky_relu_out = graph.GetOrCreateNodeArg("leaky_relu_out", nullptr);
+  auto& sub_out = graph.GetOrCreateNodeArg("sub_out", nullptr);
+  auto& y = graph.GetOrCreateNodeArg("Y", nullptr);
+
+  graph.AddNode("add", "Add", "add bias", {&x, &graph.GetOrCreateNodeArg("B", nullptr)}, {&add_out});
+  graph.AddNode("mul", "Mul", "scale", {&add_out, &graph.GetOrCreateNodeArg("S", nullptr)}, {&mul_out});
+  auto& leaky_relu = graph.AddNode("leaky_relu", "LeakyRelu", "activation", {&mul_out}, {&leaky_relu_out});
+  leaky_relu.AddAttribute("alpha", 0.2f);
+  graph.AddNode("sub", "Sub", "subtract input", {&leaky_relu_out, &x}, {&sub_out});
+  graph.AddNode("tanh", "Tanh", "activation", {&sub_out}, {&y});
+  if (mul_has_other_consumer) {
+    graph.AddNode("identity", "Identity", "consumer outside of the fused group",
+                  {&mul_out}, {&graph.GetOrCreateNodeArg("M", nullptr)});
+  }
+
+  auto status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  return TransformTestModelProto(model, {"X"}, false);
+}
+
+TEST(GraphTransformationTests, ElementwiseFusion) {
+  const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>> feeds{
+      {"X", {{2, 3, 4}, TransformTestValues(2 * 3 * 4, 0.25f)}}};
+
+  auto model_proto = CreateElementwiseTestModel(false);
+  auto op_to_count = CountOpsAfterTransform(model_proto, std::make_unique<ElementwiseFusion>());
+  EXPECT_EQ(op_to_count["FusedElementwise"], 1);
+  for (const char* op_type : {"Add", "Mul", "LeakyRelu", "Sub", "Tanh"}) {
+    EXPECT_EQ(op_to_count[op_type], 0) << op_type;
+  }
+
+  CheckTransformParity(model_proto, std::make_unique<ElementwiseFusion>(), feeds, "Y");
+}
+
+TEST(GraphTransformationTests, ElementwiseFusionOutputWithOtherConsumer) {
+  const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>> feeds{
+      {"X", {{2, 3, 4}, TransformTestValues(2 * 3 * 4, 0.25f)}}};
+
+  // The Mul output must be materialized for the Identity node, so the Mul
+  // ends the group of Add and Mul and can't join the group rooted at the Tanh.
+  auto model_proto = CreateElementwiseTestModel(true);
+  auto op_to_count = CountOpsAfterTransform(model_proto, std::make_unique<ElementwiseFusion>());
+  EXPECT_EQ(op_to_count["FusedElementwise"], 2);
+  EXPECT_EQ(op_to_count["Identity"], 1);
+  for (const char* op_type : {"Add", "Mul", "LeakyRelu", "Sub", "Tanh"}) {
+    EXPECT_EQ(op_to_count[op_type], 0) << op_type;
+  }
+
+  CheckTransformParity(model_proto, std::make_unique<ElementwiseFusion>(), feeds, "Y");
+  CheckTransformParity(model_proto, std::make_unique<ElementwiseFusion>(), feeds, "M");
+}
+
+// Options for the self attention subgraph built by CreateAttentionTestModel.
+// The defaults describe a subgraph that AttentionFusion rewrites.
+struct AttentionTestOptions {
+  std::vector<int64_t> key_perm{0, 2, 3, 1};
+  std::vector<int64_t> split_heads_shape{0, 0, 2, 4};
+  float scale_divisor = 2.0f;
+  bool weights_are_graph_inputs = false;
+};
+
+// Self attention over X [2, 4, 8] with 2 heads of size 4, in the form exported
+// by the frameworks.
+static ModelProto CreateAttentionTestModel(const AttentionTestOptions& options) {
+  Model model("AttentionFusion");
+  auto& graph = model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  for (int64_t dim : {2, 4, 8}) {
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+
+  AddInt64Initializer(graph, "split_heads_shape", options.split_heads_shape);
+  AddInt64Initializer(graph, "merge_heads_shape", {0, 0, 8});
+  AddFloatInitializer(graph, "scale", {}, {options.scale_divisor});
+
+  NodeArg* branch_outputs[3];
+  const char* branch_names[] = {"q", "k", "v"};
+  for (int b = 0; b < 3; b++) {
+    const std::string name = branch_names[b];
+    AddFloatInitializer(graph, name + "_weight", {8, 8}, TransformTestValues(8 * 8, 0.05f * (b + 1)));
+    AddFloatInitializer(graph, name + "_bias", {8}, TransformTestValues(8, 0.1f));
+
+    auto& matmul_out = graph.GetOrCreateNodeArg(name + "_matmul_out", nullptr);
+    auto& add_out = graph.GetOrCreateNodeArg(name + "_add_out", nullptr);
+    auto& reshape_out = graph.GetOrCreateNodeArg(name + "_reshape_out", nullptr);
+    branch_outputs[b] = &graph.GetOrCreateNodeArg(name + "_transpose_out", nullptr);
+
+    graph.AddNode(name + "_matmul", "MatMul", "projection",
+                  {&x, &graph.GetOrCreateNodeArg(name + "_weight", nullptr)}, {&matmul_out});
+    graph.AddNode(name + "_add", "Add", "projection bias",
+                  {&matmul_out, &graph.GetOrCreateNodeArg(name + "_bias", nullptr)}, {&add_out});
+    graph.AddNode(name + "_reshape", "Reshape", "split heads",
+                  {&add_out, &graph.GetOrCreateNodeArg("split_heads_shape", nullptr)}, {&reshape_out});
+    auto& transpose = graph.AddNode(name + "_transpose", "Transpose", "heads first",
+                                    {&reshape_out}, {branch_outputs[b]});
+    transpose.AddAttribute("perm", b == 1 ? options.key_perm : std::vector<int64_t>{0, 2, 1, 3});
+  }
+
+  auto& qk_out = graph.GetOrCreateNodeArg("qk_out", nullptr);
+  auto& scale_out = graph.GetOrCreateNodeArg("scale_out", nullptr);
+  auto& softmax_out = graph.GetOrCreateNodeArg("softmax_out", nullptr);
+  auto& qkv_out = graph.GetOrCreateNodeArg("qkv_out", nullptr);
+  auto& merge_transpose_out = graph.GetOrCreateNodeArg("merge_transpose_out", nullptr);
+  auto& y = graph.GetOrCreateNodeArg("Y", nullptr);
+
+  graph.AddNode("qk", "MatMul", "attention scores", {branch_outputs[0], branch_outputs[1]}, {&qk_out});
+  graph.AddNode("scale_div", "Div", "scale scores",
+                {&qk_out, &graph.GetOrCreateNodeArg("scale", nullptr)}, {&scale_out});
+  auto& softmax = graph.AddNode("softmax", "Softmax", "attention probabilities", {&scale_out}, {&softmax_out});
+  softmax.AddAttribute("axis", static_cast<int64_t>(3));
+  graph.AddNode("qkv", "MatMul", "attend values", {&softmax_out, branch_outputs[2]}, {&qkv_out});
+  auto& merge_transpose = graph.AddNode("merge_transpose", "Transpose", "sequence first",
+                                        {&qkv_out}, {&merge_transpose_out});
+  merge_transpose.AddAttribute("perm", std::vector<int64_t>{0, 2, 1, 3});
+  graph.AddNode("merge_reshape", "Reshape", "merge heads",
+                {&merge_transpose_out, &graph.GetOrCreateNodeArg("merge_heads_shape", nullptr)}, {&y});
+
+  auto status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  return TransformTestModelProto(model, {"X"}, options.weights_are_graph_inputs);
+}
+
+TEST(GraphTransformationTests, AttentionFusion) {
+  const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>> feeds{
+      {"X", {{2, 4, 8}, TransformTestValues(2 * 4 * 8, 0.25f)}}};
+
+  auto model_proto = CreateAttentionTestModel(AttentionTestOptions());
+  auto op_to_count = CountOpsAfterTransform(model_proto, std::make_unique<AttentionFusion>());
+  EXPECT_EQ(op_to_count["Attention"], 1);
+  for (const char* op_type : {"MatMul", "Add", "Reshape", "Transpose", "Div", "Softmax"}) {
+    EXPECT_EQ(op_to_count[op_type], 0) << op_type;
+  }
+
+  CheckTransformParity(model_proto, std::make_unique<AttentionFusion>(), feeds, "Y");
+}
+
+TEST(GraphTransformationTests, AttentionFusionPreconditions) {
+  const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>> feeds{
+      {"X", {{2, 4, 8}, TransformTestValues(2 * 4 * 8, 0.25f)}}};
+
+  // Each of these subgraphs is valid but is not the attention pattern, or
+  // depends on values that the fusion can't fold, so it must not be fused.
+  std::vector<std::pair<std::string, AttentionTestOptions>> cases;
+
+  // The key is not transposed for the scores MatMul.
+  cases.emplace_back("key perm", AttentionTestOptions());
+  cases.back().second.key_perm = {0, 2, 1, 3};
+
+  // The heads are not split with a [0, 0, num_heads, head_size] shape.
+  cases.emplace_back("split heads shape", AttentionTestOptions());
+  cases.back().second.split_heads_shape = {2, 4, 2, 4};
+
+  // The scores are not scaled by 1 / sqrt(head_size).
+  cases.emplace_back("scale", AttentionTestOptions());
+  cases.back().second.scale_divisor = 3.0f;
+
+  // The weights can be overridden by a feed, so they can't be packed.
+  cases.emplace_back("weights are graph inputs", AttentionTestOptions());
+  cases.back().second.weights_are_graph_inputs = true;
+
+  for (const auto& test_case : cases) {
+    auto model_proto = CreateAttentionTestModel(test_case.second);
+    auto op_to_count = CountOpsAfterTransform(model_proto, std::make_unique<AttentionFusion>());
+    EXPECT_EQ(op_to_count["Attention"], 0) << test_case.first;
+    EXPECT_EQ(op_to_count["Softmax"], 1) << test_case.first;
+    EXPECT_EQ(op_to_count["MatMul"], 5) << test_case.first;
+
+    CheckTransformParity(model_proto, std::make_unique<AttentionFusion>(), feeds, "Y");
+  }
+}
+
+// Layer normalization of X [2, 3, 4] over the given trailing axes, in the form
+// exported by the frameworks.
+static ModelProto CreateLayerNormTestModel(const std::vector<int64_t>& axes, const std::vector<int64_t>& scale_dims) {
+  Model model("LayerNormFusion");
+  auto& graph = model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  for (int64_t dim : {2, 3, 4}) {
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+
+  size_t scale_size = 1;
+  for (auto dim : scale_dims) {
+    scale_size *= static_cast<size_t>(dim);
+  }
+  AddFloatInitializer(graph, "scale", scale_dims, TransformTestValues(scale_size, 0.25f));
+  AddFloatInitializer(graph, "bias", scale_dims, TransformTestValues(scale_size, 0.1f));
+  AddFloatInitializer(graph, "two", {}, {2.0f});
+  AddFloatInitializer(graph, "epsilon", {}, {1e-5f});
+
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& mean_out = graph.GetOrCreateNodeArg("mean_out", nullptr);
+  auto& sub_out = graph.GetOrCreateNodeArg("sub_out", nullptr);
+  auto& pow_out = graph.GetOrCreateNodeArg("pow_out", nullptr);
+  auto& variance_out = graph.GetOrCreateNodeArg("variance_out", nullptr);
+  auto& add_epsilon_out = graph.GetOrCreateNodeArg("add_epsilon_out", nullptr);
+  auto& sqrt_out = graph.GetOrCreateNodeArg("sqrt_out", nullptr);
+  auto& div_out = graph.GetOrCreateNodeArg("div_out", nullptr);
+  auto& mul_out = graph.GetOrCreateNodeArg("mul_out", nullptr);
+  auto& y = graph.GetOrCreateNodeArg("Y", nullptr);
+
+  auto& mean = graph.AddNode("mean", "ReduceMean", "mean", {&x}, {&mean_out});
+  mean.AddAttribute("axes", axes);
+  graph.AddNode("sub", "Sub", "center", {&x, &mean_out}, {&sub_out});
+  graph.AddNode("pow", "Pow", "square", {&sub_out, &graph.GetOrCreateNodeArg("two", nullptr)}, {&pow_out});
+  auto& variance = graph.AddNode("variance", "ReduceMean", "variance", {&pow_out}, {&variance_out});
+  variance.AddAttribute("axes", axes);
+  graph.AddNode("add_epsilon", "Add", "add epsilon",
+                {&variance_out, &graph.GetOrCreateNodeArg("epsilon", nullptr)}, {&add_epsilon_out});
+  graph.AddNode("sqrt", "Sqrt", "standard deviation", {&add_epsilon_out}, {&sqrt_out});
+  graph.AddNode("div", "Div", "normalize", {&sub_out, &sqrt_out}, {&div_out});
+  graph.AddNode("mul", "Mul", "scale", {&div_out, &graph.GetOrCreateNodeArg("scale", nullptr)}, {&mul_out});
+  graph.AddNode("add_bias", "Add", "bias", {&mul_out, &graph.GetOrCreateNodeArg("bias", nullptr)}, {&y});
+
+  auto status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  return TransformTestModelProto(model, {"X"}, false);
+}
+
+TEST(GraphTransformationTests, LayerNormFusion) {
+  const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>> feeds{
+      {"X", {{2, 3, 4}, TransformTestValues(2 * 3 * 4, 0.5f)}}};
+
+  // Normalize over the last axis and over the trailing two axes.
+  const std::vector<std::pair<std::vector<int64_t>, std::vector<int64_t>>> cases{
+      {{-1}, {4}},
+      {{1, 2}, {3, 4}},
+      {{1, 2}, {1, 3, 4}}};
+
+  for (const auto& test_case : cases) {
+    auto model_proto = CreateLayerNormTestModel(test_case.first, test_case.second);
+    auto op_to_count = CountOpsAfterTransform(model_proto, std::make_unique<LayerNormFusion>());
+    EXPECT_EQ(op_to_count["LayerNormalization"], 1);
+    for (const char* op_type : {"ReduceMean", "Sub", "Pow", "Add", "Sqrt", "Div", "Mul"}) {
+      EXPECT_EQ(op_to_count[op_type], 0) << op_type;
+    }
+
+    CheckTransformParity(model_proto, std::make_unique<LayerNormFusion>(), feeds, "Y");
+  }
+}
+
+TEST(GraphTransformationTests, LayerNormFusionBroadcastScale) {
+  const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>> feeds{
+      {"X", {{2, 3, 4}, TransformTestValues(2 * 3 * 4, 0.5f)}}};
+
+  // The scale and bias are broadcast over the first normalized axis, so they
+  // don't have one value per normalized element and the subgraph is not fused.
+  auto model_proto = CreateLayerNormTestModel({1, 2}, {4});
+  auto op_to_count = CountOpsAfterTransform(model_proto, std::make_unique<LayerNormFusion>());
+  EXPECT_EQ(op_to_count["LayerNormalization"], 0);
+  EXPECT_EQ(op_to_count["ReduceMean"], 2);
+
+  CheckTransformParity(model_proto, std::make_unique<LayerNormFusion>(), feeds, "Y");
+}
+
+// Gelu of X [2, 5] as Mul(Mul(X, Add(Erf(Div(X, divisor)), 1)), 0.5), or as
+// Mul(Mul(X, 0.5), Add(Erf(Mul(X, 1 / divisor)), 1)) if half_first is set.
+static ModelProto CreateGeluTestModel(bool half_first, float divisor) {
+  Model model("GeluFusion");
+  auto& graph = model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  for (int64_t dim : {2, 5}) {
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+
+  AddFloatInitializer(graph, "scale", {}, {half_first ? 1.0f / divisor : divisor});
+  AddFloatInitializer(graph, "one", {}, {1.0f});
+  AddFloatInitializer(graph, "half", {}, {0.5f});
+
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& scale_out = graph.GetOrCreateNodeArg("scale_out", nullptr);
+  auto& erf_out = graph.GetOrCreateNodeArg("erf_out", nullptr);
+  auto& add_out = graph.GetOrCreateNodeArg("add_out", nullptr);
+  auto& mul_out = graph.GetOrCreateNodeArg("mul_out", nullptr);
+  auto& y = graph.GetOrCreateNodeArg("Y", nullptr);
+  auto& scale = graph.GetOrCreateNodeArg("scale", nullptr);
+  auto& one = graph.GetOrCreateNodeArg("one", nullptr);
+  auto& half = graph.GetOrCreateNodeArg("half", nullptr);
+
+  graph.AddNode("scale", half_first ? "Mul" : "Div", "scale", {&x, &scale}, {&scale_out});
+  graph.AddNode("erf", "Erf", "erf", {&scale_out}, {&erf_out});
+  graph.AddNode("add", "Add", "add one", {&erf_out, &one}, {&add_out});
+  if (half_first) {
+    graph.AddNode("half", "Mul", "half", {&x, &half}, {&mul_out});
+    graph.AddNode("mul", "Mul", "multiply", {&mul_out, &add_out}, {&y});
+  } else {
+    graph.AddNode("mul", "Mul", "multiply", {&x, &add_out}, {&mul_out});
+    graph.AddNode("half", "Mul", "half", {&mul_out, &half}, {&y});
+  }
+
+  auto status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  return TransformTestModelProto(model, {"X"}, false);
+}
+
+TEST(GraphTransformationTests, GeluFusion) {
+  const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>> feeds{
+      {"X", {{2, 5}, TransformTestValues(2 * 5, 0.5f)}}};
+
+  for (bool half_first : {false, true}) {
+    auto model_proto = CreateGeluTestModel(half_first, 1.41421356237309504880f);
+    auto op_to_count = CountOpsAfterTransform(model_proto, std::make_unique<GeluFusion>());
+    EXPECT_EQ(op_to_count["Gelu"], 1);
+    for (const char* op_type : {"Div", "Erf", "Add", "Mul"}) {
+      EXPECT_EQ(op_to_count[op_type], 0) << op_type;
+    }
+
+    CheckTransformParity(model_proto, std::make_unique<GeluFusion>(), feeds, "Y");
+  }
+}
+
+TEST(GraphTransformationTests, GeluFusionWrongConstant) {
+  const std::map<std::string, std::pair<std::vector<int64_t>, std::vector<float>>> feeds{
+      {"X", {{2, 5}, TransformTestValues(2 * 5, 0.5f)}}};
+
+  // The input is not scaled by 1 / sqrt(2), so this is not a Gelu.
+  for (bool half_first : {false, true}) {
+    auto model_proto = CreateGeluTestModel(half_first, 2.0f);
+    auto op_to_count = CountOpsAfterTransform(model_proto, std::make_unique<GeluFusion>());
+    EXPECT_EQ(op_to_count["Gelu"], 0);
+    EXPECT_EQ(op_to_count["Erf"], 1);
+
+    CheckTransformParity(model_proto, std::make_unique<GeluFusion>(), feeds, "Y");
+  }
+}
 
 }  // namespace test
 }  // namespace onnxruntime
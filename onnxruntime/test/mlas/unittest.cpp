@@ -17,7 +17,9 @@ Abstract:
 #include <stdio.h>
 #include <memory.h>
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <vector>
 #include <mlas.h>
 
 #if defined(_WIN32)
@@ -30,6 +32,7 @@ Abstract:
 #define _countof(_Array) (sizeof(_Array) / sizeof(_Array[0]))
 #endif
 
+template<typename T>
 class MatrixGuardBuffer
 {
 public:
@@ -47,7 +50,7 @@ public:
 #endif
     }
 
-    float* GetBuffer(size_t Elements)
+    T* GetBuffer(size_t Elements)
     {
         return _GuardAddress - Elements;
     }
@@ -58,7 +61,7 @@ private:
         const size_t PageSize = 4096;
         const size_t GuardPadding = 256 * 1024;
 
-        size_t MatrixSize = Elements * sizeof(float);
+        size_t MatrixSize = Elements * sizeof(T);
         size_t AlignedMatrixSize = (MatrixSize + PageSize - 1) & ~(PageSize - 1);
 
         _BaseBufferSize = AlignedMatrixSize + GuardPadding;
@@ -71,17 +74,17 @@ private:
         mprotect(_BaseBuffer, AlignedMatrixSize, PROT_READ | PROT_WRITE);
 #endif
 
-        float* GuardAddress = (float*)((unsigned char*)_BaseBuffer + AlignedMatrixSize);
+        T* GuardAddress = (T*)((unsigned char*)_BaseBuffer + AlignedMatrixSize);
 
         const int MinimumFillValue = -23;
         const int MaximumFillValue = 23;
 
         int FillValue = MinimumFillValue;
-        float* FillAddress = (float*)((unsigned char*)GuardAddress - MatrixSize);
+        T* FillAddress = (T*)((unsigned char*)GuardAddress - MatrixSize);
 
         while (FillAddress < GuardAddress) {
 
-            *FillAddress++ = (float)FillValue;
+            *FillAddress++ = (T)FillValue;
 
             FillValue++;
 
@@ -105,7 +108,7 @@ private:
 private:
     void* _BaseBuffer;
     size_t _BaseBufferSize;
-    float* _GuardAddress;
+    T* _GuardAddress;
 };
 
 void
@@ -249,6 +252,29 @@ TrialSgemm(
             printf("mismatch TransA=%d, TransB=%d, M=%zd, N=%zd, K=%zd, alpha=%f, beta=%f!\n", TransA, TransB, M, N, K, alpha, beta);
         }
     }
+
+    //
+    // Repeat the operation using a prepacked matrix B. The packed buffer must
+    // be aligned to 64 bytes.
+    //
+
+    std::vector<uint8_t> PackedBStorage(MlasSgemmPackBSize(N, K) + 64);
+    void* PackedB = (void*)(((uintptr_t)PackedBStorage.data() + 63) & ~uintptr_t(63));
+
+    MlasSgemmPackB(TransB, N, K, B, ldb, PackedB);
+
+    for (size_t f = 0; f < M * N; f++) {
+        C[f] = -0.5f;
+    }
+
+    MlasSgemmPacked(TransA, M, N, K, alpha, A, lda, PackedB, beta, C, ldc);
+
+    for (size_t f = 0; f < M * N; f++) {
+        if (C[f] != CReference[f]) {
+            printf("mismatch packed TransA=%d, TransB=%d, M=%zd, N=%zd, K=%zd, alpha=%f, beta=%f!\n", TransA, TransB, M, N, K, alpha, beta);
+            break;
+        }
+    }
 }
 
 void
@@ -257,11 +283,11 @@ TrialSgemm(
     size_t N,
     size_t K,
     float alpha,
-    MatrixGuardBuffer& BufferA,
-    MatrixGuardBuffer& BufferB,
+    MatrixGuardBuffer<float>& BufferA,
+    MatrixGuardBuffer<float>& BufferB,
     float beta,
-    MatrixGuardBuffer& BufferC,
-    MatrixGuardBuffer& BufferCReference
+    MatrixGuardBuffer<float>& BufferC,
+    MatrixGuardBuffer<float>& BufferCReference
     )
 {
     const float* A = BufferA.GetBuffer(K * M);
@@ -275,6 +301,51 @@ TrialSgemm(
     TrialSgemm(CblasTrans, CblasTrans, M, N, K, alpha, A, M, B, K, beta, C, CReference, N);
 }
 
+void
+ExecuteSgemmPackedTests(
+    void
+    )
+{
+    //
+    // Run a smaller set of shapes than ExecuteSgemmTests around the stride
+    // boundaries of the kernels, so that the packed matrix B path is covered
+    // by every run.
+    //
+
+    constexpr size_t MaximumDimension = 320;
+
+    MatrixGuardBuffer<float> BufferA(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer<float> BufferB(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer<float> BufferC(MaximumDimension * MaximumDimension, false);
+    MatrixGuardBuffer<float> BufferCReference(MaximumDimension * MaximumDimension, false);
+
+    for (size_t b = 1; b < 16; b++) {
+        TrialSgemm(b, b, b, 1.0f, BufferA, BufferB, 0.0f, BufferC, BufferCReference);
+    }
+    for (size_t b = 16; b <= 256; b <<= 1) {
+        TrialSgemm(b, b, b, 1.0f, BufferA, BufferB, 0.0f, BufferC, BufferCReference);
+    }
+
+    static const float multipliers[] = { 0.0f, 0.25f, 1.0f, -1.0f };
+    static const size_t ms[] = { 1, 2, 5, 16, 33 };
+    static const size_t ns[] = { 1, 15, 16, 17, 48, 127 };
+    static const size_t ks[] = { 1, 3, 16, 127, 128, 129, 300 };
+
+    for (size_t a = 0; a < _countof(multipliers); a++) {
+        for (size_t b = 0; b < _countof(multipliers); b++) {
+            for (size_t m = 0; m < _countof(ms); m++) {
+                for (size_t n = 0; n < _countof(ns); n++) {
+                    for (size_t k = 0; k < _countof(ks); k++) {
+                        TrialSgemm(ms[m], ns[n], ks[k], multipliers[a], BufferA, BufferB, multipliers[b], BufferC, BufferCReference);
+                    }
+                }
+            }
+        }
+    }
+
+    printf("SGEMM packed tests done\n");
+}
+
 void
 ExecuteSgemmTests(
     void
@@ -282,10 +353,10 @@ ExecuteSgemmTests(
 {
     constexpr size_t MaximumDimension = 320;
 
-    MatrixGuardBuffer BufferA(MaximumDimension * MaximumDimension, true);
-    MatrixGuardBuffer BufferB(MaximumDimension * MaximumDimension, true);
-    MatrixGuardBuffer BufferC(MaximumDimension * MaximumDimension, false);
-    MatrixGuardBuffer BufferCReference(MaximumDimension * MaximumDimension, false);
+    MatrixGuardBuffer<float> BufferA(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer<float> BufferB(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer<float> BufferC(MaximumDimension * MaximumDimension, false);
+    MatrixGuardBuffer<float> BufferCReference(MaximumDimension * MaximumDimension, false);
 
     // Trial balloons.
     for (size_t b = 1; b < 16; b++) {
@@ -367,6 +438,151 @@ ExecuteSgemmTests(
     }
 }
 
+template<typename BType>
+void
+ReferenceQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const BType* B,
+    size_t ldb,
+    BType offb,
+    int32_t* C,
+    size_t ldc
+    )
+{
+    for (size_t m = 0; m < M; m++) {
+
+        for (size_t n = 0; n < N; n++) {
+
+            const uint8_t* a = A + (m * lda);
+            const BType* b = B + n;
+            int32_t* c = C + (m * ldc) + n;
+            int32_t sum = 0;
+
+            for (size_t k = 0; k < K; k++) {
+                sum += (int32_t(*b) - offb) * (int32_t(*a) - offa);
+                b += ldb;
+                a += 1;
+            }
+
+            *c = sum;
+        }
+    }
+}
+
+template<typename BType>
+void
+TrialQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    uint8_t offa,
+    BType offb,
+    MatrixGuardBuffer<uint8_t>& BufferA,
+    MatrixGuardBuffer<BType>& BufferB,
+    MatrixGuardBuffer<int32_t>& BufferC,
+    MatrixGuardBuffer<int32_t>& BufferCReference
+    )
+{
+    const uint8_t* A = BufferA.GetBuffer(K * M);
+    const BType* B = BufferB.GetBuffer(N * K);
+    int32_t* C = BufferC.GetBuffer(N * M);
+    int32_t* CReference = BufferCReference.GetBuffer(N * M);
+
+    for (size_t f = 0; f < M * N; f++) {
+        C[f] = -1;
+        CReference[f] = -1;
+    }
+
+    MlasQgemm(M, N, K, A, K, offa, B, N, offb, C, N);
+    ReferenceQgemm(M, N, K, A, K, offa, B, N, offb, CReference, N);
+
+    for (size_t f = 0; f < M * N; f++) {
+        if (C[f] != CReference[f]) {
+            printf("mismatch M=%zd, N=%zd, K=%zd, offa=%d, offb=%d!\n", M, N, K, int(offa), int(offb));
+            break;
+        }
+    }
+
+    //
+    // Repeat the operation with matrix B packed ahead of time.
+    //
+
+    std::vector<uint8_t> PackedB(MlasQgemmPackBSize(N, K));
+
+    MlasQgemmPackB(N, K, B, N, offb, PackedB.data());
+
+    for (size_t f = 0; f < M * N; f++) {
+        C[f] = -1;
+    }
+
+    MlasQgemmPacked(M, N, K, A, K, offa, PackedB.data(), C, N);
+
+    for (size_t f = 0; f < M * N; f++) {
+        if (C[f] != CReference[f]) {
+            printf("mismatch packed M=%zd, N=%zd, K=%zd, offa=%d, offb=%d!\n", M, N, K, int(offa), int(offb));
+            break;
+        }
+    }
+}
+
+template<typename BType>
+void
+ExecuteQgemmTests(
+    BType offb
+    )
+{
+    constexpr size_t MaximumDimension = 320;
+
+    MatrixGuardBuffer<uint8_t> BufferA(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer<BType> BufferB(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer<int32_t> BufferC(MaximumDimension * MaximumDimension, false);
+    MatrixGuardBuffer<int32_t> BufferCReference(MaximumDimension * MaximumDimension, false);
+
+    static const uint8_t offas[] = { 0, 1, 128, 255 };
+
+    for (size_t a = 0; a < _countof(offas); a++) {
+
+        for (size_t b = 1; b < 16; b++) {
+            TrialQgemm(b, b, b, offas[a], offb, BufferA, BufferB, BufferC, BufferCReference);
+            TrialQgemm(b, b, b, offas[a], BType(0), BufferA, BufferB, BufferC, BufferCReference);
+        }
+
+        for (size_t M = 1; M < 20; M++) {
+            for (size_t N = 1; N < 36; N++) {
+
+                static const size_t ks[] = { 1, 2, 3, 4, 7, 8, 15, 16, 17, 33, 64, 255, 256, 257, 320 };
+                for (size_t k = 0; k < _countof(ks); k++) {
+                    TrialQgemm(M, N, ks[k], offas[a], offb, BufferA, BufferB, BufferC, BufferCReference);
+                }
+            }
+        }
+
+        for (size_t M = 16; M < 160; M += 48) {
+            for (size_t N = 112; N < 320; N += 37) {
+                TrialQgemm(M, N, 300, offas[a], offb, BufferA, BufferB, BufferC, BufferCReference);
+            }
+        }
+
+        printf("offa %d offb %d\n", int(offas[a]), int(offb));
+    }
+}
+
+void
+ExecuteQgemmTests(
+    void
+    )
+{
+    ExecuteQgemmTests<uint8_t>(uint8_t(127));
+    ExecuteQgemmTests<uint8_t>(uint8_t(255));
+    ExecuteQgemmTests<int8_t>(int8_t(-128));
+    ExecuteQgemmTests<int8_t>(int8_t(5));
+}
+
 void
 ReferenceConv2D(
     size_t BatchCount,
@@ -398,7 +614,7 @@ ReferenceConv2D(
     size_t K = InputChannels * KernelSize;
     size_t Im2ColBufferElements = OutputSize * K;
 
-    MatrixGuardBuffer BufferIm2Col(Im2ColBufferElements, false);
+    MatrixGuardBuffer<float> BufferIm2Col(Im2ColBufferElements, false);
 
     for (size_t b = 0; b < BatchCount; b++) {
 
@@ -530,11 +746,11 @@ TrialConv2D(
     size_t BiasBufferElements = GroupCount * FilterCount;
     size_t OutputBufferElements = BatchCount * GroupCount * FilterCount * OutputSize;
 
-    MatrixGuardBuffer BufferInput(InputBufferElements, true);
-    MatrixGuardBuffer BufferFilter(FilterBufferElements, true);
-    MatrixGuardBuffer BufferBias(BiasBufferElements, true);
-    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
-    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+    MatrixGuardBuffer<float> BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer<float> BufferFilter(FilterBufferElements, true);
+    MatrixGuardBuffer<float> BufferBias(BiasBufferElements, true);
+    MatrixGuardBuffer<float> BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer<float> BufferOutputReference(OutputBufferElements, false);
 
     const float* Input = BufferInput.GetBuffer(InputBufferElements);
     const float* Filter = BufferFilter.GetBuffer(FilterBufferElements);
@@ -542,11 +758,32 @@ TrialConv2D(
     float* Output = BufferOutput.GetBuffer(OutputBufferElements);
     float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
 
-    MatrixGuardBuffer BufferWorking(WorkingBufferSize, false);
+    MatrixGuardBuffer<float> BufferWorking(WorkingBufferSize, false);
+
+    //
+    // The Winograd algorithm requires the filter to be transformed first.
+    //
+
+    const bool IsWinograd = (Parameters.Algorithm == MlasConvAlgorithmWinograd);
+    const float* ConvFilter = Filter;
+    std::vector<float> TransformedFilter;
+
+    if (IsWinograd) {
+
+        size_t OutputTileSize = Parameters.u.Winograd.OutputTileSize;
+
+        TransformedFilter.resize(MlasConvWinogradGetTransformedFilterSize(OutputTileSize,
+            GroupCount, FilterCount, InputChannels));
+
+        MlasConvWinogradTransformFilter(OutputTileSize, GroupCount, FilterCount,
+            InputChannels, Filter, TransformedFilter.data());
+
+        ConvFilter = TransformedFilter.data();
+    }
 
     MlasConv(&Parameters,
              Input,
-             Filter,
+             ConvFilter,
              Bias,
              BufferWorking.GetBuffer(WorkingBufferSize),
              Output);
@@ -566,13 +803,63 @@ TrialConv2D(
                     Bias,
                     OutputReference);
 
-    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+    if (IsWinograd) {
+
+        //
+        // The Winograd transforms do not produce bit exact results, so compare
+        // against a tolerance relative to the magnitude of the output.
+        //
+
+        float MaximumReference = 1.0f;
+
+        for (size_t i = 0; i < OutputBufferElements; i++) {
+            MaximumReference = std::max(MaximumReference, std::fabs(OutputReference[i]));
+        }
+
+        const float Tolerance = MaximumReference * 1e-4f;
+
+        for (size_t i = 0; i < OutputBufferElements; i++) {
+            if (std::fabs(Output[i] - OutputReference[i]) > Tolerance) {
+                printf("mismatch winograd: batch=%zd,group=%zd,input(%zd,%zd,%zd),filter=%zd,pad(%zd,%zd,%zd,%zd)!!!\n",
+                    BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+                    PaddingLeftHeight, PaddingLeftWidth, PaddingRightHeight, PaddingRightWidth);
+                break;
+            }
+        }
+
+    } else if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
         printf("mismatch: batch=%zd,group=%zd,input(%zd,%zd,%zd),filter=%zd,kernel(%zd,%zd)!!!\n",
             BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
             KernelHeight, KernelWidth);
     }
 }
 
+void
+ExecuteWinogradConvTests(
+    void
+    )
+{
+    static const unsigned cs[] = { 32, 48, 64 };
+
+    for (unsigned i = 1; i <= 19; i++) {
+        for (unsigned j = 1; j <= 19; j++) {
+            TrialConv2D(1, 1, 32, i, j, 32, 3, 3, 0, 0, 0, 0, 1, 1, 1, 1);
+            TrialConv2D(1, 1, 32, i, j, 32, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1);
+            TrialConv2D(1, 1, 32, i, j, 32, 3, 3, 1, 0, 2, 1, 1, 1, 1, 1);
+        }
+    }
+
+    for (unsigned ic = 0; ic < _countof(cs); ic++) {
+        for (unsigned fc = 0; fc < _countof(cs); fc++) {
+            TrialConv2D(1, 1, cs[ic], 28, 28, cs[fc], 3, 3, 1, 1, 1, 1, 1, 1, 1, 1);
+            TrialConv2D(3, 2, cs[ic], 14, 9, cs[fc], 3, 3, 1, 1, 1, 1, 1, 1, 1, 1);
+        }
+    }
+
+    TrialConv2D(1, 1, 64, 56, 56, 64, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1);
+    TrialConv2D(2, 1, 256, 14, 14, 256, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1);
+}
+
 void
 ExecuteConvTests(
     void
@@ -851,6 +1138,76 @@ ReferenceAveragePool2D(
     }
 }
 
+void
+ReferenceLpPool2D(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const float* Input,
+    float* Output,
+    int p
+    )
+{
+    int64_t ChannelCount = InputShape[0] * InputShape[1];
+
+    int64_t InputHeight = InputShape[2];
+    int64_t InputWidth = InputShape[3];
+
+    int64_t KernelHeight = KernelShape[0];
+    int64_t KernelWidth = KernelShape[1];
+
+    int64_t PaddingLeftY = Padding[0];
+    int64_t PaddingLeftX = Padding[1];
+    int64_t PaddingRightY = Padding[2];
+    int64_t PaddingRightX = Padding[3];
+
+    int64_t StrideHeight = StrideShape[0];
+    int64_t StrideWidth = StrideShape[1];
+
+    int64_t OutputHeight = (InputHeight + PaddingLeftY + PaddingRightY - KernelHeight) / StrideHeight + 1;
+    int64_t OutputWidth = (InputWidth + PaddingLeftX + PaddingRightX - KernelWidth) / StrideWidth + 1;
+
+    for (int64_t c = 0; c < ChannelCount; c++) {
+
+        for (int64_t ph = 0; ph < OutputHeight; ph++) {
+
+            int64_t ihStart = ph * StrideHeight - PaddingLeftY;
+            int64_t ihEnd = ihStart + KernelHeight;
+
+            ihStart = (std::max)(ihStart, int64_t(0));
+            ihEnd = (std::min)(ihEnd, InputHeight);
+
+            for (int64_t pw = 0; pw < OutputWidth; pw++) {
+
+                int64_t iwStart = pw * StrideWidth - PaddingLeftX;
+                int64_t iwEnd = iwStart + KernelWidth;
+
+                iwStart = (std::max)(iwStart, int64_t(0));
+                iwEnd = (std::min)(iwEnd, InputWidth);
+
+                float m = 0.0f;
+
+                for (int64_t ih = ihStart; ih < ihEnd; ih++) {
+                    for (int64_t iw = iwStart; iw < iwEnd; iw++) {
+                        float Value = Input[ih * InputWidth + iw];
+                        m += (p == 1) ? std::fabs(Value) : Value * Value;
+                    }
+                }
+
+                if (p == 2) {
+                    m = std::sqrt(m);
+                }
+
+                Output[ph * OutputWidth + pw] = m;
+            }
+        }
+
+        Input += InputHeight * InputWidth;
+        Output += OutputHeight * OutputWidth;
+    }
+}
+
 void
 ReferenceAveragePool3D(
     const int64_t* InputShape,
@@ -967,9 +1324,9 @@ TrialPool2D(
     size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3]);
     size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3]);
 
-    MatrixGuardBuffer BufferInput(InputBufferElements, true);
-    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
-    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+    MatrixGuardBuffer<float> BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer<float> BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer<float> BufferOutputReference(OutputBufferElements, false);
 
     const float* Input = BufferInput.GetBuffer(InputBufferElements);
     float* Output = BufferOutput.GetBuffer(OutputBufferElements);
@@ -998,74 +1355,187 @@ TrialPool2D(
         printf("mismatch: averageincpad input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
             InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
     }
+
+    MlasPool(MlasL1NormPooling, 2, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
+    ReferenceLpPool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, 1);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: l1norm input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+
+    MlasPool(MlasL2NormPooling, 2, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
+    ReferenceLpPool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, 2);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: l2norm input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
 }
 
 void
-TrialPool3D(
+TrialPool1D(
     size_t BatchCount,
     size_t InputChannels,
-    size_t InputDepth,
-    size_t InputHeight,
     size_t InputWidth,
-    size_t KernelDepth,
-    size_t KernelHeight,
     size_t KernelWidth,
-    size_t PaddingLeftDepth,
-    size_t PaddingLeftHeight,
     size_t PaddingLeftWidth,
-    size_t PaddingRightDepth,
-    size_t PaddingRightHeight,
     size_t PaddingRightWidth,
-    size_t StrideDepth,
-    size_t StrideHeight,
     size_t StrideWidth
     )
 {
-    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputDepth), int64_t(InputHeight), int64_t(InputWidth) };
-    int64_t KernelShape[] = { int64_t(KernelDepth), int64_t(KernelHeight), int64_t(KernelWidth) };
-    int64_t Padding[] = { int64_t(PaddingLeftDepth), int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightDepth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
-    int64_t StrideShape[] = { int64_t(StrideDepth), int64_t(StrideHeight), int64_t(StrideWidth) };
-    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0, 0 };
+    //
+    // The reference implementations are the 2D routines with a unit height.
+    //
 
-    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[3] - KernelShape[0]) / StrideShape[0] + 1;
-    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[4] - KernelShape[1]) / StrideShape[1] + 1;
-    OutputShape[4] = (InputShape[4] + Padding[2] + Padding[5] - KernelShape[2]) / StrideShape[2] + 1;
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftWidth), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0 };
 
-    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3] * InputShape[4]);
-    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3] * OutputShape[4]);
+    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[1] - KernelShape[0]) / StrideShape[0] + 1;
+
+    int64_t InputShape2D[] = { InputShape[0], InputShape[1], 1, InputShape[2] };
+    int64_t KernelShape2D[] = { 1, KernelShape[0] };
+    int64_t Padding2D[] = { 0, Padding[0], 0, Padding[1] };
+    int64_t StrideShape2D[] = { 1, StrideShape[0] };
 
-    MatrixGuardBuffer BufferInput(InputBufferElements, true);
-    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
-    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2]);
+    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2]);
+
+    MatrixGuardBuffer<float> BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer<float> BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer<float> BufferOutputReference(OutputBufferElements, false);
 
     const float* Input = BufferInput.GetBuffer(InputBufferElements);
     float* Output = BufferOutput.GetBuffer(OutputBufferElements);
     float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
 
-    MlasPool(MlasMaximumPooling, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
-    ReferenceMaximumPool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference);
+    MlasPool(MlasMaximumPooling, 1, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
+    ReferenceMaximumPool2D(InputShape2D, KernelShape2D, Padding2D, StrideShape2D, Input, OutputReference);
 
     if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
-        printf("mismatch: maximum input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
-            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+        printf("mismatch: maximum input(%zd,%zd),kernel(%zd)!!!\n", InputChannels, InputWidth, KernelWidth);
     }
 
-    MlasPool(MlasAveragePoolingExcludePad, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
-    ReferenceAveragePool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, false);
+    MlasPool(MlasAveragePoolingExcludePad, 1, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
+    ReferenceAveragePool2D(InputShape2D, KernelShape2D, Padding2D, StrideShape2D, Input, OutputReference, false);
 
     if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
-        printf("mismatch: averageexcpad input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
-            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+        printf("mismatch: averageexcpad input(%zd,%zd),kernel(%zd)!!!\n", InputChannels, InputWidth, KernelWidth);
     }
 
-    MlasPool(MlasAveragePoolingIncludePad, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
-    ReferenceAveragePool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, true);
+    MlasPool(MlasAveragePoolingIncludePad, 1, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
+    ReferenceAveragePool2D(InputShape2D, KernelShape2D, Padding2D, StrideShape2D, Input, OutputReference, true);
 
     if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
-        printf("mismatch: averageincpad input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
-            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+        printf("mismatch: averageincpad input(%zd,%zd),kernel(%zd)!!!\n", InputChannels, InputWidth, KernelWidth);
     }
-}
+
+    MlasPool(MlasL1NormPooling, 1, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
+    ReferenceLpPool2D(InputShape2D, KernelShape2D, Padding2D, StrideShape2D, Input, OutputReference, 1);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: l1norm input(%zd,%zd),kernel(%zd)!!!\n", InputChannels, InputWidth, KernelWidth);
+    }
+
+    MlasPool(MlasL2NormPooling, 1, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
+    ReferenceLpPool2D(InputShape2D, KernelShape2D, Padding2D, StrideShape2D, Input, OutputReference, 2);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: l2norm input(%zd,%zd),kernel(%zd)!!!\n", InputChannels, InputWidth, KernelWidth);
+    }
+}
+
+void
+TrialPool3D(
+    size_t BatchCount,
+    size_t InputChannels,
+    size_t InputDepth,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t KernelDepth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftDepth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightDepth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t StrideDepth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputDepth), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelDepth), int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftDepth), int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightDepth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideDepth), int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0, 0 };
+
+    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[3] - KernelShape[0]) / StrideShape[0] + 1;
+    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[4] - KernelShape[1]) / StrideShape[1] + 1;
+    OutputShape[4] = (InputShape[4] + Padding[2] + Padding[5] - KernelShape[2]) / StrideShape[2] + 1;
+
+    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3] * InputShape[4]);
+    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3] * OutputShape[4]);
+
+    MatrixGuardBuffer<float> BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer<float> BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer<float> BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    MlasPool(MlasMaximumPooling, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
+    ReferenceMaximumPool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: maximum input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
+            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+    }
+
+    MlasPool(MlasAveragePoolingExcludePad, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
+    ReferenceAveragePool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, false);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: averageexcpad input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
+            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+    }
+
+    MlasPool(MlasAveragePoolingIncludePad, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
+    ReferenceAveragePool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, true);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: averageincpad input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
+            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+    }
+}
+
+void
+ExecutePool1DTests(
+    void
+    )
+{
+    static const unsigned is[] = { 53, 17, 11, 5, 4, 3, 2, 1 };
+
+    for (unsigned iw = 0; iw < _countof(is); iw++) {
+        TrialPool1D(2, 3, is[iw], is[iw], 0, 0, 1);
+        for (unsigned kw = 1; kw <= 5; kw++) {
+            for (unsigned p0 = 0; p0 < kw; p0++) {
+                for (unsigned p1 = 0; p1 < kw; p1++) {
+                    if (is[iw] + p0 + p1 < kw) continue;
+                    for (unsigned sw = 1; sw <= 3; sw++) {
+                        TrialPool1D(2, 3, is[iw], kw, p0, p1, sw);
+                    }
+                }
+            }
+        }
+    }
+}
 
 void
 ExecutePool2DTests(
@@ -1152,6 +1622,559 @@ ExecutePool3DTests(
     }
 }
 
+void
+TrialNchwcConv2D(
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t FilterCount,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t DilationHeight,
+    size_t DilationWidth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    const size_t BlockSize = MlasNchwcGetBlockSize();
+
+    int64_t OutputHeight64 =
+        ((int64_t(InputHeight) + int64_t(PaddingLeftHeight) + int64_t(PaddingRightHeight)) -
+        (int64_t(DilationHeight) * (int64_t(KernelHeight) - 1) + 1)) / int64_t(StrideHeight) + 1;
+    int64_t OutputWidth64 =
+        ((int64_t(InputWidth) + int64_t(PaddingLeftWidth) + int64_t(PaddingRightWidth)) -
+        (int64_t(DilationWidth) * (int64_t(KernelWidth) - 1) + 1)) / int64_t(StrideWidth) + 1;
+
+    if (OutputHeight64 <= 0 || OutputWidth64 <= 0) {
+        return;
+    }
+
+    size_t OutputHeight = size_t(OutputHeight64);
+    size_t OutputWidth = size_t(OutputWidth64);
+
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(GroupCount * InputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t FilterShape[] = { int64_t(GroupCount * FilterCount), int64_t(InputChannels), int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t DilationShape[] = { int64_t(DilationHeight), int64_t(DilationWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(GroupCount * FilterCount), OutputHeight64, OutputWidth64 };
+
+    size_t InputBufferElements = BatchCount * GroupCount * InputChannels * InputHeight * InputWidth;
+    size_t FilterBufferElements = GroupCount * FilterCount * InputChannels * KernelHeight * KernelWidth;
+    size_t BiasBufferElements = GroupCount * FilterCount;
+    size_t OutputBufferElements = BatchCount * GroupCount * FilterCount * OutputHeight * OutputWidth;
+
+    MatrixGuardBuffer<float> BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer<float> BufferFilter(FilterBufferElements, true);
+    MatrixGuardBuffer<float> BufferBias(BiasBufferElements, true);
+    MatrixGuardBuffer<float> BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer<float> BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    const float* Filter = BufferFilter.GetBuffer(FilterBufferElements);
+    const float* Bias = BufferBias.GetBuffer(BiasBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    //
+    // Reorder the input and the filter to the layouts expected by the
+    // algorithm that MlasNchwcConv selects for these shapes.
+    //
+
+    std::vector<float> NchwcInput(InputBufferElements);
+    std::vector<float> NchwcFilter(FilterBufferElements);
+    std::vector<float> NchwcOutput(OutputBufferElements);
+
+    const bool Depthwise = (GroupCount > 1 && InputChannels == 1 && FilterCount == 1);
+
+    if (GroupCount == 1 && InputChannels < BlockSize) {
+        std::copy(Input, Input + InputBufferElements, NchwcInput.begin());
+    } else {
+        MlasReorderInput(InputShape, Input, NchwcInput.data());
+    }
+
+    if (Depthwise || InputChannels < BlockSize) {
+        MlasReorderFilterOIHWBo(FilterShape, Filter, NchwcFilter.data());
+    } else {
+        MlasReorderFilterOIHWBiBo(FilterShape, Filter, NchwcFilter.data());
+    }
+
+    MLAS_ACTIVATION Activation;
+    Activation.ActivationKind = MlasIdentityActivation;
+
+    MlasNchwcConv(InputShape,
+                  KernelShape,
+                  DilationShape,
+                  Padding,
+                  StrideShape,
+                  OutputShape,
+                  GroupCount,
+                  NchwcInput.data(),
+                  NchwcFilter.data(),
+                  Bias,
+                  NchwcOutput.data(),
+                  &Activation,
+                  true);
+
+    MlasReorderOutput(OutputShape, NchwcOutput.data(), Output);
+
+    ReferenceConv2D(BatchCount,
+                    GroupCount,
+                    InputChannels,
+                    InputHeight, InputWidth,
+                    FilterCount,
+                    KernelHeight, KernelWidth,
+                    PaddingLeftHeight, PaddingLeftWidth,
+                    DilationHeight, DilationWidth,
+                    StrideHeight, StrideWidth,
+                    OutputHeight, OutputWidth,
+                    Input,
+                    Filter,
+                    Bias,
+                    OutputReference);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: nchwc batch=%zd,group=%zd,input(%zd,%zd,%zd),filter=%zd,kernel(%zd,%zd)!!!\n",
+            BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+            KernelHeight, KernelWidth);
+    }
+}
+
+void
+ExecuteNchwcConvTests(
+    void
+    )
+{
+    const size_t BlockSize = MlasNchwcGetBlockSize();
+
+    if (BlockSize == 1) {
+        return;
+    }
+
+    static const unsigned is[] = { 27, 11, 5, 1 };
+
+    for (unsigned ih = 0; ih < _countof(is); ih++) {
+        for (unsigned iw = 0; iw < _countof(is); iw++) {
+            fprintf(stderr, "Handling NCHWc %dx%d\n", is[ih], is[iw]);
+            for (unsigned kh = 1; kh <= 5; kh += 2) {
+                for (unsigned kw = 1; kw <= 5; kw += 2) {
+                    for (unsigned p = 0; p < 3; p++) {
+                        for (unsigned d = 1; d <= 2; d++) {
+                            for (unsigned s = 1; s <= 2; s++) {
+                                TrialNchwcConv2D(1, 1, BlockSize * 2, is[ih], is[iw], BlockSize * 5, kh, kw, p, p, p / 2, p / 2, d, d, s, s);
+                                TrialNchwcConv2D(1, 1, 3, is[ih], is[iw], BlockSize * 3, kh, kw, p, p, p, p, d, d, s, s);
+                                TrialNchwcConv2D(1, BlockSize * 2, 1, is[ih], is[iw], 1, kh, kw, p, p, p, p, d, d, s, s);
+                                TrialNchwcConv2D(2, 2, BlockSize, is[ih], is[iw], BlockSize, kh, kw, p / 2, p, p, p / 2, d, 1, 1, s);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+TrialNchwcPool2D(
+    size_t BatchCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0 };
+
+    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[2] - KernelShape[0]) / StrideShape[0] + 1;
+    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[3] - KernelShape[1]) / StrideShape[1] + 1;
+
+    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3]);
+    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3]);
+
+    MatrixGuardBuffer<float> BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer<float> BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer<float> BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    std::vector<float> NchwcInput(InputBufferElements);
+    std::vector<float> NchwcOutput(OutputBufferElements);
+
+    MlasReorderInput(InputShape, Input, NchwcInput.data());
+
+    static const MLAS_POOLING_KIND PoolingKinds[] = {
+        MlasMaximumPooling, MlasAveragePoolingExcludePad, MlasAveragePoolingIncludePad
+    };
+
+    for (unsigned k = 0; k < _countof(PoolingKinds); k++) {
+
+        MlasNchwcPool(PoolingKinds[k], InputShape, KernelShape, Padding, StrideShape, OutputShape, NchwcInput.data(), NchwcOutput.data());
+        MlasReorderOutput(OutputShape, NchwcOutput.data(), Output);
+
+        MlasPool(PoolingKinds[k], 2, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, OutputReference);
+
+        if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+            printf("mismatch: nchwc pool kind=%u input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+                k, InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+        }
+    }
+}
+
+void
+ExecuteNchwcPoolTests(
+    void
+    )
+{
+    const size_t BlockSize = MlasNchwcGetBlockSize();
+
+    if (BlockSize == 1) {
+        return;
+    }
+
+    static const unsigned is[] = { 53, 17, 11, 5, 4, 3, 2, 1 };
+
+    for (unsigned ih = 0; ih < _countof(is); ih++) {
+        for (unsigned iw = 0; iw < _countof(is); iw++) {
+            fprintf(stderr, "Handling NCHWc %dx%d\n", is[ih], is[iw]);
+            TrialNchwcPool2D(1, BlockSize, is[ih], is[iw], is[ih], is[iw], 0, 0, 0, 0, 1, 1);
+            for (unsigned kh = 1; kh <= 3; kh++) {
+                if (kh > is[ih]) break;
+                for (unsigned kw = 1; kw <= 3; kw++) {
+                    if (kw > is[iw]) break;
+                    for (unsigned s = 1; s <= 2; s++) {
+                        for (unsigned p0 = 0; p0 < kh; p0++) {
+                            for (unsigned p1 = 0; p1 < kw; p1++) {
+                                TrialNchwcPool2D(2, BlockSize * 2, is[ih], is[iw], kh, kw, p0, p1, kh - 1 - p0, p1, s, s);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+ReferenceBroadcastBinaryOperation(
+    MLAS_BINARY_OPERATION_KIND OperationKind,
+    size_t Dimensions,
+    const int64_t* InputShapeA,
+    const int64_t* InputShapeB,
+    const int64_t* OutputShape,
+    const float* InputA,
+    const float* InputB,
+    float* Output
+    )
+{
+    size_t OutputSize = 1;
+
+    for (size_t d = 0; d < Dimensions; d++) {
+        OutputSize *= size_t(OutputShape[d]);
+    }
+
+    for (size_t i = 0; i < OutputSize; i++) {
+
+        size_t Remainder = i;
+        size_t IndexA = 0;
+        size_t IndexB = 0;
+        size_t StrideA = 1;
+        size_t StrideB = 1;
+
+        for (size_t d = Dimensions; d > 0; d--) {
+
+            size_t Coordinate = Remainder % size_t(OutputShape[d - 1]);
+            Remainder /= size_t(OutputShape[d - 1]);
+
+            if (InputShapeA[d - 1] != 1) {
+                IndexA += Coordinate * StrideA;
+            }
+
+            if (InputShapeB[d - 1] != 1) {
+                IndexB += Coordinate * StrideB;
+            }
+
+            StrideA *= size_t(InputShapeA[d - 1]);
+            StrideB *= size_t(InputShapeB[d - 1]);
+        }
+
+        float a = InputA[IndexA];
+        float b = InputB[IndexB];
+
+        switch (OperationKind) {
+            case MlasAddOperation: Output[i] = a + b; break;
+            case MlasSubtractOperation: Output[i] = a - b; break;
+            case MlasMultiplyOperation: Output[i] = a * b; break;
+            case MlasDivideOperation: Output[i] = a / b; break;
+            case MlasMaximumOperation: Output[i] = (a > b) ? a : b; break;
+            case MlasMinimumOperation: Output[i] = (a < b) ? a : b; break;
+        }
+    }
+}
+
+void
+TrialBroadcastBinaryOperation(
+    size_t Dimensions,
+    const int64_t* Shape,
+    unsigned BroadcastMaskA,
+    unsigned BroadcastMaskB
+    )
+{
+    int64_t InputShapeA[MLAS_MAXIMUM_BROADCAST_DIMENSIONS];
+    int64_t InputShapeB[MLAS_MAXIMUM_BROADCAST_DIMENSIONS];
+    int64_t OutputShape[MLAS_MAXIMUM_BROADCAST_DIMENSIONS];
+
+    size_t InputSizeA = 1;
+    size_t InputSizeB = 1;
+    size_t OutputSize = 1;
+
+    for (size_t d = 0; d < Dimensions; d++) {
+        InputShapeA[d] = (BroadcastMaskA & (1 << d)) ? 1 : Shape[d];
+        InputShapeB[d] = (BroadcastMaskB & (1 << d)) ? 1 : Shape[d];
+        OutputShape[d] = (std::max)(InputShapeA[d], InputShapeB[d]);
+        InputSizeA *= size_t(InputShapeA[d]);
+        InputSizeB *= size_t(InputShapeB[d]);
+        OutputSize *= size_t(OutputShape[d]);
+    }
+
+    MatrixGuardBuffer<float> BufferInputA(InputSizeA, true);
+    MatrixGuardBuffer<float> BufferInputB(InputSizeB + 1, true);
+    MatrixGuardBuffer<float> BufferOutput(OutputSize, false);
+    MatrixGuardBuffer<float> BufferOutputReference(OutputSize, false);
+
+    const float* InputA = BufferInputA.GetBuffer(InputSizeA);
+    const float* InputB = BufferInputB.GetBuffer(InputSizeB + 1);
+    float* Output = BufferOutput.GetBuffer(OutputSize);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputSize);
+
+    static const MLAS_BINARY_OPERATION_KIND OperationKinds[] = {
+        MlasAddOperation, MlasSubtractOperation, MlasMultiplyOperation,
+        MlasDivideOperation, MlasMaximumOperation, MlasMinimumOperation
+    };
+
+    for (unsigned k = 0; k < _countof(OperationKinds); k++) {
+
+        MlasBroadcastBinaryOperation(OperationKinds[k], Dimensions, InputShapeA, InputShapeB, OutputShape, InputA, InputB, Output);
+        ReferenceBroadcastBinaryOperation(OperationKinds[k], Dimensions, InputShapeA, InputShapeB, OutputShape, InputA, InputB, OutputReference);
+
+        if (memcmp(Output, OutputReference, OutputSize * sizeof(float)) != 0) {
+            printf("mismatch: broadcast kind=%u dims=%zd maskA=%x maskB=%x!!!\n",
+                k, Dimensions, BroadcastMaskA, BroadcastMaskB);
+        }
+    }
+}
+
+void
+ExecuteBroadcastTests(
+    void
+    )
+{
+    static const int64_t Shapes[][4] = {
+        { 2, 3, 5, 9 },
+        { 3, 1, 7, 4 },
+        { 1, 17, 1, 33 },
+    };
+
+    for (unsigned s = 0; s < _countof(Shapes); s++) {
+        for (size_t Dimensions = 1; Dimensions <= 4; Dimensions++) {
+            for (unsigned ma = 0; ma < (1u << Dimensions); ma++) {
+                for (unsigned mb = 0; mb < (1u << Dimensions); mb++) {
+                    TrialBroadcastBinaryOperation(Dimensions, Shapes[s], ma, mb);
+                }
+            }
+        }
+    }
+
+    //
+    // Test shapes that are large enough to partition across threads.
+    //
+
+    static const int64_t LargeShape[] = { 4, 64, 33, 65 };
+
+    TrialBroadcastBinaryOperation(4, LargeShape, 0, 0);
+    TrialBroadcastBinaryOperation(4, LargeShape, 0, 0xD);
+    TrialBroadcastBinaryOperation(4, LargeShape, 0, 0x7);
+    TrialBroadcastBinaryOperation(4, LargeShape, 0xF, 0);
+    TrialBroadcastBinaryOperation(4, LargeShape, 0x3, 0xC);
+}
+
+void
+TrialTranspose(
+    size_t M,
+    size_t N,
+    size_t lda,
+    size_t ldb
+    )
+{
+    MatrixGuardBuffer<uint32_t> BufferInput(M * lda, false);
+    MatrixGuardBuffer<uint32_t> BufferOutput(N * ldb, false);
+
+    uint32_t* Input = BufferInput.GetBuffer(M * lda);
+    uint32_t* Output = BufferOutput.GetBuffer(N * ldb);
+
+    for (size_t i = 0; i < M * lda; i++) {
+        Input[i] = uint32_t(i * 2654435761u);
+    }
+
+    //
+    // Fill the output with a pattern to detect writes outside of the matrix.
+    //
+
+    std::fill_n(Output, N * ldb, 0xCDCDCDCDu);
+
+    MlasTranspose(M, N, Input, lda, Output, ldb);
+
+    for (size_t n = 0; n < N; n++) {
+        for (size_t m = 0; m < ldb; m++) {
+            uint32_t Expected = (m < M) ? Input[m * lda + n] : 0xCDCDCDCDu;
+            if (Output[n * ldb + m] != Expected) {
+                printf("mismatch: transpose M=%zd N=%zd lda=%zd ldb=%zd!!!\n", M, N, lda, ldb);
+                return;
+            }
+        }
+    }
+}
+
+void
+ExecuteTransposeTests(
+    void
+    )
+{
+    for (size_t M = 1; M <= 20; M++) {
+        for (size_t N = 1; N <= 20; N++) {
+            TrialTranspose(M, N, N, M);
+            TrialTranspose(M, N, N + 3, M + 5);
+        }
+    }
+
+    TrialTranspose(67, 129, 129, 67);
+    TrialTranspose(256, 96, 100, 260);
+}
+
+void
+TrialExp(
+    size_t N
+    )
+{
+    MatrixGuardBuffer<float> BufferInput(N, false);
+    MatrixGuardBuffer<float> BufferOutput(N, false);
+
+    float* Input = BufferInput.GetBuffer(N);
+    float* Output = BufferOutput.GetBuffer(N);
+
+    for (size_t i = 0; i < N; i++) {
+        Input[i] = -87.0f + float((i * 2654435761u) % 1751) * 0.1f;
+    }
+
+    MlasComputeExp(Input, Output, N);
+
+    for (size_t i = 0; i < N; i++) {
+        float Expected = std::exp(Input[i]);
+        if (!(std::fabs(Output[i] - Expected) <= Expected * 1e-6f + std::numeric_limits<float>::min())) {
+            printf("mismatch: exp N=%zd i=%zd %.9g %.9g!!!\n", N, i, Output[i], Expected);
+            return;
+        }
+    }
+}
+
+void
+ExecuteExpTests(
+    void
+    )
+{
+    for (size_t N = 1; N <= 40; N++) {
+        TrialExp(N);
+    }
+
+    TrialExp(1751);
+}
+
+void
+TrialSoftmax(
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    )
+{
+    MatrixGuardBuffer<float> BufferInput(N * D, false);
+    MatrixGuardBuffer<float> BufferOutput(N * D, false);
+
+    float* Input = BufferInput.GetBuffer(N * D);
+    float* Output = BufferOutput.GetBuffer(N * D);
+
+    for (size_t i = 0; i < N * D; i++) {
+        Input[i] = -20.0f + float((i * 2654435761u) % 401) * 0.1f;
+    }
+
+    MlasComputeSoftmax(Input, Output, N, D, LogSoftmax);
+
+    for (size_t n = 0; n < N; n++) {
+
+        const float* InputRow = Input + n * D;
+        const float* OutputRow = Output + n * D;
+
+        double Maximum = *std::max_element(InputRow, InputRow + D);
+        double Sum = 0.0;
+
+        for (size_t d = 0; d < D; d++) {
+            Sum += std::exp(double(InputRow[d]) - Maximum);
+        }
+
+        for (size_t d = 0; d < D; d++) {
+
+            double Expected = double(InputRow[d]) - Maximum - std::log(Sum);
+            double Tolerance = 1e-5;
+
+            if (!LogSoftmax) {
+                Expected = std::exp(Expected);
+                Tolerance = 1e-5 * Expected + 1e-30;
+            }
+
+            if (!(std::fabs(OutputRow[d] - Expected) <= Tolerance)) {
+                printf("mismatch: %s N=%zd D=%zd n=%zd d=%zd %.9g %.9g!!!\n",
+                    LogSoftmax ? "logsoftmax" : "softmax", N, D, n, d, OutputRow[d], Expected);
+                return;
+            }
+        }
+    }
+}
+
+void
+ExecuteSoftmaxTests(
+    void
+    )
+{
+    for (size_t D = 1; D <= 40; D++) {
+        TrialSoftmax(3, D, false);
+        TrialSoftmax(3, D, true);
+    }
+
+    TrialSoftmax(1, 1000, false);
+    TrialSoftmax(1, 1000, true);
+    TrialSoftmax(100, 509, false);
+    TrialSoftmax(100, 509, true);
+    TrialSoftmax(1000, 64, false);
+}
+
 #if 0
 #if defined(_WIN32)
 
@@ -1168,9 +2191,9 @@ EvaluateThreadingPerformance(
 
     const size_t MaximumDimension = 4096;
 
-    MatrixGuardBuffer BufferA(MaximumDimension, true);
-    MatrixGuardBuffer BufferB(MaximumDimension, true);
-    MatrixGuardBuffer BufferC(MaximumDimension, false);
+    MatrixGuardBuffer<float> BufferA(MaximumDimension, true);
+    MatrixGuardBuffer<float> BufferB(MaximumDimension, true);
+    MatrixGuardBuffer<float> BufferC(MaximumDimension, false);
 
     for (size_t M = 16; M <= MaximumDimension; M <<= 1) {
         for (size_t N = 16; N <= MaximumDimension; N <<= 1) {
@@ -1239,7 +2262,17 @@ main(
     )
 {
 //    ExecuteSgemmTests();
+    ExecuteSgemmPackedTests();
+    ExecuteQgemmTests();
     ExecuteConvTests();
+    ExecuteWinogradConvTests();
+    ExecuteNchwcConvTests();
+    ExecuteNchwcPoolTests();
+    ExecutePool1DTests();
+    ExecuteBroadcastTests();
+    ExecuteTransposeTests();
+    ExecuteExpTests();
+    ExecuteSoftmaxTests();
 //    ExecutePool2DTests();
 //    ExecutePool3DTests();
 //    EvaluateThreadingPerformance();
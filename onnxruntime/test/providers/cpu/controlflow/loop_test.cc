@@ -487,6 +487,97 @@ TEST(Loop, InfiniteLoopTermination) {
   terminator_thread.join();
 }
 
+// Create a subgraph where the loop carried variable changes shape. If grow is true, outer_scope_0 is appended to
+// loop_var_0 in every iteration, so the shape of the feed changes in every iteration. Otherwise loop_var_0 is summed
+// to a single value and outer_scope_0 is added to that, so the shape of the feed changes after the first iteration
+// only, and the following iterations are executed with the same feed shapes.
+static const ONNX_NAMESPACE::GraphProto CreateShapeChangingSubgraph(bool grow) {
+  Model model("Shape changing loop subgraph");
+  auto& graph = model.MainGraph();
+
+  /*
+       iter_num_in    cond_in     loop_var_0_in   [outer_scope_0]
+         (unused)        |             |                |
+                     [Identity]        |                |
+                         |       [ReduceSum]            |
+                      cond_out         |                |
+                                    [Concat] or [Add] <-+
+                                       |
+                                  loop_var_0_out
+  */
+
+  TypeProto int64_scalar;
+  int64_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+  int64_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+  TypeProto bool_scalar;
+  bool_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+  bool_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim();
+
+  auto& iter_num_in = graph.GetOrCreateNodeArg("iter_num_in", &int64_scalar);
+  auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar);
+  auto& loop_var_0_in = graph.GetOrCreateNodeArg("loop_var_0_in", &float_tensor);
+
+  auto& outer_scope_0 = graph.GetOrCreateNodeArg("outer_scope_0", &float_tensor);
+  graph.AddOuterScopeNodeArg("outer_scope_0");
+
+  auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar);
+  auto& loop_var_0_out = graph.GetOrCreateNodeArg("loop_var_0_out", &float_tensor);
+
+  graph.AddNode("cond_in_identity", "Identity", "Forward cond_in to cond_out", {&cond_in}, {&cond_out});
+
+  if (grow) {
+    auto& concat = graph.AddNode("concat", "Concat", "Append outer_scope_0 to loop_var_0",
+                                 {&loop_var_0_in, &outer_scope_0}, {&loop_var_0_out});
+    concat.AddAttribute("axis", int64_t{0});
+  } else {
+    auto& sum = graph.GetOrCreateNodeArg("sum", &float_tensor);
+    auto& reduce_sum = graph.AddNode("reduce_sum", "ReduceSum", "Sum loop_var_0", {&loop_var_0_in}, {&sum});
+    reduce_sum.AddAttribute("axes", std::vector<int64_t>{0});
+    reduce_sum.AddAttribute("keepdims", int64_t{1});
+    graph.AddNode("add", "Add", "Add outer_scope_0 to the sum", {&sum, &outer_scope_0}, {&loop_var_0_out});
+  }
+
+  graph.SetInputOrder({&iter_num_in, &cond_in, &loop_var_0_in});
+  graph.SetOutputOrder({&cond_out, &loop_var_0_out});
+
+  auto status = graph.Resolve();
+  EXPECT_EQ(status, Status::OK());
+
+  return graph.ToGraphProto();
+}
+
+// the execution frame is re-initialized for the new feed shape in every iteration
+TEST(Loop, LoopCarriedShapeChangesEveryIteration) {
+  LoopOpTester test{{}, [](const RunOptions&) { return CreateShapeChangingSubgraph(true); }};
+
+  test.AddInput<int64_t>("M", {1}, {3});
+  test.AddInput<bool>("cond", {1}, {true});
+  test.AddInput<float>("loop_var_0_orig", {1}, {0.f});
+
+  test.AddOutput<float>("loop_var_0_final", {4}, {0.f, kOuterNodeAddValue, kOuterNodeAddValue, kOuterNodeAddValue});
+
+  test.Run();
+}
+
+// the execution frame is re-initialized for the second iteration, and re-used with its memory pattern after that
+TEST(Loop, LoopCarriedShapeChangesOnce) {
+  LoopOpTester test{{}, [](const RunOptions&) { return CreateShapeChangingSubgraph(false); }};
+
+  test.AddInput<int64_t>("M", {1}, {4});
+  test.AddInput<bool>("cond", {1}, {true});
+  test.AddInput<float>("loop_var_0_orig", {2}, {1.f, 2.f});
+
+  // 1 + 2 is the first sum, and each iteration adds kOuterNodeAddValue
+  test.AddOutput<float>("loop_var_0_final", {1}, {3.f + 4 * kOuterNodeAddValue});
+
+  test.Run();
+}
+
 #ifdef USE_CUDA
 // test that when part of the subgraph run on CUDA it executes successfully
 TEST(Loop, MixedExecutionProviders) {
@@ -1,13 +1,17 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <sstream>
+
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include "core/framework/session_state.h"
 #include "core/session/inference_session.h"
 #include "core/providers/common.h"
 #include "core/providers/cpu/controlflow/scan_utils.h"
+#include "test/framework/test_utils.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/test_environment.h"
 #include "test/util/include/default_providers.h"
 
 using namespace ONNX_NAMESPACE;
@@ -1145,6 +1149,105 @@ void UnknownDimInSubgraphOutput(bool is_v8) {
 
 TEST_8_AND_9(UnknownDimInSubgraphOutput);
 
+// Run the same Scan node with different input shapes in one session, so the subgraph execution frame has to
+// re-plan its memory pattern for the new feed shapes, and re-use it for the remaining iterations of each run.
+TEST(Scan9, FeedShapesChangeBetweenRuns) {
+  Model body_model("ScanBody");
+  auto& body = body_model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("input_size");
+
+  auto& state_in = body.GetOrCreateNodeArg("state_in", &float_tensor);
+  auto& scan_in = body.GetOrCreateNodeArg("scan_in", &float_tensor);
+  auto& sum = body.GetOrCreateNodeArg("sum", &float_tensor);
+  auto& state_out = body.GetOrCreateNodeArg("state_out", &float_tensor);
+  auto& scan_out = body.GetOrCreateNodeArg("scan_out", &float_tensor);
+
+  body.AddNode("add", "Add", "Add scan_in to state_in", {&state_in, &scan_in}, {&sum});
+  body.AddNode("state_identity", "Identity", "Copy sum to state_out", {&sum}, {&state_out});
+  body.AddNode("scan_identity", "Identity", "Copy sum to scan_out", {&sum}, {&scan_out});
+
+  body.SetInputOrder({&state_in, &scan_in});
+  body.SetOutputOrder({&state_out, &scan_out});
+
+  auto status = body.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  Model model("ScanFeedShapesChange");
+  auto& graph = model.MainGraph();
+
+  TypeProto float_sequence;
+  float_sequence.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_sequence.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("sequence_len");
+  float_sequence.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("input_size");
+
+  auto& initial_state = graph.GetOrCreateNodeArg("initial_state", &float_tensor);
+  auto& scan_input = graph.GetOrCreateNodeArg("scan_input", &float_sequence);
+  auto& final_state = graph.GetOrCreateNodeArg("final_state", &float_tensor);
+  auto& scan_output = graph.GetOrCreateNodeArg("scan_output", &float_sequence);
+
+  auto& scan = graph.AddNode("scan", "Scan", "Scan node", {&initial_state, &scan_input}, {&final_state, &scan_output});
+  scan.AddAttribute("body", body.ToGraphProto());
+  scan.AddAttribute("num_scan_inputs", int64_t{1});
+
+  status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  SessionOptions so;
+  so.session_logid = "Scan9.FeedShapesChangeBetweenRuns";
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+
+  std::stringstream model_stream;
+  model.ToProto().SerializeToOstream(&model_stream);
+  ASSERT_TRUE(session_object.Load(model_stream).IsOK());
+  status = session_object.Initialize();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+
+  auto run = [&](const std::vector<int64_t>& state_shape, const std::vector<float>& state_values,
+                 const std::vector<int64_t>& seq_shape, const std::vector<float>& seq_values,
+                 const std::vector<float>& expected_final_state, const std::vector<float>& expected_scan_output) {
+    NameMLValMap feeds;
+    MLValue state_mlvalue;
+    CreateMLValue<float>(allocator, state_shape, state_values, &state_mlvalue);
+    feeds.insert(std::make_pair("initial_state", state_mlvalue));
+    MLValue seq_mlvalue;
+    CreateMLValue<float>(allocator, seq_shape, seq_values, &seq_mlvalue);
+    feeds.insert(std::make_pair("scan_input", seq_mlvalue));
+
+    std::vector<MLValue> fetches;
+    auto run_status = session_object.Run(feeds, {"final_state", "scan_output"}, &fetches);
+    ASSERT_TRUE(run_status.IsOK()) << run_status.ErrorMessage();
+    ASSERT_EQ(fetches.size(), 2u);
+
+    const auto& final_state_tensor = fetches[0].Get<Tensor>();
+    EXPECT_EQ(final_state_tensor.Shape(), TensorShape(state_shape));
+    const float* final_state_data = final_state_tensor.Data<float>();
+    EXPECT_THAT(std::vector<float>(final_state_data, final_state_data + final_state_tensor.Shape().Size()),
+                ::testing::ElementsAreArray(expected_final_state));
+
+    const auto& scan_output_tensor = fetches[1].Get<Tensor>();
+    EXPECT_EQ(scan_output_tensor.Shape(), TensorShape(seq_shape));
+    const float* scan_output_data = scan_output_tensor.Data<float>();
+    EXPECT_THAT(std::vector<float>(scan_output_data, scan_output_data + scan_output_tensor.Shape().Size()),
+                ::testing::ElementsAreArray(expected_scan_output));
+  };
+
+  run({2}, {0.f, 0.f}, {3, 2}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f},
+      {9.f, 12.f}, {1.f, 2.f, 4.f, 6.f, 9.f, 12.f});
+
+  // different input size and sequence length
+  run({3}, {1.f, 1.f, 1.f}, {2, 3}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f},
+      {6.f, 8.f, 10.f}, {2.f, 3.f, 4.f, 6.f, 8.f, 10.f});
+
+  // back to the original shapes
+  run({2}, {1.f, 1.f}, {3, 2}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f},
+      {10.f, 13.f}, {2.f, 3.f, 5.f, 7.f, 10.f, 13.f});
+}
+
 #ifdef USE_CUDA
 TEST(Scan, MixedExecutionProviders) {
   RunOptions options{};
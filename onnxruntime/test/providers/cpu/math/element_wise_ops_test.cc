@@ -238,6 +238,27 @@ TEST(MathOpTest, Mul) {
   test.Run();
 }
 
+TEST(MathOpTest, Mul_Broadcast_PerChannel) {
+  OpTester test("Mul");
+
+  const int64_t N = 2, C = 3, HW = 11;
+  std::vector<float> A(N * C * HW);
+  std::vector<float> B(C);
+  std::vector<float> Y(A.size());
+  for (int64_t c = 0; c < C; c++) {
+    B[c] = static_cast<float>(c + 2);
+  }
+  for (size_t i = 0; i < A.size(); i++) {
+    A[i] = static_cast<float>(i % 13) - 6.0f;
+    Y[i] = A[i] * B[(i / HW) % C];
+  }
+
+  test.AddInput<float>("A", {N, C, 1, HW}, A);
+  test.AddInput<float>("B", {C, 1, 1}, B);
+  test.AddOutput<float>("C", {N, C, 1, HW}, Y);
+  test.Run();
+}
+
 TEST(MathOpTest, Div_int32) {
   OpTester test("Div");
   test.AddInput<int32_t>("A", {3}, {4, 8, 8});
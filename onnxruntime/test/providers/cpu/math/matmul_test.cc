@@ -77,5 +77,40 @@ TEST(MathOpTest, MatMul) {
   }
 }
 
+// matrix B is a constant initializer, so the kernel can prepack it
+TEST(MathOpTest, MatMulInitializerB) {
+  const int64_t M = 3;
+  const int64_t K = 5;
+  const int64_t N = 21;
+
+  std::vector<float> a_vals(2 * M * K);
+  for (size_t i = 0; i < a_vals.size(); i++) {
+    a_vals[i] = static_cast<float>(i % 7) - 3.0f;
+  }
+  std::vector<float> b_vals(K * N);
+  for (size_t i = 0; i < b_vals.size(); i++) {
+    b_vals[i] = static_cast<float>(i % 5) - 2.0f;
+  }
+
+  std::vector<float> expected_vals(2 * M * N, 0.0f);
+  for (int64_t batch = 0; batch < 2; batch++) {
+    for (int64_t m = 0; m < M; m++) {
+      for (int64_t n = 0; n < N; n++) {
+        float sum = 0.0f;
+        for (int64_t k = 0; k < K; k++) {
+          sum += a_vals[(batch * M + m) * K + k] * b_vals[k * N + n];
+        }
+        expected_vals[(batch * M + m) * N + n] = sum;
+      }
+    }
+  }
+
+  OpTester test("MatMul");
+  test.AddInput<float>("A", {2, M, K}, a_vals);
+  test.AddInput<float>("B", {K, N}, b_vals, true);
+  test.AddOutput<float>("Y", {2, M, N}, expected_vals);
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
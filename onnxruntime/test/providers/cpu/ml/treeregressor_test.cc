@@ -50,5 +50,68 @@ TEST(MLOpTest, TreeRegressorMultiTarget) {
   test.Run();
 }
 
+TEST(MLOpTest, TreeRegressorManyTreesAndRows) {
+  // 100 stumps, large enough that the rows or the trees are split into blocks
+  const int64_t tree_count = 100;
+  for (int64_t N : {1, 3, 150}) {
+    OpTester test("TreeEnsembleRegressor", 1, onnxruntime::kMLDomain);
+
+    std::vector<int64_t> lefts, rights, treeids, nodeids, featureids;
+    std::vector<float> thresholds;
+    std::vector<std::string> modes;
+    std::vector<int64_t> target_treeids, target_nodeids, target_classids;
+    std::vector<float> target_weights;
+    for (int64_t t = 0; t < tree_count; ++t) {
+      lefts.insert(lefts.end(), {1, -1, -1});
+      rights.insert(rights.end(), {2, -1, -1});
+      treeids.insert(treeids.end(), {t, t, t});
+      nodeids.insert(nodeids.end(), {0, 1, 2});
+      featureids.insert(featureids.end(), {t % 3, -2, -2});
+      thresholds.insert(thresholds.end(), {static_cast<float>(t % 10), -2.f, -2.f});
+      modes.insert(modes.end(), {"BRANCH_LEQ", "LEAF", "LEAF"});
+      target_treeids.insert(target_treeids.end(), {t, t});
+      target_nodeids.insert(target_nodeids.end(), {1, 2});
+      target_classids.insert(target_classids.end(), {0, 1});
+      target_weights.insert(target_weights.end(), {1.f, static_cast<float>(t)});
+    }
+
+    std::vector<float> X;
+    std::vector<float> results;
+    for (int64_t i = 0; i < N; ++i) {
+      const float row[3] = {static_cast<float>(i % 11), static_cast<float>((i * 7) % 13), static_cast<float>(i % 5)};
+      X.insert(X.end(), row, row + 3);
+      float left = 0.f;
+      float right = 0.f;
+      for (int64_t t = 0; t < tree_count; ++t) {
+        if (row[t % 3] <= static_cast<float>(t % 10)) {
+          left += 1.f;
+        } else {
+          right += static_cast<float>(t);
+        }
+      }
+      results.push_back(left);
+      results.push_back(right);
+    }
+
+    test.AddAttribute("nodes_truenodeids", lefts);
+    test.AddAttribute("nodes_falsenodeids", rights);
+    test.AddAttribute("nodes_treeids", treeids);
+    test.AddAttribute("nodes_nodeids", nodeids);
+    test.AddAttribute("nodes_featureids", featureids);
+    test.AddAttribute("nodes_values", thresholds);
+    test.AddAttribute("nodes_modes", modes);
+    test.AddAttribute("target_treeids", target_treeids);
+    test.AddAttribute("target_nodeids", target_nodeids);
+    test.AddAttribute("target_ids", target_classids);
+    test.AddAttribute("target_weights", target_weights);
+
+    test.AddAttribute("n_targets", (int64_t)2);
+    test.AddAttribute("aggregate_function", "SUM");
+    test.AddInput<float>("X", {N, 3}, X);
+    test.AddOutput<float>("Y", {N, 2}, results);
+    test.Run();
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
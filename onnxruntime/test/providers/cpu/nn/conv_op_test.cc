@@ -542,5 +542,61 @@ TEST(ConvTest, Conv2D_group) {
   TestConvOp(attrs, {X, W}, {X_shape, W_shape}, expected_vals, Y_shape);
 }
 
+// 3x3 convolutions with enough channels use the Winograd algorithm. A
+// constant filter is transformed once by PrePack for the 4x4 output tile,
+// while smaller outputs and non-constant filters are transformed per call.
+TEST(ConvTest, Conv2D_Winograd) {
+  const int64_t C = 32, M = 40;
+  const int64_t sizes[] = {6, 3};
+  for (int64_t size : sizes) {
+    const int64_t H = size, W = size + 1;
+    vector<float> X(C * H * W);
+    for (size_t i = 0; i < X.size(); i++) {
+      X[i] = static_cast<float>(i % 5) * 0.5f - 1.0f;
+    }
+    vector<float> filter(M * C * 9);
+    for (size_t i = 0; i < filter.size(); i++) {
+      filter[i] = static_cast<float>(i % 7) * 0.125f - 0.375f;
+    }
+    vector<float> B(M);
+    for (int64_t m = 0; m < M; m++) {
+      B[m] = static_cast<float>(m % 3) - 1.0f;
+    }
+
+    // pads of one keep the output the same size as the input
+    vector<float> Y(M * H * W);
+    for (int64_t m = 0; m < M; m++) {
+      for (int64_t oh = 0; oh < H; oh++) {
+        for (int64_t ow = 0; ow < W; ow++) {
+          float sum = B[m];
+          for (int64_t c = 0; c < C; c++) {
+            for (int64_t kh = 0; kh < 3; kh++) {
+              for (int64_t kw = 0; kw < 3; kw++) {
+                const int64_t ih = oh + kh - 1;
+                const int64_t iw = ow + kw - 1;
+                if (ih >= 0 && ih < H && iw >= 0 && iw < W) {
+                  sum += X[(c * H + ih) * W + iw] * filter[((m * C + c) * 3 + kh) * 3 + kw];
+                }
+              }
+            }
+          }
+          Y[(m * H + oh) * W + ow] = sum;
+        }
+      }
+    }
+
+    for (bool is_initializer : {false, true}) {
+      OpTester test("Conv");
+      test.AddAttribute("kernel_shape", vector<int64_t>{3, 3});
+      test.AddAttribute("pads", vector<int64_t>{1, 1, 1, 1});
+      test.AddInput<float>("X", {1, C, H, W}, X);
+      test.AddInput<float>("W", {M, C, 3, 3}, filter, is_initializer);
+      test.AddInput<float>("B", {M}, B, is_initializer);
+      test.AddOutput<float>("Y", {1, M, H, W}, Y);
+      test.Run();
+    }
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
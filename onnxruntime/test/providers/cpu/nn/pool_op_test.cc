@@ -793,6 +793,25 @@ TEST(PoolTest, LpPool) {
   test.Run();
 }
 
+TEST(PoolTest, LpPool1D_L1) {
+  OpTester test("LpPool");
+
+  test.AddAttribute("auto_pad", "");
+  test.AddAttribute("p", static_cast<int64_t>(1));
+  test.AddAttribute("strides", std::vector<int64_t>{2});
+  test.AddAttribute("pads", vector<int64_t>{1, 1});
+  test.AddAttribute("kernel_shape", vector<int64_t>{2});
+
+  std::vector<float> x_vals = {1, -2, 3, -4, 5, -6, 7, -8};
+  std::vector<int64_t> x_dims = {1, 2, 4};
+  std::vector<int64_t> expected_dims = {1, 2, 3};
+  std::vector<float> expected_vals = {1, 5, 4, 5, 13, 8};
+
+  test.AddInput<float>("X", x_dims, x_vals);
+  test.AddOutput<float>("Y", expected_dims, expected_vals);
+  test.Run();
+}
+
 TEST(PoolTest, GlobalLpPool) {
   OpTester test("GlobalLpPool");
   test.AddAttribute("p", static_cast<int64_t>(3));
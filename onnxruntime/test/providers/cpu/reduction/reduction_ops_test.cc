@@ -696,6 +696,63 @@ TEST(ReductionOpTest, ReduceSum_axes02) {
   test.Run();
 }
 
+TEST(ReductionOpTest, ReduceMax_middle_axis) {
+  OpTester test("ReduceMax");
+  test.AddAttribute("axes", std::vector<int64_t>{1});
+  test.AddAttribute("keepdims", (int64_t)1);
+  test.AddInput<float>("data", {2, 3, 2},
+                       {5.0f, 1.0f,
+                        20.0f, 2.0f,
+                        30.0f, 1.0f,
+
+                        1.0f, 2.0f,
+                        3.0f, 9.0f,
+                        2.0f, 30.0f});
+  test.AddOutput<float>("reduced", {2, 1, 2}, {30.0f, 2.0f, 3.0f, 30.0f});
+  test.Run();
+}
+
+TEST(ReductionOpTest, ReduceLogSumExp_leading_axis) {
+  OpTester test("ReduceLogSumExp");
+  test.AddAttribute("axes", std::vector<int64_t>{0});
+  test.AddAttribute("keepdims", (int64_t)0);
+  test.AddInput<float>("data", {3, 2, 2},
+                       {1.0f, 2.0f,
+                        3.0f, 4.0f,
+
+                        5.0f, 6.0f,
+                        7.0f, 8.0f,
+
+                        9.0f, 10.0f,
+                        11.0f, 12.0f});
+  test.AddOutput<float>("reduced", {2, 2}, {9.01847930f, 10.01847930f, 11.01847930f, 12.01847930f});
+  test.Run();
+}
+
+// Reduces the middle axis of a tensor whose inner size spans several blocks
+// of accumulators.
+TEST(ReductionOpTest, ReduceMean_middle_axis_large) {
+  const int64_t outer = 2, reduced = 3, inner = 300;
+  std::vector<float> data(outer * reduced * inner);
+  std::vector<float> expected(outer * inner, 0.0f);
+  for (int64_t o = 0; o < outer; o++) {
+    for (int64_t r = 0; r < reduced; r++) {
+      for (int64_t i = 0; i < inner; i++) {
+        float value = static_cast<float>((o * 7 + r * 3 + i) % 11);
+        data[(o * reduced + r) * inner + i] = value;
+        expected[o * inner + i] += value / reduced;
+      }
+    }
+  }
+
+  OpTester test("ReduceMean");
+  test.AddAttribute("axes", std::vector<int64_t>{1});
+  test.AddAttribute("keepdims", (int64_t)0);
+  test.AddInput<float>("data", {outer, reduced, inner}, data);
+  test.AddOutput<float>("reduced", {outer, inner}, expected);
+  test.Run();
+}
+
 TEST(ReductionOpTest, ReduceSum_int32) {
   OpTester test("ReduceSum");
   test.AddAttribute("axes", std::vector<int64_t>{0, 2});
@@ -99,7 +99,8 @@ static void RunGruTest(const std::vector<float>& X_data,
 
 void DefaultActivationsSimpleWeightsNoBias(std::string direction,
                                            const std::vector<float>& Y_data,
-                                           const std::vector<float>& Y_h_data) {
+                                           const std::vector<float>& Y_h_data,
+                                           const std::vector<int>* sequence_lengths = nullptr) {
   int64_t seq_length = 2;
   int batch_size = 2;
   int64_t input_size = 1;
@@ -123,13 +124,13 @@ void DefaultActivationsSimpleWeightsNoBias(std::string direction,
   std::vector<float> R_data(num_directions * 3 * hidden_size * hidden_size, 0.1f);
 
   RunGruTest(X_data, W_data, R_data, Y_data, Y_h_data, input_size, batch_size, hidden_size, seq_length,
-             nullptr, nullptr, nullptr, direction);
+             nullptr, nullptr, sequence_lengths, direction);
 
   // if Y_h_data is empty that tests Y_h not being returned. we need to have at least one output or
   // the node will get removed, so only test with output_sequence == false (no Y as output) if Y_h is not optional
   if (!Y_h_data.empty())
     RunGruTest(X_data, W_data, R_data, Y_data, Y_h_data, input_size, batch_size, hidden_size, seq_length,
-               nullptr, nullptr, nullptr, direction, 9999.0, /* output_sequence*/ false);
+               nullptr, nullptr, sequence_lengths, direction, 9999.0, /* output_sequence*/ false);
 }
 
 TEST(GRUTest, ForwardDefaultActivationsSimpleWeightsNoBiasTwoRows) {
@@ -165,6 +166,60 @@ TEST(GRUTest, ReverseDefaultActivationsSimpleWeightsNoBiasTwoRows) {
   DefaultActivationsSimpleWeightsNoBias("reverse", Y_data, Y_h_data);
 }
 
+TEST(GRUTest, MixedSequenceLengths) {
+  // the rows are independent, so the expected output for each row comes from the output of
+  // ForwardDefaultActivationsSimpleWeightsNoBiasTwoRows and ReverseDefaultActivationsSimpleWeightsNoBiasTwoRows.
+  // the first row being shorter requires the batch to be re-ordered internally.
+  std::vector<int> seq_lengths{1, 2};
+
+  std::vector<float> Y_data{
+      0.4750208f, 0.450166f, 0.4255575f,
+      0.45016602f, 0.40131235f, 0.35434368f,
+
+      0.f, 0.f, 0.f,
+      0.5754369f, 0.45485455f, 0.3747841f};
+
+  std::vector<float> Y_h_data{
+      0.4750208f, 0.450166f, 0.4255575f,
+      0.5754369f, 0.45485455f, 0.3747841f};
+
+  DefaultActivationsSimpleWeightsNoBias("forward", Y_data, Y_h_data, &seq_lengths);
+
+  // swap which one is short
+  seq_lengths = {2, 1};
+
+  Y_data = {
+      0.4750208f, 0.450166f, 0.4255575f,
+      0.45016602f, 0.40131235f, 0.35434368f,
+
+      0.6027093f, 0.5083023f, 0.44950223f,
+      0.f, 0.f, 0.f};
+
+  Y_h_data = {
+      0.6027093f, 0.5083023f, 0.44950223f,
+      0.45016602f, 0.40131235f, 0.35434368f};
+
+  DefaultActivationsSimpleWeightsNoBias("forward", Y_data, Y_h_data, &seq_lengths);
+}
+
+TEST(GRUTest, MixedSequenceLengthsReverse) {
+  std::vector<int> seq_lengths{1, 2};
+
+  // a sequence of length 1 is the same forwards and backwards
+  std::vector<float> Y_data{
+      0.4750208f, 0.450166f, 0.4255575f,
+      0.5803454f, 0.4527356f, 0.36886263f,
+
+      0.f, 0.f, 0.f,
+      0.24973989f, 0.09975048f, 0.03557118f};
+
+  std::vector<float> Y_h_data{
+      0.4750208f, 0.450166f, 0.4255575f,
+      0.5803454f, 0.4527356f, 0.36886263f};
+
+  DefaultActivationsSimpleWeightsNoBias("reverse", Y_data, Y_h_data, &seq_lengths);
+}
+
 TEST(GRUTest, BidirectionalDefaultActivationsSimpleWeightsNoBiasTwoRows) {
   std::vector<float> Y_data{
       // forward output for input sequence 0
@@ -105,5 +105,62 @@ TEST(TransposeOpTest, ThreeDim) {
   TransposeTest(input_shape, input_vals, &perm, expected_shape, expected_vals);
 }
 
+// Test 4 dimensional transposes of a tensor large enough to use tiles and
+// multiple tasks, with dimensions that are not multiples of the tile size.
+TEST(TransposeOpTest, FourDimLarge) {
+  const std::vector<int64_t> input_shape({2, 37, 5, 131});
+  const int64_t input_size = 2 * 37 * 5 * 131;
+  std::vector<float> input_vals(input_size);
+  for (int64_t i = 0; i < input_size; i++) {
+    input_vals[i] = static_cast<float>(i);
+  }
+
+  const std::vector<std::vector<int64_t>> perms{{0, 2, 1, 3}, {0, 3, 2, 1}, {3, 1, 0, 2}};
+
+  for (const auto& perm : perms) {
+    std::vector<int64_t> expected_shape(4);
+    for (size_t i = 0; i < 4; i++) {
+      expected_shape[i] = input_shape[perm[i]];
+    }
+
+    const int64_t input_strides[] = {37 * 5 * 131, 5 * 131, 131, 1};
+    std::vector<float> expected_vals;
+    for (int64_t a = 0; a < expected_shape[0]; a++) {
+      for (int64_t b = 0; b < expected_shape[1]; b++) {
+        for (int64_t c = 0; c < expected_shape[2]; c++) {
+          for (int64_t d = 0; d < expected_shape[3]; d++) {
+            expected_vals.push_back(input_vals[a * input_strides[perm[0]] + b * input_strides[perm[1]] +
+                                               c * input_strides[perm[2]] + d * input_strides[perm[3]]]);
+          }
+        }
+      }
+    }
+
+    OpTester test("Transpose");
+    test.AddAttribute("perm", perm);
+    test.AddInput<float>("X", input_shape, input_vals);
+    test.AddOutput<float>("Y", expected_shape, expected_vals);
+    test.Run();
+  }
+}
+
+// Test transposes of empty tensors for the tiled and the blocked paths.
+TEST(TransposeOpTest, EmptyInput) {
+  {
+    OpTester test("Transpose");
+    test.AddAttribute("perm", std::vector<int64_t>{1, 0});
+    test.AddInput<float>("X", {0, 3}, {});
+    test.AddOutput<float>("Y", {3, 0}, {});
+    test.Run();
+  }
+  {
+    OpTester test("Transpose");
+    test.AddAttribute("perm", std::vector<int64_t>{1, 0, 2});
+    test.AddInput<float>("X", {2, 0, 4}, {});
+    test.AddOutput<float>("Y", {0, 2, 4}, {});
+    test.Run();
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <sstream>
 
 #include "gmock/gmock.h"
@@ -248,8 +249,21 @@ void OpTester::ExecuteModel(Model& model,
                             std::unordered_map<std::string, MLValue> feeds,
                             std::vector<std::string> output_names,
                             const std::string& provider_type) {
+  // The Graph lists every initializer as a graph input, which lets a feed override it and stops
+  // kernels from treating it as a constant. The initializers of the tester are never fed, so remove
+  // them from the graph inputs so that kernels see constant weights as they would in a real model.
+  auto model_proto = model.ToProto();
+  auto* graph_inputs = model_proto.mutable_graph()->mutable_input();
+  for (int i = graph_inputs->size() - 1; i >= 0; --i) {
+    const auto& input_name = graph_inputs->Get(i).name();
+    if (std::any_of(initializer_index_.cbegin(), initializer_index_.cend(),
+                    [this, &input_name](size_t index) { return input_data_[index].def_.Name() == input_name; })) {
+      graph_inputs->DeleteSubrange(i, 1);
+    }
+  }
+
   std::stringstream s1;
-  model.ToProto().SerializeToOstream(&s1);
+  model_proto.SerializeToOstream(&s1);
   auto status = session_object.Load(s1);
   EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
   if (!status.IsOK()) {
@@ -7,6 +7,9 @@
 #include <vector>
 #include <iostream>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
 #include <gtest/gtest.h>
 #include "test_allocator.h"
 #include "test_fixture.h"
@@ -154,6 +157,99 @@ INSTANTIATE_TEST_CASE_P(CApiTestWithProviders,
                         CApiTestWithProvider,
                         ::testing::Values(0, 1, 2, 3, 4));
 
+struct RunAsyncResult {
+  std::mutex mutex;
+  std::condition_variable done_cv;
+  bool done = false;
+  int num_callbacks = 0;
+  OrtErrorCode error_code = ORT_OK;
+  std::string error_message;
+  std::vector<int64_t> dims_y;
+  std::vector<float> values_y;
+};
+
+static void ORT_API_CALL RunAsyncCallback(void* user_data, OrtStatus* status, OrtValue** output,
+                                          size_t output_names_len) {
+  auto& result = *reinterpret_cast<RunAsyncResult*>(user_data);
+  std::lock_guard<std::mutex> l(result.mutex);
+  ++result.num_callbacks;
+
+  // this runs on a session thread, so nothing may throw before the waiting thread is notified
+  OrtTensorTypeAndShapeInfo* shape_info = nullptr;
+  float* f = nullptr;
+  if (status == nullptr && output_names_len == 1 && output != nullptr && output[0] != nullptr &&
+      (status = OrtGetTensorShapeAndType(output[0], &shape_info)) == nullptr &&
+      (status = OrtGetTensorMutableData(output[0], (void**)&f)) == nullptr) {
+    result.dims_y.resize(OrtGetNumOfDimensions(shape_info));
+    OrtGetDimensions(shape_info, result.dims_y.data(), result.dims_y.size());
+    result.values_y.assign(f, f + OrtGetTensorShapeElementCount(shape_info));
+  }
+
+  if (status != nullptr) {
+    result.error_code = OrtGetErrorCode(status);
+    result.error_message = OrtGetErrorMessage(status);
+    OrtReleaseStatus(status);
+  }
+  if (shape_info != nullptr) {
+    OrtReleaseTensorTypeAndShapeInfo(shape_info);
+  }
+  if (output != nullptr) {
+    for (size_t i = 0; i != output_names_len; ++i) {
+      OrtReleaseValue(output[i]);
+    }
+  }
+
+  result.done = true;
+  result.done_cv.notify_all();
+}
+
+static void RunAsyncAndWait(OrtSession* session_object, OrtAllocator* allocator, const char* output_name,
+                            RunAsyncResult& result) {
+  std::vector<size_t> dims_x = {3, 2};
+  std::vector<float> values_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  std::unique_ptr<OrtValue, decltype(&OrtReleaseValue)> value_x(
+      OrtCreateTensorAsOrtValue(allocator, dims_x, ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT), OrtReleaseValue);
+  void* raw_data;
+  ORT_THROW_ON_ERROR(OrtGetTensorMutableData(value_x.get(), &raw_data));
+  memcpy(raw_data, values_x.data(), values_x.size() * sizeof(values_x[0]));
+
+  const char* input_names[] = {"X"};
+  const OrtValue* inputs[] = {value_x.get()};
+  const char* output_names[] = {output_name};
+  ORT_THROW_ON_ERROR(OrtRunAsync(session_object, nullptr, input_names, inputs, 1, output_names, 1,
+                                 RunAsyncCallback, &result));
+
+  // the input must not be released until the callback is invoked
+  std::unique_lock<std::mutex> l(result.mutex);
+  result.done_cv.wait(l, [&result]() { return result.done; });
+}
+
+TEST_F(CApiTest, run_async) {
+  SessionOptionsWrapper sf(env);
+  std::unique_ptr<OrtSession, decltype(&OrtReleaseSession)>
+      inference_session(sf.OrtCreateSession(MODEL_URI), OrtReleaseSession);
+  std::unique_ptr<MockedOrtAllocator> default_allocator(std::make_unique<MockedOrtAllocator>());
+
+  {
+    RunAsyncResult result;
+    RunAsyncAndWait(inference_session.get(), default_allocator.get(), "Y", result);
+    ASSERT_EQ(result.num_callbacks, 1);
+    ASSERT_EQ(result.error_code, ORT_OK) << result.error_message;
+    ASSERT_EQ(result.dims_y, std::vector<int64_t>({3, 2}));
+    ASSERT_EQ(result.values_y, std::vector<float>({1.0f, 4.0f, 9.0f, 16.0f, 25.0f, 36.0f}));
+  }
+
+  // a failed run is reported through the callback, with no outputs
+  {
+    RunAsyncResult result;
+    RunAsyncAndWait(inference_session.get(), default_allocator.get(), "NotAnOutput", result);
+    ASSERT_EQ(result.num_callbacks, 1);
+    ASSERT_NE(result.error_code, ORT_OK);
+    ASSERT_FALSE(result.error_message.empty());
+    ASSERT_TRUE(result.values_y.empty());
+  }
+}
+
 #ifndef _WIN32
 //doesn't work, failed in type comparison
 TEST_F(CApiTest, DISABLED_custom_op) {
@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+
+namespace onnxruntime {
+namespace test {
+
+/**
+  * Creates a uniquely named directory under the system temporary directory for a test to write files to.
+  * Files created through Path() and the directory itself are deleted when the instance is destroyed.
+  */
+class TemporaryDirectory {
+ public:
+  explicit TemporaryDirectory(const std::string& prefix = "onnxruntime_test");
+  ~TemporaryDirectory();
+
+  const std::string& Directory() const { return directory_; }
+
+  /** Returns the path of filename in the directory. The file is deleted with the directory. */
+  std::string Path(const std::string& filename);
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(TemporaryDirectory);
+
+  std::string directory_;
+  std::vector<std::string> files_;
+};
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test/temp_dir.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "core/platform/env.h"
+
+namespace onnxruntime {
+namespace test {
+
+TemporaryDirectory::TemporaryDirectory(const std::string& prefix) {
+#ifdef _WIN32
+  char temp_path[MAX_PATH + 1];
+  DWORD length = GetTempPathA(MAX_PATH + 1, temp_path);
+  ORT_ENFORCE(length != 0 && length <= MAX_PATH, "GetTempPath failed: ", GetLastError());
+
+  const auto pid = Env::Default().GetSelfPid();
+  for (int attempt = 0;; ++attempt) {
+    std::string candidate = std::string(temp_path) + prefix + "_" + std::to_string(pid) + "_" +
+                            std::to_string(Env::Default().NowMicros()) + "_" + std::to_string(attempt);
+    if (CreateDirectoryA(candidate.c_str(), nullptr)) {
+      directory_ = candidate;
+      break;
+    }
+
+    ORT_ENFORCE(GetLastError() == ERROR_ALREADY_EXISTS && attempt < 100,
+                "Failed to create temporary directory ", candidate);
+  }
+#else
+  const char* tmpdir = getenv("TMPDIR");
+  std::string pattern = std::string(tmpdir != nullptr && *tmpdir != '\0' ? tmpdir : "/tmp") + "/" + prefix + "_XXXXXX";
+  std::vector<char> buffer(pattern.cbegin(), pattern.cend());
+  buffer.push_back('\0');
+  ORT_ENFORCE(mkdtemp(buffer.data()) != nullptr, "Failed to create temporary directory from ", pattern);
+  directory_ = buffer.data();
+#endif
+}
+
+TemporaryDirectory::~TemporaryDirectory() {
+  for (const auto& file : files_) {
+    std::remove(file.c_str());
+  }
+
+#ifdef _WIN32
+  _rmdir(directory_.c_str());
+#else
+  rmdir(directory_.c_str());
+#endif
+}
+
+std::string TemporaryDirectory::Path(const std::string& filename) {
+#ifdef _WIN32
+  std::string path = directory_ + "\\" + filename;
+#else
+  std::string path = directory_ + "/" + filename;
+#endif
+  files_.push_back(path);
+  return path;
+}
+
+}  // namespace test
+}  // namespace onnxruntime